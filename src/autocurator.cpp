@@ -17,8 +17,28 @@
 #include "CommandLine.h"
 #include "Announce.h"
 #include "IndexedDataset.h"
+#include "NcFilePool.h"
+#include "Profiler.h"
+#include "IndexServer.h"
+#include "DirectoryWatcher.h"
+#include "CompressedStream.h"
+#include "RemoteFile.h"
+#include "GridRegistry.h"
+#include "FileInfoSpill.h"
+#include "DatasetManifest.h"
+#include "contrib/json.hpp"
 
 #include <string>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
 
 #include "netcdfcpp.h"
 
@@ -28,6 +48,134 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
+///	<summary>
+///		Get the file an output is written to before CommitOutputFile is
+///		called.  Outputs that are replaced while readers may be using
+///		them are written beside the output and renamed over it.  The
+///		".tmp" suffix goes before any ".gz" or ".zst" extension so the
+///		temporary file is compressed like the output.
+///	</summary>
+static std::string OutputFilename(
+	const std::string & strFilename,
+	bool fReplace
+) {
+	if (!fReplace) {
+		return strFilename;
+	}
+	std::string strExt =
+		CompressionFormatExtension(CompressionFormatFromFilename(strFilename));
+	return strFilename.substr(0, strFilename.length() - strExt.length())
+		+ std::string(".tmp") + strExt;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Move an output written to OutputFilename into place.
+///	</summary>
+static void CommitOutputFile(
+	const std::string & strFilename,
+	bool fReplace
+) {
+	if (!fReplace) {
+		return;
+	}
+	std::string strTempFilename = OutputFilename(strFilename, fReplace);
+	if (rename(strTempFilename.c_str(), strFilename.c_str()) != 0) {
+		_EXCEPTION2("Unable to rename \"%s\" to \"%s\"",
+			strTempFilename.c_str(), strFilename.c_str());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Save the deduplication state of an index beside the index file,
+///		once the index file is in place.
+///	</summary>
+static void WriteDedupState(
+	const IndexedDataset & objFileList,
+	const std::string & strIndexFilename
+) {
+	std::string strError = objFileList.ToDedupStateFile(strIndexFilename);
+	if (strError != "") {
+		_EXCEPTIONT(strError.c_str());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Split a comma-separated list, dropping empty items.
+///	</summary>
+static std::vector<std::string> SplitCommaList(
+	const std::string & strList
+) {
+	std::vector<std::string> vecItems;
+	size_t sPos = 0;
+	while (sPos <= strList.length()) {
+		size_t sNext = strList.find(',', sPos);
+		if (sNext == std::string::npos) {
+			sNext = strList.length();
+		}
+		if (sNext != sPos) {
+			vecItems.push_back(strList.substr(sPos, sNext - sPos));
+		}
+		sPos = sNext + 1;
+	}
+	return vecItems;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write the files that were skipped as a file list, with the error
+///		of each in a comment line, so that it can be indexed again with
+///		--file_list.
+///	</summary>
+static void WriteFailedFileList(
+	const std::string & strFilename,
+	const std::vector<FailedFile> & vecFailedFiles
+) {
+	std::ofstream ofs(strFilename.c_str());
+	if (!ofs.is_open()) {
+		_EXCEPTION1("Unable to open failed file list \"%s\"",
+			strFilename.c_str());
+	}
+	for (size_t f = 0; f < vecFailedFiles.size(); f++) {
+		std::string strError = vecFailedFiles[f].m_strError;
+		std::replace(strError.begin(), strError.end(), '\n', ' ');
+		ofs << "# " << strError
+			<< " (" << vecFailedFiles[f].m_sAttempts << " attempts)" << std::endl;
+		ofs << vecFailedFiles[f].m_strFilename << std::endl;
+	}
+	if (!ofs.good()) {
+		_EXCEPTION1("Unable to write failed file list \"%s\"",
+			strFilename.c_str());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write the profile report.  With MPI the timings of all ranks are
+///		reduced into the report written by rank 0, so this must be called
+///		on every rank.
+///	</summary>
+static void WriteProfileReport(
+	const std::string & strProfileFile,
+	const IndexedDataset & objFileList
+) {
+	Profiler::Shared().StopRSSSampling();
+	objFileList.RecordMemoryFootprint();
+	std::string strError = Profiler::Shared().WriteReport(strProfileFile);
+	if (strError != "") {
+		_EXCEPTIONT(strError.c_str());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 int main(int argc, char** argv) {
 
 #if defined(HYPERION_MPIOMP)
@@ -46,7 +194,13 @@ try {
 	// Path for files
 	std::string strFilePath;
 
-	// File extension
+	// List of files to index instead of a path
+	std::string strFileList;
+
+	// List of datasets, each indexed into its own outputs
+	std::string strManifest;
+
+	// Comma-separated patterns of files to index
 	std::string strFileName;
 
 	// Recurse into subfolders
@@ -55,80 +209,1012 @@ try {
 	// Input JSON file
 	std::string strInputFileJSON;
 
+	// Input CBOR file
+	std::string strInputFileCBOR;
+
+	// Input MessagePack file
+	std::string strInputFileMessagePack;
+
+	// Comma-separated index files to merge
+	std::string strMergeFiles;
+
+	// Only re-index files that changed since the input JSON file
+	bool fIncremental;
+
+	// Comma-separated variables loaded from the input index
+	std::string strOnlyVariables;
+
 	// Output XML file
 	std::string strOutputFileXML;
 
 	// Output JSON file
 	std::string strOutputFileJSON;
 
+	// Variables per shard of a sharded JSON output, or zero for one file
+	int nShardVariables;
+
+	// Output CBOR file
+	std::string strOutputFileCBOR;
+
+	// Output MessagePack file
+	std::string strOutputFileMessagePack;
+
+	// Output mapped index file
+	std::string strOutputFileMapped;
+
+	// Output chunk reference file
+	std::string strOutputFileRefs;
+
+	// Output time-variable index CSV file
+	std::string strOutputFileCSV;
+
+	// Output contiguous time ranges per variable rather than a matrix
+	bool fOutputCSVRuns;
+
+	// Name of the time axis
+	std::string strTimeAxis;
+
+	// Patterns of files and directories to skip
+	std::string strExclude;
+
 	// Pretty print
 	bool fPrettyPrint;
 
+	// Write attributes shared by files once in JSON and binary output
+	bool fSharedFileAttributes;
+
+	// Save the deduplication state beside JSON and binary output
+	bool fDedupState;
+
+	// Number of threads used to extract file headers
+	int nThreads;
+
+	// Number of file headers extracted ahead of the merge
+	int nPrefetchDepth;
+
+	// Distribution of file extraction over threads and ranks (count or cost)
+	std::string strSchedule;
+
+	// Maximum number of files kept open
+	int nMaxOpenFiles;
+
+	// Maximum number of connections to remote servers
+	int nRemoteConnections;
+
+	// Registry of shared grids
+	std::string strGridRegistry;
+
+	// Add the grids of this dataset to the registry
+	bool fGridRegistryUpdate;
+
+	// Directory of cached file headers
+	std::string strCacheDir;
+
+	// File holding the FileInfo of indexed files outside of memory
+	std::string strSpillFile;
+
+	// Megabytes of spilled FileInfo buffered in memory
+	int nSpillBufferMB;
+
+	// Size above which coordinate values are summarized
+	int nSummarizeSize;
+
+	// Load summarized coordinate values for output
+	bool fExpandSummaries;
+
+	// Consistency checking of file headers (full, sample or none)
+	std::string strValidate;
+
+	// Decode classic format headers without the NetCDF library
+	bool fNativeHeaders;
+
+	// Compute statistics of the values of variables while indexing
+	bool fStatistics;
+
+	// Seconds the header of one file may take to be extracted
+	double dFileDeadline;
+
+	// Number of times a file that failed or exceeded the deadline is retried
+	int nFileRetries;
+
+	// Seconds waited before the first retry, doubling for each retry
+	double dRetryBackoff;
+
+	// Skip files that cannot be indexed rather than stopping
+	bool fSkipFailed;
+
+	// Output list of skipped files
+	std::string strOutputFileFailed;
+
+	// Output profile JSON file
+	std::string strProfileFile;
+
+	// Seconds between samples of the resident set size in the profile
+	double dProfileRSSInterval;
+
+	// Verbosity of the log
+	int nVerbosity;
+
+	// Seconds between progress lines
+	double dProgressInterval;
+
+	// Variable to query
+	std::string strQueryVariable;
+
+	// Semicolon-separated coordinate ranges of the query
+	std::string strQuery;
+
+	// Output query result JSON file
+	std::string strOutputFileQuery;
+
+	// Keep indexing --path as files change
+	bool fWatch;
+
+	// Seconds without changes before the index is updated
+	double dWatchInterval;
+
+	// Unix socket path or TCP address to serve the input index on
+	std::string strServeAddress;
+
+	// Seconds between checks of the served index for changes
+	double dReloadInterval;
+
 	// Parse the command line
 	BeginCommandLine()
    	CommandLineString(strFilePath, "path", "");
+	CommandLineString(strFileList, "file_list", "");
+	CommandLineString(strManifest, "manifest", "");
 	CommandLineString(strFileName, "ext", "*.nc");
+	CommandLineString(strExclude, "exclude", "");
 	CommandLineBool(fRecurse, "recurse");
 	CommandLineString(strInputFileJSON, "in_json", "");
+	CommandLineString(strInputFileCBOR, "in_cbor", "");
+	CommandLineString(strInputFileMessagePack, "in_msgpack", "");
+	CommandLineString(strMergeFiles, "merge", "");
+	CommandLineBool(fIncremental, "incremental");
+	CommandLineString(strOnlyVariables, "only_vars", "");
 	CommandLineString(strOutputFileXML, "out_xml", "");
 	CommandLineString(strOutputFileJSON, "out_json", "");
+	CommandLineInt(nShardVariables, "out_json_shard", 0);
+	CommandLineString(strOutputFileCBOR, "out_cbor", "");
+	CommandLineString(strOutputFileMessagePack, "out_msgpack", "");
+	CommandLineString(strOutputFileMapped, "out_mapped", "");
+	CommandLineString(strOutputFileRefs, "out_refs", "");
+	CommandLineString(strOutputFileCSV, "out_csv", "");
+	CommandLineBool(fOutputCSVRuns, "out_csv_runs");
+	CommandLineString(strTimeAxis, "time_axis", "time");
 	CommandLineBool(fPrettyPrint, "out_pretty");
+	CommandLineBool(fSharedFileAttributes, "out_shared_attributes");
+	CommandLineBool(fDedupState, "out_dedup_state");
+	CommandLineInt(nThreads, "threads", 1);
+	CommandLineInt(nPrefetchDepth, "prefetch", 0);
+	CommandLineString(strSchedule, "schedule", "count");
+	CommandLineInt(nMaxOpenFiles, "max_open_files",
+		static_cast<int>(NcFilePool::DefaultMaxOpenFiles));
+	CommandLineInt(nRemoteConnections, "remote_connections",
+		static_cast<int>(RemoteFileClient::DefaultMaxConnections));
+	CommandLineString(strCacheDir, "cache_dir", "");
+	CommandLineString(strSpillFile, "spill_file", "");
+	CommandLineInt(nSpillBufferMB, "spill_buffer_mb",
+		static_cast<int>(FileInfoSpill::DefaultBufferBytes / (1024 * 1024)));
+	CommandLineString(strGridRegistry, "grid_registry", "");
+	CommandLineBool(fGridRegistryUpdate, "grid_registry_update");
+	CommandLineInt(nSummarizeSize, "summarize_size", 0);
+	CommandLineBool(fExpandSummaries, "expand_summaries");
+	CommandLineString(strValidate, "validate", "full");
+	CommandLineBool(fNativeHeaders, "native_headers");
+	CommandLineBool(fStatistics, "stats");
+	CommandLineDouble(dFileDeadline, "file_deadline", 0.0);
+	CommandLineInt(nFileRetries, "file_retries", 0);
+	CommandLineDouble(dRetryBackoff, "retry_backoff", 1.0);
+	CommandLineBool(fSkipFailed, "skip_failed");
+	CommandLineString(strOutputFileFailed, "out_failed", "");
+	CommandLineString(strProfileFile, "profile", "");
+	CommandLineDouble(dProfileRSSInterval, "profile_rss_interval", 0.0);
+	CommandLineInt(nVerbosity, "verbosity", 0);
+	CommandLineDouble(dProgressInterval, "progress_interval", 10.0);
+	CommandLineString(strQueryVariable, "query_var", "");
+	CommandLineString(strQuery, "query", "");
+	CommandLineString(strOutputFileQuery, "out_query", "");
+	CommandLineBool(fWatch, "watch");
+	CommandLineDouble(dWatchInterval, "watch_interval", 10.0);
+	CommandLineString(strServeAddress, "serve", "");
+	CommandLineDouble(dReloadInterval, "reload_interval", 5.0);
 
 	ParseCommandLine(argc, argv);
 	EndCommandLine(argv)
 
 	// Check arguments
-	if ((strFilePath == "") && (strInputFileJSON == "")) {
-		_EXCEPTIONT("No --path or --in_json specified");
+	int nInputFiles =
+		  ((strInputFileJSON != "")?1:0)
+		+ ((strInputFileCBOR != "")?1:0)
+		+ ((strInputFileMessagePack != "")?1:0)
+		+ ((strMergeFiles != "")?1:0);
+
+	if (nInputFiles > 1) {
+		_EXCEPTIONT("Only one of --in_json, --in_cbor, --in_msgpack or --merge may be specified");
+	}
+	if ((strFilePath != "") && (strFileList != "")) {
+		_EXCEPTIONT("Only one of --path or --file_list may be specified");
+	}
+	if ((strFilePath == "") && (strFileList == "") && (strManifest == "") &&
+	    (nInputFiles == 0)
+	) {
+		_EXCEPTIONT("No --path, --file_list, --manifest, --in_json, --in_cbor, --in_msgpack or --merge specified");
+	}
+	if (fIncremental && (nInputFiles == 0)) {
+		_EXCEPTIONT("--incremental requires --in_json, --in_cbor, --in_msgpack or --merge");
+	}
+	if (fIncremental && (strFilePath == "") && (strFileList == "")) {
+		_EXCEPTIONT("--incremental requires --path or --file_list");
+	}
+	if ((strOnlyVariables != "") && (nInputFiles == 0)) {
+		_EXCEPTIONT("--only_vars requires --in_json, --in_cbor, --in_msgpack or --merge");
+	}
+	if ((strOnlyVariables != "") &&
+	    (fIncremental || (strFilePath != "") || (strFileList != ""))
+	) {
+		_EXCEPTIONT("--only_vars cannot be used with --incremental, --path or --file_list");
+	}
+	if (nThreads < 1) {
+		_EXCEPTIONT("--threads must be at least 1");
+	}
+	if (nSummarizeSize < 0) {
+		_EXCEPTIONT("--summarize_size must be nonnegative");
+	}
+	if (nPrefetchDepth < 0) {
+		_EXCEPTIONT("--prefetch must be nonnegative");
+	}
+	if (nMaxOpenFiles < 0) {
+		_EXCEPTIONT("--max_open_files must be nonnegative");
+	}
+	if (nRemoteConnections < 1) {
+		_EXCEPTIONT("--remote_connections must be positive");
+	}
+	if (fGridRegistryUpdate && (strGridRegistry == "")) {
+		_EXCEPTIONT("--grid_registry_update requires --grid_registry");
+	}
+	if (fDedupState &&
+	    (strOutputFileJSON == "") &&
+	    (strOutputFileCBOR == "") &&
+	    (strOutputFileMessagePack == "") &&
+	    (strManifest == "")
+	) {
+		_EXCEPTIONT("--out_dedup_state requires --out_json, --out_cbor, --out_msgpack or --manifest");
+	}
+	if (fWatch && IsRemoteURL(strFilePath)) {
+		_EXCEPTIONT("--watch cannot be used with a remote --path");
+	}
+
+	ValidationLevel eValidationLevel;
+	if (strValidate == "full") {
+		eValidationLevel = ValidationLevel_Full;
+	} else if (strValidate == "sample") {
+		eValidationLevel = ValidationLevel_Sample;
+	} else if (strValidate == "none") {
+		eValidationLevel = ValidationLevel_None;
+	} else {
+		_EXCEPTIONT("--validate must be one of \"full\", \"sample\" or \"none\"");
+	}
+
+	ExtractionSchedule eExtractionSchedule;
+	if (strSchedule == "count") {
+		eExtractionSchedule = ExtractionSchedule_Count;
+	} else if (strSchedule == "cost") {
+		eExtractionSchedule = ExtractionSchedule_Cost;
+	} else {
+		_EXCEPTIONT("--schedule must be one of \"count\" or \"cost\"");
+	}
+	if (nShardVariables < 0) {
+		_EXCEPTIONT("--out_json_shard must be nonnegative");
+	}
+	if ((nShardVariables != 0) && (strOutputFileJSON == "")) {
+		_EXCEPTIONT("--out_json_shard requires --out_json");
+	}
+	if (dProgressInterval <= 0.0) {
+		_EXCEPTIONT("--progress_interval must be positive");
+	}
+	if (dProfileRSSInterval < 0.0) {
+		_EXCEPTIONT("--profile_rss_interval must be nonnegative");
+	}
+	if ((dProfileRSSInterval != 0.0) && (strProfileFile == "")) {
+		_EXCEPTIONT("--profile_rss_interval requires --profile");
+	}
+	if ((strQueryVariable == "") &&
+	    ((strQuery != "") || (strOutputFileQuery != ""))
+	) {
+		_EXCEPTIONT("--query and --out_query require --query_var");
+	}
+
+	if (fWatch) {
+		if (strFilePath == "") {
+			_EXCEPTIONT("--watch requires --path");
+		}
+		if (strServeAddress != "") {
+			_EXCEPTIONT("--watch cannot be combined with --serve");
+		}
+		if (dWatchInterval < 0.0) {
+			_EXCEPTIONT("--watch_interval must be nonnegative");
+		}
+#if defined(HYPERION_MPIOMP)
+		int nSize;
+		MPI_Comm_size(MPI_COMM_WORLD, &nSize);
+		if (nSize > 1) {
+			_EXCEPTIONT("--watch runs on a single rank");
+		}
+#endif
+	}
+	if (strServeAddress != "") {
+		if ((nInputFiles != 1) || (strMergeFiles != "")) {
+			_EXCEPTIONT("--serve requires one of --in_json, --in_cbor or --in_msgpack");
+		}
+		if ((strFilePath != "") || (strFileList != "") || fIncremental) {
+			_EXCEPTIONT("--serve cannot be combined with --path, --file_list or --incremental");
+		}
+		if (dReloadInterval < 0.0) {
+			_EXCEPTIONT("--reload_interval must be nonnegative");
+		}
+#if defined(HYPERION_MPIOMP)
+		int nSize;
+		MPI_Comm_size(MPI_COMM_WORLD, &nSize);
+		if (nSize > 1) {
+			_EXCEPTIONT("--serve runs on a single rank");
+		}
+#endif
+	}
+
+	if (strManifest != "") {
+		if ((strFilePath != "") || (strFileList != "") || (nInputFiles != 0) ||
+		    fIncremental || fWatch || (strServeAddress != "")
+		) {
+			_EXCEPTIONT("--manifest cannot be combined with --path, --file_list, "
+				"--in_json, --in_cbor, --in_msgpack, --merge, --incremental, "
+				"--watch or --serve");
+		}
+		if ((strOutputFileXML != "") ||
+		    (strOutputFileJSON != "") ||
+		    (strOutputFileCBOR != "") ||
+		    (strOutputFileMessagePack != "") ||
+		    (strOutputFileMapped != "") ||
+		    (strOutputFileRefs != "") ||
+		    (strOutputFileCSV != "") ||
+		    (strQueryVariable != "") ||
+		    (strSpillFile != "")
+		) {
+			_EXCEPTIONT("--manifest lists the outputs of each dataset and "
+				"cannot be combined with other outputs, --query_var or --spill_file");
+		}
+#if defined(HYPERION_MPIOMP)
+		int nSize;
+		MPI_Comm_size(MPI_COMM_WORLD, &nSize);
+		if (nSize > 1) {
+			_EXCEPTIONT("--manifest runs on a single rank");
+		}
+#endif
+	}
+
+	if (strSpillFile != "") {
+		if (nSpillBufferMB < 1) {
+			_EXCEPTIONT("--spill_buffer_mb must be positive");
+		}
+		if ((nInputFiles != 0) || (strMergeFiles != "") || fIncremental || fWatch) {
+			_EXCEPTIONT("--spill_file cannot be combined with --in_json, --in_cbor, "
+				"--in_msgpack, --merge, --incremental or --watch");
+		}
+		if ((strOutputFileXML != "") ||
+		    (strOutputFileCSV != "") ||
+		    (strOutputFileMapped != "") ||
+		    (strOutputFileRefs != "") ||
+		    (strQueryVariable != "") ||
+		    (strServeAddress != "")
+		) {
+			_EXCEPTIONT("--spill_file supports only --out_json, --out_cbor and --out_msgpack");
+		}
+	}
+
+	// Compressed outputs need their compression compiled in, which is
+	// checked before any files are indexed
+	{
+		std::vector<std::string> vecCompressibleOutputs;
+		vecCompressibleOutputs.push_back(strOutputFileXML);
+		vecCompressibleOutputs.push_back(strOutputFileJSON);
+		vecCompressibleOutputs.push_back(strOutputFileRefs);
+		if (fGridRegistryUpdate) {
+			vecCompressibleOutputs.push_back(strGridRegistry);
+		}
+		for (size_t i = 0; i < vecCompressibleOutputs.size(); i++) {
+			std::string strError =
+				CompressionFormatCheckWrite(vecCompressibleOutputs[i]);
+			if (strError != "") {
+				_EXCEPTION1("%s", strError.c_str());
+			}
+		}
+	}
+
+	// Parse the query ranges, of the form "axis=low,high;axis=low,high"
+	std::vector<QueryAxisRange> vecQueryRanges;
+	{
+		std::string strError =
+			QueryAxisRange::ListFromString(strQuery, vecQueryRanges);
+		if (strError != "") {
+			_EXCEPTION1("Invalid --query: %s", strError.c_str());
+		}
+	}
+
+	// Write the log on a background thread
+	AnnounceSetVerbosityLevel(nVerbosity);
+	AnnounceSetProgressInterval(dProgressInterval);
+	AnnounceStartWriter();
+
+	// Start profiling before the first block
+	if (strProfileFile != "") {
+		Profiler::Shared().Enable();
+		Profiler::Shared().StartRSSSampling(dProfileRSSInterval);
 	}
 
 	// Banner
 	AnnounceBanner();
 
+	// Serve an existing index over a socket
+	if (strServeAddress != "") {
+		IndexServer server(
+			(strInputFileJSON != "")?(strInputFileJSON):
+			(strInputFileCBOR != "")?(strInputFileCBOR):(strInputFileMessagePack),
+			(strInputFileJSON != "")?(IndexServerFormat_JSON):
+			(strInputFileCBOR != "")?(IndexServerFormat_CBOR):(IndexServerFormat_MessagePack));
+		server.SetReloadInterval(dReloadInterval);
+
+		AnnounceStartBlock("Loading index\n");
+		std::string strError = server.Load();
+		if (strError != "") {
+			AnnounceFlush();
+			std::cout << strError << std::endl;
+			return (-1);
+		}
+		AnnounceEndBlock("Done");
+
+		strError = server.Serve(strServeAddress);
+		if (strError != "") {
+			AnnounceFlush();
+			std::cout << strError << std::endl;
+			return (-1);
+		}
+
+		AnnounceBanner();
+		AnnounceStopWriter();
+#if defined(HYPERION_MPIOMP)
+		MPI_Finalize();
+#endif
+		return 0;
+	}
+
 	// Create a new IndexedDataset
 	AnnounceStartBlock("Creating IndexedDataset");
 	IndexedDataset objFileList("file_list");
+	objFileList.SetThreadCount(nThreads);
+	objFileList.SetPrefetchDepth(static_cast<size_t>(nPrefetchDepth));
+	objFileList.SetExtractionSchedule(eExtractionSchedule);
+	NcFilePool::Shared().SetMaxOpenFiles(static_cast<size_t>(nMaxOpenFiles));
+	RemoteFileClient::Shared().SetMaxConnections(
+		static_cast<size_t>(nRemoteConnections));
+	objFileList.SetSummarizeSize(static_cast<size_t>(nSummarizeSize));
+	objFileList.SetValidationLevel(eValidationLevel);
+	objFileList.SetNativeClassicHeaders(fNativeHeaders);
+	objFileList.SetComputeStatistics(fStatistics);
+	objFileList.SetWriteSharedFileAttributes(fSharedFileAttributes);
+	objFileList.SetFileDeadline(dFileDeadline);
+	objFileList.SetFileRetries(
+		static_cast<size_t>(std::max(nFileRetries, 0)), dRetryBackoff);
+	objFileList.SetSkipFailedFiles(fSkipFailed);
+	{
+		std::vector<std::string> vecOnlyVariables =
+			SplitCommaList(strOnlyVariables);
+		objFileList.SetLoadedVariables(
+			std::set<std::string>(
+				vecOnlyVariables.begin(), vecOnlyVariables.end()));
+	}
+	if (strSpillFile != "") {
+		std::string strError = objFileList.SetFileSpill(
+			strSpillFile,
+			static_cast<size_t>(nSpillBufferMB) * 1024 * 1024);
+		if (strError != "") {
+			_EXCEPTIONT(strError.c_str());
+		}
+	}
+	if (strCacheDir != "") {
+		std::string strError = objFileList.SetHeaderCacheDir(strCacheDir);
+		if (strError != "") {
+			_EXCEPTIONT(strError.c_str());
+		}
+	}
+
+	// A registry being created need not exist yet
+	GridRegistry gridregistry;
+	if (strGridRegistry != "") {
+		std::ifstream ifsRegistry(strGridRegistry.c_str());
+		if (ifsRegistry.is_open() || !fGridRegistryUpdate) {
+			ifsRegistry.close();
+			std::string strError = gridregistry.FromFile(strGridRegistry);
+			if (strError != "") {
+				_EXCEPTIONT(strError.c_str());
+			}
+		}
+		objFileList.SetGridRegistry(&gridregistry);
+	}
 	AnnounceEndBlock("Done");
 
-	// Load from JSON file
-	if (strInputFileJSON != "") {
+	// Index the datasets of a manifest in one process, sharing the
+	// threads, header cache and grid registry
+	if (strManifest != "") {
+		AnnounceStartBlock("Reading manifest");
+		DatasetManifest manifest;
+		std::string strError = manifest.FromFile(strManifest, strFileName);
+		if (strError != "") {
+			AnnounceFlush();
+			std::cout << strError << std::endl;
+			return (-1);
+		}
+		manifest.EstimateFileCounts(nThreads, fRecurse, strExclude);
+		Announce("%lu datasets", manifest.size());
+		AnnounceEndBlock("Done");
+
+		std::atomic<size_t> sValidatedFiles(0);
+		std::atomic<size_t> sTrustedFiles(0);
+
+		std::mutex mutexFailedFiles;
+		std::vector<FailedFile> vecFailedFiles;
+
+		AnnounceStartBlock("Indexing datasets\n");
+		std::vector<std::string> vecErrors;
+		size_t sFailed = manifest.Run(
+			static_cast<size_t>(nThreads),
+			[&](const DatasetManifestEntry & entry, size_t sThreads) {
+				IndexedDataset objDataset(entry.m_strPath);
+				objDataset.SetThreadCount(sThreads);
+				objDataset.SetPrefetchDepth(static_cast<size_t>(nPrefetchDepth));
+				objDataset.SetExtractionSchedule(eExtractionSchedule);
+				objDataset.SetSummarizeSize(static_cast<size_t>(nSummarizeSize));
+				objDataset.SetValidationLevel(eValidationLevel);
+				objDataset.SetNativeClassicHeaders(fNativeHeaders);
+				objDataset.SetComputeStatistics(fStatistics);
+				objDataset.SetWriteSharedFileAttributes(fSharedFileAttributes);
+				objDataset.SetFileDeadline(dFileDeadline);
+				objDataset.SetFileRetries(
+					static_cast<size_t>(std::max(nFileRetries, 0)), dRetryBackoff);
+				objDataset.SetSkipFailedFiles(fSkipFailed);
+				objDataset.SetHeaderCache(objFileList.GetHeaderCache());
+				objDataset.SetReportProgress(false);
+				if (strGridRegistry != "") {
+					objDataset.SetGridRegistry(&gridregistry);
+				}
+
+				std::string strError =
+					objDataset.PopulateFromFilePath(
+						entry.m_strPath,
+						entry.m_strFileName,
+						fRecurse,
+						strExclude);
+				if (strError != "") {
+					return strError;
+				}
+				objDataset.BuildFileIdLookups();
+
+				size_t sValidated;
+				size_t sTrusted;
+				objDataset.GetValidationCounts(sValidated, sTrusted);
+				sValidatedFiles += sValidated;
+				sTrustedFiles += sTrusted;
+
+				{
+					const std::vector<FailedFile> & vecDatasetFailed =
+						objDataset.GetFailedFiles();
+					std::lock_guard<std::mutex> lock(mutexFailedFiles);
+					vecFailedFiles.insert(vecFailedFiles.end(),
+						vecDatasetFailed.begin(), vecDatasetFailed.end());
+				}
+
+				if (fExpandSummaries) {
+					strError = objDataset.LoadSummarizedValues();
+					if (strError != "") {
+						return strError;
+					}
+				}
+				if (fGridRegistryUpdate) {
+					objDataset.AddGridsToRegistry(gridregistry);
+				}
+				if (entry.m_strOutputXML != "") {
+					objDataset.ToXMLFile(entry.m_strOutputXML);
+				}
+				if (entry.m_strOutputJSON != "") {
+					objDataset.ToJSONFile(entry.m_strOutputJSON, fPrettyPrint);
+					if (fDedupState) {
+						WriteDedupState(objDataset, entry.m_strOutputJSON);
+					}
+				}
+				return std::string("");
+			},
+			vecErrors);
+
+		for (size_t e = 0; e < vecErrors.size(); e++) {
+			if (vecErrors[e] != "") {
+				Announce("Line %lu (\"%s\"): %s",
+					manifest[e].m_sLine,
+					manifest[e].m_strPath.c_str(),
+					vecErrors[e].c_str());
+			}
+		}
+		Announce("%lu of %lu datasets indexed",
+			manifest.size() - sFailed, manifest.size());
+		if (vecFailedFiles.size() != 0) {
+			Announce("%lu files skipped", vecFailedFiles.size());
+		}
+		if (strOutputFileFailed != "") {
+			WriteFailedFileList(strOutputFileFailed, vecFailedFiles);
+		}
+		AnnounceEndBlock("Done");
+
+		// Register the grids of all datasets
+		if (fGridRegistryUpdate) {
+			AnnounceStartBlock("Updating grid registry");
+			strError = gridregistry.ToFile(strGridRegistry);
+			if (strError != "") {
+				AnnounceFlush();
+				std::cout << strError << std::endl;
+				return (-1);
+			}
+			Announce("%lu grids registered", gridregistry.GetGridCount());
+			AnnounceEndBlock("Done");
+		}
+
+		AnnounceWarningSummary();
+
+		size_t sCacheHits;
+		size_t sCacheMisses;
+		if (objFileList.GetHeaderCacheCounts(sCacheHits, sCacheMisses)) {
+			Announce("Header cache: %lu hits, %lu misses",
+				sCacheHits, sCacheMisses);
+		}
+		if (eValidationLevel != ValidationLevel_Full) {
+			Announce("Validation: %lu files checked, %lu trusted",
+				sValidatedFiles.load(), sTrustedFiles.load());
+		}
+
+		if (strProfileFile != "") {
+			WriteProfileReport(strProfileFile, objFileList);
+		}
+
+		AnnounceBanner();
+		AnnounceStopWriter();
+#if defined(HYPERION_MPIOMP)
+		MPI_Finalize();
+#endif
+		return (sFailed == 0)?(0):(-1);
+	}
+
+	// Load from JSON, CBOR or MessagePack file
+	if ((strInputFileJSON != "") ||
+	    (strInputFileCBOR != "") ||
+	    (strInputFileMessagePack != "")
+	) {
 		AnnounceStartBlock("Populating IndexedDataset\n");
-		objFileList.FromJSONFile(strInputFileJSON);
+		std::string strError;
+		if (strInputFileJSON != "") {
+			strError = objFileList.FromJSONFile(strInputFileJSON);
+		} else if (strInputFileCBOR != "") {
+			strError = objFileList.FromBinaryFile(strInputFileCBOR, BinaryIndexFormat_CBOR);
+		} else {
+			strError = objFileList.FromBinaryFile(strInputFileMessagePack, BinaryIndexFormat_MessagePack);
+		}
+		if (strError != "") {
+			AnnounceFlush();
+			std::cout << strError << std::endl;
+			return (-1);
+		}
 		AnnounceEndBlock("Done");
 	}
 
-	// Populate from search string
-	AnnounceStartBlock("Populating IndexedDataset\n");
-	//std::string strError = objFileList.PopulateFromSearchString(strFilePath);
-	std::string strError =
-		objFileList.PopulateFromFilePath(
-			strFilePath,
-			strFileName,
-			fRecurse);
+	// Merge index files
+	if (strMergeFiles != "") {
+		std::vector<std::string> vecMergeFiles = SplitCommaList(strMergeFiles);
 
-	if (strError != "") {
-		std::cout << strError << std::endl;
-		return (-1);
-	}
-	AnnounceEndBlock("Done");
-/*
-	// Output to CSV file
-	AnnounceStartBlock("Output to CSV file\n");
-	objFileList.OutputTimeVariableIndexCSV(strOutputFile);
-	AnnounceEndBlock("Done");
-*/
-	// Output to XML file
-	if (strOutputFileXML != "") {
-		AnnounceStartBlock("Output to XML file\n");
-		objFileList.ToXMLFile(strOutputFileXML);
+		AnnounceStartBlock("Merging indexes\n");
+		std::string strError = objFileList.MergeFromFiles(vecMergeFiles);
+		if (strError != "") {
+			AnnounceFlush();
+			std::cout << strError << std::endl;
+			return (-1);
+		}
 		AnnounceEndBlock("Done");
 	}
 
-	// Output to JSON file
-	if (strOutputFileJSON != "") {
-		AnnounceStartBlock("Output to JSON file\n");
-		objFileList.ToJSONFile(strOutputFileJSON, fPrettyPrint);
+	// Populate from search string, and again whenever a watched file
+	// changes
+	DirectoryWatcher watcher;
+	if (fWatch) {
+		std::string strError =
+			watcher.Start(strFilePath, strFileName, fRecurse, strExclude);
+		if (strError != "") {
+			_EXCEPTIONT(strError.c_str());
+		}
+	}
+
+	std::string strError;
+	for (size_t sPass = 0; ; sPass++) {
+		AnnounceStartBlock("Populating IndexedDataset\n");
+		if (fIncremental || (sPass > 0)) {
+			objFileList.BeginIncrementalIndex();
+			objFileList.SetDeferredFiles(watcher.GetOpenFiles());
+		}
+		//std::string strError = objFileList.PopulateFromSearchString(strFilePath);
+		if (strFileList != "") {
+			strError = objFileList.PopulateFromFileList(strFileList);
+		} else if (strFilePath != "") {
+			strError =
+				objFileList.PopulateFromFilePath(
+					strFilePath,
+					strFileName,
+					fRecurse,
+					strExclude);
+		}
+
+		if ((strError == "") && (fIncremental || (sPass > 0))) {
+			strError = objFileList.EndIncrementalIndex();
+		}
+
+		if (strError != "") {
+			AnnounceFlush();
+			std::cout << strError << std::endl;
+			return (-1);
+		}
+		objFileList.BuildFileIdLookups();
+		if (objFileList.GetFailedFiles().size() != 0) {
+			Announce("%lu files skipped", objFileList.GetFailedFiles().size());
+		}
 		AnnounceEndBlock("Done");
+
+		// Load summarized coordinate values
+		if (fExpandSummaries) {
+			AnnounceStartBlock("Loading summarized coordinate values\n");
+			strError = objFileList.LoadSummarizedValues();
+			if (strError != "") {
+				AnnounceFlush();
+			std::cout << strError << std::endl;
+				return (-1);
+			}
+			AnnounceEndBlock("Done");
+		}
+
+		// Memory held by the index once it is built
+		objFileList.RecordMemoryFootprint();
+
+		// Register the grids shared by all files of the dataset
+		if (fGridRegistryUpdate) {
+			AnnounceStartBlock("Updating grid registry");
+			size_t sAdded = objFileList.AddGridsToRegistry(gridregistry);
+			strError = gridregistry.ToFile(strGridRegistry);
+			if (strError != "") {
+				AnnounceFlush();
+				std::cout << strError << std::endl;
+				return (-1);
+			}
+			Announce("%lu grids added (%lu registered)",
+				sAdded, gridregistry.GetGridCount());
+			AnnounceEndBlock("Done");
+		}
+
+		// Query the index
+		if (strQueryVariable != "") {
+			AnnounceStartBlock("Querying IndexedDataset\n");
+			strError = objFileList.BuildQueryIndex();
+			if (strError != "") {
+				AnnounceFlush();
+				std::cout << strError << std::endl;
+				return (-1);
+			}
+
+			std::vector<QueryFileRange> vecQueryResults;
+			std::chrono::steady_clock::time_point tBegin =
+				std::chrono::steady_clock::now();
+			strError =
+				objFileList.Query(
+					strQueryVariable,
+					vecQueryRanges,
+					vecQueryResults);
+			const double dQueryMicroseconds =
+				std::chrono::duration<double, std::micro>(
+					std::chrono::steady_clock::now() - tBegin).count();
+			if (strError != "") {
+				AnnounceFlush();
+				std::cout << strError << std::endl;
+				return (-1);
+			}
+			Announce("%lu files match (%1.1f us)",
+				vecQueryResults.size(), dQueryMicroseconds);
+
+			if (strOutputFileQuery != "") {
+				nlohmann::json j = nlohmann::json::array();
+				for (size_t r = 0; r < vecQueryResults.size(); r++) {
+					nlohmann::json jResult;
+					vecQueryResults[r].ToJSON(jResult);
+					j.push_back(jResult);
+				}
+				std::ofstream ofs(strOutputFileQuery.c_str());
+				if (!ofs.is_open()) {
+					_EXCEPTION1("Unable to open query file \"%s\"",
+						strOutputFileQuery.c_str());
+				}
+				ofs << std::setw(4) << j << std::endl;
+
+			} else {
+				for (size_t r = 0; r < vecQueryResults.size(); r++) {
+					const QueryFileRange & result = vecQueryResults[r];
+					std::string strSlab;
+					for (size_t d = 0; d < result.m_vecAxisNames.size(); d++) {
+						if (d != 0) {
+							strSlab += ", ";
+						}
+						strSlab += result.m_vecAxisNames[d]
+							+ std::string("[") + std::to_string(result.m_vecStart[d])
+							+ std::string(":") + std::to_string(result.m_vecStart[d] + result.m_vecCount[d])
+							+ std::string("]");
+					}
+					Announce("%s  %s", result.m_strFilename.c_str(), strSlab.c_str());
+				}
+			}
+			AnnounceEndBlock("Done");
+		}
+
+		// Output to CSV file
+		if (strOutputFileCSV != "") {
+			AnnounceStartBlock("Building time index\n");
+			strError = objFileList.BuildTimeIndex(strTimeAxis);
+			if (strError != "") {
+				AnnounceFlush();
+			std::cout << strError << std::endl;
+				return (-1);
+			}
+			AnnounceEndBlock("Done");
+
+			AnnounceStartBlock("Output to CSV file\n");
+			strError = objFileList.OutputTimeVariableIndexCSV(
+				OutputFilename(strOutputFileCSV, fWatch), fOutputCSVRuns);
+			if (strError != "") {
+				AnnounceFlush();
+			std::cout << strError << std::endl;
+				return (-1);
+			}
+			CommitOutputFile(strOutputFileCSV, fWatch);
+			AnnounceEndBlock("Done");
+		}
+
+		// Output to XML file
+		if (strOutputFileXML != "") {
+			AnnounceStartBlock("Output to XML file\n");
+			objFileList.ToXMLFile(OutputFilename(strOutputFileXML, fWatch));
+			CommitOutputFile(strOutputFileXML, fWatch);
+			AnnounceEndBlock("Done");
+		}
+
+		// Output to JSON file
+		if (strOutputFileJSON != "") {
+			AnnounceStartBlock("Output to JSON file\n");
+			if (nShardVariables != 0) {
+				std::string strShardBasename = strOutputFileJSON;
+				strShardBasename.resize(strShardBasename.length() - strlen(
+					CompressionFormatExtension(
+						CompressionFormatFromFilename(strShardBasename))));
+				if ((strShardBasename.length() > 5) &&
+				    (strShardBasename.compare(strShardBasename.length() - 5, 5, ".json") == 0)
+				) {
+					strShardBasename.resize(strShardBasename.length() - 5);
+				}
+				strError = objFileList.ToShardedJSONFile(
+					OutputFilename(strOutputFileJSON, fWatch),
+					static_cast<size_t>(nShardVariables),
+					fPrettyPrint,
+					strShardBasename);
+				if (strError != "") {
+					AnnounceFlush();
+					std::cout << strError << std::endl;
+					return (-1);
+				}
+			} else {
+				objFileList.ToJSONFile(OutputFilename(strOutputFileJSON, fWatch), fPrettyPrint);
+			}
+			CommitOutputFile(strOutputFileJSON, fWatch);
+			if (fDedupState) {
+				WriteDedupState(objFileList, strOutputFileJSON);
+			}
+			AnnounceEndBlock("Done");
+		}
+
+		// Output to CBOR file
+		if (strOutputFileCBOR != "") {
+			AnnounceStartBlock("Output to CBOR file\n");
+			objFileList.ToBinaryFile(OutputFilename(strOutputFileCBOR, fWatch), BinaryIndexFormat_CBOR);
+			CommitOutputFile(strOutputFileCBOR, fWatch);
+			if (fDedupState) {
+				WriteDedupState(objFileList, strOutputFileCBOR);
+			}
+			AnnounceEndBlock("Done");
+		}
+
+		// Output to MessagePack file
+		if (strOutputFileMessagePack != "") {
+			AnnounceStartBlock("Output to MessagePack file\n");
+			objFileList.ToBinaryFile(OutputFilename(strOutputFileMessagePack, fWatch), BinaryIndexFormat_MessagePack);
+			CommitOutputFile(strOutputFileMessagePack, fWatch);
+			if (fDedupState) {
+				WriteDedupState(objFileList, strOutputFileMessagePack);
+			}
+			AnnounceEndBlock("Done");
+		}
+
+		// Output to mapped index file
+		if (strOutputFileMapped != "") {
+			AnnounceStartBlock("Output to mapped index file\n");
+			objFileList.ToMappedIndexFile(OutputFilename(strOutputFileMapped, fWatch));
+			CommitOutputFile(strOutputFileMapped, fWatch);
+			AnnounceEndBlock("Done");
+		}
+
+		// Output to chunk reference file
+		if (strOutputFileRefs != "") {
+			AnnounceStartBlock("Output to chunk reference file\n");
+			size_t sFailedFiles;
+			strError = objFileList.OutputChunkReferences(
+				OutputFilename(strOutputFileRefs, fWatch), sFailedFiles);
+			if (strError != "") {
+				AnnounceFlush();
+				std::cout << strError << std::endl;
+				return (-1);
+			}
+			CommitOutputFile(strOutputFileRefs, fWatch);
+			AnnounceEndBlock("Done");
+		}
+
+		// Output list of skipped files
+		if (strOutputFileFailed != "") {
+			WriteFailedFileList(
+				OutputFilename(strOutputFileFailed, fWatch),
+				objFileList.GetFailedFiles());
+			CommitOutputFile(strOutputFileFailed, fWatch);
+		}
+
+		// Wait for files to be added, changed or removed
+		if (!fWatch) {
+			break;
+		}
+		AnnounceWarningSummary();
+		Announce("Watching \"%s\" for changes", strFilePath.c_str());
+		if (!watcher.WaitForChanges(dWatchInterval)) {
+			break;
+		}
+	}
+
+	// Warnings repeated across files
+	AnnounceWarningSummary();
+
+	// Header cache summary
+	size_t sCacheHits;
+	size_t sCacheMisses;
+	if (objFileList.GetHeaderCacheCounts(sCacheHits, sCacheMisses)) {
+		Announce("Header cache: %lu hits, %lu misses",
+			sCacheHits, sCacheMisses);
+	}
+
+	// Validation summary
+	if (eValidationLevel != ValidationLevel_Full) {
+		size_t sValidatedFiles;
+		size_t sTrustedFiles;
+		objFileList.GetValidationCounts(sValidatedFiles, sTrustedFiles);
+		Announce("Validation: %lu files checked, %lu trusted",
+			sValidatedFiles, sTrustedFiles);
+	}
+
+	// Write the profile
+	if (strProfileFile != "") {
+		WriteProfileReport(strProfileFile, objFileList);
 	}
 
 	// Banner
@@ -139,6 +1225,9 @@ try {
 } catch(...) {
 }
 
+	// Write the remainder of the log
+	AnnounceStopWriter();
+
 #if defined(HYPERION_MPIOMP)
 	// Deinitialize MPI
 	MPI_Finalize();
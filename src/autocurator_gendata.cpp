@@ -0,0 +1,373 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    autocurator_gendata.cpp
+///	\version October 14, 2026
+///
+///	<remarks>
+///		Copyright 2016- Paul Ullrich
+///
+///		This file is distributed as part of the Tempest source code package.
+///		Permission is granted to use, copy, modify and distribute this
+///		source code and its documentation under the terms of the GNU General
+///		Public License.  This software is provided "as is" without express
+///		or implied warranty.
+///	</remarks>
+
+#include "CommandLine.h"
+#include "Announce.h"
+#include "Exception.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "netcdfcpp.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Layout of the synthetic dataset.
+///	</summary>
+struct SyntheticDataset {
+
+	///	<summary>
+	///		Number of files per ensemble member.
+	///	</summary>
+	int nFiles;
+
+	///	<summary>
+	///		Number of ensemble members, each in its own subdirectory.
+	///	</summary>
+	int nMembers;
+
+	///	<summary>
+	///		Number of data variables in each file.
+	///	</summary>
+	int nVariables;
+
+	///	<summary>
+	///		Number of extra attributes on each data variable and on the
+	///		file.
+	///	</summary>
+	int nAttributes;
+
+	///	<summary>
+	///		Number of times in each file.
+	///	</summary>
+	int nTimesPerFile;
+
+	///	<summary>
+	///		Grid sizes; no vertical axis is written if nLev is zero.
+	///	</summary>
+	int nLat;
+	int nLon;
+	int nLev;
+
+	///	<summary>
+	///		Number of distinct latitude grids; file f uses grid f % nGrids.
+	///	</summary>
+	int nGrids;
+
+	///	<summary>
+	///		Time between consecutive times, in units of strTimeUnits.
+	///	</summary>
+	double dTimeStep;
+
+	///	<summary>
+	///		Flag indicating times are perturbed so they are not an
+	///		arithmetic progression.
+	///	</summary>
+	bool fIrregularTimes;
+
+	///	<summary>
+	///		Flag indicating the data variables are written, rather than
+	///		only the coordinates.
+	///	</summary>
+	bool fWriteData;
+
+	///	<summary>
+	///		Units and calendar of the time axis.
+	///	</summary>
+	std::string strTimeUnits;
+	std::string strCalendar;
+
+	///	<summary>
+	///		Prefix of the filenames and data variable names.
+	///	</summary>
+	std::string strPrefix;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Create a directory if it does not exist.
+///	</summary>
+static void MakeDirectory(
+	const std::string & strDir
+) {
+	if ((mkdir(strDir.c_str(), 0777) != 0) && (errno != EEXIST)) {
+		_EXCEPTION1("Unable to create directory \"%s\"", strDir.c_str());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write file f of ensemble member m.
+///	</summary>
+static void WriteSyntheticFile(
+	const SyntheticDataset & ds,
+	const std::string & strFilename,
+	int m,
+	int f
+) {
+	NcFile ncfile(strFilename.c_str(), NcFile::Replace);
+	if (!ncfile.is_valid()) {
+		_EXCEPTION1("Unable to open output file \"%s\"", strFilename.c_str());
+	}
+	if (!ds.fWriteData) {
+		ncfile.set_fill(NcFile::NoFill);
+	}
+
+	// Global attributes
+	char szValue[256];
+	ncfile.add_att("Conventions", "CF-1.6");
+	ncfile.add_att("title", "autocurator synthetic dataset");
+	snprintf(szValue, sizeof(szValue), "r%di1p1", m+1);
+	ncfile.add_att("variant_label", szValue);
+	snprintf(szValue, sizeof(szValue), "synthetic-%d-%d", m, f);
+	ncfile.add_att("tracking_id", szValue);
+	for (int a = 0; a < ds.nAttributes; a++) {
+		char szName[32];
+		snprintf(szName, sizeof(szName), "global_attribute_%d", a);
+		snprintf(szValue, sizeof(szValue), "value %d of file %d", a, f);
+		ncfile.add_att(szName, szValue);
+	}
+
+	// Dimensions
+	NcDim * dimTime = ncfile.add_dim("time");
+	NcDim * dimLev = NULL;
+	if (ds.nLev > 0) {
+		dimLev = ncfile.add_dim("lev", ds.nLev);
+	}
+	NcDim * dimLat = ncfile.add_dim("lat", ds.nLat);
+	NcDim * dimLon = ncfile.add_dim("lon", ds.nLon);
+	if ((dimTime == NULL) || (dimLat == NULL) || (dimLon == NULL) ||
+	    ((ds.nLev > 0) && (dimLev == NULL))
+	) {
+		_EXCEPTION1("Unable to add dimensions to \"%s\"", strFilename.c_str());
+	}
+
+	// Dimension variables
+	NcVar * varTime = ncfile.add_var("time", ncDouble, dimTime);
+	varTime->add_att("units", ds.strTimeUnits.c_str());
+	varTime->add_att("calendar", ds.strCalendar.c_str());
+	varTime->add_att("standard_name", "time");
+
+	NcVar * varLev = NULL;
+	if (dimLev != NULL) {
+		varLev = ncfile.add_var("lev", ncDouble, dimLev);
+		varLev->add_att("units", "hPa");
+		varLev->add_att("positive", "down");
+	}
+
+	NcVar * varLat = ncfile.add_var("lat", ncDouble, dimLat);
+	varLat->add_att("units", "degrees_north");
+	varLat->add_att("standard_name", "latitude");
+
+	NcVar * varLon = ncfile.add_var("lon", ncDouble, dimLon);
+	varLon->add_att("units", "degrees_east");
+	varLon->add_att("standard_name", "longitude");
+
+	// Data variables
+	std::vector<NcVar *> vecVars;
+	for (int v = 0; v < ds.nVariables; v++) {
+		char szName[256];
+		snprintf(szName, sizeof(szName), "%s%d", ds.strPrefix.c_str(), v);
+
+		NcVar * var;
+		if (dimLev != NULL) {
+			var = ncfile.add_var(szName, ncFloat, dimTime, dimLev, dimLat, dimLon);
+		} else {
+			var = ncfile.add_var(szName, ncFloat, dimTime, dimLat, dimLon);
+		}
+		if (var == NULL) {
+			_EXCEPTION2("Unable to add variable \"%s\" to \"%s\"",
+				szName, strFilename.c_str());
+		}
+		var->add_att("units", "K");
+		snprintf(szValue, sizeof(szValue), "Synthetic variable %d", v);
+		var->add_att("long_name", szValue);
+		var->add_att("_FillValue", 1.0e20f);
+		for (int a = 0; a < ds.nAttributes; a++) {
+			char szAttName[32];
+			snprintf(szAttName, sizeof(szAttName), "attribute_%d", a);
+			snprintf(szValue, sizeof(szValue), "value %d of variable %d", a, v);
+			var->add_att(szAttName, szValue);
+		}
+		vecVars.push_back(var);
+	}
+
+	// Coordinates; alternate grids are shifted by a fraction of a cell
+	const int iGrid = f % ds.nGrids;
+	const double dLatShift =
+		(180.0 / static_cast<double>(ds.nLat))
+		* static_cast<double>(iGrid) / static_cast<double>(ds.nGrids);
+
+	std::vector<double> vecLat(ds.nLat);
+	for (int j = 0; j < ds.nLat; j++) {
+		vecLat[j] = -90.0
+			+ (static_cast<double>(j) + 0.5) * 180.0 / static_cast<double>(ds.nLat)
+			- dLatShift;
+	}
+	varLat->put(&(vecLat[0]), ds.nLat);
+
+	std::vector<double> vecLon(ds.nLon);
+	for (int i = 0; i < ds.nLon; i++) {
+		vecLon[i] = static_cast<double>(i) * 360.0 / static_cast<double>(ds.nLon);
+	}
+	varLon->put(&(vecLon[0]), ds.nLon);
+
+	if (varLev != NULL) {
+		std::vector<double> vecLev(ds.nLev);
+		for (int k = 0; k < ds.nLev; k++) {
+			vecLev[k] = 1000.0 * std::pow(0.9, static_cast<double>(k));
+		}
+		varLev->put(&(vecLev[0]), ds.nLev);
+	}
+
+	std::vector<double> vecTime(ds.nTimesPerFile);
+	for (int t = 0; t < ds.nTimesPerFile; t++) {
+		const int iTime = f * ds.nTimesPerFile + t;
+		vecTime[t] = ds.dTimeStep * (static_cast<double>(iTime) + 0.5);
+		if (ds.fIrregularTimes) {
+			vecTime[t] += 0.01 * ds.dTimeStep * static_cast<double>(iTime % 7);
+		}
+	}
+	varTime->set_cur(0L);
+	varTime->put(&(vecTime[0]), ds.nTimesPerFile);
+
+	if (!ds.fWriteData) {
+		return;
+	}
+
+	// Data, one record at a time
+	const int nLev = (ds.nLev > 0)?(ds.nLev):(1);
+	std::vector<float> vecRecord(
+		static_cast<size_t>(nLev) * ds.nLat * ds.nLon);
+
+	for (int v = 0; v < ds.nVariables; v++) {
+	for (int t = 0; t < ds.nTimesPerFile; t++) {
+		for (size_t s = 0; s < vecRecord.size(); s++) {
+			vecRecord[s] = 250.0f
+				+ static_cast<float>(v)
+				+ 0.01f * static_cast<float>((s + t) % 1000);
+		}
+		if (varLev != NULL) {
+			vecVars[v]->set_cur(t, 0, 0, 0);
+			vecVars[v]->put(&(vecRecord[0]), 1, ds.nLev, ds.nLat, ds.nLon);
+		} else {
+			vecVars[v]->set_cur(t, 0, 0);
+			vecVars[v]->put(&(vecRecord[0]), 1, ds.nLat, ds.nLon);
+		}
+	}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+
+	// Turn off fatal errors in NetCDF
+	NcError error(NcError::silent_nonfatal);
+
+try {
+
+	SyntheticDataset ds;
+
+	// Output directory
+	std::string strOutputDir;
+
+	// Parse the command line
+	BeginCommandLine()
+		CommandLineString(strOutputDir, "out_dir", "");
+		CommandLineInt(ds.nFiles, "files", 100);
+		CommandLineInt(ds.nMembers, "members", 1);
+		CommandLineInt(ds.nVariables, "vars", 1);
+		CommandLineInt(ds.nAttributes, "atts", 0);
+		CommandLineInt(ds.nTimesPerFile, "times", 12);
+		CommandLineInt(ds.nLat, "lat", 90);
+		CommandLineInt(ds.nLon, "lon", 180);
+		CommandLineInt(ds.nLev, "lev", 0);
+		CommandLineInt(ds.nGrids, "grids", 1);
+		CommandLineDouble(ds.dTimeStep, "time_step", 1.0);
+		CommandLineBool(ds.fIrregularTimes, "irregular_times");
+		CommandLineString(ds.strTimeUnits, "time_units", "days since 1850-01-01");
+		CommandLineString(ds.strCalendar, "calendar", "noleap");
+		CommandLineString(ds.strPrefix, "prefix", "var");
+		CommandLineBool(ds.fWriteData, "write_data");
+
+		ParseCommandLine(argc, argv);
+	EndCommandLine(argv)
+
+	// Check arguments
+	if (strOutputDir == "") {
+		_EXCEPTIONT("No --out_dir specified");
+	}
+	if ((ds.nFiles < 1) || (ds.nMembers < 1) || (ds.nTimesPerFile < 1)) {
+		_EXCEPTIONT("--files, --members and --times must be at least 1");
+	}
+	if ((ds.nVariables < 0) || (ds.nAttributes < 0) || (ds.nLev < 0)) {
+		_EXCEPTIONT("--vars, --atts and --lev must be nonnegative");
+	}
+	if ((ds.nLat < 1) || (ds.nLon < 1)) {
+		_EXCEPTIONT("--lat and --lon must be at least 1");
+	}
+	if (ds.nGrids < 1) {
+		_EXCEPTIONT("--grids must be at least 1");
+	}
+
+	// Banner
+	AnnounceBanner();
+
+	Announce("Writing %i files to \"%s\"",
+		ds.nFiles * ds.nMembers, strOutputDir.c_str());
+	AnnounceStartBlock("Writing files");
+
+	MakeDirectory(strOutputDir);
+	for (int m = 0; m < ds.nMembers; m++) {
+		char szMember[32];
+		snprintf(szMember, sizeof(szMember), "/r%di1p1", m+1);
+		std::string strMemberDir = strOutputDir + szMember;
+		MakeDirectory(strMemberDir);
+
+		for (int f = 0; f < ds.nFiles; f++) {
+			char szFilename[512];
+			snprintf(szFilename, sizeof(szFilename),
+				"%s/%s_r%di1p1_%06d.nc",
+				strMemberDir.c_str(), ds.strPrefix.c_str(), m+1, f);
+
+			WriteSyntheticFile(ds, szFilename, m, f);
+		}
+		Announce("r%di1p1: %i files", m+1, ds.nFiles);
+	}
+
+	AnnounceEndBlock("Done");
+
+	// Banner
+	AnnounceBanner();
+
+} catch(Exception & e) {
+	Announce(e.ToString().c_str());
+	return (-1);
+}
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
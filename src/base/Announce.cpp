@@ -15,6 +15,7 @@
 ///	</remarks>
 
 #include "Announce.h"
+#include "Profiler.h"
 
 #ifdef HYPERION_MPIOMP
 #include <mpi.h>
@@ -23,6 +24,12 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdarg>
+#include <string>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -70,6 +77,304 @@ static bool s_fBlockFlag = false;
 
 ///////////////////////////////////////////////////////////////////////////////
 
+///	<summary>
+///		A monotonic clock for progress lines.
+///	</summary>
+typedef std::chrono::steady_clock AnnounceClock;
+
+///	<summary>
+///		Mutex guarding all announcement state, so that announcements may
+///		be made from any thread.
+///	</summary>
+static std::mutex s_mutexAnnounce;
+
+///	<summary>
+///		Flag indicating output is handed to the writer thread.
+///	</summary>
+static bool s_fAsync = false;
+
+///	<summary>
+///		Flag indicating the writer thread should exit once drained.
+///	</summary>
+static bool s_fStopWriter = false;
+
+///	<summary>
+///		Flag indicating the writer thread is writing output.
+///	</summary>
+static bool s_fWriting = false;
+
+///	<summary>
+///		Output not yet written by the writer thread.
+///	</summary>
+static std::string s_strPending;
+
+///	<summary>
+///		Wakes the writer thread.
+///	</summary>
+static std::condition_variable s_condWriter;
+
+///	<summary>
+///		Signalled when the writer thread has written all pending output.
+///	</summary>
+static std::condition_variable s_condDrained;
+
+///	<summary>
+///		The writer thread.
+///	</summary>
+static std::thread s_threadWriter;
+
+///	<summary>
+///		Seconds between progress lines.
+///	</summary>
+static double s_dProgressInterval = 10.0;
+
+///	<summary>
+///		Flag indicating progress is being reported on this rank.
+///	</summary>
+static bool s_fProgress = false;
+
+///	<summary>
+///		Description of the work being counted.
+///	</summary>
+static std::string s_strProgressText;
+
+///	<summary>
+///		Total amount of work, or zero if unknown.
+///	</summary>
+static size_t s_sProgressTotal = 0;
+
+///	<summary>
+///		Work completed so far.
+///	</summary>
+static size_t s_sProgressCount = 0;
+
+///	<summary>
+///		Number of progress lines output.
+///	</summary>
+static size_t s_sProgressLines = 0;
+
+///	<summary>
+///		Time progress reporting began.
+///	</summary>
+static AnnounceClock::time_point s_tProgressBegin;
+
+///	<summary>
+///		Time of the last progress line.
+///	</summary>
+static AnnounceClock::time_point s_tProgressLast;
+
+///	<summary>
+///		Number of times each warning has been made since the last summary.
+///	</summary>
+static std::map<std::string, size_t> s_mapWarnings;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check if announcements are suppressed on this rank.
+///	</summary>
+static bool AnnounceSuppressedOnRank() {
+#ifdef HYPERION_MPIOMP
+	if (g_fOnlyOutputOnRankZero) {
+		int nRank;
+		MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+		if (nRank > 0) {
+			return true;
+		}
+	}
+#endif
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write output to the output buffer, if there is one.
+///	</summary>
+static void AnnounceWriteOutput(
+	const std::string & strOutput
+) {
+	if (g_fpAnnounceOutput != NULL) {
+		fwrite(strOutput.c_str(), 1, strOutput.length(), g_fpAnnounceOutput);
+		fflush(g_fpAnnounceOutput);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write output, or queue it for the writer thread.  The caller must
+///		hold s_mutexAnnounce.
+///	</summary>
+static void AnnounceWriteLocked(
+	const std::string & strOutput
+) {
+	if (s_fAsync) {
+		s_strPending += strOutput;
+		s_condWriter.notify_one();
+	} else {
+		AnnounceWriteOutput(strOutput);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write a line at the current indentation level, ending any dangling
+///		start block.  The caller must hold s_mutexAnnounce.
+///	</summary>
+static void AnnounceLineLocked(
+	const char * szText
+) {
+	std::string strOutput;
+
+	// Turn off the block flag
+	if (s_fBlockFlag) {
+		strOutput += "\n";
+		s_fBlockFlag = false;
+	}
+
+	// Output with proper indentation
+	for (int i = 0; i < s_nIndentationLevel; i++) {
+		strOutput += "..";
+	}
+	strOutput += szText;
+	strOutput += "\n";
+
+	AnnounceWriteLocked(strOutput);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Format a duration in seconds as hours, minutes and seconds.
+///	</summary>
+static std::string AnnounceFormatDuration(
+	double dSeconds
+) {
+	long lSeconds = static_cast<long>(dSeconds + 0.5);
+	char szBuffer[64];
+	if (lSeconds >= 3600) {
+		snprintf(szBuffer, sizeof(szBuffer), "%ldh%02ldm%02lds",
+			lSeconds / 3600, (lSeconds / 60) % 60, lSeconds % 60);
+	} else if (lSeconds >= 60) {
+		snprintf(szBuffer, sizeof(szBuffer), "%ldm%02lds",
+			lSeconds / 60, lSeconds % 60);
+	} else {
+		snprintf(szBuffer, sizeof(szBuffer), "%lds", lSeconds);
+	}
+	return std::string(szBuffer);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Output a progress line.  The caller must hold s_mutexAnnounce.
+///	</summary>
+static void AnnounceProgressLineLocked(
+	bool fFinal
+) {
+	AnnounceClock::time_point tNow = AnnounceClock::now();
+	const double dElapsed =
+		std::chrono::duration<double>(tNow - s_tProgressBegin).count();
+	const double dRate =
+		(dElapsed > 0.0)?(static_cast<double>(s_sProgressCount) / dElapsed):(0.0);
+
+	char szBuffer[AnnouncementBufferSize];
+	if (fFinal) {
+		snprintf(szBuffer, sizeof(szBuffer), "%s: %lu in %s (%.1f/s)",
+			s_strProgressText.c_str(), s_sProgressCount,
+			AnnounceFormatDuration(dElapsed).c_str(), dRate);
+
+	} else if ((s_sProgressTotal != 0) && (dRate > 0.0)) {
+		const size_t sRemaining =
+			(s_sProgressTotal > s_sProgressCount)
+			?(s_sProgressTotal - s_sProgressCount):(0);
+		snprintf(szBuffer, sizeof(szBuffer), "%s: %lu/%lu (%.1f/s, ETA %s)",
+			s_strProgressText.c_str(), s_sProgressCount, s_sProgressTotal,
+			dRate, AnnounceFormatDuration(
+				static_cast<double>(sRemaining) / dRate).c_str());
+
+	} else if (s_sProgressTotal != 0) {
+		snprintf(szBuffer, sizeof(szBuffer), "%s: %lu/%lu",
+			s_strProgressText.c_str(), s_sProgressCount, s_sProgressTotal);
+
+	} else {
+		snprintf(szBuffer, sizeof(szBuffer), "%s: %lu (%.1f/s)",
+			s_strProgressText.c_str(), s_sProgressCount, dRate);
+	}
+
+	AnnounceLineLocked(szBuffer);
+	s_tProgressLast = tNow;
+	s_sProgressLines++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check if a progress line is due.  The caller must hold
+///		s_mutexAnnounce.
+///	</summary>
+static bool AnnounceProgressDueLocked() {
+	if (!s_fProgress) {
+		return false;
+	}
+	return (std::chrono::duration<double>(
+		AnnounceClock::now() - s_tProgressLast).count() >= s_dProgressInterval);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Body of the writer thread, which writes queued output and
+///		periodic progress lines.
+///	</summary>
+static void AnnounceWriterThread() {
+	std::unique_lock<std::mutex> lock(s_mutexAnnounce);
+	for (;;) {
+		s_condWriter.wait_for(
+			lock,
+			std::chrono::duration<double>(s_dProgressInterval),
+			[]() { return (s_fStopWriter || (s_strPending.length() != 0)); });
+
+		if (AnnounceProgressDueLocked()) {
+			AnnounceProgressLineLocked(false);
+		}
+
+		if (s_strPending.length() != 0) {
+			std::string strOutput;
+			strOutput.swap(s_strPending);
+			s_fWriting = true;
+			lock.unlock();
+
+			AnnounceWriteOutput(strOutput);
+
+			lock.lock();
+			s_fWriting = false;
+		}
+		if (s_strPending.length() == 0) {
+			s_condDrained.notify_all();
+			if (s_fStopWriter) {
+				return;
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Stops the writer thread at exit, so output queued before an early
+///		return from main is not lost.
+///	</summary>
+static struct AnnounceWriterGuard {
+	~AnnounceWriterGuard() {
+		AnnounceStopWriter();
+	}
+} s_guardWriter;
+
+///////////////////////////////////////////////////////////////////////////////
+
 FILE * AnnounceGetOutputBuffer() {
 	return g_fpAnnounceOutput;
 }
@@ -77,6 +382,7 @@ FILE * AnnounceGetOutputBuffer() {
 ///////////////////////////////////////////////////////////////////////////////
 
 void AnnounceSetOutputBuffer(FILE * fpAnnounceOutput) {
+	AnnounceFlush();
 	g_fpAnnounceOutput = fpAnnounceOutput;
 }
 
@@ -100,45 +406,86 @@ void AnnounceOutputOnAllRanks() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void AnnounceStartBlock(const char * szText) {
-
-	// Do not start a block at maximum indentation level
-	if (s_nIndentationLevel == MaximumIndentationLevel) {
+void AnnounceStartWriter() {
+	std::lock_guard<std::mutex> lock(s_mutexAnnounce);
+	if (s_fAsync) {
 		return;
 	}
+	s_fAsync = true;
+	s_fStopWriter = false;
+	s_threadWriter = std::thread(AnnounceWriterThread);
+}
 
-#ifdef HYPERION_MPIOMP
-	// Only output on rank zero
-	if (g_fOnlyOutputOnRankZero) {
-		int nRank;
-
-		MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+///////////////////////////////////////////////////////////////////////////////
 
-		if (nRank > 0) {
+void AnnounceStopWriter() {
+	{
+		std::lock_guard<std::mutex> lock(s_mutexAnnounce);
+		if (!s_fAsync) {
 			return;
 		}
+		s_fStopWriter = true;
+	}
+	s_condWriter.notify_one();
+	s_threadWriter.join();
+
+	std::lock_guard<std::mutex> lock(s_mutexAnnounce);
+	s_fAsync = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AnnounceFlush() {
+	std::unique_lock<std::mutex> lock(s_mutexAnnounce);
+	if (s_fAsync) {
+		s_condWriter.notify_one();
+		s_condDrained.wait(lock, []() {
+			return ((s_strPending.length() == 0) && !s_fWriting);
+		});
+	}
+	if (g_fpAnnounceOutput != NULL) {
+		fflush(g_fpAnnounceOutput);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AnnounceStartBlock(const char * szText) {
+	// Time the block whether or not it is output
+	Profiler::Shared().BeginPhase(szText);
+
+	// Only output on rank zero
+	if (AnnounceSuppressedOnRank()) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(s_mutexAnnounce);
+
+	// Do not start a block at maximum indentation level
+	if (s_nIndentationLevel == MaximumIndentationLevel) {
+		return;
 	}
-#endif
+
+	std::string strOutput;
 
 	// Check the block flag
 	if (s_fBlockFlag) {
-		fprintf(g_fpAnnounceOutput, "\n");
+		strOutput += "\n";
 	}
 
 	// Add indentation
-	int i;
-	for (i = 0; i < s_nIndentationLevel; i++) {
-		fprintf(g_fpAnnounceOutput, "..");
+	for (int i = 0; i < s_nIndentationLevel; i++) {
+		strOutput += "..";
 	}
 
 	// Output the text
 	if (szText != NULL) {
-		fprintf(g_fpAnnounceOutput, "%s", szText);
+		strOutput += szText;
 		s_fBlockFlag = true;
 	}
 	s_nIndentationLevel++;
 
-	fflush(g_fpAnnounceOutput);
+	AnnounceWriteLocked(strOutput);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -157,41 +504,32 @@ void AnnounceStartBlock(
 ///////////////////////////////////////////////////////////////////////////////
 
 void AnnounceEndBlock(const char * szText) {
-	// Do not remove a block at minimum indentation level
-	if (s_nIndentationLevel == 0) {
-		return;
-	}
+	// Time the block whether or not it is output
+	Profiler::Shared().EndPhase();
 
-#ifdef HYPERION_MPIOMP
 	// Only output on rank zero
-	if (g_fOnlyOutputOnRankZero) {
-		int nRank;
+	if (AnnounceSuppressedOnRank()) {
+		return;
+	}
 
-		MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	std::lock_guard<std::mutex> lock(s_mutexAnnounce);
 
-		if (nRank > 0) {
-			return;
-		}
+	// Do not remove a block at minimum indentation level
+	if (s_nIndentationLevel == 0) {
+		return;
 	}
-#endif
 
 	// Check block flag
 	if (szText != NULL) {
 		if (s_fBlockFlag) {
 			s_fBlockFlag = false;
-
-			fprintf(g_fpAnnounceOutput, ".. ");
-			fprintf(g_fpAnnounceOutput, "%s", szText);
-			fprintf(g_fpAnnounceOutput, "\n");
-
+			AnnounceWriteLocked(std::string(".. ") + szText + std::string("\n"));
 		} else {
-			Announce(szText);
+			AnnounceLineLocked(szText);
 		}
 	}
 
 	s_nIndentationLevel--;
-
-	fflush(g_fpAnnounceOutput);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -211,165 +549,223 @@ void AnnounceEndBlock(
 
 void Announce(const char * szText, ...) {
 
-#ifdef HYPERION_MPIOMP
 	// Only output on rank zero
-	if (g_fOnlyOutputOnRankZero) {
-		int nRank;
-
-		MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
-
-		if (nRank > 0) {
-			return;
-		}
+	if (AnnounceSuppressedOnRank()) {
+		return;
 	}
-#endif
 
-	// Turn off the block flag
-	if (s_fBlockFlag) {
-		fprintf(g_fpAnnounceOutput, "\n");
-		s_fBlockFlag = false;
+	// Write to string
+	char szBuffer[AnnouncementBufferSize];
+	if (szText != NULL) {
+		va_list arguments;
+		va_start(arguments, szText);
+		vsnprintf(szBuffer, AnnouncementBufferSize, szText, arguments);
+		va_end(arguments);
 	}
 
-	// If no text, return
+	std::lock_guard<std::mutex> lock(s_mutexAnnounce);
+
+	// If no text, only turn off the block flag
 	if (szText == NULL) {
+		if (s_fBlockFlag) {
+			AnnounceWriteLocked("\n");
+			s_fBlockFlag = false;
+		}
 		return;
 	}
 
-	// Output buffer
-	char szBuffer[AnnouncementBufferSize];
+	AnnounceLineLocked(szBuffer);
+}
 
-	va_list arguments;
+///////////////////////////////////////////////////////////////////////////////
 
-	// Initialize the argument list
-	va_start(arguments, szText);
+void Announce(
+	int iVerbosity,
+	const char * szText,
+	...
+) {
+	// Only output on rank zero
+	if (AnnounceSuppressedOnRank()) {
+		return;
+	}
+
+	// Check verbosity
+	if (iVerbosity > g_iVerbosityLevel) {
+		return;
+	}
 
 	// Write to string
-	vsprintf(szBuffer, szText, arguments);
+	char szBuffer[AnnouncementBufferSize];
+	if (szText != NULL) {
+		va_list arguments;
+		va_start(arguments, szText);
+		vsnprintf(szBuffer, AnnouncementBufferSize, szText, arguments);
+		va_end(arguments);
+	}
 
-	// Cleans up the argument list
-	va_end(arguments);
+	std::lock_guard<std::mutex> lock(s_mutexAnnounce);
 
-	// Output with proper indentation
-	int i;
-	for (i = 0; i < s_nIndentationLevel; i++) {
-		fprintf(g_fpAnnounceOutput, "..");
+	// If no text, only turn off the block flag
+	if (szText == NULL) {
+		if (s_fBlockFlag) {
+			AnnounceWriteLocked("\n");
+			s_fBlockFlag = false;
+		}
+		return;
 	}
-	fprintf(g_fpAnnounceOutput, "%s", szBuffer);
-	fprintf(g_fpAnnounceOutput, "\n");
 
-	fflush(g_fpAnnounceOutput);
+	AnnounceLineLocked(szBuffer);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void Announce(
-	int iVerbosity,
-	const char * szText,
-	...
-) {
+void AnnounceWarning(const char * szText, ...) {
 
-#ifdef HYPERION_MPIOMP
 	// Only output on rank zero
-	if (g_fOnlyOutputOnRankZero) {
-		int nRank;
+	if (AnnounceSuppressedOnRank()) {
+		return;
+	}
 
-		MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	// Write to string
+	char szBuffer[AnnouncementBufferSize];
+	va_list arguments;
+	va_start(arguments, szText);
+	vsnprintf(szBuffer, AnnouncementBufferSize, szText, arguments);
+	va_end(arguments);
 
-		if (nRank > 0) {
-			return;
-		}
+	std::string strWarning = std::string("WARNING: ") + szBuffer;
+
+	std::lock_guard<std::mutex> lock(s_mutexAnnounce);
+
+	// Output the first occurrence, and repeats only when verbose
+	size_t & sCount = s_mapWarnings[strWarning];
+	sCount++;
+	if ((sCount == 1) || (g_iVerbosityLevel > 0)) {
+		AnnounceLineLocked(strWarning.c_str());
 	}
-#endif
+}
 
-	// Check verbosity
-	if (iVerbosity > g_iVerbosityLevel) {
+///////////////////////////////////////////////////////////////////////////////
+
+void AnnounceWarningSummary() {
+
+	// Only output on rank zero
+	if (AnnounceSuppressedOnRank()) {
 		return;
 	}
 
-	// Turn off the block flag
-	if (s_fBlockFlag) {
-		fprintf(g_fpAnnounceOutput, "\n");
-		s_fBlockFlag = false;
+	std::lock_guard<std::mutex> lock(s_mutexAnnounce);
+
+	if (g_iVerbosityLevel == 0) {
+		std::map<std::string, size_t>::const_iterator iter =
+			s_mapWarnings.begin();
+		for (; iter != s_mapWarnings.end(); iter++) {
+			if (iter->second > 1) {
+				std::string strLine =
+					iter->first + std::string(" (")
+					+ std::to_string(iter->second) + std::string(" times)");
+				AnnounceLineLocked(strLine.c_str());
+			}
+		}
 	}
+	s_mapWarnings.clear();
+}
 
-	// If no text, return
-	if (szText == NULL) {
+///////////////////////////////////////////////////////////////////////////////
+
+void AnnounceSetProgressInterval(double dSeconds) {
+	std::lock_guard<std::mutex> lock(s_mutexAnnounce);
+	s_dProgressInterval = dSeconds;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AnnounceProgressBegin(
+	const char * szText,
+	size_t sTotal
+) {
+	// Only output on rank zero; checked here since the writer thread
+	// may not call into MPI
+	if (AnnounceSuppressedOnRank()) {
 		return;
 	}
 
-	// Output buffer
-	char szBuffer[AnnouncementBufferSize];
+	std::lock_guard<std::mutex> lock(s_mutexAnnounce);
+	s_fProgress = true;
+	s_strProgressText = (szText != NULL)?(szText):("");
+	s_sProgressTotal = sTotal;
+	s_sProgressCount = 0;
+	s_sProgressLines = 0;
+	s_tProgressBegin = AnnounceClock::now();
+	s_tProgressLast = s_tProgressBegin;
+}
 
-	va_list arguments;
+///////////////////////////////////////////////////////////////////////////////
 
-	// Initialize the argument list
-	va_start(arguments, szText);
+void AnnounceProgressAdvance(size_t sCount) {
+	std::lock_guard<std::mutex> lock(s_mutexAnnounce);
+	s_sProgressCount += sCount;
 
-	// Write to string
-	vsprintf(szBuffer, szText, arguments);
+	// The writer thread outputs progress lines when running
+	if (!s_fAsync && AnnounceProgressDueLocked()) {
+		AnnounceProgressLineLocked(false);
+	}
+}
 
-	// Cleans up the argument list
-	va_end(arguments);
+///////////////////////////////////////////////////////////////////////////////
 
-	// Output with proper indentation
-	int i;
-	for (i = 0; i < s_nIndentationLevel; i++) {
-		fprintf(g_fpAnnounceOutput, "..");
+void AnnounceProgressEnd() {
+	std::lock_guard<std::mutex> lock(s_mutexAnnounce);
+	if (!s_fProgress) {
+		return;
 	}
-	fprintf(g_fpAnnounceOutput, "%s", szBuffer);
-	fprintf(g_fpAnnounceOutput, "\n");
-
-	fflush(g_fpAnnounceOutput);
+	if (s_sProgressLines != 0) {
+		AnnounceProgressLineLocked(true);
+	}
+	s_fProgress = false;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void AnnounceBanner(const char * szText) {
 
-#ifdef HYPERION_MPIOMP
 	// Only output on rank zero
-	if (g_fOnlyOutputOnRankZero) {
-		int nRank;
+	if (AnnounceSuppressedOnRank()) {
+		return;
+	}
 
-		MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	std::lock_guard<std::mutex> lock(s_mutexAnnounce);
 
-		if (nRank > 0) {
-			return;
-		}
-	}
-#endif
+	std::string strOutput;
 
 	// Turn off the block flag
 	if (s_fBlockFlag) {
-		fprintf(g_fpAnnounceOutput, "\n");
+		strOutput += "\n";
 		s_fBlockFlag = false;
 	}
 
 	// No text in banner
-	int i;
 	if (szText == NULL) {
-		for (i = 0; i < BannerSize; i++) {
-			printf("-");
-		}
-		fprintf(g_fpAnnounceOutput, "\n");
-		fflush(g_fpAnnounceOutput);
+		strOutput.append(BannerSize, '-');
+		strOutput += "\n";
+		AnnounceWriteLocked(strOutput);
 		return;
 	}
 
 	// Text in banner
 	int nLen = strlen(szText) + 2;
-	printf("--");
+	strOutput += "--";
 	if (nLen > BannerSize - 2) {
-		fprintf(g_fpAnnounceOutput, "%s", szText);
-		fprintf(g_fpAnnounceOutput, "--");
+		strOutput += szText;
+		strOutput += "--";
 	} else {
-		fprintf(g_fpAnnounceOutput, " %s ", szText);
-		for (i = 0; i < BannerSize - nLen - 2; i++) {
-			fprintf(g_fpAnnounceOutput, "-");
-		}
+		strOutput += " ";
+		strOutput += szText;
+		strOutput += " ";
+		strOutput.append(BannerSize - nLen - 2, '-');
 	}
-	fprintf(g_fpAnnounceOutput, "\n");
-	fflush(g_fpAnnounceOutput);
+	strOutput += "\n";
+	AnnounceWriteLocked(strOutput);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -22,6 +22,7 @@
 #define _ANNOUNCE_H_
 
 #include <cstdio>
+#include <cstddef>
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -39,7 +40,7 @@ extern bool g_fOnlyOutputOnRankZero;
 FILE * AnnounceGetOutputBuffer();
 
 ///	<summary>
-///		Set the output buffer.
+///		Set the output buffer, or NULL to discard all output.
 ///	</summary>
 void AnnounceSetOutputBuffer(FILE * fpOutputBuffer);
 
@@ -58,6 +59,22 @@ void AnnounceOnlyOutputOnRankZero();
 ///	</summary>
 void AnnounceOutputOnAllRanks();
 
+///	<summary>
+///		Hand output to a background thread, so that announcements do not
+///		wait on a slow output stream.
+///	</summary>
+void AnnounceStartWriter();
+
+///	<summary>
+///		Write all queued output and return to writing output directly.
+///	</summary>
+void AnnounceStopWriter();
+
+///	<summary>
+///		Wait until all queued output has been written.
+///	</summary>
+void AnnounceFlush();
+
 ///	<summary>
 ///		Begin a new announcement block.
 ///	</summary>
@@ -88,6 +105,42 @@ void Announce(const char * szText, ...);
 ///	</summary>
 void Announce(int iVerbosity, const char * szText, ...);
 
+///	<summary>
+///		Make a warning.  Only the first occurrence of each warning is
+///		output unless the verbosity level is above zero; repeats are
+///		counted for AnnounceWarningSummary.
+///	</summary>
+void AnnounceWarning(const char * szText, ...);
+
+///	<summary>
+///		Output the number of times each repeated warning was made, and
+///		reset the counts.
+///	</summary>
+void AnnounceWarningSummary();
+
+///	<summary>
+///		Set the number of seconds between progress lines.
+///	</summary>
+void AnnounceSetProgressInterval(double dSeconds);
+
+///	<summary>
+///		Begin reporting progress through the given total amount of work,
+///		or an unknown amount if sTotal is zero.
+///	</summary>
+void AnnounceProgressBegin(const char * szText, size_t sTotal);
+
+///	<summary>
+///		Count completed work, outputting a progress line with the rate
+///		and estimated time remaining at most once per interval.
+///	</summary>
+void AnnounceProgressAdvance(size_t sCount = 1);
+
+///	<summary>
+///		End reporting progress, with a final line if any progress lines
+///		were output.
+///	</summary>
+void AnnounceProgressEnd();
+
 ///	<summary>
 ///		Create a banner / separator containing the specified text.
 ///	</summary>
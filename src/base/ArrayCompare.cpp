@@ -0,0 +1,276 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    ArrayCompare.cpp
+///	\version October 14, 2026
+///
+
+#include "ArrayCompare.h"
+#include "MathHelper.h"
+
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Block kernels are also built for AVX2 where the toolchain can select
+// between versions at load time.  On aarch64 they are written with NEON
+// intrinsics rather than left to the auto-vectorizer.  Elsewhere the
+// portable kernel is used.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define ARRAYCOMPARE_CLONES __attribute__((target_clones("avx2","default")))
+#else
+#define ARRAYCOMPARE_CLONES
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define ARRAYCOMPARE_NEON
+#include <arm_neon.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Number of elements checked between early outs.
+///	</summary>
+static const size_t ArrayCompareBlockSize = 256;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check if every pair of elements passes a branch-free test that
+///		implies almost_equal.  Pairs are accepted if they are equal, if
+///		they differ by at most ulps denormals, or if both are finite and
+///		they differ by at most ulps units in the last place of the larger
+///		magnitude.  The unit is obtained by masking the exponent bits of
+///		the larger magnitude and scaling by epsilon, which is exact.
+///	</summary>
+template <typename T, typename U>
+static inline bool BlockAlmostEqual(
+	const T * a,
+	const T * b,
+	size_t n,
+	T tTolScale,
+	T tMinTol,
+	U uExpMask
+) {
+	const T tMax = std::numeric_limits<T>::max();
+
+	U uPass = ~static_cast<U>(0);
+	for (size_t i = 0; i < n; i++) {
+		const T tA = a[i];
+		const T tB = b[i];
+		const T tDiff = std::abs(tA - tB);
+		const T tAbsA = std::abs(tA);
+		const T tAbsB = std::abs(tB);
+		const T tLarger = (tAbsA > tAbsB)?(tAbsA):(tAbsB);
+
+		U uScale;
+		memcpy(&uScale, &tLarger, sizeof(T));
+		uScale &= uExpMask;
+		T tScale;
+		memcpy(&tScale, &uScale, sizeof(T));
+
+		const bool fPass =
+			(tA == tB) |
+			(tDiff <= tMinTol) |
+			((tDiff <= tScale * tTolScale) & (tLarger <= tMax));
+
+		uPass &= -static_cast<U>(fPass);
+	}
+	return (uPass != 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(ARRAYCOMPARE_NEON)
+
+///	<summary>
+///		BlockAlmostEqual for floats, four elements at a time with NEON.
+///		The test is the same, lane by lane, as that of BlockAlmostEqual.
+///	</summary>
+static bool BlockAlmostEqualFloat(
+	const float * a,
+	const float * b,
+	size_t n,
+	float flTolScale,
+	float flMinTol
+) {
+	const float32x4_t vTolScale = vdupq_n_f32(flTolScale);
+	const float32x4_t vMinTol = vdupq_n_f32(flMinTol);
+	const float32x4_t vMax = vdupq_n_f32(std::numeric_limits<float>::max());
+	const uint32x4_t vExpMask = vdupq_n_u32(0x7F800000u);
+
+	uint32x4_t vPass = vdupq_n_u32(~0u);
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const float32x4_t vA = vld1q_f32(a + i);
+		const float32x4_t vB = vld1q_f32(b + i);
+		const float32x4_t vDiff = vabdq_f32(vA, vB);
+		const float32x4_t vLarger = vmaxq_f32(vabsq_f32(vA), vabsq_f32(vB));
+		const float32x4_t vScale =
+			vreinterpretq_f32_u32(
+				vandq_u32(vreinterpretq_u32_f32(vLarger), vExpMask));
+
+		uint32x4_t vTest = vorrq_u32(
+			vceqq_f32(vA, vB),
+			vcleq_f32(vDiff, vMinTol));
+		vTest = vorrq_u32(vTest, vandq_u32(
+			vcleq_f32(vDiff, vmulq_f32(vScale, vTolScale)),
+			vcleq_f32(vLarger, vMax)));
+
+		vPass = vandq_u32(vPass, vTest);
+	}
+	if (vminvq_u32(vPass) == 0) {
+		return false;
+	}
+	return BlockAlmostEqual<float, uint32_t>(
+		a + i, b + i, n - i, flTolScale, flMinTol, 0x7F800000u);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		BlockAlmostEqual for doubles, two elements at a time with NEON.
+///		The test is the same, lane by lane, as that of BlockAlmostEqual.
+///	</summary>
+static bool BlockAlmostEqualDouble(
+	const double * a,
+	const double * b,
+	size_t n,
+	double dTolScale,
+	double dMinTol
+) {
+	const float64x2_t vTolScale = vdupq_n_f64(dTolScale);
+	const float64x2_t vMinTol = vdupq_n_f64(dMinTol);
+	const float64x2_t vMax = vdupq_n_f64(std::numeric_limits<double>::max());
+	const uint64x2_t vExpMask = vdupq_n_u64(0x7FF0000000000000ull);
+
+	uint64x2_t vPass = vdupq_n_u64(~0ull);
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2) {
+		const float64x2_t vA = vld1q_f64(a + i);
+		const float64x2_t vB = vld1q_f64(b + i);
+		const float64x2_t vDiff = vabdq_f64(vA, vB);
+		const float64x2_t vLarger = vmaxq_f64(vabsq_f64(vA), vabsq_f64(vB));
+		const float64x2_t vScale =
+			vreinterpretq_f64_u64(
+				vandq_u64(vreinterpretq_u64_f64(vLarger), vExpMask));
+
+		uint64x2_t vTest = vorrq_u64(
+			vceqq_f64(vA, vB),
+			vcleq_f64(vDiff, vMinTol));
+		vTest = vorrq_u64(vTest, vandq_u64(
+			vcleq_f64(vDiff, vmulq_f64(vScale, vTolScale)),
+			vcleq_f64(vLarger, vMax)));
+
+		vPass = vandq_u64(vPass, vTest);
+	}
+	if ((vgetq_lane_u64(vPass, 0) & vgetq_lane_u64(vPass, 1)) == 0) {
+		return false;
+	}
+	return BlockAlmostEqual<double, uint64_t>(
+		a + i, b + i, n - i, dTolScale, dMinTol, 0x7FF0000000000000ull);
+}
+
+#else
+
+ARRAYCOMPARE_CLONES
+static bool BlockAlmostEqualFloat(
+	const float * a,
+	const float * b,
+	size_t n,
+	float flTolScale,
+	float flMinTol
+) {
+	return BlockAlmostEqual<float, uint32_t>(
+		a, b, n, flTolScale, flMinTol, 0x7F800000u);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ARRAYCOMPARE_CLONES
+static bool BlockAlmostEqualDouble(
+	const double * a,
+	const double * b,
+	size_t n,
+	double dTolScale,
+	double dMinTol
+) {
+	return BlockAlmostEqual<double, uint64_t>(
+		a, b, n, dTolScale, dMinTol, 0x7FF0000000000000ull);
+}
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Compare two arrays a block at a time, confirming the elements of
+///		a block that fails the branch-free test with almost_equal.
+///	</summary>
+template <typename T, typename KernelType>
+static bool AlmostEqualBlocks(
+	const T * a,
+	const T * b,
+	size_t n,
+	const unsigned ulps,
+	KernelType fnKernel
+) {
+	typedef std::numeric_limits<T> limits;
+
+	const T tTolScale = static_cast<T>(ulps) * limits::epsilon();
+	const T tMinTol = static_cast<T>(ulps) * limits::denorm_min();
+
+	for (size_t s = 0; s < n; s += ArrayCompareBlockSize) {
+		size_t sCount = n - s;
+		if (sCount > ArrayCompareBlockSize) {
+			sCount = ArrayCompareBlockSize;
+		}
+		if (fnKernel(a + s, b + s, sCount, tTolScale, tMinTol)) {
+			continue;
+		}
+		for (size_t i = s; i < s + sCount; i++) {
+			if (!fpa::almost_equal<T>(a[i], b[i], ulps)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool fpa::equal_n(
+	const int * a,
+	const int * b,
+	size_t n
+) {
+	return (n == 0) || (memcmp(a, b, n * sizeof(int)) == 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool fpa::almost_equal_n(
+	const float * a,
+	const float * b,
+	size_t n,
+	const unsigned ulps
+) {
+	return AlmostEqualBlocks(a, b, n, ulps, BlockAlmostEqualFloat);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool fpa::almost_equal_n(
+	const double * a,
+	const double * b,
+	size_t n,
+	const unsigned ulps
+) {
+	return AlmostEqualBlocks(a, b, n, ulps, BlockAlmostEqualDouble);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
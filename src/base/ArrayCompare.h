@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    ArrayCompare.h
+///	\version October 14, 2026
+///
+
+#ifndef _ARRAYCOMPARE_H_
+#define _ARRAYCOMPARE_H_
+
+#include <cstddef>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace fpa {
+
+	///	<summary>
+	///		Determine if two int arrays are equal.
+	///	</summary>
+	bool equal_n(
+		const int * a,
+		const int * b,
+		size_t n
+	);
+
+	///	<summary>
+	///		Determine if every pair of elements of two float arrays is
+	///		almost_equal.  Blocks of elements are checked with a
+	///		branch-free test that vectorizes, and only elements failing
+	///		it are passed to almost_equal, so the result is the same as
+	///		comparing element by element.  Returns at the first block
+	///		holding a mismatch.
+	///	</summary>
+	bool almost_equal_n(
+		const float * a,
+		const float * b,
+		size_t n,
+		const unsigned ulps = 4
+	);
+
+	///	<summary>
+	///		Determine if every pair of elements of two double arrays is
+	///		almost_equal.
+	///	</summary>
+	bool almost_equal_n(
+		const double * a,
+		const double * b,
+		size_t n,
+		const unsigned ulps = 4
+	);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
@@ -0,0 +1,197 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    BinaryIndexCodec.cpp
+///	\version October 14, 2026
+///
+
+#include "BinaryIndexCodec.h"
+
+#include "../contrib/json.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BinaryIndexDecodeArray(
+	BinaryIndexArrayType eType,
+	const std::vector<unsigned char> & vecBytes,
+	std::vector<double> & dValues
+) {
+	size_t sElementSize = BinaryIndexArrayElementSize(eType);
+	if (sElementSize == 0) {
+		_EXCEPTIONT("Invalid typed array type");
+	}
+
+	size_t sCount = vecBytes.size() / sElementSize;
+	dValues.resize(sCount);
+
+	for (size_t i = 0; i < sCount; i++) {
+		const unsigned char * pBytes = &(vecBytes[i * sElementSize]);
+
+		uint64_t uBits = 0;
+		for (size_t b = 0; b < sElementSize; b++) {
+			uBits |= static_cast<uint64_t>(pBytes[b]) << (8 * b);
+		}
+
+		if (eType == BinaryIndexArrayType_Float32) {
+			uint32_t uValue = static_cast<uint32_t>(uBits);
+			float flValue;
+			memcpy(&flValue, &uValue, sizeof(float));
+			dValues[i] = static_cast<double>(flValue);
+
+		} else if (eType == BinaryIndexArrayType_Float64) {
+			memcpy(&(dValues[i]), &uBits, sizeof(double));
+
+		// Unsigned integers are zero-extended
+		} else if (eType <= BinaryIndexArrayType_UInt64) {
+			dValues[i] = static_cast<double>(uBits);
+
+		// Signed integers are sign-extended
+		} else {
+			const int nShift = static_cast<int>(64 - 8 * sElementSize);
+			int64_t iValue;
+			uBits <<= nShift;
+			memcpy(&iValue, &uBits, sizeof(int64_t));
+			dValues[i] = static_cast<double>(iValue >> nShift);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// BinaryIndexWriter
+///////////////////////////////////////////////////////////////////////////////
+
+void BinaryIndexWriter::PutBigEndian(
+	uint64_t uValue,
+	int nBytes
+) {
+	for (int b = nBytes-1; b >= 0; b--) {
+		m_os.put(static_cast<char>((uValue >> (8 * b)) & 0xFF));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BinaryIndexWriter::PutCBORHead(
+	int iMajorType,
+	uint64_t uArgument
+) {
+	const int iMajor = iMajorType << 5;
+	if (uArgument < 24) {
+		m_os.put(static_cast<char>(iMajor | static_cast<int>(uArgument)));
+	} else if (uArgument <= 0xFF) {
+		m_os.put(static_cast<char>(iMajor | 24));
+		PutBigEndian(uArgument, 1);
+	} else if (uArgument <= 0xFFFF) {
+		m_os.put(static_cast<char>(iMajor | 25));
+		PutBigEndian(uArgument, 2);
+	} else if (uArgument <= 0xFFFFFFFF) {
+		m_os.put(static_cast<char>(iMajor | 26));
+		PutBigEndian(uArgument, 4);
+	} else {
+		m_os.put(static_cast<char>(iMajor | 27));
+		PutBigEndian(uArgument, 8);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BinaryIndexWriter::BeginMap(
+	size_t sSize
+) {
+	if (m_eFormat == BinaryIndexFormat_CBOR) {
+		PutCBORHead(5, sSize);
+
+	} else if (sSize < 16) {
+		m_os.put(static_cast<char>(0x80 | sSize));
+	} else if (sSize <= 0xFFFF) {
+		m_os.put(static_cast<char>(0xDE));
+		PutBigEndian(sSize, 2);
+	} else {
+		m_os.put(static_cast<char>(0xDF));
+		PutBigEndian(sSize, 4);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BinaryIndexWriter::BeginArray(
+	size_t sSize
+) {
+	if (m_eFormat == BinaryIndexFormat_CBOR) {
+		PutCBORHead(4, sSize);
+
+	} else if (sSize < 16) {
+		m_os.put(static_cast<char>(0x90 | sSize));
+	} else if (sSize <= 0xFFFF) {
+		m_os.put(static_cast<char>(0xDC));
+		PutBigEndian(sSize, 2);
+	} else {
+		m_os.put(static_cast<char>(0xDD));
+		PutBigEndian(sSize, 4);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BinaryIndexWriter::String(
+	const std::string & str
+) {
+	const size_t sSize = str.length();
+	if (m_eFormat == BinaryIndexFormat_CBOR) {
+		PutCBORHead(3, sSize);
+
+	} else if (sSize < 32) {
+		m_os.put(static_cast<char>(0xA0 | sSize));
+	} else if (sSize <= 0xFF) {
+		m_os.put(static_cast<char>(0xD9));
+		PutBigEndian(sSize, 1);
+	} else if (sSize <= 0xFFFF) {
+		m_os.put(static_cast<char>(0xDA));
+		PutBigEndian(sSize, 2);
+	} else {
+		m_os.put(static_cast<char>(0xDB));
+		PutBigEndian(sSize, 4);
+	}
+	m_os.write(str.data(), sSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BinaryIndexWriter::Value(
+	const nlohmann::json & j
+) {
+	if (m_eFormat == BinaryIndexFormat_CBOR) {
+		nlohmann::json::to_cbor(j, m_os);
+	} else {
+		nlohmann::json::to_msgpack(j, m_os);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BinaryIndexWriter::PutTypedArrayHead(
+	BinaryIndexArrayType eType,
+	size_t sBytes
+) {
+	// CBOR: tag followed by a byte string
+	if (m_eFormat == BinaryIndexFormat_CBOR) {
+		PutCBORHead(6, static_cast<uint64_t>(eType));
+		PutCBORHead(2, sBytes);
+
+	// MessagePack: ext 8, ext 16 or ext 32
+	} else {
+		if (sBytes <= 0xFF) {
+			m_os.put(static_cast<char>(0xC7));
+			PutBigEndian(sBytes, 1);
+		} else if (sBytes <= 0xFFFF) {
+			m_os.put(static_cast<char>(0xC8));
+			PutBigEndian(sBytes, 2);
+		} else {
+			m_os.put(static_cast<char>(0xC9));
+			PutBigEndian(sBytes, 4);
+		}
+		m_os.put(static_cast<char>(eType));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
@@ -0,0 +1,793 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    BinaryIndexCodec.h
+///	\version October 14, 2026
+///
+
+#ifndef _BINARYINDEXCODEC_H_
+#define _BINARYINDEXCODEC_H_
+
+#include "Exception.h"
+
+#include "../contrib/nlohmann/json_fwd.hpp"
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Binary encodings of the JSON index schema.
+///	</summary>
+enum BinaryIndexFormat {
+	BinaryIndexFormat_CBOR,
+	BinaryIndexFormat_MessagePack
+};
+
+///	<summary>
+///		Element types of typed coordinate arrays.  The values are the
+///		RFC 8746 CBOR tags for little-endian typed arrays, which are also
+///		used as the MessagePack extension type.
+///	</summary>
+enum BinaryIndexArrayType {
+	BinaryIndexArrayType_UInt8 = 64,
+	BinaryIndexArrayType_UInt16 = 69,
+	BinaryIndexArrayType_UInt32 = 70,
+	BinaryIndexArrayType_UInt64 = 71,
+	BinaryIndexArrayType_Int8 = 72,
+	BinaryIndexArrayType_Int16 = 77,
+	BinaryIndexArrayType_Int32 = 78,
+	BinaryIndexArrayType_Int64 = 79,
+	BinaryIndexArrayType_Float32 = 85,
+	BinaryIndexArrayType_Float64 = 86
+};
+
+///	<summary>
+///		The BinaryIndexArrayType of each element type, and the unsigned
+///		type of the same size used to write its bytes.
+///	</summary>
+template <typename T>
+struct BinaryIndexArrayTraits;
+
+template <>
+struct BinaryIndexArrayTraits<signed char> {
+	static const BinaryIndexArrayType Type = BinaryIndexArrayType_Int8;
+	typedef uint8_t Bits;
+};
+
+template <>
+struct BinaryIndexArrayTraits<short> {
+	static const BinaryIndexArrayType Type = BinaryIndexArrayType_Int16;
+	typedef uint16_t Bits;
+};
+
+template <>
+struct BinaryIndexArrayTraits<int> {
+	static const BinaryIndexArrayType Type = BinaryIndexArrayType_Int32;
+	typedef uint32_t Bits;
+};
+
+template <>
+struct BinaryIndexArrayTraits<long long> {
+	static const BinaryIndexArrayType Type = BinaryIndexArrayType_Int64;
+	typedef uint64_t Bits;
+};
+
+template <>
+struct BinaryIndexArrayTraits<unsigned char> {
+	static const BinaryIndexArrayType Type = BinaryIndexArrayType_UInt8;
+	typedef uint8_t Bits;
+};
+
+template <>
+struct BinaryIndexArrayTraits<unsigned short> {
+	static const BinaryIndexArrayType Type = BinaryIndexArrayType_UInt16;
+	typedef uint16_t Bits;
+};
+
+template <>
+struct BinaryIndexArrayTraits<unsigned int> {
+	static const BinaryIndexArrayType Type = BinaryIndexArrayType_UInt32;
+	typedef uint32_t Bits;
+};
+
+template <>
+struct BinaryIndexArrayTraits<unsigned long long> {
+	static const BinaryIndexArrayType Type = BinaryIndexArrayType_UInt64;
+	typedef uint64_t Bits;
+};
+
+template <>
+struct BinaryIndexArrayTraits<float> {
+	static const BinaryIndexArrayType Type = BinaryIndexArrayType_Float32;
+	typedef uint32_t Bits;
+};
+
+template <>
+struct BinaryIndexArrayTraits<double> {
+	static const BinaryIndexArrayType Type = BinaryIndexArrayType_Float64;
+	typedef uint64_t Bits;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the size in bytes of an element of a typed array, or zero if
+///		the type is not a BinaryIndexArrayType.
+///	</summary>
+inline size_t BinaryIndexArrayElementSize(
+	int iType
+) {
+	switch(iType) {
+		case BinaryIndexArrayType_UInt8:
+		case BinaryIndexArrayType_Int8:
+			return 1;
+		case BinaryIndexArrayType_UInt16:
+		case BinaryIndexArrayType_Int16:
+			return 2;
+		case BinaryIndexArrayType_UInt32:
+		case BinaryIndexArrayType_Int32:
+		case BinaryIndexArrayType_Float32:
+			return 4;
+		case BinaryIndexArrayType_UInt64:
+		case BinaryIndexArrayType_Int64:
+		case BinaryIndexArrayType_Float64:
+			return 8;
+		default:
+			return 0;
+	}
+}
+
+///	<summary>
+///		Decode the little-endian payload of a typed array as doubles.
+///	</summary>
+void BinaryIndexDecodeArray(
+	BinaryIndexArrayType eType,
+	const std::vector<unsigned char> & vecBytes,
+	std::vector<double> & dValues
+);
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A writer for CBOR or MessagePack documents with the same structure
+///		as a JSON index.  Containers are written with explicit sizes, so
+///		a document can be produced one entry at a time.  Scalars and small
+///		values are encoded with the nlohmann::json binary writers, while
+///		coordinate arrays are written as typed arrays.
+///	</summary>
+class BinaryIndexWriter {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	BinaryIndexWriter(
+		std::ostream & os,
+		BinaryIndexFormat eFormat
+	) :
+		m_os(os),
+		m_eFormat(eFormat)
+	{ }
+
+public:
+	///	<summary>
+	///		Begin a map with the given number of members.  Each member is
+	///		written as a key followed by a value.
+	///	</summary>
+	void BeginMap(size_t sSize);
+
+	///	<summary>
+	///		Begin an array with the given number of elements.
+	///	</summary>
+	void BeginArray(size_t sSize);
+
+	///	<summary>
+	///		Write a string, such as a map key.
+	///	</summary>
+	void String(const std::string & str);
+
+	///	<summary>
+	///		Write a JSON value.
+	///	</summary>
+	void Value(const nlohmann::json & j);
+
+	///	<summary>
+	///		Write a typed array of any element type with a
+	///		BinaryIndexArrayType.
+	///	</summary>
+	template <typename T>
+	void TypedArray(
+		const T * pValues,
+		size_t sCount
+	) {
+		PutTypedArray<T, typename BinaryIndexArrayTraits<T>::Bits>(
+			BinaryIndexArrayTraits<T>::Type, pValues, sCount);
+	}
+
+protected:
+	///	<summary>
+	///		Write an unsigned integer in big-endian byte order.
+	///	</summary>
+	void PutBigEndian(uint64_t uValue, int nBytes);
+
+	///	<summary>
+	///		Write a CBOR initial byte and argument.
+	///	</summary>
+	void PutCBORHead(int iMajorType, uint64_t uArgument);
+
+	///	<summary>
+	///		Write the head of a typed array with the given payload size.
+	///	</summary>
+	void PutTypedArrayHead(BinaryIndexArrayType eType, size_t sBytes);
+
+	///	<summary>
+	///		Write a typed array with elements in little-endian byte order.
+	///	</summary>
+	template <typename T, typename U>
+	void PutTypedArray(
+		BinaryIndexArrayType eType,
+		const T * pValues,
+		size_t sCount
+	) {
+		PutTypedArrayHead(eType, sCount * sizeof(U));
+		for (size_t i = 0; i < sCount; i++) {
+			U uValue;
+			memcpy(&uValue, &(pValues[i]), sizeof(U));
+			for (int b = 0; b < sizeof(U); b++) {
+				m_os.put(static_cast<char>((uValue >> (8 * b)) & 0xFF));
+			}
+		}
+	}
+
+protected:
+	///	<summary>
+	///		Output stream.
+	///	</summary>
+	std::ostream & m_os;
+
+	///	<summary>
+	///		Output format.
+	///	</summary>
+	BinaryIndexFormat m_eFormat;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A reader for CBOR or MessagePack documents that reports their
+///		contents through the nlohmann::json SAX interface.  Typed arrays
+///		are passed to an additional typed_array callback.  Map keys must
+///		be strings.
+///	</summary>
+template <class SAX>
+class BinaryIndexReader {
+
+public:
+	///	<summary>
+	///		Maximum nesting depth of containers.
+	///	</summary>
+	static const int MaxDepth = 256;
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	BinaryIndexReader(
+		std::istream & is,
+		BinaryIndexFormat eFormat,
+		const std::string & strFilename
+	) :
+		m_is(is),
+		m_eFormat(eFormat),
+		m_strFilename(strFilename)
+	{ }
+
+	///	<summary>
+	///		Parse a single document, which must make up the whole stream.
+	///	</summary>
+	void Parse(SAX & sax) {
+		if (m_eFormat == BinaryIndexFormat_CBOR) {
+			ParseCBOR(sax, 0, GetByte());
+		} else {
+			ParseMessagePack(sax, 0, GetByte());
+		}
+		if (m_is.peek() != std::istream::traits_type::eof()) {
+			_EXCEPTION1("Unexpected data after end of document in \"%s\"",
+				m_strFilename.c_str());
+		}
+	}
+
+protected:
+	///	<summary>
+	///		Read a single byte.
+	///	</summary>
+	int GetByte() {
+		int iByte = m_is.get();
+		if (iByte == std::istream::traits_type::eof()) {
+			_EXCEPTION1("Unexpected end of file in \"%s\"",
+				m_strFilename.c_str());
+		}
+		return iByte;
+	}
+
+	///	<summary>
+	///		Read an unsigned integer in big-endian byte order.
+	///	</summary>
+	uint64_t GetBigEndian(int nBytes) {
+		uint64_t uValue = 0;
+		for (int b = 0; b < nBytes; b++) {
+			uValue = (uValue << 8) | static_cast<uint64_t>(GetByte());
+		}
+		return uValue;
+	}
+
+	///	<summary>
+	///		Read a sequence of bytes onto the end of a container.
+	///	</summary>
+	template <typename T>
+	void GetBytes(uint64_t uSize, T & bytes) {
+		const size_t ChunkSize = 65536;
+		while (uSize > 0) {
+			size_t sChunk = (uSize < ChunkSize)?(static_cast<size_t>(uSize)):(ChunkSize);
+			size_t sOffset = bytes.size();
+			bytes.resize(sOffset + sChunk);
+			m_is.read(reinterpret_cast<char *>(&(bytes[sOffset])), sChunk);
+			if (static_cast<size_t>(m_is.gcount()) != sChunk) {
+				_EXCEPTION1("Unexpected end of file in \"%s\"",
+					m_strFilename.c_str());
+			}
+			uSize -= sChunk;
+		}
+	}
+
+	///	<summary>
+	///		Report a typed array.
+	///	</summary>
+	void TypedArray(SAX & sax, int iType, uint64_t uSize) {
+		size_t sElementSize = BinaryIndexArrayElementSize(iType);
+		if (sElementSize == 0) {
+			_EXCEPTION2("Unsupported extension type %i in \"%s\"",
+				iType, m_strFilename.c_str());
+		}
+		if (uSize % sElementSize != 0) {
+			_EXCEPTION1("Truncated typed array in \"%s\"",
+				m_strFilename.c_str());
+		}
+		std::vector<unsigned char> vecBytes;
+		GetBytes(uSize, vecBytes);
+		sax.typed_array(static_cast<BinaryIndexArrayType>(iType), vecBytes);
+	}
+
+	///	<summary>
+	///		Check the nesting depth of a new container.
+	///	</summary>
+	void CheckDepth(int nDepth) {
+		if (nDepth >= MaxDepth) {
+			_EXCEPTION1("Maximum nesting depth exceeded in \"%s\"",
+				m_strFilename.c_str());
+		}
+	}
+
+	///	<summary>
+	///		Read the argument of a CBOR data item.
+	///	</summary>
+	uint64_t GetCBORArgument(int iInfo) {
+		if (iInfo < 24) {
+			return static_cast<uint64_t>(iInfo);
+		} else if (iInfo == 24) {
+			return GetBigEndian(1);
+		} else if (iInfo == 25) {
+			return GetBigEndian(2);
+		} else if (iInfo == 26) {
+			return GetBigEndian(4);
+		} else if (iInfo == 27) {
+			return GetBigEndian(8);
+		}
+		_EXCEPTION1("Invalid CBOR data item in \"%s\"",
+			m_strFilename.c_str());
+	}
+
+	///	<summary>
+	///		Read a CBOR text string, possibly of indefinite length.
+	///	</summary>
+	void GetCBORString(int iInitial, std::string & str) {
+		if ((iInitial >> 5) != 3) {
+			_EXCEPTION1("Expected CBOR text string in \"%s\"",
+				m_strFilename.c_str());
+		}
+		str.clear();
+		if ((iInitial & 0x1F) != 31) {
+			GetBytes(GetCBORArgument(iInitial & 0x1F), str);
+			return;
+		}
+		for (;;) {
+			int iChunk = GetByte();
+			if (iChunk == 0xFF) {
+				break;
+			}
+			if (((iChunk >> 5) != 3) || ((iChunk & 0x1F) == 31)) {
+				_EXCEPTION1("Invalid CBOR text string chunk in \"%s\"",
+					m_strFilename.c_str());
+			}
+			GetBytes(GetCBORArgument(iChunk & 0x1F), str);
+		}
+	}
+
+	///	<summary>
+	///		Parse a CBOR data item given its initial byte.
+	///	</summary>
+	void ParseCBOR(SAX & sax, int nDepth, int iInitial) {
+		const int iMajorType = iInitial >> 5;
+		const int iInfo = iInitial & 0x1F;
+
+		switch (iMajorType) {
+
+		// Unsigned integer
+		case 0:
+			sax.number_unsigned(GetCBORArgument(iInfo));
+			return;
+
+		// Negative integer
+		case 1:
+		{
+			uint64_t uValue = GetCBORArgument(iInfo);
+			if (uValue > static_cast<uint64_t>(INT64_MAX)) {
+				_EXCEPTION1("CBOR negative integer out of range in \"%s\"",
+					m_strFilename.c_str());
+			}
+			sax.number_integer(-1 - static_cast<int64_t>(uValue));
+			return;
+		}
+
+		// Byte string
+		case 2:
+			_EXCEPTION1("Unexpected CBOR byte string in \"%s\"",
+				m_strFilename.c_str());
+
+		// Text string
+		case 3:
+		{
+			std::string str;
+			GetCBORString(iInitial, str);
+			sax.string(str);
+			return;
+		}
+
+		// Array
+		case 4:
+		{
+			CheckDepth(nDepth);
+			if (iInfo == 31) {
+				sax.start_array(static_cast<size_t>(-1));
+				for (;;) {
+					int iNext = GetByte();
+					if (iNext == 0xFF) {
+						break;
+					}
+					ParseCBOR(sax, nDepth+1, iNext);
+				}
+			} else {
+				uint64_t uSize = GetCBORArgument(iInfo);
+				sax.start_array(static_cast<size_t>(uSize));
+				for (uint64_t i = 0; i < uSize; i++) {
+					ParseCBOR(sax, nDepth+1, GetByte());
+				}
+			}
+			sax.end_array();
+			return;
+		}
+
+		// Map
+		case 5:
+		{
+			CheckDepth(nDepth);
+			std::string strKey;
+			if (iInfo == 31) {
+				sax.start_object(static_cast<size_t>(-1));
+				for (;;) {
+					int iNext = GetByte();
+					if (iNext == 0xFF) {
+						break;
+					}
+					GetCBORString(iNext, strKey);
+					sax.key(strKey);
+					ParseCBOR(sax, nDepth+1, GetByte());
+				}
+			} else {
+				uint64_t uSize = GetCBORArgument(iInfo);
+				sax.start_object(static_cast<size_t>(uSize));
+				for (uint64_t i = 0; i < uSize; i++) {
+					GetCBORString(GetByte(), strKey);
+					sax.key(strKey);
+					ParseCBOR(sax, nDepth+1, GetByte());
+				}
+			}
+			sax.end_object();
+			return;
+		}
+
+		// Tag; typed arrays are handled and all other tags are ignored
+		case 6:
+		{
+			uint64_t uTag = GetCBORArgument(iInfo);
+			int iNext = GetByte();
+			if (BinaryIndexArrayElementSize(static_cast<int>(uTag)) != 0) {
+				if (((iNext >> 5) != 2) || ((iNext & 0x1F) == 31)) {
+					_EXCEPTION1("Invalid CBOR typed array in \"%s\"",
+						m_strFilename.c_str());
+				}
+				TypedArray(sax,
+					static_cast<int>(uTag), GetCBORArgument(iNext & 0x1F));
+				return;
+			}
+			ParseCBOR(sax, nDepth, iNext);
+			return;
+		}
+
+		// Simple values and floating point
+		case 7:
+		{
+			static const std::string strEmpty;
+			if (iInfo == 20) {
+				sax.boolean(false);
+			} else if (iInfo == 21) {
+				sax.boolean(true);
+			} else if ((iInfo == 22) || (iInfo == 23)) {
+				sax.null();
+			} else if (iInfo == 25) {
+				sax.number_float(HalfToDouble(
+					static_cast<uint16_t>(GetBigEndian(2))), strEmpty);
+			} else if (iInfo == 26) {
+				uint32_t uBits = static_cast<uint32_t>(GetBigEndian(4));
+				float flValue;
+				memcpy(&flValue, &uBits, sizeof(float));
+				sax.number_float(static_cast<double>(flValue), strEmpty);
+			} else if (iInfo == 27) {
+				uint64_t uBits = GetBigEndian(8);
+				double dValue;
+				memcpy(&dValue, &uBits, sizeof(double));
+				sax.number_float(dValue, strEmpty);
+			} else {
+				_EXCEPTION1("Invalid CBOR simple value in \"%s\"",
+					m_strFilename.c_str());
+			}
+			return;
+		}
+		}
+	}
+
+	///	<summary>
+	///		Convert an IEEE 754 half-precision value to double.
+	///	</summary>
+	static double HalfToDouble(uint16_t uHalf) {
+		const int iExponent = (uHalf >> 10) & 0x1F;
+		const int iMantissa = uHalf & 0x3FF;
+		double dValue;
+		if (iExponent == 0) {
+			dValue = std::ldexp(static_cast<double>(iMantissa), -24);
+		} else if (iExponent != 31) {
+			dValue = std::ldexp(static_cast<double>(iMantissa + 1024), iExponent - 25);
+		} else if (iMantissa == 0) {
+			dValue = std::numeric_limits<double>::infinity();
+		} else {
+			dValue = std::numeric_limits<double>::quiet_NaN();
+		}
+		return ((uHalf & 0x8000) != 0)?(-dValue):(dValue);
+	}
+
+	///	<summary>
+	///		Read a MessagePack string.
+	///	</summary>
+	void GetMessagePackString(int iInitial, std::string & str) {
+		uint64_t uSize;
+		if ((iInitial >= 0xA0) && (iInitial <= 0xBF)) {
+			uSize = static_cast<uint64_t>(iInitial & 0x1F);
+		} else if (iInitial == 0xD9) {
+			uSize = GetBigEndian(1);
+		} else if (iInitial == 0xDA) {
+			uSize = GetBigEndian(2);
+		} else if (iInitial == 0xDB) {
+			uSize = GetBigEndian(4);
+		} else {
+			_EXCEPTION1("Expected MessagePack string in \"%s\"",
+				m_strFilename.c_str());
+		}
+		str.clear();
+		GetBytes(uSize, str);
+	}
+
+	///	<summary>
+	///		Parse the elements of a MessagePack array.
+	///	</summary>
+	void ParseMessagePackArray(SAX & sax, int nDepth, uint64_t uSize) {
+		CheckDepth(nDepth);
+		sax.start_array(static_cast<size_t>(uSize));
+		for (uint64_t i = 0; i < uSize; i++) {
+			ParseMessagePack(sax, nDepth+1, GetByte());
+		}
+		sax.end_array();
+	}
+
+	///	<summary>
+	///		Parse the members of a MessagePack map.
+	///	</summary>
+	void ParseMessagePackMap(SAX & sax, int nDepth, uint64_t uSize) {
+		CheckDepth(nDepth);
+		std::string strKey;
+		sax.start_object(static_cast<size_t>(uSize));
+		for (uint64_t i = 0; i < uSize; i++) {
+			GetMessagePackString(GetByte(), strKey);
+			sax.key(strKey);
+			ParseMessagePack(sax, nDepth+1, GetByte());
+		}
+		sax.end_object();
+	}
+
+	///	<summary>
+	///		Parse a MessagePack value given its initial byte.
+	///	</summary>
+	void ParseMessagePack(SAX & sax, int nDepth, int iInitial) {
+		static const std::string strEmpty;
+
+		// Positive and negative fixint
+		if (iInitial <= 0x7F) {
+			sax.number_unsigned(static_cast<uint64_t>(iInitial));
+			return;
+		}
+		if (iInitial >= 0xE0) {
+			sax.number_integer(static_cast<int64_t>(iInitial) - 256);
+			return;
+		}
+
+		// fixmap, fixarray and fixstr
+		if (iInitial <= 0x8F) {
+			ParseMessagePackMap(sax, nDepth, iInitial & 0x0F);
+			return;
+		}
+		if (iInitial <= 0x9F) {
+			ParseMessagePackArray(sax, nDepth, iInitial & 0x0F);
+			return;
+		}
+		if (iInitial <= 0xBF) {
+			std::string str;
+			GetMessagePackString(iInitial, str);
+			sax.string(str);
+			return;
+		}
+
+		switch (iInitial) {
+		case 0xC0:
+			sax.null();
+			return;
+		case 0xC2:
+			sax.boolean(false);
+			return;
+		case 0xC3:
+			sax.boolean(true);
+			return;
+
+		// ext 8, ext 16 and ext 32
+		case 0xC7:
+		case 0xC8:
+		case 0xC9:
+		{
+			uint64_t uSize = GetBigEndian(1 << (iInitial - 0xC7));
+			int iType = GetByte();
+			TypedArray(sax, iType, uSize);
+			return;
+		}
+
+		// float 32 and float 64
+		case 0xCA:
+		{
+			uint32_t uBits = static_cast<uint32_t>(GetBigEndian(4));
+			float flValue;
+			memcpy(&flValue, &uBits, sizeof(float));
+			sax.number_float(static_cast<double>(flValue), strEmpty);
+			return;
+		}
+		case 0xCB:
+		{
+			uint64_t uBits = GetBigEndian(8);
+			double dValue;
+			memcpy(&dValue, &uBits, sizeof(double));
+			sax.number_float(dValue, strEmpty);
+			return;
+		}
+
+		// uint 8 through uint 64
+		case 0xCC:
+		case 0xCD:
+		case 0xCE:
+		case 0xCF:
+			sax.number_unsigned(GetBigEndian(1 << (iInitial - 0xCC)));
+			return;
+
+		// int 8 through int 64
+		case 0xD0:
+		case 0xD1:
+		case 0xD2:
+		case 0xD3:
+		{
+			int nBytes = 1 << (iInitial - 0xD0);
+			uint64_t uValue = GetBigEndian(nBytes);
+			if (nBytes < 8) {
+				uint64_t uSign = static_cast<uint64_t>(1) << (8 * nBytes - 1);
+				uValue = (uValue ^ uSign) - uSign;
+			}
+			sax.number_integer(static_cast<int64_t>(uValue));
+			return;
+		}
+
+		// fixext 1 through fixext 16
+		case 0xD4:
+		case 0xD5:
+		case 0xD6:
+		case 0xD7:
+		case 0xD8:
+		{
+			int iType = GetByte();
+			TypedArray(sax, iType, static_cast<uint64_t>(1) << (iInitial - 0xD4));
+			return;
+		}
+
+		// str 8, str 16 and str 32
+		case 0xD9:
+		case 0xDA:
+		case 0xDB:
+		{
+			std::string str;
+			GetMessagePackString(iInitial, str);
+			sax.string(str);
+			return;
+		}
+
+		// array 16 and array 32
+		case 0xDC:
+			ParseMessagePackArray(sax, nDepth, GetBigEndian(2));
+			return;
+		case 0xDD:
+			ParseMessagePackArray(sax, nDepth, GetBigEndian(4));
+			return;
+
+		// map 16 and map 32
+		case 0xDE:
+			ParseMessagePackMap(sax, nDepth, GetBigEndian(2));
+			return;
+		case 0xDF:
+			ParseMessagePackMap(sax, nDepth, GetBigEndian(4));
+			return;
+		}
+
+		_EXCEPTION2("Unsupported MessagePack type 0x%02x in \"%s\"",
+			iInitial, m_strFilename.c_str());
+	}
+
+protected:
+	///	<summary>
+	///		Input stream.
+	///	</summary>
+	std::istream & m_is;
+
+	///	<summary>
+	///		Input format.
+	///	</summary>
+	BinaryIndexFormat m_eFormat;
+
+	///	<summary>
+	///		Name of the file being read, for error messages.
+	///	</summary>
+	std::string m_strFilename;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
@@ -0,0 +1,223 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    CFTimeUnits.cpp
+///	\version October 14, 2026
+///
+
+#include "CFTimeUnits.h"
+#include "STLStringHelper.h"
+
+#include <cmath>
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string CFTimeUnits::Parse(
+	const std::string & strUnits,
+	const std::string & strCalendar
+) {
+	// Calendar defaults to standard, as in the CF conventions
+	Time::CalendarType eCalendarType = Time::CalendarStandard;
+	if (strCalendar != "") {
+		eCalendarType = Time::CalendarTypeFromString(strCalendar);
+		if (eCalendarType == Time::CalendarUnknown) {
+			return std::string("Unknown calendar \"") + strCalendar
+				+ std::string("\"");
+		}
+	}
+
+	// Units are "<unit> since <reference time>"
+	size_t sBegin = strUnits.find_first_not_of(' ');
+	size_t sSince = strUnits.find(" since ");
+	if ((sBegin == std::string::npos) ||
+	    (sSince == std::string::npos) ||
+	    (sSince < sBegin)
+	) {
+		return std::string("Unknown time units \"") + strUnits
+			+ std::string("\", expected \"<unit> since <time>\"");
+	}
+
+	std::string strUnit = strUnits.substr(sBegin, sSince - sBegin);
+	STLStringHelper::ToLower(strUnit);
+	if ((strUnit == "months") || (strUnit == "month")) {
+		m_eOffsetUnit = OffsetUnitMonths;
+		m_llUnitMicroSeconds = 0;
+	} else if ((strUnit == "days") || (strUnit == "day") || (strUnit == "d")) {
+		m_eOffsetUnit = OffsetUnitDays;
+		m_llUnitMicroSeconds = 86400000000LL;
+	} else if ((strUnit == "hours") || (strUnit == "hour") || (strUnit == "h")) {
+		m_eOffsetUnit = OffsetUnitHours;
+		m_llUnitMicroSeconds = 3600000000LL;
+	} else if ((strUnit == "minutes") || (strUnit == "minute") || (strUnit == "min")) {
+		m_eOffsetUnit = OffsetUnitMinutes;
+		m_llUnitMicroSeconds = 60000000LL;
+	} else if ((strUnit == "seconds") || (strUnit == "second") || (strUnit == "s")) {
+		m_eOffsetUnit = OffsetUnitSeconds;
+		m_llUnitMicroSeconds = 1000000LL;
+	} else {
+		return std::string("Unknown time unit \"") + strUnit
+			+ std::string("\" in \"") + strUnits + std::string("\"");
+	}
+
+	std::string strReference = strUnits.substr(sSince + 7);
+	size_t sRefBegin = strReference.find_first_not_of(' ');
+	size_t sRefEnd = strReference.find_last_not_of(' ');
+	if (sRefBegin == std::string::npos) {
+		return std::string("Missing reference time in \"") + strUnits
+			+ std::string("\"");
+	}
+	strReference = strReference.substr(sRefBegin, sRefEnd - sRefBegin + 1);
+
+	m_timeReference = Time(eCalendarType);
+	m_timeReference.FromFormattedString(strReference);
+	m_llReference = m_timeReference.GetEpochMicroSeconds();
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Convert offsets in a fixed unit to TimeKeys, rounding to the
+///		nearest microsecond.
+///	</summary>
+template <typename T>
+static void OffsetsToTimeKeys(
+	const T * pOffsets,
+	size_t sCount,
+	long long llReference,
+	double dUnitMicroSeconds,
+	long long * pllKeys
+) {
+	for (size_t i = 0; i < sCount; i++) {
+		pllKeys[i] = llReference + static_cast<long long>(
+			std::floor(static_cast<double>(pOffsets[i]) * dUnitMicroSeconds + 0.5));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Add whole months to a reference time, which is not a fixed
+///		number of microseconds.
+///	</summary>
+template <typename T>
+static void MonthOffsetsToTimeKeys(
+	const T * pOffsets,
+	size_t sCount,
+	const Time & timeReference,
+	long long * pllKeys
+) {
+	for (size_t i = 0; i < sCount; i++) {
+		double dOffset = static_cast<double>(pOffsets[i]);
+		if (std::fabs(fmod(dOffset, 1.0)) > 1.0e-14) {
+			_EXCEPTIONT("Only integer values accepted for time in format \"months since ...\"");
+		}
+		Time time(timeReference);
+		time.AddMonths(static_cast<int>(dOffset));
+		pllKeys[i] = time.GetEpochMicroSeconds();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CFTimeUnits::ToTimeKeys(
+	const double * pdOffsets,
+	size_t sCount,
+	long long * pllKeys
+) const {
+	if (m_eOffsetUnit == OffsetUnitMonths) {
+		MonthOffsetsToTimeKeys(pdOffsets, sCount, m_timeReference, pllKeys);
+	} else {
+		OffsetsToTimeKeys(pdOffsets, sCount, m_llReference,
+			static_cast<double>(m_llUnitMicroSeconds), pllKeys);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CFTimeUnits::ToTimeKeys(
+	const float * pflOffsets,
+	size_t sCount,
+	long long * pllKeys
+) const {
+	if (m_eOffsetUnit == OffsetUnitMonths) {
+		MonthOffsetsToTimeKeys(pflOffsets, sCount, m_timeReference, pllKeys);
+	} else {
+		OffsetsToTimeKeys(pflOffsets, sCount, m_llReference,
+			static_cast<double>(m_llUnitMicroSeconds), pllKeys);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CFTimeUnits::ToTimeKeys(
+	const int * piOffsets,
+	size_t sCount,
+	long long * pllKeys
+) const {
+	if (m_eOffsetUnit == OffsetUnitMonths) {
+		MonthOffsetsToTimeKeys(piOffsets, sCount, m_timeReference, pllKeys);
+	} else {
+		for (size_t i = 0; i < sCount; i++) {
+			pllKeys[i] = m_llReference
+				+ static_cast<long long>(piOffsets[i]) * m_llUnitMicroSeconds;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+void CFTimeUnits::ToTimeKeys(
+	const T * pOffsets,
+	size_t sCount,
+	long long * pllKeys
+) const {
+	if (m_eOffsetUnit == OffsetUnitMonths) {
+		MonthOffsetsToTimeKeys(pOffsets, sCount, m_timeReference, pllKeys);
+	} else {
+		for (size_t i = 0; i < sCount; i++) {
+			pllKeys[i] = m_llReference
+				+ static_cast<long long>(pOffsets[i]) * m_llUnitMicroSeconds;
+		}
+	}
+}
+
+template void CFTimeUnits::ToTimeKeys(
+	const signed char *, size_t, long long *) const;
+template void CFTimeUnits::ToTimeKeys(
+	const short *, size_t, long long *) const;
+template void CFTimeUnits::ToTimeKeys(
+	const unsigned char *, size_t, long long *) const;
+template void CFTimeUnits::ToTimeKeys(
+	const unsigned short *, size_t, long long *) const;
+template void CFTimeUnits::ToTimeKeys(
+	const unsigned int *, size_t, long long *) const;
+template void CFTimeUnits::ToTimeKeys(
+	const long long *, size_t, long long *) const;
+template void CFTimeUnits::ToTimeKeys(
+	const unsigned long long *, size_t, long long *) const;
+
+///////////////////////////////////////////////////////////////////////////////
+
+Time CFTimeUnits::ToTime(
+	double dOffset
+) const {
+	long long llKey;
+	ToTimeKeys(&dOffset, 1, &llKey);
+	return TimeFromKey(llKey, GetCalendarType());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+Time CFTimeUnits::TimeFromKey(
+	long long llKey,
+	Time::CalendarType eCalendarType
+) {
+	Time time(eCalendarType);
+	time.FromEpochMicroSeconds(llKey);
+	return time;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
@@ -0,0 +1,194 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    CFTimeUnits.h
+///	\version October 14, 2026
+///
+
+#ifndef _CFTIMEUNITS_H_
+#define _CFTIMEUNITS_H_
+
+#include "TimeObj.h"
+#include "DataArray1D.h"
+
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A parsed CF-compliant time units string, such as
+///		"days since 1850-01-01 00:00:00", with its calendar.  The reference
+///		time is parsed once, so that all offsets of a time coordinate can
+///		be converted without reparsing the units.  Offsets are converted
+///		to TimeKeys, the number of microseconds since 1970-01-01 in the
+///		calendar, with closed-form calendar arithmetic.
+///	</summary>
+class CFTimeUnits {
+
+public:
+	///	<summary>
+	///		Unit of the time offsets.
+	///	</summary>
+	enum OffsetUnit {
+		OffsetUnitMonths,
+		OffsetUnitDays,
+		OffsetUnitHours,
+		OffsetUnitMinutes,
+		OffsetUnitSeconds
+	};
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	CFTimeUnits() :
+		m_eOffsetUnit(OffsetUnitDays),
+		m_llUnitMicroSeconds(86400000000LL),
+		m_llReference(0)
+	{ }
+
+	///	<summary>
+	///		Parse the units and calendar.  Returns an error message if the
+	///		units are not of the form "<unit> since <reference time>" or
+	///		the calendar is not recognized.
+	///	</summary>
+	std::string Parse(
+		const std::string & strUnits,
+		const std::string & strCalendar
+	);
+
+public:
+	///	<summary>
+	///		Get the calendar.
+	///	</summary>
+	Time::CalendarType GetCalendarType() const {
+		return m_timeReference.GetCalendarType();
+	}
+
+	///	<summary>
+	///		Get the reference time.
+	///	</summary>
+	const Time & GetReferenceTime() const {
+		return m_timeReference;
+	}
+
+	///	<summary>
+	///		Convert an offset from the reference time to a Time.  Only
+	///		integer offsets are accepted in months; other offsets are
+	///		rounded to the nearest microsecond.
+	///	</summary>
+	Time ToTime(
+		double dOffset
+	) const;
+
+	///	<summary>
+	///		Convert sCount offsets to TimeKeys.  Offsets in units other
+	///		than months are converted in a single branch-free pass.
+	///	</summary>
+	void ToTimeKeys(
+		const double * pdOffsets,
+		size_t sCount,
+		long long * pllKeys
+	) const;
+
+	///	<summary>
+	///		Convert sCount offsets to TimeKeys.
+	///	</summary>
+	void ToTimeKeys(
+		const float * pflOffsets,
+		size_t sCount,
+		long long * pllKeys
+	) const;
+
+	///	<summary>
+	///		Convert sCount offsets to TimeKeys.  Integer offsets are
+	///		converted exactly.
+	///	</summary>
+	void ToTimeKeys(
+		const int * piOffsets,
+		size_t sCount,
+		long long * pllKeys
+	) const;
+
+	///	<summary>
+	///		Convert sCount offsets of another integer type to TimeKeys.
+	///		Integer offsets are converted exactly.
+	///	</summary>
+	template <typename T>
+	void ToTimeKeys(
+		const T * pOffsets,
+		size_t sCount,
+		long long * pllKeys
+	) const;
+
+	///	<summary>
+	///		Convert an array of offsets to TimeKeys.
+	///	</summary>
+	void ToTimeKeys(
+		const DataArray1D<double> & dOffsets,
+		DataArray1D<long long> & llKeys
+	) const {
+		llKeys.Allocate(dOffsets.GetRows());
+		ToTimeKeys(
+			static_cast<const double *>(dOffsets),
+			dOffsets.GetRows(),
+			static_cast<long long *>(llKeys));
+	}
+
+	///	<summary>
+	///		Convert an array of offsets to TimeKeys.
+	///	</summary>
+	template <typename T>
+	void ToTimeKeys(
+		const std::vector<T> & vecOffsets,
+		std::vector<long long> & vecKeys
+	) const {
+		vecKeys.resize(vecOffsets.size());
+		ToTimeKeys(vecOffsets.data(), vecOffsets.size(), vecKeys.data());
+	}
+
+public:
+	///	<summary>
+	///		Get the TimeKey of a Time, which orders Times of the same
+	///		calendar chronologically.
+	///	</summary>
+	static long long TimeKey(
+		const Time & time
+	) {
+		return time.GetEpochMicroSeconds();
+	}
+
+	///	<summary>
+	///		Get the Time of the given calendar with the given TimeKey.
+	///	</summary>
+	static Time TimeFromKey(
+		long long llKey,
+		Time::CalendarType eCalendarType
+	);
+
+protected:
+	///	<summary>
+	///		Unit of the time offsets.
+	///	</summary>
+	OffsetUnit m_eOffsetUnit;
+
+	///	<summary>
+	///		Number of microseconds in the offset unit, or zero for months.
+	///	</summary>
+	long long m_llUnitMicroSeconds;
+
+	///	<summary>
+	///		Reference time.
+	///	</summary>
+	Time m_timeReference;
+
+	///	<summary>
+	///		TimeKey of the reference time.
+	///	</summary>
+	long long m_llReference;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
@@ -0,0 +1,634 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    ChunkReferences.cpp
+///	\version October 15, 2026
+///
+
+#include "ChunkReferences.h"
+#include "ClassicNcFile.h"
+#include "RemoteFile.h"
+#include "../contrib/json.hpp"
+
+#if defined(HYPERION_HDF5)
+#include "NcFilePool.h"
+#include "NetCDFUtilities.h"
+#include "netcdf.h"
+#include "hdf5.h"
+#include <mutex>
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the Zarr data type of a NetCDF type, without its byte order,
+///		or an empty string if the type has none.
+///	</summary>
+static std::string ZarrDataType(
+	int nType
+) {
+	switch (nType) {
+		case 1: return std::string("i1");
+		case 2: return std::string("S1");
+		case 3: return std::string("i2");
+		case 4: return std::string("i4");
+		case 5: return std::string("f4");
+		case 6: return std::string("f8");
+		case 7: return std::string("u1");
+		case 8: return std::string("u2");
+		case 9: return std::string("u4");
+		case 10: return std::string("i8");
+		case 11: return std::string("u8");
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the Zarr data type of a NetCDF type with the given byte order;
+///		single bytes have no byte order.
+///	</summary>
+static std::string ZarrDataType(
+	int nType,
+	bool fBigEndian
+) {
+	std::string strType = ZarrDataType(nType);
+	if (strType == "") {
+		return strType;
+	}
+	if ((strType[1] == '1') || (strType[0] == 'S')) {
+		return std::string("|") + strType;
+	}
+	return std::string((fBigEndian)?(">"):("<")) + strType;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get a numeric value as JSON, where Zarr writes non-finite values
+///		as strings.
+///	</summary>
+static nlohmann::json ZarrNumber(
+	double dValue
+) {
+	if (std::isnan(dValue)) {
+		return nlohmann::json("NaN");
+	}
+	if (std::isinf(dValue)) {
+		return nlohmann::json((dValue > 0.0)?("Infinity"):("-Infinity"));
+	}
+	if ((dValue == std::floor(dValue)) && (std::fabs(dValue) < 9.0e15)) {
+		return nlohmann::json(static_cast<long long>(dValue));
+	}
+	return nlohmann::json(dValue);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write attributes as the members of a .zattrs object.
+///	</summary>
+static void ChunkAttributesToJSON(
+	const ChunkAttributeVector & vecAttributes,
+	nlohmann::json & j
+) {
+	for (size_t a = 0; a < vecAttributes.size(); a++) {
+		const ChunkAttribute & att = vecAttributes[a];
+		if (att.m_fText) {
+			j[att.m_strName] = att.m_strText;
+		} else if (att.m_vecValues.size() == 1) {
+			j[att.m_strName] = ZarrNumber(att.m_vecValues[0]);
+		} else {
+			nlohmann::json jValues = nlohmann::json::array();
+			for (size_t i = 0; i < att.m_vecValues.size(); i++) {
+				jValues.push_back(ZarrNumber(att.m_vecValues[i]));
+			}
+			j[att.m_strName] = jValues;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Copy attributes of a classic format file.
+///	</summary>
+static void ChunkAttributesFromClassic(
+	const ClassicNcAttributeVector & vecClassicAttributes,
+	ChunkAttributeVector & vecAttributes
+) {
+	for (size_t a = 0; a < vecClassicAttributes.size(); a++) {
+		const ClassicNcAttribute & attClassic = vecClassicAttributes[a];
+
+		ChunkAttribute att;
+		att.m_strName = attClassic.m_strName;
+		att.m_fText = (attClassic.m_nType == 2);
+		if (att.m_fText) {
+			attClassic.AsString(att.m_strText);
+		} else {
+			att.m_vecValues.resize(attClassic.m_sCount);
+			for (size_t i = 0; i < attClassic.m_sCount; i++) {
+				attClassic.GetValue(i, att.m_vecValues[i]);
+			}
+		}
+		vecAttributes.push_back(att);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Take _FillValue from the attributes of a variable.
+///	</summary>
+static void FillValueFromAttributes(
+	VariableChunkLayout & layout
+) {
+	for (size_t a = 0; a < layout.m_vecAttributes.size(); a++) {
+		const ChunkAttribute & att = layout.m_vecAttributes[a];
+		if ((att.m_strName == "_FillValue") &&
+		    !att.m_fText &&
+		    (att.m_vecValues.size() == 1)
+		) {
+			layout.m_fHasFillValue = true;
+			layout.m_dFillValue = att.m_vecValues[0];
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string FileChunkReferences::FromFile(
+	const std::string & strFilename
+) {
+	m_strFilename = strFilename;
+	m_vecAttributes.clear();
+	m_vecVariables.clear();
+	m_vecSkipped.clear();
+
+	std::string strError;
+	if (FromClassicFile(strFilename, strError)) {
+		return strError;
+	}
+	return FromNetCDF4File(strFilename);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool FileChunkReferences::FromClassicFile(
+	const std::string & strFilename,
+	std::string & strError
+) {
+	ClassicNcFile ncclassic;
+	ClassicNcStatus eStatus = ncclassic.Open(strFilename);
+	if (eStatus == ClassicNcStatus_NotClassic) {
+		return false;
+	}
+	if (eStatus == ClassicNcStatus_Error) {
+		strError = std::string("Unable to decode \"") + strFilename
+			+ std::string("\": ") + ncclassic.GetError();
+		return true;
+	}
+
+	ChunkAttributesFromClassic(ncclassic.GetAttributes(), m_vecAttributes);
+
+	const std::vector<ClassicNcDimension> & vecDimensions =
+		ncclassic.GetDimensions();
+	const std::vector<ClassicNcVariable> & vecVariables =
+		ncclassic.GetVariables();
+
+	for (size_t v = 0; v < vecVariables.size(); v++) {
+		const ClassicNcVariable & var = vecVariables[v];
+
+		VariableChunkLayout layout;
+		layout.m_strName = var.m_strName;
+		layout.m_strDataType = ZarrDataType(var.m_nType, true);
+		ChunkAttributesFromClassic(var.m_vecAttributes, layout.m_vecAttributes);
+		FillValueFromAttributes(layout);
+
+		// Variables are contiguous, and each record of a record variable
+		// is a chunk
+		size_t sChunkValues = 1;
+		for (size_t d = 0; d < var.m_vecDimIds.size(); d++) {
+			const ClassicNcDimension & dim = vecDimensions[var.m_vecDimIds[d]];
+			layout.m_vecDimNames.push_back(dim.m_strName);
+			layout.m_vecShape.push_back(static_cast<size_t>(dim.m_ullSize));
+			if ((d == 0) && var.m_fRecord) {
+				layout.m_vecChunkShape.push_back(1);
+			} else {
+				layout.m_vecChunkShape.push_back(
+					std::max<size_t>(static_cast<size_t>(dim.m_ullSize), 1));
+				sChunkValues *= static_cast<size_t>(dim.m_ullSize);
+			}
+		}
+
+		const unsigned long long ullChunkBytes =
+			static_cast<unsigned long long>(sChunkValues)
+			* ClassicNcFile::GetTypeSize(var.m_nType);
+		const size_t sChunks =
+			(var.m_fRecord)?(layout.m_vecShape[0]):(1);
+
+		if (ullChunkBytes != 0) {
+			for (size_t c = 0; c < sChunks; c++) {
+				ChunkReference ref;
+				ref.m_vecIndex.resize(var.m_vecDimIds.size(), 0);
+				if (var.m_fRecord) {
+					ref.m_vecIndex[0] = c;
+				}
+				ref.m_ullOffset = var.m_ullBegin
+					+ static_cast<unsigned long long>(c) * ncclassic.GetRecordBytes();
+				ref.m_ullLength = ullChunkBytes;
+				layout.m_vecChunks.push_back(ref);
+			}
+		}
+
+		m_vecVariables.push_back(layout);
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(HYPERION_HDF5)
+
+///	<summary>
+///		Read the attributes of a variable, or the global attributes, of
+///		an open NetCDF-4 file.  Attributes of other than text and
+///		numeric types are not read.
+///	</summary>
+static void ChunkAttributesFromNetCDF4(
+	int ncid,
+	int varid,
+	int nAttributes,
+	ChunkAttributeVector & vecAttributes
+) {
+	for (int a = 0; a < nAttributes; a++) {
+		char szName[NC_MAX_NAME+1];
+		nc_type nctype;
+		size_t sLength;
+		if ((nc_inq_attname(ncid, varid, a, szName) != NC_NOERR) ||
+		    (nc_inq_att(ncid, varid, szName, &nctype, &sLength) != NC_NOERR)
+		) {
+			continue;
+		}
+
+		ChunkAttribute att;
+		att.m_strName = szName;
+		att.m_fText = (nctype == NC_CHAR);
+		if (att.m_fText) {
+			std::vector<char> vecText(sLength + 1, '\0');
+			if (nc_get_att_text(ncid, varid, szName, &(vecText[0])) != NC_NOERR) {
+				continue;
+			}
+			att.m_strText = std::string(&(vecText[0]));
+
+		} else if ((ZarrDataType(nctype) != "") && (sLength != 0)) {
+			if (!GetNcAttAsDoubles(ncid, varid, szName, att.m_vecValues)) {
+				continue;
+			}
+
+		} else {
+			continue;
+		}
+		vecAttributes.push_back(att);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the filters of an HDF5 dataset as numcodecs codecs.  Returns
+///		false if a filter has no codec.
+///	</summary>
+static bool ChunkFiltersFromHDF5(
+	hid_t dcpl,
+	size_t sTypeSize,
+	std::vector<ChunkFilter> & vecFilters,
+	std::string & strReason
+) {
+	int nFilters = H5Pget_nfilters(dcpl);
+	for (int f = 0; f < nFilters; f++) {
+		unsigned int uiFlags;
+		unsigned int uiConfig;
+		unsigned int uiValues[8];
+		size_t sValues = 8;
+		char szName[64];
+		H5Z_filter_t filter =
+			H5Pget_filter2(dcpl, static_cast<unsigned>(f), &uiFlags,
+				&sValues, uiValues, sizeof(szName), szName, &uiConfig);
+
+		ChunkFilter chunkfilter;
+		if (filter == H5Z_FILTER_DEFLATE) {
+			chunkfilter.m_strId = "zlib";
+			chunkfilter.m_nParameter =
+				(sValues > 0)?(static_cast<int>(uiValues[0])):(6);
+		} else if (filter == H5Z_FILTER_SHUFFLE) {
+			chunkfilter.m_strId = "shuffle";
+			chunkfilter.m_nParameter = static_cast<int>(sTypeSize);
+		} else if (filter == H5Z_FILTER_FLETCHER32) {
+			chunkfilter.m_strId = "fletcher32";
+			chunkfilter.m_nParameter = 0;
+		} else {
+			strReason = std::string("unsupported filter ")
+				+ std::to_string(static_cast<int>(filter));
+			return false;
+		}
+		vecFilters.push_back(chunkfilter);
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Locate the chunks of an HDF5 dataset.  Returns false, with the
+///		reason, if they cannot be described.
+///	</summary>
+static bool ChunksFromHDF5(
+	hid_t dset,
+	nc_type nctype,
+	VariableChunkLayout & layout,
+	std::string & strReason
+) {
+	const size_t sDims = layout.m_vecShape.size();
+
+	hid_t tid = H5Dget_type(dset);
+	const size_t sTypeSize = H5Tget_size(tid);
+	const bool fBigEndian = (H5Tget_order(tid) == H5T_ORDER_BE);
+	H5Tclose(tid);
+
+	layout.m_strDataType = ZarrDataType(nctype, fBigEndian);
+
+	hid_t dcpl = H5Dget_create_plist(dset);
+	H5D_layout_t eLayout = H5Pget_layout(dcpl);
+
+	bool fSuccess = true;
+	if (eLayout == H5D_CHUNKED) {
+		std::vector<hsize_t> vecChunk(std::max<size_t>(sDims, 1));
+		H5Pget_chunk(dcpl, static_cast<int>(sDims), &(vecChunk[0]));
+		layout.m_vecChunkShape.assign(vecChunk.begin(), vecChunk.begin() + sDims);
+
+		fSuccess = ChunkFiltersFromHDF5(dcpl, sTypeSize, layout.m_vecFilters, strReason);
+
+		hsize_t nChunks = 0;
+		if (fSuccess && (H5Dget_num_chunks(dset, H5S_ALL, &nChunks) < 0)) {
+			strReason = "unable to count chunks";
+			fSuccess = false;
+		}
+
+		std::vector<hsize_t> vecOffset(std::max<size_t>(sDims, 1));
+		for (hsize_t c = 0; fSuccess && (c < nChunks); c++) {
+			unsigned int uiFilterMask = 0;
+			haddr_t addr;
+			hsize_t sSize;
+			if (H5Dget_chunk_info(dset, H5S_ALL, c,
+				&(vecOffset[0]), &uiFilterMask, &addr, &sSize) < 0
+			) {
+				strReason = "unable to locate chunk";
+				fSuccess = false;
+				break;
+			}
+			if (uiFilterMask != 0) {
+				strReason = "filters skipped on some chunks";
+				fSuccess = false;
+				break;
+			}
+
+			ChunkReference ref;
+			ref.m_vecIndex.resize(sDims);
+			for (size_t d = 0; d < sDims; d++) {
+				ref.m_vecIndex[d] = static_cast<size_t>(vecOffset[d] / vecChunk[d]);
+			}
+			ref.m_ullOffset = static_cast<unsigned long long>(addr);
+			ref.m_ullLength = static_cast<unsigned long long>(sSize);
+			layout.m_vecChunks.push_back(ref);
+		}
+
+	} else if (eLayout == H5D_CONTIGUOUS) {
+		layout.m_vecChunkShape.resize(sDims);
+		size_t sValues = 1;
+		for (size_t d = 0; d < sDims; d++) {
+			layout.m_vecChunkShape[d] = std::max<size_t>(layout.m_vecShape[d], 1);
+			sValues *= layout.m_vecShape[d];
+		}
+
+		// Storage is not allocated until data is written
+		haddr_t addr = H5Dget_offset(dset);
+		if ((addr != HADDR_UNDEF) && (sValues != 0)) {
+			ChunkReference ref;
+			ref.m_vecIndex.resize(sDims, 0);
+			ref.m_ullOffset = static_cast<unsigned long long>(addr);
+			ref.m_ullLength = static_cast<unsigned long long>(sValues) * sTypeSize;
+			layout.m_vecChunks.push_back(ref);
+		}
+
+	} else {
+		strReason = "compact or virtual storage";
+		fSuccess = false;
+	}
+
+	H5Pclose(dcpl);
+	return fSuccess;
+}
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string FileChunkReferences::FromNetCDF4File(
+	const std::string & strFilename
+) {
+#if defined(HYPERION_HDF5)
+	if (IsRemoteURL(strFilename)) {
+		return std::string("Chunks of remote NetCDF-4 file \"") + strFilename
+			+ std::string("\" cannot be located");
+	}
+
+	// Neither library may be called from several threads at once
+	std::lock_guard<std::mutex> lockNetCDF(NcFilePool::LibraryMutex());
+
+	int ncid;
+	int iStatus = nc_open(strFilename.c_str(), NC_NOWRITE, &ncid);
+	if (iStatus != NC_NOERR) {
+		return std::string("Unable to open \"") + strFilename
+			+ std::string("\": ") + std::string(nc_strerror(iStatus));
+	}
+
+	int nFormat;
+	if ((nc_inq_format(ncid, &nFormat) != NC_NOERR) ||
+	    ((nFormat != NC_FORMAT_NETCDF4) && (nFormat != NC_FORMAT_NETCDF4_CLASSIC))
+	) {
+		nc_close(ncid);
+		return std::string("File \"") + strFilename
+			+ std::string("\" is neither a classic nor a NetCDF-4 file");
+	}
+
+	hid_t fid = H5Fopen(strFilename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+	if (fid < 0) {
+		nc_close(ncid);
+		return std::string("Unable to open \"") + strFilename
+			+ std::string("\" with HDF5");
+	}
+
+	int nDims;
+	int nVars;
+	int nAttributes;
+	int nUnlimited;
+	nc_inq(ncid, &nDims, &nVars, &nAttributes, &nUnlimited);
+	ChunkAttributesFromNetCDF4(ncid, NC_GLOBAL, nAttributes, m_vecAttributes);
+
+	for (int v = 0; v < nVars; v++) {
+		char szName[NC_MAX_NAME+1];
+		nc_type nctype;
+		int nVarDims;
+		int nVarAttributes;
+		std::vector<int> vecDimIds(NC_MAX_VAR_DIMS);
+		if (nc_inq_var(ncid, v, szName, &nctype, &nVarDims,
+			&(vecDimIds[0]), &nVarAttributes) != NC_NOERR
+		) {
+			continue;
+		}
+
+		VariableChunkLayout layout;
+		layout.m_strName = szName;
+		if (ZarrDataType(nctype) == "") {
+			m_vecSkipped.push_back(
+				std::pair<std::string, std::string>(szName, "unsupported type"));
+			continue;
+		}
+
+		for (int d = 0; d < nVarDims; d++) {
+			char szDimName[NC_MAX_NAME+1];
+			size_t sDimSize;
+			nc_inq_dim(ncid, vecDimIds[d], szDimName, &sDimSize);
+			layout.m_vecDimNames.push_back(szDimName);
+			layout.m_vecShape.push_back(sDimSize);
+		}
+
+		ChunkAttributesFromNetCDF4(ncid, v, nVarAttributes, layout.m_vecAttributes);
+		FillValueFromAttributes(layout);
+
+		hid_t dset = H5Dopen2(fid, szName, H5P_DEFAULT);
+		if (dset < 0) {
+			m_vecSkipped.push_back(
+				std::pair<std::string, std::string>(szName, "dataset not found"));
+			continue;
+		}
+
+		std::string strReason;
+		bool fSuccess = ChunksFromHDF5(dset, nctype, layout, strReason);
+		H5Dclose(dset);
+
+		if (!fSuccess) {
+			m_vecSkipped.push_back(
+				std::pair<std::string, std::string>(szName, strReason));
+			continue;
+		}
+		m_vecVariables.push_back(layout);
+	}
+
+	H5Fclose(fid);
+	nc_close(ncid);
+
+	return std::string("");
+#else
+	return std::string("File \"") + strFilename
+		+ std::string("\" is not a classic format file; chunks of NetCDF-4 ")
+		+ std::string("files are located only when built with HDF5=TRUE");
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FileChunkReferences::ToJSON(
+	nlohmann::json & jRefs
+) const {
+	jRefs = nlohmann::json::object();
+
+	// Metadata is held as JSON text
+	nlohmann::json jGroup;
+	jGroup["zarr_format"] = 2;
+	jRefs[".zgroup"] = jGroup.dump();
+
+	nlohmann::json jGroupAttrs = nlohmann::json::object();
+	ChunkAttributesToJSON(m_vecAttributes, jGroupAttrs);
+	jRefs[".zattrs"] = jGroupAttrs.dump();
+
+	for (size_t v = 0; v < m_vecVariables.size(); v++) {
+		const VariableChunkLayout & layout = m_vecVariables[v];
+
+		nlohmann::json jArray;
+		jArray["zarr_format"] = 2;
+		jArray["shape"] = layout.m_vecShape;
+		jArray["chunks"] = layout.m_vecChunkShape;
+		jArray["dtype"] = layout.m_strDataType;
+		jArray["order"] = "C";
+		jArray["compressor"] = nullptr;
+		if (layout.m_fHasFillValue) {
+			jArray["fill_value"] = ZarrNumber(layout.m_dFillValue);
+		} else {
+			jArray["fill_value"] = nullptr;
+		}
+		if (layout.m_vecFilters.size() == 0) {
+			jArray["filters"] = nullptr;
+		} else {
+			nlohmann::json jFilters = nlohmann::json::array();
+			for (size_t f = 0; f < layout.m_vecFilters.size(); f++) {
+				nlohmann::json jFilter;
+				jFilter["id"] = layout.m_vecFilters[f].m_strId;
+				if (layout.m_vecFilters[f].m_strId == "zlib") {
+					jFilter["level"] = layout.m_vecFilters[f].m_nParameter;
+				} else if (layout.m_vecFilters[f].m_strId == "shuffle") {
+					jFilter["elementsize"] = layout.m_vecFilters[f].m_nParameter;
+				}
+				jFilters.push_back(jFilter);
+			}
+			jArray["filters"] = jFilters;
+		}
+		jRefs[layout.m_strName + std::string("/.zarray")] = jArray.dump();
+
+		// Dimension names are attached as xarray expects them
+		nlohmann::json jAttrs = nlohmann::json::object();
+		ChunkAttributesToJSON(layout.m_vecAttributes, jAttrs);
+		jAttrs.erase("_FillValue");
+		jAttrs["_ARRAY_DIMENSIONS"] = layout.m_vecDimNames;
+		jRefs[layout.m_strName + std::string("/.zattrs")] = jAttrs.dump();
+
+		for (size_t c = 0; c < layout.m_vecChunks.size(); c++) {
+			const ChunkReference & ref = layout.m_vecChunks[c];
+
+			std::string strKey = layout.m_strName + std::string("/");
+			if (ref.m_vecIndex.size() == 0) {
+				strKey += "0";
+			}
+			for (size_t d = 0; d < ref.m_vecIndex.size(); d++) {
+				if (d != 0) {
+					strKey += ".";
+				}
+				strKey += std::to_string(ref.m_vecIndex[d]);
+			}
+
+			nlohmann::json jRef = nlohmann::json::array();
+			jRef.push_back(m_strFilename);
+			jRef.push_back(ref.m_ullOffset);
+			jRef.push_back(ref.m_ullLength);
+			jRefs[strKey] = jRef;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t FileChunkReferences::GetChunkCount() const {
+	size_t sChunks = 0;
+	for (size_t v = 0; v < m_vecVariables.size(); v++) {
+		sChunks += m_vecVariables[v].m_vecChunks.size();
+	}
+	return sChunks;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
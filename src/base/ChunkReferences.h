@@ -0,0 +1,243 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    ChunkReferences.h
+///	\version October 15, 2026
+///
+
+#ifndef _CHUNKREFERENCES_H_
+#define _CHUNKREFERENCES_H_
+
+#include "../contrib/nlohmann/json_fwd.hpp"
+
+#include <string>
+#include <vector>
+#include <utility>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		The location of one chunk of a variable in its file.
+///	</summary>
+struct ChunkReference {
+
+	///	<summary>
+	///		Index of the chunk along each dimension.
+	///	</summary>
+	std::vector<size_t> m_vecIndex;
+
+	///	<summary>
+	///		Offset of the chunk in the file.
+	///	</summary>
+	unsigned long long m_ullOffset;
+
+	///	<summary>
+	///		Length of the chunk in the file, after any filters.
+	///	</summary>
+	unsigned long long m_ullLength;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A filter applied to each chunk of a variable, as a numcodecs codec
+///		id and its one parameter: the level of "zlib" and the element size
+///		of "shuffle".
+///	</summary>
+struct ChunkFilter {
+
+	///	<summary>
+	///		Codec id.
+	///	</summary>
+	std::string m_strId;
+
+	///	<summary>
+	///		Codec parameter.
+	///	</summary>
+	int m_nParameter;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		An attribute of a file or variable, holding either text or
+///		numeric values.
+///	</summary>
+struct ChunkAttribute {
+
+	///	<summary>
+	///		Attribute name.
+	///	</summary>
+	std::string m_strName;
+
+	///	<summary>
+	///		Flag indicating the attribute is text.
+	///	</summary>
+	bool m_fText;
+
+	///	<summary>
+	///		Text of the attribute.
+	///	</summary>
+	std::string m_strText;
+
+	///	<summary>
+	///		Numeric values of the attribute.
+	///	</summary>
+	std::vector<double> m_vecValues;
+};
+
+///	<summary>
+///		A vector of attributes in file order.
+///	</summary>
+typedef std::vector<ChunkAttribute> ChunkAttributeVector;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		The storage of one variable of a file, in the terms of a Zarr
+///		(version 2) array.
+///	</summary>
+class VariableChunkLayout {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	VariableChunkLayout() :
+		m_fHasFillValue(false),
+		m_dFillValue(0.0)
+	{ }
+
+public:
+	///	<summary>
+	///		Variable name.
+	///	</summary>
+	std::string m_strName;
+
+	///	<summary>
+	///		Names of the dimensions of the variable.
+	///	</summary>
+	std::vector<std::string> m_vecDimNames;
+
+	///	<summary>
+	///		Size of the variable along each dimension.
+	///	</summary>
+	std::vector<size_t> m_vecShape;
+
+	///	<summary>
+	///		Size of a chunk along each dimension.
+	///	</summary>
+	std::vector<size_t> m_vecChunkShape;
+
+	///	<summary>
+	///		Zarr data type, such as ">f4".
+	///	</summary>
+	std::string m_strDataType;
+
+	///	<summary>
+	///		Filters applied to each chunk, in the order they are applied
+	///		when the chunk is written.
+	///	</summary>
+	std::vector<ChunkFilter> m_vecFilters;
+
+	///	<summary>
+	///		Flag indicating the variable has a _FillValue.
+	///	</summary>
+	bool m_fHasFillValue;
+
+	///	<summary>
+	///		Value of _FillValue.
+	///	</summary>
+	double m_dFillValue;
+
+	///	<summary>
+	///		Attributes of the variable.
+	///	</summary>
+	ChunkAttributeVector m_vecAttributes;
+
+	///	<summary>
+	///		Chunks stored in the file.  Chunks that were never written are
+	///		not listed and hold the fill value.
+	///	</summary>
+	std::vector<ChunkReference> m_vecChunks;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		The location of every chunk of every variable of a NetCDF file,
+///		so that the data can be read with byte-range requests and no
+///		NetCDF library.  Classic format files, local or remote, are
+///		decoded by ClassicNcFile; each record of a record variable is a
+///		chunk.  The chunks of NetCDF-4 files are located through the HDF5
+///		library and are only available when built with HYPERION_HDF5.
+///	</summary>
+class FileChunkReferences {
+
+public:
+	///	<summary>
+	///		Locate the chunks of every variable of the given file.
+	///		Variables whose chunks cannot be described, such as those
+	///		with filters other than shuffle, deflate and fletcher32, are
+	///		listed in m_vecSkipped.  Returns an error message on failure.
+	///	</summary>
+	std::string FromFile(
+		const std::string & strFilename
+	);
+
+	///	<summary>
+	///		Write the chunks as a Kerchunk (version 1) reference set: the
+	///		Zarr metadata of the group and of each variable, and for each
+	///		chunk a [url, offset, length] reference into the file.
+	///	</summary>
+	void ToJSON(
+		nlohmann::json & jRefs
+	) const;
+
+	///	<summary>
+	///		Get the total number of chunks of all variables.
+	///	</summary>
+	size_t GetChunkCount() const;
+
+protected:
+	///	<summary>
+	///		Locate the chunks of a classic format file.  Returns false if
+	///		the file is not a classic format file.
+	///	</summary>
+	bool FromClassicFile(
+		const std::string & strFilename,
+		std::string & strError
+	);
+
+	///	<summary>
+	///		Locate the chunks of a NetCDF-4 file.
+	///	</summary>
+	std::string FromNetCDF4File(
+		const std::string & strFilename
+	);
+
+public:
+	///	<summary>
+	///		Name of the file.
+	///	</summary>
+	std::string m_strFilename;
+
+	///	<summary>
+	///		Global attributes of the file.
+	///	</summary>
+	ChunkAttributeVector m_vecAttributes;
+
+	///	<summary>
+	///		Variables of the file.
+	///	</summary>
+	std::vector<VariableChunkLayout> m_vecVariables;
+
+	///	<summary>
+	///		Variables that could not be described, with the reason.
+	///	</summary>
+	std::vector< std::pair<std::string, std::string> > m_vecSkipped;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
@@ -0,0 +1,918 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    ClassicNcFile.cpp
+///	\version October 15, 2026
+///
+
+#include "ClassicNcFile.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		NetCDF types, as stored in the file.
+///	</summary>
+enum {
+	ClassicNcType_Byte = 1,
+	ClassicNcType_Char = 2,
+	ClassicNcType_Short = 3,
+	ClassicNcType_Int = 4,
+	ClassicNcType_Float = 5,
+	ClassicNcType_Double = 6,
+	ClassicNcType_UByte = 7,
+	ClassicNcType_UShort = 8,
+	ClassicNcType_UInt = 9,
+	ClassicNcType_Int64 = 10,
+	ClassicNcType_UInt64 = 11
+};
+
+///	<summary>
+///		Tags of the lists in the header.
+///	</summary>
+enum {
+	ClassicNcTag_Dimension = 10,
+	ClassicNcTag_Variable = 11,
+	ClassicNcTag_Attribute = 12
+};
+
+///	<summary>
+///		Bytes of the header read at a time.
+///	</summary>
+static const size_t ClassicNcHeaderBlockBytes = 65536;
+
+///	<summary>
+///		Largest span of a record variable read with a single pread.
+///	</summary>
+static const unsigned long long ClassicNcMaxSpanBytes = 4 * 1024 * 1024;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the size of a value of the given type, or zero if the type
+///		is not valid.
+///	</summary>
+static size_t ClassicNcTypeSize(
+	int nType
+) {
+	switch (nType) {
+		case ClassicNcType_Byte:
+		case ClassicNcType_Char:
+		case ClassicNcType_UByte:
+			return 1;
+		case ClassicNcType_Short:
+		case ClassicNcType_UShort:
+			return 2;
+		case ClassicNcType_Int:
+		case ClassicNcType_Float:
+		case ClassicNcType_UInt:
+			return 4;
+		case ClassicNcType_Double:
+		case ClassicNcType_Int64:
+		case ClassicNcType_UInt64:
+			return 8;
+	}
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Decode a big-endian unsigned integer of sBytes bytes.
+///	</summary>
+static unsigned long long ClassicNcDecode(
+	const char * p,
+	size_t sBytes
+) {
+	unsigned long long ullValue = 0;
+	for (size_t i = 0; i < sBytes; i++) {
+		ullValue = (ullValue << 8) | static_cast<unsigned char>(p[i]);
+	}
+	return ullValue;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Convert sCount big-endian values of sTypeSize bytes to host byte
+///		order.
+///	</summary>
+static void ClassicNcToHost(
+	const char * pRaw,
+	size_t sCount,
+	size_t sTypeSize,
+	void * pValues
+) {
+	if (sTypeSize == 1) {
+		memcpy(pValues, pRaw, sCount);
+	} else if (sTypeSize == 2) {
+		uint16_t * pOut = static_cast<uint16_t *>(pValues);
+		for (size_t i = 0; i < sCount; i++) {
+			pOut[i] = static_cast<uint16_t>(ClassicNcDecode(&(pRaw[i * 2]), 2));
+		}
+	} else if (sTypeSize == 4) {
+		uint32_t * pOut = static_cast<uint32_t *>(pValues);
+		for (size_t i = 0; i < sCount; i++) {
+			pOut[i] = static_cast<uint32_t>(ClassicNcDecode(&(pRaw[i * 4]), 4));
+		}
+	} else {
+		uint64_t * pOut = static_cast<uint64_t *>(pValues);
+		for (size_t i = 0; i < sCount; i++) {
+			pOut[i] = static_cast<uint64_t>(ClassicNcDecode(&(pRaw[i * 8]), 8));
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Round up to a multiple of four bytes.
+///	</summary>
+static unsigned long long ClassicNcPad(
+	unsigned long long ullSize
+) {
+	return (ullSize + 3) & ~3ULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ClassicNcAttribute
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcAttribute::AsString(
+	std::string & strValue
+) const {
+
+	// Text, including bytes, is read up to the first null character
+	if ((m_nType == ClassicNcType_Char) || (m_nType == ClassicNcType_Byte)) {
+		const char * pEnd = static_cast<const char *>(
+			memchr(m_vecData.data(), '\0', m_sCount));
+		strValue.assign(m_vecData.data(),
+			(pEnd == NULL)?(m_sCount):(pEnd - m_vecData.data()));
+		return true;
+	}
+
+	if (m_sCount == 0) {
+		strValue.clear();
+		return true;
+	}
+
+	const char * p = m_vecData.data();
+	char szBuffer[64];
+
+	// Numeric values are formatted as std::ostream formats them
+	if (m_nType == ClassicNcType_Float) {
+		uint32_t uiBits = static_cast<uint32_t>(ClassicNcDecode(p, 4));
+		float flValue;
+		memcpy(&flValue, &uiBits, sizeof(float));
+		snprintf(szBuffer, sizeof(szBuffer), "%g", static_cast<double>(flValue));
+
+	} else if (m_nType == ClassicNcType_Double) {
+		uint64_t ullBits = ClassicNcDecode(p, 8);
+		double dValue;
+		memcpy(&dValue, &ullBits, sizeof(double));
+		snprintf(szBuffer, sizeof(szBuffer), "%g", dValue);
+
+	} else {
+		long long llValue;
+		unsigned long long ullValue =
+			ClassicNcDecode(p, ClassicNcTypeSize(m_nType));
+
+		if (m_nType == ClassicNcType_Short) {
+			llValue = static_cast<int16_t>(ullValue);
+		} else if (m_nType == ClassicNcType_Int) {
+			llValue = static_cast<int32_t>(ullValue);
+		} else if (m_nType == ClassicNcType_Int64) {
+			llValue = static_cast<int64_t>(ullValue);
+		} else if (m_nType == ClassicNcType_UInt64) {
+			// Out of range of long long, which the library reports
+			if (ullValue > static_cast<unsigned long long>(LLONG_MAX)) {
+				return false;
+			}
+			llValue = static_cast<long long>(ullValue);
+		} else {
+			llValue = static_cast<long long>(ullValue);
+		}
+		snprintf(szBuffer, sizeof(szBuffer), "%lld", llValue);
+	}
+
+	strValue.assign(szBuffer);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcAttribute::GetValue(
+	size_t i,
+	double & dValue
+) const {
+	const size_t sTypeSize = ClassicNcTypeSize(m_nType);
+	if ((m_nType == ClassicNcType_Char) || (sTypeSize == 0) || (i >= m_sCount)) {
+		return false;
+	}
+
+	const char * p = m_vecData.data() + i * sTypeSize;
+	unsigned long long ullValue = ClassicNcDecode(p, sTypeSize);
+
+	switch (m_nType) {
+		case ClassicNcType_Byte:
+			dValue = static_cast<int8_t>(ullValue);
+			break;
+		case ClassicNcType_Short:
+			dValue = static_cast<int16_t>(ullValue);
+			break;
+		case ClassicNcType_Int:
+			dValue = static_cast<int32_t>(ullValue);
+			break;
+		case ClassicNcType_Int64:
+			dValue = static_cast<double>(static_cast<int64_t>(ullValue));
+			break;
+		case ClassicNcType_Float: {
+			uint32_t uiBits = static_cast<uint32_t>(ullValue);
+			float flValue;
+			memcpy(&flValue, &uiBits, sizeof(float));
+			dValue = flValue;
+			break;
+		}
+		case ClassicNcType_Double:
+			memcpy(&dValue, &ullValue, sizeof(double));
+			break;
+		default:
+			dValue = static_cast<double>(ullValue);
+			break;
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ClassicNcFile
+///////////////////////////////////////////////////////////////////////////////
+
+ClassicNcFile::ClassicNcFile() :
+	m_fd(-1),
+	m_ullFileSize(0),
+	m_nVersion(0),
+	m_ullRecordBytes(0)
+{ }
+
+///////////////////////////////////////////////////////////////////////////////
+
+ClassicNcFile::~ClassicNcFile() {
+	Close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ClassicNcFile::Close() {
+	if (m_fd >= 0) {
+		close(m_fd);
+		m_fd = (-1);
+	}
+	m_strURL.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcFile::ReadRanges(
+	const std::vector<RemoteByteRange> & vecRanges
+) const {
+	if (m_strURL != "") {
+		return (RemoteFileClient::Shared().ReadRanges(m_strURL, vecRanges) == "");
+	}
+	if (m_fd < 0) {
+		return false;
+	}
+	for (size_t i = 0; i < vecRanges.size(); i++) {
+		const RemoteByteRange & range = vecRanges[i];
+		size_t sRead = 0;
+		while (sRead < range.m_sSize) {
+			ssize_t nRead = pread(m_fd, range.m_pData + sRead,
+				range.m_sSize - sRead,
+				static_cast<off_t>(range.m_ullOffset + sRead));
+			if (nRead <= 0) {
+				return false;
+			}
+			sRead += static_cast<size_t>(nRead);
+		}
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcFile::Fail(
+	const char * szError
+) {
+	m_strError = szError;
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcFile::Require(
+	size_t sPos,
+	size_t sSize
+) {
+	if ((sSize > m_ullFileSize) || (sPos > m_ullFileSize - sSize)) {
+		return Fail("Header extends past the end of the file");
+	}
+	size_t sEnd = sPos + sSize;
+	if (sEnd <= m_vecHeader.size()) {
+		return true;
+	}
+
+	// Read whole blocks, so that a long header takes few reads; the
+	// header of a remote file is read in doubling blocks since each
+	// read is a round trip
+	size_t sOldSize = m_vecHeader.size();
+	size_t sNewSize =
+		((sEnd + ClassicNcHeaderBlockBytes - 1) / ClassicNcHeaderBlockBytes)
+		* ClassicNcHeaderBlockBytes;
+	if ((m_strURL != "") && (sNewSize < 2 * sOldSize)) {
+		sNewSize = 2 * sOldSize;
+	}
+	if (sNewSize > m_ullFileSize) {
+		sNewSize = static_cast<size_t>(m_ullFileSize);
+	}
+	m_vecHeader.resize(sNewSize);
+
+	std::vector<RemoteByteRange> vecRanges(1);
+	vecRanges[0].m_ullOffset = sOldSize;
+	vecRanges[0].m_sSize = sNewSize - sOldSize;
+	vecRanges[0].m_pData = &(m_vecHeader[sOldSize]);
+	if (!ReadRanges(vecRanges)) {
+		m_vecHeader.resize(sOldSize);
+		return Fail("Unable to read header");
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcFile::ReadUInt32(
+	size_t & sPos,
+	unsigned long long & ullValue
+) {
+	if (!Require(sPos, 4)) {
+		return false;
+	}
+	ullValue = ClassicNcDecode(&(m_vecHeader[sPos]), 4);
+	sPos += 4;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcFile::ReadUInt64(
+	size_t & sPos,
+	unsigned long long & ullValue
+) {
+	if (!Require(sPos, 8)) {
+		return false;
+	}
+	ullValue = ClassicNcDecode(&(m_vecHeader[sPos]), 8);
+	sPos += 8;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcFile::ReadCount(
+	size_t & sPos,
+	unsigned long long & ullValue
+) {
+	if (m_nVersion == 5) {
+		if (!ReadUInt64(sPos, ullValue)) {
+			return false;
+		}
+		if (ullValue > static_cast<unsigned long long>(LLONG_MAX)) {
+			return Fail("Negative count in header");
+		}
+		return true;
+	}
+	if (!ReadUInt32(sPos, ullValue)) {
+		return false;
+	}
+	if (ullValue > static_cast<unsigned long long>(INT_MAX)) {
+		return Fail("Negative count in header");
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcFile::ReadName(
+	size_t & sPos,
+	std::string & strName
+) {
+	unsigned long long ullLength;
+	if (!ReadCount(sPos, ullLength)) {
+		return false;
+	}
+	if (ullLength > m_ullFileSize) {
+		return Fail("Invalid name length in header");
+	}
+	size_t sPadded = static_cast<size_t>(ClassicNcPad(ullLength));
+	if (!Require(sPos, sPadded)) {
+		return false;
+	}
+	strName.assign(&(m_vecHeader[sPos]), static_cast<size_t>(ullLength));
+	sPos += sPadded;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcFile::ReadListHeader(
+	size_t & sPos,
+	unsigned long long ullTag,
+	unsigned long long & ullCount
+) {
+	unsigned long long ullReadTag;
+	if (!ReadUInt32(sPos, ullReadTag) || !ReadCount(sPos, ullCount)) {
+		return false;
+	}
+	if (ullReadTag == 0) {
+		if (ullCount != 0) {
+			return Fail("Invalid absent list in header");
+		}
+		return true;
+	}
+	if (ullReadTag != ullTag) {
+		return Fail("Unexpected list tag in header");
+	}
+
+	// Every element takes at least four bytes
+	if (ullCount > m_ullFileSize / 4) {
+		return Fail("Invalid list length in header");
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcFile::ReadAttributes(
+	size_t & sPos,
+	ClassicNcAttributeVector & vecAttributes
+) {
+	unsigned long long ullCount;
+	if (!ReadListHeader(sPos, ClassicNcTag_Attribute, ullCount)) {
+		return false;
+	}
+	vecAttributes.resize(static_cast<size_t>(ullCount));
+
+	for (size_t a = 0; a < vecAttributes.size(); a++) {
+		ClassicNcAttribute & att = vecAttributes[a];
+
+		unsigned long long ullType;
+		unsigned long long ullValues;
+		if (!ReadName(sPos, att.m_strName) ||
+		    !ReadUInt32(sPos, ullType) ||
+		    !ReadCount(sPos, ullValues)
+		) {
+			return false;
+		}
+
+		att.m_nType = static_cast<int>(ullType);
+		size_t sTypeSize = ClassicNcTypeSize(att.m_nType);
+		if ((sTypeSize == 0) ||
+		    ((m_nVersion != 5) && (att.m_nType > ClassicNcType_Double))
+		) {
+			return Fail("Invalid attribute type in header");
+		}
+		if (ullValues > m_ullFileSize / sTypeSize) {
+			return Fail("Invalid attribute length in header");
+		}
+
+		att.m_sCount = static_cast<size_t>(ullValues);
+		size_t sBytes = att.m_sCount * sTypeSize;
+		size_t sPadded = static_cast<size_t>(ClassicNcPad(sBytes));
+		if (!Require(sPos, sPadded)) {
+			return false;
+		}
+		att.m_vecData.assign(
+			m_vecHeader.begin() + sPos,
+			m_vecHeader.begin() + sPos + sBytes);
+		sPos += sPadded;
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ClassicNcStatus ClassicNcFile::Open(
+	const std::string & strFilename
+) {
+	Close();
+	m_vecHeader.clear();
+	m_vecDimensions.clear();
+	m_vecAttributes.clear();
+	m_vecVariables.clear();
+	m_strError.clear();
+
+	// The first block of the header of a remote file is read with the
+	// request that reports its size
+	if (IsRemoteURL(strFilename)) {
+		m_strURL = strFilename;
+		m_strError = RemoteFileClient::Shared().ReadHead(
+			m_strURL, ClassicNcHeaderBlockBytes, m_vecHeader, m_ullFileSize);
+		if (m_strError != "") {
+			return ClassicNcStatus_Error;
+		}
+
+	} else {
+		m_fd = open(strFilename.c_str(), O_RDONLY);
+		if (m_fd < 0) {
+			m_strError = "Unable to open file";
+			return ClassicNcStatus_Error;
+		}
+
+		struct stat statFile;
+		if (fstat(m_fd, &statFile) != 0) {
+			m_strError = "Unable to stat file";
+			return ClassicNcStatus_Error;
+		}
+		m_ullFileSize = static_cast<unsigned long long>(statFile.st_size);
+	}
+
+	// Magic number and version
+	size_t sPos = 0;
+	if (!Require(0, 4) ||
+	    (m_vecHeader[0] != 'C') || (m_vecHeader[1] != 'D') || (m_vecHeader[2] != 'F')
+	) {
+		m_strError = "Not a classic NetCDF file";
+		return ClassicNcStatus_NotClassic;
+	}
+	m_nVersion = static_cast<int>(m_vecHeader[3]);
+	if ((m_nVersion != 1) && (m_nVersion != 2) && (m_nVersion != 5)) {
+		m_strError = "Unsupported classic NetCDF version";
+		return ClassicNcStatus_NotClassic;
+	}
+	sPos = 4;
+
+	// Number of records; files being streamed do not record it
+	unsigned long long ullRecords;
+	if (m_nVersion == 5) {
+		if (!ReadUInt64(sPos, ullRecords)) {
+			return ClassicNcStatus_Error;
+		}
+		if (ullRecords == ~0ULL) {
+			m_strError = "Number of records not recorded";
+			return ClassicNcStatus_Error;
+		}
+	} else {
+		if (!ReadUInt32(sPos, ullRecords)) {
+			return ClassicNcStatus_Error;
+		}
+		if (ullRecords == 0xffffffffULL) {
+			m_strError = "Number of records not recorded";
+			return ClassicNcStatus_Error;
+		}
+	}
+
+	// Dimensions
+	unsigned long long ullCount;
+	if (!ReadListHeader(sPos, ClassicNcTag_Dimension, ullCount)) {
+		return ClassicNcStatus_Error;
+	}
+	m_vecDimensions.resize(static_cast<size_t>(ullCount));
+	for (size_t d = 0; d < m_vecDimensions.size(); d++) {
+		ClassicNcDimension & dim = m_vecDimensions[d];
+		if (!ReadName(sPos, dim.m_strName) || !ReadCount(sPos, dim.m_ullSize)) {
+			return ClassicNcStatus_Error;
+		}
+		dim.m_fRecord = (dim.m_ullSize == 0);
+		if (dim.m_fRecord) {
+			dim.m_ullSize = ullRecords;
+		}
+	}
+
+	// Global attributes
+	if (!ReadAttributes(sPos, m_vecAttributes)) {
+		return ClassicNcStatus_Error;
+	}
+
+	// Variables
+	if (!ReadListHeader(sPos, ClassicNcTag_Variable, ullCount)) {
+		return ClassicNcStatus_Error;
+	}
+	m_vecVariables.resize(static_cast<size_t>(ullCount));
+
+	size_t sRecordVariables = 0;
+	m_ullRecordBytes = 0;
+
+	for (size_t v = 0; v < m_vecVariables.size(); v++) {
+		ClassicNcVariable & var = m_vecVariables[v];
+
+		unsigned long long ullDims;
+		if (!ReadName(sPos, var.m_strName) || !ReadCount(sPos, ullDims)) {
+			return ClassicNcStatus_Error;
+		}
+		if (ullDims > m_ullFileSize / 4) {
+			m_strError = "Invalid number of variable dimensions";
+			return ClassicNcStatus_Error;
+		}
+		var.m_vecDimIds.resize(static_cast<size_t>(ullDims));
+		for (size_t d = 0; d < var.m_vecDimIds.size(); d++) {
+			unsigned long long ullDimId;
+			if (!ReadCount(sPos, ullDimId)) {
+				return ClassicNcStatus_Error;
+			}
+			if (ullDimId >= m_vecDimensions.size()) {
+				m_strError = "Invalid dimension id";
+				return ClassicNcStatus_Error;
+			}
+			var.m_vecDimIds[d] = static_cast<size_t>(ullDimId);
+		}
+
+		if (!ReadAttributes(sPos, var.m_vecAttributes)) {
+			return ClassicNcStatus_Error;
+		}
+
+		unsigned long long ullType;
+		unsigned long long ullVarSize;
+		if (!ReadUInt32(sPos, ullType) || !ReadCount(sPos, ullVarSize)) {
+			return ClassicNcStatus_Error;
+		}
+		var.m_nType = static_cast<int>(ullType);
+		if ((ClassicNcTypeSize(var.m_nType) == 0) ||
+		    ((m_nVersion != 5) && (var.m_nType > ClassicNcType_Double))
+		) {
+			m_strError = "Invalid variable type";
+			return ClassicNcStatus_Error;
+		}
+
+		bool fReadBegin =
+			(m_nVersion == 1)
+			?(ReadUInt32(sPos, var.m_ullBegin))
+			:(ReadUInt64(sPos, var.m_ullBegin));
+		if (!fReadBegin) {
+			return ClassicNcStatus_Error;
+		}
+
+		// Record variables are interleaved one record at a time.  The
+		// stored vsize is not used since it saturates for large variables.
+		var.m_fRecord =
+			(var.m_vecDimIds.size() != 0) &&
+			m_vecDimensions[var.m_vecDimIds[0]].m_fRecord;
+
+		if (var.m_fRecord) {
+			unsigned long long ullRecordSize = ClassicNcTypeSize(var.m_nType);
+			for (size_t d = 1; d < var.m_vecDimIds.size(); d++) {
+				ullRecordSize *= m_vecDimensions[var.m_vecDimIds[d]].m_ullSize;
+			}
+			m_ullRecordBytes += ClassicNcPad(ullRecordSize);
+			sRecordVariables++;
+		}
+	}
+
+	// A single record variable is not padded between records
+	if (sRecordVariables == 1) {
+		for (size_t v = 0; v < m_vecVariables.size(); v++) {
+			const ClassicNcVariable & var = m_vecVariables[v];
+			if (var.m_fRecord) {
+				m_ullRecordBytes = ClassicNcTypeSize(var.m_nType);
+				for (size_t d = 1; d < var.m_vecDimIds.size(); d++) {
+					m_ullRecordBytes *= m_vecDimensions[var.m_vecDimIds[d]].m_ullSize;
+				}
+			}
+		}
+	}
+
+	// The header is no longer needed
+	std::vector<char>().swap(m_vecHeader);
+
+	return ClassicNcStatus_Success;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t ClassicNcFile::GetTypeSize(
+	int nType
+) {
+	return ClassicNcTypeSize(nType);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int ClassicNcFile::FindVariable(
+	const std::string & strName
+) const {
+	for (size_t v = 0; v < m_vecVariables.size(); v++) {
+		if (m_vecVariables[v].m_strName == strName) {
+			return static_cast<int>(v);
+		}
+	}
+	return (-1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcFile::ReadValues(
+	const ClassicNcVariable & var,
+	size_t sBegin,
+	size_t sCount,
+	void * pValues
+) const {
+	std::vector<ClassicNcValueRead> vecReads(1);
+	vecReads[0].m_pvar = &var;
+	vecReads[0].m_sBegin = sBegin;
+	vecReads[0].m_sCount = sCount;
+	vecReads[0].m_pValues = pValues;
+	return ReadValues(vecReads);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcFile::ReadValues(
+	const std::vector<ClassicNcValueRead> & vecReads
+) const {
+	if ((m_fd < 0) && (m_strURL == "")) {
+		return false;
+	}
+
+	// Values of each read as stored, and spans of strided values that
+	// are read whole and gathered afterwards
+	std::vector< std::vector<char> > vecRaw(vecReads.size());
+	std::vector< std::vector<char> > vecSpan(vecReads.size());
+	std::vector<RemoteByteRange> vecRanges;
+
+	for (size_t r = 0; r < vecReads.size(); r++) {
+		const ClassicNcVariable & var = *(vecReads[r].m_pvar);
+		const size_t sBegin = vecReads[r].m_sBegin;
+		const size_t sCount = vecReads[r].m_sCount;
+
+		if (var.m_vecDimIds.size() != 1) {
+			return false;
+		}
+		if ((var.m_nType == ClassicNcType_Char) ||
+		    (ClassicNcTypeSize(var.m_nType) == 0)
+		) {
+			return false;
+		}
+		if (sCount == 0) {
+			continue;
+		}
+		if (sBegin + sCount > m_vecDimensions[var.m_vecDimIds[0]].m_ullSize) {
+			return false;
+		}
+
+		const size_t sTypeSize = ClassicNcTypeSize(var.m_nType);
+		const unsigned long long ullStride =
+			(var.m_fRecord)?(m_ullRecordBytes):(sTypeSize);
+		const unsigned long long ullFirst = var.m_ullBegin + sBegin * ullStride;
+		const unsigned long long ullSpan = (sCount - 1) * ullStride + sTypeSize;
+
+		if (ullFirst + ullSpan > m_ullFileSize) {
+			return false;
+		}
+
+		vecRaw[r].resize(sCount * sTypeSize);
+
+		RemoteByteRange range;
+		if (ullStride == sTypeSize) {
+			range.m_ullOffset = ullFirst;
+			range.m_sSize = static_cast<size_t>(ullSpan);
+			range.m_pData = &(vecRaw[r][0]);
+			vecRanges.push_back(range);
+
+		// Remote reads of single values are coalesced by the client
+		} else if ((m_strURL == "") && (ullSpan <= ClassicNcMaxSpanBytes)) {
+			vecSpan[r].resize(static_cast<size_t>(ullSpan));
+			range.m_ullOffset = ullFirst;
+			range.m_sSize = static_cast<size_t>(ullSpan);
+			range.m_pData = &(vecSpan[r][0]);
+			vecRanges.push_back(range);
+
+		} else {
+			for (size_t i = 0; i < sCount; i++) {
+				range.m_ullOffset = ullFirst + i * ullStride;
+				range.m_sSize = sTypeSize;
+				range.m_pData = &(vecRaw[r][i * sTypeSize]);
+				vecRanges.push_back(range);
+			}
+		}
+	}
+
+	if (!ReadRanges(vecRanges)) {
+		return false;
+	}
+
+	for (size_t r = 0; r < vecReads.size(); r++) {
+		const ClassicNcVariable & var = *(vecReads[r].m_pvar);
+		const size_t sCount = vecReads[r].m_sCount;
+		if (sCount == 0) {
+			continue;
+		}
+		const size_t sTypeSize = ClassicNcTypeSize(var.m_nType);
+		std::vector<char> & vecValues = vecRaw[r];
+
+		// Gather strided values
+		if (vecSpan[r].size() != 0) {
+			for (size_t i = 0; i < sCount; i++) {
+				memcpy(&(vecValues[i * sTypeSize]),
+					&(vecSpan[r][i * m_ullRecordBytes]), sTypeSize);
+			}
+		}
+
+		// Convert to host byte order
+		ClassicNcToHost(&(vecValues[0]), sCount, sTypeSize, vecReads[r].m_pValues);
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned long long ClassicNcFile::GetElementCount(
+	const ClassicNcVariable & var
+) const {
+	unsigned long long ullCount = 1;
+	for (size_t d = 0; d < var.m_vecDimIds.size(); d++) {
+		ullCount *= m_vecDimensions[var.m_vecDimIds[d]].m_ullSize;
+	}
+	return ullCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ClassicNcFile::ReadElements(
+	const ClassicNcVariable & var,
+	unsigned long long ullBegin,
+	size_t sCount,
+	void * pValues
+) const {
+	if ((m_fd < 0) && (m_strURL == "")) {
+		return false;
+	}
+	if ((var.m_nType == ClassicNcType_Char) ||
+	    (ClassicNcTypeSize(var.m_nType) == 0)
+	) {
+		return false;
+	}
+	if (sCount == 0) {
+		return true;
+	}
+	if (ullBegin + sCount > GetElementCount(var)) {
+		return false;
+	}
+
+	const size_t sTypeSize = ClassicNcTypeSize(var.m_nType);
+
+	// Elements of one record of a record variable, which are contiguous;
+	// the elements of other variables are all contiguous
+	unsigned long long ullRecordElements = GetElementCount(var);
+	if (var.m_fRecord) {
+		ullRecordElements /= std::max<unsigned long long>(
+			m_vecDimensions[var.m_vecDimIds[0]].m_ullSize, 1);
+	}
+	if (ullRecordElements == 0) {
+		return true;
+	}
+
+	std::vector<char> vecRaw(sCount * sTypeSize);
+	std::vector<RemoteByteRange> vecRanges;
+
+	unsigned long long ullElement = ullBegin;
+	const unsigned long long ullEnd = ullBegin + sCount;
+	while (ullElement < ullEnd) {
+		unsigned long long ullRecord = 0;
+		unsigned long long ullWithin = ullElement;
+		unsigned long long ullRun = ullEnd - ullElement;
+		if (var.m_fRecord) {
+			ullRecord = ullElement / ullRecordElements;
+			ullWithin = ullElement % ullRecordElements;
+			ullRun = std::min(ullRun, ullRecordElements - ullWithin);
+		}
+
+		RemoteByteRange range;
+		range.m_ullOffset =
+			var.m_ullBegin + ullRecord * m_ullRecordBytes + ullWithin * sTypeSize;
+		range.m_sSize = static_cast<size_t>(ullRun * sTypeSize);
+		range.m_pData = &(vecRaw[(ullElement - ullBegin) * sTypeSize]);
+		if (range.m_ullOffset + range.m_sSize > m_ullFileSize) {
+			return false;
+		}
+		vecRanges.push_back(range);
+
+		ullElement += ullRun;
+	}
+
+	if (!ReadRanges(vecRanges)) {
+		return false;
+	}
+
+	ClassicNcToHost(&(vecRaw[0]), sCount, sTypeSize, pValues);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
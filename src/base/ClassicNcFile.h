@@ -0,0 +1,420 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    ClassicNcFile.h
+///	\version October 15, 2026
+///
+
+#ifndef _CLASSICNCFILE_H_
+#define _CLASSICNCFILE_H_
+
+#include "RemoteFile.h"
+
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Result of opening a file with ClassicNcFile.
+///	</summary>
+enum ClassicNcStatus {
+	ClassicNcStatus_Success,
+	ClassicNcStatus_NotClassic,
+	ClassicNcStatus_Error
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		An attribute of a classic NetCDF file, with its values as stored
+///		in the file (big-endian, without padding).
+///	</summary>
+struct ClassicNcAttribute {
+
+	///	<summary>
+	///		Get the attribute as a string, in the same form as
+	///		GetNcAttAsString: text up to the first null character, or the
+	///		first numeric value.  Returns false if the value cannot be
+	///		represented, as the NetCDF library would.
+	///	</summary>
+	bool AsString(
+		std::string & strValue
+	) const;
+
+	///	<summary>
+	///		Get numeric value i of the attribute as a double.  Returns
+	///		false if the attribute is text or i is out of range.
+	///	</summary>
+	bool GetValue(
+		size_t i,
+		double & dValue
+	) const;
+
+	///	<summary>
+	///		Attribute name.
+	///	</summary>
+	std::string m_strName;
+
+	///	<summary>
+	///		NetCDF type of the values.
+	///	</summary>
+	int m_nType;
+
+	///	<summary>
+	///		Number of values.
+	///	</summary>
+	size_t m_sCount;
+
+	///	<summary>
+	///		Values as stored in the file.
+	///	</summary>
+	std::vector<char> m_vecData;
+};
+
+///	<summary>
+///		A vector of attributes in file order.
+///	</summary>
+typedef std::vector<ClassicNcAttribute> ClassicNcAttributeVector;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A dimension of a classic NetCDF file.
+///	</summary>
+struct ClassicNcDimension {
+
+	///	<summary>
+	///		Dimension name.
+	///	</summary>
+	std::string m_strName;
+
+	///	<summary>
+	///		Dimension size, which for the record dimension is the number
+	///		of records.
+	///	</summary>
+	unsigned long long m_ullSize;
+
+	///	<summary>
+	///		Flag indicating this is the record dimension.
+	///	</summary>
+	bool m_fRecord;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A variable of a classic NetCDF file.
+///	</summary>
+struct ClassicNcVariable {
+
+	///	<summary>
+	///		Variable name.
+	///	</summary>
+	std::string m_strName;
+
+	///	<summary>
+	///		Indices of the dimensions of the variable.
+	///	</summary>
+	std::vector<size_t> m_vecDimIds;
+
+	///	<summary>
+	///		Attributes of the variable.
+	///	</summary>
+	ClassicNcAttributeVector m_vecAttributes;
+
+	///	<summary>
+	///		NetCDF type of the values.
+	///	</summary>
+	int m_nType;
+
+	///	<summary>
+	///		Offset of the first value in the file.
+	///	</summary>
+	unsigned long long m_ullBegin;
+
+	///	<summary>
+	///		Flag indicating the first dimension is the record dimension.
+	///	</summary>
+	bool m_fRecord;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A request for values of a one-dimensional variable.
+///	</summary>
+struct ClassicNcValueRead {
+
+	///	<summary>
+	///		Variable to read.
+	///	</summary>
+	const ClassicNcVariable * m_pvar;
+
+	///	<summary>
+	///		Index of the first value.
+	///	</summary>
+	size_t m_sBegin;
+
+	///	<summary>
+	///		Number of values.
+	///	</summary>
+	size_t m_sCount;
+
+	///	<summary>
+	///		Buffer receiving the values.
+	///	</summary>
+	void * m_pValues;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A reader for the header of classic (CDF-1), 64-bit offset (CDF-2)
+///		and 64-bit data (CDF-5) NetCDF files that decodes it directly from
+///		the leading bytes of the file, without the NetCDF library.  The
+///		values of one-dimensional variables can then be read with a single
+///		pread.  NetCDF-4 files, and classic files whose header cannot be
+///		decoded, are reported so that they can be read through the
+///		library instead.  Remote files (see IsRemoteURL) are read with
+///		byte-range requests through the shared RemoteFileClient.
+///	</summary>
+class ClassicNcFile {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	ClassicNcFile();
+
+	///	<summary>
+	///		Destructor.
+	///	</summary>
+	~ClassicNcFile();
+
+private:
+	///	<summary>
+	///		Not copyable.
+	///	</summary>
+	ClassicNcFile(const ClassicNcFile &);
+	ClassicNcFile & operator=(const ClassicNcFile &);
+
+public:
+	///	<summary>
+	///		Open the given file and decode its header.
+	///	</summary>
+	ClassicNcStatus Open(
+		const std::string & strFilename
+	);
+
+	///	<summary>
+	///		Close the file.
+	///	</summary>
+	void Close();
+
+	///	<summary>
+	///		Get the reason the header could not be decoded.
+	///	</summary>
+	const std::string & GetError() const {
+		return m_strError;
+	}
+
+	///	<summary>
+	///		Get the dimensions.
+	///	</summary>
+	const std::vector<ClassicNcDimension> & GetDimensions() const {
+		return m_vecDimensions;
+	}
+
+	///	<summary>
+	///		Get the global attributes.
+	///	</summary>
+	const ClassicNcAttributeVector & GetAttributes() const {
+		return m_vecAttributes;
+	}
+
+	///	<summary>
+	///		Get the variables.
+	///	</summary>
+	const std::vector<ClassicNcVariable> & GetVariables() const {
+		return m_vecVariables;
+	}
+
+	///	<summary>
+	///		Get the number of bytes between consecutive records of a
+	///		record variable.
+	///	</summary>
+	unsigned long long GetRecordBytes() const {
+		return m_ullRecordBytes;
+	}
+
+	///	<summary>
+	///		Get the size of a value of the given NetCDF type, or zero if
+	///		the type is not valid in a classic format file.
+	///	</summary>
+	static size_t GetTypeSize(
+		int nType
+	);
+
+	///	<summary>
+	///		Find a variable by name, returning its index or -1.
+	///	</summary>
+	int FindVariable(
+		const std::string & strName
+	) const;
+
+	///	<summary>
+	///		Read values sBegin to sBegin+sCount of a one-dimensional
+	///		variable of any numeric type into a buffer of the same type,
+	///		converting them to host byte order.  Returns false if the
+	///		values are not all present in the file.
+	///	</summary>
+	bool ReadValues(
+		const ClassicNcVariable & var,
+		size_t sBegin,
+		size_t sCount,
+		void * pValues
+	) const;
+
+	///	<summary>
+	///		Read the values of several variables at once, so that the
+	///		reads of a remote file are coalesced and issued in parallel.
+	///	</summary>
+	bool ReadValues(
+		const std::vector<ClassicNcValueRead> & vecReads
+	) const;
+
+	///	<summary>
+	///		Get the number of elements of a variable.
+	///	</summary>
+	unsigned long long GetElementCount(
+		const ClassicNcVariable & var
+	) const;
+
+	///	<summary>
+	///		Read elements ullBegin to ullBegin+sCount, in row-major order,
+	///		of a variable of any numeric type and rank into a buffer of the
+	///		same type, converting them to host byte order.  Each record of
+	///		a record variable spanned is read with one range.  Returns
+	///		false if the elements are not all present in the file.
+	///	</summary>
+	bool ReadElements(
+		const ClassicNcVariable & var,
+		unsigned long long ullBegin,
+		size_t sCount,
+		void * pValues
+	) const;
+
+protected:
+	///	<summary>
+	///		Read the given ranges of the file.
+	///	</summary>
+	bool ReadRanges(
+		const std::vector<RemoteByteRange> & vecRanges
+	) const;
+
+	///	<summary>
+	///		Make sure sSize bytes of the header starting at sPos are
+	///		read, extending m_vecHeader as needed.
+	///	</summary>
+	bool Require(
+		size_t sPos,
+		size_t sSize
+	);
+
+	///	<summary>
+	///		Decode big-endian integers from the header.
+	///	</summary>
+	bool ReadUInt32(size_t & sPos, unsigned long long & ullValue);
+	bool ReadUInt64(size_t & sPos, unsigned long long & ullValue);
+
+	///	<summary>
+	///		Decode a count (NON_NEG), whose width depends on the version.
+	///	</summary>
+	bool ReadCount(size_t & sPos, unsigned long long & ullValue);
+
+	///	<summary>
+	///		Decode a name.
+	///	</summary>
+	bool ReadName(size_t & sPos, std::string & strName);
+
+	///	<summary>
+	///		Decode a list tag and its number of elements; a list that is
+	///		absent has zero elements.
+	///	</summary>
+	bool ReadListHeader(
+		size_t & sPos,
+		unsigned long long ullTag,
+		unsigned long long & ullCount
+	);
+
+	///	<summary>
+	///		Decode an attribute list.
+	///	</summary>
+	bool ReadAttributes(
+		size_t & sPos,
+		ClassicNcAttributeVector & vecAttributes
+	);
+
+	///	<summary>
+	///		Set the error message and return false.
+	///	</summary>
+	bool Fail(
+		const char * szError
+	);
+
+protected:
+	///	<summary>
+	///		File descriptor, or -1 if not open.
+	///	</summary>
+	int m_fd;
+
+	///	<summary>
+	///		URL of a remote file, or empty for a local file.
+	///	</summary>
+	std::string m_strURL;
+
+	///	<summary>
+	///		Size of the file.
+	///	</summary>
+	unsigned long long m_ullFileSize;
+
+	///	<summary>
+	///		Format version: 1, 2 or 5.
+	///	</summary>
+	int m_nVersion;
+
+	///	<summary>
+	///		Bytes of the header read so far.
+	///	</summary>
+	std::vector<char> m_vecHeader;
+
+	///	<summary>
+	///		Bytes between consecutive records of a record variable.
+	///	</summary>
+	unsigned long long m_ullRecordBytes;
+
+	///	<summary>
+	///		Dimensions.
+	///	</summary>
+	std::vector<ClassicNcDimension> m_vecDimensions;
+
+	///	<summary>
+	///		Global attributes.
+	///	</summary>
+	ClassicNcAttributeVector m_vecAttributes;
+
+	///	<summary>
+	///		Variables.
+	///	</summary>
+	std::vector<ClassicNcVariable> m_vecVariables;
+
+	///	<summary>
+	///		Reason the header could not be decoded.
+	///	</summary>
+	std::string m_strError;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
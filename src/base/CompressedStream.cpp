@@ -0,0 +1,833 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    CompressedStream.cpp
+///	\version October 14, 2026
+///
+
+#include "CompressedStream.h"
+#include "Exception.h"
+
+#include <sys/types.h>
+#include <cstring>
+#include <algorithm>
+
+#if defined(HYPERION_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(HYPERION_ZSTD)
+#include <zstd.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check if a string ends with the given suffix.
+///	</summary>
+static bool EndsWith(
+	const std::string & str,
+	const char * szSuffix
+) {
+	const size_t sLength = strlen(szSuffix);
+	return (str.length() > sLength) &&
+		(str.compare(str.length() - sLength, sLength, szSuffix) == 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CompressionFormat CompressionFormatFromFilename(
+	const std::string & strFilename
+) {
+	if (EndsWith(strFilename, ".gz")) {
+		return CompressionFormat_Gzip;
+	}
+	if (EndsWith(strFilename, ".zst")) {
+		return CompressionFormat_Zstd;
+	}
+	return CompressionFormat_None;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * CompressionFormatExtension(
+	CompressionFormat eFormat
+) {
+	if (eFormat == CompressionFormat_Gzip) {
+		return ".gz";
+	}
+	if (eFormat == CompressionFormat_Zstd) {
+		return ".zst";
+	}
+	return "";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool CompressionFormatIsAvailable(
+	CompressionFormat eFormat
+) {
+	if (eFormat == CompressionFormat_Gzip) {
+#if defined(HYPERION_ZLIB)
+		return true;
+#else
+		return false;
+#endif
+	}
+	if (eFormat == CompressionFormat_Zstd) {
+#if defined(HYPERION_ZSTD)
+		return true;
+#else
+		return false;
+#endif
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the name of a compression for error messages.
+///	</summary>
+static const char * CompressionFormatName(
+	CompressionFormat eFormat
+) {
+	if (eFormat == CompressionFormat_Gzip) {
+		return "gzip";
+	}
+	if (eFormat == CompressionFormat_Zstd) {
+		return "zstd";
+	}
+	return "uncompressed";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the error for a file whose compression this build does not
+///		support, with the option of mk/config.make that enables it.
+///	</summary>
+static std::string CompressionFormatUnavailable(
+	const char * szAction,
+	const std::string & strFilename,
+	CompressionFormat eFormat
+) {
+	std::string strOption =
+		(eFormat == CompressionFormat_Zstd)?("ZSTD"):("ZLIB");
+
+	return std::string("Unable to ") + szAction + std::string(" \"")
+		+ strFilename + std::string("\": built without ")
+		+ CompressionFormatName(eFormat)
+		+ std::string(" support (rebuild with ") + strOption
+		+ std::string("=TRUE in mk/config.make)");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string CompressionFormatCheckWrite(
+	const std::string & strFilename
+) {
+	CompressionFormat eFormat = CompressionFormatFromFilename(strFilename);
+	if (!CompressionFormatIsAvailable(eFormat)) {
+		return CompressionFormatUnavailable("write", strFilename, eFormat);
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CompressedFileCodec
+///////////////////////////////////////////////////////////////////////////////
+
+struct CompressedFileCodec {
+
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	CompressedFileCodec() :
+		m_fWrite(false)
+#if defined(HYPERION_ZLIB)
+		, m_fZlibInit(false)
+#endif
+#if defined(HYPERION_ZSTD)
+		, m_pzcs(NULL)
+		, m_pzds(NULL)
+#endif
+	{ }
+
+	///	<summary>
+	///		Destructor.
+	///	</summary>
+	~CompressedFileCodec() {
+#if defined(HYPERION_ZLIB)
+		if (m_fZlibInit) {
+			if (m_fWrite) {
+				deflateEnd(&m_zs);
+			} else {
+				inflateEnd(&m_zs);
+			}
+		}
+#endif
+#if defined(HYPERION_ZSTD)
+		if (m_pzcs != NULL) {
+			ZSTD_freeCStream(m_pzcs);
+		}
+		if (m_pzds != NULL) {
+			ZSTD_freeDStream(m_pzds);
+		}
+#endif
+	}
+
+	///	<summary>
+	///		Flag indicating the codec compresses.
+	///	</summary>
+	bool m_fWrite;
+
+	///	<summary>
+	///		Compressed bytes waiting to be written.
+	///	</summary>
+	std::vector<char> m_vecOut;
+
+#if defined(HYPERION_ZLIB)
+	///	<summary>
+	///		zlib stream, and a flag indicating it is initialized.
+	///	</summary>
+	z_stream m_zs;
+	bool m_fZlibInit;
+#endif
+
+#if defined(HYPERION_ZSTD)
+	///	<summary>
+	///		Zstandard streams.
+	///	</summary>
+	ZSTD_CStream * m_pzcs;
+	ZSTD_DStream * m_pzds;
+#endif
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CompressedFileBuf
+///////////////////////////////////////////////////////////////////////////////
+
+const size_t CompressedFileBuf::BufferBytes = 256 * 1024;
+
+///////////////////////////////////////////////////////////////////////////////
+
+CompressedFileBuf::CompressedFileBuf() :
+	m_fp(NULL),
+	m_fWrite(false),
+	m_fError(false),
+	m_fEnd(false),
+	m_eFormat(CompressionFormat_None),
+	m_pcodec(NULL),
+	m_sInBegin(0),
+	m_sInEnd(0)
+{ }
+
+///////////////////////////////////////////////////////////////////////////////
+
+CompressedFileBuf::~CompressedFileBuf() {
+	Close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string CompressedFileBuf::OpenForWrite(
+	const std::string & strFilename,
+	CompressionFormat eFormat
+) {
+	if (IsOpen()) {
+		return std::string("File already open");
+	}
+	if (!CompressionFormatIsAvailable(eFormat)) {
+		return CompressionFormatUnavailable("write", strFilename, eFormat);
+	}
+
+	m_fp = fopen(strFilename.c_str(), "wb");
+	if (m_fp == NULL) {
+		return std::string("Unable to open file \"") + strFilename
+			+ std::string("\" for writing");
+	}
+
+	m_strFilename = strFilename;
+	m_fWrite = true;
+	m_fError = false;
+	m_fEnd = false;
+	m_eFormat = eFormat;
+
+	m_pcodec = new CompressedFileCodec;
+	m_pcodec->m_fWrite = true;
+
+#if defined(HYPERION_ZLIB)
+	if (eFormat == CompressionFormat_Gzip) {
+		memset(&(m_pcodec->m_zs), 0, sizeof(z_stream));
+		// A window of 15 bits plus 16 writes a gzip header and trailer
+		if (deflateInit2(&(m_pcodec->m_zs), Z_DEFAULT_COMPRESSION,
+			Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK
+		) {
+			Close();
+			return std::string("Unable to initialize gzip compression");
+		}
+		m_pcodec->m_fZlibInit = true;
+		m_pcodec->m_vecOut.resize(BufferBytes);
+	}
+#endif
+#if defined(HYPERION_ZSTD)
+	if (eFormat == CompressionFormat_Zstd) {
+		m_pcodec->m_pzcs = ZSTD_createCStream();
+		if ((m_pcodec->m_pzcs == NULL) ||
+		    ZSTD_isError(ZSTD_initCStream(m_pcodec->m_pzcs, ZSTD_CLEVEL_DEFAULT))
+		) {
+			Close();
+			return std::string("Unable to initialize zstd compression");
+		}
+		m_pcodec->m_vecOut.resize(ZSTD_CStreamOutSize());
+	}
+#endif
+
+	m_vecText.resize(BufferBytes);
+	setp(&(m_vecText[0]), &(m_vecText[0]) + m_vecText.size());
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string CompressedFileBuf::OpenForRead(
+	const std::string & strFilename
+) {
+	if (IsOpen()) {
+		return std::string("File already open");
+	}
+
+	m_fp = fopen(strFilename.c_str(), "rb");
+	if (m_fp == NULL) {
+		return std::string("Unable to open file \"") + strFilename
+			+ std::string("\" for reading");
+	}
+
+	m_strFilename = strFilename;
+	m_fWrite = false;
+	m_fError = false;
+	m_fEnd = false;
+	m_eFormat = CompressionFormat_None;
+
+	m_pcodec = new CompressedFileCodec;
+	m_pcodec->m_fWrite = false;
+
+	// The compression is identified by the leading magic bytes
+	m_vecIn.resize(BufferBytes);
+	m_sInBegin = 0;
+	m_sInEnd = 0;
+	while ((m_sInEnd < 4) && ReadInput()) { }
+
+	const unsigned char * pMagic =
+		reinterpret_cast<const unsigned char *>(&(m_vecIn[0]));
+
+	if ((m_sInEnd >= 2) && (pMagic[0] == 0x1f) && (pMagic[1] == 0x8b)) {
+		m_eFormat = CompressionFormat_Gzip;
+
+	} else if ((m_sInEnd >= 4) &&
+		(pMagic[0] == 0x28) && (pMagic[1] == 0xb5) &&
+		(pMagic[2] == 0x2f) && (pMagic[3] == 0xfd)
+	) {
+		m_eFormat = CompressionFormat_Zstd;
+	}
+
+	if (!CompressionFormatIsAvailable(m_eFormat)) {
+		CompressionFormat eFormat = m_eFormat;
+		Close();
+		return CompressionFormatUnavailable("read", strFilename, eFormat);
+	}
+
+#if defined(HYPERION_ZLIB)
+	if (m_eFormat == CompressionFormat_Gzip) {
+		memset(&(m_pcodec->m_zs), 0, sizeof(z_stream));
+		if (inflateInit2(&(m_pcodec->m_zs), 15 + 16) != Z_OK) {
+			Close();
+			return std::string("Unable to initialize gzip decompression");
+		}
+		m_pcodec->m_fZlibInit = true;
+	}
+#endif
+#if defined(HYPERION_ZSTD)
+	if (m_eFormat == CompressionFormat_Zstd) {
+		m_pcodec->m_pzds = ZSTD_createDStream();
+		if ((m_pcodec->m_pzds == NULL) ||
+		    ZSTD_isError(ZSTD_initDStream(m_pcodec->m_pzds))
+		) {
+			Close();
+			return std::string("Unable to initialize zstd decompression");
+		}
+	}
+#endif
+
+	m_vecText.resize(BufferBytes);
+	setg(&(m_vecText[0]), &(m_vecText[0]), &(m_vecText[0]));
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string CompressedFileBuf::Close() {
+	if (m_fp == NULL) {
+		return std::string("");
+	}
+
+	if (m_fWrite) {
+		if (FlushText()) {
+			Compress(NULL, 0, true);
+		}
+	}
+
+	if ((fclose(m_fp) != 0) && m_fWrite) {
+		m_fError = true;
+	}
+	m_fp = NULL;
+
+	delete m_pcodec;
+	m_pcodec = NULL;
+
+	setp(NULL, NULL);
+	setg(NULL, NULL, NULL);
+
+	std::vector<char>().swap(m_vecText);
+	std::vector<char>().swap(m_vecIn);
+	m_sInBegin = 0;
+	m_sInEnd = 0;
+
+	if (m_fError) {
+		return std::string("Error writing to file \"") + m_strFilename
+			+ std::string("\"");
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool CompressedFileBuf::Write(
+	const char * pData,
+	size_t sSize
+) {
+	return (xsputn(pData, static_cast<std::streamsize>(sSize))
+		== static_cast<std::streamsize>(sSize));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool CompressedFileBuf::FlushText() {
+	if ((m_fp == NULL) || (!m_fWrite)) {
+		return false;
+	}
+	const size_t sSize = static_cast<size_t>(pptr() - pbase());
+	setp(&(m_vecText[0]), &(m_vecText[0]) + m_vecText.size());
+	if (sSize == 0) {
+		return !m_fError;
+	}
+	return Compress(&(m_vecText[0]), sSize, false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool CompressedFileBuf::Compress(
+	const char * pData,
+	size_t sSize,
+	bool fFinish
+) {
+	if (m_fError) {
+		return false;
+	}
+
+	if (m_eFormat == CompressionFormat_None) {
+		if ((sSize != 0) && (fwrite(pData, 1, sSize, m_fp) != sSize)) {
+			m_fError = true;
+		}
+		return !m_fError;
+	}
+
+	std::vector<char> & vecOut = m_pcodec->m_vecOut;
+
+#if defined(HYPERION_ZLIB)
+	if (m_eFormat == CompressionFormat_Gzip) {
+		z_stream & zs = m_pcodec->m_zs;
+		zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(pData));
+		zs.avail_in = static_cast<uInt>(sSize);
+
+		for (;;) {
+			zs.next_out = reinterpret_cast<Bytef *>(&(vecOut[0]));
+			zs.avail_out = static_cast<uInt>(vecOut.size());
+
+			int iResult = deflate(&zs, (fFinish)?(Z_FINISH):(Z_NO_FLUSH));
+			if (iResult == Z_STREAM_ERROR) {
+				m_fError = true;
+				return false;
+			}
+
+			size_t sOut = vecOut.size() - zs.avail_out;
+			if ((sOut != 0) && (fwrite(&(vecOut[0]), 1, sOut, m_fp) != sOut)) {
+				m_fError = true;
+				return false;
+			}
+
+			if (fFinish) {
+				if (iResult == Z_STREAM_END) {
+					break;
+				}
+			} else if (zs.avail_out != 0) {
+				break;
+			}
+		}
+		return true;
+	}
+#endif
+
+#if defined(HYPERION_ZSTD)
+	if (m_eFormat == CompressionFormat_Zstd) {
+		ZSTD_inBuffer zin = { pData, sSize, 0 };
+
+		for (;;) {
+			ZSTD_outBuffer zout = { &(vecOut[0]), vecOut.size(), 0 };
+
+			size_t sRemaining = ZSTD_compressStream2(
+				m_pcodec->m_pzcs, &zout, &zin,
+				(fFinish)?(ZSTD_e_end):(ZSTD_e_continue));
+			if (ZSTD_isError(sRemaining)) {
+				m_fError = true;
+				return false;
+			}
+
+			if ((zout.pos != 0) &&
+			    (fwrite(&(vecOut[0]), 1, zout.pos, m_fp) != zout.pos)
+			) {
+				m_fError = true;
+				return false;
+			}
+
+			if (fFinish) {
+				if (sRemaining == 0) {
+					break;
+				}
+			} else if (zin.pos == zin.size) {
+				break;
+			}
+		}
+		return true;
+	}
+#endif
+
+	m_fError = true;
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool CompressedFileBuf::ReadInput() {
+	if (m_sInBegin == m_sInEnd) {
+		m_sInBegin = 0;
+		m_sInEnd = 0;
+	}
+	if (m_sInEnd == m_vecIn.size()) {
+		return false;
+	}
+	size_t sRead =
+		fread(&(m_vecIn[m_sInEnd]), 1, m_vecIn.size() - m_sInEnd, m_fp);
+	m_sInEnd += sRead;
+	return (sRead != 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t CompressedFileBuf::Decompress() {
+	if (m_fEnd || m_fError) {
+		return 0;
+	}
+
+	if (m_eFormat == CompressionFormat_None) {
+		if (m_sInBegin != m_sInEnd) {
+			size_t sSize = m_sInEnd - m_sInBegin;
+			memcpy(&(m_vecText[0]), &(m_vecIn[m_sInBegin]), sSize);
+			m_sInBegin = m_sInEnd;
+			return sSize;
+		}
+		size_t sSize = fread(&(m_vecText[0]), 1, m_vecText.size(), m_fp);
+		if (sSize == 0) {
+			m_fEnd = true;
+		}
+		return sSize;
+	}
+
+#if defined(HYPERION_ZLIB)
+	if (m_eFormat == CompressionFormat_Gzip) {
+		z_stream & zs = m_pcodec->m_zs;
+
+		for (;;) {
+			if ((m_sInBegin == m_sInEnd) && !ReadInput()) {
+				// Truncated stream; the reader sees an early end of file
+				m_fEnd = true;
+				return 0;
+			}
+
+			zs.next_in = reinterpret_cast<Bytef *>(&(m_vecIn[m_sInBegin]));
+			zs.avail_in = static_cast<uInt>(m_sInEnd - m_sInBegin);
+			zs.next_out = reinterpret_cast<Bytef *>(&(m_vecText[0]));
+			zs.avail_out = static_cast<uInt>(m_vecText.size());
+
+			int iResult = inflate(&zs, Z_NO_FLUSH);
+
+			m_sInBegin = m_sInEnd - zs.avail_in;
+			size_t sOut = m_vecText.size() - zs.avail_out;
+
+			if (iResult == Z_STREAM_END) {
+				// Concatenated gzip members are read as one stream
+				if ((m_sInBegin != m_sInEnd) || ReadInput()) {
+					inflateReset(&zs);
+				} else {
+					m_fEnd = true;
+				}
+
+			} else if ((iResult != Z_OK) && (iResult != Z_BUF_ERROR)) {
+				m_fError = true;
+				return sOut;
+			}
+
+			if ((sOut != 0) || m_fEnd) {
+				return sOut;
+			}
+		}
+	}
+#endif
+
+#if defined(HYPERION_ZSTD)
+	if (m_eFormat == CompressionFormat_Zstd) {
+		for (;;) {
+			if ((m_sInBegin == m_sInEnd) && !ReadInput()) {
+				m_fEnd = true;
+				return 0;
+			}
+
+			ZSTD_inBuffer zin =
+				{ &(m_vecIn[m_sInBegin]), m_sInEnd - m_sInBegin, 0 };
+			ZSTD_outBuffer zout = { &(m_vecText[0]), m_vecText.size(), 0 };
+
+			size_t sResult = ZSTD_decompressStream(m_pcodec->m_pzds, &zout, &zin);
+
+			m_sInBegin += zin.pos;
+
+			if (ZSTD_isError(sResult)) {
+				m_fError = true;
+				return zout.pos;
+			}
+			if (zout.pos != 0) {
+				return zout.pos;
+			}
+		}
+	}
+#endif
+
+	m_fError = true;
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CompressedFileBuf::int_type CompressedFileBuf::overflow(
+	int_type ch
+) {
+	if (!FlushText()) {
+		return traits_type::eof();
+	}
+	if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+		*pptr() = traits_type::to_char_type(ch);
+		pbump(1);
+	}
+	return traits_type::not_eof(ch);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::streamsize CompressedFileBuf::xsputn(
+	const char * pData,
+	std::streamsize sSize
+) {
+	if ((m_fp == NULL) || (!m_fWrite)) {
+		return 0;
+	}
+
+	std::streamsize sWritten = 0;
+	while (sWritten < sSize) {
+		std::streamsize sSpace = epptr() - pptr();
+		if (sSpace == 0) {
+			if (!FlushText()) {
+				break;
+			}
+			continue;
+		}
+		std::streamsize sCopy = std::min(sSpace, sSize - sWritten);
+		memcpy(pptr(), pData + sWritten, static_cast<size_t>(sCopy));
+		pbump(static_cast<int>(sCopy));
+		sWritten += sCopy;
+	}
+	return sWritten;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int CompressedFileBuf::sync() {
+	// Text is passed to the compressor but the compressed stream is not
+	// flushed, which would reduce the compression of frequent flushes
+	if ((m_fp != NULL) && m_fWrite) {
+		return (FlushText())?(0):(-1);
+	}
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CompressedFileBuf::int_type CompressedFileBuf::underflow() {
+	if ((m_fp == NULL) || m_fWrite) {
+		return traits_type::eof();
+	}
+	if (gptr() < egptr()) {
+		return traits_type::to_int_type(*gptr());
+	}
+	size_t sSize = Decompress();
+	if (sSize == 0) {
+		return traits_type::eof();
+	}
+	setg(&(m_vecText[0]), &(m_vecText[0]), &(m_vecText[0]) + sSize);
+	return traits_type::to_int_type(*gptr());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CompressedOutputStream
+///////////////////////////////////////////////////////////////////////////////
+
+CompressedOutputStream::CompressedOutputStream(
+	const std::string & strFilename
+) :
+	std::ostream(NULL)
+{
+	std::string strError = CompressionFormatCheckWrite(strFilename);
+	if (strError != "") {
+		_EXCEPTION1("%s", strError.c_str());
+	}
+
+	m_buf.OpenForWrite(
+		strFilename, CompressionFormatFromFilename(strFilename));
+	rdbuf(&m_buf);
+	if (!m_buf.IsOpen()) {
+		setstate(std::ios_base::failbit);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CompressedOutputStream::close() {
+	if (m_buf.Close() != "") {
+		setstate(std::ios_base::badbit);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CompressedInputStream
+///////////////////////////////////////////////////////////////////////////////
+
+CompressedInputStream::CompressedInputStream(
+	const std::string & strFilename
+) :
+	std::istream(NULL)
+{
+	std::string strError = m_buf.OpenForRead(strFilename);
+	rdbuf(&m_buf);
+	if (!m_buf.IsOpen()) {
+		// A missing file is reported by the caller, as for std::ifstream
+		if (!CompressionFormatIsAvailable(m_buf.GetFormat())) {
+			_EXCEPTION1("%s", strError.c_str());
+		}
+		setstate(std::ios_base::failbit);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CompressedFileOpenWrite
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write callback of a FILE opened by CompressedFileOpenWrite.
+///	</summary>
+#if defined(__APPLE__) || defined(__FreeBSD__)
+static int CompressedFileCookieWrite(
+	void * pCookie,
+	const char * pData,
+	int nSize
+) {
+	CompressedFileBuf * pbuf = reinterpret_cast<CompressedFileBuf *>(pCookie);
+	if (!pbuf->Write(pData, static_cast<size_t>(nSize))) {
+		return -1;
+	}
+	return nSize;
+}
+#else
+static ssize_t CompressedFileCookieWrite(
+	void * pCookie,
+	const char * pData,
+	size_t sSize
+) {
+	CompressedFileBuf * pbuf = reinterpret_cast<CompressedFileBuf *>(pCookie);
+	if (!pbuf->Write(pData, sSize)) {
+		return 0;
+	}
+	return static_cast<ssize_t>(sSize);
+}
+#endif
+
+///	<summary>
+///		Close callback of a FILE opened by CompressedFileOpenWrite.
+///	</summary>
+static int CompressedFileCookieClose(
+	void * pCookie
+) {
+	CompressedFileBuf * pbuf = reinterpret_cast<CompressedFileBuf *>(pCookie);
+	std::string strError = pbuf->Close();
+	delete pbuf;
+	return (strError == "")?(0):(EOF);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FILE * CompressedFileOpenWrite(
+	const std::string & strFilename
+) {
+	CompressionFormat eFormat = CompressionFormatFromFilename(strFilename);
+	if (eFormat == CompressionFormat_None) {
+		return fopen(strFilename.c_str(), "w");
+	}
+	std::string strError = CompressionFormatCheckWrite(strFilename);
+	if (strError != "") {
+		_EXCEPTION1("%s", strError.c_str());
+	}
+
+	CompressedFileBuf * pbuf = new CompressedFileBuf;
+	if (pbuf->OpenForWrite(strFilename, eFormat) != "") {
+		delete pbuf;
+		return NULL;
+	}
+
+#if defined(__APPLE__) || defined(__FreeBSD__)
+	FILE * fp = funopen(pbuf, NULL,
+		CompressedFileCookieWrite, NULL, CompressedFileCookieClose);
+#else
+	cookie_io_functions_t funcs;
+	funcs.read = NULL;
+	funcs.write = CompressedFileCookieWrite;
+	funcs.seek = NULL;
+	funcs.close = CompressedFileCookieClose;
+	FILE * fp = fopencookie(pbuf, "w", funcs);
+#endif
+	if (fp == NULL) {
+		pbuf->Close();
+		delete pbuf;
+	}
+	return fp;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
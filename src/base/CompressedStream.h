@@ -0,0 +1,312 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    CompressedStream.h
+///	\version October 14, 2026
+///
+
+#ifndef _COMPRESSEDSTREAM_H_
+#define _COMPRESSEDSTREAM_H_
+
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Compression applied to an output file, chosen by its extension.
+///	</summary>
+enum CompressionFormat {
+	CompressionFormat_None,
+	CompressionFormat_Gzip,
+	CompressionFormat_Zstd
+};
+
+///	<summary>
+///		Get the compression of a file from its extension: ".gz" for gzip
+///		and ".zst" for Zstandard.
+///	</summary>
+CompressionFormat CompressionFormatFromFilename(
+	const std::string & strFilename
+);
+
+///	<summary>
+///		Get the extension of files with the given compression, or an
+///		empty string if uncompressed.
+///	</summary>
+const char * CompressionFormatExtension(
+	CompressionFormat eFormat
+);
+
+///	<summary>
+///		Check if support for the given compression was compiled in.
+///	</summary>
+bool CompressionFormatIsAvailable(
+	CompressionFormat eFormat
+);
+
+///	<summary>
+///		Check that a file can be written with the compression of its
+///		extension in this build.  Returns an error naming the option of
+///		mk/config.make that enables the compression, or an empty string.
+///	</summary>
+std::string CompressionFormatCheckWrite(
+	const std::string & strFilename
+);
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		State of the compressor or decompressor of a CompressedFileBuf.
+///	</summary>
+struct CompressedFileCodec;
+
+///	<summary>
+///		A std::streambuf that reads or writes a file through a streaming
+///		compressor.  Text is passed to the compressor in large blocks, so
+///		the whole file is never held in memory.  Files opened for reading
+///		are decompressed according to their leading magic bytes, so that
+///		uncompressed files are read unchanged whatever their name.
+///	</summary>
+class CompressedFileBuf : public std::streambuf {
+
+public:
+	///	<summary>
+	///		Bytes of text buffered before being passed to the compressor.
+	///	</summary>
+	static const size_t BufferBytes;
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	CompressedFileBuf();
+
+	///	<summary>
+	///		Destructor.  Closes the file if it is open.
+	///	</summary>
+	virtual ~CompressedFileBuf();
+
+private:
+	///	<summary>
+	///		Not copyable.
+	///	</summary>
+	CompressedFileBuf(const CompressedFileBuf &);
+	CompressedFileBuf & operator=(const CompressedFileBuf &);
+
+public:
+	///	<summary>
+	///		Open a file for writing with the given compression.  Returns
+	///		an error message on failure.
+	///	</summary>
+	std::string OpenForWrite(
+		const std::string & strFilename,
+		CompressionFormat eFormat
+	);
+
+	///	<summary>
+	///		Open a file for reading, detecting its compression.  Returns
+	///		an error message on failure.
+	///	</summary>
+	std::string OpenForRead(
+		const std::string & strFilename
+	);
+
+	///	<summary>
+	///		Check if the file is open.
+	///	</summary>
+	bool IsOpen() const {
+		return (m_fp != NULL);
+	}
+
+	///	<summary>
+	///		Get the compression of the open file.
+	///	</summary>
+	CompressionFormat GetFormat() const {
+		return m_eFormat;
+	}
+
+	///	<summary>
+	///		Finish the compressed stream and close the file.  Returns an
+	///		error message if any part of the file could not be written.
+	///	</summary>
+	std::string Close();
+
+	///	<summary>
+	///		Write bytes directly, bypassing the std::streambuf interface.
+	///	</summary>
+	bool Write(
+		const char * pData,
+		size_t sSize
+	);
+
+protected:
+	///	<summary>
+	///		Pass the buffered text to the compressor.
+	///	</summary>
+	bool FlushText();
+
+	///	<summary>
+	///		Compress text and write the output.  If fFinish is set the
+	///		compressed stream is ended.
+	///	</summary>
+	bool Compress(
+		const char * pData,
+		size_t sSize,
+		bool fFinish
+	);
+
+	///	<summary>
+	///		Read more compressed bytes from the file into m_vecIn.
+	///		Returns false at the end of the file.
+	///	</summary>
+	bool ReadInput();
+
+	///	<summary>
+	///		Decompress into the text buffer.  Returns the number of bytes
+	///		of text produced, or zero at the end of the stream.
+	///	</summary>
+	size_t Decompress();
+
+protected:
+	virtual int_type overflow(int_type ch);
+
+	virtual std::streamsize xsputn(const char * pData, std::streamsize sSize);
+
+	virtual int sync();
+
+	virtual int_type underflow();
+
+protected:
+	///	<summary>
+	///		The file.
+	///	</summary>
+	FILE * m_fp;
+
+	///	<summary>
+	///		Flag indicating the file is opened for writing.
+	///	</summary>
+	bool m_fWrite;
+
+	///	<summary>
+	///		Flag indicating a write has failed.
+	///	</summary>
+	bool m_fError;
+
+	///	<summary>
+	///		Flag indicating the end of the compressed stream was reached.
+	///	</summary>
+	bool m_fEnd;
+
+	///	<summary>
+	///		Compression of the file.
+	///	</summary>
+	CompressionFormat m_eFormat;
+
+	///	<summary>
+	///		Compressor or decompressor.
+	///	</summary>
+	CompressedFileCodec * m_pcodec;
+
+	///	<summary>
+	///		Uncompressed text.
+	///	</summary>
+	std::vector<char> m_vecText;
+
+	///	<summary>
+	///		Compressed bytes, and the range of them not yet decompressed.
+	///	</summary>
+	std::vector<char> m_vecIn;
+	size_t m_sInBegin;
+	size_t m_sInEnd;
+
+	///	<summary>
+	///		Path of the file, for error messages.
+	///	</summary>
+	std::string m_strFilename;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A std::ostream writing a file compressed according to its
+///		extension, in place of std::ofstream.
+///	</summary>
+class CompressedOutputStream : public std::ostream {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	CompressedOutputStream(
+		const std::string & strFilename
+	);
+
+	///	<summary>
+	///		Check if the file is open.
+	///	</summary>
+	bool is_open() const {
+		return m_buf.IsOpen();
+	}
+
+	///	<summary>
+	///		Finish writing the file, setting badbit on failure.
+	///	</summary>
+	void close();
+
+protected:
+	///	<summary>
+	///		The buffer.
+	///	</summary>
+	CompressedFileBuf m_buf;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A std::istream reading a file that may be compressed, in place of
+///		std::ifstream.
+///	</summary>
+class CompressedInputStream : public std::istream {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	CompressedInputStream(
+		const std::string & strFilename
+	);
+
+	///	<summary>
+	///		Check if the file is open.
+	///	</summary>
+	bool is_open() const {
+		return m_buf.IsOpen();
+	}
+
+protected:
+	///	<summary>
+	///		The buffer.
+	///	</summary>
+	CompressedFileBuf m_buf;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Open a FILE for writing, compressed according to the extension of
+///		strFilename.  The compressed stream is finished by fclose, which
+///		fails if any part of the file could not be written.  Returns NULL
+///		if the file cannot be opened.
+///	</summary>
+FILE * CompressedFileOpenWrite(
+	const std::string & strFilename
+);
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
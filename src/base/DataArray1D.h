@@ -20,6 +20,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "Exception.h"
+#include "DataArrayAllocator.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -35,6 +36,7 @@ public:
 	///	</summary>
 	DataArray1D() :
 		m_fOwnsData(true),
+		m_fMapped(false),
 		m_sSize(0),
 		m_data(NULL)
 	{ }
@@ -44,9 +46,12 @@ public:
 	///	</summary>
 	DataArray1D(
 		size_t sSize,
-		bool fAllocate = true
+		bool fAllocate = true,
+		const DataArrayPolicy & policy = DataArrayPolicy()
 	) :
 		m_fOwnsData(true),
+		m_policy(policy),
+		m_fMapped(false),
 		m_sSize(sSize),
 		m_data(NULL)
 	{
@@ -60,6 +65,8 @@ public:
 	///	</summary>
 	DataArray1D(const DataArray1D<T> & da) :
 		m_fOwnsData(true),
+		m_policy(da.m_policy),
+		m_fMapped(false),
 		m_sSize(0),
 		m_data(NULL)
 	{
@@ -97,21 +104,21 @@ public:
 			_EXCEPTIONT("Attempting to Allocate() on attached DataArray1D");
 		}
 
-		Detach();
-
 		if (sSize == 0) {
+			Detach();
+
 			m_sSize = 0;
 
 			return;
 		}
 		if ((m_data == NULL) || (m_sSize != sSize)) {
-			m_sSize = sSize;
+			Detach();
 
-			m_data = reinterpret_cast<T *>(malloc(GetByteSize()));
+			m_sSize = sSize;
 
-			if (m_data == NULL) {
-				_EXCEPTION1("Failed malloc call (%lu bytes)", GetByteSize());
-			}
+			m_data = reinterpret_cast<T *>(
+				DataArrayAllocator::Shared().Allocate(
+					GetByteSize(), m_policy, m_fMapped));
 		}
 
 		Zero();
@@ -130,6 +137,26 @@ public:
 		m_sSize = sSize;
 	}
 
+	///	<summary>
+	///		Set the policy for allocating data in this DataArray1D.
+	///	</summary>
+	inline void SetPolicy(
+		const DataArrayPolicy & policy
+	) {
+		if (IsAttached()) {
+			_EXCEPTIONT("Attempting SetPolicy() on attached DataArray1D");
+		}
+
+		m_policy = policy;
+	}
+
+	///	<summary>
+	///		Get the policy for allocating data in this DataArray1D.
+	///	</summary>
+	inline const DataArrayPolicy & GetPolicy() const {
+		return m_policy;
+	}
+
 public:
 	///	<summary>
 	///		Determine if this DataChunk is attached to a data array.
@@ -155,7 +182,8 @@ public:
 	///	</summary>
 	virtual void Detach() {
 		if ((m_fOwnsData) && (m_data != NULL)) {
-			delete[] m_data;
+			DataArrayAllocator::Shared().Deallocate(
+				m_data, GetByteSize(), m_policy, m_fMapped);
 		}
 		m_fOwnsData = true;
 		m_data = NULL;
@@ -331,6 +359,16 @@ private:
 	///	</summary>
 	bool m_fOwnsData;
 
+	///	<summary>
+	///		The policy for allocating data.
+	///	</summary>
+	DataArrayPolicy m_policy;
+
+	///	<summary>
+	///		A flag indicating the data was allocated with mmap().
+	///	</summary>
+	bool m_fMapped;
+
 	///	<summary>
 	///		The number of rows in this DataArray1D.
 	///	</summary>
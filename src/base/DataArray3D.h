@@ -20,6 +20,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "Exception.h"
+#include "DataArrayAllocator.h"
 #include "Subscript.h"
 
 #include <cstdlib>
@@ -36,6 +37,7 @@ public:
 	///	</summary>
 	DataArray3D() :
 		m_fOwnsData(true),
+		m_fMapped(false),
 		m_data1D(NULL)
 	{
 		m_sSize[0] = 0;
@@ -50,9 +52,12 @@ public:
 		size_t sSize0,
 		size_t sSize1,
 		size_t sSize2,
-		bool fAllocate = true
+		bool fAllocate = true,
+		const DataArrayPolicy & policy = DataArrayPolicy()
 	) :
 		m_fOwnsData(true),
+		m_policy(policy),
+		m_fMapped(false),
 		m_data1D(NULL)
 	{
 		m_sSize[0] = sSize0;
@@ -69,6 +74,8 @@ public:
 	///	</summary>
 	DataArray3D(const DataArray3D<T> & da) :
 		m_fOwnsData(true),
+		m_policy(da.m_policy),
+		m_fMapped(false),
 		m_data1D(NULL)
 	{
 		if (da.IsAttached()) {
@@ -121,9 +128,9 @@ public:
 			_EXCEPTIONT("Attempting to Allocate() on attached DataArray3D");
 		}
 
-		Detach();
-
 		if ((sSize0 == 0) || (sSize1 == 0) || (sSize2 == 0)) {
+			Detach();
+
 			m_sSize[0] = 0;
 			m_sSize[1] = 0;
 			m_sSize[2] = 0;
@@ -135,15 +142,15 @@ public:
 		    (m_sSize[1] != sSize1) ||
 		    (m_sSize[2] != sSize2)
 		) {
+			Detach();
+
 			m_sSize[0] = sSize0;
 			m_sSize[1] = sSize1;
 			m_sSize[2] = sSize2;
 
-			m_data1D = reinterpret_cast<T *>(malloc(GetByteSize()));
-
-			if (m_data1D == NULL) {
-				_EXCEPTION1("Failed malloc call (%lu bytes)", GetByteSize());
-			}
+			m_data1D = reinterpret_cast<T *>(
+				DataArrayAllocator::Shared().Allocate(
+					GetByteSize(), m_policy, m_fMapped));
 		}
 
 		Zero();
@@ -166,6 +173,26 @@ public:
 		m_sSize[2] = sSize2;
 	}
 
+	///	<summary>
+	///		Set the policy for allocating data in this DataArray3D.
+	///	</summary>
+	inline void SetPolicy(
+		const DataArrayPolicy & policy
+	) {
+		if (IsAttached()) {
+			_EXCEPTIONT("Attempting SetPolicy() on attached DataArray3D");
+		}
+
+		m_policy = policy;
+	}
+
+	///	<summary>
+	///		Get the policy for allocating data in this DataArray3D.
+	///	</summary>
+	inline const DataArrayPolicy & GetPolicy() const {
+		return m_policy;
+	}
+
 public:
 	///	<summary>
 	///		Determine if this DataChunk is attached to a data array.
@@ -191,7 +218,8 @@ public:
 	///	</summary>
 	virtual void Detach() {
 		if ((m_fOwnsData) && (m_data1D != NULL)) {
-			delete[] m_data1D;
+			DataArrayAllocator::Shared().Deallocate(
+				m_data1D, GetByteSize(), m_policy, m_fMapped);
 		}
 		m_fOwnsData = true;
 		m_data1D = NULL;
@@ -516,6 +544,16 @@ private:
 	///	</summary>
 	bool m_fOwnsData;
 
+	///	<summary>
+	///		The policy for allocating data.
+	///	</summary>
+	DataArrayPolicy m_policy;
+
+	///	<summary>
+	///		A flag indicating the data was allocated with mmap().
+	///	</summary>
+	bool m_fMapped;
+
 	///	<summary>
 	///		The size of each dimension of this DataArray3D.
 	///	</summary>
@@ -0,0 +1,216 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    DataArrayAllocator.cpp
+///	\version October 15, 2026
+///
+
+#include "DataArrayAllocator.h"
+#include "Exception.h"
+
+#include <cstdlib>
+#include <sys/mman.h>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check if a buffer of the given size uses huge pages.
+///	</summary>
+static bool UsesHugePages(
+	size_t sBytes,
+	const DataArrayPolicy & policy
+) {
+	return (policy.m_eHugePages != DataArrayHugePages_None)
+		&& (sBytes >= DataArrayAllocator::HugePageBytes);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the number of bytes actually allocated for a buffer.
+///	</summary>
+static size_t AllocatedBytes(
+	size_t sBytes,
+	const DataArrayPolicy & policy
+) {
+	if (UsesHugePages(sBytes, policy)) {
+		const size_t sPage = DataArrayAllocator::HugePageBytes;
+		return ((sBytes + sPage - 1) / sPage) * sPage;
+	}
+	return ((sBytes + DataArrayAllocator::Alignment - 1)
+		/ DataArrayAllocator::Alignment) * DataArrayAllocator::Alignment;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Allocate a new buffer from the system.
+///	</summary>
+static void * AllocateBlock(
+	size_t sBytes,
+	const DataArrayPolicy & policy,
+	bool & fMapped
+) {
+	const size_t sAllocBytes = AllocatedBytes(sBytes, policy);
+
+	fMapped = false;
+
+#if defined(MAP_HUGETLB)
+	if (UsesHugePages(sBytes, policy) &&
+	    (policy.m_eHugePages == DataArrayHugePages_Explicit)
+	) {
+		void * p = mmap(NULL, sAllocBytes, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (p != MAP_FAILED) {
+			fMapped = true;
+			return p;
+		}
+	}
+#endif
+
+	// Buffers for transparent huge pages are aligned to the huge page
+	// size so that the kernel can back them entirely with huge pages
+	size_t sAlignment = DataArrayAllocator::Alignment;
+	if (UsesHugePages(sBytes, policy)) {
+		sAlignment = DataArrayAllocator::HugePageBytes;
+	}
+
+	void * p = NULL;
+	if (posix_memalign(&p, sAlignment, sAllocBytes) != 0) {
+		_EXCEPTION1("Failed allocation (%lu bytes)", sAllocBytes);
+	}
+
+#if defined(MADV_HUGEPAGE)
+	if (UsesHugePages(sBytes, policy)) {
+		madvise(p, sAllocBytes, MADV_HUGEPAGE);
+	}
+#endif
+
+	return p;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Return a buffer to the system.
+///	</summary>
+static void FreeBlock(
+	void * p,
+	size_t sAllocBytes,
+	bool fMapped
+) {
+	if (fMapped) {
+		munmap(p, sAllocBytes);
+	} else {
+		free(p);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DataArrayAllocator & DataArrayAllocator::Shared() {
+	static DataArrayAllocator * s_pallocator = new DataArrayAllocator;
+	return *s_pallocator;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void * DataArrayAllocator::Allocate(
+	size_t sBytes,
+	const DataArrayPolicy & policy,
+	bool & fMapped
+) {
+	if (policy.m_fPooled) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto iter = m_mapPool.find(
+			PoolKey(sBytes, static_cast<int>(policy.m_eHugePages)));
+		if (iter != m_mapPool.end()) {
+			void * p = iter->second.first;
+			fMapped = iter->second.second;
+			m_sPooledBytes -= AllocatedBytes(sBytes, policy);
+			m_mapPool.erase(iter);
+			return p;
+		}
+	}
+
+	return AllocateBlock(sBytes, policy, fMapped);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void DataArrayAllocator::Deallocate(
+	void * p,
+	size_t sBytes,
+	const DataArrayPolicy & policy,
+	bool fMapped
+) {
+	if (p == NULL) {
+		return;
+	}
+
+	const size_t sAllocBytes = AllocatedBytes(sBytes, policy);
+	if (policy.m_fPooled) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_sPooledBytes + sAllocBytes <= m_sPoolLimitBytes) {
+			m_mapPool.insert(
+				std::make_pair(
+					PoolKey(sBytes, static_cast<int>(policy.m_eHugePages)),
+					PoolBlock(p, fMapped)));
+			m_sPooledBytes += sAllocBytes;
+			return;
+		}
+	}
+
+	FreeBlock(p, sAllocBytes, fMapped);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void DataArrayAllocator::SetPoolLimit(
+	size_t sBytes
+) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_sPoolLimitBytes = sBytes;
+	TrimPool(sBytes);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void DataArrayAllocator::ReleasePool() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	TrimPool(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t DataArrayAllocator::GetPooledBytes() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_sPooledBytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t DataArrayAllocator::GetPooledCount() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_mapPool.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void DataArrayAllocator::TrimPool(
+	size_t sBytes
+) {
+	// Largest buffers are freed first
+	while ((m_sPooledBytes > sBytes) && (m_mapPool.size() != 0)) {
+		auto iter = m_mapPool.end();
+		iter--;
+		const DataArrayPolicy policy(
+			static_cast<DataArrayHugePages>(iter->first.second), true);
+		const size_t sAllocBytes = AllocatedBytes(iter->first.first, policy);
+		FreeBlock(iter->second.first, sAllocBytes, iter->second.second);
+		m_sPooledBytes -= sAllocBytes;
+		m_mapPool.erase(iter);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
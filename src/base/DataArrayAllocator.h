@@ -0,0 +1,221 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    DataArrayAllocator.h
+///	\version October 15, 2026
+///
+
+#ifndef _DATAARRAYALLOCATOR_H_
+#define _DATAARRAYALLOCATOR_H_
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <utility>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Use of huge pages for the data of a DataArray.
+///	</summary>
+enum DataArrayHugePages {
+
+	///	<summary>
+	///		Normal pages.
+	///	</summary>
+	DataArrayHugePages_None,
+
+	///	<summary>
+	///		Transparent huge pages, requested with madvise() on buffers
+	///		aligned to the huge page size.
+	///	</summary>
+	DataArrayHugePages_Transparent,
+
+	///	<summary>
+	///		Pages from the reserved huge page pool (MAP_HUGETLB), falling
+	///		back to transparent huge pages if none are available.
+	///	</summary>
+	DataArrayHugePages_Explicit
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		How a DataArray allocates its data.  Data is always aligned to
+///		DataArrayAllocator::Alignment bytes.  Huge pages are only used for
+///		buffers of at least DataArrayAllocator::HugePageBytes.  Pooled
+///		buffers are returned to the pool of DataArrayAllocator::Shared()
+///		when freed and handed to the next allocation of the same size and
+///		policy, so that repeated allocations of one shape neither call the
+///		system allocator nor fault in fresh pages.
+///	</summary>
+class DataArrayPolicy {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	DataArrayPolicy(
+		DataArrayHugePages eHugePages = DataArrayHugePages_None,
+		bool fPooled = false
+	) :
+		m_eHugePages(eHugePages),
+		m_fPooled(fPooled)
+	{ }
+
+public:
+	///	<summary>
+	///		Use of huge pages.
+	///	</summary>
+	DataArrayHugePages m_eHugePages;
+
+	///	<summary>
+	///		Flag indicating freed buffers are kept for reuse.
+	///	</summary>
+	bool m_fPooled;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		The allocator of the data of DataArray1D, DataArray2D and
+///		DataArray3D, holding the pool of buffers kept for reuse.
+///	</summary>
+class DataArrayAllocator {
+
+public:
+	///	<summary>
+	///		Alignment of all buffers in bytes.
+	///	</summary>
+	static const size_t Alignment = 64;
+
+	///	<summary>
+	///		Size of a huge page in bytes; smaller buffers use normal pages.
+	///	</summary>
+	static const size_t HugePageBytes = 2 * 1024 * 1024;
+
+	///	<summary>
+	///		Default limit on the bytes of buffers held by the pool.
+	///	</summary>
+	static const size_t DefaultPoolLimitBytes = 256 * 1024 * 1024;
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	DataArrayAllocator() :
+		m_sPooledBytes(0),
+		m_sPoolLimitBytes(DefaultPoolLimitBytes)
+	{ }
+
+	///	<summary>
+	///		Destructor.
+	///	</summary>
+	~DataArrayAllocator() {
+		ReleasePool();
+	}
+
+	///	<summary>
+	///		Get the allocator shared by all DataArrays.  It is never
+	///		destroyed, so arrays may be freed during static destruction.
+	///	</summary>
+	static DataArrayAllocator & Shared();
+
+private:
+	///	<summary>
+	///		Not copyable.
+	///	</summary>
+	DataArrayAllocator(const DataArrayAllocator &);
+	DataArrayAllocator & operator=(const DataArrayAllocator &);
+
+public:
+	///	<summary>
+	///		Allocate a buffer of sBytes bytes with the given policy.  fMapped
+	///		receives whether the buffer was mapped, which must be passed to
+	///		Deallocate.  Throws an Exception on failure.
+	///	</summary>
+	void * Allocate(
+		size_t sBytes,
+		const DataArrayPolicy & policy,
+		bool & fMapped
+	);
+
+	///	<summary>
+	///		Free a buffer obtained from Allocate with the same size and
+	///		policy, keeping it in the pool if the policy is pooled and the
+	///		pool has room.
+	///	</summary>
+	void Deallocate(
+		void * p,
+		size_t sBytes,
+		const DataArrayPolicy & policy,
+		bool fMapped
+	);
+
+	///	<summary>
+	///		Set the limit on the bytes of buffers held by the pool, freeing
+	///		buffers beyond it.
+	///	</summary>
+	void SetPoolLimit(
+		size_t sBytes
+	);
+
+	///	<summary>
+	///		Free all buffers held by the pool.
+	///	</summary>
+	void ReleasePool();
+
+	///	<summary>
+	///		Get the bytes of buffers held by the pool.
+	///	</summary>
+	size_t GetPooledBytes();
+
+	///	<summary>
+	///		Get the number of buffers held by the pool.
+	///	</summary>
+	size_t GetPooledCount();
+
+protected:
+	///	<summary>
+	///		Key of a pooled buffer: its size and use of huge pages.
+	///	</summary>
+	typedef std::pair<size_t, int> PoolKey;
+
+	///	<summary>
+	///		A pooled buffer and whether it was mapped.
+	///	</summary>
+	typedef std::pair<void *, bool> PoolBlock;
+
+	///	<summary>
+	///		Free pooled buffers until at most sBytes are held; the mutex
+	///		must be held.
+	///	</summary>
+	void TrimPool(
+		size_t sBytes
+	);
+
+protected:
+	///	<summary>
+	///		Mutex guarding the pool.
+	///	</summary>
+	std::mutex m_mutex;
+
+	///	<summary>
+	///		Buffers kept for reuse.
+	///	</summary>
+	std::multimap<PoolKey, PoolBlock> m_mapPool;
+
+	///	<summary>
+	///		Bytes of buffers in the pool.
+	///	</summary>
+	size_t m_sPooledBytes;
+
+	///	<summary>
+	///		Limit on the bytes of buffers in the pool.
+	///	</summary>
+	size_t m_sPoolLimitBytes;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
@@ -0,0 +1,236 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    DatasetManifest.cpp
+///	\version October 15, 2026
+///
+
+#include "DatasetManifest.h"
+#include "DirectoryWalker.h"
+#include "FileNameFilter.h"
+#include "RemoteFile.h"
+#include "Announce.h"
+#include "Exception.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string DatasetManifest::FromFile(
+	const std::string & strFilename,
+	const std::string & strDefaultFileName
+) {
+	std::ifstream ifManifest;
+	std::istream * pisManifest = &std::cin;
+	if (strFilename != "-") {
+		ifManifest.open(strFilename.c_str());
+		if (!ifManifest.is_open()) {
+			return std::string("Unable to open manifest \"")
+				+ strFilename + std::string("\"");
+		}
+		pisManifest = &ifManifest;
+	}
+
+	m_vecEntries.clear();
+
+	std::string strLine;
+	size_t sLine = 0;
+	while (std::getline(*pisManifest, strLine)) {
+		sLine++;
+		if ((strLine.length() != 0) && (strLine[strLine.length()-1] == '\r')) {
+			strLine.resize(strLine.length()-1);
+		}
+		if ((strLine.length() == 0) || (strLine[0] == '#')) {
+			continue;
+		}
+
+		// Split into tab-separated columns
+		std::vector<std::string> vecColumns;
+		size_t sPos = 0;
+		for (;;) {
+			size_t sTab = strLine.find('\t', sPos);
+			if (sTab == std::string::npos) {
+				vecColumns.push_back(strLine.substr(sPos));
+				break;
+			}
+			vecColumns.push_back(strLine.substr(sPos, sTab - sPos));
+			sPos = sTab + 1;
+		}
+		vecColumns.resize(std::max<size_t>(vecColumns.size(), 4));
+
+		if ((vecColumns.size() > 4) ||
+		    (vecColumns[0] == "") ||
+		    ((vecColumns[2] == "") && (vecColumns[3] == ""))
+		) {
+			return std::string("Malformed line ")
+				+ std::to_string(sLine) + std::string(" of manifest");
+		}
+
+		DatasetManifestEntry entry;
+		entry.m_strPath = vecColumns[0];
+		entry.m_strFileName =
+			(vecColumns[1] == "")?(strDefaultFileName):(vecColumns[1]);
+		entry.m_strOutputJSON = vecColumns[2];
+		entry.m_strOutputXML = vecColumns[3];
+		entry.m_sLine = sLine;
+		m_vecEntries.push_back(entry);
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void DatasetManifest::EstimateFileCounts(
+	size_t sThreads,
+	bool fRecurse,
+	const std::string & strExclude
+) {
+	std::atomic<size_t> sNext(0);
+	auto CountFiles = [&]() {
+		for (;;) {
+			size_t e = sNext.fetch_add(1);
+			if (e >= m_vecEntries.size()) {
+				break;
+			}
+			DatasetManifestEntry & entry = m_vecEntries[e];
+			entry.m_sEstimatedFiles = 0;
+			if (IsRemoteURL(entry.m_strPath)) {
+				continue;
+			}
+
+			FileNameFilter filter;
+			if (filter.Parse(entry.m_strFileName, strExclude) != "") {
+				continue;
+			}
+
+			DirectoryWalker walker(1);
+			walker.Walk(
+				entry.m_strPath,
+				filter,
+				fRecurse,
+				[&](
+					const std::string &,
+					const std::vector<std::string> & vecFilenames
+				) {
+					entry.m_sEstimatedFiles += vecFilenames.size();
+					return std::string("");
+				});
+		}
+	};
+
+	std::vector<std::thread> vecThreads;
+	sThreads = std::min(std::max(sThreads, (size_t)1), m_vecEntries.size());
+	for (size_t t = 0; t < sThreads; t++) {
+		vecThreads.push_back(std::thread(CountFiles));
+	}
+	for (size_t t = 0; t < vecThreads.size(); t++) {
+		vecThreads[t].join();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t DatasetManifest::Run(
+	size_t sThreads,
+	const IndexCallback & fnIndex,
+	std::vector<std::string> & vecErrors
+) const {
+	sThreads = std::max(sThreads, (size_t)1);
+	vecErrors.assign(m_vecEntries.size(), std::string(""));
+
+	// Largest datasets first, in the order listed among equals
+	std::vector<size_t> vecOrder(m_vecEntries.size());
+	std::iota(vecOrder.begin(), vecOrder.end(), 0);
+	std::stable_sort(vecOrder.begin(), vecOrder.end(),
+		[&](size_t a, size_t b) {
+			return (m_vecEntries[a].m_sEstimatedFiles
+				> m_vecEntries[b].m_sEstimatedFiles);
+		});
+
+	// Threads not held by a running dataset, and datasets whose worker
+	// has finished but not been joined
+	std::mutex mutexThreads;
+	std::condition_variable condThreads;
+	size_t sFreeThreads = sThreads;
+	std::vector<size_t> vecFinished;
+
+	std::vector<std::thread> vecWorkers(m_vecEntries.size());
+
+	AnnounceProgressBegin("Indexed datasets", m_vecEntries.size());
+
+	for (size_t i = 0; i < vecOrder.size(); i++) {
+		const size_t e = vecOrder[i];
+		const size_t sWanted =
+			std::min(
+				std::max<size_t>(
+					(m_vecEntries[e].m_sEstimatedFiles + FilesPerThread - 1)
+						/ FilesPerThread,
+					1),
+				sThreads);
+
+		// Wait for a thread to be free, and give the dataset as many of
+		// the free threads as it can use
+		size_t sGranted;
+		std::vector<size_t> vecJoin;
+		{
+			std::unique_lock<std::mutex> lock(mutexThreads);
+			condThreads.wait(lock, [&]() { return (sFreeThreads != 0); });
+			sGranted = std::min(sWanted, sFreeThreads);
+			sFreeThreads -= sGranted;
+			vecJoin.swap(vecFinished);
+		}
+		for (size_t j = 0; j < vecJoin.size(); j++) {
+			vecWorkers[vecJoin[j]].join();
+		}
+
+		vecWorkers[e] = std::thread([&, e, sGranted]() {
+			std::string strError;
+			try {
+				strError = fnIndex(m_vecEntries[e], sGranted);
+			} catch(Exception & ex) {
+				strError = ex.ToString();
+			} catch(std::exception & ex) {
+				strError = ex.what();
+			} catch(...) {
+				strError = "Unknown error";
+			}
+			vecErrors[e] = strError;
+
+			AnnounceProgressAdvance();
+
+			{
+				std::lock_guard<std::mutex> lock(mutexThreads);
+				sFreeThreads += sGranted;
+				vecFinished.push_back(e);
+			}
+			condThreads.notify_all();
+		});
+	}
+
+	for (size_t e = 0; e < vecWorkers.size(); e++) {
+		if (vecWorkers[e].joinable()) {
+			vecWorkers[e].join();
+		}
+	}
+
+	AnnounceProgressEnd();
+
+	size_t sFailed = 0;
+	for (size_t e = 0; e < vecErrors.size(); e++) {
+		if (vecErrors[e] != "") {
+			sFailed++;
+		}
+	}
+	return sFailed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
@@ -0,0 +1,155 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    DatasetManifest.h
+///	\version October 15, 2026
+///
+
+#ifndef _DATASETMANIFEST_H_
+#define _DATASETMANIFEST_H_
+
+#include <string>
+#include <vector>
+#include <functional>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A dataset listed in a DatasetManifest.
+///	</summary>
+class DatasetManifestEntry {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	DatasetManifestEntry() :
+		m_sLine(0),
+		m_sEstimatedFiles(0)
+	{ }
+
+public:
+	///	<summary>
+	///		Path of the dataset, as given to --path.
+	///	</summary>
+	std::string m_strPath;
+
+	///	<summary>
+	///		Comma-separated patterns of files to index, as given to --ext.
+	///	</summary>
+	std::string m_strFileName;
+
+	///	<summary>
+	///		Output JSON file, or empty.
+	///	</summary>
+	std::string m_strOutputJSON;
+
+	///	<summary>
+	///		Output XML file, or empty.
+	///	</summary>
+	std::string m_strOutputXML;
+
+	///	<summary>
+	///		Line of the manifest listing the dataset.
+	///	</summary>
+	size_t m_sLine;
+
+	///	<summary>
+	///		Number of files found by EstimateFileCounts.
+	///	</summary>
+	size_t m_sEstimatedFiles;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A list of datasets indexed by one process, each into its own
+///		outputs.  Each line of a manifest holds the path, file patterns,
+///		output JSON file and output XML file of a dataset separated by
+///		tabs; the patterns may be empty to use the default, and either
+///		output may be empty or omitted, but not both.  Empty lines and
+///		lines starting with '#' are ignored.
+///
+///		Datasets are indexed concurrently on a shared budget of threads.
+///		Larger datasets are started first with a share of the threads in
+///		proportion to their number of files, and smaller datasets are
+///		packed onto the remaining threads one at a time, so that all
+///		threads stay busy until the last datasets complete.
+///	</summary>
+class DatasetManifest {
+
+public:
+	///	<summary>
+	///		Number of files of a dataset per thread given to it.
+	///	</summary>
+	static const size_t FilesPerThread = 256;
+
+	///	<summary>
+	///		Callback indexing a dataset with the given number of threads.
+	///		A non-empty return value is reported as the error of the
+	///		dataset; an Exception thrown is reported in the same way.
+	///	</summary>
+	typedef std::function<
+		std::string(
+			const DatasetManifestEntry & entry,
+			size_t sThreads)>
+		IndexCallback;
+
+public:
+	///	<summary>
+	///		Read the manifest from a file, or from standard input if it is
+	///		"-".  Datasets without file patterns use strDefaultFileName.
+	///		Returns an error message on failure.
+	///	</summary>
+	std::string FromFile(
+		const std::string & strFilename,
+		const std::string & strDefaultFileName
+	);
+
+	///	<summary>
+	///		Count the files of each local dataset on up to sThreads
+	///		threads, as a measure of the work of indexing it.  Remote
+	///		datasets and paths that cannot be walked count as empty.
+	///	</summary>
+	void EstimateFileCounts(
+		size_t sThreads,
+		bool fRecurse,
+		const std::string & strExclude
+	);
+
+	///	<summary>
+	///		Index every dataset by calling fnIndex on up to sThreads
+	///		threads in total.  vecErrors receives the error of each
+	///		dataset, or an empty string if it succeeded.  Returns the
+	///		number of datasets that failed.
+	///	</summary>
+	size_t Run(
+		size_t sThreads,
+		const IndexCallback & fnIndex,
+		std::vector<std::string> & vecErrors
+	) const;
+
+	///	<summary>
+	///		Get the number of datasets.
+	///	</summary>
+	size_t size() const {
+		return m_vecEntries.size();
+	}
+
+	///	<summary>
+	///		Get the given dataset.
+	///	</summary>
+	const DatasetManifestEntry & operator[](size_t i) const {
+		return m_vecEntries[i];
+	}
+
+protected:
+	///	<summary>
+	///		Datasets in the order listed.
+	///	</summary>
+	std::vector<DatasetManifestEntry> m_vecEntries;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
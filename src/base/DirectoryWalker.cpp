@@ -0,0 +1,404 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    DirectoryWalker.cpp
+///	\version October 14, 2026
+///
+
+#include "DirectoryWalker.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A directory of the walk.  Its files and children are filled in by
+///		the thread listing it and read by the caller once fDone is set.
+///	</summary>
+struct DirectoryWalkerNode {
+
+	///	<summary>
+	///		Path of the directory, as passed to opendir.
+	///	</summary>
+	std::string strPath;
+
+	///	<summary>
+	///		Matching files.
+	///	</summary>
+	std::vector<std::string> vecFilenames;
+
+	///	<summary>
+	///		Subdirectories, in directory order.
+	///	</summary>
+	std::vector< std::unique_ptr<DirectoryWalkerNode> > vecChildren;
+
+	///	<summary>
+	///		Flag indicating the directory could not be opened.
+	///	</summary>
+	bool fOpenFailed;
+
+	///	<summary>
+	///		Flag indicating the directory has been listed.
+	///	</summary>
+	bool fDone;
+
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	DirectoryWalkerNode(
+		const std::string & strPathIn
+	) :
+		strPath(strPathIn),
+		fOpenFailed(false),
+		fDone(false)
+	{ }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Shared state of one walk.
+///	</summary>
+class DirectoryWalkerState {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	DirectoryWalkerState(
+		size_t sThreads,
+		const FileNameFilter & filter,
+		bool fRecurse
+	) :
+		m_vecQueues(sThreads),
+		m_filter(filter),
+		m_fRecurse(fRecurse),
+		m_sQueued(0),
+		m_sPending(0),
+		m_fAbort(false)
+	{ }
+
+public:
+	///	<summary>
+	///		Queue a directory on the queue of thread t.
+	///	</summary>
+	void Push(
+		size_t t,
+		DirectoryWalkerNode * pnode
+	) {
+		{
+			std::lock_guard<std::mutex> lock(m_vecQueues[t].mutex);
+			m_vecQueues[t].deq.push_back(pnode);
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_sQueued++;
+			m_sPending++;
+		}
+		m_condWork.notify_one();
+	}
+
+	///	<summary>
+	///		Take a directory for thread t: most recently queued from its
+	///		own queue, otherwise the oldest from another queue.  Returns NULL
+	///		once the walk is complete or aborted.
+	///	</summary>
+	DirectoryWalkerNode * Pop(
+		size_t t
+	) {
+		const size_t sQueues = m_vecQueues.size();
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_condWork.wait(lock, [&]() {
+					return (m_fAbort || (m_sQueued != 0) || (m_sPending == 0));
+				});
+				if (m_fAbort || (m_sQueued == 0)) {
+					return NULL;
+				}
+			}
+
+			for (size_t i = 0; i < sQueues; i++) {
+				WorkQueue & queue = m_vecQueues[(t + i) % sQueues];
+				DirectoryWalkerNode * pnode = NULL;
+				{
+					std::lock_guard<std::mutex> lock(queue.mutex);
+					if (queue.deq.size() == 0) {
+						continue;
+					}
+					if (i == 0) {
+						pnode = queue.deq.back();
+						queue.deq.pop_back();
+					} else {
+						pnode = queue.deq.front();
+						queue.deq.pop_front();
+					}
+				}
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_sQueued--;
+				return pnode;
+			}
+		}
+	}
+
+	///	<summary>
+	///		List a directory on thread t and queue its subdirectories.
+	///	</summary>
+	void List(
+		size_t t,
+		DirectoryWalkerNode * pnode
+	) {
+		std::string strPrefix = pnode->strPath;
+		if (strPrefix[strPrefix.length()-1] != '/') {
+			strPrefix += "/";
+		}
+
+		int fd = open(pnode->strPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		DIR * pDir = (fd < 0)?(NULL):(fdopendir(fd));
+		if (pDir == NULL) {
+			if (fd >= 0) {
+				close(fd);
+			}
+			pnode->fOpenFailed = true;
+			return;
+		}
+
+		struct dirent * pDirent;
+		while ((pDirent = readdir(pDir)) != NULL) {
+			const char * szName = pDirent->d_name;
+			const size_t sLength = strlen(szName);
+			if (sLength == 0) {
+				continue;
+			}
+
+			// Filter on the name before classifying the entry
+			if (m_filter.IsExcluded(szName, sLength)) {
+				continue;
+			}
+			bool fIncluded = m_filter.IsIncluded(szName, sLength);
+			bool fDescend = m_fRecurse && (szName[0] != '.');
+
+			// Symbolic links are followed, as opendir would
+			bool fDirectory;
+			if (pDirent->d_type == DT_DIR) {
+				fDirectory = true;
+			} else if ((pDirent->d_type == DT_LNK) || (pDirent->d_type == DT_UNKNOWN)) {
+				if (!fIncluded && !fDescend) {
+					continue;
+				}
+				struct stat statEntry;
+				fDirectory =
+					(fstatat(dirfd(pDir), szName, &statEntry, 0) == 0)
+					&& S_ISDIR(statEntry.st_mode);
+			} else {
+				fDirectory = false;
+			}
+
+			if (!fDirectory) {
+				if (fIncluded) {
+					pnode->vecFilenames.push_back(szName);
+				}
+			} else if (fDescend) {
+				pnode->vecChildren.push_back(
+					std::unique_ptr<DirectoryWalkerNode>(
+						new DirectoryWalkerNode(strPrefix + szName)));
+			}
+		}
+		closedir(pDir);
+
+		// Queue in reverse so the owner takes the first subdirectory next
+		for (size_t c = pnode->vecChildren.size(); c > 0; c--) {
+			Push(t, pnode->vecChildren[c-1].get());
+		}
+	}
+
+	///	<summary>
+	///		Mark a directory as listed.
+	///	</summary>
+	void Done(
+		DirectoryWalkerNode * pnode
+	) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			pnode->fDone = true;
+			m_sPending--;
+		}
+		m_condWork.notify_all();
+		m_condDone.notify_all();
+	}
+
+	///	<summary>
+	///		Wait until a directory has been listed.
+	///	</summary>
+	void Wait(
+		DirectoryWalkerNode * pnode
+	) {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condDone.wait(lock, [&]() {
+			return (pnode->fDone);
+		});
+	}
+
+	///	<summary>
+	///		Stop all threads.
+	///	</summary>
+	void Abort() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_fAbort = true;
+		}
+		m_condWork.notify_all();
+	}
+
+protected:
+	///	<summary>
+	///		A queue of directories owned by one thread.
+	///	</summary>
+	struct WorkQueue {
+		std::mutex mutex;
+		std::deque<DirectoryWalkerNode *> deq;
+	};
+
+	///	<summary>
+	///		Queue of each thread.
+	///	</summary>
+	std::vector<WorkQueue> m_vecQueues;
+
+	///	<summary>
+	///		Filter applied to entry names.
+	///	</summary>
+	const FileNameFilter & m_filter;
+
+	///	<summary>
+	///		Flag indicating subdirectories are walked.
+	///	</summary>
+	bool m_fRecurse;
+
+	///	<summary>
+	///		Mutex guarding the counters and node completion.
+	///	</summary>
+	std::mutex m_mutex;
+
+	///	<summary>
+	///		Signalled when work is queued or the walk ends.
+	///	</summary>
+	std::condition_variable m_condWork;
+
+	///	<summary>
+	///		Signalled when a directory has been listed.
+	///	</summary>
+	std::condition_variable m_condDone;
+
+	///	<summary>
+	///		Number of directories waiting in the queues.
+	///	</summary>
+	size_t m_sQueued;
+
+	///	<summary>
+	///		Number of directories queued or being listed.
+	///	</summary>
+	size_t m_sPending;
+
+	///	<summary>
+	///		Flag indicating the walk was stopped.
+	///	</summary>
+	bool m_fAbort;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// DirectoryWalker
+///////////////////////////////////////////////////////////////////////////////
+
+std::string DirectoryWalker::Walk(
+	const std::string & strRootDir,
+	const FileNameFilter & filter,
+	bool fRecurse,
+	const DirectoryCallback & fnCallback
+) const {
+	if (strRootDir == "") {
+		return std::string("Empty file path");
+	}
+
+	DirectoryWalkerState state(m_sThreads, filter, fRecurse);
+
+	DirectoryWalkerNode nodeRoot(strRootDir);
+	state.Push(0, &nodeRoot);
+
+	std::vector<std::thread> vecThreads;
+	for (size_t t = 0; t < m_sThreads; t++) {
+		vecThreads.push_back(std::thread([&state, t]() {
+			DirectoryWalkerNode * pnode;
+			while ((pnode = state.Pop(t)) != NULL) {
+				state.List(t, pnode);
+				state.Done(pnode);
+			}
+		}));
+	}
+
+	// Hand out directories in depth-first order as they are listed;
+	// exceptions are held until the threads are joined
+	std::string strError;
+	std::exception_ptr exCallback;
+	try {
+		std::vector<DirectoryWalkerNode *> vecStack;
+		vecStack.push_back(&nodeRoot);
+		while (vecStack.size() != 0) {
+			DirectoryWalkerNode * pnode = vecStack.back();
+			vecStack.pop_back();
+
+			state.Wait(pnode);
+			if (pnode->fOpenFailed) {
+				if (pnode == &nodeRoot) {
+					std::string strBaseDir = strRootDir;
+					if (strBaseDir[strBaseDir.length()-1] != '/') {
+						strBaseDir += "/";
+					}
+					strError = std::string("Unable to open directory \"")
+						+ strBaseDir + std::string("\"");
+					break;
+				}
+				continue;
+			}
+
+			std::string strBaseDir = pnode->strPath;
+			if (strBaseDir[strBaseDir.length()-1] != '/') {
+				strBaseDir += "/";
+			}
+			strError = fnCallback(strBaseDir, pnode->vecFilenames);
+			if (strError != "") {
+				break;
+			}
+			std::vector<std::string>().swap(pnode->vecFilenames);
+
+			for (size_t c = pnode->vecChildren.size(); c > 0; c--) {
+				vecStack.push_back(pnode->vecChildren[c-1].get());
+			}
+		}
+
+	} catch(...) {
+		exCallback = std::current_exception();
+	}
+
+	state.Abort();
+	for (size_t t = 0; t < vecThreads.size(); t++) {
+		vecThreads[t].join();
+	}
+	if (exCallback) {
+		std::rethrow_exception(exCallback);
+	}
+
+	return strError;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
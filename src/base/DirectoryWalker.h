@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    DirectoryWalker.h
+///	\version October 14, 2026
+///
+
+#ifndef _DIRECTORYWALKER_H_
+#define _DIRECTORYWALKER_H_
+
+#include "FileNameFilter.h"
+
+#include <string>
+#include <vector>
+#include <functional>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Walks a directory tree on a bounded pool of threads and streams
+///		the files accepted by a FileNameFilter to a callback, one directory
+///		at a time.  Threads take directories from their own queue and
+///		steal from the queues of others when it runs dry.  Entries are
+///		classified using d_type, falling back to fstatat when the file
+///		system does not report it; names rejected by the filter are
+///		skipped before any such call.  The callback is invoked on the
+///		calling thread in the order of a serial depth-first walk, while
+///		the remaining directories are still being listed.
+///	</summary>
+class DirectoryWalker {
+
+public:
+	///	<summary>
+	///		Callback receiving a directory, with a trailing slash, and the
+	///		names of the matching files in it.  A non-empty return value
+	///		stops the walk and is returned by Walk.
+	///	</summary>
+	typedef std::function<
+		std::string(
+			const std::string & strBaseDir,
+			const std::vector<std::string> & vecFilenames)>
+		DirectoryCallback;
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	DirectoryWalker(
+		size_t sThreads
+	) :
+		m_sThreads((sThreads == 0)?(1):(sThreads))
+	{ }
+
+public:
+	///	<summary>
+	///		Walk strRootDir, descending into subdirectories not starting
+	///		with '.' and not excluded by the filter if fRecurse is set.
+	///		Subdirectories that cannot be opened are skipped.
+	///	</summary>
+	std::string Walk(
+		const std::string & strRootDir,
+		const FileNameFilter & filter,
+		bool fRecurse,
+		const DirectoryCallback & fnCallback
+	) const;
+
+protected:
+	///	<summary>
+	///		Maximum number of threads listing directories.
+	///	</summary>
+	size_t m_sThreads;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
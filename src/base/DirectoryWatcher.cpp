@@ -0,0 +1,286 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    DirectoryWatcher.cpp
+///	\version October 14, 2026
+///
+
+#include "DirectoryWatcher.h"
+#include "Announce.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Milliseconds between checks of the stop flag while waiting.
+///	</summary>
+static const int s_nWaitTimeoutMs = 250;
+
+///	<summary>
+///		Flag set by SIGINT and SIGTERM.
+///	</summary>
+static volatile sig_atomic_t s_fStopSignal = 0;
+
+///	<summary>
+///		Handler of SIGINT and SIGTERM.
+///	</summary>
+static void DirectoryWatcherStopHandler(int) {
+	s_fStopSignal = 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DirectoryWatcher::~DirectoryWatcher() {
+	if (m_fdNotify >= 0) {
+		close(m_fdNotify);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string DirectoryWatcher::Start(
+	const std::string & strRootDir,
+	const std::string & strFileName,
+	bool fRecurse,
+	const std::string & strExclude
+) {
+	std::string strError = m_filter.Parse(strFileName, strExclude);
+	if (strError != "") {
+		return strError;
+	}
+	m_fRecurse = fRecurse;
+
+#if defined(__linux__)
+	m_fdNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_fdNotify < 0) {
+		AnnounceWarning("inotify is unavailable (%s); polling for changes",
+			strerror(errno));
+	}
+#endif
+
+	if (m_fdNotify >= 0) {
+		std::string strDir = strRootDir;
+		if ((strDir == "") || (strDir[strDir.length()-1] != '/')) {
+			strDir += "/";
+		}
+		AddWatches(strDir);
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void DirectoryWatcher::AddWatches(
+	const std::string & strDir
+) {
+#if defined(__linux__)
+	const uint32_t uMask =
+		IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO
+		| IN_DELETE | IN_DELETE_SELF | IN_ONLYDIR;
+
+	int wd = inotify_add_watch(m_fdNotify, strDir.c_str(), uMask);
+	if (wd < 0) {
+		if (errno == ENOSPC) {
+			AnnounceWarning("Too many directories for inotify; raise"
+				" fs.inotify.max_user_watches to watch \"%s\"", strDir.c_str());
+		}
+		return;
+	}
+	m_mapWatchDirs[wd] = strDir;
+
+	if (!m_fRecurse) {
+		return;
+	}
+
+	// Subdirectories, pruned as DirectoryWalker prunes them
+	DIR * pDir = opendir(strDir.c_str());
+	if (pDir == NULL) {
+		return;
+	}
+	std::vector<std::string> vecSubDirs;
+	struct dirent * pDirent;
+	while ((pDirent = readdir(pDir)) != NULL) {
+		const char * szName = pDirent->d_name;
+		const size_t sLength = strlen(szName);
+		if ((sLength == 0) || (szName[0] == '.') ||
+		    m_filter.IsExcluded(szName, sLength)
+		) {
+			continue;
+		}
+
+		bool fDirectory = (pDirent->d_type == DT_DIR);
+		if ((pDirent->d_type == DT_LNK) || (pDirent->d_type == DT_UNKNOWN)) {
+			struct stat statEntry;
+			fDirectory =
+				(stat((strDir + szName).c_str(), &statEntry) == 0)
+				&& S_ISDIR(statEntry.st_mode);
+		}
+		if (fDirectory) {
+			vecSubDirs.push_back(strDir + szName + std::string("/"));
+		}
+	}
+	closedir(pDir);
+
+	for (size_t d = 0; d < vecSubDirs.size(); d++) {
+		AddWatches(vecSubDirs[d]);
+	}
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool DirectoryWatcher::ReadEvents() {
+	bool fChanged = false;
+
+#if defined(__linux__)
+	char szBuffer[65536]
+		__attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+	for (;;) {
+		ssize_t sRead = read(m_fdNotify, szBuffer, sizeof(szBuffer));
+		if (sRead <= 0) {
+			break;
+		}
+
+		for (char * p = szBuffer; p < szBuffer + sRead;) {
+			const struct inotify_event * pevent =
+				reinterpret_cast<const struct inotify_event *>(p);
+			p += sizeof(struct inotify_event) + pevent->len;
+
+			// Events were lost, so the next update must check every file
+			if (pevent->mask & IN_Q_OVERFLOW) {
+				fChanged = true;
+				continue;
+			}
+
+			std::map<int, std::string>::iterator iterDir =
+				m_mapWatchDirs.find(pevent->wd);
+			if (iterDir == m_mapWatchDirs.end()) {
+				continue;
+			}
+			if (pevent->mask & IN_IGNORED) {
+				m_mapWatchDirs.erase(iterDir);
+				continue;
+			}
+			if (pevent->mask & IN_DELETE_SELF) {
+				fChanged = true;
+				continue;
+			}
+			if (pevent->len == 0) {
+				continue;
+			}
+
+			const char * szName = pevent->name;
+			const size_t sLength = strlen(szName);
+			if (m_filter.IsExcluded(szName, sLength)) {
+				continue;
+			}
+
+			// Directories created or moved in are watched and walked
+			if (pevent->mask & IN_ISDIR) {
+				if ((pevent->mask & (IN_CREATE | IN_MOVED_TO)) &&
+				    m_fRecurse && (szName[0] != '.')
+				) {
+					AddWatches(iterDir->second + szName + std::string("/"));
+				}
+				fChanged = true;
+				continue;
+			}
+
+			if (!m_filter.IsIncluded(szName, sLength)) {
+				continue;
+			}
+
+			// Writes only mark the file as open; the change is seen when
+			// it is closed, so a file written for hours does not hold
+			// back the debounce
+			std::string strFilename = iterDir->second + szName;
+			if (pevent->mask & (IN_CREATE | IN_MODIFY)) {
+				m_setOpenFiles.insert(strFilename);
+			}
+			if (pevent->mask & (IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE)) {
+				m_setOpenFiles.erase(strFilename);
+				fChanged = true;
+			}
+		}
+	}
+#endif
+
+	return fChanged;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool DirectoryWatcher::WaitForChanges(
+	double dDebounce
+) {
+	typedef std::chrono::steady_clock Clock;
+	const Clock::duration durDebounce =
+		std::chrono::duration_cast<Clock::duration>(
+			std::chrono::duration<double>(dDebounce));
+
+	s_fStopSignal = 0;
+	void (*pfnPrevInt)(int) = signal(SIGINT, DirectoryWatcherStopHandler);
+	void (*pfnPrevTerm)(int) = signal(SIGTERM, DirectoryWatcherStopHandler);
+
+	// Without inotify every interval is treated as a change
+	bool fChanged = (m_fdNotify < 0);
+	Clock::time_point tLastChange = Clock::now();
+
+	while (!s_fStopSignal) {
+		Clock::time_point tNow = Clock::now();
+		if (fChanged && (tNow - tLastChange >= durDebounce)) {
+			break;
+		}
+
+		int nTimeoutMs = s_nWaitTimeoutMs;
+		if (fChanged) {
+			long long llRemainingMs =
+				std::chrono::duration_cast<std::chrono::milliseconds>(
+					durDebounce - (tNow - tLastChange)).count() + 1;
+			if (llRemainingMs < nTimeoutMs) {
+				nTimeoutMs = static_cast<int>(llRemainingMs);
+			}
+		}
+
+		if (m_fdNotify < 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(nTimeoutMs));
+			continue;
+		}
+
+		struct pollfd pfd;
+		pfd.fd = m_fdNotify;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, nTimeoutMs) > 0) {
+			if (ReadEvents()) {
+				fChanged = true;
+				tLastChange = Clock::now();
+			}
+		}
+	}
+
+	signal(SIGINT, pfnPrevInt);
+	signal(SIGTERM, pfnPrevTerm);
+
+	return !s_fStopSignal;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    DirectoryWatcher.h
+///	\version October 14, 2026
+///
+
+#ifndef _DIRECTORYWATCHER_H_
+#define _DIRECTORYWATCHER_H_
+
+#include "FileNameFilter.h"
+
+#include <string>
+#include <set>
+#include <map>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Waits for files accepted by a FileNameFilter to change under a
+///		directory tree, using inotify where it is available and polling
+///		otherwise.  The tree is pruned as DirectoryWalker prunes it, and
+///		directories created later are watched as they appear.  A file is
+///		reported as being written from its first modification until it
+///		is closed, so that callers can defer indexing it.
+///	</summary>
+class DirectoryWatcher {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	DirectoryWatcher() :
+		m_fRecurse(false),
+		m_fdNotify(-1)
+	{ }
+
+	///	<summary>
+	///		Destructor.
+	///	</summary>
+	~DirectoryWatcher();
+
+private:
+	///	<summary>
+	///		Not copyable.
+	///	</summary>
+	DirectoryWatcher(const DirectoryWatcher &);
+	DirectoryWatcher & operator=(const DirectoryWatcher &);
+
+public:
+	///	<summary>
+	///		Start watching strRootDir, and its subdirectories if fRecurse
+	///		is set, for changes to files matching strFileName and not
+	///		strExclude.  Returns an error message if the patterns are
+	///		invalid.
+	///	</summary>
+	std::string Start(
+		const std::string & strRootDir,
+		const std::string & strFileName,
+		bool fRecurse,
+		const std::string & strExclude
+	);
+
+	///	<summary>
+	///		Check if changes are detected by inotify rather than polling.
+	///	</summary>
+	bool IsNotifying() const {
+		return (m_fdNotify >= 0);
+	}
+
+	///	<summary>
+	///		Block until a change is seen and no further change has been
+	///		seen for dDebounce seconds, or, when polling, for dDebounce
+	///		seconds.  Returns false if SIGINT or SIGTERM was received.
+	///	</summary>
+	bool WaitForChanges(
+		double dDebounce
+	);
+
+	///	<summary>
+	///		Get the full paths of files modified and not yet closed.
+	///	</summary>
+	const std::set<std::string> & GetOpenFiles() const {
+		return m_setOpenFiles;
+	}
+
+protected:
+	///	<summary>
+	///		Watch a directory, with a trailing slash, and its
+	///		subdirectories if m_fRecurse is set.
+	///	</summary>
+	void AddWatches(
+		const std::string & strDir
+	);
+
+	///	<summary>
+	///		Read the pending inotify events.  Returns true if any of them
+	///		changed an accepted file or a directory.
+	///	</summary>
+	bool ReadEvents();
+
+protected:
+	///	<summary>
+	///		Filter of watched files.
+	///	</summary>
+	FileNameFilter m_filter;
+
+	///	<summary>
+	///		Flag indicating subdirectories are watched.
+	///	</summary>
+	bool m_fRecurse;
+
+	///	<summary>
+	///		The inotify descriptor, or -1 when polling.
+	///	</summary>
+	int m_fdNotify;
+
+	///	<summary>
+	///		Watched directory of each watch descriptor.
+	///	</summary>
+	std::map<int, std::string> m_mapWatchDirs;
+
+	///	<summary>
+	///		Files modified and not yet closed.
+	///	</summary>
+	std::set<std::string> m_setOpenFiles;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
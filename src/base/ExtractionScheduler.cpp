@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    ExtractionScheduler.cpp
+///	\version October 15, 2026
+///
+
+#include "ExtractionScheduler.h"
+
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////
+
+const double ExtractionScheduler::CachedCost = 0.1;
+
+const size_t ExtractionScheduler::ChunksPerRank = 4;
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ExtractionScheduler::EstimateCosts(
+	const std::vector<long long> & vecFileBytes,
+	const std::vector<char> & vecCached,
+	std::vector<double> & vecCosts
+) {
+	const size_t sFiles = vecFileBytes.size();
+
+	// Median size of the uncached files of known size
+	std::vector<long long> vecKnownBytes;
+	for (size_t f = 0; f < sFiles; f++) {
+		if (!vecCached[f] && (vecFileBytes[f] > 0)) {
+			vecKnownBytes.push_back(vecFileBytes[f]);
+		}
+	}
+	double dMedianBytes = 0.0;
+	if (vecKnownBytes.size() != 0) {
+		std::vector<long long>::iterator iterMedian =
+			vecKnownBytes.begin() + vecKnownBytes.size() / 2;
+		std::nth_element(
+			vecKnownBytes.begin(), iterMedian, vecKnownBytes.end());
+		dMedianBytes = static_cast<double>(*iterMedian);
+	}
+
+	vecCosts.resize(sFiles);
+	for (size_t f = 0; f < sFiles; f++) {
+		if (vecCached[f]) {
+			vecCosts[f] = CachedCost;
+		} else if ((vecFileBytes[f] <= 0) || (dMedianBytes <= 0.0)) {
+			vecCosts[f] = 2.0;
+		} else {
+			vecCosts[f] =
+				1.0 + static_cast<double>(vecFileBytes[f]) / dMedianBytes;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string ExtractionScheduler::GetDirectory(
+	const std::string & strFilename
+) {
+	size_t sSlash = strFilename.rfind('/');
+	if (sSlash == std::string::npos) {
+		return std::string("");
+	}
+	return strFilename.substr(0, sSlash + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ExtractionScheduler::Partition(
+	const std::vector<std::string> & vecFilenames,
+	const std::vector<double> & vecCosts,
+	size_t sRanks,
+	std::vector< std::vector<size_t> > & vecRankIndices
+) {
+	vecRankIndices.clear();
+	vecRankIndices.resize(std::max<size_t>(sRanks, 1));
+
+	const size_t sFiles = vecFilenames.size();
+	double dTotalCost = 0.0;
+	for (size_t f = 0; f < sFiles; f++) {
+		dTotalCost += vecCosts[f];
+	}
+	const double dChunkCost =
+		dTotalCost / static_cast<double>(vecRankIndices.size() * ChunksPerRank);
+
+	// Split the files into chunks of consecutive files in one directory
+	struct Chunk {
+		size_t m_sBegin;
+		size_t m_sEnd;
+		double m_dCost;
+	};
+
+	std::vector<Chunk> vecChunks;
+	std::string strChunkDirectory;
+	for (size_t f = 0; f < sFiles; f++) {
+		std::string strDirectory = GetDirectory(vecFilenames[f]);
+		if ((vecChunks.size() == 0) ||
+		    (strDirectory != strChunkDirectory) ||
+		    (vecChunks.back().m_dCost + vecCosts[f] > dChunkCost)
+		) {
+			Chunk chunk;
+			chunk.m_sBegin = f;
+			chunk.m_sEnd = f;
+			chunk.m_dCost = 0.0;
+			vecChunks.push_back(chunk);
+			strChunkDirectory = strDirectory;
+		}
+		vecChunks.back().m_sEnd = f+1;
+		vecChunks.back().m_dCost += vecCosts[f];
+	}
+
+	// Assign the costliest chunks first, each to the least loaded rank
+	std::stable_sort(vecChunks.begin(), vecChunks.end(),
+		[](const Chunk & a, const Chunk & b) {
+			return (a.m_dCost > b.m_dCost);
+		});
+
+	std::vector<double> vecRankCosts(vecRankIndices.size(), 0.0);
+	for (size_t c = 0; c < vecChunks.size(); c++) {
+		size_t r = static_cast<size_t>(
+			std::min_element(vecRankCosts.begin(), vecRankCosts.end())
+				- vecRankCosts.begin());
+
+		for (size_t f = vecChunks[c].m_sBegin; f < vecChunks[c].m_sEnd; f++) {
+			vecRankIndices[r].push_back(f);
+		}
+		vecRankCosts[r] += vecChunks[c].m_dCost;
+	}
+
+	// Each rank's files are listed in filename order
+	for (size_t r = 0; r < vecRankIndices.size(); r++) {
+		std::sort(vecRankIndices[r].begin(), vecRankIndices[r].end());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
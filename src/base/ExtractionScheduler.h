@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    ExtractionScheduler.h
+///	\version October 15, 2026
+///
+
+#ifndef _EXTRACTIONSCHEDULER_H_
+#define _EXTRACTIONSCHEDULER_H_
+
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		How the extraction of file headers is distributed over threads
+///		and ranks.
+///	</summary>
+enum ExtractionSchedule {
+
+	///	<summary>
+	///		Threads take files in filename order and ranks extract blocks
+	///		holding equal numbers of consecutive files.
+	///	</summary>
+	ExtractionSchedule_Count,
+
+	///	<summary>
+	///		Files are weighted by their estimated cost.  Threads take the
+	///		costliest file available first, and ranks extract chunks of
+	///		files from the same directory balanced by cost.
+	///	</summary>
+	ExtractionSchedule_Cost
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Estimates the cost of extracting the header of each file and
+///		assigns files to ranks and threads by cost.  Costs are in units
+///		of the fixed cost of opening one file.
+///	</summary>
+class ExtractionScheduler {
+
+public:
+	///	<summary>
+	///		Cost of a file whose header is in the header cache.
+	///	</summary>
+	static const double CachedCost;
+
+	///	<summary>
+	///		Number of chunks of files per rank, so that chunks of
+	///		different costs can be balanced.
+	///	</summary>
+	static const size_t ChunksPerRank;
+
+public:
+	///	<summary>
+	///		Estimate the cost of extracting the header of each file from
+	///		its size in bytes, negative if unknown, and whether its header
+	///		is cached.  Sizes are taken relative to the median size of the
+	///		uncached files of known size, and a file of the median size
+	///		costs as much to read as to open.  A fixed scale in bytes would
+	///		give every file of a tree of small files the same cost.
+	///	</summary>
+	static void EstimateCosts(
+		const std::vector<long long> & vecFileBytes,
+		const std::vector<char> & vecCached,
+		std::vector<double> & vecCosts
+	);
+
+	///	<summary>
+	///		Get the directory of a path, including the trailing slash.
+	///	</summary>
+	static std::string GetDirectory(
+		const std::string & strFilename
+	);
+
+	///	<summary>
+	///		Partition files among sRanks ranks.  Consecutive files in the
+	///		same directory are grouped into chunks of at most 1/ChunksPerRank
+	///		of the cost of a rank, and the costliest chunks are assigned
+	///		first, each to the rank with the least cost so far.  The
+	///		indices of each rank are in ascending order.  The result
+	///		depends only on the arguments, so every rank computes the
+	///		same partition.
+	///	</summary>
+	static void Partition(
+		const std::vector<std::string> & vecFilenames,
+		const std::vector<double> & vecCosts,
+		size_t sRanks,
+		std::vector< std::vector<size_t> > & vecRankIndices
+	);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
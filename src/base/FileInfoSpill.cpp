@@ -0,0 +1,376 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    FileInfoSpill.cpp
+///	\version October 15, 2026
+///
+
+#include "FileInfoSpill.h"
+#include "Exception.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Append a value in native byte order; the spill file is only read
+///		by the process that wrote it.
+///	</summary>
+template <typename T>
+static void SpillPut(
+	std::vector<char> & vecData,
+	T value
+) {
+	const size_t sOffset = vecData.size();
+	vecData.resize(sOffset + sizeof(T));
+	memcpy(&(vecData[sOffset]), &value, sizeof(T));
+}
+
+///	<summary>
+///		Append a length-prefixed string.
+///	</summary>
+static void SpillPutString(
+	std::vector<char> & vecData,
+	const std::string & str
+) {
+	SpillPut<uint32_t>(vecData, static_cast<uint32_t>(str.length()));
+	vecData.insert(vecData.end(), str.begin(), str.end());
+}
+
+///	<summary>
+///		Append a map of interned attribute names to values.
+///	</summary>
+static void SpillPutAttributes(
+	std::vector<char> & vecData,
+	const AttributeMap & mapAttributes
+) {
+	SpillPut<uint32_t>(vecData, static_cast<uint32_t>(mapAttributes.size()));
+	AttributeMap::const_iterator iter = mapAttributes.begin();
+	for (; iter != mapAttributes.end(); iter++) {
+		SpillPutString(vecData, iter->first.str());
+		SpillPutString(vecData, iter->second.str());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A cursor over the bytes of one record.
+///	</summary>
+class SpillCursor {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	SpillCursor(
+		const char * pData,
+		size_t sSize
+	) :
+		m_pData(pData),
+		m_sSize(sSize),
+		m_sPos(0)
+	{ }
+
+	///	<summary>
+	///		Read a value, returning false past the end of the record.
+	///	</summary>
+	template <typename T>
+	bool Get(T & value) {
+		if (m_sSize - m_sPos < sizeof(T)) {
+			return false;
+		}
+		memcpy(&value, m_pData + m_sPos, sizeof(T));
+		m_sPos += sizeof(T);
+		return true;
+	}
+
+	///	<summary>
+	///		Read a length-prefixed string.
+	///	</summary>
+	bool GetString(std::string & str) {
+		uint32_t uiLength;
+		if (!Get(uiLength) || (m_sSize - m_sPos < uiLength)) {
+			return false;
+		}
+		str.assign(m_pData + m_sPos, uiLength);
+		m_sPos += uiLength;
+		return true;
+	}
+
+	///	<summary>
+	///		Read a map of attribute names to values.
+	///	</summary>
+	bool GetAttributes(AttributeMap & mapAttributes) {
+		uint32_t uiCount;
+		if (!Get(uiCount)) {
+			return false;
+		}
+		std::string strName;
+		std::string strValue;
+		for (uint32_t i = 0; i < uiCount; i++) {
+			if (!GetString(strName) || !GetString(strValue)) {
+				return false;
+			}
+			mapAttributes.insert(
+				AttributeMap::value_type(
+					InternedString(strName), InternedString(strValue)));
+		}
+		return true;
+	}
+
+protected:
+	///	<summary>
+	///		Bytes of the record.
+	///	</summary>
+	const char * m_pData;
+
+	///	<summary>
+	///		Size of the record.
+	///	</summary>
+	size_t m_sSize;
+
+	///	<summary>
+	///		Position of the next byte.
+	///	</summary>
+	size_t m_sPos;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+FileInfoSpill::~FileInfoSpill() {
+	if (m_fd != (-1)) {
+		close(m_fd);
+		unlink(m_strFilename.c_str());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string FileInfoSpill::Open(
+	const std::string & strFilename,
+	size_t sBufferBytes
+) {
+	if (m_fd != (-1)) {
+		_EXCEPTIONT("Spill file already open");
+	}
+
+	m_fd = open(strFilename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if (m_fd == (-1)) {
+		return std::string("Unable to create spill file \"")
+			+ strFilename + std::string("\": ") + strerror(errno);
+	}
+	m_strFilename = strFilename;
+	m_sBufferBytes = sBufferBytes;
+	m_vecBuffer.reserve(sBufferBytes);
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string FileInfoSpill::Append(
+	const FileInfo & fileinfo
+) {
+	if (m_fd == (-1)) {
+		_EXCEPTIONT("Spill file not open");
+	}
+
+	m_vecOffsets.push_back(GetFileBytes());
+
+	// Reserve the record length, filled in once the record is complete
+	const size_t sBegin = m_vecBuffer.size();
+	SpillPut<uint32_t>(m_vecBuffer, 0);
+
+	SpillPutString(m_vecBuffer, fileinfo.m_strFilename);
+	SpillPut<long long>(m_vecBuffer, fileinfo.m_stamp.m_llSize);
+	SpillPut<long long>(m_vecBuffer, fileinfo.m_stamp.m_llModTime);
+	SpillPut<unsigned long long>(m_vecBuffer, fileinfo.m_stamp.m_ullInode);
+	SpillPutAttributes(m_vecBuffer, fileinfo.m_mapKeyAttributes);
+	SpillPutAttributes(m_vecBuffer, fileinfo.m_mapOtherAttributes);
+
+	SpillPut<uint32_t>(m_vecBuffer,
+		static_cast<uint32_t>(fileinfo.m_mapAxisSubAxis.size()));
+	AxisSubAxisMap::const_iterator iter = fileinfo.m_mapAxisSubAxis.begin();
+	for (; iter != fileinfo.m_mapAxisSubAxis.end(); iter++) {
+		SpillPutString(m_vecBuffer, iter->first);
+		SpillPutString(m_vecBuffer, iter->second);
+	}
+
+	SpillPut<uint32_t>(m_vecBuffer,
+		static_cast<uint32_t>(fileinfo.m_mapVariableStatistics.size()));
+	std::map<std::string, VariableStatistics>::const_iterator iterStats =
+		fileinfo.m_mapVariableStatistics.begin();
+	for (; iterStats != fileinfo.m_mapVariableStatistics.end(); iterStats++) {
+		SpillPutString(m_vecBuffer, iterStats->first);
+		SpillPut<VariableStatistics>(m_vecBuffer, iterStats->second);
+	}
+
+	const uint32_t uiLength =
+		static_cast<uint32_t>(m_vecBuffer.size() - sBegin - sizeof(uint32_t));
+	memcpy(&(m_vecBuffer[sBegin]), &uiLength, sizeof(uint32_t));
+
+	if (m_vecBuffer.size() >= m_sBufferBytes) {
+		return Flush();
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string FileInfoSpill::Flush() {
+	size_t sWritten = 0;
+	while (sWritten < m_vecBuffer.size()) {
+		ssize_t sResult = write(
+			m_fd,
+			&(m_vecBuffer[sWritten]),
+			m_vecBuffer.size() - sWritten);
+		if (sResult < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return std::string("Error writing spill file \"")
+				+ m_strFilename + std::string("\": ") + strerror(errno);
+		}
+		sWritten += static_cast<size_t>(sResult);
+	}
+	m_ullFileBytes += m_vecBuffer.size();
+	m_vecBuffer.clear();
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string FileInfoSpill::Read(
+	size_t sFileIx,
+	FileInfo & fileinfo
+) const {
+	if (sFileIx >= m_vecOffsets.size()) {
+		_EXCEPTION1("File index %lu out of range", sFileIx);
+	}
+
+	const unsigned long long ullOffset = m_vecOffsets[sFileIx];
+
+	// Records still in the write buffer are read from it
+	std::vector<char> vecRecord;
+	const char * pRecord;
+	uint32_t uiLength;
+	if (ullOffset >= m_ullFileBytes) {
+		const size_t sBegin = static_cast<size_t>(ullOffset - m_ullFileBytes);
+		memcpy(&uiLength, &(m_vecBuffer[sBegin]), sizeof(uint32_t));
+		pRecord = &(m_vecBuffer[sBegin + sizeof(uint32_t)]);
+
+	} else {
+		if (pread(m_fd, &uiLength, sizeof(uint32_t), ullOffset)
+			!= static_cast<ssize_t>(sizeof(uint32_t))
+		) {
+			return std::string("Error reading spill file \"")
+				+ m_strFilename + std::string("\"");
+		}
+		vecRecord.resize(uiLength);
+		size_t sRead = 0;
+		while (sRead < uiLength) {
+			ssize_t sResult = pread(
+				m_fd,
+				&(vecRecord[sRead]),
+				uiLength - sRead,
+				ullOffset + sizeof(uint32_t) + sRead);
+			if (sResult <= 0) {
+				if ((sResult < 0) && (errno == EINTR)) {
+					continue;
+				}
+				return std::string("Error reading spill file \"")
+					+ m_strFilename + std::string("\"");
+			}
+			sRead += static_cast<size_t>(sResult);
+		}
+		pRecord = (uiLength != 0)?(&(vecRecord[0])):(NULL);
+	}
+
+	SpillCursor cursor(pRecord, uiLength);
+
+	fileinfo.m_mapKeyAttributes.clear();
+	fileinfo.m_mapOtherAttributes.clear();
+	fileinfo.m_mapAxisSubAxis.clear();
+	fileinfo.m_mapVariableStatistics.clear();
+
+	bool fValid =
+		cursor.GetString(fileinfo.m_strFilename)
+		&& cursor.Get(fileinfo.m_stamp.m_llSize)
+		&& cursor.Get(fileinfo.m_stamp.m_llModTime)
+		&& cursor.Get(fileinfo.m_stamp.m_ullInode)
+		&& cursor.GetAttributes(fileinfo.m_mapKeyAttributes)
+		&& cursor.GetAttributes(fileinfo.m_mapOtherAttributes);
+
+	uint32_t uiAxes = 0;
+	fValid = fValid && cursor.Get(uiAxes);
+	std::string strAxisName;
+	std::string strSubAxisId;
+	for (uint32_t a = 0; fValid && (a < uiAxes); a++) {
+		fValid = cursor.GetString(strAxisName) && cursor.GetString(strSubAxisId);
+		if (fValid) {
+			fileinfo.m_mapAxisSubAxis.insert(
+				AxisSubAxisPair(strAxisName, strSubAxisId));
+		}
+	}
+
+	uint32_t uiStatistics = 0;
+	fValid = fValid && cursor.Get(uiStatistics);
+	std::string strVariableName;
+	VariableStatistics stats;
+	for (uint32_t v = 0; fValid && (v < uiStatistics); v++) {
+		fValid = cursor.GetString(strVariableName) && cursor.Get(stats);
+		if (fValid) {
+			fileinfo.m_mapVariableStatistics[strVariableName] = stats;
+		}
+	}
+
+	if (!fValid) {
+		return std::string("Corrupt record in spill file \"")
+			+ m_strFilename + std::string("\"");
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FileInfoSpill::ForEachInIdOrder(
+	const std::function<void(const std::string &, const FileInfo &)> & fn
+) const {
+	const size_t sFiles = m_vecOffsets.size();
+	if (sFiles == 0) {
+		return;
+	}
+
+	FileInfo fileinfo("");
+	auto Visit = [&](size_t sFileIx) {
+		std::string strError = Read(sFileIx, fileinfo);
+		if (strError != "") {
+			_EXCEPTIONT(strError.c_str());
+		}
+		fn(IndexIdToString(static_cast<IndexId>(sFileIx)), fileinfo);
+	};
+
+	// "0" sorts first; the remaining ids are visited in lexicographic
+	// order of their decimal strings by walking the implicit tree in
+	// which the children of n are 10n through 10n+9
+	Visit(0);
+	size_t sFileIx = 1;
+	for (size_t i = 1; i < sFiles; i++) {
+		Visit(sFileIx);
+		if (sFileIx * 10 < sFiles) {
+			sFileIx *= 10;
+		} else {
+			while ((sFileIx % 10 == 9) || (sFileIx + 1 >= sFiles)) {
+				sFileIx /= 10;
+			}
+			sFileIx++;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
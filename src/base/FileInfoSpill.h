@@ -0,0 +1,156 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    FileInfoSpill.h
+///	\version October 15, 2026
+///
+
+#ifndef _FILEINFOSPILL_H_
+#define _FILEINFOSPILL_H_
+
+#include "IndexedDataset.h"
+
+#include <string>
+#include <vector>
+#include <functional>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A sequential file holding the FileInfo of every indexed file, so
+///		that an index of many files need not keep them in memory.  Records
+///		are appended in order of file id through a write buffer of bounded
+///		size, and only the offset of each record is kept in memory.  The
+///		file is removed when the spill is destroyed.
+///	</summary>
+class FileInfoSpill {
+
+public:
+	///	<summary>
+	///		Default size of the write buffer in bytes.
+	///	</summary>
+	static const size_t DefaultBufferBytes = 16 * 1024 * 1024;
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	FileInfoSpill() :
+		m_fd(-1),
+		m_sBufferBytes(DefaultBufferBytes),
+		m_ullFileBytes(0)
+	{ }
+
+	///	<summary>
+	///		Destructor.
+	///	</summary>
+	~FileInfoSpill();
+
+private:
+	///	<summary>
+	///		Not copyable.
+	///	</summary>
+	FileInfoSpill(const FileInfoSpill &);
+	FileInfoSpill & operator=(const FileInfoSpill &);
+
+public:
+	///	<summary>
+	///		Create the spill file, replacing any existing file.  Records
+	///		are written once sBufferBytes of them are held in memory.
+	///		Returns an error message on failure.
+	///	</summary>
+	std::string Open(
+		const std::string & strFilename,
+		size_t sBufferBytes = DefaultBufferBytes
+	);
+
+	///	<summary>
+	///		Append the FileInfo of the next file id.  Returns an error
+	///		message on failure.
+	///	</summary>
+	std::string Append(
+		const FileInfo & fileinfo
+	);
+
+	///	<summary>
+	///		Read the FileInfo of the given file id.  Returns an error
+	///		message on failure.
+	///	</summary>
+	std::string Read(
+		size_t sFileIx,
+		FileInfo & fileinfo
+	) const;
+
+	///	<summary>
+	///		Call fn with the string id and FileInfo of every file, in the
+	///		order of their string ids as in the "file" section of an index.
+	///		Throws an Exception if a record cannot be read.
+	///	</summary>
+	void ForEachInIdOrder(
+		const std::function<void(const std::string &, const FileInfo &)> & fn
+	) const;
+
+	///	<summary>
+	///		Get the number of files spilled.
+	///	</summary>
+	size_t size() const {
+		return m_vecOffsets.size();
+	}
+
+	///	<summary>
+	///		Get the bytes of memory used by the offsets and write buffer.
+	///	</summary>
+	size_t GetMemoryBytes() const {
+		return m_vecOffsets.capacity() * sizeof(unsigned long long)
+			+ m_vecBuffer.capacity();
+	}
+
+	///	<summary>
+	///		Get the number of bytes of records written or buffered.
+	///	</summary>
+	unsigned long long GetFileBytes() const {
+		return m_ullFileBytes + m_vecBuffer.size();
+	}
+
+protected:
+	///	<summary>
+	///		Write the buffered records to the file.  Returns an error
+	///		message on failure.
+	///	</summary>
+	std::string Flush();
+
+protected:
+	///	<summary>
+	///		Name of the spill file.
+	///	</summary>
+	std::string m_strFilename;
+
+	///	<summary>
+	///		Descriptor of the spill file, or -1.
+	///	</summary>
+	int m_fd;
+
+	///	<summary>
+	///		Size of the write buffer in bytes.
+	///	</summary>
+	size_t m_sBufferBytes;
+
+	///	<summary>
+	///		Records not yet written to the file.
+	///	</summary>
+	std::vector<char> m_vecBuffer;
+
+	///	<summary>
+	///		Bytes written to the file.
+	///	</summary>
+	unsigned long long m_ullFileBytes;
+
+	///	<summary>
+	///		Offset of the record of each file id.
+	///	</summary>
+	std::vector<unsigned long long> m_vecOffsets;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
@@ -0,0 +1,159 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    FileNameFilter.cpp
+///	\version October 14, 2026
+///
+
+#include "FileNameFilter.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// FileNamePattern
+///////////////////////////////////////////////////////////////////////////////
+
+FileNamePattern::FileNamePattern(
+	const std::string & strPattern
+) :
+	m_strPattern(strPattern),
+	m_sMinLength(0)
+{
+	std::string strSegment;
+	for (size_t i = 0; i < strPattern.length(); i++) {
+		if (strPattern[i] == '*') {
+			m_vecSegments.push_back(strSegment);
+			m_sMinLength += strSegment.length();
+			strSegment.clear();
+		} else {
+			strSegment += strPattern[i];
+		}
+	}
+	m_vecSegments.push_back(strSegment);
+	m_sMinLength += strSegment.length();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool FileNamePattern::SegmentMatches(
+	const std::string & strSegment,
+	const char * szText
+) {
+	for (size_t i = 0; i < strSegment.length(); i++) {
+		if ((strSegment[i] != '?') && (strSegment[i] != szText[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool FileNamePattern::Matches(
+	const char * szName,
+	size_t sLength
+) const {
+	if (sLength < m_sMinLength) {
+		return false;
+	}
+
+	// No stars
+	const size_t sSegments = m_vecSegments.size();
+	if (sSegments == 1) {
+		return (sLength == m_sMinLength)
+			&& SegmentMatches(m_vecSegments[0], szName);
+	}
+
+	// Anchored first and last segments
+	const std::string & strFirst = m_vecSegments[0];
+	const std::string & strLast = m_vecSegments[sSegments-1];
+	if (!SegmentMatches(strFirst, szName)) {
+		return false;
+	}
+	size_t sEnd = sLength - strLast.length();
+	if (!SegmentMatches(strLast, szName + sEnd)) {
+		return false;
+	}
+
+	// Middle segments at their leftmost position
+	size_t sPos = strFirst.length();
+	for (size_t s = 1; s < sSegments-1; s++) {
+		const std::string & strSegment = m_vecSegments[s];
+		for (;;) {
+			if (sPos + strSegment.length() > sEnd) {
+				return false;
+			}
+			if (SegmentMatches(strSegment, szName + sPos)) {
+				break;
+			}
+			sPos++;
+		}
+		sPos += strSegment.length();
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// FileNameFilter
+///////////////////////////////////////////////////////////////////////////////
+
+std::string FileNameFilter::Parse(
+	const std::string & strInclude,
+	const std::string & strExclude
+) {
+	for (int iList = 0; iList < 2; iList++) {
+		const std::string & strList = (iList == 0)?(strInclude):(strExclude);
+		if (strList == "") {
+			continue;
+		}
+
+		size_t sBegin = 0;
+		for (;;) {
+			size_t sComma = strList.find(',', sBegin);
+			std::string strPattern =
+				strList.substr(sBegin,
+					(sComma == std::string::npos)?(std::string::npos):(sComma - sBegin));
+			if (strPattern == "") {
+				return std::string("Empty pattern in \"") + strList + std::string("\"");
+			}
+			if (iList == 0) {
+				AddInclude(strPattern);
+			} else {
+				AddExclude(strPattern);
+			}
+			if (sComma == std::string::npos) {
+				break;
+			}
+			sBegin = sComma + 1;
+		}
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool FileNameFilter::IsIncluded(
+	const char * szName,
+	size_t sLength
+) const {
+	for (size_t i = 0; i < m_vecInclude.size(); i++) {
+		if (m_vecInclude[i].Matches(szName, sLength)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool FileNameFilter::IsExcluded(
+	const char * szName,
+	size_t sLength
+) const {
+	for (size_t i = 0; i < m_vecExclude.size(); i++) {
+		if (m_vecExclude[i].Matches(szName, sLength)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
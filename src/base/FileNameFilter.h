@@ -0,0 +1,153 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    FileNameFilter.h
+///	\version October 14, 2026
+///
+
+#ifndef _FILENAMEFILTER_H_
+#define _FILENAMEFILTER_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A wildcard pattern, where '*' matches any run of characters and
+///		'?' matches any one character, compiled into the literal segments
+///		between its stars.  The first and last segments are anchored and
+///		each middle segment is matched at its leftmost position, which is
+///		exact for these patterns and never backtracks.
+///	</summary>
+class FileNamePattern {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	FileNamePattern(
+		const std::string & strPattern
+	);
+
+public:
+	///	<summary>
+	///		Check if a name matches the pattern.
+	///	</summary>
+	bool Matches(
+		const char * szName,
+		size_t sLength
+	) const;
+
+	///	<summary>
+	///		Get the pattern.
+	///	</summary>
+	const std::string & GetPattern() const {
+		return m_strPattern;
+	}
+
+protected:
+	///	<summary>
+	///		Check if a segment matches at the start of szText.
+	///	</summary>
+	static bool SegmentMatches(
+		const std::string & strSegment,
+		const char * szText
+	);
+
+protected:
+	///	<summary>
+	///		The pattern.
+	///	</summary>
+	std::string m_strPattern;
+
+	///	<summary>
+	///		Segments between stars.  A pattern without stars has one.
+	///	</summary>
+	std::vector<std::string> m_vecSegments;
+
+	///	<summary>
+	///		Total length of all segments.
+	///	</summary>
+	size_t m_sMinLength;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A set of include and exclude patterns.  A file is accepted if it
+///		matches any include pattern and no exclude pattern; a directory is
+///		pruned if it matches any exclude pattern.
+///	</summary>
+class FileNameFilter {
+
+public:
+	///	<summary>
+	///		Add comma-separated include and exclude patterns.
+	///	</summary>
+	std::string Parse(
+		const std::string & strInclude,
+		const std::string & strExclude
+	);
+
+	///	<summary>
+	///		Add an include pattern.
+	///	</summary>
+	void AddInclude(
+		const std::string & strPattern
+	) {
+		m_vecInclude.push_back(FileNamePattern(strPattern));
+	}
+
+	///	<summary>
+	///		Add an exclude pattern.
+	///	</summary>
+	void AddExclude(
+		const std::string & strPattern
+	) {
+		m_vecExclude.push_back(FileNamePattern(strPattern));
+	}
+
+public:
+	///	<summary>
+	///		Check if a name matches an include pattern.
+	///	</summary>
+	bool IsIncluded(
+		const char * szName,
+		size_t sLength
+	) const;
+
+	///	<summary>
+	///		Check if a name matches an exclude pattern.
+	///	</summary>
+	bool IsExcluded(
+		const char * szName,
+		size_t sLength
+	) const;
+
+	///	<summary>
+	///		Check if a file is accepted.
+	///	</summary>
+	bool Accepts(
+		const char * szName,
+		size_t sLength
+	) const {
+		return IsIncluded(szName, sLength) && !IsExcluded(szName, sLength);
+	}
+
+protected:
+	///	<summary>
+	///		Include patterns.
+	///	</summary>
+	std::vector<FileNamePattern> m_vecInclude;
+
+	///	<summary>
+	///		Exclude patterns.
+	///	</summary>
+	std::vector<FileNamePattern> m_vecExclude;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
@@ -0,0 +1,156 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    GridRegistry.cpp
+///	\version October 15, 2026
+///
+
+#include "GridRegistry.h"
+#include "CompressedStream.h"
+#include "../contrib/json.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string GridRegistry::FromFile(
+	const std::string & strFilename
+) {
+	CompressedInputStream ifs(strFilename);
+	if (!ifs.is_open()) {
+		return std::string("Unable to open grid registry \"")
+			+ strFilename + std::string("\"");
+	}
+
+	nlohmann::json j;
+	try {
+		ifs >> j;
+	} catch(nlohmann::json::exception & ex) {
+		return std::string("Error parsing grid registry \"")
+			+ strFilename + std::string("\": ") + std::string(ex.what());
+	}
+
+	nlohmann::json::iterator itergrids = j.find("grids");
+	if ((itergrids == j.end()) || !itergrids->is_object()) {
+		return std::string("Grid registry \"") + strFilename
+			+ std::string("\" missing \"grids\" object");
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_mapGrids.clear();
+	for (nlohmann::json::iterator iter = itergrids->begin(); iter != itergrids->end(); iter++) {
+		const std::string & strKey = iter.key();
+		char * pEnd = NULL;
+		unsigned long long ullFingerprint = strtoull(strKey.c_str(), &pEnd, 16);
+		if ((strKey.length() == 0) || (strKey.length() > 16) || (*pEnd != '\0')) {
+			return std::string("Grid registry \"") + strFilename
+				+ std::string("\" has invalid fingerprint \"") + strKey
+				+ std::string("\"");
+		}
+
+		std::unique_ptr<SubAxis> psubaxis(new SubAxis());
+		psubaxis->FromJSON(strKey, iter.value());
+
+		// A grid whose values do not reproduce its fingerprint would be
+		// substituted for different coordinates
+		if (psubaxis->m_fSummarized ||
+		    (psubaxis->GetContentFingerprint() != ullFingerprint)
+		) {
+			return std::string("Grid registry \"") + strFilename
+				+ std::string("\" grid \"") + strKey
+				+ std::string("\" does not match its fingerprint");
+		}
+		m_mapGrids[ullFingerprint] = std::move(psubaxis);
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string GridRegistry::ToFile(
+	const std::string & strFilename
+) const {
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Grids are written in fingerprint order so the file is reproducible
+	std::vector<unsigned long long> vecFingerprints;
+	vecFingerprints.reserve(m_mapGrids.size());
+	for (auto iter = m_mapGrids.begin(); iter != m_mapGrids.end(); iter++) {
+		vecFingerprints.push_back(iter->first);
+	}
+	std::sort(vecFingerprints.begin(), vecFingerprints.end());
+
+	nlohmann::json j;
+	nlohmann::json & jgrids = j["grids"];
+	jgrids = nlohmann::json::object();
+	for (size_t i = 0; i < vecFingerprints.size(); i++) {
+		char szFingerprint[32];
+		snprintf(szFingerprint, sizeof(szFingerprint), "%016llx", vecFingerprints[i]);
+		m_mapGrids.find(vecFingerprints[i])->second->ToJSON(jgrids[szFingerprint]);
+	}
+
+	CompressedOutputStream ofs(strFilename);
+	if (!ofs.is_open()) {
+		return std::string("Unable to open grid registry \"")
+			+ strFilename + std::string("\" for writing");
+	}
+	ofs << j << std::endl;
+	ofs.close();
+	if (!ofs) {
+		return std::string("Error writing grid registry \"")
+			+ strFilename + std::string("\"");
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const SubAxis * GridRegistry::Find(
+	unsigned long long ullFingerprint
+) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto iter = m_mapGrids.find(ullFingerprint);
+	if (iter == m_mapGrids.end()) {
+		return NULL;
+	}
+	return iter->second.get();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool GridRegistry::Insert(
+	const SubAxis & subaxis
+) {
+	if (subaxis.m_fSummarized || (subaxis.m_lSize < MinGridSize)) {
+		return false;
+	}
+	if (!IsNumericNcType(subaxis.m_nctype)) {
+		return false;
+	}
+
+	unsigned long long ullFingerprint = subaxis.GetContentFingerprint();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_mapGrids.find(ullFingerprint) != m_mapGrids.end()) {
+		return false;
+	}
+
+	// Only the values are registered; units belong to the axis
+	std::unique_ptr<SubAxis> psubaxis(new SubAxis());
+	psubaxis->m_nctype = subaxis.m_nctype;
+	psubaxis->m_lSize = subaxis.m_lSize;
+	psubaxis->m_values = subaxis.m_values;
+	psubaxis->m_fLinear = subaxis.m_fLinear;
+	psubaxis->m_dLinearStart = subaxis.m_dLinearStart;
+	psubaxis->m_dLinearStep = subaxis.m_dLinearStep;
+
+	m_mapGrids[ullFingerprint] = std::move(psubaxis);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    GridRegistry.h
+///	\version October 15, 2026
+///
+
+#ifndef _GRIDREGISTRY_H_
+#define _GRIDREGISTRY_H_
+
+#include "IndexedDataset.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A registry of coordinate arrays shared by many indexes, such as
+///		those of standard grids, keyed by their content fingerprint (see
+///		SubAxis::GetContentFingerprint).  An index written with a registry
+///		references the registered arrays by fingerprint in place of their
+///		values, and an index referencing them can only be read with the
+///		same registry.
+///
+///		The registry is stored as a JSON file, optionally compressed, of
+///		the form {"grids": {"<fingerprint>": {<subaxis>}, ...}}.  Grids
+///		may be found and inserted concurrently by indexes built on
+///		different threads; a registered grid is never removed except by
+///		FromFile.
+///	</summary>
+class GridRegistry {
+
+public:
+	///	<summary>
+	///		Smallest number of values of a registered SubAxis; shorter
+	///		arrays take little more space than a reference.
+	///	</summary>
+	static const long MinGridSize = 8;
+
+public:
+	///	<summary>
+	///		Load the registry from a file, replacing its contents.
+	///		Returns an error message on failure.
+	///	</summary>
+	std::string FromFile(
+		const std::string & strFilename
+	);
+
+	///	<summary>
+	///		Write the registry to a file.  Returns an error message on
+	///		failure.
+	///	</summary>
+	std::string ToFile(
+		const std::string & strFilename
+	) const;
+
+	///	<summary>
+	///		Find the SubAxis with the given fingerprint, or NULL.
+	///	</summary>
+	const SubAxis * Find(
+		unsigned long long ullFingerprint
+	) const;
+
+	///	<summary>
+	///		Register a copy of the values of a SubAxis.  Summarized and
+	///		untyped SubAxis, and those shorter than MinGridSize, are not
+	///		registered.  Returns true if the SubAxis was added.
+	///	</summary>
+	bool Insert(
+		const SubAxis & subaxis
+	);
+
+	///	<summary>
+	///		Get the number of registered grids.
+	///	</summary>
+	size_t GetGridCount() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_mapGrids.size();
+	}
+
+protected:
+	///	<summary>
+	///		Mutex guarding the registered grids.
+	///	</summary>
+	mutable std::mutex m_mutex;
+
+	///	<summary>
+	///		Registered grids by fingerprint.
+	///	</summary>
+	std::unordered_map<unsigned long long, std::unique_ptr<SubAxis> > m_mapGrids;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
@@ -0,0 +1,924 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    HyperionAPI.cpp
+///	\version October 15, 2026
+///
+
+#include "HyperionAPI.h"
+#include "IndexedDataset.h"
+#include "Announce.h"
+#include "Exception.h"
+
+#include <exception>
+#include <iterator>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		An IndexedDataset with the names of its variables and axes in
+///		index order, refreshed whenever the dataset is modified.
+///	</summary>
+struct hyperion_dataset {
+
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	hyperion_dataset(
+		const std::string & strName
+	) :
+		m_dataset(strName)
+	{ }
+
+	///	<summary>
+	///		Rebuild the lookups and the query index of the dataset after
+	///		it has been modified.
+	///	</summary>
+	void Refresh() {
+		m_dataset.BuildFileIdLookups();
+		m_dataset.GetVariableNames(m_vecVariableNames);
+		m_dataset.GetAxisNames(m_vecAxisNames);
+		m_strQueryIndexError = m_dataset.BuildQueryIndex();
+	}
+
+	///	<summary>
+	///		The dataset.
+	///	</summary>
+	IndexedDataset m_dataset;
+
+	///	<summary>
+	///		Names of the variables of the dataset.
+	///	</summary>
+	std::vector<std::string> m_vecVariableNames;
+
+	///	<summary>
+	///		Names of the axes of the dataset.
+	///	</summary>
+	std::vector<std::string> m_vecAxisNames;
+
+	///	<summary>
+	///		Error from building the query index, reported by queries.
+	///	</summary>
+	std::string m_strQueryIndexError;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		The result of a query.
+///	</summary>
+struct hyperion_query_result {
+
+	///	<summary>
+	///		Files and ranges of indices found by the query.
+	///	</summary>
+	std::vector<QueryFileRange> m_vecResults;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Last error on each thread.
+///	</summary>
+static thread_local std::string s_strLastError;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Record an error message, if there is one, and convert it to a
+///		return code.
+///	</summary>
+static int HyperionReturn(
+	const std::string & strError
+) {
+	if (strError != "") {
+		s_strLastError = strError;
+		return HYPERION_ERROR;
+	}
+	return HYPERION_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Call a function returning an error message, so that no exception
+///		crosses the C interface.
+///	</summary>
+template <typename Function>
+static int HyperionCall(
+	Function fn
+) {
+	try {
+		return HyperionReturn(fn());
+	} catch(Exception & e) {
+		return HyperionReturn(e.ToString());
+	} catch(std::exception & e) {
+		return HyperionReturn(std::string(e.what()));
+	} catch(...) {
+		return HyperionReturn(std::string("Unknown exception"));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check that a dataset was given.
+///	</summary>
+static bool HyperionCheckDataset(
+	const hyperion_dataset * ds
+) {
+	if (ds == NULL) {
+		HyperionReturn(std::string("No dataset given"));
+		return false;
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Find a variable of a dataset, recording an error if there is none.
+///	</summary>
+static const VariableInfo * HyperionFindVariable(
+	const hyperion_dataset * ds,
+	const char * var
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return NULL;
+	}
+	if (var == NULL) {
+		HyperionReturn(std::string("No variable given"));
+		return NULL;
+	}
+	const VariableInfo * pvarinfo = ds->m_dataset.GetVariableInfo(var);
+	if (pvarinfo == NULL) {
+		HyperionReturn(std::string("Variable \"") + var + std::string("\" not found"));
+	}
+	return pvarinfo;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Find an axis of a dataset, recording an error if there is none.
+///	</summary>
+static const AxisInfo * HyperionFindAxis(
+	const hyperion_dataset * ds,
+	const char * axis
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return NULL;
+	}
+	if (axis == NULL) {
+		HyperionReturn(std::string("No axis given"));
+		return NULL;
+	}
+	const AxisInfo * paxisinfo = ds->m_dataset.GetAxisInfo(axis);
+	if (paxisinfo == NULL) {
+		HyperionReturn(std::string("Axis \"") + axis + std::string("\" not found"));
+	}
+	return paxisinfo;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Find a subaxis of a dataset, recording an error if there is none.
+///	</summary>
+static const SubAxis * HyperionFindSubAxis(
+	const hyperion_dataset * ds,
+	const char * axis,
+	const char * subaxis_id
+) {
+	const AxisInfo * paxisinfo = HyperionFindAxis(ds, axis);
+	if (paxisinfo == NULL) {
+		return NULL;
+	}
+	if (subaxis_id == NULL) {
+		HyperionReturn(std::string("No subaxis given"));
+		return NULL;
+	}
+	AxisInfo::SubAxisVector::const_iterator itersubaxis =
+		paxisinfo->m_vecSubAxis.find(subaxis_id);
+	if (itersubaxis == paxisinfo->m_vecSubAxis.end()) {
+		HyperionReturn(std::string("Subaxis \"") + subaxis_id
+			+ std::string("\" of axis \"") + axis + std::string("\" not found"));
+		return NULL;
+	}
+	return (*itersubaxis);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Find a list of dimensions of a variable, recording an error if
+///		there is none.
+///	</summary>
+static const AxisNameVector * HyperionFindDimensionList(
+	const hyperion_dataset * ds,
+	const char * var,
+	size_t list_ix
+) {
+	const VariableInfo * pvarinfo = HyperionFindVariable(ds, var);
+	if (pvarinfo == NULL) {
+		return NULL;
+	}
+	if (list_ix >= pvarinfo->m_mapSubAxisToFileIdMaps.size()) {
+		HyperionReturn(std::string("Dimension list index out of range"));
+		return NULL;
+	}
+	return &(std::next(pvarinfo->m_mapSubAxisToFileIdMaps.begin(), list_ix)->first);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Find a file of a query result, recording an error if there is none.
+///	</summary>
+static const QueryFileRange * HyperionFindQueryFile(
+	const hyperion_query_result * result,
+	size_t ix
+) {
+	if (result == NULL) {
+		HyperionReturn(std::string("No query result given"));
+		return NULL;
+	}
+	if (ix >= result->m_vecResults.size()) {
+		HyperionReturn(std::string("Query result index out of range"));
+		return NULL;
+	}
+	return &(result->m_vecResults[ix]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Library
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_api_version(void) {
+	return HYPERION_API_VERSION;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * hyperion_last_error(void) {
+	return s_strLastError.c_str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void hyperion_set_log(
+	FILE * fp
+) {
+	AnnounceSetOutputBuffer(fp);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void hyperion_set_verbosity(
+	int level
+) {
+	AnnounceSetVerbosityLevel(level);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Dataset
+///////////////////////////////////////////////////////////////////////////////
+
+hyperion_dataset * hyperion_dataset_create(
+	const char * name
+) {
+	hyperion_dataset * ds = NULL;
+	HyperionCall([&]() -> std::string {
+		ds = new hyperion_dataset((name == NULL)?(""):(name));
+		return std::string("");
+	});
+	return ds;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void hyperion_dataset_destroy(
+	hyperion_dataset * ds
+) {
+	delete ds;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_dataset_set_threads(
+	hyperion_dataset * ds,
+	size_t threads
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return HYPERION_ERROR;
+	}
+	ds->m_dataset.SetThreadCount(threads);
+	return HYPERION_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_dataset_set_native_headers(
+	hyperion_dataset * ds,
+	int enable
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return HYPERION_ERROR;
+	}
+	ds->m_dataset.SetNativeClassicHeaders(enable != 0);
+	return HYPERION_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_dataset_set_statistics(
+	hyperion_dataset * ds,
+	int enable
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return HYPERION_ERROR;
+	}
+	ds->m_dataset.SetComputeStatistics(enable != 0);
+	return HYPERION_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_dataset_index_path(
+	hyperion_dataset * ds,
+	const char * path,
+	const char * patterns,
+	int recurse,
+	const char * exclude
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return HYPERION_ERROR;
+	}
+	if ((path == NULL) || (patterns == NULL)) {
+		return HyperionReturn(std::string("No path or patterns given"));
+	}
+	return HyperionCall([&]() -> std::string {
+		std::string strError =
+			ds->m_dataset.PopulateFromFilePath(
+				path, patterns, (recurse != 0), (exclude == NULL)?(""):(exclude));
+		ds->Refresh();
+		return strError;
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_dataset_index_file_list(
+	hyperion_dataset * ds,
+	const char * file_list
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return HYPERION_ERROR;
+	}
+	if (file_list == NULL) {
+		return HyperionReturn(std::string("No file list given"));
+	}
+	return HyperionCall([&]() -> std::string {
+		std::string strError = ds->m_dataset.PopulateFromFileList(file_list);
+		ds->Refresh();
+		return strError;
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_dataset_index_files(
+	hyperion_dataset * ds,
+	const char * const * files,
+	size_t count
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return HYPERION_ERROR;
+	}
+	if ((files == NULL) && (count != 0)) {
+		return HyperionReturn(std::string("No files given"));
+	}
+	return HyperionCall([&]() -> std::string {
+		std::vector<std::string> vecFilenames;
+		for (size_t f = 0; f < count; f++) {
+			if (files[f] == NULL) {
+				return std::string("File ") + std::to_string(f) + std::string(" is NULL");
+			}
+			vecFilenames.push_back(files[f]);
+		}
+		std::string strError = ds->m_dataset.PopulateFromFiles(vecFilenames);
+		ds->Refresh();
+		return strError;
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_dataset_load(
+	hyperion_dataset * ds,
+	const char * filename,
+	hyperion_format format
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return HYPERION_ERROR;
+	}
+	if (filename == NULL) {
+		return HyperionReturn(std::string("No filename given"));
+	}
+	if ((ds->m_dataset.GetFileCount() != 0) || (ds->m_vecVariableNames.size() != 0)) {
+		return HyperionReturn(std::string("An index can only be loaded into an empty dataset"));
+	}
+	return HyperionCall([&]() -> std::string {
+		std::string strError;
+		switch (format) {
+			case HYPERION_FORMAT_JSON:
+			case HYPERION_FORMAT_JSON_COMPACT:
+				strError = ds->m_dataset.FromJSONFile(filename);
+				break;
+			case HYPERION_FORMAT_CBOR:
+				strError = ds->m_dataset.FromBinaryFile(filename, BinaryIndexFormat_CBOR);
+				break;
+			case HYPERION_FORMAT_MSGPACK:
+				strError = ds->m_dataset.FromBinaryFile(filename, BinaryIndexFormat_MessagePack);
+				break;
+			default:
+				return std::string("Indexes cannot be loaded from this format");
+		}
+		ds->Refresh();
+		return strError;
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_dataset_save(
+	hyperion_dataset * ds,
+	const char * filename,
+	hyperion_format format
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return HYPERION_ERROR;
+	}
+	if (filename == NULL) {
+		return HyperionReturn(std::string("No filename given"));
+	}
+	return HyperionCall([&]() -> std::string {
+		switch (format) {
+			case HYPERION_FORMAT_JSON:
+				return ds->m_dataset.ToJSONFile(filename, true);
+			case HYPERION_FORMAT_JSON_COMPACT:
+				return ds->m_dataset.ToJSONFile(filename, false);
+			case HYPERION_FORMAT_CBOR:
+				return ds->m_dataset.ToBinaryFile(filename, BinaryIndexFormat_CBOR);
+			case HYPERION_FORMAT_MSGPACK:
+				return ds->m_dataset.ToBinaryFile(filename, BinaryIndexFormat_MessagePack);
+			case HYPERION_FORMAT_XML:
+				return ds->m_dataset.ToXMLFile(filename);
+			case HYPERION_FORMAT_MAPPED:
+				return ds->m_dataset.ToMappedIndexFile(filename);
+		}
+		return std::string("Unknown index format");
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_dataset_expand_summaries(
+	hyperion_dataset * ds
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return HYPERION_ERROR;
+	}
+	return HyperionCall([&]() -> std::string {
+		std::string strError = ds->m_dataset.LoadSummarizedValues();
+		ds->Refresh();
+		return strError;
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Files
+///////////////////////////////////////////////////////////////////////////////
+
+size_t hyperion_file_count(
+	const hyperion_dataset * ds
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return 0;
+	}
+	return ds->m_dataset.GetFileCount();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * hyperion_file_name(
+	const hyperion_dataset * ds,
+	size_t file_ix
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return NULL;
+	}
+	const FileInfo * pfileinfo = ds->m_dataset.GetFileInfo(file_ix);
+	if (pfileinfo == NULL) {
+		HyperionReturn(std::string("File index out of range"));
+		return NULL;
+	}
+	return pfileinfo->m_strFilename.c_str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t hyperion_file_axis_count(
+	const hyperion_dataset * ds,
+	size_t file_ix
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return 0;
+	}
+	const FileInfo * pfileinfo = ds->m_dataset.GetFileInfo(file_ix);
+	if (pfileinfo == NULL) {
+		HyperionReturn(std::string("File index out of range"));
+		return 0;
+	}
+	return pfileinfo->m_mapAxisSubAxis.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_file_axis(
+	const hyperion_dataset * ds,
+	size_t file_ix,
+	size_t ix,
+	const char ** axis,
+	const char ** subaxis_id
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return HYPERION_ERROR;
+	}
+	const FileInfo * pfileinfo = ds->m_dataset.GetFileInfo(file_ix);
+	if (pfileinfo == NULL) {
+		return HyperionReturn(std::string("File index out of range"));
+	}
+	if (ix >= pfileinfo->m_mapAxisSubAxis.size()) {
+		return HyperionReturn(std::string("Axis index out of range"));
+	}
+	AxisSubAxisMap::const_iterator iter =
+		std::next(pfileinfo->m_mapAxisSubAxis.begin(), ix);
+	if (axis != NULL) {
+		(*axis) = iter->first.c_str();
+	}
+	if (subaxis_id != NULL) {
+		(*subaxis_id) = iter->second.c_str();
+	}
+	return HYPERION_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Variables
+///////////////////////////////////////////////////////////////////////////////
+
+size_t hyperion_variable_count(
+	const hyperion_dataset * ds
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return 0;
+	}
+	return ds->m_vecVariableNames.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * hyperion_variable_name(
+	const hyperion_dataset * ds,
+	size_t var_ix
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return NULL;
+	}
+	if (var_ix >= ds->m_vecVariableNames.size()) {
+		HyperionReturn(std::string("Variable index out of range"));
+		return NULL;
+	}
+	return ds->m_vecVariableNames[var_ix].c_str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * hyperion_variable_units(
+	const hyperion_dataset * ds,
+	const char * var
+) {
+	const VariableInfo * pvarinfo = HyperionFindVariable(ds, var);
+	if (pvarinfo == NULL) {
+		return NULL;
+	}
+	return pvarinfo->m_strUnits.c_str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_variable_type(
+	const hyperion_dataset * ds,
+	const char * var
+) {
+	const VariableInfo * pvarinfo = HyperionFindVariable(ds, var);
+	if (pvarinfo == NULL) {
+		return HYPERION_ERROR;
+	}
+	return static_cast<int>(pvarinfo->m_nctype);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t hyperion_variable_dimension_list_count(
+	const hyperion_dataset * ds,
+	const char * var
+) {
+	const VariableInfo * pvarinfo = HyperionFindVariable(ds, var);
+	if (pvarinfo == NULL) {
+		return 0;
+	}
+	return pvarinfo->m_mapSubAxisToFileIdMaps.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t hyperion_variable_dimension_count(
+	const hyperion_dataset * ds,
+	const char * var,
+	size_t list_ix
+) {
+	const AxisNameVector * pvecAxisNames =
+		HyperionFindDimensionList(ds, var, list_ix);
+	if (pvecAxisNames == NULL) {
+		return 0;
+	}
+	return pvecAxisNames->size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * hyperion_variable_dimension(
+	const hyperion_dataset * ds,
+	const char * var,
+	size_t list_ix,
+	size_t dim_ix
+) {
+	const AxisNameVector * pvecAxisNames =
+		HyperionFindDimensionList(ds, var, list_ix);
+	if (pvecAxisNames == NULL) {
+		return NULL;
+	}
+	if (dim_ix >= pvecAxisNames->size()) {
+		HyperionReturn(std::string("Dimension index out of range"));
+		return NULL;
+	}
+	return (*pvecAxisNames)[dim_ix].c_str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Axes and subaxes
+///////////////////////////////////////////////////////////////////////////////
+
+size_t hyperion_axis_count(
+	const hyperion_dataset * ds
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return 0;
+	}
+	return ds->m_vecAxisNames.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * hyperion_axis_name(
+	const hyperion_dataset * ds,
+	size_t axis_ix
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return NULL;
+	}
+	if (axis_ix >= ds->m_vecAxisNames.size()) {
+		HyperionReturn(std::string("Axis index out of range"));
+		return NULL;
+	}
+	return ds->m_vecAxisNames[axis_ix].c_str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * hyperion_axis_units(
+	const hyperion_dataset * ds,
+	const char * axis
+) {
+	const AxisInfo * paxisinfo = HyperionFindAxis(ds, axis);
+	if (paxisinfo == NULL) {
+		return NULL;
+	}
+	return paxisinfo->m_strUnits.c_str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t hyperion_subaxis_count(
+	const hyperion_dataset * ds,
+	const char * axis
+) {
+	const AxisInfo * paxisinfo = HyperionFindAxis(ds, axis);
+	if (paxisinfo == NULL) {
+		return 0;
+	}
+	return paxisinfo->m_vecSubAxis.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * hyperion_subaxis_id(
+	const hyperion_dataset * ds,
+	const char * axis,
+	size_t subaxis_ix
+) {
+	const AxisInfo * paxisinfo = HyperionFindAxis(ds, axis);
+	if (paxisinfo == NULL) {
+		return NULL;
+	}
+	if (subaxis_ix >= paxisinfo->m_vecSubAxis.size()) {
+		HyperionReturn(std::string("Subaxis index out of range"));
+		return NULL;
+	}
+	return paxisinfo->m_vecSubAxis.key(subaxis_ix).c_str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t hyperion_subaxis_size(
+	const hyperion_dataset * ds,
+	const char * axis,
+	const char * subaxis_id
+) {
+	const SubAxis * psubaxis = HyperionFindSubAxis(ds, axis, subaxis_id);
+	if (psubaxis == NULL) {
+		return 0;
+	}
+	return static_cast<size_t>(psubaxis->m_lSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_subaxis_values(
+	const hyperion_dataset * ds,
+	const char * axis,
+	const char * subaxis_id,
+	const void ** values,
+	int * type,
+	size_t * count
+) {
+	const SubAxis * psubaxis = HyperionFindSubAxis(ds, axis, subaxis_id);
+	if (psubaxis == NULL) {
+		return HYPERION_ERROR;
+	}
+	if (psubaxis->m_fSummarized) {
+		return HyperionReturn(std::string("Values of subaxis \"") + subaxis_id
+			+ std::string("\" of axis \"") + axis + std::string("\" are summarized"));
+	}
+	if (values != NULL) {
+		(*values) = psubaxis->m_values.RawData();
+	}
+	if (type != NULL) {
+		(*type) = static_cast<int>(psubaxis->m_values.GetType());
+	}
+	if (count != NULL) {
+		(*count) = psubaxis->m_values.size();
+	}
+	return HYPERION_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Queries
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_dataset_query(
+	const hyperion_dataset * ds,
+	const char * var,
+	const char * ranges,
+	hyperion_query_result ** result
+) {
+	if (!HyperionCheckDataset(ds)) {
+		return HYPERION_ERROR;
+	}
+	if ((var == NULL) || (result == NULL)) {
+		return HyperionReturn(std::string("No variable or result given"));
+	}
+	(*result) = NULL;
+	if (ds->m_strQueryIndexError != "") {
+		return HyperionReturn(ds->m_strQueryIndexError);
+	}
+	return HyperionCall([&]() -> std::string {
+		std::vector<QueryAxisRange> vecRanges;
+		if ((ranges != NULL) && (ranges[0] != '\0')) {
+			std::string strError = QueryAxisRange::ListFromString(ranges, vecRanges);
+			if (strError != "") {
+				return strError;
+			}
+		}
+		hyperion_query_result * presult = new hyperion_query_result;
+		std::string strError = ds->m_dataset.Query(var, vecRanges, presult->m_vecResults);
+		if (strError != "") {
+			delete presult;
+			return strError;
+		}
+		(*result) = presult;
+		return std::string("");
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t hyperion_query_result_count(
+	const hyperion_query_result * result
+) {
+	if (result == NULL) {
+		return 0;
+	}
+	return result->m_vecResults.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t hyperion_query_result_file_index(
+	const hyperion_query_result * result,
+	size_t ix
+) {
+	const QueryFileRange * prange = HyperionFindQueryFile(result, ix);
+	if (prange == NULL) {
+		return 0;
+	}
+	return prange->m_sFileIx;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * hyperion_query_result_file_name(
+	const hyperion_query_result * result,
+	size_t ix
+) {
+	const QueryFileRange * prange = HyperionFindQueryFile(result, ix);
+	if (prange == NULL) {
+		return NULL;
+	}
+	return prange->m_strFilename.c_str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t hyperion_query_result_dimension_count(
+	const hyperion_query_result * result,
+	size_t ix
+) {
+	const QueryFileRange * prange = HyperionFindQueryFile(result, ix);
+	if (prange == NULL) {
+		return 0;
+	}
+	return prange->m_vecAxisNames.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int hyperion_query_result_range(
+	const hyperion_query_result * result,
+	size_t ix,
+	size_t dim_ix,
+	const char ** dimension,
+	long * start,
+	long * count
+) {
+	const QueryFileRange * prange = HyperionFindQueryFile(result, ix);
+	if (prange == NULL) {
+		return HYPERION_ERROR;
+	}
+	if (dim_ix >= prange->m_vecAxisNames.size()) {
+		return HyperionReturn(std::string("Dimension index out of range"));
+	}
+	if (dimension != NULL) {
+		(*dimension) = prange->m_vecAxisNames[dim_ix].c_str();
+	}
+	if (start != NULL) {
+		(*start) = prange->m_vecStart[dim_ix];
+	}
+	if (count != NULL) {
+		(*count) = prange->m_vecCount[dim_ix];
+	}
+	return HYPERION_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void hyperion_query_result_destroy(
+	hyperion_query_result * result
+) {
+	delete result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
@@ -0,0 +1,450 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    HyperionAPI.h
+///	\version October 15, 2026
+///
+
+#ifndef _HYPERIONAPI_H_
+#define _HYPERIONAPI_H_
+
+///////////////////////////////////////////////////////////////////////////////
+///
+///	A C interface to IndexedDataset, for use of libhyperionbase.so from
+///	other languages and from programs that index or query in process
+///	instead of running autocurator.
+///
+///	Functions that can fail return HYPERION_OK on success and
+///	HYPERION_ERROR otherwise, with a description of the error available
+///	from hyperion_last_error on the same thread.  Functions returning a
+///	pointer return NULL on failure.
+///
+///	Strings and arrays returned by a dataset are owned by the dataset.
+///	They remain valid until the dataset is next indexed, loaded or
+///	expanded, or is destroyed.  A dataset may be read from several
+///	threads at once, but must not be read while it is being modified.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Version of this interface, incremented when it changes
+///		incompatibly.
+///	</summary>
+#define HYPERION_API_VERSION 1
+
+///	<summary>
+///		Return codes.
+///	</summary>
+#define HYPERION_OK 0
+#define HYPERION_ERROR (-1)
+
+///	<summary>
+///		Formats in which a dataset is saved or loaded.  XML and mapped
+///		indexes can only be saved.
+///	</summary>
+typedef enum hyperion_format {
+	HYPERION_FORMAT_JSON = 0,
+	HYPERION_FORMAT_JSON_COMPACT = 1,
+	HYPERION_FORMAT_CBOR = 2,
+	HYPERION_FORMAT_MSGPACK = 3,
+	HYPERION_FORMAT_XML = 4,
+	HYPERION_FORMAT_MAPPED = 5
+} hyperion_format;
+
+///	<summary>
+///		An indexed dataset.
+///	</summary>
+typedef struct hyperion_dataset hyperion_dataset;
+
+///	<summary>
+///		The files and ranges of indices found by hyperion_dataset_query.
+///	</summary>
+typedef struct hyperion_query_result hyperion_query_result;
+
+///////////////////////////////////////////////////////////////////////////////
+// Library
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get HYPERION_API_VERSION of the library.
+///	</summary>
+int hyperion_api_version(void);
+
+///	<summary>
+///		Get a description of the last error on this thread.
+///	</summary>
+const char * hyperion_last_error(void);
+
+///	<summary>
+///		Set the stream to which progress is written, or NULL to discard
+///		it.  Progress is written to stdout by default.
+///	</summary>
+void hyperion_set_log(
+	FILE * fp
+);
+
+///	<summary>
+///		Set the verbosity of progress output.
+///	</summary>
+void hyperion_set_verbosity(
+	int level
+);
+
+///////////////////////////////////////////////////////////////////////////////
+// Dataset
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Create an empty dataset.
+///	</summary>
+hyperion_dataset * hyperion_dataset_create(
+	const char * name
+);
+
+///	<summary>
+///		Destroy a dataset.
+///	</summary>
+void hyperion_dataset_destroy(
+	hyperion_dataset * ds
+);
+
+///	<summary>
+///		Set the number of threads used to extract file headers.
+///	</summary>
+int hyperion_dataset_set_threads(
+	hyperion_dataset * ds,
+	size_t threads
+);
+
+///	<summary>
+///		Decode the headers of classic format files without the NetCDF
+///		library if enable is nonzero.
+///	</summary>
+int hyperion_dataset_set_native_headers(
+	hyperion_dataset * ds,
+	int enable
+);
+
+///	<summary>
+///		Record the statistics of the values of each variable as files
+///		are indexed if enable is nonzero.
+///	</summary>
+int hyperion_dataset_set_statistics(
+	hyperion_dataset * ds,
+	int enable
+);
+
+///	<summary>
+///		Index the files under a path, and under its subdirectories if
+///		recurse is nonzero, that match one of the comma-separated
+///		patterns and none of the excluded ones.  exclude may be NULL.
+///	</summary>
+int hyperion_dataset_index_path(
+	hyperion_dataset * ds,
+	const char * path,
+	const char * patterns,
+	int recurse,
+	const char * exclude
+);
+
+///	<summary>
+///		Index the files listed one per line in a file, or on standard
+///		input if file_list is "-".
+///	</summary>
+int hyperion_dataset_index_file_list(
+	hyperion_dataset * ds,
+	const char * file_list
+);
+
+///	<summary>
+///		Index an array of files.
+///	</summary>
+int hyperion_dataset_index_files(
+	hyperion_dataset * ds,
+	const char * const * files,
+	size_t count
+);
+
+///	<summary>
+///		Load an index into an empty dataset.
+///	</summary>
+int hyperion_dataset_load(
+	hyperion_dataset * ds,
+	const char * filename,
+	hyperion_format format
+);
+
+///	<summary>
+///		Save the dataset.  JSON is compressed if filename ends in ".gz"
+///		or ".zst".
+///	</summary>
+int hyperion_dataset_save(
+	hyperion_dataset * ds,
+	const char * filename,
+	hyperion_format format
+);
+
+///	<summary>
+///		Read the values of summarized subaxes from their source files, so
+///		that hyperion_subaxis_values can return them.
+///	</summary>
+int hyperion_dataset_expand_summaries(
+	hyperion_dataset * ds
+);
+
+///////////////////////////////////////////////////////////////////////////////
+// Files
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the number of files.
+///	</summary>
+size_t hyperion_file_count(
+	const hyperion_dataset * ds
+);
+
+///	<summary>
+///		Get the path of a file.
+///	</summary>
+const char * hyperion_file_name(
+	const hyperion_dataset * ds,
+	size_t file_ix
+);
+
+///	<summary>
+///		Get the number of axes of a file.
+///	</summary>
+size_t hyperion_file_axis_count(
+	const hyperion_dataset * ds,
+	size_t file_ix
+);
+
+///	<summary>
+///		Get an axis of a file and the id of its subaxis in that file.
+///	</summary>
+int hyperion_file_axis(
+	const hyperion_dataset * ds,
+	size_t file_ix,
+	size_t ix,
+	const char ** axis,
+	const char ** subaxis_id
+);
+
+///////////////////////////////////////////////////////////////////////////////
+// Variables
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the number of variables.
+///	</summary>
+size_t hyperion_variable_count(
+	const hyperion_dataset * ds
+);
+
+///	<summary>
+///		Get the name of a variable.
+///	</summary>
+const char * hyperion_variable_name(
+	const hyperion_dataset * ds,
+	size_t var_ix
+);
+
+///	<summary>
+///		Get the units of a variable.
+///	</summary>
+const char * hyperion_variable_units(
+	const hyperion_dataset * ds,
+	const char * var
+);
+
+///	<summary>
+///		Get the nc_type of a variable, or HYPERION_ERROR.
+///	</summary>
+int hyperion_variable_type(
+	const hyperion_dataset * ds,
+	const char * var
+);
+
+///	<summary>
+///		Get the number of distinct lists of dimensions of a variable
+///		across its files.
+///	</summary>
+size_t hyperion_variable_dimension_list_count(
+	const hyperion_dataset * ds,
+	const char * var
+);
+
+///	<summary>
+///		Get the number of dimensions in a list of dimensions of a
+///		variable.
+///	</summary>
+size_t hyperion_variable_dimension_count(
+	const hyperion_dataset * ds,
+	const char * var,
+	size_t list_ix
+);
+
+///	<summary>
+///		Get the name of a dimension in a list of dimensions of a
+///		variable.
+///	</summary>
+const char * hyperion_variable_dimension(
+	const hyperion_dataset * ds,
+	const char * var,
+	size_t list_ix,
+	size_t dim_ix
+);
+
+///////////////////////////////////////////////////////////////////////////////
+// Axes and subaxes
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the number of axes.
+///	</summary>
+size_t hyperion_axis_count(
+	const hyperion_dataset * ds
+);
+
+///	<summary>
+///		Get the name of an axis.
+///	</summary>
+const char * hyperion_axis_name(
+	const hyperion_dataset * ds,
+	size_t axis_ix
+);
+
+///	<summary>
+///		Get the units of an axis.
+///	</summary>
+const char * hyperion_axis_units(
+	const hyperion_dataset * ds,
+	const char * axis
+);
+
+///	<summary>
+///		Get the number of subaxes of an axis.
+///	</summary>
+size_t hyperion_subaxis_count(
+	const hyperion_dataset * ds,
+	const char * axis
+);
+
+///	<summary>
+///		Get the id of a subaxis of an axis.
+///	</summary>
+const char * hyperion_subaxis_id(
+	const hyperion_dataset * ds,
+	const char * axis,
+	size_t subaxis_ix
+);
+
+///	<summary>
+///		Get the length of a subaxis, or zero if there is no such subaxis.
+///	</summary>
+size_t hyperion_subaxis_size(
+	const hyperion_dataset * ds,
+	const char * axis,
+	const char * subaxis_id
+);
+
+///	<summary>
+///		Get the coordinate values of a subaxis without copying them, with
+///		their nc_type and number.  Fails if the subaxis is summarized; see
+///		hyperion_dataset_expand_summaries.
+///	</summary>
+int hyperion_subaxis_values(
+	const hyperion_dataset * ds,
+	const char * axis,
+	const char * subaxis_id,
+	const void ** values,
+	int * type,
+	size_t * count
+);
+
+///////////////////////////////////////////////////////////////////////////////
+// Queries
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Find the files holding a variable within ranges of coordinates,
+///		given as "axis=low,high" separated by semicolons; see the --query
+///		option of autocurator.  ranges may be NULL or empty to select
+///		every file.  The result is destroyed with
+///		hyperion_query_result_destroy.
+///	</summary>
+int hyperion_dataset_query(
+	const hyperion_dataset * ds,
+	const char * var,
+	const char * ranges,
+	hyperion_query_result ** result
+);
+
+///	<summary>
+///		Get the number of files in a query result.
+///	</summary>
+size_t hyperion_query_result_count(
+	const hyperion_query_result * result
+);
+
+///	<summary>
+///		Get the index of a file of a query result in its dataset.
+///	</summary>
+size_t hyperion_query_result_file_index(
+	const hyperion_query_result * result,
+	size_t ix
+);
+
+///	<summary>
+///		Get the path of a file of a query result.
+///	</summary>
+const char * hyperion_query_result_file_name(
+	const hyperion_query_result * result,
+	size_t ix
+);
+
+///	<summary>
+///		Get the number of dimensions of the variable in a file of a query
+///		result.
+///	</summary>
+size_t hyperion_query_result_dimension_count(
+	const hyperion_query_result * result,
+	size_t ix
+);
+
+///	<summary>
+///		Get a dimension of the variable in a file of a query result, and
+///		the start and length of the range of indices along it.
+///	</summary>
+int hyperion_query_result_range(
+	const hyperion_query_result * result,
+	size_t ix,
+	size_t dim_ix,
+	const char ** dimension,
+	long * start,
+	long * count
+);
+
+///	<summary>
+///		Destroy a query result.
+///	</summary>
+void hyperion_query_result_destroy(
+	hyperion_query_result * result
+);
+
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
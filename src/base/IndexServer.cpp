@@ -0,0 +1,539 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    IndexServer.cpp
+///	\version October 14, 2026
+///
+
+#include "IndexServer.h"
+#include "Announce.h"
+#include "Exception.h"
+#include "../contrib/json.hpp"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+const size_t IndexServer::MaxRequestBytes = 1 << 20;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Milliseconds between checks of the stop flag while waiting on a
+///		socket.
+///	</summary>
+static const int s_nPollTimeoutMs = 250;
+
+///	<summary>
+///		Flag set by SIGINT and SIGTERM.
+///	</summary>
+static volatile sig_atomic_t s_fStopSignal = 0;
+
+///	<summary>
+///		Handler of SIGINT and SIGTERM.
+///	</summary>
+static void IndexServerStopHandler(int) {
+	s_fStopSignal = 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexServer::Load() {
+	FileStamp stamp;
+	if (!stamp.FromFile(m_strIndexFile)) {
+		return std::string("Unable to stat index file \"")
+			+ m_strIndexFile + std::string("\"");
+	}
+
+	std::shared_ptr<IndexedDataset> pdataset(new IndexedDataset("file_list"));
+	try {
+		std::string strError;
+		if (m_eFormat == IndexServerFormat_JSON) {
+			strError = pdataset->FromJSONFile(m_strIndexFile);
+		} else if (m_eFormat == IndexServerFormat_CBOR) {
+			strError = pdataset->FromBinaryFile(m_strIndexFile, BinaryIndexFormat_CBOR);
+		} else {
+			strError = pdataset->FromBinaryFile(m_strIndexFile, BinaryIndexFormat_MessagePack);
+		}
+		if (strError == "") {
+			pdataset->BuildFileIdLookups();
+			strError = pdataset->BuildQueryIndex();
+		}
+		if (strError != "") {
+			return strError;
+		}
+
+	} catch(Exception & e) {
+		return e.ToString();
+	}
+
+	size_t sGeneration;
+	{
+		std::lock_guard<std::mutex> lock(m_mutexDataset);
+		m_pdataset = pdataset;
+		m_stamp = stamp;
+		sGeneration = ++m_sGeneration;
+	}
+
+	Announce("Loaded \"%s\" (generation %lu, %lu files)",
+		m_strIndexFile.c_str(), sGeneration, pdataset->GetFileCount());
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void IndexServer::WatchIndexFile() {
+	if (m_dReloadInterval <= 0.0) {
+		return;
+	}
+
+	const std::chrono::milliseconds msInterval(
+		static_cast<long long>(m_dReloadInterval * 1000.0));
+
+	// Only reload once the file is unchanged over a whole interval, so
+	// that a file still being written is not loaded
+	FileStamp stampPending;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutexStop);
+			m_condStop.wait_for(lock, msInterval, [this] { return m_fStop.load(); });
+			if (m_fStop.load()) {
+				return;
+			}
+		}
+
+		FileStamp stamp;
+		if (!stamp.FromFile(m_strIndexFile)) {
+			continue;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_mutexDataset);
+			if (stamp == m_stamp) {
+				stampPending = FileStamp();
+				continue;
+			}
+		}
+		if (!(stamp == stampPending)) {
+			stampPending = stamp;
+			continue;
+		}
+
+		std::string strError = Load();
+		if (strError != "") {
+			AnnounceWarning("Unable to reload \"%s\"; serving the previous"
+				" index: %s", m_strIndexFile.c_str(), strError.c_str());
+			std::lock_guard<std::mutex> lock(m_mutexDataset);
+			m_stamp = stamp;
+		}
+		stampPending = FileStamp();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexServer::HandleRequest(
+	const std::string & strRequest
+) const {
+	nlohmann::json jResponse;
+
+	nlohmann::json jRequest = nlohmann::json::parse(strRequest, nullptr, false);
+	if (jRequest.is_discarded() || !jRequest.is_object()) {
+		jResponse["error"] = "Request is not a JSON object";
+		return jResponse.dump();
+	}
+
+	nlohmann::json::const_iterator iterId = jRequest.find("id");
+	if (iterId != jRequest.end()) {
+		jResponse["id"] = *iterId;
+	}
+
+	nlohmann::json::const_iterator iterOp = jRequest.find("op");
+	if ((iterOp == jRequest.end()) || !iterOp->is_string()) {
+		jResponse["error"] = "Request has no \"op\"";
+		return jResponse.dump();
+	}
+	const std::string strOp = iterOp->get<std::string>();
+
+	std::shared_ptr<const IndexedDataset> pdataset = GetDataset();
+	if (pdataset == nullptr) {
+		jResponse["error"] = "No index is loaded";
+		return jResponse.dump();
+	}
+
+	// Liveness check
+	if (strOp == "ping") {
+		jResponse["ok"] = true;
+
+	// Summary of the index
+	} else if (strOp == "info") {
+		std::vector<std::string> vecVariableNames;
+		pdataset->GetVariableNames(vecVariableNames);
+		{
+			std::lock_guard<std::mutex> lock(m_mutexDataset);
+			jResponse["generation"] = m_sGeneration;
+		}
+		jResponse["index"] = m_strIndexFile;
+		jResponse["files"] = pdataset->GetFileCount();
+		jResponse["variables"] = vecVariableNames;
+
+	// Files and hyperslabs of a variable within coordinate ranges
+	} else if (strOp == "query") {
+		nlohmann::json::const_iterator iterVar = jRequest.find("var");
+		if ((iterVar == jRequest.end()) || !iterVar->is_string()) {
+			jResponse["error"] = "Query has no \"var\"";
+			return jResponse.dump();
+		}
+
+		std::vector<QueryAxisRange> vecRanges;
+		nlohmann::json::const_iterator iterQuery = jRequest.find("query");
+		if (iterQuery != jRequest.end()) {
+			if (!iterQuery->is_string()) {
+				jResponse["error"] = "Query \"query\" must be a string";
+				return jResponse.dump();
+			}
+			std::string strError =
+				QueryAxisRange::ListFromString(
+					iterQuery->get<std::string>(), vecRanges);
+			if (strError != "") {
+				jResponse["error"] = strError;
+				return jResponse.dump();
+			}
+		}
+
+		std::vector<QueryFileRange> vecResults;
+		std::string strError;
+		try {
+			strError =
+				pdataset->Query(
+					iterVar->get<std::string>(),
+					vecRanges,
+					vecResults);
+		} catch(Exception & e) {
+			strError = e.ToString();
+		}
+		if (strError != "") {
+			jResponse["error"] = strError;
+			return jResponse.dump();
+		}
+
+		nlohmann::json & jFiles = jResponse["files"];
+		jFiles = nlohmann::json::array();
+		for (size_t r = 0; r < vecResults.size(); r++) {
+			nlohmann::json jResult;
+			vecResults[r].ToJSON(jResult);
+			jFiles.push_back(jResult);
+		}
+
+	} else {
+		jResponse["error"] = std::string("Unknown op \"") + strOp + std::string("\"");
+	}
+
+	return jResponse.dump();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Send all of a buffer, returning false if the connection failed.
+///	</summary>
+static bool SendAll(
+	int fd,
+	const char * pData,
+	size_t sBytes
+) {
+	while (sBytes != 0) {
+		ssize_t sSent = send(fd, pData, sBytes, MSG_NOSIGNAL);
+		if (sSent < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		pData += sSent;
+		sBytes -= static_cast<size_t>(sSent);
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void IndexServer::ServeConnection(
+	int fdConnection
+) {
+	std::string strBuffer;
+	char szChunk[65536];
+
+	while (!m_fStop.load()) {
+		struct pollfd pfd;
+		pfd.fd = fdConnection;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		int nReady = poll(&pfd, 1, s_nPollTimeoutMs);
+		if (nReady < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+		if (nReady == 0) {
+			continue;
+		}
+
+		ssize_t sRead = recv(fdConnection, szChunk, sizeof(szChunk), 0);
+		if (sRead < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+		if (sRead == 0) {
+			break;
+		}
+		strBuffer.append(szChunk, static_cast<size_t>(sRead));
+
+		// Answer each complete line
+		bool fFailed = false;
+		size_t sLineBegin = 0;
+		for (;;) {
+			size_t sLineEnd = strBuffer.find('\n', sLineBegin);
+			if (sLineEnd == std::string::npos) {
+				break;
+			}
+			std::string strRequest =
+				strBuffer.substr(sLineBegin, sLineEnd - sLineBegin);
+			sLineBegin = sLineEnd + 1;
+			if ((strRequest.length() != 0) &&
+			    (strRequest[strRequest.length()-1] == '\r')
+			) {
+				strRequest.resize(strRequest.length()-1);
+			}
+			if (strRequest == "") {
+				continue;
+			}
+
+			std::string strResponse = HandleRequest(strRequest);
+			strResponse += '\n';
+			if (!SendAll(fdConnection, strResponse.c_str(), strResponse.length())) {
+				fFailed = true;
+				break;
+			}
+		}
+		if (fFailed) {
+			break;
+		}
+		strBuffer.erase(0, sLineBegin);
+
+		if (strBuffer.length() > MaxRequestBytes) {
+			std::string strResponse =
+				"{\"error\":\"Request exceeds the maximum length\"}\n";
+			SendAll(fdConnection, strResponse.c_str(), strResponse.length());
+			break;
+		}
+	}
+
+	close(fdConnection);
+	m_sConnections--;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Open a listening socket on a Unix socket path or TCP address.
+///		Returns an error message on failure.
+///	</summary>
+static std::string OpenListeningSocket(
+	const std::string & strAddress,
+	int & fdListen
+) {
+	fdListen = (-1);
+
+	// Unix socket, replacing any stale socket file
+	if (strAddress.find('/') != std::string::npos) {
+		struct sockaddr_un addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (strAddress.length() >= sizeof(addr.sun_path)) {
+			return std::string("Socket path \"") + strAddress
+				+ std::string("\" is too long");
+		}
+		strncpy(addr.sun_path, strAddress.c_str(), sizeof(addr.sun_path) - 1);
+
+		// Only replace an existing file if it is itself a socket
+		struct stat statPath;
+		if (lstat(strAddress.c_str(), &statPath) == 0) {
+			if (!S_ISSOCK(statPath.st_mode)) {
+				return std::string("\"") + strAddress
+					+ std::string("\" exists and is not a socket");
+			}
+			if (unlink(strAddress.c_str()) != 0) {
+				return std::string("Unable to remove stale socket \"")
+					+ strAddress + std::string("\": ") + strerror(errno);
+			}
+		}
+
+		fdListen = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fdListen < 0) {
+			return std::string("Unable to create socket: ") + strerror(errno);
+		}
+		if (bind(fdListen, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0) {
+			std::string strError =
+				std::string("Unable to bind \"") + strAddress
+				+ std::string("\": ") + strerror(errno);
+			close(fdListen);
+			fdListen = (-1);
+			return strError;
+		}
+
+	// TCP socket on [host:]port, with an IPv6 host written as [host]
+	} else {
+		std::string strHost;
+		std::string strPort = strAddress;
+		size_t sColon = strAddress.rfind(':');
+		if (sColon != std::string::npos) {
+			strHost = strAddress.substr(0, sColon);
+			strPort = strAddress.substr(sColon+1);
+		}
+		if ((strHost.length() >= 2) && (strHost[0] == '[')) {
+			if (strHost[strHost.length()-1] != ']') {
+				return std::string("Malformed address \"") + strAddress
+					+ std::string("\"");
+			}
+			strHost = strHost.substr(1, strHost.length()-2);
+		}
+
+		// Without a host only the loopback interface is bound; a
+		// wildcard host such as 0.0.0.0 or [::] must be given explicitly
+		struct addrinfo hints;
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+
+		struct addrinfo * paddrinfo = NULL;
+		int iStatus =
+			getaddrinfo(
+				(strHost != "")?(strHost.c_str()):(NULL),
+				strPort.c_str(),
+				&hints,
+				&paddrinfo);
+		if (iStatus != 0) {
+			return std::string("Unable to resolve \"") + strAddress
+				+ std::string("\": ") + gai_strerror(iStatus);
+		}
+
+		std::string strError;
+		for (struct addrinfo * p = paddrinfo; p != NULL; p = p->ai_next) {
+			fdListen = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+			if (fdListen < 0) {
+				continue;
+			}
+			int iReuse = 1;
+			setsockopt(fdListen, SOL_SOCKET, SO_REUSEADDR, &iReuse, sizeof(iReuse));
+			if (bind(fdListen, p->ai_addr, p->ai_addrlen) == 0) {
+				break;
+			}
+			strError = strerror(errno);
+			close(fdListen);
+			fdListen = (-1);
+		}
+		freeaddrinfo(paddrinfo);
+
+		if (fdListen < 0) {
+			return std::string("Unable to bind \"") + strAddress
+				+ std::string("\": ") + strError;
+		}
+	}
+
+	if (listen(fdListen, SOMAXCONN) != 0) {
+		std::string strError =
+			std::string("Unable to listen on \"") + strAddress
+			+ std::string("\": ") + strerror(errno);
+		close(fdListen);
+		fdListen = (-1);
+		return strError;
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexServer::Serve(
+	const std::string & strAddress
+) {
+	if (GetDataset() == nullptr) {
+		_EXCEPTIONT("Index must be loaded before serving");
+	}
+
+	int fdListen;
+	std::string strError = OpenListeningSocket(strAddress, fdListen);
+	if (strError != "") {
+		return strError;
+	}
+
+	s_fStopSignal = 0;
+	m_fStop = false;
+	void (*pfnPrevInt)(int) = signal(SIGINT, IndexServerStopHandler);
+	void (*pfnPrevTerm)(int) = signal(SIGTERM, IndexServerStopHandler);
+
+	std::thread threadWatch(&IndexServer::WatchIndexFile, this);
+
+	Announce("Serving on \"%s\"", strAddress.c_str());
+
+	while (!s_fStopSignal) {
+		struct pollfd pfd;
+		pfd.fd = fdListen;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		int nReady = poll(&pfd, 1, s_nPollTimeoutMs);
+		if (nReady <= 0) {
+			continue;
+		}
+
+		int fdConnection = accept(fdListen, NULL, NULL);
+		if (fdConnection < 0) {
+			continue;
+		}
+
+		m_sConnections++;
+		std::thread(&IndexServer::ServeConnection, this, fdConnection).detach();
+	}
+
+	Announce("Stopping server");
+
+	// Wake the watcher and let the connections finish
+	{
+		std::lock_guard<std::mutex> lock(m_mutexStop);
+		m_fStop = true;
+	}
+	m_condStop.notify_all();
+	threadWatch.join();
+
+	close(fdListen);
+	if (strAddress.find('/') != std::string::npos) {
+		unlink(strAddress.c_str());
+	}
+
+	while (m_sConnections.load() != 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(s_nPollTimeoutMs / 5));
+	}
+
+	signal(SIGINT, pfnPrevInt);
+	signal(SIGTERM, pfnPrevTerm);
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    IndexServer.h
+///	\version October 14, 2026
+///
+
+#ifndef _INDEXSERVER_H_
+#define _INDEXSERVER_H_
+
+#include "IndexedDataset.h"
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Formats of the index file loaded by an IndexServer.
+///	</summary>
+enum IndexServerFormat {
+	IndexServerFormat_JSON,
+	IndexServerFormat_CBOR,
+	IndexServerFormat_MessagePack
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Holds an IndexedDataset loaded from an index file and answers
+///		requests on a Unix or TCP socket, so that consumers do not each
+///		parse the index.  Requests and responses are single-line JSON
+///		objects:
+///
+///		  {"op":"query","var":"tas","query":"time=1950-01-01,1950-12-31"}
+///		  {"op":"info"}
+///		  {"op":"ping"}
+///
+///		A query is answered with {"files":[...]}, each file written by
+///		QueryFileRange::ToJSON, and any failure with {"error":"..."}.
+///		The "id" of a request, if any, is copied to its response.
+///
+///		Each connection is served on its own thread.  The index file is
+///		polled for changes and reloaded in the background; requests that
+///		arrive during a reload are answered from the previous index.
+///	</summary>
+class IndexServer {
+
+public:
+	///	<summary>
+	///		Longest request line accepted, in bytes.
+	///	</summary>
+	static const size_t MaxRequestBytes;
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	IndexServer(
+		const std::string & strIndexFile,
+		IndexServerFormat eFormat
+	) :
+		m_strIndexFile(strIndexFile),
+		m_eFormat(eFormat),
+		m_dReloadInterval(5.0),
+		m_sGeneration(0),
+		m_fStop(false),
+		m_sConnections(0)
+	{ }
+
+	///	<summary>
+	///		Set the seconds between checks of the index file for changes,
+	///		or zero to never reload.
+	///	</summary>
+	void SetReloadInterval(
+		double dReloadInterval
+	) {
+		m_dReloadInterval = dReloadInterval;
+	}
+
+	///	<summary>
+	///		Load the index file.  Returns an error message if it cannot
+	///		be loaded, in which case any previous index is kept.
+	///	</summary>
+	std::string Load();
+
+	///	<summary>
+	///		Serve requests on the given address until SIGINT or SIGTERM is
+	///		received.  An address containing a '/' is the path of a Unix
+	///		socket; any other address is a TCP port, optionally preceded
+	///		by a host and a colon, with IPv6 hosts in brackets.  A port
+	///		alone listens on loopback only.  Returns an error message if
+	///		the socket cannot be opened.
+	///	</summary>
+	std::string Serve(
+		const std::string & strAddress
+	);
+
+	///	<summary>
+	///		Answer one request line.
+	///	</summary>
+	std::string HandleRequest(
+		const std::string & strRequest
+	) const;
+
+protected:
+	///	<summary>
+	///		Get the current index.
+	///	</summary>
+	std::shared_ptr<const IndexedDataset> GetDataset() const {
+		std::lock_guard<std::mutex> lock(m_mutexDataset);
+		return m_pdataset;
+	}
+
+	///	<summary>
+	///		Reload the index file whenever it changes, until stopped.
+	///	</summary>
+	void WatchIndexFile();
+
+	///	<summary>
+	///		Answer the requests of one connection until it is closed.
+	///	</summary>
+	void ServeConnection(
+		int fdConnection
+	);
+
+protected:
+	///	<summary>
+	///		Path of the index file.
+	///	</summary>
+	std::string m_strIndexFile;
+
+	///	<summary>
+	///		Format of the index file.
+	///	</summary>
+	IndexServerFormat m_eFormat;
+
+	///	<summary>
+	///		Seconds between checks of the index file.
+	///	</summary>
+	double m_dReloadInterval;
+
+	///	<summary>
+	///		Mutex guarding m_pdataset, m_stamp and m_sGeneration.
+	///	</summary>
+	mutable std::mutex m_mutexDataset;
+
+	///	<summary>
+	///		The current index.
+	///	</summary>
+	std::shared_ptr<const IndexedDataset> m_pdataset;
+
+	///	<summary>
+	///		Stamp of the index file when it was loaded.
+	///	</summary>
+	FileStamp m_stamp;
+
+	///	<summary>
+	///		Number of times the index has been loaded.
+	///	</summary>
+	size_t m_sGeneration;
+
+	///	<summary>
+	///		Mutex and condition used to wake the watcher when stopping.
+	///	</summary>
+	std::mutex m_mutexStop;
+	std::condition_variable m_condStop;
+
+	///	<summary>
+	///		Flag indicating the server is stopping.
+	///	</summary>
+	std::atomic<bool> m_fStop;
+
+	///	<summary>
+	///		Number of open connections.
+	///	</summary>
+	std::atomic<size_t> m_sConnections;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
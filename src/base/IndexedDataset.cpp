@@ -10,14 +10,42 @@
 #include "DataArray2D.h"
 #include "netcdfcpp.h"
 #include "NetCDFUtilities.h"
+#include "NcFilePool.h"
+#include "Profiler.h"
+#include "MappedIndex.h"
+#include "DirectoryWalker.h"
+#include "ArrayCompare.h"
+#include "NumberFormat.h"
+#include "CFTimeUnits.h"
+#include "CompressedStream.h"
+#include "RemoteFile.h"
+#include "GridRegistry.h"
+#include "FileInfoSpill.h"
+#include "ChunkReferences.h"
 #include "../contrib/tinyxml2.h"
 #include "../contrib/json.hpp"
 
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cmath>
+#include <climits>
+#include <limits>
+#include <algorithm>
+#include <deque>
 #include <fstream>
+#include <iostream>
 #include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <functional>
 
 #if defined(HYPERION_MPIOMP)
 #include <mpi.h>
@@ -27,34 +55,52 @@
 // DataObjectInfo
 ///////////////////////////////////////////////////////////////////////////////
 
+void DataObjectInfo::InsertFileAttribute(
+	const std::string & strAttName,
+	const std::string & strValue
+) {
+	InternedString strAttValue(strValue);
+
+	// Define new value of this attribute
+	std::string strAttNameTemp = strAttName;
+	STLStringHelper::ToLower(strAttNameTemp);
+
+	if ((strAttNameTemp == "conventions") ||
+	    (strAttNameTemp == "version") ||
+	    (strAttNameTemp == "history") || 
+	    (strAttNameTemp == "tracking_id") 
+	) {
+		m_mapKeyAttributes.insert(
+			AttributeMap::value_type(
+				strAttName, strAttValue));
+	} else {
+		m_mapOtherAttributes.insert(
+			AttributeMap::value_type(
+				strAttName, strAttValue));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 std::string DataObjectInfo::FromNcFile(
 	NcFile * ncfile
 ) {
 	// Get attributes, if available
+	const int ncid = ncfile->id();
+	char szAttName[NC_MAX_NAME+1];
+	std::string strValue;
 	for (int a = 0; a < ncfile->num_atts(); a++) {
-		NcAtt * att = ncfile->get_att(a);
-		std::string strAttName = att->name();
+		if (!GetNcAttName(ncid, NC_GLOBAL, a, szAttName)) {
+			continue;
+		}
+		std::string strAttName(szAttName);
 		if (strAttName == "units") {
 			continue;
 		}
-
-		// Define new value of this attribute
-		std::string strAttNameTemp = strAttName;
-		STLStringHelper::ToLower(strAttNameTemp);
-
-		if ((strAttNameTemp == "conventions") ||
-		    (strAttNameTemp == "version") ||
-		    (strAttNameTemp == "history") || 
-		    (strAttNameTemp == "tracking_id") 
-		) {
-			m_mapKeyAttributes.insert(
-				AttributeMap::value_type(
-					strAttName, att->as_string(0)));
-		} else {
-			m_mapOtherAttributes.insert(
-				AttributeMap::value_type(
-					strAttName, att->as_string(0)));
+		if (!GetNcAttAsString(ncid, NC_GLOBAL, szAttName, strValue)) {
+			continue;
 		}
+		InsertFileAttribute(strAttName, strValue);
 /*
 		// Check for consistency across files
 		} else {
@@ -93,12 +139,40 @@ std::string DataObjectInfo::FromNcFile(
 
 ///////////////////////////////////////////////////////////////////////////////
 
+///	<summary>
+///		Check if an attribute of a variable or axis is a key attribute.
+///	</summary>
+static bool IsKeyVariableAttribute(
+	const std::string & strAttName
+) {
+	return (strAttName == "missing_value")
+		|| (strAttName == "comments")
+		|| (strAttName == "long_name")
+		|| (strAttName == "grid_name")
+		|| (strAttName == "grid_type");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 std::string DataObjectInfo::FromNcVar(
+	NcFile * ncfile,
 	NcVar * var,
 	bool fCheckConsistency
+) {
+	VariableHeader varheader;
+	varheader.FromNcVar(ncfile, var);
+
+	return FromVariableHeader(varheader, fCheckConsistency);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string DataObjectInfo::FromVariableHeader(
+	const VariableHeader & varheader,
+	bool fCheckConsistency
 ) {
 	// Get name, if available
-	std::string strName = var->name();
+	const std::string & strName = varheader.m_strName;
 	if (!fCheckConsistency) {
 		m_strName = strName;
 	} else if (strName != m_strName) {
@@ -108,7 +182,7 @@ std::string DataObjectInfo::FromNcVar(
 	}
 
 	// Get type, if available
-	NcType nctype = var->type();
+	NcType nctype = varheader.m_nctype;
 	if (!fCheckConsistency) {
 		m_nctype = nctype;
 	} else if (nctype != m_nctype) {
@@ -117,11 +191,7 @@ std::string DataObjectInfo::FromNcVar(
 	}
 
 	// Get units, if available
-	std::string strUnits;
-	NcAtt * attUnits = var->get_att("units");
-	if (attUnits != NULL) {
-		strUnits = attUnits->as_string(0);
-	}
+	const std::string & strUnits = varheader.m_strUnits;
 	if (!fCheckConsistency) {
 		m_strUnits = strUnits;
 	} else if (strUnits != m_strUnits) {
@@ -130,28 +200,20 @@ std::string DataObjectInfo::FromNcVar(
 	}
 
 	// Get attributes, if available
-	for (int a = 0; a < var->num_atts(); a++) {
-		NcAtt * att = var->get_att(a);
-		std::string strAttName = att->name();
-		if (strAttName == "units") {
-			continue;
-		}
+	for (size_t a = 0; a < varheader.m_vecAttributes.size(); a++) {
+		const InternedString & strAttName = varheader.m_vecAttributes[a].first;
+		const InternedString & strAttValue = varheader.m_vecAttributes[a].second;
 
 		// Define new value of this attribute
 		if (!fCheckConsistency) {
-			if ((strAttName == "missing_value") ||
-			    (strAttName == "comments") ||
-			    (strAttName == "long_name") ||
-			    (strAttName == "grid_name") ||
-			    (strAttName == "grid_type")
-			) {
+			if (IsKeyVariableAttribute(strAttName)) {
 				m_mapKeyAttributes.insert(
 					AttributeMap::value_type(
-						strAttName, att->as_string(0)));
+						strAttName, strAttValue));
 			} else {
 				m_mapOtherAttributes.insert(
 					AttributeMap::value_type(
-						strAttName, att->as_string(0)));
+						strAttName, strAttValue));
 			}
 
 		// Check for consistency across files
@@ -162,15 +224,15 @@ std::string DataObjectInfo::FromNcVar(
 				m_mapOtherAttributes.find(strAttName);
 
 			if (iterAttKey != m_mapKeyAttributes.end()) {
-				if (iterAttKey->second != att->as_string(0)) {
-					Announce("WARNING: Variable \"%s\" has inconsistent "
+				if (iterAttKey->second != strAttValue) {
+					AnnounceWarning("Variable \"%s\" has inconsistent "
 						"value of attribute \"%s\" across files",
 						strName.c_str(), strAttName.c_str());
 				}
 			}
 			if (iterAttOther != m_mapOtherAttributes.end()) {
-				if (iterAttOther->second != att->as_string(0)) {
-					Announce("WARNING: Variable \"%s\" has inconsistent "
+				if (iterAttOther->second != strAttValue) {
+					AnnounceWarning("Variable \"%s\" has inconsistent "
 						"value of attribute \"%s\" across files",
 						strName.c_str(), strAttName.c_str());
 				}
@@ -178,7 +240,7 @@ std::string DataObjectInfo::FromNcVar(
 			if ((iterAttKey == m_mapKeyAttributes.end()) &&
 			    (iterAttOther == m_mapOtherAttributes.end())
 			) {
-				Announce("WARNING: Variable \"%s\" has inconsistent "
+				AnnounceWarning("Variable \"%s\" has inconsistent "
 					"appearance of attribute \"%s\" across files",
 					strName.c_str(), strAttName.c_str());
 			}
@@ -195,7 +257,9 @@ void DataObjectInfo::InsertAttribute(
 	const std::string & strValue
 ) {
 	bool fSuccess;
-	if (m_setKeyAttributeNames.find(strKey) != m_setKeyAttributeNames.end()) {
+	if ((m_setKeyAttributeNames.find(strKey) != m_setKeyAttributeNames.end()) ||
+	    IsKeyVariableAttribute(strKey)
+	) {
 		fSuccess =
 			m_mapKeyAttributes.insert(
 				AttributeMap::value_type(strKey, strValue)).second;
@@ -225,48 +289,160 @@ void DataObjectInfo::RemoveRedundantOtherAttributes(
 // SubAxis
 ///////////////////////////////////////////////////////////////////////////////
 
-std::string SubAxis::ValuesToString() const {
-	std::ostringstream ssText;
+///	<summary>
+///		Write values as a Python list, formatting them a buffer at a
+///		time.
+///	</summary>
+template <typename T>
+static void ValuesToStreamBuffered(
+	std::ostream & os,
+	const T * pValues,
+	size_t sCount
+) {
+	typedef typename NcValueTraits<T>::Promoted Promoted;
 
-	// No type
-	if (m_nctype == ncNoType) {
-		return std::string("[ ]");
+	char szBuffer[4096];
+	char * pEnd = szBuffer + sizeof(szBuffer);
 
-	// Double type
-	} else if (m_nctype == ncDouble) {
-		ssText << std::setprecision(17);
-		ssText << "[";
-		for (int i = 0; i < m_dValuesDouble.size(); i++) {
-			ssText << m_dValuesDouble[i];
-			if (i != m_dValuesDouble.size()-1) {
-				ssText << " ";
-			}
+	char * p = szBuffer;
+	*(p++) = '[';
+	for (size_t i = 0; i < sCount; i++) {
+		if (pEnd - p < static_cast<ptrdiff_t>(NumberFormatMaxChars + 2)) {
+			os.write(szBuffer, p - szBuffer);
+			p = szBuffer;
 		}
-		ssText << "]";
+		if (i != 0) {
+			*(p++) = ' ';
+		}
+		p = FormatNumber(p, static_cast<Promoted>(pValues[i]));
+	}
+	*(p++) = ']';
+	os.write(szBuffer, p - szBuffer);
+}
 
-	// Float type
-	} else if (m_nctype == ncFloat) {
-		ssText << std::setprecision(8);
-		ssText << "[";
-		for (int i = 0; i < m_dValuesFloat.size(); i++) {
-			ssText << m_dValuesFloat[i];
-			if (i != m_dValuesFloat.size()-1) {
-				ssText << " ";
-			}
+///	<summary>
+///		Kernel writing values as a Python list.
+///	</summary>
+struct ValuesToStreamKernel {
+	std::ostream & os;
+	const TypedValueArray & values;
+
+	template <typename T>
+	void Apply() {
+		ValuesToStreamBuffered(os, values.Data<T>(), values.size());
+	}
+};
+
+///	<summary>
+///		Kernel appending values to a JSON array.
+///	</summary>
+struct ValuesToJSONKernel {
+	nlohmann::json & jv;
+	const TypedValueArray & values;
+
+	template <typename T>
+	void Apply() {
+		typedef typename NcValueTraits<T>::Promoted Promoted;
+		const T * pValues = values.Data<T>();
+		for (size_t i = 0; i < values.size(); i++) {
+			jv.push_back(static_cast<Promoted>(pValues[i]));
+		}
+	}
+};
+
+///	<summary>
+///		Kernel reading values from a JSON array.
+///	</summary>
+struct ValuesFromJSONKernel {
+	TypedValueArray & values;
+	const nlohmann::json & jv;
+
+	template <typename T>
+	void Apply() {
+		values.Resize(NcValueTraits<T>::Type, jv.size());
+		T * pValues = values.Data<T>();
+		for (size_t i = 0; i < jv.size(); i++) {
+			pValues[i] = jv[i].get<T>();
 		}
-		ssText << "]";
+	}
+};
+
+///	<summary>
+///		Kernel converting values from doubles.
+///	</summary>
+struct ValuesFromDoublesKernel {
+	TypedValueArray & values;
+	const std::vector<double> & dValues;
+
+	template <typename T>
+	void Apply() {
+		values.Resize(NcValueTraits<T>::Type, dValues.size());
+		T * pValues = values.Data<T>();
+		for (size_t i = 0; i < dValues.size(); i++) {
+			pValues[i] = static_cast<T>(dValues[i]);
+		}
+	}
+};
+
+///	<summary>
+///		Kernel converting values to doubles.
+///	</summary>
+struct ValuesToDoublesKernel {
+	const TypedValueArray & values;
+	std::vector<double> & dValues;
+
+	template <typename T>
+	void Apply() {
+		const T * pValues = values.Data<T>();
+		dValues.assign(pValues, pValues + values.size());
+	}
+};
+
+///	<summary>
+///		Kernel adding values to a SubAxisSummary.
+///	</summary>
+struct ValuesSummaryKernel {
+	SubAxisSummary & summary;
+	const TypedValueArray & values;
+
+	template <typename T>
+	void Apply() {
+		summary.Add(values.Data<T>(), values.size());
+	}
+};
 
-	} else {
+///////////////////////////////////////////////////////////////////////////////
+
+void SubAxis::ValuesToStream(
+	std::ostream & os
+) const {
+
+	// No type
+	if (m_nctype == ncNoType) {
+		os << "[ ]";
+		return;
+	}
+
+	ValuesToStreamKernel kernel = {os, m_values};
+	if (!DispatchNumericNcType(m_nctype, kernel)) {
 		_EXCEPTIONT("Invalid type");
 	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
 
+std::string SubAxis::ValuesToString() const {
+	std::ostringstream ssText;
+	ValuesToStream(ssText);
 	return ssText.str();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void SubAxis::ToJSON(
-	nlohmann::json & j
+	nlohmann::json & j,
+	bool fIncludeValues,
+	const GridRegistry * pgridregistry
 ) const {
 
 	// Datatype
@@ -275,33 +451,74 @@ void SubAxis::ToJSON(
 	// Size
 	j["size"] = m_lSize;
 
+	// Fingerprint of the values
+	const bool fTyped = IsNumericNcType(m_nctype);
+	unsigned long long ullFingerprint = 0;
+	char szFingerprint[32];
+	if (fTyped) {
+		ullFingerprint = GetContentFingerprint();
+		snprintf(szFingerprint, sizeof(szFingerprint), "%016llx", ullFingerprint);
+		j["fingerprint"] = szFingerprint;
+	}
+
 	// No type
 	if (m_nctype == ncNoType) {
 
-	// Int type
-	} else if (m_nctype == ncInt) {
-		nlohmann::json & jv = j["values"];
-		for (size_t i = 0; i < m_dValuesInt.size(); i++) {
-			jv.push_back(m_dValuesInt[i]);
+	// Summary in place of the values
+	} else if (m_fSummarized) {
+		nlohmann::json & js = j["summary"];
+		m_summary.ToJSON(js);
+		js["source"] = m_strSourceFile;
+
+	// Arithmetic progression in place of the values
+	} else if (m_fLinear) {
+		nlohmann::json & jr = j["range"];
+		if (IsIntegerNcType(m_nctype)) {
+			jr["start"] = static_cast<long long>(m_dLinearStart);
+			jr["step"] = static_cast<long long>(m_dLinearStep);
+		} else {
+			jr["start"] = m_dLinearStart;
+			jr["step"] = m_dLinearStep;
 		}
 
-	// Float type
-	} else if (m_nctype == ncFloat) {
-		nlohmann::json & jv = j["values"];
-		for (size_t i = 0; i < m_dValuesFloat.size(); i++) {
-			jv.push_back(m_dValuesFloat[i]);
-		}
+	// Reference to a registered grid in place of the values
+	} else if (fTyped &&
+	           (pgridregistry != NULL) &&
+	           (pgridregistry->Find(ullFingerprint) != NULL)
+	) {
+		j["grid"] = szFingerprint;
 
-	// Double type
-	} else if (m_nctype == ncDouble) {
-		nlohmann::json & jv = j["values"];
-		for (size_t i = 0; i < m_dValuesDouble.size(); i++) {
-			jv.push_back(m_dValuesDouble[i]);
+	// Values left out
+	} else if (!fIncludeValues) {
+		if (!fTyped) {
+			_EXCEPTIONT("Invalid type");
 		}
 
+	// Values
 	} else {
-		_EXCEPTIONT("Invalid type");
+		ValuesToJSONKernel kernel = {j["values"], m_values};
+		if (!DispatchNumericNcType(m_nctype, kernel)) {
+			_EXCEPTIONT("Invalid type");
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Parse the "hash" member of a summary.
+///	</summary>
+static bool SummaryHashFromString(
+	const std::string & strHash,
+	unsigned long long & ullHash
+) {
+	if ((strHash.length() == 0) || (strHash.length() > 16) ||
+	    (strHash.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+	) {
+		return false;
 	}
+	ullHash = strtoull(strHash.c_str(), NULL, 16);
+	return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -330,6 +547,86 @@ void SubAxis::FromJSON(
 	}
 	m_lSize = iters.value();
 
+	// Units (optional)
+	nlohmann::json::iterator iteru = j.find("units");
+	if (iteru != j.end()) {
+		if (!iteru.value().is_string()) {
+			_EXCEPTION1("JSON subaxis \"%s\" \"units\" must be type string", strKey.c_str());
+		}
+		m_strUnits = iteru.value();
+	}
+
+	// Summary (optional)
+	nlohmann::json::iterator iterss = j.find("summary");
+	if (iterss != j.end()) {
+		nlohmann::json & js = *iterss;
+		if (!js.is_object()) {
+			_EXCEPTION1("JSON subaxis \"%s\" \"summary\" must be type object", strKey.c_str());
+		}
+		m_fSummarized = true;
+		m_summary = SubAxisSummary();
+		m_summary.m_sCount = static_cast<size_t>(m_lSize);
+		m_summary.m_dMin = std::numeric_limits<double>::infinity();
+		m_summary.m_dMax = -std::numeric_limits<double>::infinity();
+		const char * szMembers[4] = {"min", "max", "first", "last"};
+		double * pdMembers[4] = {
+			&(m_summary.m_dMin), &(m_summary.m_dMax),
+			&(m_summary.m_dFirst), &(m_summary.m_dLast)};
+		for (int m = 0; m < 4; m++) {
+			nlohmann::json::iterator iterm = js.find(szMembers[m]);
+			if (iterm == js.end()) {
+				continue;
+			}
+			if (iterm->is_null()) {
+				*(pdMembers[m]) = std::numeric_limits<double>::quiet_NaN();
+			} else if (iterm->is_number()) {
+				*(pdMembers[m]) = iterm->get<double>();
+			} else {
+				_EXCEPTION2("JSON subaxis \"%s\" summary \"%s\" must be type number",
+					strKey.c_str(), szMembers[m]);
+			}
+		}
+		nlohmann::json::iterator iterh = js.find("hash");
+		if ((iterh == js.end()) || !iterh->is_string() ||
+		    !SummaryHashFromString(iterh->get<std::string>(), m_summary.m_ullHash)
+		) {
+			_EXCEPTION1("JSON subaxis \"%s\" summary missing valid \"hash\"", strKey.c_str());
+		}
+		nlohmann::json::iterator itersrc = js.find("source");
+		if ((itersrc != js.end()) && itersrc->is_string()) {
+			m_strSourceFile = itersrc->get<std::string>();
+		}
+		if (j.find("values") != j.end()) {
+			_EXCEPTION1("JSON subaxis \"%s\" specifies both \"values\" and \"summary\"", strKey.c_str());
+		}
+	}
+
+	// Arithmetic progression (optional)
+	nlohmann::json::iterator iterr = j.find("range");
+	if (iterr != j.end()) {
+		nlohmann::json & jr = *iterr;
+		if (!jr.is_object()) {
+			_EXCEPTION1("JSON subaxis \"%s\" \"range\" must be type object", strKey.c_str());
+		}
+		if (m_fSummarized || (j.find("values") != j.end())) {
+			_EXCEPTION1("JSON subaxis \"%s\" specifies \"range\" with \"values\" or \"summary\"", strKey.c_str());
+		}
+		nlohmann::json::iterator iterstart = jr.find("start");
+		nlohmann::json::iterator iterstep = jr.find("step");
+		if ((iterstart == jr.end()) || !iterstart->is_number() ||
+		    (iterstep == jr.end()) || !iterstep->is_number()
+		) {
+			_EXCEPTION1("JSON subaxis \"%s\" \"range\" requires numbers \"start\" and \"step\"", strKey.c_str());
+		}
+		if (!IsNumericNcType(m_nctype)) {
+			_EXCEPTION1("JSON subaxis \"%s\" \"range\" unsupported type, expected a numeric type", strKey.c_str());
+		}
+		if (m_lSize < 0) {
+			_EXCEPTION1("JSON subaxis \"%s\" \"size\" must be non-negative", strKey.c_str());
+		}
+		ExpandLinear(iterstart->get<double>(), iterstep->get<double>());
+	}
+
 	// Values (optional)
 	nlohmann::json::iterator iterv = j.find("values");
 	if (iterv != j.end()) {
@@ -337,30 +634,69 @@ void SubAxis::FromJSON(
 		if (!jv.is_array()) {
 			_EXCEPTION1("JSON subaxis \"%s\" \"values\" must be type array", strKey.c_str());
 		}
-		if (m_nctype == ncInt) {
-			m_dValuesInt.resize(jv.size());
-			for (size_t i = 0; i < jv.size(); i++) {
-				m_dValuesInt[i] = jv[i];
-			}
+		ValuesFromJSONKernel kernel = {m_values, jv};
+		if (!DispatchNumericNcType(m_nctype, kernel)) {
+			_EXCEPTION1("JSON subaxis \"%s\" \"values\" unsupported type, expected a numeric type", strKey.c_str());
+		}
+		DetectLinear();
+	}
+}
 
-		} else if (m_nctype == ncFloat) {
-			m_dValuesFloat.resize(jv.size());
-			for (size_t i = 0; i < jv.size(); i++) {
-				m_dValuesFloat[i] = jv[i];
-			}
+///////////////////////////////////////////////////////////////////////////////
 
-		} else if (m_nctype == ncDouble) {
-			m_dValuesDouble.resize(jv.size());
-			for (size_t i = 0; i < jv.size(); i++) {
-				m_dValuesDouble[i] = jv[i];
-			}
+///	<summary>
+///		Compare arrays of integers, which are equal only if identical.
+///	</summary>
+template <typename T>
+static bool ValuesEqual(
+	const T * a,
+	const T * b,
+	size_t n
+) {
+	return (n == 0) || (memcmp(a, b, n * sizeof(T)) == 0);
+}
 
-		} else {
-			_EXCEPTION1("JSON subaxis \"%s\" \"values\" unsupported type, expected [\"Int\", \"Float\", \"Double\"]", strKey.c_str());
-		}
-	}
+static bool ValuesEqual(
+	const int * a,
+	const int * b,
+	size_t n
+) {
+	return fpa::equal_n(a, b, n);
 }
 
+///	<summary>
+///		Compare arrays of floating point values with a tolerance.
+///	</summary>
+static bool ValuesEqual(
+	const float * a,
+	const float * b,
+	size_t n
+) {
+	return fpa::almost_equal_n(a, b, n);
+}
+
+static bool ValuesEqual(
+	const double * a,
+	const double * b,
+	size_t n
+) {
+	return fpa::almost_equal_n(a, b, n);
+}
+
+///	<summary>
+///		Kernel comparing two arrays of values of the same length.
+///	</summary>
+struct ValuesEqualKernel {
+	const TypedValueArray & a;
+	const TypedValueArray & b;
+	bool fEqual;
+
+	template <typename T>
+	void Apply() {
+		fEqual = ValuesEqual(a.Data<T>(), b.Data<T>(), a.size());
+	}
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 bool SubAxis::operator==(const SubAxis & dimrange) const {
@@ -370,1192 +706,11258 @@ bool SubAxis::operator==(const SubAxis & dimrange) const {
 		return false;
 	}
 
+	// Values in different units are different coordinates
+	if (dimrange.m_strUnits != m_strUnits) {
+		return false;
+	}
+
 	// No type
 	if (m_nctype == ncNoType) {
 		return true;
 
-	// Dimension values stored as ints
-	} else if (m_nctype == ncInt) {
-		if (dimrange.m_dValuesInt.size() != m_dValuesInt.size()) {
-			return false;
-		}
-		for (size_t s = 0; s < m_dValuesInt.size(); s++) {
-			if (dimrange.m_dValuesInt[s] != m_dValuesInt[s]) {
-				return false;
-			}
-		}
+	// Summarized values
+	} else if (m_fSummarized || dimrange.m_fSummarized) {
+		return (
+			m_fSummarized &&
+			dimrange.m_fSummarized &&
+			(m_lSize == dimrange.m_lSize) &&
+			(m_summary == dimrange.m_summary));
+
+	// Arithmetic progressions with the same closed form have the same
+	// values; other progressions are compared value by value
+	} else if (
+		m_fLinear &&
+		dimrange.m_fLinear &&
+		(m_lSize == dimrange.m_lSize) &&
+		(m_dLinearStart == dimrange.m_dLinearStart) &&
+		(m_dLinearStep == dimrange.m_dLinearStep)
+	) {
+		return true;
 
-	// Dimension values stored as doubles
-	} else if (m_nctype == ncDouble) {
-		if (dimrange.m_dValuesDouble.size() != m_dValuesDouble.size()) {
-			return false;
+	// Dimension values of different lengths
+	} else if (dimrange.m_values.size() != m_values.size()) {
+		return false;
+	}
+
+	ValuesEqualKernel kernel = {dimrange.m_values, m_values, false};
+	if (!DispatchNumericNcType(m_nctype, kernel)) {
+		_EXCEPTIONT("Unhandled type");
+	}
+	return kernel.fEqual;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Combine a value into a running fingerprint.
+///	</summary>
+static inline size_t FingerprintCombine(
+	size_t sFingerprint,
+	unsigned long long ullValue
+) {
+	unsigned long long ull = ullValue + 0x9e3779b97f4a7c15ULL
+		+ (static_cast<unsigned long long>(sFingerprint) << 6)
+		+ (static_cast<unsigned long long>(sFingerprint) >> 2);
+	ull ^= (ull >> 30);
+	ull *= 0xbf58476d1ce4e5b9ULL;
+	ull ^= (ull >> 27);
+	ull *= 0x94d049bb133111ebULL;
+	ull ^= (ull >> 31);
+	return static_cast<size_t>(sFingerprint ^ ull);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Quantize the bit pattern of a floating point value to a bucket of
+///		2^iShift adjacent representable values.  Values that fpa::almost_equal
+///		considers equal are at most 8 representable values apart, so if
+///		the value lies within a guard band of a bucket boundary the
+///		neighbouring bucket is returned in ullAltBucket as well.  Zero
+///		and values too small to fill a bucket share bucket 0 regardless
+///		of sign.
+///	</summary>
+static void FingerprintQuantize(
+	unsigned long long ullBits,
+	int nBits,
+	int iShift,
+	unsigned long long & ullBucket,
+	unsigned long long & ullAltBucket,
+	bool & fHasAlt
+) {
+	static const unsigned long long Guard = 16;
+
+	const unsigned long long ullSign = 1ULL << (nBits - 1);
+	const unsigned long long ullMask = (1ULL << iShift) - 1ULL;
+	const unsigned long long ullHalf = 1ULL << (iShift - 1);
+
+	const unsigned long long ullSignBit = ullBits & ullSign;
+	const unsigned long long ullCentered = (ullBits & ~ullSign) + ullHalf;
+	const unsigned long long ullRemainder = ullCentered & ullMask;
+	const unsigned long long ullQuantum = ullCentered >> iShift;
+
+	ullBucket = (ullQuantum == 0)?(0):(ullSignBit | ullQuantum);
+
+	fHasAlt = false;
+	if (ullRemainder < Guard) {
+		unsigned long long ullAltQuantum = ullQuantum - 1;
+		ullAltBucket = (ullAltQuantum == 0)?(0):(ullSignBit | ullAltQuantum);
+		fHasAlt = true;
+
+	} else if (ullRemainder > ullMask - Guard) {
+		ullAltBucket = ullSignBit | (ullQuantum + 1);
+		fHasAlt = true;
+	}
+}
+
+///	<summary>
+///		Quantize a floating point value with FingerprintQuantize.
+///	</summary>
+static void FingerprintQuantizeValue(
+	float fl,
+	unsigned long long & ullBucket,
+	unsigned long long & ullAltBucket,
+	bool & fHasAlt
+) {
+	FingerprintQuantize(
+		NcValueBits(fl), 32, 10, ullBucket, ullAltBucket, fHasAlt);
+}
+
+static void FingerprintQuantizeValue(
+	double d,
+	unsigned long long & ullBucket,
+	unsigned long long & ullAltBucket,
+	bool & fHasAlt
+) {
+	FingerprintQuantize(
+		NcValueBits(d), 64, 24, ullBucket, ullAltBucket, fHasAlt);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Fingerprint integer values, which are compared exactly, so all
+///		of them are hashed.
+///	</summary>
+template <typename T>
+static void FingerprintValues(
+	const T * pValues,
+	size_t sSize,
+	size_t sBase,
+	std::vector<size_t> & vecFingerprints,
+	std::true_type
+) {
+	sBase = FingerprintCombine(sBase, sSize);
+	for (size_t s = 0; s < sSize; s++) {
+		sBase = FingerprintCombine(sBase, NcValueBits(pValues[s]));
+	}
+	vecFingerprints.push_back(sBase);
+}
+
+///	<summary>
+///		Fingerprint floating point values, which are compared with a
+///		tolerance, so a few sampled values are quantized.
+///	</summary>
+template <typename T>
+static void FingerprintValues(
+	const T * pValues,
+	size_t sSize,
+	size_t sBase,
+	std::vector<size_t> & vecFingerprints,
+	std::false_type
+) {
+	static const size_t MaxSamples = 4;
+
+	sBase = FingerprintCombine(sBase, sSize);
+
+	std::vector<size_t> vecSamples;
+	if (sSize <= MaxSamples) {
+		for (size_t s = 0; s < sSize; s++) {
+			vecSamples.push_back(s);
 		}
-		for (size_t s = 0; s < m_dValuesDouble.size(); s++) {
-			if (!fpa::almost_equal<double>(dimrange.m_dValuesDouble[s], m_dValuesDouble[s])) {
-				return false;
-			}
+	} else {
+		for (size_t i = 0; i < MaxSamples; i++) {
+			vecSamples.push_back(i * (sSize - 1) / (MaxSamples - 1));
 		}
+	}
 
-	// Dimension values stored as floats
-	} else if (m_nctype == ncFloat) {
-		if (dimrange.m_dValuesFloat.size() != m_dValuesFloat.size()) {
-			return false;
-		}
-		for (size_t s = 0; s < m_dValuesDouble.size(); s++) {
-			if (!fpa::almost_equal<float>(dimrange.m_dValuesFloat[s], m_dValuesFloat[s])) {
-				return false;
+	vecFingerprints.push_back(sBase);
+	for (size_t i = 0; i < vecSamples.size(); i++) {
+		unsigned long long ullBucket;
+		unsigned long long ullAltBucket;
+		bool fHasAlt;
+		FingerprintQuantizeValue(
+			pValues[vecSamples[i]], ullBucket, ullAltBucket, fHasAlt);
+
+		const size_t sPrevious = vecFingerprints.size();
+		for (size_t f = 0; f < sPrevious; f++) {
+			if (fHasAlt) {
+				vecFingerprints.push_back(
+					FingerprintCombine(vecFingerprints[f], ullAltBucket));
 			}
+			vecFingerprints[f] =
+				FingerprintCombine(vecFingerprints[f], ullBucket);
 		}
+	}
+}
 
-	// Unhandled type
-	} else {
-		_EXCEPTIONT("Unhandled type");
+///	<summary>
+///		Kernel computing the fingerprints of values.
+///	</summary>
+struct FingerprintKernel {
+	const TypedValueArray & values;
+	size_t sBase;
+	std::vector<size_t> & vecFingerprints;
+
+	template <typename T>
+	void Apply() {
+		FingerprintValues(
+			values.Data<T>(),
+			values.size(),
+			sBase,
+			vecFingerprints,
+			std::integral_constant<bool, std::numeric_limits<T>::is_integer>());
 	}
+};
 
-	return true;
+///////////////////////////////////////////////////////////////////////////////
+
+void SubAxis::GetFingerprints(
+	std::vector<size_t> & vecFingerprints
+) const {
+	vecFingerprints.clear();
 
+	size_t sBase = FingerprintCombine(0, static_cast<unsigned long long>(m_nctype));
+
+	// All SubAxis without a type are equal
+	if (m_nctype == ncNoType) {
+		vecFingerprints.push_back(sBase);
+		return;
+	}
+
+	// Summarized SubAxis are compared exactly through their hash
+	if (m_fSummarized) {
+		sBase = FingerprintCombine(sBase, static_cast<unsigned long long>(m_lSize));
+		sBase = FingerprintCombine(sBase, m_summary.m_ullHash);
+		vecFingerprints.push_back(sBase);
+		return;
+	}
+
+	// Values of types other than the numeric types are not stored
+	FingerprintKernel kernel = {m_values, sBase, vecFingerprints};
+	if (!DispatchNumericNcType(m_nctype, kernel)) {
+		vecFingerprints.push_back(sBase);
+	}
 }
 
-///////////////////////////////////////////////////////////////////////////////
-// AxisNameVector
 ///////////////////////////////////////////////////////////////////////////////
 
-std::string AxisNameVector::ToString() const {
-	std::string strAxes("[");
-	for (int d = 0; d < size(); d++) {
-		strAxes += "\"" + (*this)[d] + "\"";
-		if (d != size()-1) {
-			strAxes += ", ";
-		}
+void SubAxis::Summarize() {
+	if (m_fSummarized) {
+		return;
 	}
-	strAxes += "]";
-	return strAxes;
+	if (!IsNumericNcType(m_nctype)) {
+		return;
+	}
+
+	m_summary = SubAxisSummary();
+	ValuesSummaryKernel kernel = {m_summary, m_values};
+	DispatchNumericNcType(m_nctype, kernel);
+
+	m_values.Clear();
+	m_fSummarized = true;
+	m_fLinear = false;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void AxisNameVector::ToJSON(nlohmann::json & j) const {
-	for (int d = 0; d < size(); d++) {
-		j.push_back((*this)[d]);
+unsigned long long SubAxis::GetContentFingerprint() const {
+
+	// The values are hashed as a summary hashes them, so that summarized
+	// and complete copies of an array have the same fingerprint
+	unsigned long long ullValuesHash;
+	if (m_fSummarized) {
+		ullValuesHash = m_summary.m_ullHash;
+	} else {
+		SubAxisSummary summary;
+		ValuesSummaryKernel kernel = {summary, m_values};
+		DispatchNumericNcType(m_nctype, kernel);
+		ullValuesHash = summary.m_ullHash;
 	}
+
+	size_t sFingerprint =
+		FingerprintCombine(0, static_cast<unsigned long long>(m_nctype));
+	sFingerprint =
+		FingerprintCombine(sFingerprint, static_cast<unsigned long long>(m_lSize));
+	sFingerprint = FingerprintCombine(sFingerprint, ullValuesHash);
+	return static_cast<unsigned long long>(sFingerprint);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-// SubAxisToFileIdMap
+
+///	<summary>
+///		Term i of an arithmetic progression.  The fused multiply-add is
+///		rounded once on every platform, so an index written on one
+///		machine expands to the same values on another.
+///	</summary>
+static inline double LinearTerm(
+	double dStart,
+	double dStep,
+	size_t i
+) {
+	return std::fma(static_cast<double>(i), dStep, dStart);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
-std::string SubAxisToFileIdMap::ToString() const {
-	std::string strSubAxes("[");
-	SubAxisToFileIdMap::const_iterator iterSubAxisToFileId = begin();
-	for (; iterSubAxisToFileId != end(); iterSubAxisToFileId++) {
-		if (iterSubAxisToFileId != begin()) {
-			strSubAxes += ", ";
-		}
-		strSubAxes += "[";
-		for (int d = 0; d < iterSubAxisToFileId->first.size(); d++) {
-			strSubAxes += "\"" + iterSubAxisToFileId->first[d] + "\"";
-			strSubAxes += ", ";
-		}
-		strSubAxes += "\"" + iterSubAxisToFileId->second + "\"]";
+///	<summary>
+///		Check if a term of an arithmetic progression can be converted to
+///		type T.  The largest 64-bit integers are not exact as doubles, so
+///		the bound itself is excluded for them.
+///	</summary>
+template <typename T>
+static inline bool LinearTermFits(
+	double dTerm
+) {
+	static const double dLowest =
+		static_cast<double>(std::numeric_limits<T>::lowest());
+	static const double dMax =
+		static_cast<double>(std::numeric_limits<T>::max());
+
+	if (std::numeric_limits<T>::digits > std::numeric_limits<double>::digits) {
+		return (dTerm >= dLowest) && (dTerm < dMax);
 	}
-	strSubAxes += "]";
-	return strSubAxes;
+	return (dTerm >= dLowest) && (dTerm <= dMax);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void SubAxisToFileIdMap::ToJSON(nlohmann::json & j) const {
-	SubAxisToFileIdMap::const_iterator iterSubAxisToFileId = begin();
-	for (; iterSubAxisToFileId != end(); iterSubAxisToFileId++) {
-		nlohmann::json jx;
-		for (int d = 0; d < iterSubAxisToFileId->first.size(); d++) {
-			jx.push_back(iterSubAxisToFileId->first[d]);
+///	<summary>
+///		Check if every value is reproduced bit for bit by LinearTerm.
+///	</summary>
+template <typename T>
+static bool LinearMatches(
+	const T * pValues,
+	size_t sSize,
+	double dStart,
+	double dStep
+) {
+	for (size_t i = 0; i < sSize; i++) {
+		double dTerm = LinearTerm(dStart, dStep, i);
+		if (!LinearTermFits<T>(dTerm)) {
+			return false;
+		}
+		T value = static_cast<T>(dTerm);
+		if ((value != pValues[i]) ||
+		    (std::signbit(value) != std::signbit(pValues[i]))
+		) {
+			return false;
 		}
-		jx.push_back(iterSubAxisToFileId->second);
-		j.push_back(jx);
 	}
+	return true;
 }
 
-///////////////////////////////////////////////////////////////////////////////
-// VariableInfo
 ///////////////////////////////////////////////////////////////////////////////
 
-void VariableInfo::SubAxisToFileIdMapFromJSON(
-	const std::string & strKey,
-	nlohmann::json & j
+///	<summary>
+///		Find the start and step of an arithmetic progression reproducing
+///		the given values, trying the step through the end points and
+///		the step between the first two values.
+///	</summary>
+template <typename T>
+static bool LinearFit(
+	const T * pValues,
+	size_t sSize,
+	double & dStart,
+	double & dStep
 ) {
-	AxisNameVector vecAxisNames;
-	SubAxisToFileIdMap mapSubAxisToFileId;
+	dStart = static_cast<double>(pValues[0]);
 
-	// Load axisids
-	auto itaxisids = j.find("axisids");
-	if (itaxisids == j.end()) {
-		_EXCEPTION1("JSON variable \"%s\" missing \"axisids\" key",
-			strKey.c_str());
+	double dSpanStep =
+		(static_cast<double>(pValues[sSize-1]) - dStart)
+		/ static_cast<double>(sSize - 1);
+	if (std::numeric_limits<T>::is_integer) {
+		dSpanStep = std::floor(dSpanStep);
 	}
-	if (!itaxisids.value().is_null()) {
-		if (!itaxisids.value().is_array()) {
-			_EXCEPTION1("JSON variable \"%s\" \"axisids\" must be type array",
-				strKey.c_str());
-		}
-		nlohmann::json & jaxisids = *itaxisids;
-		
-		for (size_t i = 0; i < jaxisids.size(); i++) {
-			vecAxisNames.push_back(jaxisids[i]);
-		}
+	if (LinearMatches(pValues, sSize, dStart, dSpanStep)) {
+		dStep = dSpanStep;
+		return true;
 	}
 
-	// Load subaxismap
-	auto itsubaxismap = j.find("subaxismap");
-	if (itsubaxismap == j.end()) {
-		_EXCEPTION1("JSON variable \"%s\" missing \"subaxismap\" key",
-			strKey.c_str());
+	double dFirstStep = static_cast<double>(pValues[1]) - dStart;
+	if ((dFirstStep != dSpanStep) &&
+	    LinearMatches(pValues, sSize, dStart, dFirstStep)
+	) {
+		dStep = dFirstStep;
+		return true;
 	}
-	if (!itsubaxismap.value().is_array()) {
-		_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" must be type "
-			"array of arrays of strings",
-			strKey.c_str());
+	return false;
+}
+
+///	<summary>
+///		Kernel finding the arithmetic progression reproducing values.
+///	</summary>
+struct LinearFitKernel {
+	const TypedValueArray & values;
+	double dStart;
+	double dStep;
+	bool fLinear;
+
+	template <typename T>
+	void Apply() {
+		fLinear = LinearFit(values.Data<T>(), values.size(), dStart, dStep);
 	}
-	nlohmann::json jsubaxismap = *itsubaxismap;
-	for (size_t i = 0; i < jsubaxismap.size(); i++) {
-		nlohmann::json & jsubaxismapix = jsubaxismap[i];
-		if (!itsubaxismap.value().is_array()) {
-			_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" must be type "
-				"array of arrays of strings",
-				strKey.c_str());
+};
+
+///	<summary>
+///		Kernel setting values to the terms of an arithmetic progression.
+///	</summary>
+struct LinearExpandKernel {
+	TypedValueArray & values;
+	size_t sSize;
+	double dStart;
+	double dStep;
+
+	template <typename T>
+	void Apply() {
+		values.Resize(NcValueTraits<T>::Type, sSize);
+		T * pValues = values.Data<T>();
+		for (size_t i = 0; i < sSize; i++) {
+			pValues[i] = static_cast<T>(LinearTerm(dStart, dStep, i));
 		}
+	}
+};
 
-		SubAxisIdVector vecSubAxisId;
-		std::string strFileId;
+///////////////////////////////////////////////////////////////////////////////
 
-		vecSubAxisId.resize(jsubaxismapix.size()-1);
-		for (size_t j = 0; j < jsubaxismapix.size(); j++) {
-			if (!jsubaxismapix[j].is_string()) {
-				_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" must be type "
-					"array of arrays of strings",
-					strKey.c_str());
-			}
+void SubAxis::DetectLinear() {
 
-			if (j < jsubaxismapix.size()-1) {
-				vecSubAxisId[j] = jsubaxismapix[j];
-			} else {
-				strFileId = jsubaxismapix[j];
-			}
-		}
+	// Shorter progressions take as much space as their values
+	static const long MinLinearSize = 3;
 
-		mapSubAxisToFileId.insert(
-			SubAxisToFileIdMap::value_type(
-				vecSubAxisId, strFileId));
+	m_fLinear = false;
+	if (m_fSummarized || (m_lSize < MinLinearSize)) {
+		return;
+	}
+	if (m_values.size() != static_cast<size_t>(m_lSize)) {
+		return;
 	}
 
-	// Insert value into map
-	m_mapSubAxisToFileIdMaps.insert(
-		AxisNamesToSubAxisToFileIdMapMap::value_type(
-			vecAxisNames, mapSubAxisToFileId));
+	LinearFitKernel kernel = {m_values, 0.0, 0.0, false};
+	if (DispatchNumericNcType(m_nctype, kernel) && kernel.fLinear) {
+		m_fLinear = true;
+		m_dLinearStart = kernel.dStart;
+		m_dLinearStep = kernel.dStep;
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-// IndexedDataset
+
+void SubAxis::ExpandLinear(
+	double dStart,
+	double dStep
+) {
+	LinearExpandKernel kernel =
+		{m_values, static_cast<size_t>(m_lSize), dStart, dStep};
+	if (!DispatchNumericNcType(m_nctype, kernel)) {
+		_EXCEPTIONT("Invalid type");
+	}
+
+	m_fLinear = true;
+	m_dLinearStart = dStart;
+	m_dLinearStep = dStep;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SubAxisSummary
 ///////////////////////////////////////////////////////////////////////////////
 
-const size_t IndexedDataset::InvalidFileIx = (-1);
+void SubAxisSummary::Add(
+	double dValue,
+	unsigned long long ullBits
+) {
+	if (m_sCount == 0) {
+		m_dMin = std::numeric_limits<double>::infinity();
+		m_dMax = -std::numeric_limits<double>::infinity();
+		m_dFirst = dValue;
+	}
+	if (dValue < m_dMin) {
+		m_dMin = dValue;
+	}
+	if (dValue > m_dMax) {
+		m_dMax = dValue;
+	}
+	m_dLast = dValue;
+	m_ullHash = FingerprintCombine(static_cast<size_t>(m_ullHash), ullBits);
+	m_sCount++;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
-const size_t IndexedDataset::InvalidTimeIx = (-1);
+///	<summary>
+///		Compare two summary values, treating NaNs as equal.
+///	</summary>
+static inline bool SummaryValueEqual(
+	double d1,
+	double d2
+) {
+	return ((d1 == d2) || ((d1 != d1) && (d2 != d2)));
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
-const long IndexedDataset::InconsistentDimensionSizes = (-1);
+bool SubAxisSummary::operator==(
+	const SubAxisSummary & summary
+) const {
+	return (
+		(m_sCount == summary.m_sCount) &&
+		(m_ullHash == summary.m_ullHash) &&
+		SummaryValueEqual(m_dMin, summary.m_dMin) &&
+		SummaryValueEqual(m_dMax, summary.m_dMax) &&
+		SummaryValueEqual(m_dFirst, summary.m_dFirst) &&
+		SummaryValueEqual(m_dLast, summary.m_dLast));
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
-std::string IndexedDataset::PopulateFromSearchString(
-	const std::string & strSearchString
-) {
-	std::string strBaseDir;
+void SubAxisSummary::ToJSON(
+	nlohmann::json & j
+) const {
+	char szHash[32];
+	snprintf(szHash, sizeof(szHash), "%016llx", m_ullHash);
 
-	// File the directory in the search string
-	std::string strFileSearchString;
-	for (int i = strSearchString.length(); i >= 0; i--) {
-		if (strSearchString[i] == '/') {
-			strBaseDir = strSearchString.substr(0,i+1);
-			strFileSearchString =
-				strSearchString.substr(i+1, std::string::npos);
-			break;
-		}
-	}
-	if ((strBaseDir == "") && (strFileSearchString == "")) {
-		strFileSearchString = strSearchString;
-		strBaseDir = "./";
+	// Minimum and maximum are left out if all values are NaN
+	if (m_dMin <= m_dMax) {
+		j["min"] = m_dMin;
+		j["max"] = m_dMax;
 	}
+	j["first"] = m_dFirst;
+	j["last"] = m_dLast;
+	j["hash"] = szHash;
+}
 
-	// Open the directory
-	DIR * pDir = opendir(strBaseDir.c_str());
-	if (pDir == NULL) {
-		return std::string("Unable to open directory \"")
-			+ strBaseDir + std::string("\"");
-	}
+///////////////////////////////////////////////////////////////////////////////
+// AxisInfo
+///////////////////////////////////////////////////////////////////////////////
 
-	// Search all files in the directory for match to search string
-	std::vector<std::string> vecFilenames;
-	struct dirent * pDirent;
-	while ((pDirent = readdir(pDir)) != NULL) {
-		std::string strFilename = pDirent->d_name;
-		if (STLStringHelper::WildcardMatch(
-				strFileSearchString.c_str(),
-				strFilename.c_str())
-		) {
-			// File found, insert into list of filenames
-			vecFilenames.push_back(strFilename);
+std::string AxisInfo::FindSubAxis(
+	const SubAxis & subaxis
+) const {
+	std::vector<size_t> vecFingerprints;
+	subaxis.GetFingerprints(vecFingerprints);
+
+	bool fFound = false;
+	std::string strSubAxisId;
+	for (size_t f = 0; f < vecFingerprints.size(); f++) {
+		std::pair<
+			SubAxisFingerprintIndex::const_iterator,
+			SubAxisFingerprintIndex::const_iterator> range =
+				m_mapSubAxisFingerprints.equal_range(vecFingerprints[f]);
+
+		for (; range.first != range.second; range.first++) {
+			const std::string & strCandidateId = range.first->second;
+			if (fFound && !(strCandidateId < strSubAxisId)) {
+				continue;
+			}
+			SubAxisVector::const_iterator iterSubAxis =
+				m_vecSubAxis.find(strCandidateId);
+			if (iterSubAxis == m_vecSubAxis.end()) {
+				_EXCEPTIONT("Logic error");
+			}
+			if ((**iterSubAxis) == subaxis) {
+				strSubAxisId = strCandidateId;
+				fFound = true;
+			}
 		}
 	}
-	closedir(pDir);
-
-	// Index the variable data
-	return IndexVariableData(strBaseDir, vecFilenames);
+	return strSubAxisId;
 }
 
-
 ///////////////////////////////////////////////////////////////////////////////
 
-std::string IndexedDataset::PopulateFromFilePath(
-	const std::string & strFilePath,
-	const std::string & strFileName,
-	bool fRecurse
+void AxisInfo::InsertSubAxis(
+	const std::string & strSubAxisId,
+	SubAxis * psubaxis
 ) {
-	std::string strError;
-
-	// Search files in this directory
-	std::string strSearchString;
-	if (strFilePath == "") {
-		return std::string("Empty file path");
-	} else if (strFilePath[strFilePath.length()-1] == '/') {
-		strSearchString = strFilePath + strFileName;
-	} else {
-		strSearchString = strFilePath + "/" + strFileName;
-	}
-	strError = PopulateFromSearchString(strSearchString);
-	if ((strError != "") || (!fRecurse)) {
-		return strError;
-	}
-
-	// Recurse into subfolders
-	DIR * pDir = opendir(strFilePath.c_str());
-	if (pDir == NULL) {
-		return std::string("Unable to open directory \"")
-			+ strFilePath + std::string("\"");
-	}
+	m_vecSubAxis.insert(strSubAxisId, psubaxis);
 
-	// Look for subfolders
-	struct dirent * pDirent;
-	while ((pDirent = readdir(pDir)) != NULL) {
-		std::string strSubDir;
-		if (strFilePath[strFilePath.length()-1] == '/') {
-			strSubDir = strFilePath + pDirent->d_name;
-		} else {
-			strSubDir = strFilePath + "/" + pDirent->d_name;
-		}
+	std::vector<size_t> vecFingerprints;
+	psubaxis->GetFingerprints(vecFingerprints);
+	m_mapSubAxisFingerprints.insert(
+		SubAxisFingerprintIndex::value_type(vecFingerprints[0], strSubAxisId));
+}
 
-		DIR * pSubdir = opendir(strSubDir.c_str());
-		if (pSubdir == NULL) {
-			continue;
-		}
-		closedir(pSubdir);
-		if (strlen(pDirent->d_name) == 0) {
-			continue;
-		}
-		if (pDirent->d_name[0] == '.') {
-			continue;
-		}
+///////////////////////////////////////////////////////////////////////////////
 
-		strError =
-			PopulateFromFilePath(
-				strSubDir,
-				strFileName,
-				fRecurse);
+void AxisInfo::RebuildSubAxisIndex() {
+	m_mapSubAxisFingerprints.clear();
 
-		if (strError != "") {
-			closedir(pDir);
-			return strError;
-		}
+	std::vector<size_t> vecFingerprints;
+	SubAxisVector::iterator iterSubAxis = m_vecSubAxis.begin();
+	for (; iterSubAxis != m_vecSubAxis.end(); iterSubAxis++) {
+		(*iterSubAxis)->GetFingerprints(vecFingerprints);
+		m_mapSubAxisFingerprints.insert(
+			SubAxisFingerprintIndex::value_type(
+				vecFingerprints[0], iterSubAxis.key()));
 	}
-	closedir(pDir);
-	
-	return std::string("");
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// AxisNameVector
 ///////////////////////////////////////////////////////////////////////////////
 
-std::string IndexedDataset::LoadData_float(
-	const std::string & strVariableName,
-	const std::vector<long> & vecAuxIndices,
-	DataArray1D<float> & data
-) {
-/*
-	// Find the VariableInfo structure for this Variable
-	size_t iVarInfo = 0;
-	for (; iVarInfo < m_vecVariableInfo.size(); iVarInfo++) {
-		if (strVariableName == m_vecVariableInfo[iVarInfo]->m_strName) {
-			break;
+std::string AxisNameVector::ToString() const {
+	std::string strAxes("[");
+	for (int d = 0; d < size(); d++) {
+		strAxes += "\"" + (*this)[d] + "\"";
+		if (d != size()-1) {
+			strAxes += ", ";
 		}
 	}
-	if (iVarInfo == m_vecVariableInfo.size()) {
-		_EXCEPTION1("Variable \"%s\" not found in file_list index",
-			strVariableName.c_str());
-	}
+	strAxes += "]";
+	return strAxes;
+}
 
-	// Find the local file/time pair associated with this global time index
-	VariableInfo & varinfo = *(m_vecVariableInfo[iVarInfo]);
+///////////////////////////////////////////////////////////////////////////////
 
-	// Get the time index
-	if ((varinfo.m_iTimeDimIx != (-1)) &&
-		(varinfo.m_iTimeDimIx >= vecAuxIndices.size())
-	) {
-		_EXCEPTIONT("time index exceeds auxiliary index size");
+void AxisNameVector::ToJSON(nlohmann::json & j) const {
+	for (int d = 0; d < size(); d++) {
+		j.push_back((*this)[d]);
 	}
+}
 
-	// Extract the global time index
-	size_t sTime = (-1);
-	if (varinfo.m_iTimeDimIx != (-1)) {
-		sTime = vecAuxIndices[varinfo.m_iTimeDimIx];
-	}
+///////////////////////////////////////////////////////////////////////////////
+// SubAxisToFileIdMap
+///////////////////////////////////////////////////////////////////////////////
 
-	// Find local file/time index
-	VariableTimeFileMap::const_iterator iter =
-		varinfo.m_mapTimeFile.find(sTime);
+const size_t SubAxisToFileIdMap::DenseLookupMaxVaryingAxes = 2;
 
-	if (iter == varinfo.m_mapTimeFile.end()) {
-		_EXCEPTION2("sTime (%s) (%lu) not found", strVariableName.c_str(), sTime);
-	}
+///////////////////////////////////////////////////////////////////////////////
 
-	size_t sFile = iter->second.first;
-	int iTime = iter->second.second;
+const size_t SubAxisToFileIdMap::DenseLookupMaxFillRatio = 2;
 
-	{
-		std::string strLoading =
-			std::string("READ [") + strVariableName + std::string("]");
-
-		for (size_t d = 0; d < vecAuxIndices.size(); d++) {
-			if (d == varinfo.m_iTimeDimIx) {
-				strLoading +=
-					std::string(" [")
-					+ m_vecTimes[sTime].ToString()
-					+ std::string("]");
-			} else {
-				strLoading +=
-					std::string(" [")
-					+ varinfo.m_vecAuxDimNames[d]
-					+ std::string(": ")
-					+ std::to_string(vecAuxIndices[d])
-					+ std::string("]");
-			}
-		}
-		Announce(strLoading.c_str());
-	}
+///////////////////////////////////////////////////////////////////////////////
 
-	// Open the correct NetCDF file
-	std::string strFullFilename = m_strBaseDir + m_vecFilenames[sFile];
-	NcFile ncfile(strFullFilename.c_str());
-	if (!ncfile.is_valid()) {
-		_EXCEPTION1("Cannot open file \"%s\"", strFullFilename.c_str());
-	}
+const IndexId SubAxisToFileIdMap::InvalidDenseEntry = UINT32_MAX;
 
-	// Get the correct variable from the file
-	NcVar * var = ncfile.get_var(strVariableName.c_str());
-	const long nDims = var->num_dims() - m_vecGridDimNames.size();
+///////////////////////////////////////////////////////////////////////////////
 
-	if (var == NULL) {
-		_EXCEPTION1("Variable \"%s\" no longer found in file",
-			strVariableName.c_str());
+bool IndexIdFromString(
+	const std::string & str,
+	IndexId & id
+) {
+	if ((str.length() == 0) || (str.length() > 10)) {
+		return false;
 	}
-	if ((var->type() != ncFloat) && (var->type() != ncDouble)) {
-		return std::string("Variable \"")
-			+ strVariableName
-			+ std::string("\" is not of type float or double");
+	unsigned long long ullId = 0;
+	for (size_t i = 0; i < str.length(); i++) {
+		if ((str[i] < '0') || (str[i] > '9')) {
+			return false;
+		}
+		ullId = 10 * ullId + static_cast<unsigned long long>(str[i] - '0');
 	}
-	if (nDims != vecAuxIndices.size()) {
-		_EXCEPTION2("Auxiliary index array size mismatch (%li / %lu)",
-			nDims, vecAuxIndices.size());
+	if (ullId > static_cast<unsigned long long>(UINT32_MAX)) {
+		return false;
 	}
+	id = static_cast<IndexId>(ullId);
+	return true;
+}
 
-	// Set the data position and size
-	long lTotalSize = 1;
-	std::vector<long> vecPos = vecAuxIndices;
-	std::vector<long> vecSize = vecAuxIndices;
+///////////////////////////////////////////////////////////////////////////////
 
-	for (size_t d = 0; d < vecAuxIndices.size(); d++) {
-		if (d == varinfo.m_iTimeDimIx) {
-			vecPos[d] = iTime;
+size_t SubAxisToFileIdMap::LowerBound(
+	const SubAxisIdVector & vecSubAxisIds
+) const {
+	const size_t sStride = m_sWidth + 1;
+	size_t sLow = 0;
+	size_t sHigh = size();
+	while (sLow < sHigh) {
+		size_t sMid = sLow + (sHigh - sLow) / 2;
+		const IndexId * pEntry = &(m_vecEntries[sMid * sStride]);
+		if (std::lexicographical_compare(
+				pEntry, pEntry + m_sWidth,
+				vecSubAxisIds.begin(), vecSubAxisIds.end())
+		) {
+			sLow = sMid + 1;
+		} else {
+			sHigh = sMid;
 		}
-		vecSize[d] = 1;
-	}
-	for (size_t d = 0; d < m_vecGridDimNames.size(); d++) {
-		NcDim * dimGrid = var->get_dim(vecPos.size());
-		vecPos.push_back(0);
-		vecSize.push_back(dimGrid->size());
-		lTotalSize *= dimGrid->size();
 	}
+	return sLow * sStride;
+}
 
-	if (data.GetRows() != lTotalSize) {
-		//for (int d = 0; d < vecAuxIndices.size(); d++) {
-		//	printf("%s %i\n", varinfo.m_vecDimNames[d].c_str(), vecAuxIndices[d]);
-		//}
-		//for (int d = 0; d < nDims; d++) {
-		//	printf("%i %i\n", vecPos[d], vecSize[d]);
-		//}
-		_EXCEPTION2("Data size mismatch (%i/%lu)", data.GetRows(), lTotalSize);
-	}
+///////////////////////////////////////////////////////////////////////////////
 
-	// Set the position
-	var->set_cur(&(vecPos[0]));
+size_t SubAxisToFileIdMap::find(
+	const SubAxisIdVector & vecSubAxisIds
+) const {
+	if (vecSubAxisIds.size() != m_sWidth) {
+		return size();
+	}
 
-	// Load the data
-	if (var->type() == ncDouble) {
-		DataArray1D<double> data_dbl(data.GetRows());
-		var->get(&(data_dbl[0]), &(vecSize[0]));
-		for (int i = 0; i < data.GetRows(); i++) {
-			data[i] = static_cast<float>(data_dbl[i]);
+	// Dense lookup
+	if (m_vecDenseEntries.size() != 0) {
+		size_t sCell = 0;
+		for (size_t d = 0; d < m_sWidth; d++) {
+			if ((vecSubAxisIds[d] < m_vecDenseBase[d]) ||
+			    (vecSubAxisIds[d] - m_vecDenseBase[d] >= m_vecDenseExtent[d])
+			) {
+				return size();
+			}
+			sCell = sCell * m_vecDenseExtent[d]
+				+ (vecSubAxisIds[d] - m_vecDenseBase[d]);
 		}
-	} else {
-		var->get(&(data[0]), &(vecSize[0]));
+		IndexId ixEntry = m_vecDenseEntries[sCell];
+		return (ixEntry == InvalidDenseEntry)?(size()):(ixEntry);
 	}
 
-	NcError err;
-	if (err.get_err() != NC_NOERR) {
-		_EXCEPTION1("NetCDF Fatal Error (%i)", err.get_err());
+	size_t sPos = LowerBound(vecSubAxisIds);
+	if ((sPos == m_vecEntries.size()) ||
+	    !std::equal(vecSubAxisIds.begin(), vecSubAxisIds.end(),
+			m_vecEntries.begin() + sPos)
+	) {
+		return size();
 	}
-
-	// Cleanup
-	ncfile.close();
-*/
-	return std::string("");
+	return sPos / (m_sWidth + 1);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-std::string IndexedDataset::WriteData_float(
-	const std::string & strVariableName,
-	const std::vector<long> & vecAuxIndices,
-	const DataArray1D<float> & data
+bool SubAxisToFileIdMap::insert(
+	const SubAxisIdVector & vecSubAxisIds,
+	IndexId idFile
 ) {
-/*
-	// Find the VariableInfo structure for this Variable
-	size_t iVarInfo = 0;
-	for (; iVarInfo < m_vecVariableInfo.size(); iVarInfo++) {
-		if (strVariableName == m_vecVariableInfo[iVarInfo]->m_strName) {
-			break;
+	if (m_vecEntries.size() == 0) {
+		m_sWidth = vecSubAxisIds.size();
+	} else if (vecSubAxisIds.size() != m_sWidth) {
+		_EXCEPTION2("SubAxisToFileIdMap entry has %lu subaxis ids; expected %lu",
+			vecSubAxisIds.size(), m_sWidth);
+	}
+
+	// Files are usually merged in the order of their subaxes, so most
+	// entries are appended
+	const size_t sStride = m_sWidth + 1;
+	size_t sPos = m_vecEntries.size();
+	if ((sPos != 0) &&
+	    !std::lexicographical_compare(
+			m_vecEntries.end() - sStride, m_vecEntries.end() - 1,
+			vecSubAxisIds.begin(), vecSubAxisIds.end())
+	) {
+		sPos = LowerBound(vecSubAxisIds);
+		if (std::equal(vecSubAxisIds.begin(), vecSubAxisIds.end(),
+				m_vecEntries.begin() + sPos)
+		) {
+			return false;
 		}
 	}
 
-	// File index for write
-	size_t sFile = (-1);
-	int iLocalTime = (-1);
+	ClearDenseLookup();
 
-	// Not found
-	if (iVarInfo == m_vecVariableInfo.size()) {
-		_EXCEPTION();
+	IndexId * pEntry;
+	if (sPos == m_vecEntries.size()) {
+		m_vecEntries.resize(m_vecEntries.size() + sStride);
+		pEntry = &(m_vecEntries[sPos]);
+	} else {
+		m_vecEntries.insert(m_vecEntries.begin() + sPos, sStride, 0);
+		pEntry = &(m_vecEntries[sPos]);
 	}
+	std::copy(vecSubAxisIds.begin(), vecSubAxisIds.end(), pEntry);
+	pEntry[m_sWidth] = idFile;
+	return true;
+}
 
-	// Get file index from varinfo
-	VariableInfo & varinfo = *(m_vecVariableInfo[iVarInfo]);
+///////////////////////////////////////////////////////////////////////////////
 
-	// Check auxiliary indices
-	if (vecAuxIndices.size() != varinfo.m_vecAuxDimSizes.size()) {
-		_EXCEPTIONT("Invalid auxiliary index");
+size_t SubAxisToFileIdMap::insert(
+	size_t sWidth,
+	const std::vector<IndexId> & vecEntries
+) {
+	const size_t sStride = sWidth + 1;
+	if (vecEntries.size() % sStride != 0) {
+		_EXCEPTION2("SubAxisToFileIdMap entries of length %lu are not tuples"
+			" of %lu ids", vecEntries.size(), sStride);
 	}
-
-	// Extract the time index
-	size_t sTime = (-1);
-	if (varinfo.m_iTimeDimIx != (-1)) {
-		sTime = vecAuxIndices[varinfo.m_iTimeDimIx];
+	if (vecEntries.size() == 0) {
+		return 0;
 	}
-
-	// Write message
-	{
-		std::string strWriting =
-			std::string("WRITE [") + strVariableName + std::string("]");
-
-		for (size_t d = 0; d < vecAuxIndices.size(); d++) {
-			if (d == varinfo.m_iTimeDimIx) {
-				strWriting +=
-					std::string(" [")
-					+ m_vecTimes[sTime].ToString()
-					+ std::string("]");
-			} else {
-				strWriting +=
-					std::string(" [")
-					+ varinfo.m_vecAuxDimNames[d]
-					+ std::string(": ")
-					+ std::to_string(vecAuxIndices[d])
-					+ std::string("]");
-			}
-		}
-		Announce(strWriting.c_str());
+	if (m_vecEntries.size() == 0) {
+		m_sWidth = sWidth;
+	} else if (sWidth != m_sWidth) {
+		_EXCEPTION2("SubAxisToFileIdMap entry has %lu subaxis ids; expected %lu",
+			sWidth, m_sWidth);
 	}
 
-	// Check consistency with indexing procedure
-	if ((sTime == (-1)) && (varinfo.m_iTimeDimIx != (-1))) {
-		_EXCEPTIONT("Attempting to write single time index "
-			"for multi-time-index variable");
+	// Sort the new entries, keeping the first of any with equal subaxis ids
+	const size_t sNewCount = vecEntries.size() / sStride;
+	std::vector<size_t> vecOrder(sNewCount);
+	for (size_t i = 0; i < sNewCount; i++) {
+		vecOrder[i] = i * sStride;
 	}
-	if ((sTime != (-1)) && (varinfo.m_iTimeDimIx == (-1))) {
-		_EXCEPTIONT("Attempting to write single time indexed "
-			"variable as multi-indexed variable");
+	auto SubAxisIdsLess = [sWidth](const IndexId * a, const IndexId * b) {
+		return std::lexicographical_compare(a, a + sWidth, b, b + sWidth);
+	};
+	std::stable_sort(vecOrder.begin(), vecOrder.end(),
+		[&](size_t a, size_t b) {
+			return SubAxisIdsLess(&(vecEntries[a]), &(vecEntries[b]));
+		});
+
+	// Merge with the existing entries, which take precedence
+	std::vector<IndexId> vecMerged;
+	vecMerged.reserve(m_vecEntries.size() + vecEntries.size());
+	size_t sInserted = 0;
+	size_t sPos = 0;
+	for (size_t i = 0; i < sNewCount; i++) {
+		const IndexId * pNew = &(vecEntries[vecOrder[i]]);
+		if ((i != 0) && !SubAxisIdsLess(&(vecEntries[vecOrder[i-1]]), pNew)) {
+			continue;
+		}
+		while ((sPos < m_vecEntries.size()) &&
+		       SubAxisIdsLess(&(m_vecEntries[sPos]), pNew)
+		) {
+			vecMerged.insert(vecMerged.end(),
+				m_vecEntries.begin() + sPos,
+				m_vecEntries.begin() + sPos + sStride);
+			sPos += sStride;
+		}
+		if ((sPos < m_vecEntries.size()) &&
+		    !SubAxisIdsLess(pNew, &(m_vecEntries[sPos]))
+		) {
+			continue;
+		}
+		vecMerged.insert(vecMerged.end(), pNew, pNew + sStride);
+		sInserted++;
 	}
+	vecMerged.insert(vecMerged.end(),
+		m_vecEntries.begin() + sPos, m_vecEntries.end());
 
-	VariableTimeFileMap::const_iterator iterTimeFile =
-		varinfo.m_mapTimeFile.find(sTime);
-
-	if (iterTimeFile == varinfo.m_mapTimeFile.end()) {
-		if (sTime == InvalidTimeIx) {
-			sFile = m_sReduceTargetIx;
-			iLocalTime = (-1);
-
-		} else {
-			std::map<size_t, LocalFileTimePair>::const_iterator iterFileIx =
-				m_mapOutputTimeFile.find(sTime);
-
-			if (iterFileIx == m_mapOutputTimeFile.end()) {
-				_EXCEPTIONT("Unable to determine output file");
-			}
+	if (sInserted != 0) {
+		ClearDenseLookup();
+		m_vecEntries.swap(vecMerged);
+	}
+	return sInserted;
+}
 
-			sFile = iterFileIx->second.first;
-			iLocalTime = iterFileIx->second.second;
+///////////////////////////////////////////////////////////////////////////////
 
-			varinfo.m_mapTimeFile.insert(
-				VariableTimeFileMap::value_type(
-					sTime,
-					LocalFileTimePair(sFile, iLocalTime)));
-		}
+bool SubAxisToFileIdMap::BuildDenseLookup() {
+	ClearDenseLookup();
 
-	} else {
-		sFile = iterTimeFile->second.first;
-		iLocalTime = iterTimeFile->second.second;
+	const size_t sEntries = size();
+	if ((sEntries < 2) || (sEntries >= static_cast<size_t>(InvalidDenseEntry))) {
+		return false;
 	}
 
-	if (sFile == (-1)) {
-		_EXCEPTIONT("Logic error");
+	// Range of subaxis ids along each axis
+	std::vector<IndexId> vecBase(subaxisids(0), subaxisids(0) + m_sWidth);
+	std::vector<IndexId> vecMax(vecBase);
+	for (size_t i = 1; i < sEntries; i++) {
+		const IndexId * pSubAxisIds = subaxisids(i);
+		for (size_t d = 0; d < m_sWidth; d++) {
+			vecBase[d] = std::min(vecBase[d], pSubAxisIds[d]);
+			vecMax[d] = std::max(vecMax[d], pSubAxisIds[d]);
+		}
 	}
 
-	// Set the data position and size
-	long lTotalSize = 1;
-	std::vector<long> vecPos = vecAuxIndices;
-	std::vector<long> vecSize = vecAuxIndices;
-
-	for (size_t d = 0; d < vecAuxIndices.size(); d++) {
-		if (d == varinfo.m_iTimeDimIx) {
-			vecPos[d] = iLocalTime;
+	size_t sVaryingAxes = 0;
+	size_t sCells = 1;
+	std::vector<size_t> vecExtent(m_sWidth);
+	for (size_t d = 0; d < m_sWidth; d++) {
+		vecExtent[d] = static_cast<size_t>(vecMax[d] - vecBase[d]) + 1;
+		if (vecExtent[d] == 1) {
+			continue;
+		}
+		sVaryingAxes++;
+		if ((sVaryingAxes > DenseLookupMaxVaryingAxes) ||
+		    (vecExtent[d] > DenseLookupMaxFillRatio * sEntries / sCells)
+		) {
+			return false;
+		}
+		sCells *= vecExtent[d];
+	}
+	if (sCells > DenseLookupMaxFillRatio * sEntries) {
+		return false;
+	}
+
+	m_vecDenseEntries.resize(sCells, InvalidDenseEntry);
+	for (size_t i = 0; i < sEntries; i++) {
+		const IndexId * pSubAxisIds = subaxisids(i);
+		size_t sCell = 0;
+		for (size_t d = 0; d < m_sWidth; d++) {
+			sCell = sCell * vecExtent[d] + (pSubAxisIds[d] - vecBase[d]);
+		}
+		m_vecDenseEntries[sCell] = static_cast<IndexId>(i);
+	}
+	m_vecDenseBase.swap(vecBase);
+	m_vecDenseExtent.swap(vecExtent);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SubAxisToFileIdMap::ToStream(std::ostream & os) const {
+	os << "[";
+	for (size_t i = 0; i < size(); i++) {
+		if (i != 0) {
+			os << ", ";
+		}
+		os << "[";
+		const IndexId * pSubAxisIds = subaxisids(i);
+		for (size_t d = 0; d < m_sWidth; d++) {
+			os << "\"" << pSubAxisIds[d] << "\", ";
+		}
+		os << "\"" << fileid(i) << "\"]";
+	}
+	os << "]";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string SubAxisToFileIdMap::ToString() const {
+	std::ostringstream ssSubAxes;
+	ToStream(ssSubAxes);
+	return ssSubAxes.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SubAxisToFileIdMap::ToJSON(nlohmann::json & j) const {
+	for (size_t i = 0; i < size(); i++) {
+		nlohmann::json jx;
+		const IndexId * pSubAxisIds = subaxisids(i);
+		for (size_t d = 0; d < m_sWidth; d++) {
+			jx.push_back(IndexIdToString(pSubAxisIds[d]));
+		}
+		jx.push_back(IndexIdToString(fileid(i)));
+		j.push_back(jx);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SubAxisIntervalIndex
+///////////////////////////////////////////////////////////////////////////////
+
+void SubAxisIntervalIndex::Sort() {
+	std::sort(m_vecIntervals.begin(), m_vecIntervals.end(), Interval::MinLess);
+
+	m_vecPrefixMax.resize(m_vecIntervals.size());
+	for (size_t i = 0; i < m_vecIntervals.size(); i++) {
+		m_vecPrefixMax[i] = m_vecIntervals[i].m_dMax;
+		if ((i != 0) && (m_vecPrefixMax[i-1] > m_vecPrefixMax[i])) {
+			m_vecPrefixMax[i] = m_vecPrefixMax[i-1];
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SubAxisIntervalIndex::FindOverlapping(
+	double dLow,
+	double dHigh,
+	std::vector<size_t> & vecIntervalIxs
+) const {
+	vecIntervalIxs.clear();
+
+	// Intervals from sEnd on start above dHigh
+	const size_t sEnd = static_cast<size_t>(
+		std::upper_bound(
+			m_vecIntervals.begin(), m_vecIntervals.end(), dHigh,
+			[](double d, const Interval & interval) {
+				return (d < interval.m_dMin);
+			}) - m_vecIntervals.begin());
+
+	// Intervals before sBegin end below dLow
+	const size_t sBegin = static_cast<size_t>(
+		std::lower_bound(
+			m_vecPrefixMax.begin(), m_vecPrefixMax.begin() + sEnd, dLow)
+		- m_vecPrefixMax.begin());
+
+	for (size_t i = sBegin; i < sEnd; i++) {
+		if (m_vecIntervals[i].m_dMax >= dLow) {
+			vecIntervalIxs.push_back(i);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// QueryAxisRange
+///////////////////////////////////////////////////////////////////////////////
+
+std::string QueryAxisRange::FromString(
+	const std::string & strRange
+) {
+	const std::string strMalformed =
+		std::string("Malformed query range \"") + strRange
+		+ std::string("\"; expected <axis>=<low>,<high>");
+
+	size_t sEquals = strRange.find('=');
+	if ((sEquals == std::string::npos) || (sEquals == 0)) {
+		return strMalformed;
+	}
+	size_t sComma = strRange.find(',', sEquals+1);
+	if (sComma == std::string::npos) {
+		return strMalformed;
+	}
+
+	m_strAxisName = strRange.substr(0, sEquals);
+	const std::string strLow = strRange.substr(sEquals+1, sComma-sEquals-1);
+	const std::string strHigh = strRange.substr(sComma+1);
+	if ((strLow == "") || (strHigh == "")) {
+		return strMalformed;
+	}
+
+	char * szEndLow = NULL;
+	char * szEndHigh = NULL;
+	double dLow = strtod(strLow.c_str(), &szEndLow);
+	double dHigh = strtod(strHigh.c_str(), &szEndHigh);
+	bool fLowNumeric = (*szEndLow == '\0');
+	bool fHighNumeric = (*szEndHigh == '\0');
+
+	if (fLowNumeric && fHighNumeric) {
+		if (dLow > dHigh) {
+			return std::string("Query range \"") + strRange
+				+ std::string("\" has its lower bound above its upper bound");
+		}
+		m_dLow = dLow;
+		m_dHigh = dHigh;
+		m_fFormattedTime = false;
+
+	} else if (!fLowNumeric && !fHighNumeric) {
+		m_strTimeLow = strLow;
+		m_strTimeHigh = strHigh;
+		m_fFormattedTime = true;
+
+	} else {
+		return std::string("Query range \"") + strRange
+			+ std::string("\" must have two numeric or two time bounds");
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// QueryFileRange
+///////////////////////////////////////////////////////////////////////////////
+
+std::string QueryAxisRange::ListFromString(
+	const std::string & strRanges,
+	std::vector<QueryAxisRange> & vecRanges
+) {
+	vecRanges.clear();
+
+	size_t sPos = 0;
+	while (sPos <= strRanges.length()) {
+		size_t sNext = strRanges.find(';', sPos);
+		if (sNext == std::string::npos) {
+			sNext = strRanges.length();
+		}
+		std::string strRange = strRanges.substr(sPos, sNext - sPos);
+		if (strRange != "") {
+			QueryAxisRange range;
+			std::string strError = range.FromString(strRange);
+			if (strError != "") {
+				return strError;
+			}
+			vecRanges.push_back(range);
+		}
+		sPos = sNext + 1;
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void QueryFileRange::ToJSON(nlohmann::json & j) const {
+	j["file"] = m_strFilename;
+	m_vecAxisNames.ToJSON(j["axisids"]);
+	j["start"] = m_vecStart;
+	j["count"] = m_vecCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// VariableInfo
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableInfo::SubAxisToFileIdMapFromJSON(
+	const std::string & strKey,
+	nlohmann::json & j
+) {
+	AxisNameVector vecAxisNames;
+	SubAxisToFileIdMap mapSubAxisToFileId;
+
+	// Load axisids
+	auto itaxisids = j.find("axisids");
+	if (itaxisids == j.end()) {
+		_EXCEPTION1("JSON variable \"%s\" missing \"axisids\" key",
+			strKey.c_str());
+	}
+	if (!itaxisids.value().is_null()) {
+		if (!itaxisids.value().is_array()) {
+			_EXCEPTION1("JSON variable \"%s\" \"axisids\" must be type array",
+				strKey.c_str());
+		}
+		nlohmann::json & jaxisids = *itaxisids;
+		
+		for (size_t i = 0; i < jaxisids.size(); i++) {
+			vecAxisNames.push_back(jaxisids[i]);
+		}
+	}
+
+	// Load subaxismap
+	auto itsubaxismap = j.find("subaxismap");
+	if (itsubaxismap == j.end()) {
+		_EXCEPTION1("JSON variable \"%s\" missing \"subaxismap\" key",
+			strKey.c_str());
+	}
+	if (!itsubaxismap.value().is_array()) {
+		_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" must be type "
+			"array of arrays of strings",
+			strKey.c_str());
+	}
+	nlohmann::json jsubaxismap = *itsubaxismap;
+	for (size_t i = 0; i < jsubaxismap.size(); i++) {
+		nlohmann::json & jsubaxismapix = jsubaxismap[i];
+		if (!itsubaxismap.value().is_array()) {
+			_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" must be type "
+				"array of arrays of strings",
+				strKey.c_str());
+		}
+
+		if (jsubaxismapix.size() != vecAxisNames.size()+1) {
+			_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" entry has the "
+				"wrong length",
+				strKey.c_str());
+		}
+
+		SubAxisIdVector vecSubAxisId;
+		IndexId idFile = 0;
+
+		vecSubAxisId.resize(jsubaxismapix.size()-1);
+		for (size_t j = 0; j < jsubaxismapix.size(); j++) {
+			if (!jsubaxismapix[j].is_string()) {
+				_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" must be type "
+					"array of arrays of strings",
+					strKey.c_str());
+			}
+
+			IndexId & id = (j < jsubaxismapix.size()-1)?(vecSubAxisId[j]):(idFile);
+			if (!IndexIdFromString(jsubaxismapix[j].get<std::string>(), id)) {
+				_EXCEPTION2("JSON variable \"%s\" \"subaxismap\" contains "
+					"invalid id \"%s\"",
+					strKey.c_str(),
+					jsubaxismapix[j].get<std::string>().c_str());
+			}
+		}
+
+		mapSubAxisToFileId.insert(vecSubAxisId, idFile);
+	}
+
+	// Insert value into map
+	m_mapSubAxisToFileIdMaps.insert(
+		AxisNamesToSubAxisToFileIdMapMap::value_type(
+			vecAxisNames, mapSubAxisToFileId));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t VariableInfo::BuildFileIdLookups() {
+	size_t sDense = 0;
+	AxisNamesToSubAxisToFileIdMapMap::iterator iterAxisGroup =
+		m_mapSubAxisToFileIdMaps.begin();
+	for (; iterAxisGroup != m_mapSubAxisToFileIdMaps.end(); iterAxisGroup++) {
+		if (iterAxisGroup->second.BuildDenseLookup()) {
+			sDense++;
+		}
+	}
+	return sDense;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool VariableInfo::MergeStorage(
+	const VariableStorage & storage
+) {
+	if (m_fStorageVaries || (storage == m_storage)) {
+		return false;
+	}
+	if (!m_storage.IsKnown()) {
+		m_storage = storage;
+		return false;
+	}
+	if (!storage.IsKnown()) {
+		return false;
+	}
+	m_fStorageVaries = true;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// VariableStorage
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableStorage::FromNcVar(
+	int ncid,
+	int varid,
+	int nDims
+) {
+	(*this) = VariableStorage();
+
+	int iFormat;
+	if (nc_inq_format(ncid, &iFormat) != NC_NOERR) {
+		return;
+	}
+	if ((iFormat != NC_FORMAT_NETCDF4) &&
+	    (iFormat != NC_FORMAT_NETCDF4_CLASSIC)
+	) {
+		SetClassic();
+		return;
+	}
+
+	int iStorage;
+	std::vector<size_t> vecChunkSizes(std::max(nDims, 1), 0);
+	if (nc_inq_var_chunking(ncid, varid, &iStorage, &(vecChunkSizes[0])) != NC_NOERR) {
+		return;
+	}
+	if (iStorage == NC_CHUNKED) {
+		m_eLayout = Layout_Chunked;
+		vecChunkSizes.resize(nDims);
+		m_vecChunkSizes = vecChunkSizes;
+#if defined(NC_COMPACT)
+	} else if (iStorage == NC_COMPACT) {
+		m_eLayout = Layout_Compact;
+#endif
+	} else {
+		m_eLayout = Layout_Contiguous;
+	}
+
+	int iShuffle;
+	int iDeflate;
+	int iDeflateLevel;
+	if ((nc_inq_var_deflate(ncid, varid, &iShuffle, &iDeflate, &iDeflateLevel) == NC_NOERR) &&
+	    (m_eLayout == Layout_Chunked)
+	) {
+		m_fShuffle = (iShuffle != 0);
+		m_iDeflateLevel = (iDeflate != 0)?(iDeflateLevel):(0);
+	}
+
+	int iFletcher32;
+	if (nc_inq_var_fletcher32(ncid, varid, &iFletcher32) == NC_NOERR) {
+		m_fFletcher32 = (iFletcher32 != 0);
+	}
+
+	int iEndian;
+	if (nc_inq_var_endian(ncid, varid, &iEndian) == NC_NOERR) {
+		if (iEndian == NC_ENDIAN_LITTLE) {
+			m_eEndian = Endian_Little;
+		} else if (iEndian == NC_ENDIAN_BIG) {
+			m_eEndian = Endian_Big;
+		}
+	}
+
+	// Filters other than deflate, shuffle and fletcher32 (NetCDF 4.6+);
+	// newer versions of the library list those three as filters too
+#if defined(NC_EFILTER)
+	unsigned int uFilterId = 0;
+	if ((nc_inq_var_filter(ncid, varid, &uFilterId, NULL, NULL) == NC_NOERR) &&
+	    (uFilterId > 3)
+	) {
+		m_uFilterId = uFilterId;
+	}
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableStorage::SetClassic() {
+	(*this) = VariableStorage();
+	m_eLayout = Layout_Contiguous;
+	m_eEndian = Endian_Big;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableStorage::ToJSON(
+	nlohmann::json & j
+) const {
+	j["layout"] = LayoutToString(m_eLayout);
+	if (m_eLayout == Layout_Chunked) {
+		j["chunks"] = m_vecChunkSizes;
+	}
+	if (m_iDeflateLevel != 0) {
+		j["deflate"] = m_iDeflateLevel;
+	}
+	if (m_fShuffle) {
+		j["shuffle"] = true;
+	}
+	if (m_fFletcher32) {
+		j["fletcher32"] = true;
+	}
+	if (m_eEndian != Endian_Native) {
+		j["endian"] = EndianToString(m_eEndian);
+	}
+	if (m_uFilterId != 0) {
+		j["filter"] = m_uFilterId;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string VariableStorage::ChunkSizesToString() const {
+	std::string strChunkSizes;
+	for (size_t d = 0; d < m_vecChunkSizes.size(); d++) {
+		if (d != 0) {
+			strChunkSizes += ",";
+		}
+		strChunkSizes += std::to_string((unsigned long long)m_vecChunkSizes[d]);
+	}
+	return strChunkSizes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * VariableStorage::LayoutToString(
+	Layout eLayout
+) {
+	switch (eLayout) {
+		case Layout_Contiguous: return "contiguous";
+		case Layout_Chunked: return "chunked";
+		case Layout_Compact: return "compact";
+		default: return "unknown";
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool VariableStorage::LayoutFromString(
+	const std::string & strLayout,
+	Layout & eLayout
+) {
+	if (strLayout == "contiguous") {
+		eLayout = Layout_Contiguous;
+	} else if (strLayout == "chunked") {
+		eLayout = Layout_Chunked;
+	} else if (strLayout == "compact") {
+		eLayout = Layout_Compact;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * VariableStorage::EndianToString(
+	Endian eEndian
+) {
+	switch (eEndian) {
+		case Endian_Little: return "little";
+		case Endian_Big: return "big";
+		default: return "native";
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool VariableStorage::EndianFromString(
+	const std::string & strEndian,
+	Endian & eEndian
+) {
+	if (strEndian == "native") {
+		eEndian = Endian_Native;
+	} else if (strEndian == "little") {
+		eEndian = Endian_Little;
+	} else if (strEndian == "big") {
+		eEndian = Endian_Big;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// VariableHeader
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableHeader::FromNcVar(
+	NcFile * ncfile,
+	NcVar * var
+) {
+	m_strName = var->name();
+	m_nctype = var->type();
+
+	// Get units and attributes, if available, reading each once
+	const int ncid = ncfile->id();
+	const int varid = var->id();
+	char szAttName[NC_MAX_NAME+1];
+	std::string strValue;
+	for (int a = 0; a < var->num_atts(); a++) {
+		if (!GetNcAttName(ncid, varid, a, szAttName) ||
+		    !GetNcAttAsString(ncid, varid, szAttName, strValue)
+		) {
+			continue;
+		}
+		if (strcmp(szAttName, "units") == 0) {
+			m_strUnits = strValue;
+		} else {
+			m_vecAttributes.push_back(
+				AttributeVector::value_type(szAttName, strValue));
+		}
+	}
+
+	// Get dimension names
+	const int nDims = var->num_dims();
+	for (int d = 0; d < nDims; d++) {
+		m_vecDimNames.push_back(var->get_dim(d)->name());
+	}
+
+	// Get storage layout
+	m_storage.FromNcVar(ncid, varid, nDims);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableHeader::FromClassicNcVar(
+	const ClassicNcFile & ncclassic,
+	const ClassicNcVariable & var
+) {
+	m_strName = var.m_strName;
+	m_nctype = static_cast<NcType>(var.m_nType);
+
+	// Get units and attributes, if available
+	std::string strValue;
+	for (size_t a = 0; a < var.m_vecAttributes.size(); a++) {
+		const ClassicNcAttribute & att = var.m_vecAttributes[a];
+		if (!att.AsString(strValue)) {
+			continue;
+		}
+		if (att.m_strName == "units") {
+			m_strUnits = strValue;
+		} else {
+			m_vecAttributes.push_back(
+				AttributeVector::value_type(att.m_strName, strValue));
+		}
+	}
+
+	// Get dimension names
+	const std::vector<ClassicNcDimension> & vecDims = ncclassic.GetDimensions();
+	for (size_t d = 0; d < var.m_vecDimIds.size(); d++) {
+		m_vecDimNames.push_back(vecDims[var.m_vecDimIds[d]].m_strName);
+	}
+
+	// Get storage layout
+	m_storage.SetClassic();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// FileStamp
+///////////////////////////////////////////////////////////////////////////////
+
+bool FileStamp::FromFile(
+	const std::string & strFilename
+) {
+	if (IsRemoteURL(strFilename)) {
+		m_ullInode = 0;
+		std::string strError = RemoteFileClient::Shared().Stat(
+			strFilename, m_llSize, m_llModTime);
+		if (strError != "") {
+			m_llSize = 0;
+			m_llModTime = 0;
+			return false;
+		}
+		return true;
+	}
+
+	struct stat statFile;
+	if (stat(strFilename.c_str(), &statFile) != 0) {
+		m_llSize = 0;
+		m_llModTime = 0;
+		m_ullInode = 0;
+		return false;
+	}
+
+#if defined(__APPLE__)
+	const struct timespec & tsModTime = statFile.st_mtimespec;
+#else
+	const struct timespec & tsModTime = statFile.st_mtim;
+#endif
+
+	m_llSize = static_cast<long long>(statFile.st_size);
+	m_llModTime =
+		static_cast<long long>(tsModTime.tv_sec) * 1000000000LL
+		+ static_cast<long long>(tsModTime.tv_nsec);
+	m_ullInode = static_cast<unsigned long long>(statFile.st_ino);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// FileInfo
+///////////////////////////////////////////////////////////////////////////////
+
+void FileInfo::GetAttributes(
+	AttributeMap & mapKeyAttributes,
+	AttributeMap & mapOtherAttributes
+) const {
+	if (m_pattrblock != NULL) {
+		mapKeyAttributes = m_pattrblock->m_mapKeyAttributes;
+		mapOtherAttributes = m_pattrblock->m_mapOtherAttributes;
+	} else {
+		mapKeyAttributes.clear();
+		mapOtherAttributes.clear();
+	}
+
+	AttributeMap::const_iterator iterattr = m_mapKeyAttributes.begin();
+	for (; iterattr != m_mapKeyAttributes.end(); iterattr++) {
+		mapKeyAttributes[iterattr->first] = iterattr->second;
+	}
+	iterattr = m_mapOtherAttributes.begin();
+	for (; iterattr != m_mapOtherAttributes.end(); iterattr++) {
+		mapOtherAttributes[iterattr->first] = iterattr->second;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FileInfo::UnshareAttributes() {
+	if (m_pattrblock == NULL) {
+		return;
+	}
+
+	AttributeMap mapKeyAttributes;
+	AttributeMap mapOtherAttributes;
+	GetAttributes(mapKeyAttributes, mapOtherAttributes);
+
+	m_mapKeyAttributes.swap(mapKeyAttributes);
+	m_mapOtherAttributes.swap(mapOtherAttributes);
+	m_pattrblock.reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// FileAttributeBlockTable
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Hash the names of the key and other attributes of a file.
+///	</summary>
+static size_t AttributeNamesHash(
+	const AttributeMap & mapKeyAttributes,
+	const AttributeMap & mapOtherAttributes
+) {
+	std::hash<InternedString> hashName;
+
+	size_t sHash = mapKeyAttributes.size();
+	AttributeMap::const_iterator iterattr = mapKeyAttributes.begin();
+	for (; iterattr != mapKeyAttributes.end(); iterattr++) {
+		sHash = sHash * 31 + hashName(iterattr->first);
+	}
+	sHash = sHash * 31 + mapOtherAttributes.size();
+	iterattr = mapOtherAttributes.begin();
+	for (; iterattr != mapOtherAttributes.end(); iterattr++) {
+		sHash = sHash * 31 + hashName(iterattr->first);
+	}
+	return sHash;
+}
+
+///	<summary>
+///		Add to sDifferent the number of values of mapAttributes that
+///		differ from those of mapBlock.  Returns false if the two maps do
+///		not hold the same attribute names.
+///	</summary>
+static bool CountDifferentValues(
+	const AttributeMap & mapAttributes,
+	const AttributeMap & mapBlock,
+	size_t & sDifferent
+) {
+	if (mapAttributes.size() != mapBlock.size()) {
+		return false;
+	}
+	AttributeMap::const_iterator iterattr = mapAttributes.begin();
+	AttributeMap::const_iterator iterblock = mapBlock.begin();
+	for (; iterattr != mapAttributes.end(); iterattr++, iterblock++) {
+		if (iterattr->first != iterblock->first) {
+			return false;
+		}
+		if (iterattr->second != iterblock->second) {
+			sDifferent++;
+		}
+	}
+	return true;
+}
+
+///	<summary>
+///		Remove from mapAttributes the values equal to those of mapBlock,
+///		which holds the same attribute names.
+///	</summary>
+static void EraseSharedValues(
+	AttributeMap & mapAttributes,
+	const AttributeMap & mapBlock
+) {
+	AttributeMap::iterator iterattr = mapAttributes.begin();
+	AttributeMap::const_iterator iterblock = mapBlock.begin();
+	for (; iterblock != mapBlock.end(); iterblock++) {
+		if (iterattr->second == iterblock->second) {
+			iterattr = mapAttributes.erase(iterattr);
+		} else {
+			iterattr++;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FileAttributeBlockTable::Share(
+	FileInfo & fileinfo
+) {
+	fileinfo.UnshareAttributes();
+
+	const size_t sAttributes =
+		fileinfo.m_mapKeyAttributes.size()
+		+ fileinfo.m_mapOtherAttributes.size();
+	if (sAttributes == 0) {
+		return;
+	}
+
+	std::vector< std::shared_ptr<const FileAttributeBlock> > & vecBlocks =
+		m_mapBlocks[AttributeNamesHash(
+			fileinfo.m_mapKeyAttributes,
+			fileinfo.m_mapOtherAttributes)];
+
+	// Find the candidate with the fewest values that differ
+	size_t sBest = vecBlocks.size();
+	size_t sBestDifferent = sAttributes;
+	for (size_t b = vecBlocks.size(); b > 0; b--) {
+		const FileAttributeBlock & block = *(vecBlocks[b-1]);
+		size_t sDifferent = 0;
+		if (!CountDifferentValues(
+				fileinfo.m_mapKeyAttributes,
+				block.m_mapKeyAttributes,
+				sDifferent) ||
+		    !CountDifferentValues(
+				fileinfo.m_mapOtherAttributes,
+				block.m_mapOtherAttributes,
+				sDifferent)
+		) {
+			continue;
+		}
+		if (sDifferent < sBestDifferent) {
+			sBest = b-1;
+			sBestDifferent = sDifferent;
+			if (sDifferent == 0) {
+				break;
+			}
+		}
+	}
+
+	// Keep only the values that differ from a block that holds most of
+	// the values of the file
+	if ((sBest != vecBlocks.size()) && (2 * sBestDifferent <= sAttributes)) {
+		const FileAttributeBlock & block = *(vecBlocks[sBest]);
+		EraseSharedValues(fileinfo.m_mapKeyAttributes, block.m_mapKeyAttributes);
+		EraseSharedValues(fileinfo.m_mapOtherAttributes, block.m_mapOtherAttributes);
+		fileinfo.m_pattrblock = vecBlocks[sBest];
+		return;
+	}
+
+	// Start a new block holding the values of the file
+	std::shared_ptr<FileAttributeBlock> pblock =
+		std::make_shared<FileAttributeBlock>();
+	pblock->m_mapKeyAttributes.swap(fileinfo.m_mapKeyAttributes);
+	pblock->m_mapOtherAttributes.swap(fileinfo.m_mapOtherAttributes);
+	fileinfo.m_pattrblock = pblock;
+
+	if (vecBlocks.size() >= MaxCandidates) {
+		vecBlocks.erase(vecBlocks.begin());
+	}
+	vecBlocks.push_back(pblock);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// FileHeader
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		The NetCDF library is not thread-safe, so all calls into it,
+///		including those through NcFilePool, are serialized on this mutex.
+///	</summary>
+static std::mutex & s_mutexNetCDF = NcFilePool::LibraryMutex();
+
+///////////////////////////////////////////////////////////////////////////////
+
+class FileHeaderExtractionPool;
+
+///	<summary>
+///		A lock on s_mutexNetCDF taken to extract a file header.  When the
+///		extraction on this thread has a deadline, the time spent waiting
+///		for the lock is reported to its pool so that it is not counted
+///		against the deadline, and the wait is abandoned with an exception
+///		once another extraction has held the lock past its own deadline.
+///	</summary>
+class NetCDFHeaderLock {
+
+public:
+	///	<summary>
+	///		Constructor, which acquires s_mutexNetCDF.
+	///	</summary>
+	NetCDFHeaderLock();
+
+	///	<summary>
+	///		Destructor, which releases s_mutexNetCDF.
+	///	</summary>
+	~NetCDFHeaderLock();
+
+	///	<summary>
+	///		Set the extraction with a deadline on this thread, or NULL.
+	///	</summary>
+	static void SetTimedExtraction(
+		FileHeaderExtractionPool * ppool,
+		FileHeaderExtraction * pextraction
+	);
+
+private:
+	///	<summary>
+	///		Pool and extraction with a deadline on this thread.
+	///	</summary>
+	static thread_local FileHeaderExtractionPool * s_ppool;
+	static thread_local FileHeaderExtraction * s_pextraction;
+
+	///	<summary>
+	///		Flag indicating s_mutexNetCDF is held by an extraction with a
+	///		deadline, and the time by which it should release it, guarded
+	///		by s_mutexHolder and signalled by s_condHolder on release.
+	///	</summary>
+	static bool s_fTimedHolder;
+	static Profiler::Clock::time_point s_tHolderDeadline;
+	static std::mutex s_mutexHolder;
+	static std::condition_variable s_condHolder;
+
+	///	<summary>
+	///		Flag indicating this lock was taken by an extraction with a
+	///		deadline.
+	///	</summary>
+	bool m_fTimed;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Read the leading block of a file without going through the NetCDF
+///		library, so that the open and header read latency of the
+///		underlying filesystem is paid outside of s_mutexNetCDF.
+///	</summary>
+static void PrefetchFileHeader(
+	const std::string & strFilename
+) {
+	static const size_t PrefetchBytes = 65536;
+
+	int fd = open(strFilename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return;
+	}
+	std::vector<char> vecBuffer(PrefetchBytes);
+	ssize_t nRead = pread(fd, &(vecBuffer[0]), PrefetchBytes, 0);
+	(void)nRead;
+	close(fd);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Number of values of a dimension variable read at a time when it
+///		is summarized.
+///	</summary>
+static const long SummarizeBlockSize = 65536;
+
+///	<summary>
+///		Read values of a one-dimensional NcVar from its current position.
+///	</summary>
+template <typename T>
+static void NcVarGetValues(
+	NcVar * var,
+	T * pValues,
+	long lCount
+) {
+	var->get(pValues, lCount);
+}
+
+///	<summary>
+///		Read values of an unsigned type, which the C++ interface only
+///		reads through 64-bit integers.
+///	</summary>
+template <typename T>
+static void NcVarGetWidened(
+	NcVar * var,
+	T * pValues,
+	long lCount
+) {
+	std::vector<ncint64> vecWide(lCount);
+	var->get(&(vecWide[0]), lCount);
+	for (long i = 0; i < lCount; i++) {
+		pValues[i] = static_cast<T>(vecWide[i]);
+	}
+}
+
+static void NcVarGetValues(
+	NcVar * var,
+	unsigned char * pValues,
+	long lCount
+) {
+	NcVarGetWidened(var, pValues, lCount);
+}
+
+static void NcVarGetValues(
+	NcVar * var,
+	unsigned short * pValues,
+	long lCount
+) {
+	NcVarGetWidened(var, pValues, lCount);
+}
+
+static void NcVarGetValues(
+	NcVar * var,
+	unsigned int * pValues,
+	long lCount
+) {
+	NcVarGetWidened(var, pValues, lCount);
+}
+
+///	<summary>
+///		Kernel reading all values of a dimension variable.
+///	</summary>
+struct NcVarReadKernel {
+	NcVar * var;
+	long lSize;
+	TypedValueArray & values;
+
+	template <typename T>
+	void Apply() {
+		values.Resize(NcValueTraits<T>::Type, lSize);
+		if (lSize != 0) {
+			var->set_cur((long)0);
+			NcVarGetValues(var, values.Data<T>(), lSize);
+		}
+	}
+};
+
+///	<summary>
+///		Kernel summarizing the values of a dimension variable a block at
+///		a time.
+///	</summary>
+struct NcVarSummarizeKernel {
+	NcVar * var;
+	long lSize;
+	SubAxisSummary & summary;
+
+	template <typename T>
+	void Apply() {
+		std::vector<T> vecBlock(std::min(lSize, SummarizeBlockSize));
+		for (long lBegin = 0; lBegin < lSize; lBegin += SummarizeBlockSize) {
+			long lCount = std::min(SummarizeBlockSize, lSize - lBegin);
+			var->set_cur(lBegin);
+			NcVarGetValues(var, &(vecBlock[0]), lCount);
+			summary.Add(&(vecBlock[0]), lCount);
+		}
+	}
+};
+
+///	<summary>
+///		Kernel summarizing the values of a dimension variable of a
+///		ClassicNcFile a block at a time.
+///	</summary>
+struct ClassicSummarizeKernel {
+	const ClassicNcFile & ncclassic;
+	const ClassicNcVariable & var;
+	long lSize;
+	SubAxisSummary & summary;
+	bool fSuccess;
+
+	template <typename T>
+	void Apply() {
+		std::vector<T> vecBlock(std::min(lSize, SummarizeBlockSize));
+		for (long lBegin = 0; lBegin < lSize; lBegin += SummarizeBlockSize) {
+			long lCount = std::min(SummarizeBlockSize, lSize - lBegin);
+			if (!ncclassic.ReadValues(var, lBegin, lCount, &(vecBlock[0]))) {
+				fSuccess = false;
+				return;
+			}
+			summary.Add(&(vecBlock[0]), lCount);
+		}
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool FileHeader::ExtractClassic(
+	const std::string & strFilename,
+	size_t sSummarizeSize,
+	bool fStatistics
+) {
+	Profiler & profiler = Profiler::Shared();
+	Profiler::Clock::time_point tBegin = Profiler::Clock::now();
+
+	ClassicNcFile ncclassic;
+	if (ncclassic.Open(strFilename) != ClassicNcStatus_Success) {
+		return false;
+	}
+
+	// Handles to the file held by the pool may be stale
+	{
+		NetCDFHeaderLock lockNetCDF;
+		NcFilePool::Shared().Evict(strFilename);
+	}
+
+	const double dOpenTime = Profiler::SecondsSince(tBegin);
+	tBegin = Profiler::Clock::now();
+
+	// Load in global attributes
+	const ClassicNcAttributeVector & vecAtts = ncclassic.GetAttributes();
+	std::string strValue;
+	for (size_t a = 0; a < vecAtts.size(); a++) {
+		if (vecAtts[a].m_strName == "units") {
+			continue;
+		}
+		if (!vecAtts[a].AsString(strValue)) {
+			continue;
+		}
+		m_datainfo.InsertFileAttribute(vecAtts[a].m_strName, strValue);
+	}
+
+	// Load all dimensions and their dimension variables
+	const std::vector<ClassicNcDimension> & vecDims = ncclassic.GetDimensions();
+	const std::vector<ClassicNcVariable> & vecVars = ncclassic.GetVariables();
+
+	std::vector<ClassicNcValueRead> vecReads;
+
+	m_vecDimensions.resize(vecDims.size());
+	for (size_t d = 0; d < vecDims.size(); d++) {
+		DimensionHeader & dimheader = m_vecDimensions[d];
+
+		dimheader.m_strName = vecDims[d].m_strName;
+		dimheader.m_lSize = static_cast<long>(vecDims[d].m_ullSize);
+
+		int iVarDim = ncclassic.FindVariable(dimheader.m_strName);
+		if (iVarDim < 0) {
+			continue;
+		}
+		const ClassicNcVariable & varDim = vecVars[iVarDim];
+		dimheader.m_fHasVariable = true;
+		dimheader.m_varheader.FromClassicNcVar(ncclassic, varDim);
+
+		// Values are only needed from well-formed dimension variables;
+		// malformed ones are reported during the merge.
+		const VariableHeader & varheader = dimheader.m_varheader;
+		if ((varheader.m_vecDimNames.size() != 1) ||
+		    (varheader.m_vecDimNames[0] != dimheader.m_strName)
+		) {
+			continue;
+		}
+
+		const long lSize = dimheader.m_lSize;
+
+		// Summarize long dimension variables a block at a time, so
+		// memory use does not grow with the size of the grid
+		if ((sSummarizeSize != 0) &&
+		    (static_cast<size_t>(lSize) > sSummarizeSize) &&
+		    IsNumericNcType(varheader.m_nctype)
+		) {
+			ClassicSummarizeKernel kernel =
+				{ncclassic, varDim, lSize, dimheader.m_summary, true};
+			DispatchNumericNcType(varheader.m_nctype, kernel);
+			if (!kernel.fSuccess) {
+				return false;
+			}
+			dimheader.m_fSummarized = true;
+			profiler.AddCoordinateBytes(
+				static_cast<size_t>(lSize) * NcTypeValueSize(varheader.m_nctype));
+
+		} else if (IsNumericNcType(varheader.m_nctype)) {
+			dimheader.m_values.Resize(varheader.m_nctype, lSize);
+			if (lSize != 0) {
+				ClassicNcValueRead read = {&varDim, 0, static_cast<size_t>(lSize),
+					dimheader.m_values.RawData()};
+				vecReads.push_back(read);
+			}
+			profiler.AddCoordinateBytes(dimheader.m_values.GetBytes());
+		}
+	}
+
+	// Read the values of all dimension variables together, so the reads
+	// of a remote file are coalesced and issued in parallel
+	if (!ncclassic.ReadValues(vecReads)) {
+		return false;
+	}
+
+	// Load all variables
+	m_vecVariables.resize(vecVars.size());
+	for (size_t v = 0; v < vecVars.size(); v++) {
+		m_vecVariables[v].FromClassicNcVar(ncclassic, vecVars[v]);
+	}
+
+	// Read the values of all variables for their statistics
+	if (fStatistics) {
+		m_vecStatistics.resize(vecVars.size());
+		for (size_t v = 0; v < vecVars.size(); v++) {
+			if (!m_vecStatistics[v].FromClassicNcVar(ncclassic, vecVars[v])) {
+				return false;
+			}
+		}
+	}
+
+	m_dOpenTime = dOpenTime;
+	profiler.AddFileStage(ProfilerFileStage_Open, m_dOpenTime);
+	m_dHeaderTime = Profiler::SecondsSince(tBegin);
+	profiler.AddFileStage(ProfilerFileStage_Header, m_dHeaderTime);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FileHeader::Extract(
+	const std::string & strFilename,
+	size_t sSummarizeSize,
+	bool fNativeClassic,
+	bool fStatistics
+) {
+	m_strFilename = strFilename;
+	m_stamp.FromFile(strFilename);
+
+	// Decode classic format files directly, falling back to the NetCDF
+	// library for other files and anything the decoder cannot handle
+	const bool fRemote = IsRemoteURL(strFilename);
+	if (fNativeClassic || fRemote) {
+		try {
+			if (ExtractClassic(strFilename, sSummarizeSize, fStatistics)) {
+				return;
+			}
+		} catch(...) {
+		}
+		m_datainfo = DataObjectInfo();
+		m_vecDimensions.clear();
+		m_vecVariables.clear();
+		m_vecStatistics.clear();
+	}
+
+	try {
+		NetCDFHeaderLock lockNetCDF;
+
+		// Remote files are read by the library with byte-range requests
+		std::string strOpenName = strFilename;
+		if (fRemote) {
+			strOpenName =
+				RemoteFileClient::Shared().GetHTTPURL(strFilename)
+				+ std::string("#mode=bytes");
+		}
+
+		// Open the NetCDF file, which may have changed since it was last
+		// opened through the pool
+		NcFilePool & pool = NcFilePool::Shared();
+		pool.Evict(strOpenName);
+
+		Profiler & profiler = Profiler::Shared();
+		Profiler::Clock::time_point tBegin = Profiler::Clock::now();
+
+		NcFilePool::Handle handle;
+		m_strError = pool.Open(strOpenName, handle);
+		if (m_strError != "") {
+			return;
+		}
+		NcFile & ncFile = *handle;
+
+		m_dOpenTime = Profiler::SecondsSince(tBegin);
+		profiler.AddFileStage(ProfilerFileStage_Open, m_dOpenTime);
+		tBegin = Profiler::Clock::now();
+
+		// Load in global attributes
+		m_datainfo.FromNcFile(&ncFile);
+
+		// Load all dimensions and their dimension variables
+		const int nDims = ncFile.num_dims();
+		m_vecDimensions.resize(nDims);
+		for (int d = 0; d < nDims; d++) {
+			NcDim * dim = ncFile.get_dim(d);
+			DimensionHeader & dimheader = m_vecDimensions[d];
+
+			dimheader.m_strName = dim->name();
+			dimheader.m_lSize = dim->size();
+
+			NcVar * varDim = ncFile.get_var(dimheader.m_strName.c_str());
+			if (varDim == NULL) {
+				continue;
+			}
+			dimheader.m_fHasVariable = true;
+			dimheader.m_varheader.FromNcVar(&ncFile, varDim);
+
+			// Values are only needed from well-formed dimension variables;
+			// malformed ones are reported during the merge.
+			const VariableHeader & varheader = dimheader.m_varheader;
+			if ((varheader.m_vecDimNames.size() != 1) ||
+			    (varheader.m_vecDimNames[0] != dimheader.m_strName)
+			) {
+				continue;
+			}
+
+			const long lSize = dimheader.m_lSize;
+
+			// Summarize long dimension variables a block at a time, so
+			// memory use does not grow with the size of the grid
+			if ((sSummarizeSize != 0) &&
+			    (static_cast<size_t>(lSize) > sSummarizeSize) &&
+			    IsNumericNcType(varheader.m_nctype)
+			) {
+				NcVarSummarizeKernel kernel = {varDim, lSize, dimheader.m_summary};
+				DispatchNumericNcType(varheader.m_nctype, kernel);
+				dimheader.m_fSummarized = true;
+				profiler.AddCoordinateBytes(
+					static_cast<size_t>(lSize) * NcTypeValueSize(varheader.m_nctype));
+
+			} else if (IsNumericNcType(varheader.m_nctype)) {
+				NcVarReadKernel kernel = {varDim, lSize, dimheader.m_values};
+				DispatchNumericNcType(varheader.m_nctype, kernel);
+				profiler.AddCoordinateBytes(dimheader.m_values.GetBytes());
+			}
+		}
+
+		// Load all variables
+		const int nVariables = ncFile.num_vars();
+		m_vecVariables.resize(nVariables);
+		for (int v = 0; v < nVariables; v++) {
+			NcVar * var = ncFile.get_var(v);
+			if (var == NULL) {
+				_EXCEPTION1("Malformed NetCDF file \"%s\"",
+					strFilename.c_str());
+			}
+			m_vecVariables[v].FromNcVar(&ncFile, var);
+		}
+
+		// Read the values of all variables for their statistics
+		if (fStatistics) {
+			m_vecStatistics.resize(nVariables);
+			for (int v = 0; v < nVariables; v++) {
+				m_strError =
+					m_vecStatistics[v].FromNcVar(ncFile.id(), ncFile.get_var(v)->id());
+				if (m_strError != "") {
+					m_strError += " \"" + m_vecVariables[v].m_strName + "\"";
+					return;
+				}
+			}
+		}
+
+		m_dHeaderTime = Profiler::SecondsSince(tBegin);
+		profiler.AddFileStage(ProfilerFileStage_Header, m_dHeaderTime);
+
+	} catch(...) {
+		m_exception = std::current_exception();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+static void BufferWrite(
+	std::vector<char> & vecBuffer,
+	const T & t
+) {
+	const char * p = reinterpret_cast<const char *>(&t);
+	vecBuffer.insert(vecBuffer.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+static void BufferWrite(
+	std::vector<char> & vecBuffer,
+	const std::vector<T> & vec
+) {
+	BufferWrite<size_t>(vecBuffer, vec.size());
+	const char * p = reinterpret_cast<const char *>(vec.data());
+	vecBuffer.insert(vecBuffer.end(), p, p + vec.size() * sizeof(T));
+}
+
+static void BufferWrite(
+	std::vector<char> & vecBuffer,
+	const std::string & str
+) {
+	BufferWrite<size_t>(vecBuffer, str.length());
+	vecBuffer.insert(vecBuffer.end(), str.begin(), str.end());
+}
+
+static void BufferWrite(
+	std::vector<char> & vecBuffer,
+	const InternedString & str
+) {
+	BufferWrite(vecBuffer, str.str());
+}
+
+static void BufferWrite(
+	std::vector<char> & vecBuffer,
+	const AttributeMap & mapAttributes
+) {
+	BufferWrite<size_t>(vecBuffer, mapAttributes.size());
+	AttributeMap::const_iterator iter = mapAttributes.begin();
+	for (; iter != mapAttributes.end(); iter++) {
+		BufferWrite(vecBuffer, iter->first);
+		BufferWrite(vecBuffer, iter->second);
+	}
+}
+
+static void BufferWrite(
+	std::vector<char> & vecBuffer,
+	const TypedValueArray & values
+) {
+	BufferWrite<int>(vecBuffer, static_cast<int>(values.GetType()));
+	BufferWrite<size_t>(vecBuffer, values.size());
+	const char * p = static_cast<const char *>(values.RawData());
+	vecBuffer.insert(vecBuffer.end(), p, p + values.GetBytes());
+}
+
+static void BufferWrite(
+	std::vector<char> & vecBuffer,
+	const VariableStorage & storage
+) {
+	BufferWrite<int>(vecBuffer, static_cast<int>(storage.m_eLayout));
+	BufferWrite(vecBuffer, storage.m_vecChunkSizes);
+	BufferWrite<int>(vecBuffer, storage.m_iDeflateLevel);
+	BufferWrite<char>(vecBuffer, (storage.m_fShuffle)?(1):(0));
+	BufferWrite<char>(vecBuffer, (storage.m_fFletcher32)?(1):(0));
+	BufferWrite<int>(vecBuffer, static_cast<int>(storage.m_eEndian));
+	BufferWrite<unsigned int>(vecBuffer, storage.m_uFilterId);
+}
+
+static void BufferWrite(
+	std::vector<char> & vecBuffer,
+	const VariableHeader & varheader
+) {
+	BufferWrite(vecBuffer, varheader.m_strName);
+	BufferWrite<int>(vecBuffer, static_cast<int>(varheader.m_nctype));
+	BufferWrite(vecBuffer, varheader.m_strUnits);
+	BufferWrite<size_t>(vecBuffer, varheader.m_vecAttributes.size());
+	for (size_t a = 0; a < varheader.m_vecAttributes.size(); a++) {
+		BufferWrite(vecBuffer, varheader.m_vecAttributes[a].first);
+		BufferWrite(vecBuffer, varheader.m_vecAttributes[a].second);
+	}
+	BufferWrite<size_t>(vecBuffer, varheader.m_vecDimNames.size());
+	for (size_t d = 0; d < varheader.m_vecDimNames.size(); d++) {
+		BufferWrite(vecBuffer, varheader.m_vecDimNames[d]);
+	}
+	BufferWrite(vecBuffer, varheader.m_storage);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void BufferCheck(
+	const std::vector<char> & vecBuffer,
+	size_t sPos,
+	size_t sBytes
+) {
+	if (sPos + sBytes > vecBuffer.size()) {
+		_EXCEPTIONT("Truncated FileHeader buffer");
+	}
+}
+
+template <typename T>
+static void BufferRead(
+	const std::vector<char> & vecBuffer,
+	size_t & sPos,
+	T & t
+) {
+	BufferCheck(vecBuffer, sPos, sizeof(T));
+	memcpy(&t, &(vecBuffer[sPos]), sizeof(T));
+	sPos += sizeof(T);
+}
+
+template <typename T>
+static void BufferRead(
+	const std::vector<char> & vecBuffer,
+	size_t & sPos,
+	std::vector<T> & vec
+) {
+	size_t sSize;
+	BufferRead<size_t>(vecBuffer, sPos, sSize);
+	BufferCheck(vecBuffer, sPos, sSize * sizeof(T));
+	vec.resize(sSize);
+	if (sSize != 0) {
+		memcpy(vec.data(), &(vecBuffer[sPos]), sSize * sizeof(T));
+	}
+	sPos += sSize * sizeof(T);
+}
+
+static void BufferRead(
+	const std::vector<char> & vecBuffer,
+	size_t & sPos,
+	std::string & str
+) {
+	size_t sLength;
+	BufferRead<size_t>(vecBuffer, sPos, sLength);
+	BufferCheck(vecBuffer, sPos, sLength);
+	str.assign(vecBuffer.begin() + sPos, vecBuffer.begin() + sPos + sLength);
+	sPos += sLength;
+}
+
+static void BufferRead(
+	const std::vector<char> & vecBuffer,
+	size_t & sPos,
+	InternedString & str
+) {
+	std::string strValue;
+	BufferRead(vecBuffer, sPos, strValue);
+	str = InternedString(strValue);
+}
+
+static void BufferRead(
+	const std::vector<char> & vecBuffer,
+	size_t & sPos,
+	AttributeMap & mapAttributes
+) {
+	size_t sCount;
+	BufferRead<size_t>(vecBuffer, sPos, sCount);
+	for (size_t i = 0; i < sCount; i++) {
+		InternedString strKey;
+		InternedString strValue;
+		BufferRead(vecBuffer, sPos, strKey);
+		BufferRead(vecBuffer, sPos, strValue);
+		mapAttributes.insert(AttributeMap::value_type(strKey, strValue));
+	}
+}
+
+static void BufferRead(
+	const std::vector<char> & vecBuffer,
+	size_t & sPos,
+	TypedValueArray & values
+) {
+	int iType;
+	size_t sSize;
+	BufferRead<int>(vecBuffer, sPos, iType);
+	BufferRead<size_t>(vecBuffer, sPos, sSize);
+	if (static_cast<NcType>(iType) == ncNoType) {
+		values.Clear();
+		return;
+	}
+	const size_t sValueSize = NcTypeValueSize(static_cast<NcType>(iType));
+	if ((sValueSize == 0) || (sSize > vecBuffer.size() / sValueSize)) {
+		_EXCEPTIONT("Invalid FileHeader buffer");
+	}
+	BufferCheck(vecBuffer, sPos, sSize * sValueSize);
+	values.Resize(static_cast<NcType>(iType), sSize);
+	if (sSize != 0) {
+		memcpy(values.RawData(), &(vecBuffer[sPos]), sSize * sValueSize);
+	}
+	sPos += sSize * sValueSize;
+}
+
+static void BufferRead(
+	const std::vector<char> & vecBuffer,
+	size_t & sPos,
+	VariableStorage & storage
+) {
+	int iLayout;
+	int iEndian;
+	char cShuffle;
+	char cFletcher32;
+	BufferRead<int>(vecBuffer, sPos, iLayout);
+	BufferRead(vecBuffer, sPos, storage.m_vecChunkSizes);
+	BufferRead<int>(vecBuffer, sPos, storage.m_iDeflateLevel);
+	BufferRead<char>(vecBuffer, sPos, cShuffle);
+	BufferRead<char>(vecBuffer, sPos, cFletcher32);
+	BufferRead<int>(vecBuffer, sPos, iEndian);
+	BufferRead<unsigned int>(vecBuffer, sPos, storage.m_uFilterId);
+	storage.m_eLayout = static_cast<VariableStorage::Layout>(iLayout);
+	storage.m_fShuffle = (cShuffle != 0);
+	storage.m_fFletcher32 = (cFletcher32 != 0);
+	storage.m_eEndian = static_cast<VariableStorage::Endian>(iEndian);
+}
+
+static void BufferRead(
+	const std::vector<char> & vecBuffer,
+	size_t & sPos,
+	VariableHeader & varheader
+) {
+	int iType;
+	BufferRead(vecBuffer, sPos, varheader.m_strName);
+	BufferRead<int>(vecBuffer, sPos, iType);
+	varheader.m_nctype = static_cast<NcType>(iType);
+	BufferRead(vecBuffer, sPos, varheader.m_strUnits);
+
+	size_t sCount;
+	BufferRead<size_t>(vecBuffer, sPos, sCount);
+	varheader.m_vecAttributes.resize(sCount);
+	for (size_t a = 0; a < sCount; a++) {
+		BufferRead(vecBuffer, sPos, varheader.m_vecAttributes[a].first);
+		BufferRead(vecBuffer, sPos, varheader.m_vecAttributes[a].second);
+	}
+	BufferRead<size_t>(vecBuffer, sPos, sCount);
+	varheader.m_vecDimNames.resize(sCount);
+	for (size_t d = 0; d < sCount; d++) {
+		BufferRead(vecBuffer, sPos, varheader.m_vecDimNames[d]);
+	}
+	BufferRead(vecBuffer, sPos, varheader.m_storage);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool FileHeader::HasValuesFor(
+	size_t sSummarizeSize
+) const {
+	for (size_t d = 0; d < m_vecDimensions.size(); d++) {
+		const DimensionHeader & dimheader = m_vecDimensions[d];
+		if (dimheader.m_fSummarized &&
+		   ((sSummarizeSize == 0) ||
+		    (static_cast<size_t>(dimheader.m_lSize) <= sSummarizeSize))
+		) {
+			return false;
+		}
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string SubAxis::LoadValues(
+	const std::string & strVariableName
+) {
+	if (!m_fSummarized) {
+		return std::string("");
+	}
+
+	TypedValueArray values;
+	{
+		std::lock_guard<std::mutex> lockNetCDF(s_mutexNetCDF);
+
+		NcFilePool::Handle handle;
+		std::string strError =
+			NcFilePool::Shared().Open(m_strSourceFile, handle);
+		if (strError != "") {
+			return strError;
+		}
+		NcFile & ncFile = *handle;
+		NcVar * varDim = ncFile.get_var(strVariableName.c_str());
+		if ((varDim == NULL) ||
+		    (varDim->num_dims() != 1) ||
+		    (varDim->type() != m_nctype) ||
+		    (varDim->get_dim(0)->size() != m_lSize)
+		) {
+			return std::string("Dimension variable \"") + strVariableName
+				+ std::string("\" in \"") + m_strSourceFile
+				+ std::string("\" does not match the index");
+		}
+
+		NcVarReadKernel kernel = {varDim, m_lSize, values};
+		DispatchNumericNcType(m_nctype, kernel);
+	}
+	Profiler::Shared().AddCoordinateBytes(values.GetBytes());
+
+	// Check the values are still the ones that were summarized
+	SubAxisSummary summary;
+	ValuesSummaryKernel kernel = {summary, values};
+	DispatchNumericNcType(m_nctype, kernel);
+	if (!(summary == m_summary)) {
+		return std::string("Dimension variable \"") + strVariableName
+			+ std::string("\" in \"") + m_strSourceFile
+			+ std::string("\" changed since it was indexed");
+	}
+
+	m_values.swap(values);
+	m_fSummarized = false;
+	DetectLinear();
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string FileHeader::GetError() const {
+	if (m_exception) {
+		try {
+			std::rethrow_exception(m_exception);
+		} catch(Exception & e) {
+			return e.ToString();
+		} catch(...) {
+			return std::string("Unknown exception reading \"")
+				+ m_strFilename + std::string("\"");
+		}
+	}
+	return m_strError;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FileHeader::ToBuffer(
+	std::vector<char> & vecBuffer
+) const {
+	std::string strError = GetError();
+
+	BufferWrite(vecBuffer, m_strFilename);
+	BufferWrite<FileStamp>(vecBuffer, m_stamp);
+	BufferWrite(vecBuffer, strError);
+	BufferWrite(vecBuffer, m_datainfo.m_mapKeyAttributes);
+	BufferWrite(vecBuffer, m_datainfo.m_mapOtherAttributes);
+
+	BufferWrite<size_t>(vecBuffer, m_vecDimensions.size());
+	for (size_t d = 0; d < m_vecDimensions.size(); d++) {
+		const DimensionHeader & dimheader = m_vecDimensions[d];
+		BufferWrite(vecBuffer, dimheader.m_strName);
+		BufferWrite<long>(vecBuffer, dimheader.m_lSize);
+		BufferWrite<char>(vecBuffer, dimheader.m_fHasVariable ? 1 : 0);
+		BufferWrite(vecBuffer, dimheader.m_varheader);
+		BufferWrite(vecBuffer, dimheader.m_values);
+		BufferWrite<char>(vecBuffer, dimheader.m_fSummarized ? 1 : 0);
+		BufferWrite<SubAxisSummary>(vecBuffer, dimheader.m_summary);
+	}
+
+	BufferWrite<size_t>(vecBuffer, m_vecVariables.size());
+	for (size_t v = 0; v < m_vecVariables.size(); v++) {
+		BufferWrite(vecBuffer, m_vecVariables[v]);
+	}
+	BufferWrite<VariableStatistics>(vecBuffer, m_vecStatistics);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FileHeader::FromBuffer(
+	const std::vector<char> & vecBuffer,
+	size_t & sPos
+) {
+	BufferRead(vecBuffer, sPos, m_strFilename);
+	BufferRead<FileStamp>(vecBuffer, sPos, m_stamp);
+	BufferRead(vecBuffer, sPos, m_strError);
+	BufferRead(vecBuffer, sPos, m_datainfo.m_mapKeyAttributes);
+	BufferRead(vecBuffer, sPos, m_datainfo.m_mapOtherAttributes);
+
+	size_t sCount;
+	BufferRead<size_t>(vecBuffer, sPos, sCount);
+	m_vecDimensions.resize(sCount);
+	for (size_t d = 0; d < sCount; d++) {
+		DimensionHeader & dimheader = m_vecDimensions[d];
+		char cHasVariable;
+		BufferRead(vecBuffer, sPos, dimheader.m_strName);
+		BufferRead<long>(vecBuffer, sPos, dimheader.m_lSize);
+		BufferRead<char>(vecBuffer, sPos, cHasVariable);
+		dimheader.m_fHasVariable = (cHasVariable != 0);
+		BufferRead(vecBuffer, sPos, dimheader.m_varheader);
+		BufferRead(vecBuffer, sPos, dimheader.m_values);
+		char cSummarized;
+		BufferRead<char>(vecBuffer, sPos, cSummarized);
+		dimheader.m_fSummarized = (cSummarized != 0);
+		BufferRead<SubAxisSummary>(vecBuffer, sPos, dimheader.m_summary);
+	}
+
+	BufferRead<size_t>(vecBuffer, sPos, sCount);
+	m_vecVariables.resize(sCount);
+	for (size_t v = 0; v < sCount; v++) {
+		BufferRead(vecBuffer, sPos, m_vecVariables[v]);
+	}
+	BufferRead<VariableStatistics>(vecBuffer, sPos, m_vecStatistics);
+}
+
+///	<summary>
+///		Mix a value into a 64-bit FNV-1a hash.
+///	</summary>
+static void HeaderHashCombine(
+	unsigned long long & ullHash,
+	unsigned long long ullValue
+) {
+	for (int i = 0; i < 8; i++) {
+		ullHash ^= (ullValue & 0xff);
+		ullHash *= 1099511628211ULL;
+		ullValue >>= 8;
+	}
+}
+
+///	<summary>
+///		Mix a string into a 64-bit FNV-1a hash.
+///	</summary>
+static void HeaderHashCombine(
+	unsigned long long & ullHash,
+	const std::string & str
+) {
+	for (size_t i = 0; i < str.length(); i++) {
+		ullHash ^= static_cast<unsigned char>(str[i]);
+		ullHash *= 1099511628211ULL;
+	}
+	HeaderHashCombine(ullHash, static_cast<unsigned long long>(str.length()));
+}
+
+///	<summary>
+///		Mix the header of a variable into a 64-bit FNV-1a hash.  Attribute
+///		names and values are hashed by their text rather than their pooled
+///		handles, since a freed pooled string may be reused and hashes are
+///		kept across runs.
+///	</summary>
+static void HeaderHashCombine(
+	unsigned long long & ullHash,
+	const VariableHeader & varheader,
+	bool fValues
+) {
+	HeaderHashCombine(ullHash, varheader.m_strName);
+	HeaderHashCombine(ullHash, static_cast<unsigned long long>(varheader.m_nctype));
+	HeaderHashCombine(ullHash, static_cast<unsigned long long>(varheader.m_vecDimNames.size()));
+	for (size_t d = 0; d < varheader.m_vecDimNames.size(); d++) {
+		HeaderHashCombine(ullHash, varheader.m_vecDimNames[d]);
+	}
+	HeaderHashCombine(ullHash, static_cast<unsigned long long>(varheader.m_vecAttributes.size()));
+	for (size_t a = 0; a < varheader.m_vecAttributes.size(); a++) {
+		HeaderHashCombine(ullHash, varheader.m_vecAttributes[a].first.str());
+		if (fValues) {
+			HeaderHashCombine(ullHash, varheader.m_vecAttributes[a].second.str());
+		}
+	}
+	if (fValues) {
+		HeaderHashCombine(ullHash, varheader.m_strUnits);
+
+		const VariableStorage & storage = varheader.m_storage;
+		HeaderHashCombine(ullHash, static_cast<unsigned long long>(storage.m_eLayout));
+		HeaderHashCombine(ullHash, static_cast<unsigned long long>(storage.m_vecChunkSizes.size()));
+		for (size_t d = 0; d < storage.m_vecChunkSizes.size(); d++) {
+			HeaderHashCombine(ullHash, static_cast<unsigned long long>(storage.m_vecChunkSizes[d]));
+		}
+		HeaderHashCombine(ullHash, static_cast<unsigned long long>(storage.m_iDeflateLevel));
+		HeaderHashCombine(ullHash, (storage.m_fShuffle)?(1ULL):(0ULL));
+		HeaderHashCombine(ullHash, (storage.m_fFletcher32)?(1ULL):(0ULL));
+		HeaderHashCombine(ullHash, static_cast<unsigned long long>(storage.m_eEndian));
+		HeaderHashCombine(ullHash, static_cast<unsigned long long>(storage.m_uFilterId));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Hash the dimensions and variables of a FileHeader, with or without
+///		the units, attribute values and storage layout of its variables.
+///	</summary>
+static unsigned long long FileHeaderHash(
+	const FileHeader & header,
+	bool fValues
+) {
+	unsigned long long ullHash = 14695981039346656037ULL;
+
+	HeaderHashCombine(ullHash, static_cast<unsigned long long>(header.m_vecDimensions.size()));
+	for (size_t d = 0; d < header.m_vecDimensions.size(); d++) {
+		const DimensionHeader & dimheader = header.m_vecDimensions[d];
+		HeaderHashCombine(ullHash, dimheader.m_strName);
+		HeaderHashCombine(ullHash, (dimheader.m_fHasVariable)?(1ULL):(0ULL));
+		if (dimheader.m_fHasVariable) {
+			HeaderHashCombine(ullHash, dimheader.m_varheader, fValues);
+		}
+	}
+
+	HeaderHashCombine(ullHash, static_cast<unsigned long long>(header.m_vecVariables.size()));
+	for (size_t v = 0; v < header.m_vecVariables.size(); v++) {
+		HeaderHashCombine(ullHash, header.m_vecVariables[v], fValues);
+	}
+
+	return ullHash;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned long long FileHeader::GetStructureHash() const {
+	return FileHeaderHash(*this, false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned long long FileHeader::GetHeaderHash() const {
+	return FileHeaderHash(*this, true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// FileHeaderCache
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Magic string at the start of each cache entry.  The version number
+///		must be incremented whenever the FileHeader buffer format changes.
+///	</summary>
+static const char s_szCacheMagic[8] = {'A','C','F','H','D','R','0','5'};
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string FileHeaderCache::Initialize() {
+	struct stat statDir;
+	if (stat(m_strCacheDir.c_str(), &statDir) == 0) {
+		if (!S_ISDIR(statDir.st_mode)) {
+			return std::string("Cache path \"") + m_strCacheDir
+				+ std::string("\" is not a directory");
+		}
+		return std::string("");
+	}
+	if ((mkdir(m_strCacheDir.c_str(), 0777) != 0) && (errno != EEXIST)) {
+		return std::string("Unable to create cache directory \"")
+			+ m_strCacheDir + std::string("\"");
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string FileHeaderCache::GetKey(
+	const std::string & strFilename
+) const {
+
+	// Remote files are identified by a hash of their URL in place of the
+	// device and inode
+	if (IsRemoteURL(strFilename)) {
+		FileStamp stamp;
+		if (!stamp.FromFile(strFilename)) {
+			return std::string("");
+		}
+		unsigned long long ullHash = 14695981039346656037ULL;
+		HeaderHashCombine(ullHash, strFilename);
+
+		char szKey[128];
+		snprintf(szKey, sizeof(szKey), "0-%llx-%llx-%llx",
+			ullHash,
+			static_cast<unsigned long long>(stamp.m_llSize),
+			static_cast<unsigned long long>(stamp.m_llModTime));
+
+		return std::string(szKey);
+	}
+
+	struct stat statFile;
+	if (stat(strFilename.c_str(), &statFile) != 0) {
+		return std::string("");
+	}
+
+	FileStamp stamp;
+	stamp.FromFile(strFilename);
+
+	char szKey[128];
+	snprintf(szKey, sizeof(szKey), "%llx-%llx-%llx-%llx",
+		static_cast<unsigned long long>(statFile.st_dev),
+		stamp.m_ullInode,
+		static_cast<unsigned long long>(stamp.m_llSize),
+		static_cast<unsigned long long>(stamp.m_llModTime));
+
+	return std::string(szKey);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string FileHeaderCache::GetEntryPath(
+	const std::string & strKey
+) const {
+	// Spread entries over 256 subdirectories by the low byte of the inode
+	size_t sInodeEnd = strKey.find('-', strKey.find('-') + 1);
+	std::string strSubDir = strKey.substr(sInodeEnd - 2, 2);
+	if (strSubDir[0] == '-') {
+		strSubDir[0] = '0';
+	}
+	return m_strCacheDir + "/" + strSubDir + "/" + strKey;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool FileHeaderCache::Contains(
+	const std::string & strKey
+) const {
+	struct stat statEntry;
+	return (stat(GetEntryPath(strKey).c_str(), &statEntry) == 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool FileHeaderCache::Load(
+	const std::string & strKey,
+	const std::string & strFilename,
+	size_t sSummarizeSize,
+	bool fStatistics,
+	FileHeader & header
+) {
+	std::ifstream ifs(GetEntryPath(strKey).c_str(), std::ios::binary);
+	if (!ifs.is_open()) {
+		m_sMisses++;
+		return false;
+	}
+
+	std::vector<char> vecBuffer(
+		(std::istreambuf_iterator<char>(ifs)),
+		std::istreambuf_iterator<char>());
+
+	try {
+		size_t sPos = sizeof(s_szCacheMagic);
+		if ((vecBuffer.size() < sPos) ||
+		    (memcmp(&(vecBuffer[0]), s_szCacheMagic, sPos) != 0)
+		) {
+			m_sMisses++;
+			return false;
+		}
+
+		std::string strStoredKey;
+		BufferRead(vecBuffer, sPos, strStoredKey);
+		if (strStoredKey != strKey) {
+			m_sMisses++;
+			return false;
+		}
+
+		FileHeader headerCached;
+		headerCached.FromBuffer(vecBuffer, sPos);
+		if (sPos != vecBuffer.size()) {
+			m_sMisses++;
+			return false;
+		}
+
+		// Values summarized below the current size are not usable
+		if (!headerCached.HasValuesFor(sSummarizeSize)) {
+			m_sMisses++;
+			return false;
+		}
+
+		// Statistics are only stored if they were computed
+		if (fStatistics &&
+		    (headerCached.m_vecStatistics.size() != headerCached.m_vecVariables.size())
+		) {
+			m_sMisses++;
+			return false;
+		}
+		if (!fStatistics) {
+			headerCached.m_vecStatistics.clear();
+		}
+
+		// The same file may be reached through a different path
+		header = headerCached;
+		header.m_strFilename = strFilename;
+
+	} catch(Exception & e) {
+		m_sMisses++;
+		return false;
+	}
+
+	m_sHits++;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FileHeaderCache::Store(
+	const std::string & strKey,
+	const FileHeader & header
+) const {
+	if ((header.m_strError != "") || (header.m_exception)) {
+		return;
+	}
+
+	// Do not store the header if the file changed while it was extracted
+	if (GetKey(header.m_strFilename) != strKey) {
+		return;
+	}
+
+	std::vector<char> vecBuffer(s_szCacheMagic,
+		s_szCacheMagic + sizeof(s_szCacheMagic));
+	BufferWrite(vecBuffer, strKey);
+	header.ToBuffer(vecBuffer);
+
+	std::string strEntryPath = GetEntryPath(strKey);
+	std::string strSubDir = strEntryPath.substr(0, strEntryPath.rfind('/'));
+	mkdir(strSubDir.c_str(), 0777);
+
+	// Write to a temporary file and rename so that concurrent jobs
+	// never see a partial entry
+	char szSuffix[64];
+	snprintf(szSuffix, sizeof(szSuffix), ".tmp.%d.%lx",
+		static_cast<int>(getpid()),
+		static_cast<unsigned long>(
+			std::hash<std::thread::id>()(std::this_thread::get_id())));
+	std::string strTempPath = strEntryPath + szSuffix;
+
+	std::ofstream ofs(strTempPath.c_str(), std::ios::binary);
+	if (!ofs.is_open()) {
+		return;
+	}
+	ofs.write(&(vecBuffer[0]), vecBuffer.size());
+	ofs.close();
+	if (!ofs) {
+		unlink(strTempPath.c_str());
+		return;
+	}
+	if (rename(strTempPath.c_str(), strEntryPath.c_str()) != 0) {
+		unlink(strTempPath.c_str());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// IndexDedupState
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Magic string at the start of a deduplication state file.  The
+///		version number is increased whenever the format changes.
+///	</summary>
+static const char s_szDedupStateMagic[8] = {'A','C','D','E','D','U','P','1'};
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexDedupState::GetPath(
+	const std::string & strIndexFilename
+) {
+	return strIndexFilename + std::string(".dedup");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexDedupState::ToFile(
+	const std::string & strFilename
+) const {
+	std::vector<char> vecBuffer(s_szDedupStateMagic,
+		s_szDedupStateMagic + sizeof(s_szDedupStateMagic));
+
+	BufferWrite(vecBuffer, m_stampIndex.m_llSize);
+	BufferWrite(vecBuffer, m_stampIndex.m_llModTime);
+	BufferWrite(vecBuffer, m_stampIndex.m_ullInode);
+	BufferWrite<size_t>(vecBuffer, m_sInternedStrings);
+	BufferWrite<int>(vecBuffer, static_cast<int>(m_eValidationLevel));
+	BufferWrite(vecBuffer, m_vecValidatedHashes);
+
+	BufferWrite<size_t>(vecBuffer, m_mapSubAxisFingerprints.size());
+	AxisFingerprintIndexMap::const_iterator iterAxis =
+		m_mapSubAxisFingerprints.begin();
+	for (; iterAxis != m_mapSubAxisFingerprints.end(); iterAxis++) {
+		BufferWrite(vecBuffer, iterAxis->first);
+		BufferWrite<size_t>(vecBuffer, iterAxis->second.size());
+		AxisInfo::SubAxisFingerprintIndex::const_iterator iter =
+			iterAxis->second.begin();
+		for (; iter != iterAxis->second.end(); iter++) {
+			BufferWrite<size_t>(vecBuffer, iter->first);
+			BufferWrite(vecBuffer, iter->second);
+		}
+	}
+
+	// Write to a temporary file and rename so that a reader never sees
+	// a partial state
+	std::string strTempFilename = strFilename + std::string(".tmp");
+	std::ofstream ofs(strTempFilename.c_str(), std::ios::binary);
+	if (!ofs.is_open()) {
+		return std::string("ERROR: Unable to open \"")
+			+ strTempFilename + std::string("\" for writing");
+	}
+	ofs.write(&(vecBuffer[0]), vecBuffer.size());
+	ofs.close();
+	if (!ofs) {
+		unlink(strTempFilename.c_str());
+		return std::string("ERROR: Unable to write \"")
+			+ strTempFilename + std::string("\"");
+	}
+	if (rename(strTempFilename.c_str(), strFilename.c_str()) != 0) {
+		unlink(strTempFilename.c_str());
+		return std::string("ERROR: Unable to rename \"")
+			+ strTempFilename + std::string("\" to \"")
+			+ strFilename + std::string("\"");
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool IndexDedupState::FromFile(
+	const std::string & strFilename,
+	const std::string & strIndexFilename
+) {
+	std::ifstream ifs(strFilename.c_str(), std::ios::binary);
+	if (!ifs.is_open()) {
+		return false;
+	}
+
+	std::vector<char> vecBuffer(
+		(std::istreambuf_iterator<char>(ifs)),
+		std::istreambuf_iterator<char>());
+
+	try {
+		size_t sPos = sizeof(s_szDedupStateMagic);
+		if ((vecBuffer.size() < sPos) ||
+		    (memcmp(&(vecBuffer[0]), s_szDedupStateMagic, sPos) != 0)
+		) {
+			return false;
+		}
+
+		// The state only describes the index file it was saved with
+		BufferRead(vecBuffer, sPos, m_stampIndex.m_llSize);
+		BufferRead(vecBuffer, sPos, m_stampIndex.m_llModTime);
+		BufferRead(vecBuffer, sPos, m_stampIndex.m_ullInode);
+
+		FileStamp stampIndex;
+		if (!stampIndex.FromFile(strIndexFilename) ||
+		    !(stampIndex == m_stampIndex)
+		) {
+			return false;
+		}
+
+		int iValidationLevel;
+		BufferRead<size_t>(vecBuffer, sPos, m_sInternedStrings);
+		BufferRead<int>(vecBuffer, sPos, iValidationLevel);
+		m_eValidationLevel = static_cast<ValidationLevel>(iValidationLevel);
+		BufferRead(vecBuffer, sPos, m_vecValidatedHashes);
+
+		size_t sAxes;
+		BufferRead<size_t>(vecBuffer, sPos, sAxes);
+		m_mapSubAxisFingerprints.clear();
+		for (size_t a = 0; a < sAxes; a++) {
+			std::string strAxisName;
+			size_t sEntries;
+			BufferRead(vecBuffer, sPos, strAxisName);
+			BufferRead<size_t>(vecBuffer, sPos, sEntries);
+
+			AxisInfo::SubAxisFingerprintIndex & mapFingerprints =
+				m_mapSubAxisFingerprints[strAxisName];
+			mapFingerprints.reserve(sEntries);
+			for (size_t e = 0; e < sEntries; e++) {
+				size_t sFingerprint;
+				std::string strSubAxisId;
+				BufferRead<size_t>(vecBuffer, sPos, sFingerprint);
+				BufferRead(vecBuffer, sPos, strSubAxisId);
+				mapFingerprints.insert(
+					AxisInfo::SubAxisFingerprintIndex::value_type(
+						sFingerprint, strSubAxisId));
+			}
+		}
+		if (sPos != vecBuffer.size()) {
+			return false;
+		}
+
+	} catch(Exception & e) {
+		return false;
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool IndexDedupState::InstallSubAxisIndex(
+	AxisInfo & axisinfo
+) {
+	AxisFingerprintIndexMap::iterator iterAxis =
+		m_mapSubAxisFingerprints.find(axisinfo.m_strName);
+	if (iterAxis == m_mapSubAxisFingerprints.end()) {
+		return false;
+	}
+
+	// Each subaxis has one entry, so matching sizes and ids that all
+	// exist mean the saved index covers exactly the loaded subaxes
+	AxisInfo::SubAxisFingerprintIndex & mapFingerprints = iterAxis->second;
+	if (mapFingerprints.size() != axisinfo.m_vecSubAxis.size()) {
+		return false;
+	}
+	AxisInfo::SubAxisFingerprintIndex::const_iterator iter =
+		mapFingerprints.begin();
+	for (; iter != mapFingerprints.end(); iter++) {
+		if (axisinfo.m_vecSubAxis.find(iter->second) == axisinfo.m_vecSubAxis.end()) {
+			return false;
+		}
+	}
+
+	axisinfo.m_mapSubAxisFingerprints.swap(mapFingerprints);
+	m_mapSubAxisFingerprints.erase(iterAxis);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// IndexedDataset
+///////////////////////////////////////////////////////////////////////////////
+
+const size_t IndexedDataset::InvalidFileIx = (-1);
+
+///////////////////////////////////////////////////////////////////////////////
+
+const size_t IndexedDataset::InvalidTimeIx = (-1);
+
+///////////////////////////////////////////////////////////////////////////////
+
+const long IndexedDataset::InconsistentDimensionSizes = (-1);
+
+///////////////////////////////////////////////////////////////////////////////
+
+IndexedDataset::~IndexedDataset() {
+	JoinAbandonedWorkers(true);
+	if ((m_pcache != NULL) && m_fOwnsCache) {
+		delete m_pcache;
+	}
+	if (m_pspill != NULL) {
+		delete m_pspill;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t IndexedDataset::AddGridsToRegistry(
+	GridRegistry & gridregistry
+) const {
+	size_t sAdded = 0;
+	LookupVectorHeap<std::string, AxisInfo>::const_iterator iteraxis = m_vecAxisInfo.begin();
+	for (; iteraxis != m_vecAxisInfo.end(); iteraxis++) {
+		const AxisInfo * paxisinfo = *iteraxis;
+		if (paxisinfo->m_vecSubAxis.size() != 1) {
+			continue;
+		}
+		if (gridregistry.Insert(*(paxisinfo->m_vecSubAxis[0]))) {
+			sAdded++;
+		}
+	}
+	return sAdded;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Estimated bytes of a std::map or std::set node beside its value:
+///		three pointers and a color.
+///	</summary>
+static const size_t MapNodeOverhead = 32;
+
+///	<summary>
+///		Estimate the heap bytes owned by a std::string; strings of up to
+///		15 characters are stored inline.
+///	</summary>
+static size_t StringHeapBytes(
+	const std::string & str
+) {
+	return (str.capacity() > 15)?(str.capacity() + 1):(0);
+}
+
+///	<summary>
+///		Estimate the heap bytes owned by a map from string to string.
+///	</summary>
+static size_t StringMapHeapBytes(
+	const std::map<std::string, std::string> & map
+) {
+	size_t sBytes = map.size()
+		* (MapNodeOverhead + sizeof(std::map<std::string, std::string>::value_type));
+	for (auto iter = map.begin(); iter != map.end(); iter++) {
+		sBytes += StringHeapBytes(iter->first) + StringHeapBytes(iter->second);
+	}
+	return sBytes;
+}
+
+///	<summary>
+///		Estimate the heap bytes owned by a DataObjectInfo other than its
+///		attribute maps, whose strings are interned.
+///	</summary>
+static size_t DataObjectInfoHeapBytes(
+	const DataObjectInfo & info
+) {
+	size_t sBytes =
+		StringHeapBytes(info.m_strName)
+		+ StringHeapBytes(info.m_strUnits)
+		+ info.m_setKeyAttributeNames.size()
+			* (MapNodeOverhead + sizeof(std::string));
+	for (auto iter = info.m_setKeyAttributeNames.begin();
+	     iter != info.m_setKeyAttributeNames.end(); iter++
+	) {
+		sBytes += StringHeapBytes(*iter);
+	}
+	return sBytes;
+}
+
+///	<summary>
+///		Get the number of attributes of a DataObjectInfo.
+///	</summary>
+static size_t DataObjectInfoAttributeCount(
+	const DataObjectInfo & info
+) {
+	return info.m_mapKeyAttributes.size() + info.m_mapOtherAttributes.size();
+}
+
+///	<summary>
+///		Estimate the heap bytes of the attribute maps of a DataObjectInfo.
+///	</summary>
+static size_t DataObjectInfoAttributeBytes(
+	const DataObjectInfo & info
+) {
+	return DataObjectInfoAttributeCount(info)
+		* (MapNodeOverhead + sizeof(AttributeMap::value_type));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void IndexedDataset::RecordMemoryFootprint() const {
+
+	Profiler & profiler = Profiler::Shared();
+	if (!profiler.IsEnabled()) {
+		return;
+	}
+
+	size_t sTotalBytes = 0;
+	auto Record = [&](const char * szStructure, size_t sBytes, size_t sObjects) {
+		profiler.RecordMemory(szStructure, sBytes, sObjects);
+		sTotalBytes += sBytes;
+	};
+
+	// Names are counted twice, as the lookup tables hold a copy
+
+	// Files and their attributes
+	{
+		size_t sBytes = ObjectPool<FileInfo>::Shared().GetReservedBytes()
+			+ m_vecFileInfo.GetContainerBytes();
+		size_t sAttributeBytes = 0;
+		size_t sAttributes = 0;
+		size_t sBlockBytes = 0;
+		std::unordered_set<const FileAttributeBlock *> setBlocks;
+		for (size_t f = 0; f < m_vecFileInfo.size(); f++) {
+			const FileInfo * pfileinfo = m_vecFileInfo[f];
+			sBytes += DataObjectInfoHeapBytes(*pfileinfo)
+				+ 2 * StringHeapBytes(pfileinfo->m_strFilename)
+				+ StringMapHeapBytes(pfileinfo->m_mapAxisSubAxis);
+			sAttributeBytes += DataObjectInfoAttributeBytes(*pfileinfo);
+			sAttributes += DataObjectInfoAttributeCount(*pfileinfo);
+
+			const FileAttributeBlock * pblock = pfileinfo->m_pattrblock.get();
+			if ((pblock != NULL) && setBlocks.insert(pblock).second) {
+				const size_t sBlockCount =
+					pblock->m_mapKeyAttributes.size()
+					+ pblock->m_mapOtherAttributes.size();
+				sBlockBytes += sizeof(FileAttributeBlock)
+					+ sBlockCount * (MapNodeOverhead + sizeof(AttributeMap::value_type));
+			}
+		}
+		Record("file_info", sBytes, ObjectPool<FileInfo>::Shared().GetLiveCount());
+		Record("file_attributes", sAttributeBytes, sAttributes);
+		Record("file_attribute_blocks", sBlockBytes, setBlocks.size());
+	}
+
+	// Offsets and write buffer of spilled files
+	if (m_pspill != NULL) {
+		Record("file_spill", m_pspill->GetMemoryBytes(), m_pspill->size());
+	}
+
+	// Axes, their SubAxis and the coordinate values of each SubAxis
+	{
+		size_t sAxisBytes = ObjectPool<AxisInfo>::Shared().GetReservedBytes()
+			+ m_vecAxisInfo.GetContainerBytes();
+		size_t sSubAxisBytes = ObjectPool<SubAxis>::Shared().GetReservedBytes();
+		size_t sValueBytes = 0;
+		size_t sValueArrays = 0;
+		for (size_t a = 0; a < m_vecAxisInfo.size(); a++) {
+			const AxisInfo * paxisinfo = m_vecAxisInfo[a];
+			sAxisBytes += 2 * StringHeapBytes(paxisinfo->m_strName)
+				+ DataObjectInfoHeapBytes(*paxisinfo)
+				+ DataObjectInfoAttributeBytes(*paxisinfo)
+				+ paxisinfo->m_vecSubAxis.GetContainerBytes()
+				+ paxisinfo->m_mapSubAxisFingerprints.size()
+					* (2 * sizeof(void *) + sizeof(AxisInfo::SubAxisFingerprintIndex::value_type))
+				+ paxisinfo->m_mapSubAxisFingerprints.bucket_count() * sizeof(void *)
+				+ paxisinfo->m_intervals.GetMemoryBytes();
+
+			for (size_t s = 0; s < paxisinfo->m_vecSubAxis.size(); s++) {
+				const SubAxis * psubaxis = paxisinfo->m_vecSubAxis[s];
+				sSubAxisBytes += 2 * StringHeapBytes(psubaxis->m_strName)
+					+ DataObjectInfoHeapBytes(*psubaxis)
+					+ DataObjectInfoAttributeBytes(*psubaxis)
+					+ StringHeapBytes(psubaxis->m_strSourceFile);
+
+				size_t sBytes = psubaxis->m_values.GetCapacityBytes();
+				if (sBytes != 0) {
+					sValueBytes += sBytes;
+					sValueArrays++;
+				}
+			}
+		}
+		Record("axis_info", sAxisBytes, ObjectPool<AxisInfo>::Shared().GetLiveCount());
+		Record("subaxis", sSubAxisBytes, ObjectPool<SubAxis>::Shared().GetLiveCount());
+		Record("subaxis_values", sValueBytes, sValueArrays);
+	}
+
+	// Variables and their maps from subaxis coordinates to files
+	{
+		size_t sBytes = ObjectPool<VariableInfo>::Shared().GetReservedBytes()
+			+ m_vecVariableInfo.GetContainerBytes();
+		size_t sFileIdMapBytes = 0;
+		size_t sFileIdMaps = 0;
+		for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
+			const VariableInfo * pvarinfo = m_vecVariableInfo[v];
+			sBytes += 2 * StringHeapBytes(pvarinfo->m_strName)
+				+ DataObjectInfoHeapBytes(*pvarinfo)
+				+ DataObjectInfoAttributeBytes(*pvarinfo)
+				+ pvarinfo->m_mapTimeFile.size()
+					* (MapNodeOverhead + sizeof(VariableTimeFileMap::value_type));
+
+			const AxisNamesToSubAxisToFileIdMapMap & mapFileIdMaps =
+				pvarinfo->m_mapSubAxisToFileIdMaps;
+			for (auto iter = mapFileIdMaps.begin(); iter != mapFileIdMaps.end(); iter++) {
+				sFileIdMapBytes += MapNodeOverhead
+					+ sizeof(AxisNamesToSubAxisToFileIdMapMap::value_type)
+					+ iter->first.capacity() * sizeof(std::string)
+					+ iter->second.GetMemoryBytes();
+				for (size_t d = 0; d < iter->first.size(); d++) {
+					sFileIdMapBytes += StringHeapBytes(iter->first[d]);
+				}
+			}
+			sFileIdMaps += mapFileIdMaps.size();
+		}
+		Record("variable_info", sBytes, ObjectPool<VariableInfo>::Shared().GetLiveCount());
+		Record("subaxis_to_file_id_maps", sFileIdMapBytes, sFileIdMaps);
+	}
+
+	// Remaining structures of the dataset
+	Record("times",
+		m_vecTimes.capacity() * sizeof(Time)
+		+ m_mapQueryFileIx.size()
+			* (2 * sizeof(void *) + sizeof(std::pair<const IndexId, size_t>))
+		+ m_mapQueryFileIx.bucket_count() * sizeof(void *),
+		m_vecTimes.size());
+	Record("interned_strings",
+		InternedString::PoolBytes(),
+		InternedString::PoolSize());
+	Record("data_array_pool",
+		DataArrayAllocator::Shared().GetPooledBytes(),
+		DataArrayAllocator::Shared().GetPooledCount());
+
+	// The total is reported against the number of files indexed
+	profiler.RecordMemory("total", sTotalBytes, GetFileCount());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::LoadSummarizedValues() {
+	LookupVectorHeap<std::string, AxisInfo>::iterator iteraxis =
+		m_vecAxisInfo.begin();
+	for (; iteraxis != m_vecAxisInfo.end(); iteraxis++) {
+		AxisInfo * paxisinfo = *iteraxis;
+
+		bool fLoaded = false;
+		AxisInfo::SubAxisVector::iterator itersubaxis =
+			paxisinfo->m_vecSubAxis.begin();
+		for (; itersubaxis != paxisinfo->m_vecSubAxis.end(); itersubaxis++) {
+			SubAxis * psubaxis = *itersubaxis;
+			if (!psubaxis->m_fSummarized) {
+				continue;
+			}
+			std::string strError = psubaxis->LoadValues(iteraxis.key());
+			if (strError != "") {
+				return strError;
+			}
+			fLoaded = true;
+		}
+		if (fLoaded) {
+			paxisinfo->RebuildSubAxisIndex();
+		}
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::SetHeaderCacheDir(
+	const std::string & strCacheDir
+) {
+	SetHeaderCache(NULL);
+	if (strCacheDir == "") {
+		return std::string("");
+	}
+
+	FileHeaderCache * pcache = new FileHeaderCache(strCacheDir);
+	std::string strError = pcache->Initialize();
+	if (strError != "") {
+		delete pcache;
+		return strError;
+	}
+	m_pcache = pcache;
+	m_fOwnsCache = true;
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void IndexedDataset::SetHeaderCache(
+	FileHeaderCache * pcache
+) {
+	JoinAbandonedWorkers(true);
+	if ((m_pcache != NULL) && m_fOwnsCache) {
+		delete m_pcache;
+	}
+	m_pcache = pcache;
+	m_fOwnsCache = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::SetFileSpill(
+	const std::string & strSpillFile,
+	size_t sBufferBytes
+) {
+	if (GetFileCount() != 0) {
+		return std::string("A spill file must be set before files are indexed");
+	}
+	if (m_pspill != NULL) {
+		delete m_pspill;
+		m_pspill = NULL;
+	}
+	if (strSpillFile == "") {
+		return std::string("");
+	}
+
+	FileInfoSpill * pspill = new FileInfoSpill;
+	std::string strError = pspill->Open(strSpillFile, sBufferBytes);
+	if (strError != "") {
+		delete pspill;
+		return strError;
+	}
+	m_pspill = pspill;
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t IndexedDataset::GetFileCount() const {
+	if (m_pspill != NULL) {
+		return m_pspill->size();
+	}
+	return m_vecFileInfo.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool IndexedDataset::GetHeaderCacheCounts(
+	size_t & sHits,
+	size_t & sMisses
+) const {
+	sHits = 0;
+	sMisses = 0;
+	if (m_pcache == NULL) {
+		return false;
+	}
+
+	unsigned long ulCounts[2];
+	ulCounts[0] = static_cast<unsigned long>(m_pcache->GetHits());
+	ulCounts[1] = static_cast<unsigned long>(m_pcache->GetMisses());
+
+#if defined(HYPERION_MPIOMP)
+	MPI_Allreduce(
+		MPI_IN_PLACE, ulCounts, 2, MPI_UNSIGNED_LONG,
+		MPI_SUM, MPI_COMM_WORLD);
+#endif
+
+	sHits = static_cast<size_t>(ulCounts[0]);
+	sMisses = static_cast<size_t>(ulCounts[1]);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::PopulateFromSearchString(
+	const std::string & strSearchString
+) {
+	std::string strBaseDir;
+
+	// File the directory in the search string
+	std::string strFileSearchString;
+	for (int i = strSearchString.length(); i >= 0; i--) {
+		if (strSearchString[i] == '/') {
+			strBaseDir = strSearchString.substr(0,i+1);
+			strFileSearchString =
+				strSearchString.substr(i+1, std::string::npos);
+			break;
+		}
+	}
+	if ((strBaseDir == "") && (strFileSearchString == "")) {
+		strFileSearchString = strSearchString;
+		strBaseDir = "./";
+	}
+
+	// Open the directory
+	DIR * pDir = opendir(strBaseDir.c_str());
+	if (pDir == NULL) {
+		return std::string("Unable to open directory \"")
+			+ strBaseDir + std::string("\"");
+	}
+
+	// Search all files in the directory for match to search string
+	FileNamePattern pattern(strFileSearchString);
+	std::vector<std::string> vecFilenames;
+	struct dirent * pDirent;
+	while ((pDirent = readdir(pDir)) != NULL) {
+		std::string strFilename = pDirent->d_name;
+		if (pattern.Matches(strFilename.c_str(), strFilename.length())) {
+			// File found, insert into list of filenames
+			vecFilenames.push_back(strFilename);
+		}
+	}
+	closedir(pDir);
+
+	// Index the variable data
+	return IndexVariableData(strBaseDir, vecFilenames);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(HYPERION_MPIOMP)
+
+///	<summary>
+///		Largest message sent in one MPI call, since counts are int.
+///	</summary>
+static const size_t MPIMaxMessageBytes = (1 << 30);
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Broadcast an error and a list of files from rank 0 to all ranks,
+///		with the stamps of the files if rank 0 has one for each file.
+///	</summary>
+static void MPIBroadcastFileList(
+	std::string & strError,
+	std::vector<std::string> & vecFilenames,
+	std::vector<FileStamp> & vecStamps
+) {
+	int nRank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+
+	std::vector<char> vecBuffer;
+	if (nRank == 0) {
+		const bool fStamps = (vecStamps.size() == vecFilenames.size());
+		BufferWrite(vecBuffer, strError);
+		BufferWrite<int>(vecBuffer, fStamps?1:0);
+		for (size_t f = 0; f < vecFilenames.size(); f++) {
+			BufferWrite(vecBuffer, vecFilenames[f]);
+			if (fStamps) {
+				BufferWrite<long long>(vecBuffer, vecStamps[f].m_llSize);
+				BufferWrite<long long>(vecBuffer, vecStamps[f].m_llModTime);
+			}
+		}
+	}
+
+	unsigned long long ullSize = vecBuffer.size();
+	MPI_Bcast(&ullSize, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
+	vecBuffer.resize(ullSize);
+	for (size_t s = 0; s < ullSize; s += MPIMaxMessageBytes) {
+		int nBytes =
+			static_cast<int>(
+				std::min(MPIMaxMessageBytes, (size_t)ullSize - s));
+		MPI_Bcast(&(vecBuffer[s]), nBytes, MPI_BYTE, 0, MPI_COMM_WORLD);
+	}
+
+	if (nRank != 0) {
+		size_t sPos = 0;
+		int iStamps;
+		BufferRead(vecBuffer, sPos, strError);
+		BufferRead<int>(vecBuffer, sPos, iStamps);
+		vecFilenames.clear();
+		vecStamps.clear();
+		while (sPos < vecBuffer.size()) {
+			std::string strPath;
+			BufferRead(vecBuffer, sPos, strPath);
+			vecFilenames.push_back(strPath);
+			if (iStamps != 0) {
+				FileStamp stamp;
+				BufferRead<long long>(vecBuffer, sPos, stamp.m_llSize);
+				BufferRead<long long>(vecBuffer, sPos, stamp.m_llModTime);
+				vecStamps.push_back(stamp);
+			}
+		}
+	}
+}
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::PopulateFromRemotePath(
+	const std::string & strFilePath,
+	const FileNameFilter & filter,
+	bool fRecurse
+) {
+	std::string strBaseDir = strFilePath;
+	if (strBaseDir[strBaseDir.length()-1] != '/') {
+		strBaseDir += '/';
+	}
+
+	int nRank = 0;
+	int nCommSize = 1;
+#if defined(HYPERION_MPIOMP)
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nCommSize);
+#endif
+
+	// With several ranks the objects are listed on rank 0 only
+	std::vector<RemoteObject> vecObjects;
+	std::string strError;
+	if (nRank == 0) {
+		strError =
+			RemoteFileClient::Shared().List(strBaseDir, fRecurse, vecObjects);
+	}
+	if ((strError != "") && (nCommSize == 1)) {
+		return strError;
+	}
+
+	// Group the objects by directory, as the walker reports them, with
+	// the size and time from the listing so that unchanged files are not
+	// requested again during an incremental update
+	std::map<std::string, std::vector<std::string> > mapDirFilenames;
+	std::map<std::string, std::vector<FileStamp> > mapDirStamps;
+	for (size_t i = 0; i < vecObjects.size(); i++) {
+		const std::string & strKey = vecObjects[i].m_strKey;
+		size_t sSlash = strKey.rfind('/');
+		std::string strDir =
+			(sSlash == std::string::npos)?(std::string("")):(strKey.substr(0, sSlash + 1));
+		std::string strName =
+			(sSlash == std::string::npos)?(strKey):(strKey.substr(sSlash + 1));
+
+		if (!filter.Accepts(strName.c_str(), strName.length())) {
+			continue;
+		}
+
+		// Skip hidden and excluded directories
+		bool fSkip = false;
+		size_t sBegin = 0;
+		while (sBegin < strDir.length()) {
+			size_t sEnd = strDir.find('/', sBegin);
+			if ((strDir[sBegin] == '.') ||
+			    filter.IsExcluded(strDir.c_str() + sBegin, sEnd - sBegin)
+			) {
+				fSkip = true;
+				break;
+			}
+			sBegin = sEnd + 1;
+		}
+		if (fSkip) {
+			continue;
+		}
+
+		FileStamp stamp;
+		stamp.m_llSize = vecObjects[i].m_llSize;
+		stamp.m_llModTime = vecObjects[i].m_llModTime;
+
+		mapDirFilenames[strDir].push_back(strName);
+		mapDirStamps[strDir].push_back(stamp);
+	}
+
+#if defined(HYPERION_MPIOMP)
+	// With several ranks all objects are indexed in one call, so that
+	// they are partitioned across the ranks at once
+	if (nCommSize > 1) {
+		std::vector<std::string> vecFilenames;
+		std::vector<FileStamp> vecStamps;
+		std::map<std::string, std::vector<std::string> >::const_iterator iterDir =
+			mapDirFilenames.begin();
+		for (; iterDir != mapDirFilenames.end(); iterDir++) {
+			const std::vector<FileStamp> & vecDirStamps =
+				mapDirStamps[iterDir->first];
+			for (size_t f = 0; f < iterDir->second.size(); f++) {
+				vecFilenames.push_back(
+					strBaseDir + iterDir->first + iterDir->second[f]);
+				vecStamps.push_back(vecDirStamps[f]);
+			}
+		}
+		MPIBroadcastFileList(strError, vecFilenames, vecStamps);
+		if (strError != "") {
+			return strError;
+		}
+		return IndexVariableData("", vecFilenames, &vecStamps);
+	}
+#endif
+
+	std::map<std::string, std::vector<std::string> >::const_iterator iterDir =
+		mapDirFilenames.begin();
+	for (; iterDir != mapDirFilenames.end(); iterDir++) {
+		strError = IndexVariableData(
+			strBaseDir + iterDir->first,
+			iterDir->second,
+			&(mapDirStamps[iterDir->first]));
+		if (strError != "") {
+			return strError;
+		}
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::PopulateFromFilePath(
+	const std::string & strFilePath,
+	const std::string & strFileName,
+	bool fRecurse,
+	const std::string & strExclude
+) {
+	FileNameFilter filter;
+	std::string strError = filter.Parse(strFileName, strExclude);
+	if (strError != "") {
+		return strError;
+	}
+
+	if (IsRemoteURL(strFilePath)) {
+		return PopulateFromRemotePath(strFilePath, filter, fRecurse);
+	}
+
+	DirectoryWalker walker(m_sThreads);
+
+#if defined(HYPERION_MPIOMP)
+	// With several ranks the tree is walked on rank 0 only and all files
+	// are indexed in one call, so that they are partitioned across the
+	// ranks at once rather than one directory at a time
+	int nCommSize;
+	MPI_Comm_size(MPI_COMM_WORLD, &nCommSize);
+	if (nCommSize > 1) {
+		int nRank;
+		MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+
+		std::vector<std::string> vecFilenames;
+		std::vector<FileStamp> vecStamps;
+		if (nRank == 0) {
+			strError = walker.Walk(
+				strFilePath,
+				filter,
+				fRecurse,
+				[&vecFilenames](
+					const std::string & strBaseDir,
+					const std::vector<std::string> & vecDirFilenames
+				) {
+					for (size_t f = 0; f < vecDirFilenames.size(); f++) {
+						vecFilenames.push_back(strBaseDir + vecDirFilenames[f]);
+					}
+					return std::string("");
+				});
+		}
+		MPIBroadcastFileList(strError, vecFilenames, vecStamps);
+		if (strError != "") {
+			return strError;
+		}
+		return IndexVariableData("", vecFilenames);
+	}
+#endif
+
+	// Index each directory as soon as it is listed, while the walker
+	// continues with the rest of the tree
+	return walker.Walk(
+		strFilePath,
+		filter,
+		fRecurse,
+		[this](
+			const std::string & strBaseDir,
+			const std::vector<std::string> & vecFilenames
+		) {
+			return IndexVariableData(strBaseDir, vecFilenames);
+		});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Parse a line of a file list into a path and an optional stamp,
+///		whose m_llSize is -1 if the line has no size and time.  Returns
+///		false if the line is malformed.
+///	</summary>
+static bool ParseFileListLine(
+	const std::string & strLine,
+	std::string & strPath,
+	FileStamp & stamp
+) {
+	stamp = FileStamp();
+	stamp.m_llSize = -1;
+
+	size_t sTab = strLine.find('\t');
+	if (sTab == std::string::npos) {
+		strPath = strLine;
+		return true;
+	}
+	strPath = strLine.substr(0, sTab);
+
+	size_t sTab2 = strLine.find('\t', sTab+1);
+	if (sTab2 == std::string::npos) {
+		return false;
+	}
+	std::string strSize = strLine.substr(sTab+1, sTab2-sTab-1);
+	std::string strTime = strLine.substr(sTab2+1);
+
+	// Size in bytes
+	char * pEnd;
+	errno = 0;
+	long long llSize = strtoll(strSize.c_str(), &pEnd, 10);
+	if ((strSize == "") || (*pEnd != '\0') || (errno != 0) || (llSize < 0)) {
+		return false;
+	}
+
+	// Modification time in seconds, with up to nine decimals
+	size_t sDot = strTime.find('.');
+	std::string strSeconds = strTime.substr(0, sDot);
+	std::string strFraction =
+		(sDot == std::string::npos)?(""):(strTime.substr(sDot+1));
+	if ((strSeconds == "") || (strFraction.length() > 9) ||
+	    (strSeconds.find_first_not_of("0123456789") != std::string::npos) ||
+	    (strFraction.find_first_not_of("0123456789") != std::string::npos) ||
+	    ((sDot != std::string::npos) && (strFraction == ""))
+	) {
+		return false;
+	}
+	strFraction.resize(9, '0');
+
+	stamp.m_llSize = llSize;
+	stamp.m_llModTime =
+		atoll(strSeconds.c_str()) * 1000000000LL + atoll(strFraction.c_str());
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::PopulateFromFileList(
+	const std::string & strFileList
+) {
+	int nRank = 0;
+	int nCommSize = 1;
+#if defined(HYPERION_MPIOMP)
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nCommSize);
+#endif
+
+	// The list is read on rank 0 and shared with the other ranks
+	std::ifstream ifList;
+	std::istream * pisList = &std::cin;
+	std::string strError;
+	if ((nRank == 0) && (strFileList != "-")) {
+		ifList.open(strFileList.c_str());
+		if (!ifList.is_open()) {
+			strError = std::string("Unable to open file list \"")
+				+ strFileList + std::string("\"");
+		}
+		pisList = &ifList;
+	}
+
+	// Index the list in batches as it is read.  With several ranks the
+	// whole list is read and indexed in one call, so that it is
+	// partitioned across the ranks at once.
+	const size_t sBatchSize =
+		(nCommSize > 1)
+		?(std::numeric_limits<size_t>::max())
+		:(std::max<size_t>(256, 64 * m_sThreads));
+	size_t sLine = 0;
+	bool fEnd = false;
+	while (!fEnd) {
+		std::vector<std::string> vecFilenames;
+		std::vector<FileStamp> vecStamps;
+
+		if ((nRank == 0) && (strError == "")) {
+			std::string strLine;
+			while (vecFilenames.size() < sBatchSize) {
+				if (!std::getline(*pisList, strLine)) {
+					fEnd = true;
+					break;
+				}
+				sLine++;
+				if ((strLine.length() != 0) && (strLine[strLine.length()-1] == '\r')) {
+					strLine.resize(strLine.length()-1);
+				}
+				if ((strLine.length() == 0) || (strLine[0] == '#')) {
+					continue;
+				}
+
+				std::string strPath;
+				FileStamp stamp;
+				if (!ParseFileListLine(strLine, strPath, stamp) || (strPath == "")) {
+					strError = std::string("Malformed line ")
+						+ std::to_string(sLine) + std::string(" of file list");
+					break;
+				}
+				vecFilenames.push_back(strPath);
+				vecStamps.push_back(stamp);
+			}
+		}
+		if (strError != "") {
+			vecFilenames.clear();
+			vecStamps.clear();
+			fEnd = true;
+		}
+
+#if defined(HYPERION_MPIOMP)
+		if (nCommSize > 1) {
+			MPIBroadcastFileList(strError, vecFilenames, vecStamps);
+			fEnd = true;
+		}
+#endif
+		if (strError != "") {
+			return strError;
+		}
+
+		if (vecFilenames.size() != 0) {
+			strError = IndexVariableData("", vecFilenames, &vecStamps);
+			if (strError != "") {
+				return strError;
+			}
+		}
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::PopulateFromFiles(
+	const std::vector<std::string> & vecFilenames
+) {
+	if (vecFilenames.size() == 0) {
+		return std::string("");
+	}
+	return IndexVariableData("", vecFilenames);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Sort ids numerically where possible, so that renumbering
+///		preserves their original order.
+///	</summary>
+static void SortIds(
+	std::vector<std::string> & vecIds
+) {
+	std::vector< std::pair<long long, std::string> > vecKeys;
+	for (size_t i = 0; i < vecIds.size(); i++) {
+		vecKeys.push_back(
+			std::pair<long long, std::string>(
+				atoll(vecIds[i].c_str()), vecIds[i]));
+	}
+	std::sort(vecKeys.begin(), vecKeys.end());
+	for (size_t i = 0; i < vecIds.size(); i++) {
+		vecIds[i] = vecKeys[i].second;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void IndexedDataset::BeginIncrementalIndex() {
+	m_fIncremental = true;
+	m_mapIncrementalFileIds.clear();
+	m_setStaleFileIds.clear();
+	m_setOrphanedKeys.clear();
+	m_vecFailedFiles.clear();
+
+	LookupVectorHeap<std::string, FileInfo>::iterator iterfile =
+		m_vecFileInfo.begin();
+	for (; iterfile != m_vecFileInfo.end(); iterfile++) {
+		m_mapIncrementalFileIds.insert(
+			std::pair<std::string, std::string>(
+				(*iterfile)->m_strFilename, iterfile.key()));
+		m_setStaleFileIds.insert(iterfile.key());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::EndIncrementalIndex() {
+	if (!m_fIncremental) {
+		return std::string("EndIncrementalIndex called without "
+			"BeginIncrementalIndex");
+	}
+
+	Announce("%lu previously indexed files removed or replaced",
+		m_setStaleFileIds.size());
+
+	RemoveFileReferences(m_setStaleFileIds);
+
+	// Re-index unchanged files that were shadowed by removed files
+	std::string strError;
+	std::set<std::string> setTriedFilenames;
+	for (;;) {
+		std::vector<std::string> vecFilenames;
+		FindShadowedFiles(setTriedFilenames, vecFilenames);
+
+#if defined(HYPERION_MPIOMP)
+		// Only rank 0 holds the merged index, so it decides for all ranks
+		std::vector<char> vecBuffer;
+		for (size_t f = 0; f < vecFilenames.size(); f++) {
+			BufferWrite(vecBuffer, vecFilenames[f]);
+		}
+		unsigned long long ullSize = vecBuffer.size();
+		MPI_Bcast(&ullSize, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
+		vecBuffer.resize(ullSize);
+		if (ullSize != 0) {
+			MPI_Bcast(&(vecBuffer[0]), (int)ullSize, MPI_BYTE, 0, MPI_COMM_WORLD);
+		}
+		vecFilenames.clear();
+		for (size_t sPos = 0; sPos < vecBuffer.size();) {
+			std::string strFilename;
+			BufferRead(vecBuffer, sPos, strFilename);
+			vecFilenames.push_back(strFilename);
+			setTriedFilenames.insert(strFilename);
+		}
+#endif
+		if (vecFilenames.size() == 0) {
+			break;
+		}
+
+		Announce("Re-indexing %lu files shadowed by removed files",
+			vecFilenames.size());
+
+		std::set<std::string> setFilenames(
+			vecFilenames.begin(), vecFilenames.end());
+		std::set<std::string> setShadowedFileIds;
+		LookupVectorHeap<std::string, FileInfo>::iterator iterfile =
+			m_vecFileInfo.begin();
+		for (; iterfile != m_vecFileInfo.end(); iterfile++) {
+			if ((m_setStaleFileIds.find(iterfile.key()) == m_setStaleFileIds.end()) &&
+			    (setFilenames.find((*iterfile)->m_strFilename) != setFilenames.end())
+			) {
+				setShadowedFileIds.insert(iterfile.key());
+			}
+		}
+		RemoveFileReferences(setShadowedFileIds);
+		m_setStaleFileIds.insert(
+			setShadowedFileIds.begin(), setShadowedFileIds.end());
+
+		m_fIncremental = false;
+		strError = IndexVariableData("", vecFilenames);
+		m_fIncremental = true;
+		if (strError != "") {
+			break;
+		}
+	}
+
+	CompactIndex(m_setStaleFileIds);
+
+	m_fIncremental = false;
+	m_mapIncrementalFileIds.clear();
+	m_setStaleFileIds.clear();
+	m_setOrphanedKeys.clear();
+
+	return strError;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void IndexedDataset::FindShadowedFiles(
+	std::set<std::string> & setTriedFilenames,
+	std::vector<std::string> & vecFilenames
+) {
+	vecFilenames.clear();
+
+	// Surviving files in order of file id
+	std::vector<std::string> vecFileIds;
+	LookupVectorHeap<std::string, FileInfo>::iterator iterfile =
+		m_vecFileInfo.begin();
+	for (; iterfile != m_vecFileInfo.end(); iterfile++) {
+		if ((m_setStaleFileIds.find(iterfile.key()) == m_setStaleFileIds.end()) &&
+		    (setTriedFilenames.find((*iterfile)->m_strFilename) == setTriedFilenames.end())
+		) {
+			vecFileIds.push_back(iterfile.key());
+		}
+	}
+	SortIds(vecFileIds);
+
+	// Index surviving files by their (axis, subaxis) pairs
+	std::map<AxisSubAxisPair, std::vector<const FileInfo *> > mapAxisSubAxisFiles;
+	for (size_t f = 0; f < vecFileIds.size(); f++) {
+		const FileInfo * pfileinfo = *(m_vecFileInfo.find(vecFileIds[f]));
+		AxisSubAxisMap::const_iterator iter = pfileinfo->m_mapAxisSubAxis.begin();
+		for (; iter != pfileinfo->m_mapAxisSubAxis.end(); iter++) {
+			mapAxisSubAxisFiles[*iter].push_back(pfileinfo);
+		}
+	}
+
+	std::set<std::string> setFilenames;
+	std::set<VariableSubAxisKey>::iterator iterKey = m_setOrphanedKeys.begin();
+	while (iterKey != m_setOrphanedKeys.end()) {
+		const AxisNameVector & vecAxisNames = iterKey->second.first;
+		const SubAxisIdVector & vecSubAxisIds = iterKey->second.second;
+
+		// Skip entries that have since been reclaimed by another file
+		LookupVectorHeap<std::string, VariableInfo>::iterator itervar =
+			m_vecVariableInfo.find(iterKey->first);
+		if (itervar != m_vecVariableInfo.end()) {
+			AxisNamesToSubAxisToFileIdMapMap::const_iterator iterAxisGroup =
+				(*itervar)->m_mapSubAxisToFileIdMaps.find(vecAxisNames);
+			if ((iterAxisGroup != (*itervar)->m_mapSubAxisToFileIdMaps.end()) &&
+			    (iterAxisGroup->second.find(vecSubAxisIds) != iterAxisGroup->second.size())
+			) {
+				m_setOrphanedKeys.erase(iterKey++);
+				continue;
+			}
+		}
+
+		// Variables without dimensions could be in any file; only the
+		// first surviving file is tried, to bound the number of files
+		// that are re-indexed
+		if (vecAxisNames.size() == 0) {
+			if (vecFileIds.size() != 0) {
+				setFilenames.insert(
+					(*(m_vecFileInfo.find(vecFileIds[0])))->m_strFilename);
+			}
+			m_setOrphanedKeys.erase(iterKey++);
+			continue;
+		}
+
+		// Files whose subaxes match all of the entry's subaxes
+		std::map<AxisSubAxisPair, std::vector<const FileInfo *> >::const_iterator
+			iterFiles = mapAxisSubAxisFiles.find(
+				AxisSubAxisPair(
+					vecAxisNames[0], IndexIdToString(vecSubAxisIds[0])));
+		if (iterFiles != mapAxisSubAxisFiles.end()) {
+			const std::vector<const FileInfo *> & vecFiles = iterFiles->second;
+			for (size_t f = 0; f < vecFiles.size(); f++) {
+				bool fMatch = true;
+				for (size_t d = 1; d < vecAxisNames.size(); d++) {
+					AxisSubAxisMap::const_iterator iter =
+						vecFiles[f]->m_mapAxisSubAxis.find(vecAxisNames[d]);
+					if ((iter == vecFiles[f]->m_mapAxisSubAxis.end()) ||
+					    (iter->second != IndexIdToString(vecSubAxisIds[d]))
+					) {
+						fMatch = false;
+						break;
+					}
+				}
+				if (fMatch) {
+					setFilenames.insert(vecFiles[f]->m_strFilename);
+				}
+			}
+		}
+		iterKey++;
+	}
+
+	// Return in order of file id
+	for (size_t f = 0; f < vecFileIds.size(); f++) {
+		const std::string & strFilename =
+			(*(m_vecFileInfo.find(vecFileIds[f])))->m_strFilename;
+		if (setFilenames.find(strFilename) != setFilenames.end()) {
+			vecFilenames.push_back(strFilename);
+			setTriedFilenames.insert(strFilename);
+		}
+	}
+
+	// Entries with no remaining candidates cannot be reclaimed
+	if (vecFilenames.size() == 0) {
+		m_setOrphanedKeys.clear();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::FindHyperslabs(
+	const std::string & strVariableName,
+	const std::vector<AxisIndexRange> & vecRanges,
+	std::vector<FileHyperslab> & vecHyperslabs
+) const {
+	vecHyperslabs.clear();
+
+	const VariableInfo * pvarinfo = GetVariableInfo(strVariableName);
+	if (pvarinfo == NULL) {
+		return std::string("Variable \"") + strVariableName
+			+ std::string("\" not found in index");
+	}
+	const VariableInfo & varinfo = *pvarinfo;
+
+	// A variable is read with a single set of dimensions
+	if (varinfo.m_mapSubAxisToFileIdMaps.size() != 1) {
+		return std::string("Variable \"") + strVariableName
+			+ std::string("\" has inconsistent dimensions across files");
+	}
+	const AxisNameVector & vecAxisNames =
+		varinfo.m_mapSubAxisToFileIdMaps.begin()->first;
+	const SubAxisToFileIdMap & mapSubAxisToFileId =
+		varinfo.m_mapSubAxisToFileIdMaps.begin()->second;
+
+	if (vecRanges.size() != vecAxisNames.size()) {
+		return std::string("Variable \"") + strVariableName
+			+ std::string("\" has ") + std::to_string(vecAxisNames.size())
+			+ std::string(" dimensions but ") + std::to_string(vecRanges.size())
+			+ std::string(" index ranges were given");
+	}
+	for (size_t d = 0; d < vecRanges.size(); d++) {
+		if ((vecRanges[d].first < 0) || (vecRanges[d].second < 0)) {
+			return std::string("Negative index range on axis \"")
+				+ vecAxisNames[d] + std::string("\"");
+		}
+	}
+
+	// Size of one index of the first dimension in the loaded array
+	size_t sInnerSize = 1;
+	for (size_t d = 1; d < vecRanges.size(); d++) {
+		sInnerSize *= static_cast<size_t>(vecRanges[d].second);
+	}
+
+	// Position along the time axis
+	size_t sTimeDim = vecAxisNames.size();
+	if (m_strTimeAxisName != "") {
+		sTimeDim = std::find(
+			vecAxisNames.begin(), vecAxisNames.end(), m_strTimeAxisName)
+			- vecAxisNames.begin();
+	}
+
+	const FileInfo * pfileinfoFirst = NULL;
+
+	// Variable without the time axis
+	if (sTimeDim == vecAxisNames.size()) {
+		if (mapSubAxisToFileId.size() != 1) {
+			return std::string("Variable \"") + strVariableName
+				+ std::string("\" is held by more than one file, but does not"
+				" have the time axis");
+		}
+		LookupVectorHeap<std::string, FileInfo>::const_iterator iterfile =
+			m_vecFileInfo.find(IndexIdToString(mapSubAxisToFileId.fileid(0)));
+		if (iterfile == m_vecFileInfo.end()) {
+			_EXCEPTIONT("Logic error");
+		}
+		pfileinfoFirst = *iterfile;
+
+		FileHyperslab hyperslab;
+		for (size_t f = 0; f < m_vecFileInfo.size(); f++) {
+			if (m_vecFileInfo[f] == pfileinfoFirst) {
+				hyperslab.m_sFileIx = f;
+				break;
+			}
+		}
+		for (size_t d = 0; d < vecRanges.size(); d++) {
+			hyperslab.m_vecStart.push_back(vecRanges[d].first);
+			hyperslab.m_vecCount.push_back(vecRanges[d].second);
+		}
+		vecHyperslabs.push_back(hyperslab);
+
+	// Variable on the time axis, grouping consecutive times in one file
+	} else {
+		if (sTimeDim != 0) {
+			return std::string("Variable \"") + strVariableName
+				+ std::string("\" does not have \"") + m_strTimeAxisName
+				+ std::string("\" as its first dimension");
+		}
+		const long lTimeBegin = vecRanges[0].first;
+		const long lTimeEnd = vecRanges[0].first + vecRanges[0].second;
+		if (static_cast<size_t>(lTimeEnd) > m_vecTimes.size()) {
+			return std::string("Time index range exceeds the ")
+				+ std::to_string(m_vecTimes.size())
+				+ std::string(" times in the index");
+		}
+
+		for (long t = lTimeBegin; t < lTimeEnd; t++) {
+			VariableTimeFileMap::const_iterator iterTimeFile =
+				varinfo.m_mapTimeFile.find(static_cast<size_t>(t));
+			if (iterTimeFile == varinfo.m_mapTimeFile.end()) {
+				return std::string("Variable \"") + strVariableName
+					+ std::string("\" has no data at time ")
+					+ m_vecTimes[t].ToString();
+			}
+			const size_t sFileIx = iterTimeFile->second.first;
+			const long lLocalTime = iterTimeFile->second.second;
+
+			if (vecHyperslabs.size() != 0) {
+				FileHyperslab & hyperslabLast = vecHyperslabs.back();
+				if ((hyperslabLast.m_sFileIx == sFileIx) &&
+				    (hyperslabLast.m_vecStart[0] + hyperslabLast.m_vecCount[0]
+				        == lLocalTime)
+				) {
+					hyperslabLast.m_vecCount[0]++;
+					continue;
+				}
+			}
+
+			FileHyperslab hyperslab;
+			hyperslab.m_sFileIx = sFileIx;
+			hyperslab.m_vecStart.push_back(lLocalTime);
+			hyperslab.m_vecCount.push_back(1);
+			for (size_t d = 1; d < vecRanges.size(); d++) {
+				hyperslab.m_vecStart.push_back(vecRanges[d].first);
+				hyperslab.m_vecCount.push_back(vecRanges[d].second);
+			}
+			hyperslab.m_sOffset =
+				static_cast<size_t>(t - lTimeBegin) * sInnerSize;
+			vecHyperslabs.push_back(hyperslab);
+		}
+	}
+
+	// Indices other than time must refer to the same coordinates in
+	// every file and lie within them
+	for (size_t h = 0; h < vecHyperslabs.size(); h++) {
+		const FileInfo & fileinfo = *(m_vecFileInfo[vecHyperslabs[h].m_sFileIx]);
+		if (pfileinfoFirst == NULL) {
+			pfileinfoFirst = &fileinfo;
+		}
+
+		for (size_t d = 0; d < vecAxisNames.size(); d++) {
+			if (d == sTimeDim) {
+				continue;
+			}
+			AxisSubAxisMap::const_iterator iterSubAxis =
+				fileinfo.m_mapAxisSubAxis.find(vecAxisNames[d]);
+			AxisSubAxisMap::const_iterator iterSubAxisFirst =
+				pfileinfoFirst->m_mapAxisSubAxis.find(vecAxisNames[d]);
+			if ((iterSubAxis == fileinfo.m_mapAxisSubAxis.end()) ||
+			    (iterSubAxisFirst == pfileinfoFirst->m_mapAxisSubAxis.end())
+			) {
+				_EXCEPTIONT("Logic error");
+			}
+			if (iterSubAxis->second != iterSubAxisFirst->second) {
+				return std::string("Variable \"") + strVariableName
+					+ std::string("\" has different \"") + vecAxisNames[d]
+					+ std::string("\" coordinates in \"")
+					+ pfileinfoFirst->m_strFilename + std::string("\" and \"")
+					+ fileinfo.m_strFilename + std::string("\"");
+			}
+			if (h != 0) {
+				continue;
+			}
+
+			LookupVectorHeap<std::string, AxisInfo>::const_iterator iteraxis =
+				m_vecAxisInfo.find(vecAxisNames[d]);
+			if (iteraxis == m_vecAxisInfo.end()) {
+				_EXCEPTIONT("Logic error");
+			}
+			AxisInfo::SubAxisVector::const_iterator itersubaxis =
+				(*iteraxis)->m_vecSubAxis.find(iterSubAxis->second);
+			if (itersubaxis == (*iteraxis)->m_vecSubAxis.end()) {
+				_EXCEPTIONT("Logic error");
+			}
+			if (vecRanges[d].first + vecRanges[d].second
+			        > (*itersubaxis)->m_lSize
+			) {
+				return std::string("Index range exceeds the size ")
+					+ std::to_string((*itersubaxis)->m_lSize)
+					+ std::string(" of axis \"") + vecAxisNames[d]
+					+ std::string("\"");
+			}
+		}
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::ReadHyperslabs_float(
+	const std::string & strVariableName,
+	const std::vector<FileHyperslab> & vecHyperslabs,
+	float * pData
+) const {
+	for (size_t h = 0; h < vecHyperslabs.size(); h++) {
+		const FileHyperslab & hyperslab = vecHyperslabs[h];
+		const std::string & strFilename =
+			m_vecFileInfo[hyperslab.m_sFileIx]->m_strFilename;
+
+		size_t sSize = 1;
+		for (size_t d = 0; d < hyperslab.m_vecCount.size(); d++) {
+			sSize *= static_cast<size_t>(hyperslab.m_vecCount[d]);
+		}
+		if (sSize == 0) {
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lockNetCDF(s_mutexNetCDF);
+
+		NcFilePool::Handle handle;
+		std::string strError = NcFilePool::Shared().Open(strFilename, handle);
+		if (strError != "") {
+			return strError;
+		}
+		NcVar * var = handle->get_var(strVariableName.c_str());
+		if ((var == NULL) ||
+		    (var->num_dims() != static_cast<int>(hyperslab.m_vecCount.size()))
+		) {
+			return std::string("Variable \"") + strVariableName
+				+ std::string("\" in \"") + strFilename
+				+ std::string("\" does not match the index");
+		}
+		if ((var->type() == ncChar) || (var->type() == ncNoType)) {
+			return std::string("Variable \"") + strVariableName
+				+ std::string("\" is not of a numeric type");
+		}
+
+		// Values are converted to float by the library
+		var->set_cur(const_cast<long *>(&(hyperslab.m_vecStart[0])));
+		if (!var->get(pData + hyperslab.m_sOffset, &(hyperslab.m_vecCount[0]))) {
+			return std::string("Unable to read variable \"") + strVariableName
+				+ std::string("\" from \"") + strFilename + std::string("\"");
+		}
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::LoadData_float(
+	const std::string & strVariableName,
+	const std::vector<AxisIndexRange> & vecRanges,
+	DataArray1D<float> & data
+) {
+	std::vector<FileHyperslab> vecHyperslabs;
+	std::string strError =
+		FindHyperslabs(strVariableName, vecRanges, vecHyperslabs);
+	if (strError != "") {
+		return strError;
+	}
+
+	size_t sSize = 1;
+	for (size_t d = 0; d < vecRanges.size(); d++) {
+		sSize *= static_cast<size_t>(vecRanges[d].second);
+	}
+	data.Allocate(sSize);
+	if (sSize == 0) {
+		return std::string("");
+	}
+
+	return ReadHyperslabs_float(strVariableName, vecHyperslabs, &(data[0]));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::LoadData_float(
+	const std::string & strVariableName,
+	const std::vector<AxisIndexRange> & vecRanges,
+	DataArray2D<float> & data
+) {
+	if (vecRanges.size() != 2) {
+		return std::string("Loading into DataArray2D requires 2 index ranges");
+	}
+
+	std::vector<FileHyperslab> vecHyperslabs;
+	std::string strError =
+		FindHyperslabs(strVariableName, vecRanges, vecHyperslabs);
+	if (strError != "") {
+		return strError;
+	}
+
+	data.Allocate(vecRanges[0].second, vecRanges[1].second);
+	if ((vecRanges[0].second == 0) || (vecRanges[1].second == 0)) {
+		return std::string("");
+	}
+
+	return ReadHyperslabs_float(strVariableName, vecHyperslabs, &(data(0,0)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::LoadData_float(
+	const std::string & strVariableName,
+	const std::vector<AxisIndexRange> & vecRanges,
+	DataArray3D<float> & data
+) {
+	if (vecRanges.size() != 3) {
+		return std::string("Loading into DataArray3D requires 3 index ranges");
+	}
+
+	std::vector<FileHyperslab> vecHyperslabs;
+	std::string strError =
+		FindHyperslabs(strVariableName, vecRanges, vecHyperslabs);
+	if (strError != "") {
+		return strError;
+	}
+
+	data.Allocate(vecRanges[0].second, vecRanges[1].second, vecRanges[2].second);
+	if ((vecRanges[0].second == 0) ||
+	    (vecRanges[1].second == 0) ||
+	    (vecRanges[2].second == 0)
+	) {
+		return std::string("");
+	}
+
+	return ReadHyperslabs_float(strVariableName, vecHyperslabs, &(data(0,0,0)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::WriteData_float(
+	const std::string & strVariableName,
+	const std::vector<AxisIndexRange> & vecRanges,
+	const DataArray1D<float> & data,
+	NcWriteBatch & batch
+) const {
+	std::vector<FileHyperslab> vecHyperslabs;
+	std::string strError =
+		FindHyperslabs(strVariableName, vecRanges, vecHyperslabs);
+	if (strError != "") {
+		return strError;
+	}
+
+	size_t sSize = 1;
+	for (size_t d = 0; d < vecRanges.size(); d++) {
+		sSize *= static_cast<size_t>(vecRanges[d].second);
+	}
+	if (data.GetRows() != sSize) {
+		return std::string("Data of size ") + std::to_string(data.GetRows())
+			+ std::string(" does not match the ") + std::to_string(sSize)
+			+ std::string(" values of the index ranges");
+	}
+	if (sSize == 0) {
+		return std::string("");
+	}
+
+	const float * pData = data;
+	for (size_t h = 0; h < vecHyperslabs.size(); h++) {
+		const FileHyperslab & hyperslab = vecHyperslabs[h];
+		strError = batch.Add(
+			m_vecFileInfo[hyperslab.m_sFileIx]->m_strFilename,
+			strVariableName,
+			hyperslab.m_vecStart,
+			hyperslab.m_vecCount,
+			pData + hyperslab.m_sOffset);
+		if (strError != "") {
+			return strError;
+		}
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::WriteData_float(
+	const std::string & strVariableName,
+	const std::vector<AxisIndexRange> & vecRanges,
+	const DataArray1D<float> & data
+) const {
+	NcWriteBatch batch;
+	std::string strError =
+		WriteData_float(strVariableName, vecRanges, data, batch);
+	if (strError != "") {
+		return strError;
+	}
+	return batch.Flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check if a stamp from a file list matches the stamp of an indexed
+///		file.  The listed modification time may be given to a coarser
+///		precision, in which case the indexed time is truncated to match.
+///	</summary>
+static bool ListedStampMatches(
+	const FileStamp & stampListed,
+	const FileStamp & stampIndexed
+) {
+	if (stampListed.m_llSize != stampIndexed.m_llSize) {
+		return false;
+	}
+	long long llResolution = 1;
+	while ((llResolution < 1000000000LL) &&
+	       (stampListed.m_llModTime % (llResolution * 10) == 0)
+	) {
+		llResolution *= 10;
+	}
+	return (stampListed.m_llModTime ==
+		(stampIndexed.m_llModTime / llResolution) * llResolution);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		One attempt to extract the header of a file.  Each attempt owns
+///		its result, so that a worker blocked past the file deadline can
+///		be abandoned, and its result merged if it completes later.
+///	</summary>
+class FileHeaderExtraction {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	FileHeaderExtraction(
+		const std::string & strFilename,
+		size_t sAttempts
+	) :
+		m_strFilename(strFilename),
+		m_sFileIx(0),
+		m_dCost(1.0),
+		m_sAttempts(sAttempts),
+		m_fStarted(false),
+		m_durLibraryWait(Profiler::Clock::duration::zero()),
+		m_fWaitingForLibrary(false),
+		m_fDone(false),
+		m_fTimedOut(false)
+	{ }
+
+public:
+	///	<summary>
+	///		Full path to the file.
+	///	</summary>
+	std::string m_strFilename;
+
+	///	<summary>
+	///		Index of the file in the list being indexed.
+	///	</summary>
+	size_t m_sFileIx;
+
+	///	<summary>
+	///		Estimated cost of the extraction.
+	///	</summary>
+	double m_dCost;
+
+	///	<summary>
+	///		Header extracted from the file.
+	///	</summary>
+	FileHeader m_header;
+
+	///	<summary>
+	///		Number of attempts made, including this one once started.
+	///	</summary>
+	size_t m_sAttempts;
+
+	///	<summary>
+	///		Flag indicating a worker has started the extraction, and the
+	///		time it started.
+	///	</summary>
+	bool m_fStarted;
+	Profiler::Clock::time_point m_tStart;
+
+	///	<summary>
+	///		Time spent waiting for s_mutexNetCDF, which is not counted
+	///		against the file deadline, and flag indicating the extraction
+	///		is waiting for it now.
+	///	</summary>
+	Profiler::Clock::duration m_durLibraryWait;
+	bool m_fWaitingForLibrary;
+
+	///	<summary>
+	///		Flag indicating m_header is complete.  Once set, the worker no
+	///		longer refers to the extraction.
+	///	</summary>
+	std::atomic<bool> m_fDone;
+
+	///	<summary>
+	///		Flag indicating the extraction exceeded the file deadline.
+	///	</summary>
+	bool m_fTimedOut;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		State of a pool of threads extracting file headers, shared by the
+///		workers and the merge.  Members other than the extractions are
+///		guarded by m_mutex.
+///	</summary>
+class FileHeaderExtractionPool {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	FileHeaderExtractionPool(
+		const std::vector< std::shared_ptr<FileHeaderExtraction> > & vecExtractions,
+		size_t sWindow,
+		bool fCostliestFirst,
+		Profiler::Clock::duration durDeadline
+	) :
+		m_vecExtractions(vecExtractions),
+		m_sWindow(sWindow),
+		m_fCostliestFirst(fCostliestFirst),
+		m_durDeadline(durDeadline),
+		m_sNextFile(0),
+		m_sMergedFiles(0),
+		m_fAbort(false)
+	{ }
+
+public:
+	///	<summary>
+	///		Extractions in the order they are merged.
+	///	</summary>
+	std::vector< std::shared_ptr<FileHeaderExtraction> > m_vecExtractions;
+
+	///	<summary>
+	///		Number of files workers may run ahead of the merge.
+	///	</summary>
+	size_t m_sWindow;
+
+	///	<summary>
+	///		Flag indicating workers take the costliest file not yet
+	///		started within the window, rather than the first.
+	///	</summary>
+	bool m_fCostliestFirst;
+
+	///	<summary>
+	///		Deadline for each file, excluding the time spent waiting for
+	///		s_mutexNetCDF, or zero.
+	///	</summary>
+	Profiler::Clock::duration m_durDeadline;
+
+	///	<summary>
+	///		Extraction in progress on each worker, or NULL.
+	///	</summary>
+	std::vector< std::shared_ptr<FileHeaderExtraction> > m_vecBusy;
+
+	///	<summary>
+	///		First file not yet started and number of files merged.
+	///	</summary>
+	size_t m_sNextFile;
+	size_t m_sMergedFiles;
+
+	///	<summary>
+	///		Flag indicating workers are to stop.
+	///	</summary>
+	bool m_fAbort;
+
+	///	<summary>
+	///		Mutex and conditions signalling extractions that started or
+	///		completed, and progress of the merge.
+	///	</summary>
+	std::mutex m_mutex;
+	std::condition_variable m_condReady;
+	std::condition_variable m_condWindow;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+thread_local FileHeaderExtractionPool * NetCDFHeaderLock::s_ppool = NULL;
+thread_local FileHeaderExtraction * NetCDFHeaderLock::s_pextraction = NULL;
+bool NetCDFHeaderLock::s_fTimedHolder = false;
+Profiler::Clock::time_point NetCDFHeaderLock::s_tHolderDeadline;
+std::mutex NetCDFHeaderLock::s_mutexHolder;
+std::condition_variable NetCDFHeaderLock::s_condHolder;
+
+///////////////////////////////////////////////////////////////////////////////
+
+NetCDFHeaderLock::NetCDFHeaderLock() :
+	m_fTimed(s_ppool != NULL)
+{
+	if (!m_fTimed) {
+		s_mutexNetCDF.lock();
+		return;
+	}
+
+	FileHeaderExtractionPool & pool = *s_ppool;
+	FileHeaderExtraction & extraction = *s_pextraction;
+
+	if (!s_mutexNetCDF.try_lock()) {
+		const Profiler::Clock::time_point tWait = Profiler::Clock::now();
+		{
+			std::lock_guard<std::mutex> lock(pool.m_mutex);
+			extraction.m_fWaitingForLibrary = true;
+		}
+
+		// Holders without a deadline do not signal their release, so
+		// the lock is also polled
+		bool fAbandoned = false;
+		{
+			std::unique_lock<std::mutex> lockHolder(s_mutexHolder);
+			while (!s_mutexNetCDF.try_lock()) {
+				const Profiler::Clock::time_point tNow = Profiler::Clock::now();
+				if (s_fTimedHolder && (tNow >= s_tHolderDeadline)) {
+					fAbandoned = true;
+					break;
+				}
+				Profiler::Clock::time_point tWake =
+					tNow + std::chrono::milliseconds(10);
+				if (s_fTimedHolder && (s_tHolderDeadline < tWake)) {
+					tWake = s_tHolderDeadline;
+				}
+				s_condHolder.wait_until(lockHolder, tWake);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(pool.m_mutex);
+			extraction.m_fWaitingForLibrary = false;
+			extraction.m_durLibraryWait += Profiler::Clock::now() - tWait;
+		}
+		pool.m_condReady.notify_all();
+
+		if (fAbandoned) {
+			_EXCEPTIONT("The NetCDF library is held by an extraction"
+				" past the file deadline");
+		}
+	}
+
+	std::lock_guard<std::mutex> lockHolder(s_mutexHolder);
+	s_fTimedHolder = true;
+	s_tHolderDeadline = Profiler::Clock::now() + pool.m_durDeadline;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+NetCDFHeaderLock::~NetCDFHeaderLock() {
+	if (m_fTimed) {
+		std::lock_guard<std::mutex> lockHolder(s_mutexHolder);
+		s_fTimedHolder = false;
+	}
+	s_mutexNetCDF.unlock();
+	if (m_fTimed) {
+		s_condHolder.notify_all();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void NetCDFHeaderLock::SetTimedExtraction(
+	FileHeaderExtractionPool * ppool,
+	FileHeaderExtraction * pextraction
+) {
+	s_ppool = ppool;
+	s_pextraction = pextraction;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::IndexVariableData(
+	const std::string & strBaseDir,
+	const std::vector<std::string> & vecInputFilenames,
+	const std::vector<FileStamp> * pvecListedStamps
+) {
+	std::string strError;
+
+	// During an incremental update only index new or modified files
+	std::vector<std::string> vecChangedFilenames;
+	if (m_fIncremental) {
+		std::set<std::string> setModifiedFileIds;
+		for (size_t f = 0; f < vecInputFilenames.size(); f++) {
+			std::string strFullFilename = strBaseDir + vecInputFilenames[f];
+			const bool fDeferred =
+				(m_setDeferredFilenames.find(strFullFilename)
+					!= m_setDeferredFilenames.end());
+
+			std::map<std::string, std::string>::iterator iterFileId =
+				m_mapIncrementalFileIds.find(strFullFilename);
+			if (iterFileId == m_mapIncrementalFileIds.end()) {
+				if (!fDeferred) {
+					vecChangedFilenames.push_back(vecInputFilenames[f]);
+				}
+				continue;
+			}
+			if (fDeferred) {
+				m_setStaleFileIds.erase(iterFileId->second);
+				m_mapIncrementalFileIds.erase(iterFileId);
+				continue;
+			}
+
+			LookupVectorHeap<std::string, FileInfo>::iterator iterfile =
+				m_vecFileInfo.find(iterFileId->second);
+			if (iterfile == m_vecFileInfo.end()) {
+				_EXCEPTIONT("Logic error");
+			}
+
+			bool fUnchanged;
+			if ((pvecListedStamps != NULL) && ((*pvecListedStamps)[f].m_llSize >= 0)) {
+				fUnchanged =
+					ListedStampMatches((*pvecListedStamps)[f], (*iterfile)->m_stamp);
+			} else {
+				FileStamp stamp;
+				stamp.FromFile(strFullFilename);
+				fUnchanged = stamp.IsValid() && (stamp == (*iterfile)->m_stamp);
+			}
+			if (fUnchanged) {
+				m_setStaleFileIds.erase(iterFileId->second);
+			} else {
+				setModifiedFileIds.insert(iterFileId->second);
+				vecChangedFilenames.push_back(vecInputFilenames[f]);
+			}
+			m_mapIncrementalFileIds.erase(iterFileId);
+		}
+
+		// Drop references to the previous version of modified files so
+		// the new version takes their place
+		RemoveFileReferences(setModifiedFileIds);
+	}
+
+	const std::vector<std::string> & vecFilenames =
+		(m_fIncremental)?(vecChangedFilenames):(vecInputFilenames);
+
+	// Listed stamps only correspond to the files when all are indexed
+	const std::vector<FileStamp> * pvecStamps =
+		(m_fIncremental)?(NULL):(pvecListedStamps);
+
+	// Report progress through the merge, ending on every return
+	struct ProgressScope {
+		ProgressScope(size_t sFiles, bool fReport) :
+			m_fReport(fReport)
+		{
+			if (m_fReport) {
+				AnnounceProgressBegin("Indexed files", sFiles);
+			}
+		}
+		~ProgressScope() {
+			if (m_fReport) {
+				AnnounceProgressEnd();
+			}
+		}
+		bool m_fReport;
+	} scopeProgress(vecFilenames.size(), m_fReportProgress);
+
+	// Check if we're appending to an already populated IndexedDataset
+	bool fAppendIndex =
+		(m_vecVariableInfo.size() != 0) ||
+		(m_vecAxisInfo.size() != 0) ||
+		(GetFileCount() != 0);
+
+#if defined(HYPERION_MPIOMP)
+	// Split the file list across ranks
+	int nCommSize;
+	MPI_Comm_size(MPI_COMM_WORLD, &nCommSize);
+	if (nCommSize > 1) {
+		if (m_pspill != NULL) {
+			return std::string("ERROR: A spill file cannot be used with multiple ranks");
+		}
+		return IndexVariableDataDistributed(
+			strBaseDir, vecFilenames, pvecStamps);
+	}
+#endif
+
+	// Extract and merge the files, then retry those that failed or
+	// exceeded the deadline in rounds with a doubling backoff
+	std::vector< std::shared_ptr<FileHeaderExtraction> > vecExtractions;
+	vecExtractions.reserve(vecFilenames.size());
+	for (size_t f = 0; f < vecFilenames.size(); f++) {
+		vecExtractions.push_back(
+			std::make_shared<FileHeaderExtraction>(
+				strBaseDir + vecFilenames[f], 0));
+	}
+
+	// Weight the files so that workers start on the costliest first
+	if ((m_eExtractionSchedule == ExtractionSchedule_Cost) &&
+	    ((m_sThreads > 1) || (m_sPrefetchDepth > 0))
+	) {
+		std::vector<long long> vecFileBytes;
+		std::vector<char> vecCached;
+		StatExtractionFiles(
+			strBaseDir, vecFilenames, pvecStamps,
+			0, vecFilenames.size(), vecFileBytes, vecCached);
+
+		std::vector<double> vecCosts;
+		ExtractionScheduler::EstimateCosts(vecFileBytes, vecCached, vecCosts);
+		for (size_t f = 0; f < vecFilenames.size(); f++) {
+			vecExtractions[f]->m_dCost = vecCosts[f];
+		}
+	}
+
+	std::vector< std::shared_ptr<FileHeaderExtraction> > vecFailed;
+	strError =
+		ExtractFileHeadersWithRetries(
+			vecExtractions,
+			[this](FileHeaderExtraction & extraction) {
+				return MergeFileHeader(extraction.m_header);
+			},
+			vecFailed);
+	if (strError != "") {
+		return strError;
+	}
+	return SkipFailedFiles(vecFailed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::ExtractFileHeadersWithRetries(
+	std::vector< std::shared_ptr<FileHeaderExtraction> > & vecExtractions,
+	const std::function<std::string(FileHeaderExtraction &)> & fnConsume,
+	std::vector< std::shared_ptr<FileHeaderExtraction> > & vecFailed
+) {
+	for (size_t sRound = 0; ; sRound++) {
+		vecFailed.clear();
+		std::string strError =
+			ExtractAndConsumeFileHeaders(vecExtractions, fnConsume, vecFailed);
+		if (strError != "") {
+			return strError;
+		}
+		if ((vecFailed.size() == 0) || (sRound >= m_sFileRetries)) {
+			break;
+		}
+
+		const double dBackoff =
+			std::ldexp(m_dRetryBackoff, static_cast<int>(sRound));
+		Announce("Retrying %lu files in %1.1f s", vecFailed.size(), dBackoff);
+		std::this_thread::sleep_for(std::chrono::duration<double>(dBackoff));
+
+		// A straggler whose abandoned extraction has since completed is
+		// consumed without being extracted again
+		vecExtractions.clear();
+		for (size_t f = 0; f < vecFailed.size(); f++) {
+			FileHeaderExtraction & extraction = *(vecFailed[f]);
+			if (extraction.m_fDone && !extraction.m_header.HasError()) {
+				strError = fnConsume(extraction);
+				if (strError != "") {
+					return strError;
+				}
+				continue;
+			}
+			std::shared_ptr<FileHeaderExtraction> pretry =
+				std::make_shared<FileHeaderExtraction>(
+					extraction.m_strFilename, extraction.m_sAttempts);
+			pretry->m_sFileIx = extraction.m_sFileIx;
+			pretry->m_dCost = extraction.m_dCost;
+			vecExtractions.push_back(pretry);
+		}
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::ExtractAndConsumeFileHeaders(
+	const std::vector< std::shared_ptr<FileHeaderExtraction> > & vecExtractions,
+	const std::function<std::string(FileHeaderExtraction &)> & fnConsume,
+	std::vector< std::shared_ptr<FileHeaderExtraction> > & vecFailed
+) {
+	std::string strError;
+
+	const size_t sFiles = vecExtractions.size();
+	if (sFiles == 0) {
+		return strError;
+	}
+
+	JoinAbandonedWorkers(false);
+
+	const bool fSetAsideFailures =
+		(m_dFileDeadline > 0.0) || (m_sFileRetries > 0) || m_fSkipFailedFiles;
+
+	// Consume an extracted header, or set it aside to be retried
+	auto fnMerge = [&](const std::shared_ptr<FileHeaderExtraction> & pextraction) {
+		FileHeaderExtraction & extraction = *pextraction;
+		if (fSetAsideFailures &&
+		    (extraction.m_fTimedOut || extraction.m_header.HasError())
+		) {
+			vecFailed.push_back(pextraction);
+			return std::string("");
+		}
+		std::string strMergeError = fnConsume(extraction);
+		extraction.m_header = FileHeader();
+		return strMergeError;
+	};
+
+	// Extract and merge one file at a time
+	const bool fPipeline = (m_sThreads > 1) || (m_sPrefetchDepth > 0);
+	if ((!fPipeline || (sFiles <= 1)) && (m_dFileDeadline == 0.0)) {
+		for (size_t f = 0; f < sFiles; f++) {
+			FileHeaderExtraction & extraction = *(vecExtractions[f]);
+			extraction.m_sAttempts++;
+			LoadFileHeader(extraction.m_strFilename, false, extraction.m_header);
+			extraction.m_fDone = true;
+
+			strError = fnMerge(vecExtractions[f]);
+			if (strError != "") return strError;
+		}
+		return std::string("");
+	}
+
+	// Extract headers on a pool of worker threads and merge them on this
+	// thread in filename order, so the index is identical to the serial
+	// result.  Workers run at most sWindow files ahead of the merge, so
+	// that opening and reading the headers of the next files overlaps
+	// merging the current one even with a single worker.  A file that
+	// exceeds the deadline is set aside and its worker is replaced, so
+	// that the merge continues with the next file.  Workers refer only
+	// to the shared pool and to this dataset, so that those abandoned
+	// on a file past its deadline may outlive this call; they are
+	// joined later, and at the latest when this dataset is destroyed.
+	const size_t sThreads = std::max<size_t>(1, std::min(m_sThreads, sFiles));
+	const size_t sWindow =
+		(m_sPrefetchDepth != 0)?(m_sPrefetchDepth):(4 * sThreads);
+	const Profiler::Clock::duration durDeadline =
+		std::chrono::duration_cast<Profiler::Clock::duration>(
+			std::chrono::duration<double>(m_dFileDeadline));
+
+	std::shared_ptr<FileHeaderExtractionPool> ppool =
+		std::make_shared<FileHeaderExtractionPool>(
+			vecExtractions, sWindow,
+			(m_eExtractionSchedule == ExtractionSchedule_Cost),
+			durDeadline);
+	FileHeaderExtractionPool & pool = *ppool;
+
+	auto fnWorker = [this, ppool](size_t t) {
+		FileHeaderExtractionPool & pool = *ppool;
+		const size_t sFiles = pool.m_vecExtractions.size();
+		for (;;) {
+			std::shared_ptr<FileHeaderExtraction> pextraction;
+			{
+				std::unique_lock<std::mutex> lock(pool.m_mutex);
+				pool.m_condWindow.wait(lock, [&]() {
+					return (pool.m_fAbort
+						|| (pool.m_sNextFile >= sFiles)
+						|| (pool.m_sNextFile < pool.m_sMergedFiles + pool.m_sWindow));
+				});
+				if (pool.m_fAbort || (pool.m_sNextFile >= sFiles)) {
+					return;
+				}
+
+				size_t f = pool.m_sNextFile;
+				if (pool.m_fCostliestFirst) {
+					const size_t sWindowEnd =
+						std::min(sFiles, pool.m_sMergedFiles + pool.m_sWindow);
+					for (size_t g = f+1; g < sWindowEnd; g++) {
+						if (!pool.m_vecExtractions[g]->m_fStarted &&
+						    (pool.m_vecExtractions[g]->m_dCost > pool.m_vecExtractions[f]->m_dCost)
+						) {
+							f = g;
+						}
+					}
+				}
+				pextraction = pool.m_vecExtractions[f];
+				pextraction->m_sAttempts++;
+				pextraction->m_tStart = Profiler::Clock::now();
+				pextraction->m_fStarted = true;
+				pool.m_vecBusy[t] = pextraction;
+				while ((pool.m_sNextFile < sFiles) &&
+				       pool.m_vecExtractions[pool.m_sNextFile]->m_fStarted
+				) {
+					pool.m_sNextFile++;
+				}
+			}
+			pool.m_condReady.notify_all();
+
+			if (m_dFileDeadline > 0.0) {
+				NetCDFHeaderLock::SetTimedExtraction(ppool.get(), pextraction.get());
+			}
+			LoadFileHeader(
+				pextraction->m_strFilename, true, pextraction->m_header);
+			NetCDFHeaderLock::SetTimedExtraction(NULL, NULL);
+
+			{
+				std::lock_guard<std::mutex> lock(pool.m_mutex);
+				pextraction->m_fDone = true;
+				pool.m_vecBusy[t].reset();
+			}
+			pool.m_condReady.notify_all();
+		}
+	};
+
+	std::vector<std::thread> vecThreads;
+	pool.m_vecBusy.resize(sThreads);
+	for (size_t t = 0; t < sThreads; t++) {
+		vecThreads.push_back(std::thread(fnWorker, t));
+	}
+
+	// Merge in order; exceptions are held until the workers are joined
+	std::exception_ptr exMerge;
+	try {
+		for (size_t f = 0; f < sFiles; f++) {
+			FileHeaderExtraction & extraction = *(vecExtractions[f]);
+			bool fTimedOut = false;
+			{
+				std::unique_lock<std::mutex> lock(pool.m_mutex);
+				if (m_dFileDeadline > 0.0) {
+					pool.m_condReady.wait(lock, [&]() {
+						return extraction.m_fStarted;
+					});
+
+					// Time spent waiting for the NetCDF library behind other
+					// workers is not counted against the deadline; a worker
+					// gives up the wait itself if the library is held past
+					// the deadline by another file
+					while (!extraction.m_fDone) {
+						if (extraction.m_fWaitingForLibrary) {
+							pool.m_condReady.wait(lock);
+							continue;
+						}
+						const Profiler::Clock::time_point tDeadline =
+							extraction.m_tStart
+							+ extraction.m_durLibraryWait
+							+ durDeadline;
+						if (Profiler::Clock::now() >= tDeadline) {
+							fTimedOut = true;
+							break;
+						}
+						pool.m_condReady.wait_until(lock, tDeadline);
+					}
+				} else {
+					pool.m_condReady.wait(lock, [&]() {
+						return extraction.m_fDone.load();
+					});
+				}
+				if (fTimedOut) {
+					extraction.m_fTimedOut = true;
+					pool.m_vecBusy.push_back(
+						std::shared_ptr<FileHeaderExtraction>());
+				}
+			}
+			if (fTimedOut) {
+				Announce("WARNING: \"%s\" exceeded the deadline of %1.1f s",
+					extraction.m_strFilename.c_str(), m_dFileDeadline);
+				vecThreads.push_back(std::thread(fnWorker, vecThreads.size()));
+			}
+
+			strError = fnMerge(vecExtractions[f]);
+			if (strError != "") {
+				break;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(pool.m_mutex);
+				pool.m_sMergedFiles = f+1;
+			}
+			pool.m_condWindow.notify_all();
+		}
+
+	} catch(...) {
+		exMerge = std::current_exception();
+	}
+
+	// With a deadline, workers still busy are abandoned rather than joined
+	std::vector< std::shared_ptr<FileHeaderExtraction> > vecAbandon(vecThreads.size());
+	{
+		std::lock_guard<std::mutex> lock(pool.m_mutex);
+		pool.m_fAbort = true;
+		if (m_dFileDeadline > 0.0) {
+			for (size_t t = 0; t < vecThreads.size(); t++) {
+				vecAbandon[t] = pool.m_vecBusy[t];
+			}
+		}
+	}
+	pool.m_condWindow.notify_all();
+	for (size_t t = 0; t < vecThreads.size(); t++) {
+		if (vecAbandon[t] != NULL) {
+			m_vecAbandonedWorkers.push_back(
+				std::make_pair(std::move(vecThreads[t]), vecAbandon[t]));
+		} else {
+			vecThreads[t].join();
+		}
+	}
+	if (exMerge) {
+		std::rethrow_exception(exMerge);
+	}
+	return strError;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void IndexedDataset::JoinAbandonedWorkers(
+	bool fWait
+) {
+	if ((m_vecAbandonedWorkers.size() != 0) && fWait) {
+		Announce("Waiting for %lu abandoned extractions to finish",
+			m_vecAbandonedWorkers.size());
+	}
+
+	// A worker no longer refers to this dataset once its extraction is
+	// done, so joining it then does not block
+	size_t sKept = 0;
+	for (size_t t = 0; t < m_vecAbandonedWorkers.size(); t++) {
+		if (fWait || m_vecAbandonedWorkers[t].second->m_fDone) {
+			m_vecAbandonedWorkers[t].first.join();
+		} else {
+			if (sKept != t) {
+				m_vecAbandonedWorkers[sKept] = std::move(m_vecAbandonedWorkers[t]);
+			}
+			sKept++;
+		}
+	}
+	m_vecAbandonedWorkers.resize(sKept);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::SkipFailedFiles(
+	const std::vector< std::shared_ptr<FileHeaderExtraction> > & vecFailed
+) {
+	for (size_t f = 0; f < vecFailed.size(); f++) {
+		FileHeaderExtraction & extraction = *(vecFailed[f]);
+
+		std::string strError;
+		if (extraction.m_fTimedOut) {
+			char szDeadline[32];
+			snprintf(szDeadline, sizeof(szDeadline), "%1.1f", m_dFileDeadline);
+			strError = std::string("Extracting \"")
+				+ extraction.m_strFilename
+				+ std::string("\" exceeded the deadline of ")
+				+ szDeadline + std::string(" s");
+
+		} else if (!m_fSkipFailedFiles) {
+			return MergeFileHeader(extraction.m_header);
+
+		} else {
+			strError = extraction.m_header.GetError();
+		}
+
+		if (!m_fSkipFailedFiles) {
+			return strError;
+		}
+
+		Announce("WARNING: Skipping \"%s\" after %lu attempts: %s",
+			extraction.m_strFilename.c_str(),
+			extraction.m_sAttempts,
+			strError.c_str());
+		m_vecFailedFiles.push_back(
+			FailedFile(
+				extraction.m_strFilename,
+				strError,
+				extraction.m_sAttempts));
+
+		if (m_fReportProgress) {
+			AnnounceProgressAdvance();
+		}
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void IndexedDataset::StatExtractionFiles(
+	const std::string & strBaseDir,
+	const std::vector<std::string> & vecFilenames,
+	const std::vector<FileStamp> * pvecStamps,
+	size_t sBegin,
+	size_t sEnd,
+	std::vector<long long> & vecFileBytes,
+	std::vector<char> & vecCached
+) {
+	const size_t sFiles = (sEnd > sBegin)?(sEnd - sBegin):(0);
+	vecFileBytes.resize(sFiles);
+	vecCached.resize(sFiles);
+	if (sFiles == 0) {
+		return;
+	}
+
+	// Remote files are not stat'ed, since each stat is a request
+	auto fnEstimate = [&](size_t f) {
+		const std::string strFilename = strBaseDir + vecFilenames[sBegin + f];
+		const bool fRemote = IsRemoteURL(strFilename);
+
+		long long llSize = -1;
+		if ((pvecStamps != NULL) && ((*pvecStamps)[sBegin + f].m_llSize >= 0)) {
+			llSize = (*pvecStamps)[sBegin + f].m_llSize;
+		} else if (!fRemote) {
+			FileStamp stamp;
+			if (stamp.FromFile(strFilename)) {
+				llSize = stamp.m_llSize;
+			}
+		}
+
+		bool fCached = false;
+		if ((m_pcache != NULL) && !fRemote) {
+			std::string strKey = m_pcache->GetKey(strFilename);
+			fCached = (strKey != "") && m_pcache->Contains(strKey);
+		}
+
+		vecFileBytes[f] = llSize;
+		vecCached[f] = (fCached)?(1):(0);
+	};
+
+	const size_t sThreads = std::max<size_t>(1, std::min(m_sThreads, sFiles));
+	if (sThreads == 1) {
+		for (size_t f = 0; f < sFiles; f++) {
+			fnEstimate(f);
+		}
+		return;
+	}
+
+	std::vector<std::thread> vecThreads;
+	for (size_t t = 0; t < sThreads; t++) {
+		vecThreads.push_back(std::thread([&, t]() {
+			for (size_t f = t; f < sFiles; f += sThreads) {
+				fnEstimate(f);
+			}
+		}));
+	}
+	for (size_t t = 0; t < vecThreads.size(); t++) {
+		vecThreads[t].join();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void IndexedDataset::LoadFileHeader(
+	const std::string & strFilename,
+	bool fPrefetch,
+	FileHeader & header
+) {
+	std::string strKey;
+	if (m_pcache != NULL) {
+		strKey = m_pcache->GetKey(strFilename);
+		if ((strKey != "") &&
+		    m_pcache->Load(strKey, strFilename, m_sSummarizeSize,
+				m_fComputeStatistics, header)
+		) {
+			return;
+		}
+	}
+
+	if (fPrefetch) {
+		PrefetchFileHeader(strFilename);
+	}
+	header.Extract(strFilename, m_sSummarizeSize, m_fNativeClassic,
+		m_fComputeStatistics);
+
+	if ((m_pcache != NULL) && (strKey != "")) {
+		m_pcache->Store(strKey, header);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(HYPERION_MPIOMP)
+
+static void MPISendBuffer(
+	const std::vector<char> & vecBuffer,
+	int iDest
+) {
+	unsigned long long ullSize = vecBuffer.size();
+	MPI_Send(&ullSize, 1, MPI_UNSIGNED_LONG_LONG, iDest, 0, MPI_COMM_WORLD);
+
+	for (size_t s = 0; s < vecBuffer.size(); s += MPIMaxMessageBytes) {
+		int nBytes =
+			static_cast<int>(
+				std::min(MPIMaxMessageBytes, vecBuffer.size() - s));
+		MPI_Send(
+			const_cast<char *>(&(vecBuffer[s])),
+			nBytes, MPI_BYTE, iDest, 0, MPI_COMM_WORLD);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void MPIRecvAppendBuffer(
+	std::vector<char> & vecBuffer,
+	int iSource
+) {
+	unsigned long long ullSize;
+	MPI_Recv(&ullSize, 1, MPI_UNSIGNED_LONG_LONG, iSource, 0,
+		MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+	size_t sBegin = vecBuffer.size();
+	vecBuffer.resize(sBegin + ullSize);
+
+	for (size_t s = 0; s < ullSize; s += MPIMaxMessageBytes) {
+		int nBytes =
+			static_cast<int>(
+				std::min(MPIMaxMessageBytes, (size_t)ullSize - s));
+		MPI_Recv(
+			&(vecBuffer[sBegin + s]),
+			nBytes, MPI_BYTE, iSource, 0,
+			MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Flags of a header record sent to rank 0: the file failed after
+///		all retries, it exceeded the deadline, or the rank failed and
+///		the record holds its error.
+///	</summary>
+static const unsigned long long MPIRecordFailed = 1;
+static const unsigned long long MPIRecordTimedOut = 2;
+static const unsigned long long MPIRecordError = 4;
+
+///	<summary>
+///		Prefix of a header record: the index of the file, the flags,
+///		the number of attempts and the length of the serialized header
+///		that follows.
+///	</summary>
+struct MPIHeaderRecord {
+	unsigned long long ullIndex;
+	unsigned long long ullFlags;
+	unsigned long long ullAttempts;
+	unsigned long long ullLength;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void MPIAppendHeaderRecord(
+	std::vector<char> & vecBuffer,
+	size_t sFileIx,
+	unsigned long long ullFlags,
+	size_t sAttempts,
+	const FileHeader & header
+) {
+	MPIHeaderRecord record;
+	record.ullIndex = sFileIx;
+	record.ullFlags = ullFlags;
+	record.ullAttempts = sAttempts;
+	record.ullLength = 0;
+
+	const size_t sRecordPos = vecBuffer.size();
+	vecBuffer.resize(sRecordPos + sizeof(record));
+
+	header.ToBuffer(vecBuffer);
+
+	record.ullLength = vecBuffer.size() - sRecordPos - sizeof(record);
+	memcpy(&(vecBuffer[sRecordPos]), &record, sizeof(record));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void MPIReadHeaderRecord(
+	const std::vector<char> & vecBuffer,
+	size_t & sPos,
+	size_t sFiles,
+	MPIHeaderRecord & record
+) {
+	if (sPos + sizeof(record) > vecBuffer.size()) {
+		_EXCEPTIONT("Truncated header record");
+	}
+	memcpy(&record, &(vecBuffer[sPos]), sizeof(record));
+	sPos += sizeof(record);
+	if ((record.ullIndex >= sFiles) ||
+	    (record.ullLength > vecBuffer.size() - sPos)
+	) {
+		_EXCEPTIONT("Invalid header record");
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Size at which a rank starts a new chunk of header records.
+///	</summary>
+static const size_t MPIRecordChunkBytes = (64 << 20);
+
+///	<summary>
+///		Header records of one rank, read on rank 0 in filename order.
+///		Each rank sends its tail first, holding the records of files not
+///		extracted in filename order, and then its other records in
+///		chunks in filename order, ending with an empty chunk.  A chunk is
+///		only received once rank 0 reaches its files.  The records of
+///		rank 0 itself are held in m_deqLocalChunks.
+///	</summary>
+class MPIHeaderRecordStream {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	MPIHeaderRecordStream() :
+		m_nRank(0),
+		m_sFiles(0),
+		m_fTailReceived(false),
+		m_sChunkPos(0),
+		m_fEnded(false)
+	{ }
+
+public:
+	///	<summary>
+	///		Receive and index the tail, if not yet done.  An error sent
+	///		by the rank is stored in m_strError.
+	///	</summary>
+	void ReceiveTail(
+		double & dIdleTime
+	) {
+		if (m_fTailReceived) {
+			return;
+		}
+		if (m_nRank != 0) {
+			Profiler::Clock::time_point tIdle = Profiler::Clock::now();
+			MPIRecvAppendBuffer(m_vecTail, m_nRank);
+			dIdleTime += Profiler::SecondsSince(tIdle);
+		}
+		m_fTailReceived = true;
+
+		for (size_t sPos = 0; sPos < m_vecTail.size(); ) {
+			MPIHeaderRecord record;
+			MPIReadHeaderRecord(m_vecTail, sPos, m_sFiles, record);
+			if (record.ullFlags & MPIRecordError) {
+				FileHeader header;
+				header.FromBuffer(m_vecTail, sPos);
+				m_strError = header.m_strError;
+				return;
+			}
+			m_mapTail[record.ullIndex] = std::make_pair(record, sPos);
+			sPos += record.ullLength;
+		}
+	}
+
+	///	<summary>
+	///		Find the record of file f in the tail and the position of its
+	///		header in m_vecTail.
+	///	</summary>
+	bool FindInTail(
+		size_t f,
+		MPIHeaderRecord & record,
+		size_t & sHeaderPos
+	) const {
+		std::map< size_t, std::pair<MPIHeaderRecord, size_t> >::const_iterator iter =
+			m_mapTail.find(f);
+		if (iter == m_mapTail.end()) {
+			return false;
+		}
+		record = iter->second.first;
+		sHeaderPos = iter->second.second;
+		return true;
+	}
+
+	///	<summary>
+	///		Read the next record in filename order and the position of its
+	///		header in m_vecChunk, receiving the next chunk if needed.
+	///		Returns false after the last record.
+	///	</summary>
+	bool Next(
+		MPIHeaderRecord & record,
+		size_t & sHeaderPos,
+		double & dIdleTime
+	) {
+		while (!m_fEnded && (m_sChunkPos >= m_vecChunk.size())) {
+			NextChunk(dIdleTime);
+		}
+		if (m_fEnded) {
+			return false;
+		}
+		MPIReadHeaderRecord(m_vecChunk, m_sChunkPos, m_sFiles, record);
+		sHeaderPos = m_sChunkPos;
+		m_sChunkPos += record.ullLength;
+		return true;
+	}
+
+	///	<summary>
+	///		Receive and discard all that the rank has yet to send.
+	///	</summary>
+	void Drain(
+		double & dIdleTime
+	) {
+		ReceiveTail(dIdleTime);
+		while (!m_fEnded) {
+			NextChunk(dIdleTime);
+		}
+	}
+
+protected:
+	///	<summary>
+	///		Replace the current chunk by the next one.
+	///	</summary>
+	void NextChunk(
+		double & dIdleTime
+	) {
+		m_vecChunk.clear();
+		m_sChunkPos = 0;
+		if (m_nRank == 0) {
+			if (m_deqLocalChunks.size() == 0) {
+				m_fEnded = true;
+				return;
+			}
+			m_vecChunk.swap(m_deqLocalChunks.front());
+			m_deqLocalChunks.pop_front();
+
+		} else {
+			Profiler::Clock::time_point tIdle = Profiler::Clock::now();
+			MPIRecvAppendBuffer(m_vecChunk, m_nRank);
+			dIdleTime += Profiler::SecondsSince(tIdle);
+			m_fEnded = (m_vecChunk.size() == 0);
+		}
+	}
+
+public:
+	///	<summary>
+	///		Rank sending the records and number of files indexed.
+	///	</summary>
+	int m_nRank;
+	size_t m_sFiles;
+
+	///	<summary>
+	///		Chunks not yet read, on rank 0 only.
+	///	</summary>
+	std::deque< std::vector<char> > m_deqLocalChunks;
+
+	///	<summary>
+	///		Tail and the record and header position of each file in it.
+	///	</summary>
+	std::vector<char> m_vecTail;
+	bool m_fTailReceived;
+	std::map< size_t, std::pair<MPIHeaderRecord, size_t> > m_mapTail;
+
+	///	<summary>
+	///		Error sent by the rank.
+	///	</summary>
+	std::string m_strError;
+
+	///	<summary>
+	///		Current chunk and position of the next record in it.
+	///	</summary>
+	std::vector<char> m_vecChunk;
+	size_t m_sChunkPos;
+
+	///	<summary>
+	///		Flag indicating the empty chunk ending the records was read.
+	///	</summary>
+	bool m_fEnded;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::IndexVariableDataDistributed(
+	const std::string & strBaseDir,
+	const std::vector<std::string> & vecFilenames,
+	const std::vector<FileStamp> * pvecStamps
+) {
+	int nRank;
+	int nCommSize;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nCommSize);
+
+	const size_t sFiles = vecFilenames.size();
+
+	Profiler::Clock::time_point tBusy = Profiler::Clock::now();
+	double dIdleTime = 0.0;
+
+	// Choose the files extracted by this rank, in filename order, and
+	// the rank extracting each file
+	std::vector<size_t> vecIndices;
+	std::vector<int> vecOwner(sFiles, 0);
+	std::vector<double> vecCosts;
+	if (m_eExtractionSchedule == ExtractionSchedule_Cost) {
+
+		// Each rank stats a contiguous block of files, and every rank
+		// estimates the costs of all files from their sizes
+		std::vector<int> vecCounts(nCommSize);
+		std::vector<int> vecDispls(nCommSize);
+		for (int r = 0; r < nCommSize; r++) {
+			vecDispls[r] = static_cast<int>((sFiles * r) / nCommSize);
+			vecCounts[r] =
+				static_cast<int>((sFiles * (r+1)) / nCommSize) - vecDispls[r];
+		}
+
+		std::vector<long long> vecBlockBytes;
+		std::vector<char> vecBlockCached;
+		StatExtractionFiles(
+			strBaseDir, vecFilenames, pvecStamps,
+			vecDispls[nRank], vecDispls[nRank] + vecCounts[nRank],
+			vecBlockBytes, vecBlockCached);
+
+		std::vector<long long> vecFileBytes(sFiles);
+		std::vector<char> vecCached(sFiles);
+		Profiler::Clock::time_point tIdle = Profiler::Clock::now();
+		MPI_Allgatherv(
+			(vecBlockBytes.size() != 0)?(&(vecBlockBytes[0])):(NULL),
+			vecCounts[nRank], MPI_LONG_LONG,
+			(sFiles != 0)?(&(vecFileBytes[0])):(NULL),
+			&(vecCounts[0]), &(vecDispls[0]), MPI_LONG_LONG, MPI_COMM_WORLD);
+		MPI_Allgatherv(
+			(vecBlockCached.size() != 0)?(&(vecBlockCached[0])):(NULL),
+			vecCounts[nRank], MPI_CHAR,
+			(sFiles != 0)?(&(vecCached[0])):(NULL),
+			&(vecCounts[0]), &(vecDispls[0]), MPI_CHAR, MPI_COMM_WORLD);
+		dIdleTime += Profiler::SecondsSince(tIdle);
+
+		ExtractionScheduler::EstimateCosts(vecFileBytes, vecCached, vecCosts);
+
+		// Every rank computes the same partition
+		std::vector< std::vector<size_t> > vecRankIndices;
+		ExtractionScheduler::Partition(
+			vecFilenames, vecCosts, nCommSize, vecRankIndices);
+		for (int r = 0; r < nCommSize; r++) {
+			for (size_t i = 0; i < vecRankIndices[r].size(); i++) {
+				vecOwner[vecRankIndices[r][i]] = r;
+			}
+		}
+		vecIndices.swap(vecRankIndices[nRank]);
+
+	} else {
+		// Each rank extracts a contiguous block of files
+		for (int r = 0; r < nCommSize; r++) {
+			const size_t sBegin = (sFiles * r) / nCommSize;
+			const size_t sEnd = (sFiles * (r+1)) / nCommSize;
+			for (size_t f = sBegin; f < sEnd; f++) {
+				vecOwner[f] = r;
+				if (r == nRank) {
+					vecIndices.push_back(f);
+				}
+			}
+		}
+	}
+
+	// Each rank applies the deadline and retries to its own files.  A
+	// header is serialized into a record as soon as it is extracted and
+	// then released.  Records in filename order go into chunks of at
+	// most about MPIRecordChunkBytes; those of retried files and files
+	// that still fail after all retries go into the tail.
+	unsigned long long ullFileBytes = 0;
+
+	std::deque< std::vector<char> > deqChunks;
+	std::vector<char> vecTail;
+	{
+		std::vector< std::shared_ptr<FileHeaderExtraction> > vecExtractions;
+		vecExtractions.reserve(vecIndices.size());
+		for (size_t f = 0; f < vecIndices.size(); f++) {
+			std::shared_ptr<FileHeaderExtraction> pextraction =
+				std::make_shared<FileHeaderExtraction>(
+					strBaseDir + vecFilenames[vecIndices[f]], 0);
+			pextraction->m_sFileIx = vecIndices[f];
+			if (vecCosts.size() != 0) {
+				pextraction->m_dCost = vecCosts[vecIndices[f]];
+			}
+			vecExtractions.push_back(pextraction);
+		}
+
+		bool fInOrder = false;
+		size_t sLastInOrder = 0;
+
+		std::vector< std::shared_ptr<FileHeaderExtraction> > vecFailed;
+		std::string strExtractError;
+		try {
+			strExtractError =
+				ExtractFileHeadersWithRetries(
+					vecExtractions,
+					[&](FileHeaderExtraction & extraction) {
+						if (fInOrder && (extraction.m_sFileIx <= sLastInOrder)) {
+							MPIAppendHeaderRecord(
+								vecTail,
+								extraction.m_sFileIx,
+								0,
+								extraction.m_sAttempts,
+								extraction.m_header);
+
+						} else {
+							if ((deqChunks.size() == 0) ||
+							    (deqChunks.back().size() >= MPIRecordChunkBytes)
+							) {
+								deqChunks.push_back(std::vector<char>());
+							}
+							MPIAppendHeaderRecord(
+								deqChunks.back(),
+								extraction.m_sFileIx,
+								0,
+								extraction.m_sAttempts,
+								extraction.m_header);
+							fInOrder = true;
+							sLastInOrder = extraction.m_sFileIx;
+						}
+						if (extraction.m_header.m_stamp.m_llSize > 0) {
+							ullFileBytes += extraction.m_header.m_stamp.m_llSize;
+						}
+						return std::string("");
+					},
+					vecFailed);
+
+		} catch(Exception & e) {
+			strExtractError = e.ToString();
+		}
+
+		// An error on this rank is passed on to rank 0 in the tail
+		if (strExtractError != "") {
+			FileHeader headerError;
+			headerError.m_strError = strExtractError;
+			MPIAppendHeaderRecord(
+				vecTail, 0, MPIRecordError, 0, headerError);
+			vecFailed.clear();
+		}
+
+		// The header of an extraction past its deadline may still be
+		// written by its worker, so only its filename is sent
+		for (size_t f = 0; f < vecFailed.size(); f++) {
+			const FileHeaderExtraction & extraction = *(vecFailed[f]);
+			FileHeader headerFailed;
+			headerFailed.m_strFilename = extraction.m_strFilename;
+			if (!extraction.m_fTimedOut) {
+				headerFailed.m_strError = extraction.m_header.GetError();
+			}
+			MPIAppendHeaderRecord(
+				vecTail,
+				extraction.m_sFileIx,
+				MPIRecordFailed
+					| ((extraction.m_fTimedOut)?(MPIRecordTimedOut):(0)),
+				extraction.m_sAttempts,
+				headerFailed);
+		}
+	}
+
+	// Other ranks send their tail and then each chunk, ending with an
+	// empty chunk.  Sends complete as rank 0 reaches the files of this
+	// rank, so time spent here is mostly spent waiting for rank 0.
+	std::string strError;
+	if (nRank != 0) {
+		Profiler::Clock::time_point tIdle = Profiler::Clock::now();
+		MPISendBuffer(vecTail, 0);
+		vecTail.clear();
+		while (deqChunks.size() != 0) {
+			MPISendBuffer(deqChunks.front(), 0);
+			deqChunks.pop_front();
+		}
+		MPISendBuffer(std::vector<char>(), 0);
+		dIdleTime += Profiler::SecondsSince(tIdle);
+
+	// Rank 0 merges the records of all ranks in filename order, holding
+	// at most one chunk of each other rank at a time
+	} else {
+		std::vector<MPIHeaderRecordStream> vecStreams(nCommSize);
+		for (int r = 0; r < nCommSize; r++) {
+			vecStreams[r].m_nRank = r;
+			vecStreams[r].m_sFiles = sFiles;
+		}
+		vecStreams[0].m_vecTail.swap(vecTail);
+		vecStreams[0].m_deqLocalChunks.swap(deqChunks);
+
+		try {
+			std::vector< std::shared_ptr<FileHeaderExtraction> > vecFailed;
+			for (size_t f = 0; f < sFiles; f++) {
+				MPIHeaderRecordStream & stream = vecStreams[vecOwner[f]];
+				stream.ReceiveTail(dIdleTime);
+				if (stream.m_strError != "") {
+					strError = stream.m_strError;
+					break;
+				}
+
+				MPIHeaderRecord record;
+				size_t sHeaderPos;
+				const std::vector<char> * pvecRecords = &(stream.m_vecTail);
+				if (!stream.FindInTail(f, record, sHeaderPos)) {
+					pvecRecords = &(stream.m_vecChunk);
+					if (!stream.Next(record, sHeaderPos, dIdleTime) ||
+					    (record.ullIndex != f)
+					) {
+						_EXCEPTION1("No header received for \"%s\"",
+							vecFilenames[f].c_str());
+					}
+				}
+
+				if (record.ullFlags & MPIRecordFailed) {
+					std::shared_ptr<FileHeaderExtraction> pextraction =
+						std::make_shared<FileHeaderExtraction>(
+							strBaseDir + vecFilenames[f],
+							record.ullAttempts);
+					pextraction->m_fTimedOut =
+						((record.ullFlags & MPIRecordTimedOut) != 0);
+					pextraction->m_header.FromBuffer(*pvecRecords, sHeaderPos);
+					vecFailed.push_back(pextraction);
+					continue;
+				}
+
+				FileHeader header;
+				header.FromBuffer(*pvecRecords, sHeaderPos);
+
+				strError = MergeFileHeader(header);
+				if (strError != "") {
+					break;
+				}
+			}
+
+			if (strError == "") {
+				strError = SkipFailedFiles(vecFailed);
+			}
+
+		} catch(Exception & e) {
+			strError = e.ToString();
+		}
+
+		// Receive what is left so that every send completes
+		for (int r = 1; r < nCommSize; r++) {
+			vecStreams[r].Drain(dIdleTime);
+		}
+	}
+
+	double dBusyTime = Profiler::SecondsSince(tBusy) - dIdleTime;
+
+	// Share the result of the merge so all ranks stop together; the other
+	// ranks wait here for rank 0 to finish the merge
+	Profiler::Clock::time_point tIdle = Profiler::Clock::now();
+	unsigned long long ullErrorLength = strError.length();
+	MPI_Bcast(&ullErrorLength, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
+	strError.resize(ullErrorLength);
+	if (ullErrorLength != 0) {
+		MPI_Bcast(&(strError[0]), (int)ullErrorLength, MPI_CHAR, 0, MPI_COMM_WORLD);
+	}
+	dIdleTime += Profiler::SecondsSince(tIdle);
+
+	Profiler::Shared().AddRankWork(
+		vecIndices.size(), ullFileBytes, dBusyTime, dIdleTime);
+
+	return strError;
+}
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::MergeFileHeader(
+	FileHeader & header
+) {
+	std::string strError;
+
+	Profiler::Clock::time_point tBegin = Profiler::Clock::now();
+
+	// Report errors encountered during extraction
+	if (header.m_exception) {
+		std::rethrow_exception(header.m_exception);
+	}
+	if (header.m_strError != "") {
+		return header.m_strError;
+	}
+
+	const std::string & strFullFilename = header.m_strFilename;
+
+	Announce(1, "Indexing %s", strFullFilename.c_str());
+
+	// Load in global attributes
+	if (GetFileCount() == 0) {
+		m_datainfo.m_mapKeyAttributes.insert(
+			header.m_datainfo.m_mapKeyAttributes.begin(),
+			header.m_datainfo.m_mapKeyAttributes.end());
+		m_datainfo.m_mapOtherAttributes.insert(
+			header.m_datainfo.m_mapOtherAttributes.begin(),
+			header.m_datainfo.m_mapOtherAttributes.end());
+	}
+
+	// Add a new FileInfo descriptor; a spilled FileInfo only lives
+	// until it has been merged
+	size_t sFileIndex = GetFileCount();
+	if (sFileIndex > static_cast<size_t>(UINT32_MAX)) {
+		return std::string("ERROR: Too many files in index");
+	}
+	const IndexId idFile = static_cast<IndexId>(sFileIndex);
+	std::string strFileId = IndexIdToString(idFile);
+	std::unique_ptr<FileInfo> pfileinfoSpilled;
+	if (m_pspill != NULL) {
+		pfileinfoSpilled.reset(new FileInfo(strFullFilename));
+	} else {
+		m_vecFileInfo.insert(
+			strFileId,
+			new FileInfo(strFullFilename));
+	}
+	FileInfo & fileinfo =
+		(m_pspill != NULL)
+		?(*pfileinfoSpilled)
+		:(*(m_vecFileInfo[sFileIndex]));
+	fileinfo.m_stamp = header.m_stamp;
+	fileinfo.m_mapKeyAttributes.swap(header.m_datainfo.m_mapKeyAttributes);
+	fileinfo.m_mapOtherAttributes.swap(header.m_datainfo.m_mapOtherAttributes);
+	fileinfo.RemoveRedundantOtherAttributes(m_datainfo);
+	if (m_pspill == NULL) {
+		m_fileattrblocks.Share(fileinfo);
+	}
+
+	// Files that are not checked skip the comparison of their dimension
+	// variables and attributes against the axes and variables indexed
+	const bool fValidate = SelectForValidation(header);
+
+	// Index all Dimensions
+	Announce(2, "..Loading dimensions");
+	for (size_t d = 0; d < header.m_vecDimensions.size(); d++) {
+		DimensionHeader & dimheader = header.m_vecDimensions[d];
+		const std::string & strAxisName = dimheader.m_strName;
+
+		// New axis, not yet indexed
+		bool fNewAxis = false;
+
+		LookupVectorHeap<std::string, AxisInfo>::iterator iteraxis =
+			m_vecAxisInfo.find(strAxisName);
+
+		AxisInfo * paxisinfo;
+		if (iteraxis == m_vecAxisInfo.end()) {
+			paxisinfo = new AxisInfo(strAxisName);
+			m_vecAxisInfo.insert(strAxisName, paxisinfo);
+			fNewAxis = true;
+
+		} else {
+			paxisinfo = *iteraxis;
+		}
+		AxisInfo & axisinfo = *paxisinfo;
+
+		// Dimension size
+		long lSize = dimheader.m_lSize;
+
+		// Build the candidate SubAxis in place, and only allocate it once
+		// it is known not to duplicate an existing SubAxis
+		SubAxis subaxis;
+		std::string strSubAxisId =
+			std::to_string((long long)axisinfo.m_vecSubAxis.size());
+
+		subaxis.m_lSize = lSize;
+
+		// Check for variable
+		const VariableHeader & varheader = dimheader.m_varheader;
+		if ((!dimheader.m_fHasVariable) && (axisinfo.m_nctype != ncNoType)) {
+			return std::string("ERROR: Dimension variable \"")
+				+ strAxisName
+				+ std::string("\" missing from file, but present in other files.");
+		}
+		if (dimheader.m_fHasVariable && (fValidate || fNewAxis)) {
+			if (varheader.m_vecDimNames.size() != 1) {
+				return std::string("ERROR: Dimension variable \"")
+					+ varheader.m_strName
+					+ std::string("\" must have exactly 1 dimension");
+			}
+			if (varheader.m_vecDimNames[0] != strAxisName) {
+				return std::string("ERROR: Dimension variable \"")
+					+ varheader.m_strName
+					+ std::string("\" does not have dimension \"")
+					+ strAxisName
+					+ std::string("\"");
+			}
+		}
+		if (dimheader.m_fHasVariable) {
+
+			// Set or verify the axis type, which determines how the
+			// values are stored and so is checked for every file
+			if (fNewAxis) {
+				axisinfo.m_nctype = varheader.m_nctype;
+
+			} else if (axisinfo.m_nctype != varheader.m_nctype) {
+				return std::string("ERROR: Dimension variable \"")
+					+ varheader.m_strName
+					+ std::string("\" type mismatch.  Possible"
+					" duplicate dimension name in dataset.");
+			}
+			subaxis.m_nctype = axisinfo.m_nctype;
+
+			// Check for units attribute
+			if (fNewAxis || fValidate) {
+				axisinfo.FromVariableHeader(varheader, !fNewAxis);
+			}
+
+			// Initialize the DataObjectInfo from the NcVar
+			strError = subaxis.FromVariableHeader(varheader, false);
+			if (strError != "") {
+				return strError;
+			}
+
+			// Get the values from the dimension
+			if (!IsNumericNcType(axisinfo.m_nctype)) {
+				_EXCEPTION1("Unsupported dimension nctype \"%s\"",
+					NcTypeToString(axisinfo.m_nctype).c_str());
+			}
+			subaxis.m_values.swap(dimheader.m_values);
+
+			// Summarize long values, keeping track of where they came from
+			if (dimheader.m_fSummarized) {
+				subaxis.m_fSummarized = true;
+				subaxis.m_summary = dimheader.m_summary;
+			} else if ((m_sSummarizeSize != 0) &&
+			           (static_cast<size_t>(lSize) > m_sSummarizeSize)
+			) {
+				subaxis.Summarize();
+			}
+			if (subaxis.m_fSummarized) {
+				subaxis.m_strSourceFile = header.m_strFilename;
+			} else {
+				subaxis.DetectLinear();
+			}
+		}
+
+		// Check if SubAxis already exists
+		std::string strExistingSubAxisId = axisinfo.FindSubAxis(subaxis);
+		Profiler::Shared().AddSubAxisDedup(strExistingSubAxisId != "");
+		if (strExistingSubAxisId != "") {
+			strSubAxisId = strExistingSubAxisId;
+		} else {
+			axisinfo.InsertSubAxis(strSubAxisId, new SubAxis(std::move(subaxis)));
+		}
+
+		// Add axis/subaxis pair to FileInfo
+		fileinfo.m_mapAxisSubAxis.insert(
+			AxisSubAxisPair(strAxisName, strSubAxisId));
+	}
+
+	// Loop over all Variables
+	Announce(2, "..Loading variables");
+	for (size_t v = 0; v < header.m_vecVariables.size(); v++) {
+		const VariableHeader & varheader = header.m_vecVariables[v];
+
+		const std::string & strVariableName = varheader.m_strName;
+
+		// Don't index dimension variables
+		if (m_vecAxisInfo.find(strVariableName) != m_vecAxisInfo.end()) {
+			continue;
+		}
+
+		//printf("....Variable %i (%s)\n", v, strVariableName.c_str());
+
+		// New variable, not yet indexed
+		bool fNewVariable = false;
+
+		LookupVectorHeap<std::string, VariableInfo>::iterator itervar =
+			m_vecVariableInfo.find(strVariableName);
+
+		VariableInfo * pvarinfo;
+		if (itervar == m_vecVariableInfo.end()) {
+			pvarinfo = new VariableInfo(strVariableName);
+			m_vecVariableInfo.insert(strVariableName, pvarinfo);
+			fNewVariable = true;
+
+		} else {
+			pvarinfo = *itervar;
+		}
+		VariableInfo & varinfo = *pvarinfo;
+
+		// Initialize the DataObjectInfo from the NcVar
+		if (fNewVariable || fValidate) {
+			strError = varinfo.FromVariableHeader(varheader, !fNewVariable);
+			if (strError != "") return strError;
+		}
+
+		// Storage layouts are compared for every file, since they are
+		// not part of the structure hash used to sample files
+		if (varinfo.MergeStorage(varheader.m_storage)) {
+			AnnounceWarning("Variable \"%s\" has inconsistent storage "
+				"layout across files", strVariableName.c_str());
+		}
+
+		// Record the statistics of the variable in this file
+		if ((v < header.m_vecStatistics.size()) &&
+		    !header.m_vecStatistics[v].IsEmpty()
+		) {
+			const VariableStatistics & stats = header.m_vecStatistics[v];
+			fileinfo.m_mapVariableStatistics[strVariableName] = stats;
+			varinfo.m_statistics.Add(stats);
+		}
+
+		// Build the SubAxisCoordinate
+		AxisNameVector vecAxisNames;
+		SubAxisIdVector vecSubAxisIds;
+		for (size_t d = 0; d < varheader.m_vecDimNames.size(); d++) {
+			const std::string & strAxisName = varheader.m_vecDimNames[d];
+			vecAxisNames.push_back(strAxisName);
+
+			AxisSubAxisMap::const_iterator iterSubAxisId =
+				fileinfo.m_mapAxisSubAxis.find(strAxisName);
+			if (iterSubAxisId == fileinfo.m_mapAxisSubAxis.end()) {
+				_EXCEPTIONT("Logic error");
+			}
+			IndexId idSubAxis;
+			if (!IndexIdFromString(iterSubAxisId->second, idSubAxis)) {
+				return std::string("ERROR: Subaxis id \"")
+					+ iterSubAxisId->second
+					+ std::string("\" of axis \"") + strAxisName
+					+ std::string("\" is not an integer");
+			}
+			vecSubAxisIds.push_back(idSubAxis);
+		}
+
+		// Get subaxis to file id map
+		AxisNamesToSubAxisToFileIdMapMap::iterator iterAxisToFileIdMap =
+			varinfo.m_mapSubAxisToFileIdMaps.find(vecAxisNames);
+		if (iterAxisToFileIdMap == varinfo.m_mapSubAxisToFileIdMaps.end()) {
+			std::pair<AxisNamesToSubAxisToFileIdMapMap::iterator, bool> pri =
+				varinfo.m_mapSubAxisToFileIdMaps.insert(
+					AxisNamesToSubAxisToFileIdMapMap::value_type(
+						vecAxisNames,
+						SubAxisToFileIdMap()));
+
+			if (!pri.second) {
+				_EXCEPTIONT("Logic error");
+			}
+
+			iterAxisToFileIdMap = pri.first;
+		}
+		SubAxisToFileIdMap & mapSubAxisToFileId =
+			iterAxisToFileIdMap->second;
+
+		// Insert this subaxis into the map
+		mapSubAxisToFileId.insert(vecSubAxisIds, idFile);
+/*
+		// Load dimension information
+		const int nDims = var->num_dims();
+
+		varinfo.m_vecDimNames.resize(nDims);
+		varinfo.m_vecDimSizes.resize(nDims);
+		for (int d = 0; d < nDims; d++) {
+			varinfo.m_vecDimNames[d] = var->get_dim(d)->name();
+
+			if (varinfo.m_vecDimNames[d] == m_strRecordDimName) {
+				if (varinfo.m_iTimeDimIx == (-1)) {
+					varinfo.m_iTimeDimIx = d;
+				} else if (info.m_iTimeDimIx != d) {
+					return std::string("ERROR: Variable \"") + strVariableName
+						+ std::string("\" has inconsistent \"time\" dimension across files");
+				}
+				varinfo.m_vecDimSizes[d] = (-1);
+			} else {
+				varinfo.m_vecDimSizes[d] = var->get_dim(d)->size();
+			}
+
+			if ((varinfo.m_vecDimNames[d] == "lev") ||
+				(varinfo.m_vecDimNames[d] == "pres") ||
+				(varinfo.m_vecDimNames[d] == "z") ||
+				(varinfo.m_vecDimNames[d] == "plev")
+			) {
+				if (varinfo.m_iVerticalDimIx != (-1)) {
+					if (varinfo.m_iVerticalDimIx != d) {
+						return std::string("ERROR: Possibly multiple vertical dimensions in variable ")
+							+ info.m_strName;
+					}
+				}
+				varinfo.m_iVerticalDimIx = d;
+			}
+		}
+*/
+/*
+		// Determine direction of vertical dimension
+		if (info.m_iVerticalDimIx != (-1)) {
+			AxisInfoMap::iterator iterDimInfo =
+				m_mapAxisInfo.find(info.m_vecDimNames[info.m_iVerticalDimIx]);
+
+			if (iterDimInfo != m_mapAxisInfo.end()) {
+				info.m_nVerticalDimOrder = iterDimInfo->second.m_nOrder;
+
+			} else {
+				_EXCEPTIONT("Logic error");
+			}
+		}
+*/
+	}
+
+	if (m_pspill != NULL) {
+		strError = m_pspill->Append(fileinfo);
+		if (strError != "") {
+			return strError;
+		}
+	}
+
+	if (m_fReportProgress) {
+		AnnounceProgressAdvance();
+	}
+
+	const double dMergeTime = Profiler::SecondsSince(tBegin);
+	Profiler & profiler = Profiler::Shared();
+	profiler.AddFileStage(ProfilerFileStage_Merge, dMergeTime);
+	profiler.AddFile(
+		strFullFilename,
+		header.m_dOpenTime,
+		header.m_dHeaderTime,
+		dMergeTime);
+
+	// Walk the index as it doubles in size, so the peak footprint is
+	// tracked during indexing at a cost linear in the number of files
+	const size_t sFiles = GetFileCount();
+	if (profiler.IsEnabled() && (sFiles >= 1024) && ((sFiles & (sFiles - 1)) == 0)) {
+		RecordMemoryFootprint();
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool IndexedDataset::SelectForValidation(
+	const FileHeader & header
+) {
+	bool fValidate = true;
+
+	if (m_eValidationLevel == ValidationLevel_Sample) {
+		if (!m_setValidatedHashes.insert(header.GetStructureHash()).second) {
+			fValidate =
+				(LookupTraits<std::string>::Hash(header.m_strFilename)
+					% ValidationSampleInterval == 0);
+		}
+
+	} else if (m_eValidationLevel == ValidationLevel_None) {
+		fValidate = m_setValidatedHashes.insert(header.GetHeaderHash()).second;
+	}
+
+	if (fValidate) {
+		m_sValidatedFiles++;
+	} else {
+		m_sTrustedFiles++;
+	}
+	return fValidate;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void IndexedDataset::RemoveFileReferences(
+	const std::set<std::string> & setFileIds
+) {
+	if (setFileIds.size() == 0) {
+		return;
+	}
+
+	std::set<IndexId> setIds;
+	std::set<std::string>::const_iterator iterFileId = setFileIds.begin();
+	for (; iterFileId != setFileIds.end(); iterFileId++) {
+		IndexId idFile;
+		if (IndexIdFromString(*iterFileId, idFile)) {
+			setIds.insert(idFile);
+		}
+	}
+
+	for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
+		VariableInfo & varinfo = *(m_vecVariableInfo[v]);
+
+		AxisNamesToSubAxisToFileIdMapMap::iterator iterAxisGroup =
+			varinfo.m_mapSubAxisToFileIdMaps.begin();
+		for (; iterAxisGroup != varinfo.m_mapSubAxisToFileIdMaps.end(); iterAxisGroup++) {
+			SubAxisToFileIdMap & mapSubAxisToFileId = iterAxisGroup->second;
+			const AxisNameVector & vecAxisNames = iterAxisGroup->first;
+			const size_t sWidth = mapSubAxisToFileId.width();
+
+			mapSubAxisToFileId.erase_if(
+				[&](const IndexId * pSubAxisIds, IndexId idFile) {
+					if (setIds.find(idFile) == setIds.end()) {
+						return false;
+					}
+					if (m_fIncremental) {
+						m_setOrphanedKeys.insert(
+							VariableSubAxisKey(
+								varinfo.m_strName,
+								std::pair<AxisNameVector, SubAxisIdVector>(
+									vecAxisNames,
+									SubAxisIdVector(
+										pSubAxisIds, pSubAxisIds + sWidth))));
+					}
+					return true;
+				});
+		}
+	}
+
+	// Statistics of variables cannot be reduced by a file, so they are
+	// recomputed from the files that remain
+	bool fHadStatistics = false;
+	std::set<std::string>::const_iterator iterStale = setFileIds.begin();
+	for (; iterStale != setFileIds.end(); iterStale++) {
+		LookupVectorHeap<std::string, FileInfo>::iterator iterfile =
+			m_vecFileInfo.find(*iterStale);
+		if ((iterfile != m_vecFileInfo.end()) &&
+		    ((*iterfile)->m_mapVariableStatistics.size() != 0)
+		) {
+			(*iterfile)->m_mapVariableStatistics.clear();
+			fHadStatistics = true;
+		}
+	}
+	if (fHadStatistics) {
+		RebuildVariableStatistics();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void IndexedDataset::RebuildVariableStatistics() {
+	for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
+		m_vecVariableInfo[v]->m_statistics = VariableStatistics();
+	}
+
+	auto AddFile = [&](const std::string &, const FileInfo & fileinfo) {
+		std::map<std::string, VariableStatistics>::const_iterator iterStats =
+			fileinfo.m_mapVariableStatistics.begin();
+		for (; iterStats != fileinfo.m_mapVariableStatistics.end(); iterStats++) {
+			LookupVectorHeap<std::string, VariableInfo>::iterator itervar =
+				m_vecVariableInfo.find(iterStats->first);
+			if (itervar != m_vecVariableInfo.end()) {
+				(*itervar)->m_statistics.Add(iterStats->second);
+			}
+		}
+	};
+
+	if (m_pspill != NULL) {
+		m_pspill->ForEachInIdOrder(AddFile);
+	} else {
+		LookupVectorHeap<std::string, FileInfo>::iterator iterfile =
+			m_vecFileInfo.begin();
+		for (; iterfile != m_vecFileInfo.end(); iterfile++) {
+			AddFile(iterfile.key(), *(*iterfile));
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void IndexedDataset::CompactIndex(
+	const std::set<std::string> & setRemovedFileIds
+) {
+	if (setRemovedFileIds.size() == 0) {
+		return;
+	}
+
+	// Renumber the remaining files
+	std::map<std::string, std::string> mapNewFileIds;
+	{
+		std::vector<std::string> vecFileIds;
+		LookupVectorHeap<std::string, FileInfo>::iterator iterfile =
+			m_vecFileInfo.begin();
+		for (; iterfile != m_vecFileInfo.end(); iterfile++) {
+			if (setRemovedFileIds.find(iterfile.key()) == setRemovedFileIds.end()) {
+				vecFileIds.push_back(iterfile.key());
+			} else {
+				delete (*iterfile);
+			}
+		}
+		SortIds(vecFileIds);
+
+		LookupVectorHeap<std::string, FileInfo> vecFileInfo;
+		for (size_t f = 0; f < vecFileIds.size(); f++) {
+			std::string strNewFileId = std::to_string((long long)f);
+			vecFileInfo.insert(
+				strNewFileId, *(m_vecFileInfo.find(vecFileIds[f])));
+			mapNewFileIds[vecFileIds[f]] = strNewFileId;
+		}
+		m_vecFileInfo.release();
+		m_vecFileInfo.swap(vecFileInfo);
+	}
+
+	// Find subaxes still referenced by a file
+	std::map<std::string, std::map<std::string, std::string> > mapNewSubAxisIds;
+	for (size_t f = 0; f < m_vecFileInfo.size(); f++) {
+		const AxisSubAxisMap & mapAxisSubAxis = m_vecFileInfo[f]->m_mapAxisSubAxis;
+		AxisSubAxisMap::const_iterator iter = mapAxisSubAxis.begin();
+		for (; iter != mapAxisSubAxis.end(); iter++) {
+			mapNewSubAxisIds[iter->first][iter->second] = "";
+		}
+	}
+
+	// Remove unreferenced subaxes and axes, and renumber subaxes
+	{
+		LookupVectorHeap<std::string, AxisInfo> vecAxisInfo;
+		for (size_t a = 0; a < m_vecAxisInfo.size(); a++) {
+			AxisInfo * paxisinfo = m_vecAxisInfo[a];
+
+			std::map<std::string, std::map<std::string, std::string> >::iterator
+				iterAxis = mapNewSubAxisIds.find(paxisinfo->m_strName);
+			if (iterAxis == mapNewSubAxisIds.end()) {
+				delete paxisinfo;
+				continue;
+			}
+			std::map<std::string, std::string> & mapSubAxisIds = iterAxis->second;
+
+			std::vector<std::string> vecSubAxisIds;
+			AxisInfo::SubAxisVector::iterator itersubaxis =
+				paxisinfo->m_vecSubAxis.begin();
+			for (; itersubaxis != paxisinfo->m_vecSubAxis.end(); itersubaxis++) {
+				if (mapSubAxisIds.find(itersubaxis.key()) != mapSubAxisIds.end()) {
+					vecSubAxisIds.push_back(itersubaxis.key());
+				} else {
+					delete (*itersubaxis);
+				}
+			}
+			SortIds(vecSubAxisIds);
+
+			AxisInfo::SubAxisVector vecSubAxis;
+			for (size_t s = 0; s < vecSubAxisIds.size(); s++) {
+				std::string strNewSubAxisId = std::to_string((long long)s);
+				vecSubAxis.insert(
+					strNewSubAxisId,
+					*(paxisinfo->m_vecSubAxis.find(vecSubAxisIds[s])));
+				mapSubAxisIds[vecSubAxisIds[s]] = strNewSubAxisId;
+			}
+			paxisinfo->m_vecSubAxis.release();
+			paxisinfo->m_vecSubAxis.swap(vecSubAxis);
+			paxisinfo->RebuildSubAxisIndex();
+
+			vecAxisInfo.insert(paxisinfo->m_strName, paxisinfo);
+		}
+		m_vecAxisInfo.release();
+		m_vecAxisInfo.swap(vecAxisInfo);
+	}
+
+	// Update subaxis ids in files
+	for (size_t f = 0; f < m_vecFileInfo.size(); f++) {
+		AxisSubAxisMap & mapAxisSubAxis = m_vecFileInfo[f]->m_mapAxisSubAxis;
+		AxisSubAxisMap::iterator iter = mapAxisSubAxis.begin();
+		for (; iter != mapAxisSubAxis.end(); iter++) {
+			iter->second = mapNewSubAxisIds[iter->first][iter->second];
+		}
+	}
+
+	// Integer forms of the renumbering
+	std::map<IndexId, IndexId> mapNewFileIndexIds;
+	{
+		std::map<std::string, std::string>::const_iterator iter =
+			mapNewFileIds.begin();
+		for (; iter != mapNewFileIds.end(); iter++) {
+			IndexId idOld;
+			IndexId idNew;
+			if (IndexIdFromString(iter->first, idOld) &&
+			    IndexIdFromString(iter->second, idNew)
+			) {
+				mapNewFileIndexIds[idOld] = idNew;
+			}
+		}
+	}
+	std::map<std::string, std::map<IndexId, IndexId> > mapNewSubAxisIndexIds;
+	{
+		std::map<std::string, std::map<std::string, std::string> >::const_iterator
+			iterAxis = mapNewSubAxisIds.begin();
+		for (; iterAxis != mapNewSubAxisIds.end(); iterAxis++) {
+			std::map<IndexId, IndexId> & mapAxisIds =
+				mapNewSubAxisIndexIds[iterAxis->first];
+			std::map<std::string, std::string>::const_iterator iter =
+				iterAxis->second.begin();
+			for (; iter != iterAxis->second.end(); iter++) {
+				IndexId idOld;
+				IndexId idNew;
+				if (IndexIdFromString(iter->first, idOld) &&
+				    IndexIdFromString(iter->second, idNew)
+				) {
+					mapAxisIds[idOld] = idNew;
+				}
+			}
+		}
+	}
+
+	// Update file and subaxis ids in variables, removing variables that
+	// no longer appear in any file
+	{
+		LookupVectorHeap<std::string, VariableInfo> vecVariableInfo;
+		for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
+			VariableInfo * pvarinfo = m_vecVariableInfo[v];
+
+			AxisNamesToSubAxisToFileIdMapMap mapSubAxisToFileIdMaps;
+
+			AxisNamesToSubAxisToFileIdMapMap::const_iterator iterAxisGroup =
+				pvarinfo->m_mapSubAxisToFileIdMaps.begin();
+			for (; iterAxisGroup != pvarinfo->m_mapSubAxisToFileIdMaps.end(); iterAxisGroup++) {
+				const AxisNameVector & vecAxisNames = iterAxisGroup->first;
+				const SubAxisToFileIdMap & mapSubAxisToFileIdOld =
+					iterAxisGroup->second;
+
+				if ((mapSubAxisToFileIdOld.size() != 0) &&
+				    (mapSubAxisToFileIdOld.width() != vecAxisNames.size())
+				) {
+					_EXCEPTIONT("Logic error");
+				}
+
+				std::vector<std::map<IndexId, IndexId> *> vecAxisIds;
+				for (size_t d = 0; d < vecAxisNames.size(); d++) {
+					vecAxisIds.push_back(&(mapNewSubAxisIndexIds[vecAxisNames[d]]));
+				}
+
+				SubAxisToFileIdMap mapSubAxisToFileId;
+				SubAxisIdVector vecSubAxisIds(vecAxisNames.size());
+				for (size_t i = 0; i < mapSubAxisToFileIdOld.size(); i++) {
+					std::map<IndexId, IndexId>::const_iterator iterFileId =
+						mapNewFileIndexIds.find(mapSubAxisToFileIdOld.fileid(i));
+					if (iterFileId == mapNewFileIndexIds.end()) {
+						continue;
+					}
+
+					const IndexId * pSubAxisIds =
+						mapSubAxisToFileIdOld.subaxisids(i);
+					for (size_t d = 0; d < vecSubAxisIds.size(); d++) {
+						vecSubAxisIds[d] = (*(vecAxisIds[d]))[pSubAxisIds[d]];
+					}
+
+					mapSubAxisToFileId.insert(vecSubAxisIds, iterFileId->second);
+				}
+
+				if (mapSubAxisToFileId.size() != 0) {
+					mapSubAxisToFileIdMaps.insert(
+						AxisNamesToSubAxisToFileIdMapMap::value_type(
+							vecAxisNames, SubAxisToFileIdMap()))
+						.first->second.swap(mapSubAxisToFileId);
+				}
+			}
+
+			if ((mapSubAxisToFileIdMaps.size() == 0) &&
+			    (pvarinfo->m_mapSubAxisToFileIdMaps.size() != 0)
+			) {
+				delete pvarinfo;
+				continue;
+			}
+
+			pvarinfo->m_mapSubAxisToFileIdMaps.swap(mapSubAxisToFileIdMaps);
+			vecVariableInfo.insert(pvarinfo->m_strName, pvarinfo);
+		}
+		m_vecVariableInfo.release();
+		m_vecVariableInfo.swap(vecVariableInfo);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the calendar attribute of a data object, or an empty string
+///		if it has none.
+///	</summary>
+static std::string GetCalendarAttribute(
+	const DataObjectInfo & info
+) {
+	static const InternedString strCalendar("calendar");
+
+	AttributeMap::const_iterator iterAtt =
+		info.m_mapOtherAttributes.find(strCalendar);
+	if (iterAtt != info.m_mapOtherAttributes.end()) {
+		return iterAtt->second.str();
+	}
+	iterAtt = info.m_mapKeyAttributes.find(strCalendar);
+	if (iterAtt != info.m_mapKeyAttributes.end()) {
+		return iterAtt->second.str();
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Kernel converting time offsets to TimeKeys.
+///	</summary>
+struct ValuesTimeKeysKernel {
+	const TypedValueArray & values;
+	const CFTimeUnits & timeunits;
+	std::vector<long long> & vecKeys;
+
+	template <typename T>
+	void Apply() {
+		vecKeys.resize(values.size());
+		timeunits.ToTimeKeys(values.Data<T>(), values.size(), vecKeys.data());
+	}
+};
+
+///	<summary>
+///		Convert the values of a SubAxis to TimeKeys.  A SubAxis of a
+///		type other than the numeric types has none.
+///	</summary>
+static void SubAxisTimeKeys(
+	const SubAxis & subaxis,
+	const CFTimeUnits & timeunits,
+	std::vector<long long> & vecKeys
+) {
+	vecKeys.clear();
+	ValuesTimeKeysKernel kernel = {subaxis.m_values, timeunits, vecKeys};
+	DispatchNumericNcType(subaxis.m_nctype, kernel);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::BuildTimeIndex(
+	const std::string & strTimeAxisName
+) {
+	m_strTimeAxisName = strTimeAxisName;
+	m_vecTimes.clear();
+	for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
+		m_vecVariableInfo[v]->m_mapTimeFile.clear();
+	}
+
+#if defined(HYPERION_MPIOMP)
+	// The index is only held on the root thread
+	int nRank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	if (nRank != 0) {
+		return std::string("");
+	}
+#endif
+
+	LookupVectorHeap<std::string, AxisInfo>::iterator iteraxis =
+		m_vecAxisInfo.find(strTimeAxisName);
+	if (iteraxis == m_vecAxisInfo.end()) {
+		return std::string("ERROR: Time axis \"") + strTimeAxisName
+			+ std::string("\" not found in index");
+	}
+	const AxisInfo & axisinfo = *(*iteraxis);
+
+	if (!IsNumericNcType(axisinfo.m_nctype)) {
+		return std::string("ERROR: Time axis \"") + strTimeAxisName
+			+ std::string("\" must have a dimension variable of"
+			" numeric type");
+	}
+
+	const std::string strAxisCalendar = GetCalendarAttribute(axisinfo);
+
+	// Convert the values of each subaxis to TimeKeys, parsing each
+	// distinct units and calendar once
+	typedef std::pair<std::string, std::string> UnitsCalendarPair;
+	std::map<UnitsCalendarPair, CFTimeUnits> mapTimeUnits;
+
+	std::map<std::string, std::vector<long long> > mapSubAxisKeys;
+	std::vector<long long> vecAllKeys;
+
+	Time::CalendarType eCalendarType = Time::CalendarUnknown;
+
+	AxisInfo::SubAxisVector::const_iterator itersubaxis =
+		axisinfo.m_vecSubAxis.begin();
+	for (; itersubaxis != axisinfo.m_vecSubAxis.end(); itersubaxis++) {
+		const SubAxis & subaxis = *(*itersubaxis);
+
+		if (subaxis.m_fSummarized) {
+			return std::string("ERROR: Time axis \"") + strTimeAxisName
+				+ std::string("\" has summarized values; rerun with"
+				" --expand_summaries");
+		}
+
+		UnitsCalendarPair prUnitsCalendar(
+			(subaxis.m_strUnits != "")?(subaxis.m_strUnits):(axisinfo.m_strUnits),
+			GetCalendarAttribute(subaxis));
+		if (prUnitsCalendar.second == "") {
+			prUnitsCalendar.second = strAxisCalendar;
+		}
+
+		std::map<UnitsCalendarPair, CFTimeUnits>::iterator iterUnits =
+			mapTimeUnits.find(prUnitsCalendar);
+		if (iterUnits == mapTimeUnits.end()) {
+			iterUnits = mapTimeUnits.insert(
+				std::pair<UnitsCalendarPair, CFTimeUnits>(
+					prUnitsCalendar, CFTimeUnits())).first;
+
+			std::string strError =
+				iterUnits->second.Parse(
+					prUnitsCalendar.first,
+					prUnitsCalendar.second);
+			if (strError != "") {
+				return std::string("ERROR: Time axis \"") + strTimeAxisName
+					+ std::string("\": ") + strError;
+			}
+		}
+		const CFTimeUnits & timeunits = iterUnits->second;
+
+		// Times on different calendars cannot be ordered
+		if (eCalendarType == Time::CalendarUnknown) {
+			eCalendarType = timeunits.GetCalendarType();
+		} else if (eCalendarType != timeunits.GetCalendarType()) {
+			return std::string("ERROR: Time axis \"") + strTimeAxisName
+				+ std::string("\" has inconsistent calendars across files");
+		}
+
+		std::vector<long long> & vecKeys =
+			mapSubAxisKeys[itersubaxis.key()];
+		SubAxisTimeKeys(subaxis, timeunits, vecKeys);
+		vecAllKeys.insert(vecAllKeys.end(), vecKeys.begin(), vecKeys.end());
+	}
+
+	// Sort and merge the TimeKeys of all subaxes
+	std::sort(vecAllKeys.begin(), vecAllKeys.end());
+	vecAllKeys.erase(
+		std::unique(vecAllKeys.begin(), vecAllKeys.end()),
+		vecAllKeys.end());
+
+	m_vecTimes.reserve(vecAllKeys.size());
+	for (size_t t = 0; t < vecAllKeys.size(); t++) {
+		m_vecTimes.push_back(
+			CFTimeUnits::TimeFromKey(vecAllKeys[t], eCalendarType));
+	}
+
+	// Index of each time of each subaxis in m_vecTimes
+	std::map<IndexId, std::vector<size_t> > mapSubAxisTimeIxs;
+	std::map<std::string, std::vector<long long> >::const_iterator iterkeys =
+		mapSubAxisKeys.begin();
+	for (; iterkeys != mapSubAxisKeys.end(); iterkeys++) {
+		IndexId idSubAxis;
+		if (!IndexIdFromString(iterkeys->first, idSubAxis)) {
+			return std::string("ERROR: Subaxis id \"") + iterkeys->first
+				+ std::string("\" of time axis \"") + strTimeAxisName
+				+ std::string("\" is not an integer");
+		}
+		const std::vector<long long> & vecKeys = iterkeys->second;
+		std::vector<size_t> & vecTimeIxs = mapSubAxisTimeIxs[idSubAxis];
+		vecTimeIxs.resize(vecKeys.size());
+		for (size_t t = 0; t < vecKeys.size(); t++) {
+			vecTimeIxs[t] = static_cast<size_t>(
+				std::lower_bound(vecAllKeys.begin(), vecAllKeys.end(), vecKeys[t])
+					- vecAllKeys.begin());
+		}
+	}
+
+	// Index of each file id in m_vecFileInfo
+	std::map<const FileInfo *, size_t> mapFileInfoIx;
+	for (size_t f = 0; f < m_vecFileInfo.size(); f++) {
+		mapFileInfoIx[m_vecFileInfo[f]] = f;
+	}
+	std::map<IndexId, size_t> mapFileIdIx;
+	LookupVectorHeap<std::string, FileInfo>::iterator iterfile =
+		m_vecFileInfo.begin();
+	for (; iterfile != m_vecFileInfo.end(); iterfile++) {
+		IndexId idFile;
+		if (IndexIdFromString(iterfile.key(), idFile)) {
+			mapFileIdIx[idFile] = mapFileInfoIx[*iterfile];
+		}
+	}
+
+	// Map the times of each variable on the time axis to files; entries
+	// are sorted by time so that the map is built in linear time, and the
+	// first entry is kept where several provide the same time
+	std::vector< std::pair<size_t, LocalFileTimePair> > vecTimeFile;
+	for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
+		VariableInfo & varinfo = *(m_vecVariableInfo[v]);
+
+		vecTimeFile.clear();
+
+		AxisNamesToSubAxisToFileIdMapMap::const_iterator itergroup =
+			varinfo.m_mapSubAxisToFileIdMaps.begin();
+		for (; itergroup != varinfo.m_mapSubAxisToFileIdMaps.end(); itergroup++) {
+			const AxisNameVector & vecAxisNames = itergroup->first;
+
+			size_t sTimeDim = 0;
+			for (; sTimeDim < vecAxisNames.size(); sTimeDim++) {
+				if (vecAxisNames[sTimeDim] == strTimeAxisName) {
+					break;
+				}
+			}
+			if (sTimeDim == vecAxisNames.size()) {
+				continue;
+			}
+
+			const SubAxisToFileIdMap & mapSubAxisToFileId = itergroup->second;
+			for (size_t i = 0; i < mapSubAxisToFileId.size(); i++) {
+				std::map<IndexId, std::vector<size_t> >::const_iterator iterixs =
+					mapSubAxisTimeIxs.find(
+						mapSubAxisToFileId.subaxisids(i)[sTimeDim]);
+				std::map<IndexId, size_t>::const_iterator iterfileix =
+					mapFileIdIx.find(mapSubAxisToFileId.fileid(i));
+				if ((iterixs == mapSubAxisTimeIxs.end()) ||
+				    (iterfileix == mapFileIdIx.end())
+				) {
+					_EXCEPTIONT("Logic error");
+				}
+
+				const std::vector<size_t> & vecTimeIxs = iterixs->second;
+				for (size_t t = 0; t < vecTimeIxs.size(); t++) {
+					vecTimeFile.push_back(
+						std::pair<size_t, LocalFileTimePair>(
+							vecTimeIxs[t],
+							LocalFileTimePair(
+								iterfileix->second,
+								static_cast<int>(t))));
+				}
+			}
+		}
+
+		std::stable_sort(vecTimeFile.begin(), vecTimeFile.end(),
+			[](const std::pair<size_t, LocalFileTimePair> & a,
+			   const std::pair<size_t, LocalFileTimePair> & b) {
+				return (a.first < b.first);
+			});
+
+		size_t sRepeated = 0;
+		for (size_t i = 0; i < vecTimeFile.size(); i++) {
+			if ((i != 0) && (vecTimeFile[i].first == vecTimeFile[i-1].first)) {
+				sRepeated++;
+				continue;
+			}
+			varinfo.m_mapTimeFile.insert(
+				varinfo.m_mapTimeFile.end(),
+				vecTimeFile[i]);
+		}
+		if (sRepeated != 0) {
+			AnnounceWarning("Variable \"%s\" has %lu repeated times across"
+				" files; only the first file is indexed for each",
+				varinfo.m_strName.c_str(), sRepeated);
+		}
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t IndexedDataset::BuildFileIdLookups() {
+	size_t sDense = 0;
+	size_t sGroups = 0;
+	for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
+		sDense += m_vecVariableInfo[v]->BuildFileIdLookups();
+		sGroups += m_vecVariableInfo[v]->m_mapSubAxisToFileIdMaps.size();
+	}
+	Announce(1, "Built dense file lookups for %lu of %lu axis groups",
+		sDense, sGroups);
+	return sDense;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the values of a SubAxis as doubles, converted to TimeKeys if
+///		punits is not NULL.
+///	</summary>
+static void SubAxisQueryValues(
+	const SubAxis & subaxis,
+	const CFTimeUnits * punits,
+	std::vector<double> & vecValues
+) {
+	if (punits != NULL) {
+		std::vector<long long> vecKeys;
+		SubAxisTimeKeys(subaxis, *punits, vecKeys);
+		vecValues.assign(vecKeys.begin(), vecKeys.end());
+
+	} else {
+		vecValues.clear();
+		ValuesToDoublesKernel kernel = {subaxis.m_values, vecValues};
+		DispatchNumericNcType(subaxis.m_nctype, kernel);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::BuildQueryIndex() {
+	m_fHasQueryIndex = false;
+	m_mapQueryFileIx.clear();
+
+#if defined(HYPERION_MPIOMP)
+	// The index is only held on the root thread
+	int nRank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	if (nRank != 0) {
+		m_fHasQueryIndex = true;
+		return std::string("");
+	}
+#endif
+
+	// Index of each file id in m_vecFileInfo
+	LookupVectorHeap<std::string, FileInfo>::iterator iterfile =
+		m_vecFileInfo.begin();
+	for (; iterfile != m_vecFileInfo.end(); iterfile++) {
+		IndexId idFile;
+		if (!IndexIdFromString(iterfile.key(), idFile)) {
+			return std::string("ERROR: File id \"") + iterfile.key()
+				+ std::string("\" is not an integer");
+		}
+		m_mapQueryFileIx[idFile] = iterfile.index();
+	}
+
+	// Ranges of the values of each subaxis
+	std::vector<double> vecValues;
+	for (size_t a = 0; a < m_vecAxisInfo.size(); a++) {
+		AxisInfo & axisinfo = *(m_vecAxisInfo[a]);
+		SubAxisIntervalIndex & intervals = axisinfo.m_intervals;
+		intervals.Clear();
+
+		if (!IsNumericNcType(axisinfo.m_nctype)) {
+			continue;
+		}
+
+		// Values are TimeKeys if the units of every subaxis parse as
+		// CF time units in the same calendar
+		typedef std::pair<std::string, std::string> UnitsCalendarPair;
+		std::map<UnitsCalendarPair, size_t> mapTimeUnitsIx;
+		std::vector<size_t> vecTimeUnitsIx;
+
+		const std::string strAxisCalendar = GetCalendarAttribute(axisinfo);
+		intervals.m_fTime = (axisinfo.m_vecSubAxis.size() != 0);
+
+		AxisInfo::SubAxisVector::iterator itersubaxis =
+			axisinfo.m_vecSubAxis.begin();
+		for (; itersubaxis != axisinfo.m_vecSubAxis.end(); itersubaxis++) {
+			const SubAxis & subaxis = *(*itersubaxis);
+
+			UnitsCalendarPair prUnitsCalendar(
+				(subaxis.m_strUnits != "")?(subaxis.m_strUnits):(axisinfo.m_strUnits),
+				GetCalendarAttribute(subaxis));
+			if (prUnitsCalendar.second == "") {
+				prUnitsCalendar.second = strAxisCalendar;
+			}
+
+			std::map<UnitsCalendarPair, size_t>::const_iterator iterUnits =
+				mapTimeUnitsIx.find(prUnitsCalendar);
+			if (iterUnits == mapTimeUnitsIx.end()) {
+				CFTimeUnits timeunits;
+				if (prUnitsCalendar.first.find(" since ") == std::string::npos) {
+					intervals.m_fTime = false;
+					break;
+				}
+				if (timeunits.Parse(
+						prUnitsCalendar.first,
+						prUnitsCalendar.second) != ""
+				) {
+					intervals.m_fTime = false;
+					break;
+				}
+				if (intervals.m_vecTimeUnits.size() == 0) {
+					intervals.m_eCalendarType = timeunits.GetCalendarType();
+				} else if (intervals.m_eCalendarType != timeunits.GetCalendarType()) {
+					AnnounceWarning("Axis \"%s\" has subaxes on different"
+						" calendars; times are queried as values",
+						axisinfo.m_strName.c_str());
+					intervals.m_fTime = false;
+					break;
+				}
+				iterUnits = mapTimeUnitsIx.insert(
+					std::pair<UnitsCalendarPair, size_t>(
+						prUnitsCalendar, intervals.m_vecTimeUnits.size())).first;
+				intervals.m_vecTimeUnits.push_back(timeunits);
+			}
+			vecTimeUnitsIx.push_back(iterUnits->second);
+		}
+		if (!intervals.m_fTime) {
+			intervals.m_eCalendarType = Time::CalendarUnknown;
+			intervals.m_vecTimeUnits.clear();
+		}
+
+		size_t s = 0;
+		itersubaxis = axisinfo.m_vecSubAxis.begin();
+		for (; itersubaxis != axisinfo.m_vecSubAxis.end(); itersubaxis++, s++) {
+			const SubAxis & subaxis = *(*itersubaxis);
+
+			SubAxisIntervalIndex::Interval interval;
+			if (!IndexIdFromString(itersubaxis.key(), interval.m_idSubAxis)) {
+				return std::string("ERROR: Subaxis id \"") + itersubaxis.key()
+					+ std::string("\" of axis \"") + axisinfo.m_strName
+					+ std::string("\" is not an integer");
+			}
+			interval.m_psubaxis = &subaxis;
+			interval.m_sTimeUnitsIx = (intervals.m_fTime)?(vecTimeUnitsIx[s]):(0);
+
+			// Range of the values, ignoring NaNs
+			if (subaxis.m_fSummarized) {
+				if (subaxis.m_summary.m_sCount == 0) {
+					continue;
+				}
+				interval.m_dMin = subaxis.m_summary.m_dMin;
+				interval.m_dMax = subaxis.m_summary.m_dMax;
+
+			} else {
+				SubAxisQueryValues(subaxis, NULL, vecValues);
+				bool fHasValue = false;
+				for (size_t i = 0; i < vecValues.size(); i++) {
+					if (std::isnan(vecValues[i])) {
+						continue;
+					}
+					if (!fHasValue) {
+						interval.m_dMin = vecValues[i];
+						interval.m_dMax = vecValues[i];
+						fHasValue = true;
+					} else if (vecValues[i] < interval.m_dMin) {
+						interval.m_dMin = vecValues[i];
+					} else if (vecValues[i] > interval.m_dMax) {
+						interval.m_dMax = vecValues[i];
+					}
+				}
+				if (!fHasValue) {
+					continue;
+				}
+			}
+
+			if (intervals.m_fTime) {
+				const double dOffsets[2] = { interval.m_dMin, interval.m_dMax };
+				long long llKeys[2];
+				intervals.m_vecTimeUnits[interval.m_sTimeUnitsIx].ToTimeKeys(
+					dOffsets, 2, llKeys);
+				interval.m_dMin = static_cast<double>(llKeys[0]);
+				interval.m_dMax = static_cast<double>(llKeys[1]);
+			}
+
+			intervals.m_vecIntervals.push_back(interval);
+		}
+
+		intervals.Sort();
+	}
+
+	m_fHasQueryIndex = true;
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A list of subaxis ids and the range of indices of each within a
+///		query, sorted by subaxis id.
+///	</summary>
+typedef std::vector< std::pair<IndexId, AxisIndexRange> > QuerySubAxisRanges;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Find the subaxes of an axis overlapping a query range, and the
+///		range of indices of each that lies within it.
+///	</summary>
+static std::string ResolveQueryAxisRange(
+	const AxisInfo & axisinfo,
+	const QueryAxisRange & range,
+	QuerySubAxisRanges & vecSubAxisRanges
+) {
+	const SubAxisIntervalIndex & intervals = axisinfo.m_intervals;
+
+	vecSubAxisRanges.clear();
+
+	// Bounds in the values of the interval index
+	double dLow = range.m_dLow;
+	double dHigh = range.m_dHigh;
+	if (range.m_fFormattedTime) {
+		if (!intervals.m_fTime) {
+			return std::string("Axis \"") + axisinfo.m_strName
+				+ std::string("\" does not have CF time units; its query"
+				" range must be numeric");
+		}
+		Time timeLow(intervals.m_eCalendarType);
+		Time timeHigh(intervals.m_eCalendarType);
+		timeLow.FromFormattedString(range.m_strTimeLow);
+		timeHigh.FromFormattedString(range.m_strTimeHigh);
+		dLow = static_cast<double>(CFTimeUnits::TimeKey(timeLow));
+		dHigh = static_cast<double>(CFTimeUnits::TimeKey(timeHigh));
+		if (dLow > dHigh) {
+			return std::string("Query range on axis \"") + axisinfo.m_strName
+				+ std::string("\" has its lower bound after its upper bound");
+		}
+
+	} else if (intervals.m_fTime) {
+		CFTimeUnits timeunits;
+		std::string strError =
+			timeunits.Parse(axisinfo.m_strUnits, GetCalendarAttribute(axisinfo));
+		if (strError != "") {
+			return std::string("Axis \"") + axisinfo.m_strName
+				+ std::string("\" has no units for numeric time bounds: ")
+				+ strError;
+		}
+		const double dOffsets[2] = { range.m_dLow, range.m_dHigh };
+		long long llKeys[2];
+		timeunits.ToTimeKeys(dOffsets, 2, llKeys);
+		dLow = static_cast<double>(llKeys[0]);
+		dHigh = static_cast<double>(llKeys[1]);
+	}
+
+	std::vector<size_t> vecIntervalIxs;
+	intervals.FindOverlapping(dLow, dHigh, vecIntervalIxs);
+
+	std::vector<double> vecValues;
+	for (size_t i = 0; i < vecIntervalIxs.size(); i++) {
+		const SubAxisIntervalIndex::Interval & interval =
+			intervals.m_vecIntervals[vecIntervalIxs[i]];
+		const SubAxis & subaxis = *(interval.m_psubaxis);
+
+		// Subaxis entirely within the range
+		if ((interval.m_dMin >= dLow) && (interval.m_dMax <= dHigh)) {
+			vecSubAxisRanges.push_back(
+				QuerySubAxisRanges::value_type(
+					interval.m_idSubAxis,
+					AxisIndexRange(0, subaxis.m_lSize)));
+			continue;
+		}
+
+		if (subaxis.m_fSummarized) {
+			return std::string("Axis \"") + axisinfo.m_strName
+				+ std::string("\" has summarized values; rerun with"
+				" --expand_summaries");
+		}
+
+		// First and last values within the range
+		SubAxisQueryValues(
+			subaxis,
+			(intervals.m_fTime)
+				?(&(intervals.m_vecTimeUnits[interval.m_sTimeUnitsIx]))
+				:(NULL),
+			vecValues);
+
+		long lFirst = (-1);
+		long lLast = (-1);
+		for (size_t v = 0; v < vecValues.size(); v++) {
+			if ((vecValues[v] >= dLow) && (vecValues[v] <= dHigh)) {
+				if (lFirst == (-1)) {
+					lFirst = static_cast<long>(v);
+				}
+				lLast = static_cast<long>(v);
+			}
+		}
+		if (lFirst != (-1)) {
+			vecSubAxisRanges.push_back(
+				QuerySubAxisRanges::value_type(
+					interval.m_idSubAxis,
+					AxisIndexRange(lFirst, lLast - lFirst + 1)));
+		}
+	}
+
+	std::sort(vecSubAxisRanges.begin(), vecSubAxisRanges.end(),
+		[](const QuerySubAxisRanges::value_type & a,
+		   const QuerySubAxisRanges::value_type & b) {
+			return (a.first < b.first);
+		});
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::Query(
+	const std::string & strVariableName,
+	const std::vector<QueryAxisRange> & vecRanges,
+	std::vector<QueryFileRange> & vecResults
+) const {
+	vecResults.clear();
+
+#if defined(HYPERION_MPIOMP)
+	// The index is only held on the root thread
+	int nRank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	if (nRank != 0) {
+		return std::string("");
+	}
+#endif
+
+	if (!m_fHasQueryIndex) {
+		return std::string("Query index has not been built");
+	}
+
+	const VariableInfo * pvarinfo = GetVariableInfo(strVariableName);
+	if (pvarinfo == NULL) {
+		return std::string("Variable \"") + strVariableName
+			+ std::string("\" not found in index");
+	}
+	const VariableInfo & varinfo = *pvarinfo;
+
+	// Subaxes of each axis within its range
+	std::map<std::string, QuerySubAxisRanges> mapAxisRanges;
+	for (size_t r = 0; r < vecRanges.size(); r++) {
+		const std::string & strAxisName = vecRanges[r].m_strAxisName;
+
+		bool fVariableHasAxis = false;
+		AxisNamesToSubAxisToFileIdMapMap::const_iterator iterAxisGroup =
+			varinfo.m_mapSubAxisToFileIdMaps.begin();
+		for (; iterAxisGroup != varinfo.m_mapSubAxisToFileIdMaps.end(); iterAxisGroup++) {
+			const AxisNameVector & vecAxisNames = iterAxisGroup->first;
+			if (std::find(vecAxisNames.begin(), vecAxisNames.end(), strAxisName)
+			    != vecAxisNames.end()
+			) {
+				fVariableHasAxis = true;
+				break;
+			}
+		}
+		if (!fVariableHasAxis) {
+			return std::string("Variable \"") + strVariableName
+				+ std::string("\" does not have axis \"") + strAxisName
+				+ std::string("\"");
+		}
+
+		std::pair<std::map<std::string, QuerySubAxisRanges>::iterator, bool> pr =
+			mapAxisRanges.insert(
+				std::pair<std::string, QuerySubAxisRanges>(
+					strAxisName, QuerySubAxisRanges()));
+		if (!pr.second) {
+			return std::string("Query has more than one range on axis \"")
+				+ strAxisName + std::string("\"");
+		}
+
+		LookupVectorHeap<std::string, AxisInfo>::const_iterator iteraxis =
+			m_vecAxisInfo.find(strAxisName);
+		if (iteraxis == m_vecAxisInfo.end()) {
+			_EXCEPTIONT("Logic error");
+		}
+		std::string strError =
+			ResolveQueryAxisRange(*(*iteraxis), vecRanges[r], pr.first->second);
+		if (strError != "") {
+			return strError;
+		}
+	}
+
+	// Match the subaxes of each axis group
+	AxisNamesToSubAxisToFileIdMapMap::const_iterator iterAxisGroup =
+		varinfo.m_mapSubAxisToFileIdMaps.begin();
+	for (; iterAxisGroup != varinfo.m_mapSubAxisToFileIdMaps.end(); iterAxisGroup++) {
+		const AxisNameVector & vecAxisNames = iterAxisGroup->first;
+		const SubAxisToFileIdMap & mapSubAxisToFileId = iterAxisGroup->second;
+		if (mapSubAxisToFileId.size() == 0) {
+			continue;
+		}
+		const size_t sDims = vecAxisNames.size();
+
+		// Candidate subaxes along each axis; axes without a range admit
+		// all of their subaxes in full
+		std::vector<QuerySubAxisRanges> vecUnrestricted(sDims);
+		std::vector<const QuerySubAxisRanges *> vecDimRanges(sDims);
+		size_t sCandidates = 1;
+		for (size_t d = 0; d < sDims; d++) {
+			std::map<std::string, QuerySubAxisRanges>::const_iterator iterRanges =
+				mapAxisRanges.find(vecAxisNames[d]);
+			if (iterRanges != mapAxisRanges.end()) {
+				vecDimRanges[d] = &(iterRanges->second);
+
+			} else {
+				LookupVectorHeap<std::string, AxisInfo>::const_iterator iteraxis =
+					m_vecAxisInfo.find(vecAxisNames[d]);
+				if (iteraxis == m_vecAxisInfo.end()) {
+					_EXCEPTIONT("Logic error");
+				}
+				const SubAxisIntervalIndex & intervals = (*iteraxis)->m_intervals;
+				if (intervals.m_vecIntervals.size() != 0) {
+					for (size_t i = 0; i < intervals.m_vecIntervals.size(); i++) {
+						vecUnrestricted[d].push_back(
+							QuerySubAxisRanges::value_type(
+								intervals.m_vecIntervals[i].m_idSubAxis,
+								AxisIndexRange(0,
+									intervals.m_vecIntervals[i].m_psubaxis->m_lSize)));
+					}
+				} else {
+					// Axes without values, such as those with no dimension
+					// variable
+					AxisInfo::SubAxisVector::const_iterator itersubaxis =
+						(*iteraxis)->m_vecSubAxis.begin();
+					for (; itersubaxis != (*iteraxis)->m_vecSubAxis.end(); itersubaxis++) {
+						IndexId idSubAxis;
+						if (IndexIdFromString(itersubaxis.key(), idSubAxis)) {
+							vecUnrestricted[d].push_back(
+								QuerySubAxisRanges::value_type(
+									idSubAxis,
+									AxisIndexRange(0, (*itersubaxis)->m_lSize)));
+						}
+					}
+				}
+				std::sort(vecUnrestricted[d].begin(), vecUnrestricted[d].end(),
+					[](const QuerySubAxisRanges::value_type & a,
+					   const QuerySubAxisRanges::value_type & b) {
+						return (a.first < b.first);
+					});
+				vecDimRanges[d] = &(vecUnrestricted[d]);
+			}
+
+			if (sCandidates <= mapSubAxisToFileId.size()) {
+				sCandidates *= vecDimRanges[d]->size();
+			}
+		}
+		if (sCandidates == 0) {
+			continue;
+		}
+
+		// Add the file holding one combination of subaxes
+		std::vector<size_t> vecCandidateIxs(sDims, 0);
+		SubAxisIdVector vecSubAxisIds(sDims);
+		auto AddResult = [&](size_t ixEntry) {
+			std::unordered_map<IndexId, size_t>::const_iterator iterFileIx =
+				m_mapQueryFileIx.find(mapSubAxisToFileId.fileid(ixEntry));
+			if (iterFileIx == m_mapQueryFileIx.end()) {
+				_EXCEPTIONT("Logic error");
+			}
+			QueryFileRange result;
+			result.m_sFileIx = iterFileIx->second;
+			result.m_strFilename = m_vecFileInfo[result.m_sFileIx]->m_strFilename;
+			result.m_vecAxisNames = vecAxisNames;
+			for (size_t d = 0; d < sDims; d++) {
+				const AxisIndexRange & range =
+					(*(vecDimRanges[d]))[vecCandidateIxs[d]].second;
+				result.m_vecStart.push_back(range.first);
+				result.m_vecCount.push_back(range.second);
+			}
+			vecResults.push_back(result);
+		};
+
+		// Few combinations: look each up
+		if (sCandidates <= mapSubAxisToFileId.size()) {
+			for (;;) {
+				for (size_t d = 0; d < sDims; d++) {
+					vecSubAxisIds[d] = (*(vecDimRanges[d]))[vecCandidateIxs[d]].first;
+				}
+				size_t ixEntry = mapSubAxisToFileId.find(vecSubAxisIds);
+				if (ixEntry != mapSubAxisToFileId.size()) {
+					AddResult(ixEntry);
+				}
+
+				size_t d = sDims;
+				for (; d > 0; d--) {
+					vecCandidateIxs[d-1]++;
+					if (vecCandidateIxs[d-1] < vecDimRanges[d-1]->size()) {
+						break;
+					}
+					vecCandidateIxs[d-1] = 0;
+				}
+				if (d == 0) {
+					break;
+				}
+			}
+
+		// Many combinations: scan the entries
+		} else {
+			for (size_t i = 0; i < mapSubAxisToFileId.size(); i++) {
+				const IndexId * pSubAxisIds = mapSubAxisToFileId.subaxisids(i);
+				size_t d = 0;
+				for (; d < sDims; d++) {
+					const QuerySubAxisRanges & vecCandidates = *(vecDimRanges[d]);
+					QuerySubAxisRanges::const_iterator iterCandidate =
+						std::lower_bound(
+							vecCandidates.begin(), vecCandidates.end(),
+							pSubAxisIds[d],
+							[](const QuerySubAxisRanges::value_type & a, IndexId id) {
+								return (a.first < id);
+							});
+					if ((iterCandidate == vecCandidates.end()) ||
+					    (iterCandidate->first != pSubAxisIds[d])
+					) {
+						break;
+					}
+					vecCandidateIxs[d] =
+						static_cast<size_t>(iterCandidate - vecCandidates.begin());
+				}
+				if (d == sDims) {
+					AddResult(i);
+				}
+			}
+		}
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check whether any axis group of a variable includes the given axis.
+///	</summary>
+static bool VariableHasAxis(
+	const VariableInfo & varinfo,
+	const std::string & strAxisName
+) {
+	AxisNamesToSubAxisToFileIdMapMap::const_iterator itergroup =
+		varinfo.m_mapSubAxisToFileIdMaps.begin();
+	for (; itergroup != varinfo.m_mapSubAxisToFileIdMaps.end(); itergroup++) {
+		if (std::find(
+			itergroup->first.begin(),
+			itergroup->first.end(),
+			strAxisName) != itergroup->first.end()
+		) {
+			return true;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::OutputTimeVariableIndexCSV(
+	const std::string & strCSVOutputFilename,
+	bool fRunLength
+) {
+#if defined(HYPERION_MPIOMP)
+	// Only output on root thread
+	int nRank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	if (nRank != 0) {
+		return std::string("");
+	}
+#endif
+
+	if (m_strTimeAxisName == "") {
+		return std::string("Time index has not been built");
+	}
+
+	// Open output file
+	std::ofstream ofOutput(strCSVOutputFilename.c_str());
+	if (!ofOutput.is_open()) {
+		return std::string("Unable to open output file \"") + strCSVOutputFilename + "\"";
+	}
+
+	// Contiguous ranges of available times, one variable at a time
+	if (fRunLength) {
+
+		// Times at which no variable is available do not appear in the
+		// time index, so a run is also broken by a step between times
+		// well beyond the median step.  The tolerance admits the
+		// varying length of calendar months.
+		double dMaxStep = 0.0;
+		if (m_vecTimes.size() > 1) {
+			std::vector<double> vecSteps(m_vecTimes.size() - 1);
+			for (size_t t = 1; t < m_vecTimes.size(); t++) {
+				vecSteps[t-1] = m_vecTimes[t] - m_vecTimes[t-1];
+			}
+			std::nth_element(
+				vecSteps.begin(),
+				vecSteps.begin() + vecSteps.size() / 2,
+				vecSteps.end());
+			dMaxStep = 1.5 * vecSteps[vecSteps.size() / 2];
+		}
+
+		ofOutput << "variable,first_time,last_time,count\n";
+
+		for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
+			const VariableInfo & varinfo = *(m_vecVariableInfo[v]);
+
+			if (!VariableHasAxis(varinfo, m_strTimeAxisName)) {
+				ofOutput << varinfo.m_strName << ",NONE,NONE,0\n";
+				continue;
+			}
+
+			// Runs are broken where a time index is skipped
+			// or a time is missing from the index
+			VariableTimeFileMap::const_iterator iterTimeFile =
+				varinfo.m_mapTimeFile.begin();
+			while (iterTimeFile != varinfo.m_mapTimeFile.end()) {
+				const size_t tFirst = iterTimeFile->first;
+				size_t tLast = tFirst;
+				for (iterTimeFile++; iterTimeFile != varinfo.m_mapTimeFile.end(); iterTimeFile++) {
+					if ((iterTimeFile->first != tLast + 1) ||
+					    (m_vecTimes[tLast + 1] - m_vecTimes[tLast] > dMaxStep)
+					) {
+						break;
+					}
+					tLast++;
+				}
+
+				ofOutput << varinfo.m_strName
+					<< "," << m_vecTimes[tFirst].ToString()
+					<< "," << m_vecTimes[tLast].ToString()
+					<< "," << (tLast - tFirst + 1) << "\n";
+			}
+		}
+
+		ofOutput.close();
+		if (!ofOutput) {
+			return std::string("Error writing output file \"") + strCSVOutputFilename + "\"";
+		}
+		return std::string("");
+	}
+
+	// Output variables across header
+	ofOutput << "time";
+	for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
+		ofOutput << "," << m_vecVariableInfo[v]->m_strName;
+	}
+	ofOutput << "\n";
+
+	// Output variables with no time dimension
+	ofOutput << "NONE";
+	for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
+		if (VariableHasAxis(*(m_vecVariableInfo[v]), m_strTimeAxisName)) {
+			ofOutput << ",";
+		} else {
+			ofOutput << ",X";
+		}
+	}
+	ofOutput << "\n";
+
+	// Output variables with time dimension, walking the maps of all
+	// variables in step since they are ordered by time index.  Each row
+	// is written as it is produced, so the matrix is never held in full.
+	std::vector<VariableTimeFileMap::const_iterator> vecIterTimeFile;
+	for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
+		vecIterTimeFile.push_back(m_vecVariableInfo[v]->m_mapTimeFile.begin());
+	}
+
+	for (size_t t = 0; t < m_vecTimes.size(); t++) {
+		ofOutput << m_vecTimes[t].ToString();
+
+		for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
+			VariableTimeFileMap::const_iterator & iterTimeFile =
+				vecIterTimeFile[v];
+
+			if ((iterTimeFile == m_vecVariableInfo[v]->m_mapTimeFile.end()) ||
+			    (iterTimeFile->first != t)
+			) {
+				ofOutput << ",";
+			} else {
+				ofOutput << "," << iterTimeFile->second.first
+					<< ":" << iterTimeFile->second.second;
+				iterTimeFile++;
+			}
+		}
+		ofOutput << "\n";
+	}
+
+	// Output file names
+	ofOutput << "\n\n";
+
+	ofOutput << "file_ix,filename\n";
+	for (size_t f = 0; f < m_vecFileInfo.size(); f++) {
+		ofOutput << f << ",\"" << m_vecFileInfo[f]->m_strFilename << "\"\n";
+	}
+
+	ofOutput.close();
+	if (!ofOutput) {
+		return std::string("Error writing output file \"") + strCSVOutputFilename + "\"";
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Call fnTask(i) for each i in [0, sTasks) on up to sThreads threads.
+///	</summary>
+static void RunTasksOnThreads(
+	size_t sThreads,
+	size_t sTasks,
+	const std::function<void(size_t)> & fnTask
+) {
+	std::atomic<size_t> sNext(0);
+	std::vector<std::thread> vecThreads;
+	sThreads = std::min(std::max(sThreads, (size_t)1), sTasks);
+	for (size_t t = 0; t < sThreads; t++) {
+		vecThreads.push_back(std::thread([&]() {
+			for (;;) {
+				size_t i = sNext.fetch_add(1);
+				if (i >= sTasks) {
+					break;
+				}
+				fnTask(i);
+			}
+		}));
+	}
+	for (size_t t = 0; t < vecThreads.size(); t++) {
+		vecThreads[t].join();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Number of chunks formatted per thread before they are written.
+///	</summary>
+static const size_t FormatChunksPerThread = 4;
+
+///	<summary>
+///		Number of files formatted as one chunk.
+///	</summary>
+static const size_t FormatFileChunkItems = 256;
+
+///	<summary>
+///		Number of variables formatted as one chunk.  Variables hold a
+///		lookup table of every file in which they appear, so are formatted
+///		in smaller chunks than files.
+///	</summary>
+static const size_t FormatVariableChunkItems = 8;
+
+///	<summary>
+///		Format sItems items in chunks of sChunkItems, with fnFormat(sBegin,
+///		sEnd, str) appending the text of items [sBegin, sEnd) to str.
+///		Chunks are formatted on up to sThreads threads into separate
+///		buffers, and the text of each batch of chunks is passed to fnWrite
+///		in item order, so output is identical to formatting sequentially
+///		while memory use is bounded by the size of a batch.  An exception
+///		thrown while formatting is rethrown once the batch completes.
+///	</summary>
+static void FormatInParallel(
+	size_t sThreads,
+	size_t sItems,
+	size_t sChunkItems,
+	const std::function<void(size_t, size_t, std::string &)> & fnFormat,
+	const std::function<void(const std::string &)> & fnWrite
+) {
+	sChunkItems = std::max(sChunkItems, (size_t)1);
+	const size_t sChunks = (sItems + sChunkItems - 1) / sChunkItems;
+
+	// Without threads to share the work the text is formatted and
+	// written one chunk at a time
+	if (sThreads <= 1) {
+		std::string strChunk;
+		for (size_t c = 0; c < sChunks; c++) {
+			strChunk.clear();
+			fnFormat(
+				c * sChunkItems,
+				std::min((c + 1) * sChunkItems, sItems),
+				strChunk);
+			fnWrite(strChunk);
+		}
+		return;
+	}
+
+	const size_t sBatchChunks = sThreads * FormatChunksPerThread;
+	std::vector<std::string> vecChunks(sBatchChunks);
+	std::vector<std::exception_ptr> vecExceptions(sBatchChunks);
+	std::string strBatch;
+
+	for (size_t cBegin = 0; cBegin < sChunks; cBegin += sBatchChunks) {
+		const size_t sBatch = std::min(sBatchChunks, sChunks - cBegin);
+
+		RunTasksOnThreads(sThreads, sBatch, [&](size_t c) {
+			vecChunks[c].clear();
+			try {
+				const size_t sBegin = (cBegin + c) * sChunkItems;
+				fnFormat(
+					sBegin,
+					std::min(sBegin + sChunkItems, sItems),
+					vecChunks[c]);
+			} catch(...) {
+				vecExceptions[c] = std::current_exception();
+			}
+		});
+
+		size_t sBatchBytes = 0;
+		for (size_t c = 0; c < sBatch; c++) {
+			if (vecExceptions[c]) {
+				std::rethrow_exception(vecExceptions[c]);
+			}
+			sBatchBytes += vecChunks[c].length();
+		}
+
+		strBatch.clear();
+		strBatch.reserve(sBatchBytes);
+		for (size_t c = 0; c < sBatch; c++) {
+			strBatch += vecChunks[c];
+		}
+		fnWrite(strBatch);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Attributes of an XML element, in the order they are first set.
+///		As with tinyxml2::XMLElement::SetAttribute, setting an attribute a
+///		second time replaces its value in place.
+///	</summary>
+class XMLAttributeList :
+	public std::vector< std::pair<std::string, std::string> >
+{
+public:
+	///	<summary>
+	///		Set the value of an attribute.
+	///	</summary>
+	void Set(
+		const std::string & strName,
+		const std::string & strValue
+	) {
+		for (iterator iter = begin(); iter != end(); iter++) {
+			if (iter->first == strName) {
+				iter->second = strValue;
+				return;
+			}
+		}
+		push_back(value_type(strName, strValue));
+	}
+
+	///	<summary>
+	///		Set the value of all key attributes in an AttributeMap.
+	///	</summary>
+	void Set(
+		const AttributeMap & mapAttributes
+	) {
+		AttributeMap::const_iterator iterAtt = mapAttributes.begin();
+		for (; iterAtt != mapAttributes.end(); iterAtt++) {
+			Set(iterAtt->first.str(), iterAtt->second.str());
+		}
+	}
+
+	///	<summary>
+	///		Push all attributes onto the element most recently opened.
+	///	</summary>
+	void Push(
+		tinyxml2::XMLPrinter & xmlPrinter
+	) const {
+		for (const_iterator iter = begin(); iter != end(); iter++) {
+			xmlPrinter.PushAttribute(iter->first.c_str(), iter->second.c_str());
+		}
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A std::streambuf that passes text to an XMLPrinter in fixed-size
+///		chunks, so that long coordinate arrays are never held in full.
+///	</summary>
+class XMLPrinterTextBuf : public std::streambuf {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	XMLPrinterTextBuf(
+		tinyxml2::XMLPrinter & xmlPrinter
+	) :
+		m_xmlPrinter(xmlPrinter)
+	{
+		setp(m_szBuffer, m_szBuffer + sizeof(m_szBuffer) - 2);
+	}
+
+	///	<summary>
+	///		Destructor.
+	///	</summary>
+	virtual ~XMLPrinterTextBuf() {
+		Flush();
+	}
+
+protected:
+	///	<summary>
+	///		Pass any buffered text to the XMLPrinter.
+	///	</summary>
+	void Flush() {
+		if (pptr() != pbase()) {
+			*pptr() = '\0';
+			m_xmlPrinter.PushText(pbase());
+			setp(m_szBuffer, m_szBuffer + sizeof(m_szBuffer) - 2);
+		}
+	}
+
+	virtual int_type overflow(int_type ch) {
+		if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+			*pptr() = traits_type::to_char_type(ch);
+			pbump(1);
+		}
+		Flush();
+		return traits_type::not_eof(ch);
+	}
+
+	virtual int sync() {
+		Flush();
+		return 0;
+	}
+
+protected:
+	///	<summary>
+	///		XMLPrinter receiving the text.
+	///	</summary>
+	tinyxml2::XMLPrinter & m_xmlPrinter;
+
+	///	<summary>
+	///		Buffered text.
+	///	</summary>
+	char m_szBuffer[4096];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write non-key attributes as attr elements.
+///	</summary>
+static void XMLPushOtherAttributes(
+	tinyxml2::XMLPrinter & xmlPrinter,
+	const AttributeMap & mapOtherAttributes
+) {
+	AttributeMap::const_iterator iterAttOther =
+		mapOtherAttributes.begin();
+	for (; iterAttOther != mapOtherAttributes.end(); iterAttOther++) {
+		xmlPrinter.OpenElement("attr");
+		xmlPrinter.PushAttribute("name", iterAttOther->first.c_str());
+		xmlPrinter.PushAttribute("datatype", "String");
+		xmlPrinter.PushText(iterAttOther->second.c_str());
+		xmlPrinter.CloseElement();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write the values of a SubAxis as the text of the element most
+///		recently opened.
+///	</summary>
+static void XMLPushSubAxisValues(
+	tinyxml2::XMLPrinter & xmlPrinter,
+	const SubAxis & subaxis
+) {
+	if (subaxis.m_fSummarized) {
+		return;
+	}
+	XMLPrinterTextBuf sbText(xmlPrinter);
+	std::ostream osText(&sbText);
+	subaxis.ValuesToStream(osText);
+	osText.flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		An XMLPrinter that can also write text formatted by another
+///		XMLPrinter, so that elements formatted separately are written in
+///		place.
+///	</summary>
+class XMLStreamPrinter : public tinyxml2::XMLPrinter {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	XMLStreamPrinter(
+		FILE * fp
+	) :
+		tinyxml2::XMLPrinter(fp)
+	{ }
+
+	///	<summary>
+	///		Write formatted elements as children of the open element.
+	///	</summary>
+	void PushRaw(
+		const std::string & strText
+	) {
+		if (strText.length() != 0) {
+			SealElementIfJustOpened();
+			Write(strText.c_str(), strText.length());
+		}
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write the file element of a FileInfo.
+///	</summary>
+static void XMLPushFileElement(
+	tinyxml2::XMLPrinter & xmlPrinter,
+	const std::string & strFileId,
+	const FileInfo & fileinfo
+) {
+	xmlPrinter.OpenElement("file");
+
+	AttributeMap mapKeyAttributes;
+	AttributeMap mapOtherAttributes;
+	fileinfo.GetAttributes(mapKeyAttributes, mapOtherAttributes);
+
+	XMLAttributeList listAttributes;
+	listAttributes.Set("id", strFileId);
+	listAttributes.Set("name", fileinfo.m_strFilename);
+	listAttributes.Set(mapKeyAttributes);
+	listAttributes.Push(xmlPrinter);
+
+	XMLPushOtherAttributes(xmlPrinter, mapOtherAttributes);
+
+	AxisSubAxisMap::const_iterator iterAxes =
+		fileinfo.m_mapAxisSubAxis.begin();
+	for (; iterAxes != fileinfo.m_mapAxisSubAxis.end(); iterAxes++) {
+		xmlPrinter.OpenElement("subaxis");
+		xmlPrinter.PushAttribute("axis", iterAxes->first.c_str());
+		xmlPrinter.PushAttribute("subaxis", iterAxes->second.c_str());
+		xmlPrinter.CloseElement();
+	}
+
+	xmlPrinter.CloseElement();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write the axis element of an AxisInfo.
+///	</summary>
+static void XMLPushAxisElement(
+	tinyxml2::XMLPrinter & xmlPrinter,
+	const AxisInfo & axisinfo
+) {
+	xmlPrinter.OpenElement("axis");
+
+	XMLAttributeList listAttributes;
+	listAttributes.Set("id", axisinfo.m_strName);
+	listAttributes.Set("units", axisinfo.m_strUnits);
+	listAttributes.Set("datatype", NcTypeToString(axisinfo.m_nctype));
+	listAttributes.Set(axisinfo.m_mapKeyAttributes);
+	listAttributes.Push(xmlPrinter);
+
+	XMLPushOtherAttributes(xmlPrinter, axisinfo.m_mapOtherAttributes);
+
+	// A single subaxis is written as the text of the axis itself
+	if (axisinfo.m_vecSubAxis.size() == 1) {
+		const SubAxis * psubaxisinfo = axisinfo.m_vecSubAxis[0];
+		if (psubaxisinfo->m_nctype != ncNoType) {
+			XMLPushSubAxisValues(xmlPrinter, *psubaxisinfo);
+		}
+
+	// Add all subaxes
+	} else {
+		AxisInfo::SubAxisVector::const_iterator itersubaxis = axisinfo.m_vecSubAxis.begin();
+		for (; itersubaxis != axisinfo.m_vecSubAxis.end(); itersubaxis++) {
+			const SubAxis * psubaxisinfo = *itersubaxis;
+
+			xmlPrinter.OpenElement("subaxis");
+			xmlPrinter.PushAttribute("id", itersubaxis.key().c_str());
+			xmlPrinter.PushAttribute("size", std::to_string((long long)psubaxisinfo->m_lSize).c_str());
+			if (psubaxisinfo->m_nctype != ncNoType) {
+				XMLPushSubAxisValues(xmlPrinter, *psubaxisinfo);
+			}
+			xmlPrinter.CloseElement();
+		}
+	}
+
+	xmlPrinter.CloseElement();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write the variable element of a VariableInfo.
+///	</summary>
+static void XMLPushVariableElement(
+	tinyxml2::XMLPrinter & xmlPrinter,
+	const VariableInfo & varinfo
+) {
+	xmlPrinter.OpenElement("variable");
+
+	XMLAttributeList listAttributes;
+	listAttributes.Set("id", varinfo.m_strName);
+	listAttributes.Set("datatype", NcTypeToString(varinfo.m_nctype));
+	listAttributes.Set("units", varinfo.m_strUnits);
+	listAttributes.Set(varinfo.m_mapKeyAttributes);
+	listAttributes.Push(xmlPrinter);
+
+	XMLPushOtherAttributes(xmlPrinter, varinfo.m_mapOtherAttributes);
+
+	// Output storage layout
+	const VariableStorage & storage = varinfo.m_storage;
+	if (storage.IsKnown()) {
+		xmlPrinter.OpenElement("storage");
+		xmlPrinter.PushAttribute("layout",
+			VariableStorage::LayoutToString(storage.m_eLayout));
+		if (storage.m_eLayout == VariableStorage::Layout_Chunked) {
+			xmlPrinter.PushAttribute("chunks",
+				storage.ChunkSizesToString().c_str());
+		}
+		if (storage.m_iDeflateLevel != 0) {
+			xmlPrinter.PushAttribute("deflate", storage.m_iDeflateLevel);
+		}
+		if (storage.m_fShuffle) {
+			xmlPrinter.PushAttribute("shuffle", "true");
+		}
+		if (storage.m_fFletcher32) {
+			xmlPrinter.PushAttribute("fletcher32", "true");
+		}
+		if (storage.m_eEndian != VariableStorage::Endian_Native) {
+			xmlPrinter.PushAttribute("endian",
+				VariableStorage::EndianToString(storage.m_eEndian));
+		}
+		if (storage.m_uFilterId != 0) {
+			xmlPrinter.PushAttribute("filter", storage.m_uFilterId);
+		}
+		if (varinfo.m_fStorageVaries) {
+			xmlPrinter.PushAttribute("varies", "true");
+		}
+		xmlPrinter.CloseElement();
+	}
+
+	// Output statistics of the values
+	const VariableStatistics & stats = varinfo.m_statistics;
+	if (!stats.IsEmpty()) {
+		xmlPrinter.OpenElement("statistics");
+		xmlPrinter.PushAttribute("count", std::to_string(stats.m_ullCount).c_str());
+		xmlPrinter.PushAttribute("missing", std::to_string(stats.m_ullMissing).c_str());
+		if (stats.m_ullCount != 0) {
+			char szValue[NumberFormatMaxChars + 1];
+			*FormatNumber(szValue, stats.m_dMin) = '\0';
+			xmlPrinter.PushAttribute("min", szValue);
+			*FormatNumber(szValue, stats.m_dMax) = '\0';
+			xmlPrinter.PushAttribute("max", szValue);
+			*FormatNumber(szValue, stats.GetMean()) = '\0';
+			xmlPrinter.PushAttribute("mean", szValue);
+		}
+		xmlPrinter.CloseElement();
+	}
+
+	// Output subaxis lookup table
+	AxisNamesToSubAxisToFileIdMapMap::const_iterator iterAxisGroup =
+		varinfo.m_mapSubAxisToFileIdMaps.begin();
+	for (; iterAxisGroup != varinfo.m_mapSubAxisToFileIdMaps.end(); iterAxisGroup++) {
+
+		if (varinfo.m_mapSubAxisToFileIdMaps.size() > 1) {
+			xmlPrinter.OpenElement("axisgroup");
+		}
+
+		xmlPrinter.OpenElement("axisids");
+		xmlPrinter.PushText(iterAxisGroup->first.ToString().c_str());
+		xmlPrinter.CloseElement();
+
+		xmlPrinter.OpenElement("subaxismap");
+		{
+			XMLPrinterTextBuf sbText(xmlPrinter);
+			std::ostream osText(&sbText);
+			iterAxisGroup->second.ToStream(osText);
+			osText.flush();
+		}
+		xmlPrinter.CloseElement();
+
+		if (varinfo.m_mapSubAxisToFileIdMaps.size() > 1) {
+			xmlPrinter.CloseElement();
+		}
+	}
+
+	xmlPrinter.CloseElement();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Format elements [sBegin, sEnd) as children of the dataset element,
+///		appending the text to strText.
+///	</summary>
+static void XMLFormatDatasetChildren(
+	size_t sBegin,
+	size_t sEnd,
+	const std::function<void(tinyxml2::XMLPrinter &, size_t)> & fnPushElement,
+	std::string & strText
+) {
+	tinyxml2::XMLPrinter xmlChunk(NULL, false, 1);
+	for (size_t i = sBegin; i < sEnd; i++) {
+		fnPushElement(xmlChunk, i);
+	}
+
+	// The first element of a printer is not preceded by a line break
+	strText += '\n';
+	strText.append(xmlChunk.CStr(), xmlChunk.CStrSize() - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::ToXMLFile(
+	const std::string & strXMLOutputFilename
+) const {
+#if defined(HYPERION_MPIOMP)
+	// Only output on root thread
+	int nRank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	if (nRank != 0) {
+		return std::string("");
+	}
+#endif
+
+	// Elements are written to the file as they are produced, so memory
+	// use does not grow with the size of the index.  Files named .gz or
+	// .zst are compressed as they are written.
+	FILE * fpXML = CompressedFileOpenWrite(strXMLOutputFilename);
+	if (fpXML == NULL) {
+		_EXCEPTION1("Unable to open file \"%s\" for writing",
+			strXMLOutputFilename.c_str());
+	}
+
+	XMLStreamPrinter xmlPrinter(fpXML);
+
+	// Declaration
+	xmlPrinter.PushDeclaration("xml version=\"1.0\" encoding=\"\"");
+
+	// DOCTYPE
+	xmlPrinter.PushUnknown("DOCTYPE dataset SYSTEM \"http://www-pcmdi.llnl.gov/software/cdms/cdml.dtd\"");
+
+	// Dataset
+	xmlPrinter.OpenElement("dataset");
+	{
+		XMLAttributeList listAttributes;
+		listAttributes.Set(m_datainfo.m_mapKeyAttributes);
+		listAttributes.Push(xmlPrinter);
+
+		XMLPushOtherAttributes(xmlPrinter, m_datainfo.m_mapOtherAttributes);
+	}
+
+	// Files, axes and variables are formatted in chunks on m_sThreads
+	// threads, and each batch of chunks is written in order
+	auto WriteChunks = [&](const std::string & strText) {
+		xmlPrinter.PushRaw(strText);
+	};
+
+	// FileInfo
+	{
+		std::vector< std::pair<const std::string *, const FileInfo *> > vecFiles;
+		vecFiles.reserve(m_vecFileInfo.size());
+		LookupVectorHeap<std::string, FileInfo>::const_iterator iterfile = m_vecFileInfo.begin();
+		for (; iterfile != m_vecFileInfo.end(); iterfile++) {
+			vecFiles.push_back(
+				std::pair<const std::string *, const FileInfo *>(
+					&(iterfile.key()), *iterfile));
+		}
+
+		FormatInParallel(m_sThreads, vecFiles.size(), FormatFileChunkItems,
+			[&](size_t sBegin, size_t sEnd, std::string & strText) {
+				XMLFormatDatasetChildren(sBegin, sEnd,
+					[&](tinyxml2::XMLPrinter & xmlChunk, size_t f) {
+						XMLPushFileElement(
+							xmlChunk, *(vecFiles[f].first), *(vecFiles[f].second));
+					}, strText);
+			}, WriteChunks);
+	}
+
+	// AxisInfo
+	{
+		std::vector<const AxisInfo *> vecAxes;
+		vecAxes.reserve(m_vecAxisInfo.size());
+		LookupVectorHeap<std::string, AxisInfo>::const_iterator iteraxis = m_vecAxisInfo.begin();
+		for (; iteraxis != m_vecAxisInfo.end(); iteraxis++) {
+			vecAxes.push_back(*iteraxis);
+		}
+
+		FormatInParallel(m_sThreads, vecAxes.size(), 1,
+			[&](size_t sBegin, size_t sEnd, std::string & strText) {
+				XMLFormatDatasetChildren(sBegin, sEnd,
+					[&](tinyxml2::XMLPrinter & xmlChunk, size_t a) {
+						XMLPushAxisElement(xmlChunk, *(vecAxes[a]));
+					}, strText);
+			}, WriteChunks);
+	}
+
+	// Variables
+	FormatInParallel(m_sThreads, m_vecVariableInfo.size(), FormatVariableChunkItems,
+		[&](size_t sBegin, size_t sEnd, std::string & strText) {
+			XMLFormatDatasetChildren(sBegin, sEnd,
+				[&](tinyxml2::XMLPrinter & xmlChunk, size_t v) {
+					XMLPushVariableElement(xmlChunk, *(m_vecVariableInfo[v]));
+				}, strText);
+		}, WriteChunks);
+
+	xmlPrinter.CloseElement();
+
+	if (ferror(fpXML) || (fclose(fpXML) != 0)) {
+		_EXCEPTION1("Error writing file \"%s\"",
+			strXMLOutputFilename.c_str());
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+// IndexedDatasetJSONReader
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		The parts of an index loaded when only some of its variables are
+///		selected.  The index is read in two passes: the first reads only
+///		the selected variables, and the second reads only the files,
+///		axes and subaxes that they reference.
+///	</summary>
+class IndexLoadFilter {
+
+public:
+	///	<summary>
+	///		Pass through the index.
+	///	</summary>
+	enum Pass {
+		Pass_Variables,
+		Pass_References
+	};
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	IndexLoadFilter(
+		const std::set<std::string> & setVariables
+	) :
+		m_ePass(Pass_Variables),
+		m_setVariables(setVariables)
+	{ }
+
+	///	<summary>
+	///		Record the files, axes and subaxes referenced by the variables
+	///		read in the first pass, and begin the second pass.  Returns an
+	///		error if a selected variable is not in the index.
+	///	</summary>
+	std::string BeginReferencesPass(
+		const LookupVectorHeap<std::string, VariableInfo> & vecVariableInfo,
+		const std::string & strFilename
+	) {
+		std::set<std::string>::const_iterator itervar = m_setVariables.begin();
+		for (; itervar != m_setVariables.end(); itervar++) {
+			if (vecVariableInfo.find(*itervar) == vecVariableInfo.end()) {
+				return std::string("Variable \"") + *itervar
+					+ std::string("\" not found in \"") + strFilename
+					+ std::string("\"");
+			}
+		}
+
+		for (size_t v = 0; v < vecVariableInfo.size(); v++) {
+			const AxisNamesToSubAxisToFileIdMapMap & mapMaps =
+				vecVariableInfo[v]->m_mapSubAxisToFileIdMaps;
+			AxisNamesToSubAxisToFileIdMapMap::const_iterator itermap = mapMaps.begin();
+			for (; itermap != mapMaps.end(); itermap++) {
+				const AxisNameVector & vecAxisNames = itermap->first;
+				const SubAxisToFileIdMap & mapSubAxisToFileId = itermap->second;
+
+				std::vector< std::unordered_set<IndexId> * > vecpsetSubAxisIds;
+				for (size_t d = 0; d < vecAxisNames.size(); d++) {
+					vecpsetSubAxisIds.push_back(&(m_mapAxisSubAxisIds[vecAxisNames[d]]));
+				}
+				for (size_t i = 0; i < mapSubAxisToFileId.size(); i++) {
+					const IndexId * pidSubAxis = mapSubAxisToFileId.subaxisids(i);
+					for (size_t d = 0; d < vecpsetSubAxisIds.size(); d++) {
+						vecpsetSubAxisIds[d]->insert(pidSubAxis[d]);
+					}
+					m_setFileIds.insert(mapSubAxisToFileId.fileid(i));
+				}
+			}
+		}
+
+		m_ePass = Pass_References;
+		return std::string("");
+	}
+
+	///	<summary>
+	///		Check if the given section of the index is read in this pass.
+	///	</summary>
+	bool LoadsSection(
+		const std::string & strSection
+	) const {
+		const bool fVariables =
+			(strSection == "variables") || (strSection == "shards");
+		return (m_ePass == Pass_Variables)?(fVariables):(!fVariables);
+	}
+
+	///	<summary>
+	///		Check if the given variable is loaded.
+	///	</summary>
+	bool LoadsVariable(
+		const std::string & strVariable
+	) const {
+		return (m_setVariables.find(strVariable) != m_setVariables.end());
+	}
+
+	///	<summary>
+	///		Check if the file with the given id is loaded.
+	///	</summary>
+	bool LoadsFile(
+		const std::string & strFileId
+	) const {
+		IndexId idFile;
+		return IndexIdFromString(strFileId, idFile)
+			&& (m_setFileIds.find(idFile) != m_setFileIds.end());
+	}
+
+	///	<summary>
+	///		Check if the given axis is loaded.
+	///	</summary>
+	bool LoadsAxis(
+		const std::string & strAxis
+	) const {
+		return (m_mapAxisSubAxisIds.find(strAxis) != m_mapAxisSubAxisIds.end());
+	}
+
+	///	<summary>
+	///		Check if the subaxis with the given id of the given axis is
+	///		loaded.
+	///	</summary>
+	bool LoadsSubAxis(
+		const std::string & strAxis,
+		const std::string & strSubAxisId
+	) const {
+		std::map< std::string, std::unordered_set<IndexId> >::const_iterator iteraxis =
+			m_mapAxisSubAxisIds.find(strAxis);
+		IndexId idSubAxis;
+		return (iteraxis != m_mapAxisSubAxisIds.end())
+			&& IndexIdFromString(strSubAxisId, idSubAxis)
+			&& (iteraxis->second.find(idSubAxis) != iteraxis->second.end());
+	}
+
+protected:
+	///	<summary>
+	///		Current pass.
+	///	</summary>
+	Pass m_ePass;
+
+	///	<summary>
+	///		Variables selected.
+	///	</summary>
+	std::set<std::string> m_setVariables;
+
+	///	<summary>
+	///		Ids of files referenced by the selected variables.
+	///	</summary>
+	std::unordered_set<IndexId> m_setFileIds;
+
+	///	<summary>
+	///		Ids of the subaxes of each axis referenced by the selected
+	///		variables.
+	///	</summary>
+	std::map< std::string, std::unordered_set<IndexId> > m_mapAxisSubAxisIds;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A nlohmann::json SAX event consumer that populates an IndexedDataset
+///		directly from a JSON index, without building a DOM of the document.
+///		Only the scalars and coordinate values of the entry currently being
+///		read are buffered, so members may appear in any order.  CBOR and
+///		MessagePack indexes are read through the same interface by
+///		BinaryIndexReader, which also reports typed coordinate arrays.
+///		Entries excluded by an IndexLoadFilter are skipped unbuilt.
+///	</summary>
+class IndexedDatasetJSONReader {
+
+public:
+	typedef nlohmann::json::number_integer_t number_integer_t;
+	typedef nlohmann::json::number_unsigned_t number_unsigned_t;
+	typedef nlohmann::json::number_float_t number_float_t;
+	typedef nlohmann::json::string_t string_t;
+
+protected:
+	///	<summary>
+	///		Position in the document.
+	///	</summary>
+	enum State {
+		State_Document,
+		State_Root,
+		State_Dataset,
+		State_Files,
+		State_File,
+		State_FileStamp,
+		State_FileStatistics,
+		State_FileVariableStatistics,
+		State_FileAxes,
+		State_FileAxisPair,
+		State_FileAttributeBlocks,
+		State_FileAttributeBlock,
+		State_Axes,
+		State_Axis,
+		State_AxisValues,
+		State_AxisSummary,
+		State_AxisRange,
+		State_SubAxes,
+		State_SubAxis,
+		State_SubAxisValues,
+		State_SubAxisSummary,
+		State_SubAxisRange,
+		State_Variables,
+		State_Variable,
+		State_VariableStorage,
+		State_VariableStorageChunks,
+		State_AxisGroups,
+		State_AxisGroup,
+		State_AxisIds,
+		State_SubAxisMap,
+		State_SubAxisMapEntry,
+		State_Shards,
+		State_Shard,
+		State_Skip
+	};
+
+	///	<summary>
+	///		An open object or array, with the most recent key if an object.
+	///	</summary>
+	struct Frame {
+		Frame(State eState) :
+			m_eState(eState)
+		{ }
+
+		State m_eState;
+		std::string m_strKey;
+	};
+
+	///	<summary>
+	///		Type of a scalar value.
+	///	</summary>
+	enum ValueType {
+		Value_Null,
+		Value_Boolean,
+		Value_Integer,
+		Value_Unsigned,
+		Value_Float,
+		Value_String
+	};
+
+	///	<summary>
+	///		A scalar value.
+	///	</summary>
+	struct Scalar {
+		Scalar(ValueType eType) :
+			m_eType(eType),
+			m_ll(0),
+			m_ull(0),
+			m_d(0.0),
+			m_pstr(NULL)
+		{ }
+
+		bool IsNumber() const {
+			return (
+				(m_eType == Value_Integer) ||
+				(m_eType == Value_Unsigned) ||
+				(m_eType == Value_Float));
+		}
+
+		bool IsInteger() const {
+			return ((m_eType == Value_Integer) || (m_eType == Value_Unsigned));
+		}
+
+		double AsDouble() const {
+			if (m_eType == Value_Integer) {
+				return static_cast<double>(m_ll);
+			} else if (m_eType == Value_Unsigned) {
+				return static_cast<double>(m_ull);
+			}
+			return m_d;
+		}
+
+		long long AsLongLong() const {
+			if (m_eType == Value_Integer) {
+				return m_ll;
+			} else if (m_eType == Value_Unsigned) {
+				return static_cast<long long>(m_ull);
+			}
+			return static_cast<long long>(m_d);
+		}
+
+		ValueType m_eType;
+		long long m_ll;
+		unsigned long long m_ull;
+		double m_d;
+		const std::string * m_pstr;
+	};
+
+	///	<summary>
+	///		Members of an axis or subaxis entry describing a SubAxis.
+	///	</summary>
+	struct SubAxisData {
+		void Reset() {
+			m_fHasDatatype = false;
+			m_strDatatype = "";
+			m_fHasSize = false;
+			m_lSize = 0;
+			m_fHasValues = false;
+			m_fValuesArray = false;
+			m_dValues.clear();
+			m_fHasSummary = false;
+			m_fHasHash = false;
+			m_summary = SubAxisSummary();
+			m_summary.m_dMin = std::numeric_limits<double>::infinity();
+			m_summary.m_dMax = -std::numeric_limits<double>::infinity();
+			m_strSource = "";
+			m_fHasRange = false;
+			m_fHasRangeStart = false;
+			m_dRangeStart = 0.0;
+			m_fHasRangeStep = false;
+			m_dRangeStep = 0.0;
+			m_strUnits = "";
+			m_fHasGrid = false;
+			m_ullGrid = 0;
+		}
+
+		bool m_fHasDatatype;
+		std::string m_strDatatype;
+		bool m_fHasSize;
+		long m_lSize;
+		bool m_fHasValues;
+		bool m_fValuesArray;
+		std::vector<double> m_dValues;
+		bool m_fHasSummary;
+		bool m_fHasHash;
+		SubAxisSummary m_summary;
+		std::string m_strSource;
+		bool m_fHasRange;
+		bool m_fHasRangeStart;
+		double m_dRangeStart;
+		bool m_fHasRangeStep;
+		double m_dRangeStep;
+		std::string m_strUnits;
+		bool m_fHasGrid;
+		unsigned long long m_ullGrid;
+	};
+
+	///	<summary>
+	///		Members of a variable or axis group entry describing a
+	///		SubAxisToFileIdMap.
+	///	</summary>
+	struct AxisGroupData {
+		void Reset() {
+			m_fHasAxisIds = false;
+			m_vecAxisNames.clear();
+			m_fHasSubAxisMap = false;
+			m_mapSubAxisToFileId.clear();
+		}
+
+		bool m_fHasAxisIds;
+		AxisNameVector m_vecAxisNames;
+		bool m_fHasSubAxisMap;
+		SubAxisToFileIdMap m_mapSubAxisToFileId;
+	};
+
+public:
+	///	<summary>
+	///		Constructor.  If fShard is set the document is a shard of a
+	///		sharded index, of which only the "variables" section is read.
+	///		If pfilter is not NULL only the parts of the index it selects
+	///		for its current pass are read.
+	///	</summary>
+	IndexedDatasetJSONReader(
+		IndexedDataset & dataset,
+		const std::string & strFilename,
+		bool fShard = false,
+		const IndexLoadFilter * pfilter = NULL,
+		IndexDedupState * pdedupstate = NULL
+	) :
+		m_dataset(dataset),
+		m_strFilename(strFilename),
+		m_fShard(fShard),
+		m_pfilter(pfilter),
+		m_pdedupstate(pdedupstate),
+		m_fHasDataset(false),
+		m_fHasFiles(false),
+		m_fHasAxes(false),
+		m_fHasVariables(false),
+		m_fHasShards(false),
+		m_pfileinfo(NULL),
+		m_pattrblockinfo(NULL),
+		m_paxisinfo(NULL),
+		m_pvarinfo(NULL),
+		m_pgroup(NULL)
+	{
+		m_vecStack.push_back(Frame(State_Document));
+	}
+
+public:
+	///	<summary>
+	///		Get the shards listed in the "shards" section, each with the
+	///		names of its variables.
+	///	</summary>
+	const std::vector< std::pair<std::string, std::vector<std::string> > > & GetShards() const {
+		return m_vecShards;
+	}
+
+public:
+	bool null() {
+		return OnScalar(Scalar(Value_Null));
+	}
+
+	bool boolean(bool f) {
+		Scalar v(Value_Boolean);
+		v.m_ll = (f)?(1):(0);
+		return OnScalar(v);
+	}
+
+	bool number_integer(number_integer_t n) {
+		Scalar v(Value_Integer);
+		v.m_ll = static_cast<long long>(n);
+		return OnScalar(v);
+	}
+
+	bool number_unsigned(number_unsigned_t n) {
+		Scalar v(Value_Unsigned);
+		v.m_ull = static_cast<unsigned long long>(n);
+		return OnScalar(v);
+	}
+
+	bool number_float(number_float_t d, const string_t &) {
+		Scalar v(Value_Float);
+		v.m_d = static_cast<double>(d);
+		return OnScalar(v);
+	}
+
+	bool string(string_t & str) {
+		Scalar v(Value_String);
+		v.m_pstr = &str;
+		return OnScalar(v);
+	}
+
+	bool start_object(std::size_t) {
+		return OnStart(true);
+	}
+
+	bool key(string_t & str) {
+		m_vecStack.back().m_strKey = str;
+		return true;
+	}
+
+	bool end_object() {
+		return OnEnd();
+	}
+
+	bool start_array(std::size_t) {
+		return OnStart(false);
+	}
+
+	bool end_array() {
+		return OnEnd();
+	}
+
+	bool typed_array(
+		BinaryIndexArrayType eType,
+		const std::vector<unsigned char> & vecBytes
+	) {
+		Frame & frame = m_vecStack.back();
+		const std::string & strKey = frame.m_strKey;
+
+		SubAxisData * pdata = NULL;
+		if ((frame.m_eState == State_Axis) && (strKey == "values")) {
+			pdata = &m_dataAxis;
+		} else if ((frame.m_eState == State_SubAxis) && (strKey == "values")) {
+			pdata = &m_dataSubAxis;
+		} else if (frame.m_eState == State_Skip) {
+			return true;
+		} else if ((frame.m_eState == State_Root) && !RootSection(strKey)) {
+			return true;
+		} else {
+			_EXCEPTION2("Unexpected typed array with key \"%s\" in \"%s\"",
+				strKey.c_str(), m_strFilename.c_str());
+		}
+
+		pdata->m_fHasValues = true;
+		pdata->m_fValuesArray = true;
+		BinaryIndexDecodeArray(eType, vecBytes, pdata->m_dValues);
+		return true;
+	}
+
+	bool parse_error(
+		std::size_t,
+		const std::string &,
+		const nlohmann::detail::exception & ex
+	) {
+		_EXCEPTION2("Error parsing JSON file \"%s\": %s",
+			m_strFilename.c_str(), ex.what());
+	}
+
+protected:
+	///	<summary>
+	///		Add to each file entry that references a block of the
+	///		"file_attributes" section the attributes of the block it does
+	///		not override, and share them again in the dataset.
+	///	</summary>
+	void ResolveFileAttributeBlocks() {
+		for (size_t f = 0; f < m_vecFileAttributeBlockRefs.size(); f++) {
+			FileInfo & fileinfo = *(m_vecFileAttributeBlockRefs[f].first);
+			const std::string & strBlockId = m_vecFileAttributeBlockRefs[f].second;
+
+			std::map<std::string, DataObjectInfo>::const_iterator iterBlock =
+				m_mapFileAttributeBlocks.find(strBlockId);
+			if (iterBlock == m_mapFileAttributeBlocks.end()) {
+				_EXCEPTION2("JSON file entry \"%s\" refers to unknown "
+					"\"file_attributes\" block \"%s\"",
+					fileinfo.m_strFilename.c_str(), strBlockId.c_str());
+			}
+			fileinfo.m_mapKeyAttributes.insert(
+				iterBlock->second.m_mapKeyAttributes.begin(),
+				iterBlock->second.m_mapKeyAttributes.end());
+			fileinfo.m_mapOtherAttributes.insert(
+				iterBlock->second.m_mapOtherAttributes.begin(),
+				iterBlock->second.m_mapOtherAttributes.end());
+			m_dataset.m_fileattrblocks.Share(fileinfo);
+		}
+		m_vecFileAttributeBlockRefs.clear();
+	}
+
+	///	<summary>
+	///		Insert a scalar attribute into a DataObjectInfo.
+	///	</summary>
+	void InsertAttribute(
+		DataObjectInfo & info,
+		const char * szSection,
+		const std::string & strKey,
+		const Scalar & v
+	) {
+		std::string strValue;
+		if (v.m_eType == Value_String) {
+			strValue = *(v.m_pstr);
+		} else if (v.IsInteger()) {
+			strValue = std::to_string(v.AsLongLong());
+		} else if (v.m_eType == Value_Float) {
+			char szValue[NumberFormatMaxChars];
+			strValue.assign(szValue, FormatNumber(szValue, v.m_d));
+		} else {
+			_EXCEPTION2("Invalid JSON attribute value in \"%s\" with key \"%s\"",
+				szSection, strKey.c_str());
+		}
+
+		// Global attributes of files are split as FromNcFile splits them
+		if (strcmp(szSection, "file") == 0) {
+			info.InsertFileAttribute(strKey, strValue);
+		} else {
+			info.InsertAttribute(strKey, strValue);
+		}
+	}
+
+	///	<summary>
+	///		Handle a scalar member of an axis or subaxis entry describing
+	///		a SubAxis.  Returns false if the key is not a SubAxis member.
+	///	</summary>
+	bool SubAxisScalar(
+		SubAxisData & data,
+		const std::string & strEntryKey,
+		const std::string & strKey,
+		const Scalar & v
+	) {
+		if (strKey == "datatype") {
+			if (v.m_eType != Value_String) {
+				_EXCEPTION1("JSON axis \"%s\" \"datatype\" must be type string",
+					strEntryKey.c_str());
+			}
+			data.m_fHasDatatype = true;
+			data.m_strDatatype = *(v.m_pstr);
+			return true;
+		}
+		if (strKey == "size") {
+			if (!v.IsInteger()) {
+				_EXCEPTION1("JSON subaxis \"%s\" \"size\" must be type integer",
+					strEntryKey.c_str());
+			}
+			data.m_fHasSize = true;
+			data.m_lSize = static_cast<long>(v.AsLongLong());
+			return true;
+		}
+		if (strKey == "values") {
+			data.m_fHasValues = true;
+			data.m_fValuesArray = false;
+			return true;
+		}
+		if (strKey == "fingerprint") {
+			unsigned long long ullFingerprint;
+			if ((v.m_eType != Value_String) ||
+			    !SummaryHashFromString(*(v.m_pstr), ullFingerprint)
+			) {
+				_EXCEPTION1("JSON subaxis \"%s\" \"fingerprint\" must be a hexadecimal string",
+					strEntryKey.c_str());
+			}
+			return true;
+		}
+		if (strKey == "grid") {
+			if ((v.m_eType != Value_String) ||
+			    !SummaryHashFromString(*(v.m_pstr), data.m_ullGrid)
+			) {
+				_EXCEPTION1("JSON subaxis \"%s\" \"grid\" must be a hexadecimal string",
+					strEntryKey.c_str());
+			}
+			data.m_fHasGrid = true;
+			return true;
+		}
+		if (strKey == "summary") {
+			_EXCEPTION1("JSON subaxis \"%s\" \"summary\" must be type object",
+				strEntryKey.c_str());
+		}
+		if (strKey == "range") {
+			_EXCEPTION1("JSON subaxis \"%s\" \"range\" must be type object",
+				strEntryKey.c_str());
+		}
+		return false;
+	}
+
+	///	<summary>
+	///		Handle a member of the summary of an axis or subaxis entry.
+	///	</summary>
+	void SummaryScalar(
+		SubAxisData & data,
+		const std::string & strKey,
+		const Scalar & v
+	) {
+		double * pdValue = NULL;
+		if (strKey == "min") {
+			pdValue = &(data.m_summary.m_dMin);
+		} else if (strKey == "max") {
+			pdValue = &(data.m_summary.m_dMax);
+		} else if (strKey == "first") {
+			pdValue = &(data.m_summary.m_dFirst);
+		} else if (strKey == "last") {
+			pdValue = &(data.m_summary.m_dLast);
+		}
+		if (pdValue != NULL) {
+			if (v.m_eType == Value_Null) {
+				*pdValue = std::numeric_limits<double>::quiet_NaN();
+			} else if (v.IsNumber()) {
+				*pdValue = v.AsDouble();
+			} else {
+				_EXCEPTION1("JSON subaxis summary \"%s\" must be type number",
+					strKey.c_str());
+			}
+
+		} else if (strKey == "hash") {
+			if ((v.m_eType != Value_String) ||
+			    !SummaryHashFromString(*(v.m_pstr), data.m_summary.m_ullHash)
+			) {
+				_EXCEPTIONT("JSON subaxis summary \"hash\" must be a hexadecimal string");
+			}
+			data.m_fHasHash = true;
+
+		} else if ((strKey == "source") && (v.m_eType == Value_String)) {
+			data.m_strSource = *(v.m_pstr);
+		}
+	}
+
+	///	<summary>
+	///		Handle a member of the range of an axis or subaxis entry.
+	///	</summary>
+	void RangeScalar(
+		SubAxisData & data,
+		const std::string & strKey,
+		const Scalar & v
+	) {
+		double * pdValue = NULL;
+		if (strKey == "start") {
+			pdValue = &(data.m_dRangeStart);
+			data.m_fHasRangeStart = true;
+		} else if (strKey == "step") {
+			pdValue = &(data.m_dRangeStep);
+			data.m_fHasRangeStep = true;
+		} else {
+			return;
+		}
+		if (!v.IsNumber()) {
+			_EXCEPTION1("JSON subaxis range \"%s\" must be type number",
+				strKey.c_str());
+		}
+		*pdValue = v.AsDouble();
+	}
+
+	///	<summary>
+	///		Build a SubAxis from the members of an axis or subaxis entry.
+	///	</summary>
+	SubAxis * BuildSubAxis(
+		SubAxisData & data,
+		const std::string & strEntryKey
+	) {
+		if (!data.m_fHasDatatype) {
+			_EXCEPTION1("JSON subaxis \"%s\" missing \"datatype\" key",
+				strEntryKey.c_str());
+		}
+		if (!data.m_fHasSize) {
+			_EXCEPTION1("JSON subaxis \"%s\" missing \"size\" key",
+				strEntryKey.c_str());
+		}
+
+		SubAxis * psubaxis = new SubAxis();
+		psubaxis->m_nctype = StringToNcType(data.m_strDatatype);
+		psubaxis->m_lSize = data.m_lSize;
+		psubaxis->m_strUnits = data.m_strUnits;
+
+		if (data.m_fHasSummary) {
+			if (data.m_fHasValues) {
+				delete psubaxis;
+				_EXCEPTION1("JSON subaxis \"%s\" specifies both \"values\" and \"summary\"",
+					strEntryKey.c_str());
+			}
+			if (!data.m_fHasHash) {
+				delete psubaxis;
+				_EXCEPTION1("JSON subaxis \"%s\" summary missing valid \"hash\"",
+					strEntryKey.c_str());
+			}
+			psubaxis->m_fSummarized = true;
+			psubaxis->m_summary = data.m_summary;
+			psubaxis->m_summary.m_sCount = static_cast<size_t>(data.m_lSize);
+			psubaxis->m_strSourceFile = data.m_strSource;
+		}
+
+		if (data.m_fHasRange) {
+			if (data.m_fHasValues || data.m_fHasSummary) {
+				delete psubaxis;
+				_EXCEPTION1("JSON subaxis \"%s\" specifies \"range\" with \"values\" or \"summary\"",
+					strEntryKey.c_str());
+			}
+			if (!data.m_fHasRangeStart || !data.m_fHasRangeStep) {
+				delete psubaxis;
+				_EXCEPTION1("JSON subaxis \"%s\" \"range\" requires numbers \"start\" and \"step\"",
+					strEntryKey.c_str());
+			}
+			if (!IsNumericNcType(psubaxis->m_nctype)) {
+				delete psubaxis;
+				_EXCEPTION1("JSON subaxis \"%s\" \"range\" unsupported type, expected a numeric type", strEntryKey.c_str());
+			}
+			if (psubaxis->m_lSize < 0) {
+				delete psubaxis;
+				_EXCEPTION1("JSON subaxis \"%s\" \"size\" must be non-negative",
+					strEntryKey.c_str());
+			}
+			psubaxis->ExpandLinear(data.m_dRangeStart, data.m_dRangeStep);
+		}
+
+		if (data.m_fHasGrid) {
+			if (data.m_fHasValues || data.m_fHasSummary || data.m_fHasRange) {
+				delete psubaxis;
+				_EXCEPTION1("JSON subaxis \"%s\" specifies \"grid\" with \"values\", \"summary\" or \"range\"",
+					strEntryKey.c_str());
+			}
+			const GridRegistry * pgridregistry = m_dataset.m_pgridregistry;
+			const SubAxis * pgrid =
+				(pgridregistry == NULL)?(NULL):(pgridregistry->Find(data.m_ullGrid));
+			if ((pgrid == NULL) ||
+			    (pgrid->m_nctype != psubaxis->m_nctype) ||
+			    (pgrid->m_lSize != psubaxis->m_lSize)
+			) {
+				delete psubaxis;
+				_EXCEPTION2("JSON subaxis \"%s\" references grid %016llx, which is not in the grid registry",
+					strEntryKey.c_str(), data.m_ullGrid);
+			}
+			psubaxis->m_values = pgrid->m_values;
+			psubaxis->m_fLinear = pgrid->m_fLinear;
+			psubaxis->m_dLinearStart = pgrid->m_dLinearStart;
+			psubaxis->m_dLinearStep = pgrid->m_dLinearStep;
+		}
+
+		if (data.m_fHasValues) {
+			if (!data.m_fValuesArray) {
+				delete psubaxis;
+				_EXCEPTION1("JSON subaxis \"%s\" \"values\" must be type array",
+					strEntryKey.c_str());
+			}
+			ValuesFromDoublesKernel kernel = {psubaxis->m_values, data.m_dValues};
+			if (!DispatchNumericNcType(psubaxis->m_nctype, kernel)) {
+				delete psubaxis;
+				_EXCEPTION1("JSON subaxis \"%s\" \"values\" unsupported type, expected a numeric type", strEntryKey.c_str());
+			}
+			psubaxis->DetectLinear();
+		}
+		return psubaxis;
+	}
+
+	///	<summary>
+	///		Handle the start of an axisids or subaxismap member.  Returns
+	///		false if the key is neither.
+	///	</summary>
+	bool AxisGroupStart(
+		State eState,
+		bool fObject,
+		const std::string & strKey
+	) {
+		if (strKey == "axisids") {
+			if (fObject) {
+				_EXCEPTION1("JSON variable \"%s\" \"axisids\" must be type array",
+					m_pvarinfo->m_strName.c_str());
+			}
+			m_pgroup->m_fHasAxisIds = true;
+			m_pgroup->m_vecAxisNames.clear();
+			m_vecStack.push_back(Frame(State_AxisIds));
+			return true;
+		}
+		if (strKey == "subaxismap") {
+			if (fObject) {
+				_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" must be type "
+					"array of arrays of strings",
+					m_pvarinfo->m_strName.c_str());
+			}
+			m_pgroup->m_fHasSubAxisMap = true;
+			m_vecStack.push_back(Frame(State_SubAxisMap));
+			return true;
+		}
+		return false;
+	}
+
+	///	<summary>
+	///		Handle a scalar axisids or subaxismap member.  Returns false
+	///		if the key is neither.
+	///	</summary>
+	bool AxisGroupScalar(
+		const std::string & strKey,
+		const Scalar & v
+	) {
+		if (strKey == "axisids") {
+			if (v.m_eType != Value_Null) {
+				_EXCEPTION1("JSON variable \"%s\" \"axisids\" must be type array",
+					m_pvarinfo->m_strName.c_str());
+			}
+			m_pgroup->m_fHasAxisIds = true;
+			m_pgroup->m_vecAxisNames.clear();
+			return true;
+		}
+		if (strKey == "subaxismap") {
+			_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" must be type "
+				"array of arrays of strings",
+				m_pvarinfo->m_strName.c_str());
+		}
+		return false;
+	}
+
+	///	<summary>
+	///		Insert the SubAxisToFileIdMap described by an axis group.
+	///	</summary>
+	void InsertAxisGroup(
+		AxisGroupData & group
+	) {
+		if (!group.m_fHasAxisIds) {
+			_EXCEPTION1("JSON variable \"%s\" missing \"axisids\" key",
+				m_pvarinfo->m_strName.c_str());
+		}
+		if (!group.m_fHasSubAxisMap) {
+			_EXCEPTION1("JSON variable \"%s\" missing \"subaxismap\" key",
+				m_pvarinfo->m_strName.c_str());
+		}
+		if ((group.m_mapSubAxisToFileId.size() != 0) &&
+		    (group.m_mapSubAxisToFileId.width() != group.m_vecAxisNames.size())
+		) {
+			_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" entries do not "
+				"match \"axisids\"",
+				m_pvarinfo->m_strName.c_str());
+		}
+		group.m_mapSubAxisToFileId.shrink_to_fit();
+		m_pvarinfo->m_mapSubAxisToFileIdMaps.insert(
+			AxisNamesToSubAxisToFileIdMapMap::value_type(
+				group.m_vecAxisNames, SubAxisToFileIdMap()))
+			.first->second.swap(group.m_mapSubAxisToFileId);
+	}
+
+	///	<summary>
+	///		Handle a scalar member of the statistics of a variable of a
+	///		file.  Members that are not known are ignored.
+	///	</summary>
+	void StatisticsScalar(
+		const std::string & strKey,
+		const Scalar & v
+	) {
+		if ((strKey == "count") || (strKey == "missing")) {
+			if (!v.IsInteger() || (v.AsLongLong() < 0)) {
+				_EXCEPTION2("JSON file statistics of \"%s\" \"%s\" must be "
+					"a non-negative integer",
+					m_strStatisticsVariable.c_str(), strKey.c_str());
+			}
+			const unsigned long long ullValue =
+				(v.m_eType == Value_Unsigned)?(v.m_ull):
+				static_cast<unsigned long long>(v.AsLongLong());
+			if (strKey == "count") {
+				m_statistics.m_ullCount = ullValue;
+			} else {
+				m_statistics.m_ullMissing = ullValue;
+			}
+
+		} else if ((strKey == "min") || (strKey == "max") || (strKey == "mean")) {
+			if (!v.IsNumber()) {
+				_EXCEPTION2("JSON file statistics of \"%s\" \"%s\" must be a number",
+					m_strStatisticsVariable.c_str(), strKey.c_str());
+			}
+			if (strKey == "min") {
+				m_statistics.m_dMin = v.AsDouble();
+			} else if (strKey == "max") {
+				m_statistics.m_dMax = v.AsDouble();
+			} else {
+				m_dStatisticsMean = v.AsDouble();
+			}
+		}
+	}
+
+	///	<summary>
+	///		Handle a scalar member of the storage of a variable.  Members
+	///		that are not known are ignored.
+	///	</summary>
+	void StorageScalar(
+		const std::string & strKey,
+		const Scalar & v
+	) {
+		VariableStorage & storage = m_pvarinfo->m_storage;
+		if (strKey == "layout") {
+			if ((v.m_eType != Value_String) ||
+			    !VariableStorage::LayoutFromString(*(v.m_pstr), storage.m_eLayout)
+			) {
+				_EXCEPTION1("JSON variable \"%s\" \"layout\" must be one of "
+					"\"contiguous\", \"chunked\" or \"compact\"",
+					m_pvarinfo->m_strName.c_str());
+			}
+
+		} else if (strKey == "endian") {
+			if ((v.m_eType != Value_String) ||
+			    !VariableStorage::EndianFromString(*(v.m_pstr), storage.m_eEndian)
+			) {
+				_EXCEPTION1("JSON variable \"%s\" \"endian\" must be one of "
+					"\"native\", \"little\" or \"big\"",
+					m_pvarinfo->m_strName.c_str());
+			}
+
+		} else if ((strKey == "deflate") || (strKey == "filter")) {
+			if (!v.IsInteger() || (v.AsLongLong() < 0)) {
+				_EXCEPTION2("JSON variable \"%s\" \"%s\" must be a non-negative integer",
+					m_pvarinfo->m_strName.c_str(), strKey.c_str());
+			}
+			if (strKey == "deflate") {
+				storage.m_iDeflateLevel = static_cast<int>(v.AsLongLong());
+			} else {
+				storage.m_uFilterId = static_cast<unsigned int>(v.AsLongLong());
+			}
+
+		} else if ((strKey == "shuffle") || (strKey == "fletcher32") || (strKey == "varies")) {
+			if (v.m_eType != Value_Boolean) {
+				_EXCEPTION2("JSON variable \"%s\" \"%s\" must be type boolean",
+					m_pvarinfo->m_strName.c_str(), strKey.c_str());
+			}
+			if (strKey == "shuffle") {
+				storage.m_fShuffle = (v.m_ll != 0);
+			} else if (strKey == "fletcher32") {
+				storage.m_fFletcher32 = (v.m_ll != 0);
+			} else {
+				m_pvarinfo->m_fStorageVaries = (v.m_ll != 0);
+			}
+
+		} else if (strKey == "chunks") {
+			_EXCEPTION1("JSON variable \"%s\" \"chunks\" must be type array of integers",
+				m_pvarinfo->m_strName.c_str());
+		}
+	}
+
+	///	<summary>
+	///		Handle a scalar value.
+	///	</summary>
+	bool OnScalar(const Scalar & v) {
+		Frame & frame = m_vecStack.back();
+		const std::string & strKey = frame.m_strKey;
+
+		switch (frame.m_eState) {
+		case State_Document:
+			_EXCEPTION1("JSON file \"%s\" must contain an object",
+				m_strFilename.c_str());
+
+		case State_Root:
+			if (!RootSection(strKey)) {
+				return true;
+			}
+			if (v.m_eType != Value_Null) {
+				_EXCEPTION1("JSON \"%s\" must be of type object", strKey.c_str());
+			}
+			return true;
+
+		case State_Dataset:
+			if (v.m_eType != Value_String) {
+				_EXCEPTION1("Invalid JSON attribute value in \"dataset\" with key \"%s\"",
+					strKey.c_str());
+			}
+			m_dataset.m_datainfo.InsertFileAttribute(strKey, *(v.m_pstr));
+			return true;
+
+		case State_Files:
+			_EXCEPTIONT("JSON file entry missing \"name\" key");
+
+		case State_File:
+			if (strKey == "name") {
+				if (v.m_eType != Value_String) {
+					_EXCEPTIONT("JSON file entry \"name\" must be of type string");
+				}
+				m_pfileinfo->m_strFilename = *(v.m_pstr);
+				m_fHasFileName = true;
+
+			} else if (strKey == "stamp") {
+				_EXCEPTIONT("\"stamp\" must be of type object");
+
+			} else if (strKey == "statistics") {
+				_EXCEPTIONT("\"statistics\" must be of type object");
+
+			} else if (strKey == "axes") {
+				if (v.m_eType != Value_Null) {
+					_EXCEPTIONT("\"axes\" must be of type array");
+				}
+
+			} else if (strKey == "shared_attributes") {
+				if (v.m_eType != Value_String) {
+					_EXCEPTIONT("JSON file entry \"shared_attributes\" must be of type string");
+				}
+				m_strFileAttributeBlock = *(v.m_pstr);
+
+			} else {
+				InsertAttribute(*m_pfileinfo, "file", strKey, v);
+			}
+			return true;
+
+		case State_FileAttributeBlocks:
+			_EXCEPTION1("JSON file attribute block \"%s\" must be of type object",
+				strKey.c_str());
+
+		case State_FileAttributeBlock:
+			InsertAttribute(*m_pattrblockinfo, "file", strKey, v);
+			return true;
+
+		case State_FileStamp:
+			if ((strKey == "size") || (strKey == "mtime") || (strKey == "inode")) {
+				if (!v.IsNumber()) {
+					_EXCEPTIONT("\"stamp\" must contain \"size\", "
+						"\"mtime\" and \"inode\"");
+				}
+				if (strKey == "size") {
+					m_pfileinfo->m_stamp.m_llSize = v.AsLongLong();
+					m_nStampMembers |= 1;
+				} else if (strKey == "mtime") {
+					m_pfileinfo->m_stamp.m_llModTime = v.AsLongLong();
+					m_nStampMembers |= 2;
+				} else {
+					m_pfileinfo->m_stamp.m_ullInode =
+						(v.m_eType == Value_Unsigned)?(v.m_ull):
+						static_cast<unsigned long long>(v.AsLongLong());
+					m_nStampMembers |= 4;
+				}
+			}
+			return true;
+
+		case State_FileStatistics:
+			_EXCEPTION1("JSON file statistics of \"%s\" must be of type object",
+				strKey.c_str());
+
+		case State_FileVariableStatistics:
+			StatisticsScalar(strKey, v);
+			return true;
+
+		case State_FileAxes:
+			_EXCEPTIONT("\"axes\" must be an array of arrays");
+
+		case State_FileAxisPair:
+			if (v.m_eType != Value_String) {
+				_EXCEPTIONT("\"axes\" must be an array of arrays of strings");
+			}
+			m_vecAxisPair.push_back(*(v.m_pstr));
+			return true;
+
+		case State_Axes:
+			_EXCEPTIONT("JSON axis entry missing \"datatype\" key");
+
+		case State_Axis:
+			if (SubAxisScalar(m_dataAxis, m_paxisinfo->m_strName, strKey, v)) {
+
+			} else if (strKey == "subaxes") {
+				if (v.m_eType != Value_Null) {
+					_EXCEPTION1("JSON axis \"%s\" \"subaxes\" must be type object",
+						m_paxisinfo->m_strName.c_str());
+				}
+				m_fAxisHasSubAxes = true;
+
+			} else if ((strKey == "units") && (v.m_eType == Value_String)) {
+				m_paxisinfo->m_strUnits = *(v.m_pstr);
+
+			} else {
+				InsertAttribute(*m_paxisinfo, "axes", strKey, v);
+			}
+			return true;
+
+		case State_AxisValues:
+		case State_SubAxisValues:
+			if (!v.IsNumber()) {
+				_EXCEPTIONT("JSON subaxis \"values\" must be type array of numbers");
+			}
+			((frame.m_eState == State_AxisValues)?(m_dataAxis):(m_dataSubAxis))
+				.m_dValues.push_back(v.AsDouble());
+			return true;
+
+		case State_SubAxes:
+			_EXCEPTION1("JSON subaxis \"%s\" missing \"datatype\" key",
+				strKey.c_str());
+
+		case State_SubAxis:
+			if (SubAxisScalar(m_dataSubAxis, m_strSubAxisId, strKey, v)) {
+
+			} else if ((strKey == "units") && (v.m_eType == Value_String)) {
+				m_dataSubAxis.m_strUnits = *(v.m_pstr);
+			}
+			return true;
+
+		case State_AxisSummary:
+			SummaryScalar(m_dataAxis, strKey, v);
+			return true;
+
+		case State_SubAxisSummary:
+			SummaryScalar(m_dataSubAxis, strKey, v);
+			return true;
+
+		case State_AxisRange:
+			RangeScalar(m_dataAxis, strKey, v);
+			return true;
+
+		case State_SubAxisRange:
+			RangeScalar(m_dataSubAxis, strKey, v);
+			return true;
+
+		case State_Variables:
+			_EXCEPTION1("JSON variable \"%s\" missing \"datatype\" key",
+				strKey.c_str());
+
+		case State_Variable:
+			if (strKey == "datatype") {
+				if (v.m_eType != Value_String) {
+					_EXCEPTION1("JSON variable \"%s\" \"datatype\" must be type string",
+						m_pvarinfo->m_strName.c_str());
+				}
+				m_pvarinfo->m_nctype = StringToNcType(*(v.m_pstr));
+				m_fVariableHasDatatype = true;
+
+			} else if (AxisGroupScalar(strKey, v)) {
+
+			} else if (strKey == "axisgroups") {
+				if (v.m_eType != Value_Null) {
+					_EXCEPTION1("JSON variable \"%s\" missing \"axisids\" key",
+						m_pvarinfo->m_strName.c_str());
+				}
+				m_fVariableHasAxisGroups = true;
+
+			} else if ((strKey == "units") && (v.m_eType == Value_String)) {
+				m_pvarinfo->m_strUnits = *(v.m_pstr);
+
+			} else {
+				InsertAttribute(*m_pvarinfo, "variables", strKey, v);
+			}
+			return true;
+
+		case State_VariableStorage:
+			StorageScalar(strKey, v);
+			return true;
+
+		case State_VariableStorageChunks:
+			if (!v.IsInteger() || (v.AsLongLong() <= 0)) {
+				_EXCEPTION1("JSON variable \"%s\" \"chunks\" must be type array of integers",
+					m_pvarinfo->m_strName.c_str());
+			}
+			m_pvarinfo->m_storage.m_vecChunkSizes.push_back(
+				static_cast<size_t>(v.AsLongLong()));
+			return true;
+
+		case State_AxisGroups:
+			_EXCEPTION1("JSON variable \"%s\" missing \"axisids\" key",
+				m_pvarinfo->m_strName.c_str());
+
+		case State_AxisGroup:
+			AxisGroupScalar(strKey, v);
+			return true;
+
+		case State_AxisIds:
+			if (v.m_eType != Value_String) {
+				_EXCEPTION1("JSON variable \"%s\" \"axisids\" must be type array of strings",
+					m_pvarinfo->m_strName.c_str());
+			}
+			m_pgroup->m_vecAxisNames.push_back(*(v.m_pstr));
+			return true;
+
+		case State_SubAxisMap:
+			_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" must be type "
+				"array of arrays of strings",
+				m_pvarinfo->m_strName.c_str());
+
+		case State_SubAxisMapEntry:
+			if (v.m_eType != Value_String) {
+				_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" must be type "
+					"array of arrays of strings",
+					m_pvarinfo->m_strName.c_str());
+			}
+			m_vecSubAxisMapEntry.push_back(*(v.m_pstr));
+			return true;
+
+		case State_Shards:
+			_EXCEPTION1("JSON shard \"%s\" must be type array of strings",
+				strKey.c_str());
+
+		case State_Shard:
+			if (v.m_eType != Value_String) {
+				_EXCEPTION1("JSON shard \"%s\" must be type array of strings",
+					m_vecShards.back().first.c_str());
+			}
+			m_vecShards.back().second.push_back(*(v.m_pstr));
+			return true;
+
+		case State_Skip:
+			return true;
+		}
+		return true;
+	}
+
+	///	<summary>
+	///		Check if a key at the root is a section that is read, and
+	///		record that the section is present.
+	///	</summary>
+	bool RootSection(const std::string & strKey) {
+		if (m_fShard) {
+			if (strKey != "variables") {
+				return false;
+			}
+			m_fHasVariables = true;
+
+		} else if (strKey == "dataset") {
+			m_fHasDataset = true;
+		} else if (strKey == "file") {
+			m_fHasFiles = true;
+		} else if (strKey == "axes") {
+			m_fHasAxes = true;
+		} else if (strKey == "variables") {
+			m_fHasVariables = true;
+		} else if (strKey == "shards") {
+			m_fHasShards = true;
+		} else if (strKey != "file_attributes") {
+			return false;
+		}
+		return (m_pfilter == NULL) || m_pfilter->LoadsSection(strKey);
+	}
+
+	///	<summary>
+	///		Handle the start of an object or array.
+	///	</summary>
+	bool OnStart(bool fObject) {
+		Frame & frame = m_vecStack.back();
+		const std::string strKey = frame.m_strKey;
+
+		switch (frame.m_eState) {
+		case State_Document:
+			if (!fObject) {
+				_EXCEPTION1("JSON file \"%s\" must contain an object",
+					m_strFilename.c_str());
+			}
+			m_vecStack.push_back(Frame(State_Root));
+			return true;
+
+		case State_Root:
+			if (!RootSection(strKey)) {
+				m_vecStack.push_back(Frame(State_Skip));
+				return true;
+			}
+			if (!fObject) {
+				_EXCEPTION1("JSON \"%s\" must be of type object", strKey.c_str());
+			}
+			if (strKey == "dataset") {
+				m_vecStack.push_back(Frame(State_Dataset));
+			} else if (strKey == "file") {
+				m_vecStack.push_back(Frame(State_Files));
+			} else if (strKey == "axes") {
+				m_vecStack.push_back(Frame(State_Axes));
+			} else if (strKey == "shards") {
+				m_vecStack.push_back(Frame(State_Shards));
+			} else if (strKey == "file_attributes") {
+				m_vecStack.push_back(Frame(State_FileAttributeBlocks));
+			} else {
+				m_vecStack.push_back(Frame(State_Variables));
+			}
+			return true;
+
+		case State_Dataset:
+			_EXCEPTION1("Invalid JSON attribute value in \"dataset\" with key \"%s\"",
+				strKey.c_str());
+
+		case State_Files:
+			if (!fObject) {
+				_EXCEPTIONT("JSON file entry missing \"name\" key");
+			}
+			if ((m_pfilter != NULL) && !m_pfilter->LoadsFile(strKey)) {
+				m_vecStack.push_back(Frame(State_Skip));
+				return true;
+			}
+			m_pfileinfo = new FileInfo("");
+			m_dataset.m_vecFileInfo.insert(strKey, m_pfileinfo);
+			m_fHasFileName = false;
+			m_strFileAttributeBlock = "";
+			m_vecStack.push_back(Frame(State_File));
+			return true;
+
+		case State_FileAttributeBlocks:
+			if (!fObject) {
+				_EXCEPTION1("JSON file attribute block \"%s\" must be of type object",
+					strKey.c_str());
+			}
+			m_pattrblockinfo = &(m_mapFileAttributeBlocks[strKey]);
+			m_vecStack.push_back(Frame(State_FileAttributeBlock));
+			return true;
+
+		case State_FileAttributeBlock:
+			_EXCEPTION1("Invalid JSON attribute value in \"file_attributes\" with key \"%s\"",
+				strKey.c_str());
+
+		case State_File:
+			if (strKey == "stamp") {
+				if (!fObject) {
+					_EXCEPTIONT("\"stamp\" must be of type object");
+				}
+				m_nStampMembers = 0;
+				m_vecStack.push_back(Frame(State_FileStamp));
+
+			} else if (strKey == "statistics") {
+				if (!fObject) {
+					_EXCEPTIONT("\"statistics\" must be of type object");
+				}
+				m_vecStack.push_back(Frame(State_FileStatistics));
+
+			} else if (strKey == "axes") {
+				if (fObject) {
+					_EXCEPTIONT("\"axes\" must be of type array");
+				}
+				m_vecStack.push_back(Frame(State_FileAxes));
+
+			} else if (strKey == "name") {
+				_EXCEPTIONT("JSON file entry \"name\" must be of type string");
+
+			} else {
+				_EXCEPTION1("Invalid JSON attribute value in \"file\" with key \"%s\"",
+					strKey.c_str());
+			}
+			return true;
+
+		case State_FileStamp:
+			if ((strKey == "size") || (strKey == "mtime") || (strKey == "inode")) {
+				_EXCEPTIONT("\"stamp\" must contain \"size\", "
+					"\"mtime\" and \"inode\"");
+			}
+			m_vecStack.push_back(Frame(State_Skip));
+			return true;
+
+		case State_FileStatistics:
+			if (!fObject) {
+				_EXCEPTION1("JSON file statistics of \"%s\" must be of type object",
+					strKey.c_str());
+			}
+			if ((m_pfilter != NULL) && !m_pfilter->LoadsVariable(strKey)) {
+				m_vecStack.push_back(Frame(State_Skip));
+				return true;
+			}
+			m_strStatisticsVariable = strKey;
+			m_statistics = VariableStatistics();
+			m_dStatisticsMean = 0.0;
+			m_vecStack.push_back(Frame(State_FileVariableStatistics));
+			return true;
+
+		case State_FileVariableStatistics:
+			m_vecStack.push_back(Frame(State_Skip));
+			return true;
+
+		case State_FileAxes:
+			if (fObject) {
+				_EXCEPTIONT("\"axes\" must be an array of arrays");
+			}
+			m_vecAxisPair.clear();
+			m_vecStack.push_back(Frame(State_FileAxisPair));
+			return true;
+
+		case State_FileAxisPair:
+			_EXCEPTIONT("\"axes\" must be an array of arrays of strings");
+
+		case State_Axes:
+			if (!fObject) {
+				_EXCEPTIONT("JSON axis entry missing \"datatype\" key");
+			}
+			if ((m_pfilter != NULL) && !m_pfilter->LoadsAxis(strKey)) {
+				m_vecStack.push_back(Frame(State_Skip));
+				return true;
+			}
+			m_paxisinfo = new AxisInfo(strKey);
+			m_dataset.m_vecAxisInfo.insert(strKey, m_paxisinfo);
+			m_dataAxis.Reset();
+			m_fAxisHasSubAxes = false;
+			m_vecStack.push_back(Frame(State_Axis));
+			return true;
+
+		case State_Axis:
+			if (strKey == "values") {
+				m_dataAxis.m_fHasValues = true;
+				m_dataAxis.m_fValuesArray = !fObject;
+				m_dataAxis.m_dValues.clear();
+				m_vecStack.push_back(Frame((fObject)?(State_Skip):(State_AxisValues)));
+
+			} else if (strKey == "summary") {
+				if (!fObject) {
+					_EXCEPTION1("JSON subaxis \"%s\" \"summary\" must be type object",
+						m_paxisinfo->m_strName.c_str());
+				}
+				m_dataAxis.m_fHasSummary = true;
+				m_vecStack.push_back(Frame(State_AxisSummary));
+
+			} else if (strKey == "range") {
+				if (!fObject) {
+					_EXCEPTION1("JSON subaxis \"%s\" \"range\" must be type object",
+						m_paxisinfo->m_strName.c_str());
+				}
+				m_dataAxis.m_fHasRange = true;
+				m_vecStack.push_back(Frame(State_AxisRange));
+
+			} else if (strKey == "subaxes") {
+				if (!fObject) {
+					_EXCEPTION1("JSON axis \"%s\" \"subaxes\" must be type object",
+						m_paxisinfo->m_strName.c_str());
+				}
+				m_fAxisHasSubAxes = true;
+				m_vecStack.push_back(Frame(State_SubAxes));
+
+			} else if (strKey == "datatype") {
+				_EXCEPTION1("JSON axis \"%s\" \"datatype\" must be type string",
+					m_paxisinfo->m_strName.c_str());
+
+			} else if (strKey == "size") {
+				_EXCEPTION1("JSON subaxis \"%s\" \"size\" must be type integer",
+					m_paxisinfo->m_strName.c_str());
+
+			} else {
+				_EXCEPTION1("Invalid JSON attribute value in \"axes\" with key \"%s\"",
+					strKey.c_str());
+			}
+			return true;
+
+		case State_AxisValues:
+		case State_SubAxisValues:
+			_EXCEPTIONT("JSON subaxis \"values\" must be type array of numbers");
+
+		case State_AxisSummary:
+		case State_SubAxisSummary:
+			_EXCEPTIONT("JSON subaxis \"summary\" members must be scalars");
+
+		case State_AxisRange:
+		case State_SubAxisRange:
+			_EXCEPTIONT("JSON subaxis \"range\" members must be scalars");
+
+		case State_SubAxes:
+			if (!fObject) {
+				_EXCEPTION1("JSON subaxis \"%s\" missing \"datatype\" key",
+					strKey.c_str());
+			}
+			if ((m_pfilter != NULL) &&
+			    !m_pfilter->LoadsSubAxis(m_paxisinfo->m_strName, strKey)
+			) {
+				m_vecStack.push_back(Frame(State_Skip));
+				return true;
+			}
+			m_strSubAxisId = strKey;
+			m_dataSubAxis.Reset();
+			m_vecStack.push_back(Frame(State_SubAxis));
+			return true;
+
+		case State_SubAxis:
+			if (strKey == "values") {
+				m_dataSubAxis.m_fHasValues = true;
+				m_dataSubAxis.m_fValuesArray = !fObject;
+				m_dataSubAxis.m_dValues.clear();
+				m_vecStack.push_back(Frame((fObject)?(State_Skip):(State_SubAxisValues)));
+
+			} else if (strKey == "summary") {
+				if (!fObject) {
+					_EXCEPTION1("JSON subaxis \"%s\" \"summary\" must be type object",
+						m_strSubAxisId.c_str());
+				}
+				m_dataSubAxis.m_fHasSummary = true;
+				m_vecStack.push_back(Frame(State_SubAxisSummary));
+
+			} else if (strKey == "range") {
+				if (!fObject) {
+					_EXCEPTION1("JSON subaxis \"%s\" \"range\" must be type object",
+						m_strSubAxisId.c_str());
+				}
+				m_dataSubAxis.m_fHasRange = true;
+				m_vecStack.push_back(Frame(State_SubAxisRange));
+
+			} else if (strKey == "datatype") {
+				_EXCEPTION1("JSON axis \"%s\" \"datatype\" must be type string",
+					m_strSubAxisId.c_str());
+
+			} else if (strKey == "size") {
+				_EXCEPTION1("JSON subaxis \"%s\" \"size\" must be type integer",
+					m_strSubAxisId.c_str());
+
+			} else {
+				m_vecStack.push_back(Frame(State_Skip));
+			}
+			return true;
+
+		case State_Variables:
+			if (!fObject) {
+				_EXCEPTION1("JSON variable \"%s\" missing \"datatype\" key",
+					strKey.c_str());
+			}
+			if ((m_pfilter != NULL) && !m_pfilter->LoadsVariable(strKey)) {
+				m_vecStack.push_back(Frame(State_Skip));
+				return true;
+			}
+			m_pvarinfo = new VariableInfo(strKey);
+			m_dataset.m_vecVariableInfo.insert(strKey, m_pvarinfo);
+			m_fVariableHasDatatype = false;
+			m_fVariableHasAxisGroups = false;
+			m_groupVariable.Reset();
+			m_pgroup = &m_groupVariable;
+			m_vecStack.push_back(Frame(State_Variable));
+			return true;
+
+		case State_Variable:
+			if (AxisGroupStart(State_Variable, fObject, strKey)) {
+
+			} else if (strKey == "storage") {
+				if (!fObject) {
+					_EXCEPTION1("JSON variable \"%s\" \"storage\" must be type object",
+						m_pvarinfo->m_strName.c_str());
+				}
+				m_pvarinfo->m_storage = VariableStorage();
+				m_vecStack.push_back(Frame(State_VariableStorage));
+
+			// Statistics of variables are rebuilt from those of files
+			} else if (strKey == "statistics") {
+				m_vecStack.push_back(Frame(State_Skip));
+
+			} else if (strKey == "axisgroups") {
+				if (!fObject) {
+					_EXCEPTION1("JSON variable \"%s\" missing \"axisids\" key",
+						m_pvarinfo->m_strName.c_str());
+				}
+				m_fVariableHasAxisGroups = true;
+				m_vecStack.push_back(Frame(State_AxisGroups));
+
+			} else if (strKey == "datatype") {
+				_EXCEPTION1("JSON variable \"%s\" \"datatype\" must be type string",
+					m_pvarinfo->m_strName.c_str());
+
+			} else {
+				_EXCEPTION1("Invalid JSON attribute value in \"variables\" with key \"%s\"",
+					strKey.c_str());
+			}
+			return true;
+
+		case State_VariableStorage:
+			if (strKey == "chunks") {
+				if (fObject) {
+					_EXCEPTION1("JSON variable \"%s\" \"chunks\" must be type array of integers",
+						m_pvarinfo->m_strName.c_str());
+				}
+				m_pvarinfo->m_storage.m_vecChunkSizes.clear();
+				m_vecStack.push_back(Frame(State_VariableStorageChunks));
+			} else {
+				m_vecStack.push_back(Frame(State_Skip));
+			}
+			return true;
+
+		case State_VariableStorageChunks:
+			_EXCEPTION1("JSON variable \"%s\" \"chunks\" must be type array of integers",
+				m_pvarinfo->m_strName.c_str());
+
+		case State_AxisGroups:
+			if (!fObject) {
+				_EXCEPTION1("JSON variable \"%s\" missing \"axisids\" key",
+					m_pvarinfo->m_strName.c_str());
+			}
+			m_groupAxisGroup.Reset();
+			m_pgroup = &m_groupAxisGroup;
+			m_vecStack.push_back(Frame(State_AxisGroup));
+			return true;
+
+		case State_AxisGroup:
+			if (!AxisGroupStart(State_AxisGroup, fObject, strKey)) {
+				m_vecStack.push_back(Frame(State_Skip));
+			}
+			return true;
+
+		case State_AxisIds:
+			_EXCEPTION1("JSON variable \"%s\" \"axisids\" must be type array of strings",
+				m_pvarinfo->m_strName.c_str());
+
+		case State_SubAxisMap:
+			if (fObject) {
+				_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" must be type "
+					"array of arrays of strings",
+					m_pvarinfo->m_strName.c_str());
+			}
+			m_vecSubAxisMapEntry.clear();
+			m_vecStack.push_back(Frame(State_SubAxisMapEntry));
+			return true;
+
+		case State_SubAxisMapEntry:
+			_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" must be type "
+				"array of arrays of strings",
+				m_pvarinfo->m_strName.c_str());
+
+		case State_Shards:
+			if (fObject) {
+				_EXCEPTION1("JSON shard \"%s\" must be type array of strings",
+					strKey.c_str());
+			}
+			m_vecShards.push_back(
+				std::pair<std::string, std::vector<std::string> >(
+					strKey, std::vector<std::string>()));
+			m_vecStack.push_back(Frame(State_Shard));
+			return true;
+
+		case State_Shard:
+			_EXCEPTION1("JSON shard \"%s\" must be type array of strings",
+				m_vecShards.back().first.c_str());
+
+		case State_Skip:
+			m_vecStack.push_back(Frame(State_Skip));
+			return true;
+		}
+		return true;
+	}
+
+	///	<summary>
+	///		Handle the end of an object or array.
+	///	</summary>
+	bool OnEnd() {
+		State eState = m_vecStack.back().m_eState;
+		m_vecStack.pop_back();
+
+		switch (eState) {
+		case State_Root:
+			if (m_fShard) {
+				if (!m_fHasVariables) {
+					_EXCEPTION1("JSON shard \"%s\" missing \"variables\" key",
+						m_strFilename.c_str());
+				}
+				break;
+			}
+			if (!m_fHasDataset) {
+				_EXCEPTIONT("JSON file missing \"dataset\" key");
+			}
+			if (!m_fHasFiles) {
+				_EXCEPTIONT("JSON file missing \"file\" key");
+			}
+			if (!m_fHasAxes) {
+				_EXCEPTIONT("JSON file missing \"axes\" key");
+			}
+			if (!m_fHasVariables && !m_fHasShards) {
+				_EXCEPTIONT("JSON file missing \"variables\" key");
+			}
+			ResolveFileAttributeBlocks();
+			break;
+
+		case State_File:
+			if (!m_fHasFileName) {
+				_EXCEPTIONT("JSON file entry missing \"name\" key");
+			}
+			if (m_strFileAttributeBlock == "") {
+				m_dataset.m_fileattrblocks.Share(*m_pfileinfo);
+			} else {
+				m_vecFileAttributeBlockRefs.push_back(
+					std::pair<FileInfo *, std::string>(
+						m_pfileinfo, m_strFileAttributeBlock));
+			}
+			m_pfileinfo = NULL;
+			break;
+
+		case State_FileAttributeBlock:
+			m_pattrblockinfo = NULL;
+			break;
+
+		case State_FileStamp:
+			if (m_nStampMembers != 7) {
+				_EXCEPTIONT("\"stamp\" must contain \"size\", "
+					"\"mtime\" and \"inode\"");
+			}
+			break;
+
+		case State_FileVariableStatistics:
+			m_statistics.SetMean(m_dStatisticsMean);
+			m_pfileinfo->m_mapVariableStatistics[m_strStatisticsVariable] =
+				m_statistics;
+			break;
+
+		case State_VariableStorage:
+			if (!m_pvarinfo->m_storage.IsKnown()) {
+				_EXCEPTION1("JSON variable \"%s\" \"storage\" missing \"layout\" key",
+					m_pvarinfo->m_strName.c_str());
+			}
+			break;
+
+		case State_FileAxisPair:
+			if (m_vecAxisPair.size() != 2) {
+				_EXCEPTIONT("\"axes\" must be an array of arrays of size 2");
+			}
+			if ((m_pfilter != NULL) &&
+			    !m_pfilter->LoadsSubAxis(m_vecAxisPair[0], m_vecAxisPair[1])
+			) {
+				break;
+			}
+			m_pfileinfo->m_mapAxisSubAxis.insert(
+				AxisSubAxisMap::value_type(
+					m_vecAxisPair[0], m_vecAxisPair[1]));
+			break;
+
+		case State_Axis:
+		{
+			const std::string & strAxisName = m_paxisinfo->m_strName;
+			if (!m_dataAxis.m_fHasDatatype) {
+				_EXCEPTIONT("JSON axis entry missing \"datatype\" key");
+			}
+			m_paxisinfo->m_nctype = StringToNcType(m_dataAxis.m_strDatatype);
+
+			if (m_fAxisHasSubAxes) {
+				if (m_dataAxis.m_fHasValues) {
+					_EXCEPTION1("axis \"%s\" specifies both \"values\" and \"subaxes\"",
+						strAxisName.c_str());
+				}
+				if (m_dataAxis.m_fHasSize) {
+					_EXCEPTION1("axis \"%s\" specifies both \"size\" and \"subaxes\"",
+						strAxisName.c_str());
+				}
+			}
+
+			// Values of a single subaxis given with the axis
+			if (m_dataAxis.m_fHasSize) {
+				m_paxisinfo->m_vecSubAxis.insert(
+					"0", BuildSubAxis(m_dataAxis, strAxisName));
+			}
+
+			// Subaxes are in the units of the axis unless specified
+			for (size_t s = 0; s < m_paxisinfo->m_vecSubAxis.size(); s++) {
+				SubAxis * psubaxis = m_paxisinfo->m_vecSubAxis[s];
+				if (psubaxis->m_strUnits == "") {
+					psubaxis->m_strUnits = m_paxisinfo->m_strUnits;
+				}
+			}
+			if ((m_pdedupstate == NULL) ||
+			    !m_pdedupstate->InstallSubAxisIndex(*m_paxisinfo)
+			) {
+				m_paxisinfo->RebuildSubAxisIndex();
+			}
+			m_paxisinfo = NULL;
+			break;
+		}
+
+		case State_SubAxis:
+			m_paxisinfo->m_vecSubAxis.insert(
+				m_strSubAxisId, BuildSubAxis(m_dataSubAxis, m_strSubAxisId));
+			break;
+
+		case State_Variable:
+			if (!m_fVariableHasDatatype) {
+				_EXCEPTION1("JSON variable \"%s\" missing \"datatype\" key",
+					m_pvarinfo->m_strName.c_str());
+			}
+			if (!m_fVariableHasAxisGroups) {
+				InsertAxisGroup(m_groupVariable);
+
+			} else if (m_groupVariable.m_fHasAxisIds) {
+				_EXCEPTION1("variable \"%s\" specifies both \"axisgroups\" "
+					"and \"axisids\"",
+					m_pvarinfo->m_strName.c_str());
+
+			} else if (m_groupVariable.m_fHasSubAxisMap) {
+				_EXCEPTION1("variable \"%s\" specifies both \"axisgroups\" "
+					"and \"subaxismap\"",
+					m_pvarinfo->m_strName.c_str());
+			}
+			m_pvarinfo = NULL;
+			m_pgroup = NULL;
+			break;
+
+		case State_AxisGroup:
+			InsertAxisGroup(m_groupAxisGroup);
+			m_pgroup = &m_groupVariable;
+			break;
+
+		case State_SubAxisMapEntry:
+		{
+			if (m_vecSubAxisMapEntry.size() == 0) {
+				_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" must be type "
+					"array of arrays of strings",
+					m_pvarinfo->m_strName.c_str());
+			}
+			SubAxisToFileIdMap & mapSubAxisToFileId = m_pgroup->m_mapSubAxisToFileId;
+			if ((mapSubAxisToFileId.size() != 0) &&
+			    (mapSubAxisToFileId.width() != m_vecSubAxisMapEntry.size() - 1)
+			) {
+				_EXCEPTION1("JSON variable \"%s\" \"subaxismap\" entries "
+					"have different lengths",
+					m_pvarinfo->m_strName.c_str());
+			}
+			SubAxisIdVector vecSubAxisId(m_vecSubAxisMapEntry.size() - 1);
+			IndexId idFile = 0;
+			for (size_t d = 0; d < m_vecSubAxisMapEntry.size(); d++) {
+				IndexId & id =
+					(d < vecSubAxisId.size())?(vecSubAxisId[d]):(idFile);
+				if (!IndexIdFromString(m_vecSubAxisMapEntry[d], id)) {
+					_EXCEPTION2("JSON variable \"%s\" \"subaxismap\" contains "
+						"invalid id \"%s\"",
+						m_pvarinfo->m_strName.c_str(),
+						m_vecSubAxisMapEntry[d].c_str());
+				}
+			}
+			mapSubAxisToFileId.insert(vecSubAxisId, idFile);
+			break;
+		}
+
+		default:
+			break;
+		}
+		return true;
+	}
+
+protected:
+	///	<summary>
+	///		IndexedDataset being populated.
+	///	</summary>
+	IndexedDataset & m_dataset;
+
+	///	<summary>
+	///		Name of the file being read, for error messages.
+	///	</summary>
+	std::string m_strFilename;
+
+	///	<summary>
+	///		Stack of open objects and arrays.
+	///	</summary>
+	std::vector<Frame> m_vecStack;
+
+	///	<summary>
+	///		Flag indicating the document is a shard.
+	///	</summary>
+	bool m_fShard;
+
+	///	<summary>
+	///		Selection of the parts of the index read, or NULL to read all.
+	///	</summary>
+	const IndexLoadFilter * m_pfilter;
+
+	///	<summary>
+	///		Saved deduplication state whose subaxis fingerprint indexes
+	///		replace rebuilding them, or NULL.
+	///	</summary>
+	IndexDedupState * m_pdedupstate;
+
+	///	<summary>
+	///		Flags indicating which sections are present.
+	///	</summary>
+	bool m_fHasDataset;
+	bool m_fHasFiles;
+	bool m_fHasAxes;
+	bool m_fHasVariables;
+	bool m_fHasShards;
+
+	///	<summary>
+	///		Shards listed in the "shards" section.
+	///	</summary>
+	std::vector< std::pair<std::string, std::vector<std::string> > > m_vecShards;
+
+	///	<summary>
+	///		Current file entry.
+	///	</summary>
+	FileInfo * m_pfileinfo;
+	bool m_fHasFileName;
+	int m_nStampMembers;
+	std::vector<std::string> m_vecAxisPair;
+	std::string m_strFileAttributeBlock;
+
+	///	<summary>
+	///		Blocks of the "file_attributes" section, the current block
+	///		entry, and the file entries that reference a block.
+	///	</summary>
+	std::map<std::string, DataObjectInfo> m_mapFileAttributeBlocks;
+	DataObjectInfo * m_pattrblockinfo;
+	std::vector< std::pair<FileInfo *, std::string> > m_vecFileAttributeBlockRefs;
+
+	///	<summary>
+	///		Statistics of a variable of the current file entry.
+	///	</summary>
+	std::string m_strStatisticsVariable;
+	VariableStatistics m_statistics;
+	double m_dStatisticsMean;
+
+	///	<summary>
+	///		Current axis and subaxis entries.
+	///	</summary>
+	AxisInfo * m_paxisinfo;
+	SubAxisData m_dataAxis;
+	bool m_fAxisHasSubAxes;
+	std::string m_strSubAxisId;
+	SubAxisData m_dataSubAxis;
+
+	///	<summary>
+	///		Current variable and axis group entries.
+	///	</summary>
+	VariableInfo * m_pvarinfo;
+	bool m_fVariableHasDatatype;
+	bool m_fVariableHasAxisGroups;
+	AxisGroupData m_groupVariable;
+	AxisGroupData m_groupAxisGroup;
+	AxisGroupData * m_pgroup;
+	std::vector<InternedString> m_vecSubAxisMapEntry;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check that a DataObjectInfo from another index agrees with the
+///		one here, warning of attributes that differ.
+///	</summary>
+static std::string CheckMergedObjectInfo(
+	const DataObjectInfo & doi,
+	const DataObjectInfo & doiMerged,
+	const char * szKind
+) {
+	if (doi.m_nctype != doiMerged.m_nctype) {
+		return std::string("ERROR: ") + szKind + std::string(" \"")
+			+ doi.m_strName + std::string("\" has inconsistent type across"
+			" indexes");
+	}
+	if (doi.m_strUnits != doiMerged.m_strUnits) {
+		return std::string("ERROR: ") + szKind + std::string(" \"")
+			+ doi.m_strName + std::string("\" has inconsistent units across"
+			" indexes");
+	}
+
+	const AttributeMap * pmapAttributes[2] =
+		{ &(doiMerged.m_mapKeyAttributes), &(doiMerged.m_mapOtherAttributes) };
+	for (int m = 0; m < 2; m++) {
+		AttributeMap::const_iterator iterattr = pmapAttributes[m]->begin();
+		for (; iterattr != pmapAttributes[m]->end(); iterattr++) {
+			AttributeMap::const_iterator iterAttKey =
+				doi.m_mapKeyAttributes.find(iterattr->first);
+			AttributeMap::const_iterator iterAttOther =
+				doi.m_mapOtherAttributes.find(iterattr->first);
+			if ((iterAttKey == doi.m_mapKeyAttributes.end()) &&
+			    (iterAttOther == doi.m_mapOtherAttributes.end())
+			) {
+				AnnounceWarning("%s \"%s\" has inconsistent appearance of"
+					" attribute \"%s\" across indexes",
+					szKind, doi.m_strName.c_str(), iterattr->first.c_str());
+			} else if (
+			    ((iterAttKey != doi.m_mapKeyAttributes.end()) &&
+			     (iterAttKey->second != iterattr->second)) ||
+			    ((iterAttOther != doi.m_mapOtherAttributes.end()) &&
+			     (iterAttOther->second != iterattr->second))
+			) {
+				AnnounceWarning("%s \"%s\" has inconsistent value of"
+					" attribute \"%s\" across indexes",
+					szKind, doi.m_strName.c_str(), iterattr->first.c_str());
+			}
 		}
-		vecSize[d] = 1;
 	}
-	for (size_t d = 0; d < m_vecGridDimNames.size(); d++) {
-		AxisInfoMap::const_iterator iter =
-			m_mapAxisInfo.find(m_vecGridDimNames[d]);
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::Merge(
+	const IndexedDataset & dataset
+) {
+	if (&dataset == this) {
+		_EXCEPTIONT("Cannot merge an IndexedDataset into itself");
+	}
+	if (dataset.m_vecFileInfo.size() == 0) {
+		return std::string("");
+	}
 
-		if (iter == m_mapAxisInfo.end()) {
-			_EXCEPTIONT("Dimension not found in map");
+	// Global attributes come from the first file
+	if (m_vecFileInfo.size() == 0) {
+		m_datainfo.m_mapKeyAttributes.insert(
+			dataset.m_datainfo.m_mapKeyAttributes.begin(),
+			dataset.m_datainfo.m_mapKeyAttributes.end());
+		m_datainfo.m_mapOtherAttributes.insert(
+			dataset.m_datainfo.m_mapOtherAttributes.begin(),
+			dataset.m_datainfo.m_mapOtherAttributes.end());
+	}
+
+	// Add axes and subaxes, mapping the subaxis ids of each axis
+	std::map<std::string, std::map<std::string, std::string> > mapSubAxisIds;
+	LookupVectorHeap<std::string, AxisInfo>::const_iterator iteraxisMerged =
+		dataset.m_vecAxisInfo.begin();
+	for (; iteraxisMerged != dataset.m_vecAxisInfo.end(); iteraxisMerged++) {
+		const AxisInfo & axisinfoMerged = *(*iteraxisMerged);
+		const std::string & strAxisName = axisinfoMerged.m_strName;
+
+		if (m_vecVariableInfo.find(strAxisName) != m_vecVariableInfo.end()) {
+			return std::string("ERROR: Axis \"") + strAxisName
+				+ std::string("\" is a variable in the index it is merged into");
 		}
 
-		vecPos.push_back(0);
-		vecSize.push_back(iter->second.m_lSize);
-		lTotalSize *= iter->second.m_lSize;
+		AxisInfo * paxisinfo;
+		LookupVectorHeap<std::string, AxisInfo>::iterator iteraxis =
+			m_vecAxisInfo.find(strAxisName);
+		if (iteraxis == m_vecAxisInfo.end()) {
+			paxisinfo = new AxisInfo(strAxisName);
+			static_cast<DataObjectInfo &>(*paxisinfo) = axisinfoMerged;
+			paxisinfo->m_eType = axisinfoMerged.m_eType;
+			m_vecAxisInfo.insert(strAxisName, paxisinfo);
+
+		} else {
+			paxisinfo = *iteraxis;
+			std::string strError =
+				CheckMergedObjectInfo(*paxisinfo, axisinfoMerged, "Axis");
+			if (strError != "") {
+				return strError;
+			}
+		}
+		AxisInfo & axisinfo = *paxisinfo;
+
+		// Subaxes in id order, so that new ids follow the same order
+		std::vector<std::string> vecSubAxisIds;
+		AxisInfo::SubAxisVector::const_iterator itersubaxis =
+			axisinfoMerged.m_vecSubAxis.begin();
+		for (; itersubaxis != axisinfoMerged.m_vecSubAxis.end(); itersubaxis++) {
+			vecSubAxisIds.push_back(itersubaxis.key());
+		}
+		SortIds(vecSubAxisIds);
+
+		std::map<std::string, std::string> & mapAxisSubAxisIds =
+			mapSubAxisIds[strAxisName];
+		for (size_t s = 0; s < vecSubAxisIds.size(); s++) {
+			const SubAxis & subaxis =
+				*(*(axisinfoMerged.m_vecSubAxis.find(vecSubAxisIds[s])));
+
+			std::string strSubAxisId = axisinfo.FindSubAxis(subaxis);
+			if (strSubAxisId == "") {
+				strSubAxisId =
+					std::to_string((long long)axisinfo.m_vecSubAxis.size());
+				axisinfo.InsertSubAxis(strSubAxisId, new SubAxis(subaxis));
+			}
+			mapAxisSubAxisIds[vecSubAxisIds[s]] = strSubAxisId;
+		}
 	}
-	//for (size_t d = 0; d < m_vecGridDimNames.size(); d++) {
-	//	printf("DIM %s %i/%i\n", varinfo.m_vecDimNames[d].c_str(), vecPos[d], vecSize[d]);
-	//}
 
-	if (data.GetRows() != lTotalSize) {
-		_EXCEPTION2("Data size mismatch (%i/%lu)", data.GetRows(), lTotalSize);
+	// Add files in id order, mapping their ids
+	std::map<std::string, IndexId> mapExistingFileIds;
+	{
+		LookupVectorHeap<std::string, FileInfo>::iterator iterfile =
+			m_vecFileInfo.begin();
+		for (; iterfile != m_vecFileInfo.end(); iterfile++) {
+			IndexId idFile;
+			if (IndexIdFromString(iterfile.key(), idFile)) {
+				mapExistingFileIds[(*iterfile)->m_strFilename] = idFile;
+			}
+		}
 	}
 
-	// Write data
-	std::string strFullFilename = m_strBaseDir + m_vecFilenames[sFile];
-	NcFile ncout(strFullFilename.c_str(), NcFile::Write);
-	if (!ncout.is_valid()) {
-		_EXCEPTION1("Unable to open output file \"%s\"", strFullFilename.c_str());
+	std::vector<std::string> vecFileIds;
+	{
+		LookupVectorHeap<std::string, FileInfo>::const_iterator iterfile =
+			dataset.m_vecFileInfo.begin();
+		for (; iterfile != dataset.m_vecFileInfo.end(); iterfile++) {
+			vecFileIds.push_back(iterfile.key());
+		}
 	}
+	SortIds(vecFileIds);
 
-	// Get dimensions
-	std::vector<NcDim *> vecDims;
-	vecDims.resize(varinfo.m_vecDimNames.size());
-	for (int d = 0; d < vecDims.size(); d++) {
-		long lDimSize = GetDimensionSize(varinfo.m_vecDimNames[d]);
-		vecDims[d] = ncout.get_dim(varinfo.m_vecDimNames[d].c_str());
-		if (vecDims[d] != NULL) {
-			if (d != varinfo.m_iTimeDimIx) {
-				if (vecDims[d]->size() != lDimSize) {
-					_EXCEPTION3("Dimension %s mismatch (%lu / %li)",
-						varinfo.m_vecDimNames[d].c_str(),
-						vecDims[d]->size(), lDimSize);
-				}
+	std::unordered_map<IndexId, IndexId> mapFileIds;
+	for (size_t f = 0; f < vecFileIds.size(); f++) {
+		const FileInfo & fileinfoMerged =
+			*(*(dataset.m_vecFileInfo.find(vecFileIds[f])));
+
+		IndexId idMergedFile;
+		if (!IndexIdFromString(vecFileIds[f], idMergedFile)) {
+			return std::string("ERROR: File id \"") + vecFileIds[f]
+				+ std::string("\" is not an integer");
+		}
+
+		// Files in both indexes keep their entry here
+		std::map<std::string, IndexId>::const_iterator iterExisting =
+			mapExistingFileIds.find(fileinfoMerged.m_strFilename);
+		if (iterExisting != mapExistingFileIds.end()) {
+			const FileStamp & stamp =
+				(*(m_vecFileInfo.find(IndexIdToString(iterExisting->second))))->m_stamp;
+			if (!(stamp == fileinfoMerged.m_stamp)) {
+				AnnounceWarning("File \"%s\" differs between merged indexes;"
+					" keeping the first", fileinfoMerged.m_strFilename.c_str());
+			}
+			mapFileIds[idMergedFile] = iterExisting->second;
+			continue;
+		}
+
+		size_t sFileIndex = m_vecFileInfo.size();
+		if (sFileIndex > static_cast<size_t>(UINT32_MAX)) {
+			return std::string("ERROR: Too many files in index");
+		}
+		const IndexId idFile = static_cast<IndexId>(sFileIndex);
+		FileInfo * pfileinfo = new FileInfo(fileinfoMerged.m_strFilename);
+		m_vecFileInfo.insert(IndexIdToString(idFile), pfileinfo);
+		mapExistingFileIds[fileinfoMerged.m_strFilename] = idFile;
+		mapFileIds[idMergedFile] = idFile;
+
+		// Attributes of the file, restoring those it shared with the
+		// other index before removing those it shares with this one
+		pfileinfo->m_stamp = fileinfoMerged.m_stamp;
+		pfileinfo->m_mapVariableStatistics = fileinfoMerged.m_mapVariableStatistics;
+		fileinfoMerged.GetAttributes(
+			pfileinfo->m_mapKeyAttributes,
+			pfileinfo->m_mapOtherAttributes);
+		pfileinfo->m_mapOtherAttributes.insert(
+			dataset.m_datainfo.m_mapOtherAttributes.begin(),
+			dataset.m_datainfo.m_mapOtherAttributes.end());
+		pfileinfo->RemoveRedundantOtherAttributes(m_datainfo);
+		m_fileattrblocks.Share(*pfileinfo);
+
+		AxisSubAxisMap::const_iterator iterAxisSubAxis =
+			fileinfoMerged.m_mapAxisSubAxis.begin();
+		for (; iterAxisSubAxis != fileinfoMerged.m_mapAxisSubAxis.end(); iterAxisSubAxis++) {
+			std::map<std::string, std::map<std::string, std::string> >::const_iterator
+				iterAxis = mapSubAxisIds.find(iterAxisSubAxis->first);
+			if (iterAxis == mapSubAxisIds.end()) {
+				return std::string("ERROR: File \"") + fileinfoMerged.m_strFilename
+					+ std::string("\" refers to unknown axis \"")
+					+ iterAxisSubAxis->first + std::string("\"");
 			}
+			std::map<std::string, std::string>::const_iterator iterSubAxis =
+				iterAxis->second.find(iterAxisSubAxis->second);
+			if (iterSubAxis == iterAxis->second.end()) {
+				return std::string("ERROR: File \"") + fileinfoMerged.m_strFilename
+					+ std::string("\" refers to unknown subaxis \"")
+					+ iterAxisSubAxis->second + std::string("\" of axis \"")
+					+ iterAxisSubAxis->first + std::string("\"");
+			}
+			pfileinfo->m_mapAxisSubAxis.insert(
+				AxisSubAxisPair(iterAxisSubAxis->first, iterSubAxis->second));
+		}
+	}
+
+	// Add the subaxis maps of variables
+	LookupVectorHeap<std::string, VariableInfo>::const_iterator itervarMerged =
+		dataset.m_vecVariableInfo.begin();
+	for (; itervarMerged != dataset.m_vecVariableInfo.end(); itervarMerged++) {
+		const VariableInfo & varinfoMerged = *(*itervarMerged);
+		const std::string & strVariableName = varinfoMerged.m_strName;
+
+		// Don't index dimension variables
+		if (m_vecAxisInfo.find(strVariableName) != m_vecAxisInfo.end()) {
+			continue;
+		}
+
+		VariableInfo * pvarinfo;
+		LookupVectorHeap<std::string, VariableInfo>::iterator itervar =
+			m_vecVariableInfo.find(strVariableName);
+		if (itervar == m_vecVariableInfo.end()) {
+			pvarinfo = new VariableInfo(strVariableName);
+			static_cast<DataObjectInfo &>(*pvarinfo) = varinfoMerged;
+			pvarinfo->m_storage = varinfoMerged.m_storage;
+			pvarinfo->m_fStorageVaries = varinfoMerged.m_fStorageVaries;
+			m_vecVariableInfo.insert(strVariableName, pvarinfo);
 
 		} else {
+			pvarinfo = *itervar;
+			std::string strError =
+				CheckMergedObjectInfo(*pvarinfo, varinfoMerged, "Variable");
+			if (strError != "") {
+				return strError;
+			}
+			pvarinfo->MergeStorage(varinfoMerged.m_storage);
+			pvarinfo->m_fStorageVaries |= varinfoMerged.m_fStorageVaries;
+		}
+
+		AxisNamesToSubAxisToFileIdMapMap::const_iterator iterAxisGroup =
+			varinfoMerged.m_mapSubAxisToFileIdMaps.begin();
+		for (; iterAxisGroup != varinfoMerged.m_mapSubAxisToFileIdMaps.end(); iterAxisGroup++) {
+			const AxisNameVector & vecAxisNames = iterAxisGroup->first;
+			const SubAxisToFileIdMap & mapSubAxisToFileIdMerged = iterAxisGroup->second;
+			const size_t sWidth = vecAxisNames.size();
+
+			// Map of the subaxis ids of each axis of the group
+			std::vector< std::unordered_map<IndexId, IndexId> > vecIdMaps(sWidth);
+			for (size_t d = 0; d < sWidth; d++) {
+				std::map<std::string, std::map<std::string, std::string> >::const_iterator
+					iterAxis = mapSubAxisIds.find(vecAxisNames[d]);
+				if (iterAxis == mapSubAxisIds.end()) {
+					return std::string("ERROR: Variable \"") + strVariableName
+						+ std::string("\" refers to unknown axis \"")
+						+ vecAxisNames[d] + std::string("\"");
+				}
+				std::map<std::string, std::string>::const_iterator iterSubAxis =
+					iterAxis->second.begin();
+				for (; iterSubAxis != iterAxis->second.end(); iterSubAxis++) {
+					IndexId idFrom;
+					IndexId idTo;
+					if (IndexIdFromString(iterSubAxis->first, idFrom) &&
+					    IndexIdFromString(iterSubAxis->second, idTo)
+					) {
+						vecIdMaps[d][idFrom] = idTo;
+					}
+				}
+			}
+
+			std::vector<IndexId> vecEntries;
+			vecEntries.reserve(mapSubAxisToFileIdMerged.size() * (sWidth + 1));
+			for (size_t i = 0; i < mapSubAxisToFileIdMerged.size(); i++) {
+				const IndexId * pSubAxisIds = mapSubAxisToFileIdMerged.subaxisids(i);
+				for (size_t d = 0; d < sWidth; d++) {
+					std::unordered_map<IndexId, IndexId>::const_iterator iterId =
+						vecIdMaps[d].find(pSubAxisIds[d]);
+					if (iterId == vecIdMaps[d].end()) {
+						return std::string("ERROR: Variable \"") + strVariableName
+							+ std::string("\" refers to unknown subaxis \"")
+							+ IndexIdToString(pSubAxisIds[d])
+							+ std::string("\" of axis \"")
+							+ vecAxisNames[d] + std::string("\"");
+					}
+					vecEntries.push_back(iterId->second);
+				}
+				std::unordered_map<IndexId, IndexId>::const_iterator iterFileId =
+					mapFileIds.find(mapSubAxisToFileIdMerged.fileid(i));
+				if (iterFileId == mapFileIds.end()) {
+					return std::string("ERROR: Variable \"") + strVariableName
+						+ std::string("\" refers to unknown file \"")
+						+ IndexIdToString(mapSubAxisToFileIdMerged.fileid(i))
+						+ std::string("\"");
+				}
+				vecEntries.push_back(iterFileId->second);
+			}
+
+			pvarinfo->m_mapSubAxisToFileIdMaps[vecAxisNames].insert(
+				sWidth, vecEntries);
+		}
+	}
+
+	// Files kept from this index replace those of the merged index, so
+	// statistics of variables are recomputed rather than added
+	RebuildVariableStatistics();
+
+	m_fHasQueryIndex = false;
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void IndexedDataset::RunTasks(
+	size_t sTasks,
+	const std::function<void(size_t)> & fnTask
+) const {
+	RunTasksOnThreads(m_sThreads, sTasks, fnTask);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::MergeFromFiles(
+	const std::vector<std::string> & vecFilenames
+) {
+	if (vecFilenames.size() == 0) {
+		return std::string("");
+	}
+
+	// Load each index
+	std::vector< std::unique_ptr<IndexedDataset> > vecDatasets(vecFilenames.size());
+	std::vector<std::string> vecErrors(vecFilenames.size());
+	std::vector<std::exception_ptr> vecExceptions(vecFilenames.size());
+
+	auto EndsWith = [](const std::string & str, const char * szSuffix) {
+		const size_t sLength = strlen(szSuffix);
+		return (str.length() >= sLength)
+			&& (str.compare(str.length() - sLength, sLength, szSuffix) == 0);
+	};
+
+	Announce("Loading %lu indexes", vecFilenames.size());
+	RunTasks(vecFilenames.size(), [&](size_t i) {
+		try {
+			vecDatasets[i].reset(new IndexedDataset(""));
+			vecDatasets[i]->SetGridRegistry(m_pgridregistry);
+			vecDatasets[i]->SetLoadedVariables(m_setLoadedVariables);
+			if (EndsWith(vecFilenames[i], ".cbor")) {
+				vecErrors[i] = vecDatasets[i]->FromBinaryFile(
+					vecFilenames[i], BinaryIndexFormat_CBOR);
+			} else if (EndsWith(vecFilenames[i], ".msgpack")) {
+				vecErrors[i] = vecDatasets[i]->FromBinaryFile(
+					vecFilenames[i], BinaryIndexFormat_MessagePack);
+			} else {
+				vecErrors[i] = vecDatasets[i]->FromJSONFile(vecFilenames[i]);
+			}
+		} catch(...) {
+			vecExceptions[i] = std::current_exception();
+		}
+	});
+
+	// Merge adjacent pairs until one index remains
+	for (size_t sStride = 1; sStride < vecFilenames.size(); sStride *= 2) {
+		for (size_t i = 0; i < vecFilenames.size(); i++) {
+			if (vecExceptions[i]) {
+				std::rethrow_exception(vecExceptions[i]);
+			}
+			if (vecErrors[i] != "") {
+				return vecErrors[i];
+			}
+		}
+
+		const size_t sPairs =
+			(vecFilenames.size() + 2 * sStride - 1) / (2 * sStride);
+		Announce("Merging %lu pairs of indexes", sPairs);
+		RunTasks(sPairs, [&](size_t p) {
+			const size_t i = p * 2 * sStride;
+			const size_t j = i + sStride;
+			if (j >= vecFilenames.size()) {
+				return;
+			}
+			try {
+				vecErrors[i] = vecDatasets[i]->Merge(*(vecDatasets[j]));
+				vecDatasets[j].reset();
+			} catch(...) {
+				vecExceptions[i] = std::current_exception();
+			}
+		});
+	}
+	if (vecExceptions[0]) {
+		std::rethrow_exception(vecExceptions[0]);
+	}
+	if (vecErrors[0] != "") {
+		return vecErrors[0];
+	}
+
+	return Merge(*(vecDatasets[0]));
+}
+
+///////////////////////////////////////////////////////////////////////////////
 
-			// Create a new dimension in output file
-			vecDims[d] =
-				ncout.add_dim(
-					varinfo.m_vecDimNames[d].c_str(),
-					lDimSize);
+bool IndexedDataset::LoadDedupState(
+	const std::string & strIndexFilename,
+	IndexDedupState & state
+) {
+	if (!state.FromFile(IndexDedupState::GetPath(strIndexFilename), strIndexFilename)) {
+		return false;
+	}
+
+	InternedString::ReservePool(state.m_sInternedStrings);
+
+	// Hashes only identify files already checked at the same level
+	if (state.m_eValidationLevel == m_eValidationLevel) {
+		m_setValidatedHashes.insert(
+			state.m_vecValidatedHashes.begin(),
+			state.m_vecValidatedHashes.end());
+	}
+
+	Announce(1, "Loaded deduplication state of \"%s\"", strIndexFilename.c_str());
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::ToDedupStateFile(
+	const std::string & strIndexFilename
+) const {
+#if defined(HYPERION_MPIOMP)
+	// Only output on root thread
+	int nRank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	if (nRank != 0) {
+		return std::string("");
+	}
+#endif
+
+	IndexDedupState state;
+	if (!state.m_stampIndex.FromFile(strIndexFilename)) {
+		return std::string("ERROR: Unable to stat index file \"")
+			+ strIndexFilename + std::string("\"");
+	}
+
+	state.m_sInternedStrings = InternedString::PoolSize();
+
+	state.m_eValidationLevel = m_eValidationLevel;
+	state.m_vecValidatedHashes.assign(
+		m_setValidatedHashes.begin(), m_setValidatedHashes.end());
+	std::sort(state.m_vecValidatedHashes.begin(), state.m_vecValidatedHashes.end());
+
+	LookupVectorHeap<std::string, AxisInfo>::const_iterator iteraxis =
+		m_vecAxisInfo.begin();
+	for (; iteraxis != m_vecAxisInfo.end(); iteraxis++) {
+		state.m_mapSubAxisFingerprints[iteraxis.key()] =
+			(*iteraxis)->m_mapSubAxisFingerprints;
+	}
+
+	return state.ToFile(IndexDedupState::GetPath(strIndexFilename));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::FromJSONFile(
+	const std::string & strJSONInputFilename
+) {
+	IndexLoadFilter filter(m_setLoadedVariables);
+	const IndexLoadFilter * pfilter =
+		(m_setLoadedVariables.size() != 0)?(&filter):(NULL);
+
+	IndexDedupState dedupstate;
+	IndexDedupState * pdedupstate =
+		(LoadDedupState(strJSONInputFilename, dedupstate))?(&dedupstate):(NULL);
+
+	for (int iPass = 0; iPass < ((pfilter != NULL)?(2):(1)); iPass++) {
+
+		// Compressed indexes are detected from their contents
+		CompressedInputStream ifJSON(strJSONInputFilename);
+		if (!ifJSON.is_open()) {
+			_EXCEPTION1("Error opening file \"%s\" for reading",
+				strJSONInputFilename.c_str());
+		}
+
+		IndexedDatasetJSONReader reader(
+			*this, strJSONInputFilename, false, pfilter, pdedupstate);
+		nlohmann::json::sax_parse(ifJSON, &reader);
+
+		// Variables of a sharded index
+		if (reader.GetShards().size() != 0) {
+			std::string strError =
+				LoadJSONShards(strJSONInputFilename, reader.GetShards(), pfilter);
+			if (strError != "") {
+				return strError;
+			}
+		}
+
+		// Only read what the selected variables reference in the next pass
+		if ((pfilter != NULL) && (iPass == 0)) {
+			std::string strError =
+				filter.BeginReferencesPass(m_vecVariableInfo, strJSONInputFilename);
+			if (strError != "") {
+				return strError;
+			}
+		}
+	}
+
+	RebuildVariableStatistics();
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::LoadJSONShards(
+	const std::string & strJSONManifestFilename,
+	const std::vector< std::pair<std::string, std::vector<std::string> > > & vecShards,
+	const IndexLoadFilter * pfilter
+) {
+	// Shards are named relative to the directory of the manifest
+	std::string strDir;
+	size_t sSlash = strJSONManifestFilename.rfind('/');
+	if (sSlash != std::string::npos) {
+		strDir = strJSONManifestFilename.substr(0, sSlash + 1);
+	}
+
+	// Each shard is read into its own IndexedDataset
+	std::vector< std::unique_ptr<IndexedDataset> > vecDatasets(vecShards.size());
+	std::vector<std::exception_ptr> vecExceptions(vecShards.size());
+
+	// Variables of each shard that are loaded
+	std::vector< std::vector<std::string> > vecShardVariables(vecShards.size());
+	for (size_t i = 0; i < vecShards.size(); i++) {
+		for (size_t v = 0; v < vecShards[i].second.size(); v++) {
+			if ((pfilter == NULL) || pfilter->LoadsVariable(vecShards[i].second[v])) {
+				vecShardVariables[i].push_back(vecShards[i].second[v]);
+			}
+		}
+	}
+
+	RunTasks(vecShards.size(), [&](size_t i) {
+		if (vecShardVariables[i].size() == 0) {
+			return;
+		}
+		try {
+			std::string strShardFilename = vecShards[i].first;
+			if ((strShardFilename == "") || (strShardFilename[0] != '/')) {
+				strShardFilename = strDir + strShardFilename;
+			}
+			CompressedInputStream ifShard(strShardFilename);
+			if (!ifShard.is_open()) {
+				_EXCEPTION1("Error opening file \"%s\" for reading",
+					strShardFilename.c_str());
+			}
+			vecDatasets[i].reset(new IndexedDataset(""));
+			vecDatasets[i]->SetGridRegistry(m_pgridregistry);
+			IndexedDatasetJSONReader reader(
+				*(vecDatasets[i]), strShardFilename, true, pfilter);
+			nlohmann::json::sax_parse(ifShard, &reader);
+
+		} catch(...) {
+			vecExceptions[i] = std::current_exception();
+		}
+	});
+
+	// Move the variables into this index in shard order
+	for (size_t i = 0; i < vecShards.size(); i++) {
+		if (vecExceptions[i]) {
+			std::rethrow_exception(vecExceptions[i]);
+		}
+		if (vecShardVariables[i].size() == 0) {
+			continue;
+		}
+
+		const std::vector<std::string> & vecVariables = vecShardVariables[i];
+		LookupVectorHeap<std::string, VariableInfo> & vecShardVariableInfo =
+			vecDatasets[i]->m_vecVariableInfo;
+
+		std::string strError;
+		if (vecShardVariableInfo.size() != vecVariables.size()) {
+			strError = "Shard \"" + vecShards[i].first
+				+ "\" does not hold the variables listed in the manifest";
+		}
+		for (size_t v = 0; (strError == "") && (v < vecVariables.size()); v++) {
+			if (vecShardVariableInfo.find(vecVariables[v]) == vecShardVariableInfo.end()) {
+				strError = "Shard \"" + vecShards[i].first
+					+ "\" missing variable \"" + vecVariables[v] + "\"";
+			} else if (m_vecVariableInfo.find(vecVariables[v]) != m_vecVariableInfo.end()) {
+				strError = "Variable \"" + vecVariables[v]
+					+ "\" appears in more than one shard";
+			}
+		}
+		if (strError != "") {
+			return strError;
+		}
+
+		for (size_t v = 0; v < vecShardVariableInfo.size(); v++) {
+			VariableInfo * pvarinfo = vecShardVariableInfo[v];
+			m_vecVariableInfo.insert(pvarinfo->m_strName, pvarinfo);
+		}
+		vecShardVariableInfo.release();
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::FromBinaryFile(
+	const std::string & strInputFilename,
+	BinaryIndexFormat eFormat
+) {
+	IndexLoadFilter filter(m_setLoadedVariables);
+	const IndexLoadFilter * pfilter =
+		(m_setLoadedVariables.size() != 0)?(&filter):(NULL);
+
+	IndexDedupState dedupstate;
+	IndexDedupState * pdedupstate =
+		(LoadDedupState(strInputFilename, dedupstate))?(&dedupstate):(NULL);
+
+	for (int iPass = 0; iPass < ((pfilter != NULL)?(2):(1)); iPass++) {
+		std::ifstream ifBinary(strInputFilename.c_str(), std::ios::binary);
+		if (!ifBinary.is_open()) {
+			_EXCEPTION1("Error opening file \"%s\" for reading",
+				strInputFilename.c_str());
+		}
 
-			if (vecDims[d] == NULL) {
-				_EXCEPTION1("Cannot add dimension %s",
-					varinfo.m_vecDimNames[d].c_str());
+		IndexedDatasetJSONReader reader(
+			*this, strInputFilename, false, pfilter, pdedupstate);
+		BinaryIndexReader<IndexedDatasetJSONReader>
+			binreader(ifBinary, eFormat, strInputFilename);
+		binreader.Parse(reader);
+
+		// Only read what the selected variables reference in the next pass
+		if ((pfilter != NULL) && (iPass == 0)) {
+			std::string strError =
+				filter.BeginReferencesPass(m_vecVariableInfo, strInputFilename);
+			if (strError != "") {
+				return strError;
 			}
+		}
+	}
+
+	RebuildVariableStatistics();
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write the key of the next member of a JSON object being streamed
+///		at the given depth, in the same format as nlohmann::json::dump.
+///	</summary>
+static void JSONStreamKey(
+	std::ostream & os,
+	const std::string & strKey,
+	bool fPrettyPrint,
+	int nDepth,
+	bool & fFirstMember
+) {
+	if (!fFirstMember) {
+		os << ",";
+	}
+	fFirstMember = false;
+
+	if (fPrettyPrint) {
+		os << "\n" << std::string(4 * nDepth, ' ');
+		os << nlohmann::json(strKey).dump() << ": ";
+	} else {
+		os << nlohmann::json(strKey).dump() << ":";
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write a JSON value nested at the given depth of a JSON document
+///		being streamed.
+///	</summary>
+static void JSONStreamValue(
+	std::ostream & os,
+	const nlohmann::json & j,
+	bool fPrettyPrint,
+	int nDepth
+) {
+	if (!fPrettyPrint) {
+		os << j.dump();
+		return;
+	}
+
+	// Serialized strings never contain raw newlines, so every newline
+	// starts a new line of the pretty-printed value
+	std::string strValue = j.dump(4);
+	std::string strIndent = std::string("\n") + std::string(4 * nDepth, ' ');
+	size_t sPos = 0;
+	for (;;) {
+		size_t sNewline = strValue.find('\n', sPos);
+		if (sNewline == std::string::npos) {
+			os.write(strValue.data() + sPos, strValue.length() - sPos);
+			break;
+		}
+		os.write(strValue.data() + sPos, sNewline - sPos);
+		os << strIndent;
+		sPos = sNewline + 1;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Close a JSON object being streamed at the given depth.
+///	</summary>
+static void JSONStreamEndObject(
+	std::ostream & os,
+	bool fPrettyPrint,
+	int nDepth
+) {
+	if (fPrettyPrint) {
+		os << "\n" << std::string(4 * nDepth, ' ');
+	}
+	os << "}";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Add the attributes of an AttributeMap to a JSON object, replacing
+///		those already present.
+///	</summary>
+static void AttributeMapToJSON(
+	const AttributeMap & mapAttributes,
+	nlohmann::json & j
+) {
+	AttributeMap::const_iterator iterAtt = mapAttributes.begin();
+	for (; iterAtt != mapAttributes.end(); iterAtt++) {
+		j[iterAtt->first.c_str()] = iterAtt->second.c_str();
+	}
+}
 
-			AxisInfoMap::const_iterator iterDimInfo =
-				m_mapAxisInfo.find(varinfo.m_vecDimNames[d]);
+///	<summary>
+///		Add the key and other attributes of a DataObjectInfo to the JSON
+///		object describing it.
+///	</summary>
+static void DataObjectAttributesToJSON(
+	const DataObjectInfo & info,
+	nlohmann::json & j
+) {
+	AttributeMapToJSON(info.m_mapKeyAttributes, j);
+	AttributeMapToJSON(info.m_mapOtherAttributes, j);
+}
 
-			// Create a dimension variable in output file
-			if (iterDimInfo->second.m_dValuesDouble.size() != 0) {
-				NcVar * varDim =
-					ncout.add_var(
-						varinfo.m_vecDimNames[d].c_str(),
-						ncDouble,
-						vecDims[d]);
-				if (varDim == NULL) {
-					_EXCEPTION1("Cannot add variable %s",
-						varinfo.m_vecDimNames[d].c_str());
-				}
-				varDim->set_cur((long)0);
-				varDim->put(
-					&(iterDimInfo->second.m_dValuesDouble[0]),
-					iterDimInfo->second.m_dValuesDouble.size());
+///////////////////////////////////////////////////////////////////////////////
 
-				if (iterDimInfo->second.m_strUnits != "") {
-					varDim->add_att("units",
-						iterDimInfo->second.m_strUnits.c_str());
-				}
-			}
+///	<summary>
+///		Ids of the FileAttributeBlock written in the "file_attributes"
+///		section of an index.
+///	</summary>
+typedef std::unordered_map<const FileAttributeBlock *, std::string>
+	FileAttributeBlockIdMap;
+
+///	<summary>
+///		Assign ids to the FileAttributeBlock shared by more than one of
+///		the files, in order of the first file holding each.  A block held
+///		by a single file is written with that file.
+///	</summary>
+static void AssignFileAttributeBlockIds(
+	const LookupVectorHeap<std::string, FileInfo> & vecFileInfo,
+	FileAttributeBlockIdMap & mapBlockIds,
+	std::vector<const FileAttributeBlock *> & vecBlocks
+) {
+	std::unordered_map<const FileAttributeBlock *, size_t> mapFileCounts;
+	std::vector<const FileAttributeBlock *> vecOrder;
+	for (size_t f = 0; f < vecFileInfo.size(); f++) {
+		const FileAttributeBlock * pblock = vecFileInfo[f]->m_pattrblock.get();
+		if (pblock == NULL) {
+			continue;
+		}
+		if ((mapFileCounts[pblock]++) == 0) {
+			vecOrder.push_back(pblock);
 		}
 	}
 
-	// Create variable
-	NcVar * var = ncout.get_var(strVariableName.c_str());
-	if (var == NULL) {
-		var = ncout.add_var(
-			strVariableName.c_str(),
-			ncFloat,
-			vecDims.size(),
-			(const NcDim **)(&(vecDims[0])));
-
-		if (var == NULL) {
-			_EXCEPTION1("Unable to create variable \"%s\"",
-				strVariableName.c_str());
+	mapBlockIds.clear();
+	vecBlocks.clear();
+	for (size_t b = 0; b < vecOrder.size(); b++) {
+		if (mapFileCounts[vecOrder[b]] > 1) {
+			mapBlockIds[vecOrder[b]] = std::to_string((long long)vecBlocks.size());
+			vecBlocks.push_back(vecOrder[b]);
 		}
-
-		var->add_att("units", varinfo.m_strUnits.c_str());
 	}
+}
 
-	// Set current position
-	var->set_cur(&(vecPos[0]));
-
-	// Write data
-	var->put(&(data[0]), &(vecSize[0]));
-*/
-	return std::string("");
+///	<summary>
+///		Build the JSON object describing an entry of the
+///		"file_attributes" section.
+///	</summary>
+static void FileAttributeBlockToJSON(
+	const FileAttributeBlock & block,
+	nlohmann::json & jfa
+) {
+	AttributeMapToJSON(block.m_mapKeyAttributes, jfa);
+	AttributeMapToJSON(block.m_mapOtherAttributes, jfa);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-std::string IndexedDataset::IndexVariableData(
-	const std::string & strBaseDir,
-	const std::vector<std::string> & vecFilenames
+///	<summary>
+///		Build the JSON object describing an entry of the "axes" section.
+///		If fIncludeValues is false the "values" of each subaxis are left
+///		out.  Subaxes found in pgridregistry reference it instead.
+///	</summary>
+static void AxisInfoToJSON(
+	const AxisInfo & axisinfo,
+	nlohmann::json & jaa,
+	bool fIncludeValues,
+	const GridRegistry * pgridregistry
 ) {
-	std::string strError;
+	jaa["units"] = axisinfo.m_strUnits.c_str();
+	jaa["datatype"] =  NcTypeToString(axisinfo.m_nctype).c_str();
 
-	// Check if we're appending to an already populated IndexedDataset
-	bool fAppendIndex =
-		(m_vecVariableInfo.size() != 0) ||
-		(m_vecAxisInfo.size() != 0) ||
-		(m_vecFileInfo.size() != 0);
+	DataObjectAttributesToJSON(axisinfo, jaa);
 
-	// Open all files
-	for (size_t f = 0; f < vecFilenames.size(); f++) {
+	// Add all subaxes
+	AxisInfo::SubAxisVector::const_iterator itersubaxis = axisinfo.m_vecSubAxis.begin();
+	for (; itersubaxis != axisinfo.m_vecSubAxis.end(); itersubaxis++) {
+		const SubAxis * psubaxisinfo = *itersubaxis;
 
-		// Open the NetCDF file
-		std::string strFullFilename = strBaseDir + vecFilenames[f];
-		NcFile ncFile(strFullFilename.c_str(), NcFile::ReadOnly);
-		if (!ncFile.is_valid()) {
-			return std::string("Unable to open data file \"")
-				+ strFullFilename + std::string("\" for reading");
+		nlohmann::json * jaas = NULL;
+		if (axisinfo.m_vecSubAxis.size() == 1) {
+			jaas = &jaa;
+		} else {
+			jaas = &(jaa["subaxes"][itersubaxis.key().c_str()]);
 		}
+		psubaxisinfo->ToJSON(*jaas, fIncludeValues, pgridregistry);
 
-		printf("Indexing %s\n", strFullFilename.c_str());
-
-		// Load in global attributes
-		if (m_vecFileInfo.size() == 0) {
-			strError = m_datainfo.FromNcFile(&ncFile);
-			if (strError != "") return strError;
+		// Units are only written for subaxes that differ from the axis
+		if ((psubaxisinfo->m_strUnits != "") &&
+		    (psubaxisinfo->m_strUnits != axisinfo.m_strUnits)
+		) {
+			(*jaas)["units"] = psubaxisinfo->m_strUnits.c_str();
 		}
+	}
+}
 
-		// Add a new FileInfo descriptor
-		size_t sFileIndex = m_vecFileInfo.size();
-		std::string strFileId = std::to_string((long long)sFileIndex);
-		m_vecFileInfo.insert(
-			strFileId,
-			new FileInfo(strFullFilename));
-		FileInfo & fileinfo = *(m_vecFileInfo[sFileIndex]);
-		fileinfo.FromNcFile(&ncFile);
-		fileinfo.RemoveRedundantOtherAttributes(m_datainfo);
-
-		// time indices stored in this file
-		std::vector<size_t> vecFileTimeIndices;
-/*
-		// Find the time variable, if it exists
-		NcVar * varTime = ncFile.get_var(m_strRecordDimName.c_str());
-		if (varTime != NULL) {
-			if (varTime->num_dims() != 1) {
-				return std::string("\"")
-					+ m_strRecordDimName
-					+ std::string("\" variable must contain exactly one dimension in \"")
-					+ vecFilenames[f] + std::string("\"");
-			}
-			if ((varTime->type() != ncInt) && (varTime->type() != ncDouble)) {
-				return std::string("\"")
-					+ m_strRecordDimName
-					+ std::string("\" variable must be ncInt or ncDouble in \"")
-					+ vecFilenames[f] + std::string("\"");
-			}
-
-			Time::CalendarType timecal;
-
-			NcDim * dimTime = varTime->get_dim(0);
-			if (dimTime == NULL) {
-				_EXCEPTION1("Malformed NetCDF file \"%s\"",
-					vecFilenames[f].c_str());
-			}
+///////////////////////////////////////////////////////////////////////////////
 
-			// Get calendar
-			NcAtt * attTimeCalendar = varTime->get_att("calendar");
-			if (attTimeCalendar == NULL) {
-				timecal = Time::CalendarStandard;
-			} else {
-				std::string strTimeCalendar = attTimeCalendar->as_string(0);
-				timecal = Time::CalendarTypeFromString(strTimeCalendar);
-				if (timecal == Time::CalendarUnknown) {
-					return std::string("Unknown calendar \"") + strTimeCalendar
-						+ std::string("\" in \"")
-						+ vecFilenames[f] + std::string("\"");
-				}
-			}
+///	<summary>
+///		Build the JSON object describing an entry of the "file" section.
+///		Attributes of a block in pmapBlockIds are referenced by its id
+///		rather than written with the file.
+///	</summary>
+static void FileInfoToJSON(
+	const FileInfo & fileinfo,
+	nlohmann::json & jfi,
+	const FileAttributeBlockIdMap * pmapBlockIds = NULL
+) {
+	jfi["name"] = fileinfo.m_strFilename.c_str();
 
-			// Get units attribute
-			NcAtt * attTimeUnits = varTime->get_att("units");
-			if (attTimeUnits != NULL) {
-				m_strTimeUnits = attTimeUnits->as_string(0);
-			}
-			if (m_strTimeUnits == "") {
-				return std::string("Unknown units for \"")
-					+ m_strRecordDimName
-					+ std::string("\" in \"")
-					+ vecFilenames[f] + std::string("\"");
-			}
+	if (fileinfo.m_stamp.IsValid()) {
+		nlohmann::json & jfis = jfi["stamp"];
+		jfis["size"] = fileinfo.m_stamp.m_llSize;
+		jfis["mtime"] = fileinfo.m_stamp.m_llModTime;
+		jfis["inode"] = fileinfo.m_stamp.m_ullInode;
+	}
 
-			// Add Times to master array and store corresponding indices
-			// in vecFileTimeIndices.
-			DataArray1D<int> nTimes(dimTime->size());
-			if (varTime->type() == ncInt) {
-				varTime->set_cur((long)0);
-				varTime->get(&(nTimes[0]), dimTime->size());
+	if (fileinfo.m_pattrblock != NULL) {
+		const std::string * pstrBlockId = NULL;
+		if (pmapBlockIds != NULL) {
+			FileAttributeBlockIdMap::const_iterator iterBlockId =
+				pmapBlockIds->find(fileinfo.m_pattrblock.get());
+			if (iterBlockId != pmapBlockIds->end()) {
+				pstrBlockId = &(iterBlockId->second);
 			}
+		}
+		if (pstrBlockId != NULL) {
+			jfi["shared_attributes"] = *pstrBlockId;
+		} else {
+			FileAttributeBlockToJSON(*(fileinfo.m_pattrblock), jfi);
+		}
+	}
+	DataObjectAttributesToJSON(fileinfo, jfi);
+
+	nlohmann::json & jfia = jfi["axes"];
+	AxisSubAxisMap::const_iterator iterAxes =
+		fileinfo.m_mapAxisSubAxis.begin();
+	for (; iterAxes != fileinfo.m_mapAxisSubAxis.end(); iterAxes++) {
+		nlohmann::json jaxis;
+		jaxis.push_back(iterAxes->first.c_str());
+		jaxis.push_back(iterAxes->second.c_str());
+		jfia.push_back(jaxis);
+	}
 
-			DataArray1D<double> dTimes(dimTime->size());
-			if (varTime->type() == ncDouble) {
-				varTime->set_cur((long)0);
-				varTime->get(&(dTimes[0]), dimTime->size());
-			}
+	if (fileinfo.m_mapVariableStatistics.size() != 0) {
+		nlohmann::json & jfist = jfi["statistics"];
+		std::map<std::string, VariableStatistics>::const_iterator iterStats =
+			fileinfo.m_mapVariableStatistics.begin();
+		for (; iterStats != fileinfo.m_mapVariableStatistics.end(); iterStats++) {
+			iterStats->second.ToJSON(jfist[iterStats->first]);
+		}
+	}
+}
 
-			for (int t = 0; t < dimTime->size(); t++) {
-				Time time(timecal);
-				if (m_strTimeUnits != "") {
-					if (varTime->type() == ncInt) {
-						time.FromCFCompliantUnitsOffsetInt(
-							m_strTimeUnits,
-							nTimes[t]);
+///////////////////////////////////////////////////////////////////////////////
 
-					} else if (varTime->type() == ncDouble) {
-						time.FromCFCompliantUnitsOffsetDouble(
-							m_strTimeUnits,
-							dTimes[t]);
-					}
-				}
+///	<summary>
+///		Build the JSON object describing an entry of the "variables"
+///		section.
+///	</summary>
+static void VariableInfoToJSON(
+	const VariableInfo & varinfo,
+	nlohmann::json & jvv
+) {
+	jvv["units"] = varinfo.m_strUnits.c_str();
+	jvv["datatype"] = NcTypeToString(varinfo.m_nctype).c_str();
 
-				std::map<Time, size_t>::const_iterator iterTime =
-					m_mapTimeToIndex.find(time);
+	DataObjectAttributesToJSON(varinfo, jvv);
 
-				if (iterTime == m_mapTimeToIndex.end()) {
-					size_t sNewIndex = m_vecTimes.size();
-					m_vecTimes.push_back(time);
-					vecFileTimeIndices.push_back(sNewIndex);
-					m_mapTimeToIndex.insert(
-						std::pair<Time, size_t>(time, sNewIndex));
-				} else {
-					vecFileTimeIndices.push_back(iterTime->second);
-				}
-			}
+	if (varinfo.m_storage.IsKnown()) {
+		nlohmann::json & jvvs = jvv["storage"];
+		varinfo.m_storage.ToJSON(jvvs);
+		if (varinfo.m_fStorageVaries) {
+			jvvs["varies"] = true;
 		}
+	}
 
-		printf("..File contains %lu times\n", vecFileTimeIndices.size());
-*/
-		// Index all Dimensions
-		printf("..Loading dimensions\n");
-		const int nDims = ncFile.num_dims();
-		for (int d = 0; d < nDims; d++) {
-			NcDim * dim = ncFile.get_dim(d);
-			std::string strAxisName(dim->name());
-
-			// New axis, not yet indexed
-			bool fNewAxis = false;
+	if (!varinfo.m_statistics.IsEmpty()) {
+		varinfo.m_statistics.ToJSON(jvv["statistics"]);
+	}
 
-			LookupVectorHeap<std::string, AxisInfo>::iterator iteraxis =
-				m_vecAxisInfo.find(strAxisName);
+	// Output subaxis lookup table
+	if (varinfo.m_mapSubAxisToFileIdMaps.size() != 0) {
 
-			AxisInfo * paxisinfo;
-			if (iteraxis == m_vecAxisInfo.end()) {
-				paxisinfo = new AxisInfo(strAxisName);
-				m_vecAxisInfo.insert(strAxisName, paxisinfo);
-				fNewAxis = true;
+		int ixAxisGroup = 0;
+		AxisNamesToSubAxisToFileIdMapMap::const_iterator iterAxisGroup =
+			varinfo.m_mapSubAxisToFileIdMaps.begin();
+		for (; iterAxisGroup != varinfo.m_mapSubAxisToFileIdMaps.end(); iterAxisGroup++) {
 
+			nlohmann::json * jvvg = NULL;
+			if (varinfo.m_mapSubAxisToFileIdMaps.size() > 1) {
+				std::string strKey = std::to_string((long long)ixAxisGroup);
+				jvvg = &(jvv["axisgroups"][strKey]);
 			} else {
-				paxisinfo = *iteraxis;
+				jvvg = &jvv;
 			}
-			AxisInfo & axisinfo = *paxisinfo;
-
-			// Dimension size
-			long lSize = dim->size();
-
-			// Create a new SubAxis
-			SubAxis * psubaxis = new SubAxis();
-			if (psubaxis == NULL) {
-				_EXCEPTIONT("Error allocating new SubAxis");
-			}
-			std::string strSubAxisId =
-				std::to_string((long long)axisinfo.m_vecSubAxis.size());
-
-			psubaxis->m_lSize = lSize;
 
-			// Check for variable
-			NcVar * varDim = ncFile.get_var(strAxisName.c_str());
-			if ((varDim == NULL) && (axisinfo.m_nctype != ncNoType)) {
-				return std::string("ERROR: Dimension variable \"")
-					+ strAxisName
-					+ std::string("\" missing from file, but present in other files.");
-			}
-			if (varDim != NULL) {
-				if (varDim->num_dims() != 1) {
-					return std::string("ERROR: Dimension variable \"")
-						+ varDim->name()
-						+ std::string("\" must have exactly 1 dimension");
-				}
-				if (std::string(varDim->get_dim(0)->name()) != strAxisName) {
-					return std::string("ERROR: Dimension variable \"")
-						+ varDim->name()
-						+ std::string("\" does not have dimension \"");
-						+ varDim->name()
-						+ std::string("\"");
-				}
-
-				// Set or verify the axis type
-				if (fNewAxis) {
-					axisinfo.m_nctype = varDim->type();
-
-				} else if (axisinfo.m_nctype != varDim->type()) {
-					return std::string("ERROR: Dimension variable \"")
-						+ varDim->name()
-						+ std::string("\" type mismatch.  Possible"
-						" duplicate dimension name in dataset.");
-				}
-				psubaxis->m_nctype = axisinfo.m_nctype;
-
-				// Check for units attribute
-				axisinfo.FromNcVar(varDim, !fNewAxis);
+			iterAxisGroup->first.ToJSON((*jvvg)["axisids"]);
 
-				// Initialize the DataObjectInfo from the NcVar
-				strError = psubaxis->FromNcVar(varDim, false);
-				if (strError != "") {
-					delete psubaxis;
-					return strError;
-				}
-
-				// Get the values from the dimension
-				double dOrder = 0;
-				bool fMonotonicityError = false;
-
-				if (axisinfo.m_nctype == ncInt) {
-					psubaxis->m_dValuesInt.resize(lSize);
-					varDim->set_cur((long)0);
-					varDim->get(&(psubaxis->m_dValuesInt[0]), lSize);
-
-				} else if (axisinfo.m_nctype == ncDouble) {
-					psubaxis->m_dValuesDouble.resize(lSize);
-					varDim->set_cur((long)0);
-					varDim->get(&(psubaxis->m_dValuesDouble[0]), lSize);
+			iterAxisGroup->second.ToJSON((*jvvg)["subaxismap"]);
+		}
+	}
+}
 
-				} else if (axisinfo.m_nctype == ncFloat) {
-					psubaxis->m_dValuesFloat.resize(lSize);
-					varDim->set_cur((long)0);
-					varDim->get(&(psubaxis->m_dValuesFloat[0]), lSize);
+///////////////////////////////////////////////////////////////////////////////
 
-				} else {
-					_EXCEPTION1("Unsupported dimension nctype \"%s\"",
-						NcTypeToString(axisinfo.m_nctype).c_str());
-				}
-			}
+///	<summary>
+///		Stream the "axes", "dataset" and "file" sections of a JSON index,
+///		followed by the "file_attributes" section if fSharedFileAttributes
+///		is set.  Axes and files are formatted in chunks on up to sThreads
+///		threads; files held in a FileInfoSpill are read and formatted in
+///		order.
+///	</summary>
+static void JSONStreamHeadSections(
+	std::ostream & os,
+	const LookupVectorHeap<std::string, AxisInfo> & vecAxisInfo,
+	const DataObjectInfo & datainfo,
+	const LookupVectorHeap<std::string, FileInfo> & vecFileInfo,
+	const FileInfoSpill * pspill,
+	const GridRegistry * pgridregistry,
+	bool fSharedFileAttributes,
+	bool fPrettyPrint,
+	bool & fFirstSection,
+	size_t sThreads
+) {
+	auto WriteChunks = [&](const std::string & strText) {
+		os.write(strText.c_str(), strText.length());
+	};
 
-			// Check if SubAxis already exists
-			AxisInfo::SubAxisVector::iterator iterSubAxis =
-				axisinfo.m_vecSubAxis.begin();
+	// AxisInfo
+	JSONStreamKey(os, "axes", fPrettyPrint, 1, fFirstSection);
+	if (vecAxisInfo.size() == 0) {
+		os << "null";
 
-			for (; iterSubAxis != axisinfo.m_vecSubAxis.end(); iterSubAxis++) {
-				if ((**iterSubAxis) == (*psubaxis)) {
-					break;
-				}
-			}
-			if (iterSubAxis != axisinfo.m_vecSubAxis.end()) {
-				strSubAxisId = iterSubAxis.key();
-				delete psubaxis;
-			} else {
-				axisinfo.m_vecSubAxis.insert(strSubAxisId, psubaxis);
-			}
+	} else {
+		os << "{";
 
-			// Add axis/subaxis pair to FileInfo
-			fileinfo.m_mapAxisSubAxis.insert(
-				AxisSubAxisPair(strAxisName, strSubAxisId));
+		std::vector<const AxisInfo *> vecAxes;
+		vecAxes.reserve(vecAxisInfo.size());
+		LookupVectorHeap<std::string, AxisInfo>::const_iterator iteraxis = vecAxisInfo.begin();
+		for (; iteraxis != vecAxisInfo.end(); iteraxis++) {
+			vecAxes.push_back(*iteraxis);
 		}
 
-		// Loop over all Variables
-		printf("..Loading variables\n");
-		const int nVariables = ncFile.num_vars();
-		for (int v = 0; v < nVariables; v++) {
-			NcVar * var = ncFile.get_var(v);
-			if (var == NULL) {
-				_EXCEPTION1("Malformed NetCDF file \"%s\"",
-					vecFilenames[f].c_str());
-			}
-
-			std::string strVariableName = var->name();
+		FormatInParallel(sThreads, vecAxes.size(), 1,
+			[&](size_t sBegin, size_t sEnd, std::string & strText) {
+				std::ostringstream ssChunk;
+				bool fFirstAxis = (sBegin == 0);
+				for (size_t a = sBegin; a < sEnd; a++) {
+					nlohmann::json jaa;
+					AxisInfoToJSON(*(vecAxes[a]), jaa, true, pgridregistry);
 
-			// Don't index dimension variables
-			bool fDimensionVar = false;
-			for (int d = 0; d < m_vecAxisInfo.size(); d++) {
-				if (m_vecAxisInfo[d]->m_strName == strVariableName) {
-					fDimensionVar = true;
-					break;
+					JSONStreamKey(ssChunk, vecAxes[a]->m_strName, fPrettyPrint, 2, fFirstAxis);
+					JSONStreamValue(ssChunk, jaa, fPrettyPrint, 2);
 				}
-			}
-			if (fDimensionVar) {
-				continue;
-			}
-
-			//printf("....Variable %i (%s)\n", v, strVariableName.c_str());
-
-			// New variable, not yet indexed
-			bool fNewVariable = false;
-
-			LookupVectorHeap<std::string, VariableInfo>::iterator itervar =
-				m_vecVariableInfo.find(strVariableName);
+				strText += ssChunk.str();
+			}, WriteChunks);
 
-			VariableInfo * pvarinfo;
-			if (itervar == m_vecVariableInfo.end()) {
-				pvarinfo = new VariableInfo(strVariableName);
-				m_vecVariableInfo.insert(strVariableName, pvarinfo);
-				fNewVariable = true;
+		JSONStreamEndObject(os, fPrettyPrint, 1);
+	}
 
-			} else {
-				pvarinfo = *itervar;
-			}
-			VariableInfo & varinfo = *pvarinfo;
+	// Dataset 
+	{
+		nlohmann::json jd;
+		DataObjectAttributesToJSON(datainfo, jd);
 
-			// Initialize the DataObjectInfo from the NcVar
-			strError = varinfo.FromNcVar(var, !fNewVariable);
-			if (strError != "") return strError;
+		JSONStreamKey(os, "dataset", fPrettyPrint, 1, fFirstSection);
+		JSONStreamValue(os, jd, fPrettyPrint, 1);
+	}
 
-			// Build the SubAxisCoordinate
-			AxisNameVector vecAxisNames;
-			SubAxisIdVector vecSubAxisIds;
-			const int nDims = var->num_dims();
-			for (int d = 0; d < nDims; d++) {
-				std::string strAxisName = var->get_dim(d)->name();
-				vecAxisNames.push_back(strAxisName);
-
-				AxisSubAxisMap::const_iterator iterSubAxisId =
-					fileinfo.m_mapAxisSubAxis.find(strAxisName);
-				if (iterSubAxisId == fileinfo.m_mapAxisSubAxis.end()) {
-					_EXCEPTIONT("Logic error");
-				}
-				vecSubAxisIds.push_back(iterSubAxisId->second);
-			}
+	// Blocks of attributes shared by files
+	FileAttributeBlockIdMap mapBlockIds;
+	std::vector<const FileAttributeBlock *> vecBlocks;
+	if (fSharedFileAttributes) {
+		AssignFileAttributeBlockIds(vecFileInfo, mapBlockIds, vecBlocks);
+	}
 
-			// Get subaxis to file id map
-			AxisNamesToSubAxisToFileIdMapMap::iterator iterAxisToFileIdMap =
-				varinfo.m_mapSubAxisToFileIdMaps.find(vecAxisNames);
-			if (iterAxisToFileIdMap == varinfo.m_mapSubAxisToFileIdMaps.end()) {
-				std::pair<AxisNamesToSubAxisToFileIdMapMap::iterator, bool> pri =
-					varinfo.m_mapSubAxisToFileIdMaps.insert(
-						AxisNamesToSubAxisToFileIdMapMap::value_type(
-							vecAxisNames,
-							SubAxisToFileIdMap()));
+	// FileInfo
+	JSONStreamKey(os, "file", fPrettyPrint, 1, fFirstSection);
+	if ((pspill != NULL) && (pspill->size() != 0)) {
+		bool fFirstFile = true;
+		os << "{";
 
-				if (!pri.second) {
-					_EXCEPTIONT("Logic error");
-				}
+		pspill->ForEachInIdOrder(
+			[&](const std::string & strFileId, const FileInfo & fileinfo) {
+				nlohmann::json jfi;
+				FileInfoToJSON(fileinfo, jfi);
 
-				iterAxisToFileIdMap = pri.first;
-			}
-			SubAxisToFileIdMap & mapSubAxisToFileId =
-				iterAxisToFileIdMap->second;
+				JSONStreamKey(os, strFileId, fPrettyPrint, 2, fFirstFile);
+				JSONStreamValue(os, jfi, fPrettyPrint, 2);
+			});
+		JSONStreamEndObject(os, fPrettyPrint, 1);
 
-			// Insert this subaxis into the map
-			std::pair<SubAxisToFileIdMap::iterator, bool> prj =
-				mapSubAxisToFileId.insert(
-					SubAxisToFileIdMap::value_type(
-						vecSubAxisIds,
-						strFileId));
-/*
-			// Load dimension information
-			const int nDims = var->num_dims();
-
-			varinfo.m_vecDimNames.resize(nDims);
-			varinfo.m_vecDimSizes.resize(nDims);
-			for (int d = 0; d < nDims; d++) {
-				varinfo.m_vecDimNames[d] = var->get_dim(d)->name();
-
-				if (varinfo.m_vecDimNames[d] == m_strRecordDimName) {
-					if (varinfo.m_iTimeDimIx == (-1)) {
-						varinfo.m_iTimeDimIx = d;
-					} else if (info.m_iTimeDimIx != d) {
-						return std::string("ERROR: Variable \"") + strVariableName
-							+ std::string("\" has inconsistent \"time\" dimension across files");
-					}
-					varinfo.m_vecDimSizes[d] = (-1);
-				} else {
-					varinfo.m_vecDimSizes[d] = var->get_dim(d)->size();
-				}
+	} else if (vecFileInfo.size() == 0) {
+		os << "null";
 
-				if ((varinfo.m_vecDimNames[d] == "lev") ||
-					(varinfo.m_vecDimNames[d] == "pres") ||
-					(varinfo.m_vecDimNames[d] == "z") ||
-					(varinfo.m_vecDimNames[d] == "plev")
-				) {
-					if (varinfo.m_iVerticalDimIx != (-1)) {
-						if (varinfo.m_iVerticalDimIx != d) {
-							return std::string("ERROR: Possibly multiple vertical dimensions in variable ")
-								+ info.m_strName;
-						}
-					}
-					varinfo.m_iVerticalDimIx = d;
-				}
-			}
-*/
-/*
-			// Determine direction of vertical dimension
-			if (info.m_iVerticalDimIx != (-1)) {
-				AxisInfoMap::iterator iterDimInfo =
-					m_mapAxisInfo.find(info.m_vecDimNames[info.m_iVerticalDimIx]);
+	} else {
+		os << "{";
+
+		std::vector< std::pair<const std::string *, const FileInfo *> > vecFiles;
+		vecFiles.reserve(vecFileInfo.size());
+		LookupVectorHeap<std::string, FileInfo>::const_iterator iterfile = vecFileInfo.begin();
+		for (; iterfile != vecFileInfo.end(); iterfile++) {
+			vecFiles.push_back(
+				std::pair<const std::string *, const FileInfo *>(
+					&(iterfile.key()), *iterfile));
+		}
 
-				if (iterDimInfo != m_mapAxisInfo.end()) {
-					info.m_nVerticalDimOrder = iterDimInfo->second.m_nOrder;
+		FormatInParallel(sThreads, vecFiles.size(), FormatFileChunkItems,
+			[&](size_t sBegin, size_t sEnd, std::string & strText) {
+				std::ostringstream ssChunk;
+				bool fFirstFile = (sBegin == 0);
+				for (size_t f = sBegin; f < sEnd; f++) {
+					nlohmann::json jfi;
+					FileInfoToJSON(*(vecFiles[f].second), jfi, &mapBlockIds);
 
-				} else {
-					_EXCEPTIONT("Logic error");
+					JSONStreamKey(ssChunk, *(vecFiles[f].first), fPrettyPrint, 2, fFirstFile);
+					JSONStreamValue(ssChunk, jfi, fPrettyPrint, 2);
 				}
-			}
-*/
-/*
-			// No time information on this Variable
-			if (info.m_iTimeDimIx == (-1)) {
-				if (info.m_mapTimeFile.size() == 0) {
-					info.m_mapTimeFile.insert(
-						std::pair<size_t, LocalFileTimePair>(
-							InvalidTimeIx,
-							LocalFileTimePair(f, 0)));
+				strText += ssChunk.str();
+			}, WriteChunks);
 
-				} else if (info.m_mapTimeFile.size() == 1) {
-					VariableTimeFileMap::const_iterator iterTimeFile =
-						info.m_mapTimeFile.begin();
-
-					if (iterTimeFile->first != InvalidTimeIx) {
-						return std::string("Variable \"") + strVariableName
-							+ std::string("\" has inconsistent \"time\" dimension across files");
-					}
+		JSONStreamEndObject(os, fPrettyPrint, 1);
+	}
 
-				} else {
-					return std::string("Variable \"") + strVariableName
-						+ std::string("\" has inconsistent \"time\" dimension across files");
-				}
+	// FileAttributeBlock
+	if (fSharedFileAttributes) {
+		JSONStreamKey(os, "file_attributes", fPrettyPrint, 1, fFirstSection);
+		if (vecBlocks.size() == 0) {
+			os << "null";
 
-			// Add file and time indices to VariableInfo
-			} else {
-				for (int t = 0; t < vecFileTimeIndices.size(); t++) {
-					VariableTimeFileMap::const_iterator iterTimeFile =
-						info.m_mapTimeFile.find(vecFileTimeIndices[t]);
-
-					if (iterTimeFile == info.m_mapTimeFile.end()) {
-						info.m_mapTimeFile.insert(
-							std::pair<size_t, LocalFileTimePair>(
-								vecFileTimeIndices[t],
-								LocalFileTimePair(f, t)));
-
-					} else {
-						return std::string("Variable \"") + strVariableName
-							+ std::string("\" has repeated time across files:\n")
-							+ std::string("Time: ") + m_vecTimes[vecFileTimeIndices[t]].ToString() + std::string("\n")
-							+ std::string("File1: ") + m_vecFilenames[iterTimeFile->second.first] + std::string("\n")
-							+ std::string("File2: ") + m_vecFilenames[f];
-					}
-				}
+		} else {
+			bool fFirstBlock = true;
+			os << "{";
+			for (size_t b = 0; b < vecBlocks.size(); b++) {
+				nlohmann::json jfa;
+				FileAttributeBlockToJSON(*(vecBlocks[b]), jfa);
+
+				JSONStreamKey(os, mapBlockIds[vecBlocks[b]], fPrettyPrint, 2, fFirstBlock);
+				JSONStreamValue(os, jfa, fPrettyPrint, 2);
 			}
-*/
+			JSONStreamEndObject(os, fPrettyPrint, 1);
 		}
 	}
-/*
-	// Sort the Time array
-	SortTimeArray();
-
-	for (int v = 0; v < m_vecVariableInfo.size(); v++) {
+}
 
-		VariableInfo & varinfo = *(m_vecVariableInfo[v]);
+///////////////////////////////////////////////////////////////////////////////
 
-		// Update the time dimension size for all variables
-		int iTimeDimIx = varinfo.m_iTimeDimIx;
-		if (iTimeDimIx != (-1)) {
-			if (varinfo.m_vecDimSizes.size() < iTimeDimIx) {
-				_EXCEPTIONT("Logic error");
-			}
-			varinfo.m_vecDimSizes[iTimeDimIx] =
-				varinfo.m_mapTimeFile.size();
-		}
+///	<summary>
+///		Stream the "variables" section of a JSON index holding the given
+///		variables, formatted on up to sThreads threads.
+///	</summary>
+static void JSONStreamVariablesSection(
+	std::ostream & os,
+	const std::vector<const VariableInfo *> & vecVariables,
+	bool fPrettyPrint,
+	bool & fFirstSection,
+	size_t sThreads
+) {
+	JSONStreamKey(os, "variables", fPrettyPrint, 1, fFirstSection);
+	if (vecVariables.size() == 0) {
+		os << "null";
 
-		// Initialize auxiliary dimension information for all variables
-		varinfo.m_vecAuxDimNames.clear();
-		varinfo.m_vecAuxDimSizes.clear();
-		for (size_t d = 0; d < varinfo.m_vecDimSizes.size(); d++) {
-			bool fFound = false;
-			for (int g = 0; g < m_vecGridDimNames.size(); g++) {
-				if (m_vecGridDimNames[g] == varinfo.m_vecDimNames[d]) {
-					fFound = true;
-					break;
+	} else {
+		os << "{";
+
+		FormatInParallel(sThreads, vecVariables.size(), FormatVariableChunkItems,
+			[&](size_t sBegin, size_t sEnd, std::string & strText) {
+				std::ostringstream ssChunk;
+				bool fFirstVariable = (sBegin == 0);
+				for (size_t v = sBegin; v < sEnd; v++) {
+					nlohmann::json jvv;
+					VariableInfoToJSON(*(vecVariables[v]), jvv);
+
+					JSONStreamKey(ssChunk, vecVariables[v]->m_strName, fPrettyPrint, 2, fFirstVariable);
+					JSONStreamValue(ssChunk, jvv, fPrettyPrint, 2);
 				}
-			}
-			if (!fFound) {
-				varinfo.m_vecAuxDimNames.push_back(
-					varinfo.m_vecDimNames[d]);
-				varinfo.m_vecAuxDimSizes.push_back(
-					varinfo.m_vecDimSizes[d]);
-			}
-		}
+				strText += ssChunk.str();
+			},
+			[&](const std::string & strText) {
+				os.write(strText.c_str(), strText.length());
+			});
+
+		JSONStreamEndObject(os, fPrettyPrint, 1);
 	}
-*/
-	return std::string("");
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-std::string IndexedDataset::OutputTimeVariableIndexCSV(
-	const std::string & strCSVOutputFilename
-) {
+std::string IndexedDataset::ToJSONFile(
+	const std::string & strJSONOutputFilename,
+	bool fPrettyPrint
+) const {
 #if defined(HYPERION_MPIOMP)
 	// Only output on root thread
 	int nRank;
@@ -1564,671 +11966,749 @@ std::string IndexedDataset::OutputTimeVariableIndexCSV(
 		return std::string("");
 	}
 #endif
-/*
-	if (m_vecTimes.size() != m_mapTimeToIndex.size()) {
-		_EXCEPTIONT("vecTimes / mapTimeToIndex mismatch");
-	}
-
-	std::vector< std::pair<size_t,int> > iTimeVariableIndex;
-	iTimeVariableIndex.resize(m_vecVariableInfo.size());
-
-	// Open output file
-	std::ofstream ofOutput(strCSVOutputFilename.c_str());
-	if (!ofOutput.is_open()) {
-		return std::string("Unable to open output file \"") + strCSVOutputFilename + "\"";
-	}
-
-	// Output variables across header
-	ofOutput << "time";
-	for (int v = 0; v < m_vecVariableInfo.size(); v++) {
-		ofOutput << "," << m_vecVariableInfo[v]->m_strName;
-	}
-	ofOutput << std::endl;
-
-	// Output variables with no time dimension
-	ofOutput << "NONE";
-	for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
-		//if (m_vecVariableInfo[v]->m_iTimeDimIx == (-1)) {
-		//	ofOutput << ",X";
-		//} else {
-			ofOutput << ",";
-		//}
-	}
-	ofOutput << std::endl;
-
-	// Output variables with time dimension
-	for (size_t t = 0; t < m_vecTimes.size(); t++) {
-		ofOutput << m_vecTimes[t].ToString();
-
-		for (size_t v = 0; v < m_vecVariableInfo.size(); v++) {
-
-			VariableTimeFileMap::const_iterator iterTimeFile =
-				m_vecVariableInfo[v]->m_mapTimeFile.find(t);
-
-			if (iterTimeFile == m_vecVariableInfo[v]->m_mapTimeFile.end()) {
-				ofOutput << ",";
-			} else {
-				ofOutput << "," << iterTimeFile->second.first
-					<< ":" << iterTimeFile->second.second;
-			}
-		}
-		ofOutput << std::endl;
-	}
-
-	// Output file names
-	ofOutput << std::endl << std::endl;
 
-	ofOutput << "file_ix,filename" << std::endl;
-	for (size_t f = 0; f < m_vecFilenames.size(); f++) {
-		ofOutput << f << ",\"" << m_strBaseDir << m_vecFilenames[f] << "\"" << std::endl;
+	// Files named .gz or .zst are compressed as they are written
+	CompressedOutputStream ofJSON(strJSONOutputFilename);
+	if (!ofJSON.is_open()) {
+		_EXCEPTION1("Error opening file \"%s\" for writing",
+			strJSONOutputFilename.c_str());
 	}
-*/
-	return ("");
-}
-
-///////////////////////////////////////////////////////////////////////////////
 
-std::string IndexedDataset::ToXMLFile(
-	const std::string & strXMLOutputFilename
-) const {
-	using namespace tinyxml2;
-	tinyxml2::XMLDocument xmlDoc;
-
-	// Declaration
-	xmlDoc.InsertEndChild(
-		xmlDoc.NewDeclaration(
-			"xml version=\"1.0\" encoding=\"\""));
-
-	// DOCTYPE
-	tinyxml2::XMLUnknown * pdoctype = xmlDoc.NewUnknown("DOCTYPE dataset SYSTEM \"http://www-pcmdi.llnl.gov/software/cdms/cdml.dtd\"");
-	xmlDoc.InsertEndChild(pdoctype);
+	// The document is streamed in chunks of files, axes and variables
+	// formatted on m_sThreads threads rather than built as a single
+	// nlohmann::json.  The output is identical: members appear in sorted
+	// key order and sections with no entries are written as null.
+	bool fFirstSection = true;
+	ofJSON << "{";
 
-	// Dataset 
-	tinyxml2::XMLElement * pdata = xmlDoc.NewElement("dataset");
-	{
-		AttributeMap::const_iterator iterAttKey =
-			m_datainfo.m_mapKeyAttributes.begin();
-		for (; iterAttKey != m_datainfo.m_mapKeyAttributes.end(); iterAttKey++) {
-			pdata->SetAttribute(iterAttKey->first.c_str(), iterAttKey->second.c_str());
-		}
+	JSONStreamHeadSections(
+		ofJSON, m_vecAxisInfo, m_datainfo, m_vecFileInfo, m_pspill,
+		m_pgridregistry, m_fWriteSharedFileAttributes,
+		fPrettyPrint, fFirstSection, m_sThreads);
 
-		AttributeMap::const_iterator iterAttOther =
-			m_datainfo.m_mapOtherAttributes.begin();
-		for (; iterAttOther != m_datainfo.m_mapOtherAttributes.end(); iterAttOther++) {
-			tinyxml2::XMLElement * pattr = xmlDoc.NewElement("attr");
-			pattr->SetAttribute("name", iterAttOther->first.c_str());
-			pattr->SetAttribute("datatype", "String");
-			pattr->SetText(iterAttOther->second.c_str());
-			pdata->InsertEndChild(pattr);
-		}
+	// Variables
+	std::vector<const VariableInfo *> vecVariables;
+	vecVariables.reserve(m_vecVariableInfo.size());
+	LookupVectorHeap<std::string, VariableInfo>::const_iterator itervar = m_vecVariableInfo.begin();
+	for (; itervar != m_vecVariableInfo.end(); itervar++) {
+		vecVariables.push_back(*itervar);
 	}
-	xmlDoc.InsertEndChild(pdata);
+	JSONStreamVariablesSection(ofJSON, vecVariables, fPrettyPrint, fFirstSection, m_sThreads);
 
-	// FileInfo
-	LookupVectorHeap<std::string, FileInfo>::const_iterator iterfile = m_vecFileInfo.begin();
-	for (; iterfile != m_vecFileInfo.end(); iterfile++) {
-		const FileInfo * pfileinfo = *iterfile;
+	JSONStreamEndObject(ofJSON, fPrettyPrint, 0);
 
-		tinyxml2::XMLElement * pfile = xmlDoc.NewElement("file");
-		pfile->SetAttribute("id", iterfile.key().c_str());
-		pfile->SetAttribute("name", pfileinfo->m_strFilename.c_str());
-		pdata->InsertEndChild(pfile);
+	ofJSON.close();
+	if (!ofJSON) {
+		_EXCEPTION1("Error writing to file \"%s\"",
+			strJSONOutputFilename.c_str());
+	}
 
-		AttributeMap::const_iterator iterAttKey =
-			pfileinfo->m_mapKeyAttributes.begin();
-		for (; iterAttKey != pfileinfo->m_mapKeyAttributes.end(); iterAttKey++) {
-			pfile->SetAttribute(iterAttKey->first.c_str(), iterAttKey->second.c_str());
-		}
+	return std::string("");
+}
 
-		AttributeMap::const_iterator iterAttOther =
-			pfileinfo->m_mapOtherAttributes.begin();
-		for (; iterAttOther != pfileinfo->m_mapOtherAttributes.end(); iterAttOther++) {
-			tinyxml2::XMLElement * pattr = xmlDoc.NewElement("attr");
-			pattr->SetAttribute("name", iterAttOther->first.c_str());
-			pattr->SetAttribute("datatype", "String");
-			pattr->SetText(iterAttOther->second.c_str());
-			pfile->InsertEndChild(pattr);
-		}
+///////////////////////////////////////////////////////////////////////////////
 
-		AxisSubAxisMap::const_iterator iterAxes =
-			pfileinfo->m_mapAxisSubAxis.begin();
-		for (; iterAxes != pfileinfo->m_mapAxisSubAxis.end(); iterAxes++) {
-			tinyxml2::XMLElement * paxissubaxis = xmlDoc.NewElement("subaxis");
-			paxissubaxis->SetAttribute("axis", iterAxes->first.c_str());
-			paxissubaxis->SetAttribute("subaxis", iterAxes->second.c_str());
-			pfile->InsertEndChild(paxissubaxis);
-		}
+std::string IndexedDataset::ToShardedJSONFile(
+	const std::string & strJSONOutputFilename,
+	size_t sVariablesPerShard,
+	bool fPrettyPrint,
+	const std::string & strShardBasename
+) const {
+#if defined(HYPERION_MPIOMP)
+	// Only output on root thread
+	int nRank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	if (nRank != 0) {
+		return std::string("");
 	}
+#endif
 
-	// AxisInfo
-	LookupVectorHeap<std::string, AxisInfo>::const_iterator iteraxis = m_vecAxisInfo.begin();
-	for (; iteraxis != m_vecAxisInfo.end(); iteraxis++) {
-		const AxisInfo * paxisinfo = *iteraxis;
-
-		tinyxml2::XMLElement * pdim = xmlDoc.NewElement("axis");
-		pdim->SetAttribute("id", paxisinfo->m_strName.c_str());
-		pdim->SetAttribute("units", paxisinfo->m_strUnits.c_str());
-		pdim->SetAttribute("datatype", NcTypeToString(paxisinfo->m_nctype).c_str());
+	if (sVariablesPerShard == 0) {
+		return std::string("At least one variable per shard is required");
+	}
 
-		AttributeMap::const_iterator iterAttKey =
-			paxisinfo->m_mapKeyAttributes.begin();
-		for (; iterAttKey != paxisinfo->m_mapKeyAttributes.end(); iterAttKey++) {
-			pdim->SetAttribute(iterAttKey->first.c_str(), iterAttKey->second.c_str());
+	// Shards are compressed in the same way as the manifest
+	const CompressionFormat eFormat =
+		CompressionFormatFromFilename(strJSONOutputFilename);
+	const std::string strCompressionExt = CompressionFormatExtension(eFormat);
+
+	// Shard file names, with and without the directory
+	std::string strBasename = strShardBasename;
+	if (strBasename == "") {
+		strBasename = strJSONOutputFilename;
+		strBasename.resize(strBasename.length() - strCompressionExt.length());
+		if ((strBasename.length() > 5) &&
+		    (strBasename.compare(strBasename.length() - 5, 5, ".json") == 0)
+		) {
+			strBasename.resize(strBasename.length() - 5);
 		}
+	}
+	std::string strBasenameDir;
+	std::string strBasenameFile = strBasename;
+	size_t sSlash = strBasename.rfind('/');
+	if (sSlash != std::string::npos) {
+		strBasenameDir = strBasename.substr(0, sSlash + 1);
+		strBasenameFile = strBasename.substr(sSlash + 1);
+	}
 
-		AttributeMap::const_iterator iterAttOther =
-			paxisinfo->m_mapOtherAttributes.begin();
-		for (; iterAttOther != paxisinfo->m_mapOtherAttributes.end(); iterAttOther++) {
-			tinyxml2::XMLElement * pattr = xmlDoc.NewElement("attr");
-			pattr->SetAttribute("name", iterAttOther->first.c_str());
-			pattr->SetAttribute("datatype", "String");
-			pattr->SetText(iterAttOther->second.c_str());
-			pdim->InsertEndChild(pattr);
-		}
+	// Variables in sorted order, split into consecutive groups
+	std::vector<const VariableInfo *> vecVariables;
+	vecVariables.reserve(m_vecVariableInfo.size());
+	LookupVectorHeap<std::string, VariableInfo>::const_iterator itervar = m_vecVariableInfo.begin();
+	for (; itervar != m_vecVariableInfo.end(); itervar++) {
+		vecVariables.push_back(*itervar);
+	}
 
-		// Add all subaxes
-		AxisInfo::SubAxisVector::const_iterator itersubaxis = paxisinfo->m_vecSubAxis.begin();
-		for (; itersubaxis != paxisinfo->m_vecSubAxis.end(); itersubaxis++) {
-			const SubAxis * psubaxisinfo = *itersubaxis;
+	const size_t sShards =
+		(vecVariables.size() + sVariablesPerShard - 1) / sVariablesPerShard;
 
-			tinyxml2::XMLElement * psubaxis;
-			if (paxisinfo->m_vecSubAxis.size() == 1) {
-				psubaxis = pdim;
-			} else {
-				psubaxis = xmlDoc.NewElement("subaxis");
-				psubaxis->SetAttribute("id", itersubaxis.key().c_str());
-				psubaxis->SetAttribute("size", std::to_string((long long)psubaxisinfo->m_lSize).c_str());
-			}
-			if (psubaxisinfo->m_nctype != ncNoType) {
-				psubaxis->SetText(psubaxisinfo->ValuesToString().c_str());
-			}
-			pdim->InsertEndChild(psubaxis);
-		}
+	std::vector<std::string> vecShardFilenames(sShards);
+	for (size_t i = 0; i < sShards; i++) {
+		char szShard[32];
+		snprintf(szShard, sizeof(szShard), ".shard%04lu.json", i);
+		vecShardFilenames[i] = strBasenameFile + szShard + strCompressionExt;
 	}
 
-	// Variables
-	for (int v = 0; v < m_vecVariableInfo.size(); v++) {
-		const VariableInfo * pvarinfo = m_vecVariableInfo[v];
+	// Write the shards
+	std::vector<std::exception_ptr> vecExceptions(sShards);
+	RunTasks(sShards, [&](size_t i) {
+		try {
+			const size_t sBegin = i * sVariablesPerShard;
+			const size_t sEnd =
+				std::min(sBegin + sVariablesPerShard, vecVariables.size());
+			std::vector<const VariableInfo *> vecShardVariables(
+				vecVariables.begin() + sBegin, vecVariables.begin() + sEnd);
+
+			std::string strShardFilename = strBasenameDir + vecShardFilenames[i];
+			CompressedOutputStream ofShard(strShardFilename);
+			if (!ofShard.is_open()) {
+				_EXCEPTION1("Error opening file \"%s\" for writing",
+					strShardFilename.c_str());
+			}
 
-		tinyxml2::XMLElement * pvar = xmlDoc.NewElement("variable");
-		pvar->SetAttribute("id", pvarinfo->m_strName.c_str());
-		pvar->SetAttribute("datatype", NcTypeToString(pvarinfo->m_nctype).c_str());
-		pvar->SetAttribute("units", pvarinfo->m_strUnits.c_str());
+			bool fFirstSection = true;
+			ofShard << "{";
+			// Shards are already written in parallel
+			JSONStreamVariablesSection(ofShard, vecShardVariables, fPrettyPrint, fFirstSection, 1);
+			JSONStreamEndObject(ofShard, fPrettyPrint, 0);
 
-		AttributeMap::const_iterator iterAttKey =
-			pvarinfo->m_mapKeyAttributes.begin();
-		for (; iterAttKey != pvarinfo->m_mapKeyAttributes.end(); iterAttKey++) {
-			pvar->SetAttribute(iterAttKey->first.c_str(), iterAttKey->second.c_str());
-		}
+			ofShard.close();
+			if (!ofShard) {
+				_EXCEPTION1("Error writing to file \"%s\"",
+					strShardFilename.c_str());
+			}
 
-		AttributeMap::const_iterator iterAttOther =
-			pvarinfo->m_mapOtherAttributes.begin();
-		for (; iterAttOther != pvarinfo->m_mapOtherAttributes.end(); iterAttOther++) {
-			tinyxml2::XMLElement * pattr = xmlDoc.NewElement("attr");
-			pattr->SetAttribute("name", iterAttOther->first.c_str());
-			pattr->SetAttribute("datatype", "String");
-			pattr->SetText(iterAttOther->second.c_str());
-			pvar->InsertEndChild(pattr);
+		} catch(...) {
+			vecExceptions[i] = std::current_exception();
 		}
+	});
+	for (size_t i = 0; i < sShards; i++) {
+		if (vecExceptions[i]) {
+			std::rethrow_exception(vecExceptions[i]);
+		}
+	}
 
-		// Output subaxis lookup table
-		if (pvarinfo->m_mapSubAxisToFileIdMaps.size() != 0) {
-			
-			AxisNamesToSubAxisToFileIdMapMap::const_iterator iterAxisGroup =
-				pvarinfo->m_mapSubAxisToFileIdMaps.begin();
-			for (; iterAxisGroup != pvarinfo->m_mapSubAxisToFileIdMaps.end(); iterAxisGroup++) {
-
-				tinyxml2::XMLElement * paxgrp = pvar;
-				if (pvarinfo->m_mapSubAxisToFileIdMaps.size() > 1) {
-					paxgrp = xmlDoc.NewElement("axisgroup");
-				}
+	// Write the manifest once every shard it lists exists
+	CompressedOutputStream ofJSON(strJSONOutputFilename);
+	if (!ofJSON.is_open()) {
+		_EXCEPTION1("Error opening file \"%s\" for writing",
+			strJSONOutputFilename.c_str());
+	}
 
-				tinyxml2::XMLElement * pnames = xmlDoc.NewElement("axisids");
-				pnames->SetText(iterAxisGroup->first.ToString().c_str());
-				paxgrp->InsertEndChild(pnames);
+	bool fFirstSection = true;
+	ofJSON << "{";
 
-				tinyxml2::XMLElement * paxmap = xmlDoc.NewElement("subaxismap");
-				paxmap->SetText(iterAxisGroup->second.ToString().c_str());
+	JSONStreamHeadSections(
+		ofJSON, m_vecAxisInfo, m_datainfo, m_vecFileInfo, m_pspill,
+		m_pgridregistry, m_fWriteSharedFileAttributes,
+		fPrettyPrint, fFirstSection, m_sThreads);
 
-				paxgrp->InsertEndChild(paxmap);
+	JSONStreamKey(ofJSON, "shards", fPrettyPrint, 1, fFirstSection);
+	if (sShards == 0) {
+		ofJSON << "null";
 
-				if (pvarinfo->m_mapSubAxisToFileIdMaps.size() > 1) {
-					pvar->InsertEndChild(paxgrp);
-				}
+	} else {
+		bool fFirstShard = true;
+		ofJSON << "{";
+
+		for (size_t i = 0; i < sShards; i++) {
+			nlohmann::json jsv = nlohmann::json::array();
+			const size_t sEnd =
+				std::min((i + 1) * sVariablesPerShard, vecVariables.size());
+			for (size_t v = i * sVariablesPerShard; v < sEnd; v++) {
+				jsv.push_back(vecVariables[v]->m_strName.c_str());
 			}
-		}
 
-		pdata->InsertEndChild(pvar);
+			JSONStreamKey(ofJSON, vecShardFilenames[i], fPrettyPrint, 2, fFirstShard);
+			JSONStreamValue(ofJSON, jsv, fPrettyPrint, 2);
+		}
+		JSONStreamEndObject(ofJSON, fPrettyPrint, 1);
 	}
 
-	xmlDoc.SaveFile(strXMLOutputFilename.c_str());
+	JSONStreamEndObject(ofJSON, fPrettyPrint, 0);
+
+	ofJSON.close();
+	if (!ofJSON) {
+		_EXCEPTION1("Error writing to file \"%s\"",
+			strJSONOutputFilename.c_str());
+	}
 
 	return std::string("");
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-std::string IndexedDataset::FromJSONFile(
-	const std::string & strJSONInputFilename
+///	<summary>
+///		Check if a SubAxis has "values" in the JSON schema.
+///	</summary>
+static bool SubAxisHasValues(
+	const SubAxis & subaxis
 ) {
-	std::ifstream ifJSON(strJSONInputFilename.c_str());
-	if (!ifJSON.is_open()) {
-		_EXCEPTION1("Error opening file \"%s\" for reading",
-			strJSONInputFilename.c_str());
-	}
+	return (!subaxis.m_fSummarized) && (!subaxis.m_fLinear) &&
+		IsNumericNcType(subaxis.m_nctype);
+}
 
-	nlohmann::json j;
-	ifJSON >> j;
+///////////////////////////////////////////////////////////////////////////////
 
-	// Dataset
-	{
-		auto itd = j.find("dataset");
-		if (itd == j.end()) {
-			_EXCEPTIONT("JSON file missing \"dataset\" key");
-		}
-		nlohmann::json & jd = *itd;
+///	<summary>
+///		Kernel writing values as a typed array.
+///	</summary>
+struct ValuesToBinaryKernel {
+	BinaryIndexWriter & writer;
+	const TypedValueArray & values;
 
-		// Load attributes
-		for (nlohmann::json::iterator itd = jd.begin(); itd != jd.end(); ++itd) {
-			m_datainfo.InsertAttribute(itd.key(), itd.value());
-		}
+	template <typename T>
+	void Apply() {
+		writer.TypedArray(values.Data<T>(), values.size());
 	}
+};
+
+///	<summary>
+///		Write the values of a SubAxis as a typed array.
+///	</summary>
+static void SubAxisValuesToBinary(
+	BinaryIndexWriter & writer,
+	const SubAxis & subaxis
+) {
+	ValuesToBinaryKernel kernel = {writer, subaxis.m_values};
+	if (!DispatchNumericNcType(subaxis.m_nctype, kernel)) {
+		_EXCEPTIONT("Invalid type");
+	}
+}
 
-	// FileInfo
-	{
-		auto it = j.find("file");
-		if (it == j.end()) {
-			_EXCEPTIONT("JSON file missing \"file\" key");
-		}
-		nlohmann::json & jf = *it;
-
-		// Set of files
-		for (nlohmann::json::iterator itf = jf.begin(); itf != jf.end(); ++itf) {
-			nlohmann::json & jff = *itf;
+///////////////////////////////////////////////////////////////////////////////
 
-			// File name
-			auto itfname = jff.find("name");
-			if (itfname == jff.end()) {
-				_EXCEPTIONT("JSON file entry missing \"name\" key");
+///	<summary>
+///		Write the members of a JSON object built without "values",
+///		followed by the values of the given SubAxis as a typed array.
+///		Any "subaxes" member is written with the values of each subaxis.
+///	</summary>
+static void AxisInfoToBinary(
+	BinaryIndexWriter & writer,
+	const AxisInfo & axisinfo,
+	const SubAxis * psubaxis,
+	const nlohmann::json & j
+) {
+	bool fHasValues =
+		(psubaxis != NULL) &&
+		SubAxisHasValues(*psubaxis) &&
+		(j.find("grid") == j.end());
+
+	writer.BeginMap(j.size() + (fHasValues?1:0));
+
+	nlohmann::json::const_iterator iter = j.begin();
+	for (; iter != j.end(); iter++) {
+		writer.String(iter.key());
+
+		if ((psubaxis == NULL) && (iter.key() == "subaxes")) {
+			const nlohmann::json & jaas = iter.value();
+			writer.BeginMap(jaas.size());
+
+			nlohmann::json::const_iterator itersub = jaas.begin();
+			for (; itersub != jaas.end(); itersub++) {
+				AxisInfo::SubAxisVector::const_iterator itersubaxis =
+					axisinfo.m_vecSubAxis.find(itersub.key());
+				if (itersubaxis == axisinfo.m_vecSubAxis.end()) {
+					_EXCEPTION1("Invalid subaxis \"%s\"", itersub.key().c_str());
+				}
+				writer.String(itersub.key());
+				AxisInfoToBinary(writer, axisinfo, *itersubaxis, itersub.value());
 			}
 
-			FileInfo * pfileinfo = new FileInfo(itfname.value());
-			m_vecFileInfo.insert(itf.key(), pfileinfo);
+		} else {
+			writer.Value(iter.value());
+		}
+	}
 
-			nlohmann::json::iterator itff = jff.begin();
-			for (; itff != jff.end(); ++itff) {
-				if (itff.key() == "name") {
-					continue;
-				}
+	if (fHasValues) {
+		writer.String("values");
+		SubAxisValuesToBinary(writer, *psubaxis);
+	}
+}
 
-				// Axes stored in this file
-				if (itff.key() == "axes") {
-					nlohmann::json & jffa = *itff;
-					if (!jffa.is_array()) {
-						_EXCEPTIONT("\"axes\" must be of type array");
-					}
+///////////////////////////////////////////////////////////////////////////////
 
-					for (size_t s = 0; s < jffa.size(); s++) {
-						nlohmann::json & jffaa = jffa[s];
-						if (!jffaa.is_array()) {
-							_EXCEPTIONT("\"axes\" must be an array of arrays");
-						}
-						if (jffaa.size() != 2) {
-							_EXCEPTIONT("\"axes\" must be an array of arrays of size 2");
-						}
+std::string IndexedDataset::ToBinaryFile(
+	const std::string & strOutputFilename,
+	BinaryIndexFormat eFormat
+) const {
+#if defined(HYPERION_MPIOMP)
+	// Only output on root thread
+	int nRank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	if (nRank != 0) {
+		return std::string("");
+	}
+#endif
 
-						pfileinfo->m_mapAxisSubAxis.insert(
-							AxisSubAxisMap::value_type(
-								jffaa[0], jffaa[1]));
-					}
+	std::ofstream ofBinary(strOutputFilename.c_str(), std::ios::binary);
+	if (!ofBinary.is_open()) {
+		_EXCEPTION1("Error opening file \"%s\" for writing",
+			strOutputFilename.c_str());
+	}
 
-					continue;
-				}
+	// The document has the same structure as the one written by
+	// ToJSONFile and is likewise streamed one entry at a time
+	BinaryIndexWriter writer(ofBinary, eFormat);
+	writer.BeginMap((m_fWriteSharedFileAttributes)?(5):(4));
 
-				if (itff.value().is_string()) {
-					pfileinfo->InsertAttribute(
-						itff.key(), itff.value());
+	// AxisInfo
+	writer.String("axes");
+	if (m_vecAxisInfo.size() == 0) {
+		writer.Value(nlohmann::json());
 
-				} else if (itff.value().is_number_integer()) {
-					pfileinfo->InsertAttribute(
-						itff.key(), std::to_string((long long)itff.value()));
+	} else {
+		writer.BeginMap(m_vecAxisInfo.size());
 
-				} else if (itff.value().is_number_float()) {
-					pfileinfo->InsertAttribute(
-						itff.key(), std::to_string((double)itff.value()));
+		LookupVectorHeap<std::string, AxisInfo>::const_iterator iteraxis = m_vecAxisInfo.begin();
+		for (; iteraxis != m_vecAxisInfo.end(); iteraxis++) {
+			const AxisInfo * paxisinfo = *iteraxis;
 
-				} else {
-					_EXCEPTION1("Invalid JSON attribute value in \"file\" with key \"%s\"", itff.key().c_str());
-				}
+			nlohmann::json jaa;
+			AxisInfoToJSON(*paxisinfo, jaa, false, m_pgridregistry);
+
+			const SubAxis * psubaxis = NULL;
+			if (paxisinfo->m_vecSubAxis.size() == 1) {
+				psubaxis = paxisinfo->m_vecSubAxis[0];
 			}
 
+			writer.String(paxisinfo->m_strName);
+			AxisInfoToBinary(writer, *paxisinfo, psubaxis, jaa);
 		}
 	}
 
-	// AxisInfo
+	// Dataset
 	{
-		auto it = j.find("axes");
-		if (it == j.end()) {
-			_EXCEPTIONT("JSON file missing \"axes\" key");
-		}
-		nlohmann::json & ja = *it;
+		nlohmann::json jd;
+		DataObjectAttributesToJSON(m_datainfo, jd);
 
-		// Set of axes
-		for (nlohmann::json::iterator ita = ja.begin(); ita != ja.end(); ++ita) {
-			nlohmann::json & jaa = *ita;
+		writer.String("dataset");
+		writer.Value(jd);
+	}
 
-			AxisInfo * paxisinfo = new AxisInfo(ita.key());
-			m_vecAxisInfo.insert(ita.key(), paxisinfo);
+	// Blocks of attributes shared by files
+	FileAttributeBlockIdMap mapBlockIds;
+	std::vector<const FileAttributeBlock *> vecBlocks;
+	if (m_fWriteSharedFileAttributes) {
+		AssignFileAttributeBlockIds(m_vecFileInfo, mapBlockIds, vecBlocks);
+	}
 
-			// Load datatype
-			auto itaadatatype = jaa.find("datatype");
-			if (itaadatatype == jaa.end()) {
-				_EXCEPTIONT("JSON axis entry missing \"datatype\" key");
-			}
-			if (!itaadatatype.value().is_string()) {
-				_EXCEPTION1("JSON axis \"%s\" \"datatype\" must be type string", ita.key().c_str());
-			}
-			paxisinfo->m_nctype = StringToNcType(itaadatatype.value());
+	// FileInfo
+	writer.String("file");
+	if ((m_pspill != NULL) && (m_pspill->size() != 0)) {
+		writer.BeginMap(m_pspill->size());
 
-			auto itaavalues = jaa.find("values");
-			auto itaasize = jaa.find("size");
-			auto itaasubaxes = jaa.find("subaxes");
-			if (itaasubaxes != jaa.end()) {
-				if (itaavalues != jaa.end()) {
-					_EXCEPTION1("axis \"%s\" specifies both \"values\" and \"subaxes\"",
-						ita.key().c_str());
-				}
-				if (itaasize != jaa.end()) {
-					_EXCEPTION1("axis \"%s\" specifies both \"size\" and \"subaxes\"",
-						ita.key().c_str());
-				}
-			}
+		m_pspill->ForEachInIdOrder(
+			[&](const std::string & strFileId, const FileInfo & fileinfo) {
+				nlohmann::json jfi;
+				FileInfoToJSON(fileinfo, jfi);
 
-			// Load values
-			if (itaasize != jaa.end()) {
-				SubAxis * psubaxis = new SubAxis();
-				paxisinfo->m_vecSubAxis.insert("0", psubaxis);
-				psubaxis->FromJSON(ita.key(), ita.value());
-			}
+				writer.String(strFileId);
+				writer.Value(jfi);
+			});
 
-			// Load subaxes
-			if (itaasubaxes != jaa.end()) {
-				nlohmann::json & jaas = *itaasubaxes;
-				nlohmann::json::iterator itaas = jaas.begin();
-				for (; itaas != jaas.end(); ++itaas) {
-					SubAxis * psubaxis = new SubAxis();
-					paxisinfo->m_vecSubAxis.insert(itaas.key(), psubaxis);
-					psubaxis->FromJSON(itaas.key(), itaas.value());
-				}
-			}
+	} else if (m_vecFileInfo.size() == 0) {
+		writer.Value(nlohmann::json());
 
-			// Load all attributes
-			nlohmann::json::iterator itaa = jaa.begin();
-			for (; itaa != jaa.end(); ++itaa) {
-				if ((itaa.key() == "subaxes") ||
-				    (itaa.key() == "values") ||
-					(itaa.key() == "size") ||
-					(itaa.key() == "datatype")
-				) {
-					continue;
+	} else {
+		writer.BeginMap(m_vecFileInfo.size());
 
-				} else if (itaa.value().is_string()) {
-					paxisinfo->InsertAttribute(
-						itaa.key(), itaa.value());
+		LookupVectorHeap<std::string, FileInfo>::const_iterator iterfile = m_vecFileInfo.begin();
+		for (; iterfile != m_vecFileInfo.end(); iterfile++) {
+			nlohmann::json jfi;
+			FileInfoToJSON(*(*iterfile), jfi, &mapBlockIds);
+
+			writer.String(iterfile.key());
+			writer.Value(jfi);
+		}
+	}
 
-				} else if (itaa.value().is_number_integer()) {
-					paxisinfo->InsertAttribute(
-						itaa.key(), std::to_string((long long)itaa.value()));
+	// FileAttributeBlock
+	if (m_fWriteSharedFileAttributes) {
+		writer.String("file_attributes");
+		if (vecBlocks.size() == 0) {
+			writer.Value(nlohmann::json());
 
-				} else if (itaa.value().is_number_float()) {
-					paxisinfo->InsertAttribute(
-						itaa.key(), std::to_string((double)itaa.value()));
+		} else {
+			writer.BeginMap(vecBlocks.size());
+			for (size_t b = 0; b < vecBlocks.size(); b++) {
+				nlohmann::json jfa;
+				FileAttributeBlockToJSON(*(vecBlocks[b]), jfa);
 
-				} else {
-					_EXCEPTION1("Invalid JSON attribute value in \"axes\" with key \"%s\"", itaa.key().c_str());
-				}
+				writer.String(mapBlockIds[vecBlocks[b]]);
+				writer.Value(jfa);
 			}
-
 		}
 	}
 
-	// VariableInfo
-	{
-		auto it = j.find("variables");
-		if (it == j.end()) {
-			_EXCEPTIONT("JSON file missing \"variables\" key");
-		}
-		nlohmann::json & jv = *it;
-
-		// Set of variables
-		for (nlohmann::json::iterator itv = jv.begin(); itv != jv.end(); ++itv) {
-			nlohmann::json & jvv = *itv;
+	// Variables
+	writer.String("variables");
+	if (m_vecVariableInfo.size() == 0) {
+		writer.Value(nlohmann::json());
 
-			VariableInfo * pvarinfo = new VariableInfo(itv.key());
-			m_vecVariableInfo.insert(itv.key(), pvarinfo);
+	} else {
+		writer.BeginMap(m_vecVariableInfo.size());
 
-			// Load datatype
-			auto itvvdatatype = jvv.find("datatype");
-			if (itvvdatatype == jvv.end()) {
-				_EXCEPTION1("JSON variable \"%s\" missing \"datatype\" key",
-					itv.key().c_str());
-			}
-			if (!itvvdatatype.value().is_string()) {
-				_EXCEPTION1("JSON axis \"%s\" \"datatype\" must be type string",
-					itv.key().c_str());
-			}
-			pvarinfo->m_nctype = StringToNcType(itvvdatatype.value());
+		LookupVectorHeap<std::string, VariableInfo>::const_iterator itervar = m_vecVariableInfo.begin();
+		for (; itervar != m_vecVariableInfo.end(); itervar++) {
+			const VariableInfo * pvarinfo = *itervar;
 
-			// Load axisgroups
-			auto itvvaxisgroups = jvv.find("axisgroups");
-			if (itvvaxisgroups == jvv.end()) {
-				pvarinfo->SubAxisToFileIdMapFromJSON(it.key(), jvv);
+			nlohmann::json jvv;
+			VariableInfoToJSON(*pvarinfo, jvv);
 
-			} else {
-				auto itvvaxisids = jvv.find("axisids");
-				if (itvvaxisids != jvv.end()) {
-					_EXCEPTION1("variable \"%s\" specifies both \"axisgroups\" "
-						"and \"axisids\"",
-						itv.key().c_str());
-				}
-				auto itvvsubaxismap = jvv.find("subaxismap");
-				if (itvvsubaxismap != jvv.end()) {
-					_EXCEPTION1("variable \"%s\" specifies both \"axisgroups\" "
-						"and \"subaxismap\"",
-						itv.key().c_str());
-				}
+			writer.String(pvarinfo->m_strName);
+			writer.Value(jvv);
+		}
+	}
 
-				nlohmann::json & jvvaxisgroups = *itvvaxisgroups;
-				nlohmann::json::iterator itvvg = jvvaxisgroups.begin();
-				for (; itvvg != jvvaxisgroups.end(); ++itvvg) {
-					pvarinfo->SubAxisToFileIdMapFromJSON(it.key(), *itvvg);
-				}
-			}
+	if (!ofBinary) {
+		_EXCEPTION1("Error writing to file \"%s\"",
+			strOutputFilename.c_str());
+	}
 
-			// Load all attributes
-			nlohmann::json::iterator itvv = jvv.begin();
-			for (; itvv != jvv.end(); ++itvv) {
-				if ((itvv.key() == "axisids") ||
-				    (itvv.key() == "subaxismap") ||
-				    (itvv.key() == "axisgroups") ||
-					(itvv.key() == "datatype")
-				) {
-					continue;
+	return std::string("");
+}
 
-				} else if (itvv.value().is_string()) {
-					pvarinfo->InsertAttribute(
-						itvv.key(), itvv.value());
+///////////////////////////////////////////////////////////////////////////////
 
-				} else if (itvv.value().is_number_integer()) {
-					pvarinfo->InsertAttribute(
-						itvv.key(), std::to_string((long long)itvv.value()));
+///	<summary>
+///		Add the key and other attributes of a DataObjectInfo to a mapped
+///		index and return the range they occupy.
+///	</summary>
+static void DataObjectAttributesToMappedIndex(
+	MappedIndexWriter & writer,
+	const DataObjectInfo & info,
+	uint32_t & uAttrBegin,
+	uint32_t & uAttrCount
+) {
+	uAttrBegin = static_cast<uint32_t>(writer.m_vecAttributes.size());
 
-				} else if (itvv.value().is_number_float()) {
-					pvarinfo->InsertAttribute(
-						itvv.key(), std::to_string((double)itvv.value()));
+	AttributeMap::const_iterator iterAttKey =
+		info.m_mapKeyAttributes.begin();
+	for (; iterAttKey != info.m_mapKeyAttributes.end(); iterAttKey++) {
+		writer.AddAttribute(iterAttKey->first, iterAttKey->second, true);
+	}
 
-				} else {
-					_EXCEPTION1("Invalid JSON attribute value in \"variables\" with key \"%s\"", itvv.key().c_str());
-				}
-			}
-		}
+	AttributeMap::const_iterator iterAttOther =
+		info.m_mapOtherAttributes.begin();
+	for (; iterAttOther != info.m_mapOtherAttributes.end(); iterAttOther++) {
+		writer.AddAttribute(iterAttOther->first, iterAttOther->second, false);
 	}
 
-	return std::string("");
+	uAttrCount = static_cast<uint32_t>(writer.m_vecAttributes.size()) - uAttrBegin;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-std::string IndexedDataset::ToJSONFile(
-	const std::string & strJSONOutputFilename,
-	bool fPrettyPrint
+std::string IndexedDataset::ToMappedIndexFile(
+	const std::string & strOutputFilename
 ) const {
-	std::ofstream ofJSON(strJSONOutputFilename.c_str());
-	if (!ofJSON.is_open()) {
-		_EXCEPTION1("Error opening file \"%s\" for writing",
-			strJSONOutputFilename.c_str());
+#if defined(HYPERION_MPIOMP)
+	// Only output on root thread
+	int nRank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	if (nRank != 0) {
+		return std::string("");
 	}
+#endif
 
-	nlohmann::json j;
-
-	// Dataset 
-	nlohmann::json & jd = j["dataset"];
-	{
-		AttributeMap::const_iterator iterAttKey =
-			m_datainfo.m_mapKeyAttributes.begin();
-		for (; iterAttKey != m_datainfo.m_mapKeyAttributes.end(); iterAttKey++) {
-			jd[iterAttKey->first.c_str()] = iterAttKey->second.c_str();
-		}
+	// Files, axes, subaxes, variables and subaxis map entries are all
+	// added in key order, so that MappedIndex can binary search them
+	MappedIndexWriter writer;
 
-		AttributeMap::const_iterator iterAttOther =
-			m_datainfo.m_mapOtherAttributes.begin();
-		for (; iterAttOther != m_datainfo.m_mapOtherAttributes.end(); iterAttOther++) {
-			jd[iterAttOther->first.c_str()] = iterAttOther->second.c_str();
-		}
-	}
+	// Dataset
+	DataObjectAttributesToMappedIndex(writer, m_datainfo,
+		writer.m_uDatasetAttrBegin, writer.m_uDatasetAttrCount);
 
 	// FileInfo
-	nlohmann::json & jf = j["file"];
 	LookupVectorHeap<std::string, FileInfo>::const_iterator iterfile = m_vecFileInfo.begin();
 	for (; iterfile != m_vecFileInfo.end(); iterfile++) {
 		const FileInfo * pfileinfo = *iterfile;
 
-		nlohmann::json & jfi = jf[iterfile.key().c_str()];
-
-		jfi["name"] = pfileinfo->m_strFilename.c_str();
-
-		AttributeMap::const_iterator iterAttKey =
-			pfileinfo->m_mapKeyAttributes.begin();
-		for (; iterAttKey != pfileinfo->m_mapKeyAttributes.end(); iterAttKey++) {
-			jfi[iterAttKey->first.c_str()] = iterAttKey->second.c_str();
-		}
-
-		AttributeMap::const_iterator iterAttOther =
-			pfileinfo->m_mapOtherAttributes.begin();
-		for (; iterAttOther != pfileinfo->m_mapOtherAttributes.end(); iterAttOther++) {
-			jfi[iterAttOther->first.c_str()] = iterAttOther->second.c_str();
-		}
+		MappedIndexFile file;
+		memset(&file, 0, sizeof(MappedIndexFile));
+		file.uId = writer.String(iterfile.key());
+		file.uName = writer.String(pfileinfo->m_strFilename);
+		DataObjectAttributesToMappedIndex(writer, *pfileinfo,
+			file.uAttrBegin, file.uAttrCount);
 
-		nlohmann::json & jfia = jfi["axes"];
+		file.uAxesBegin = static_cast<uint32_t>(writer.m_vecFileAxes.size());
 		AxisSubAxisMap::const_iterator iterAxes =
 			pfileinfo->m_mapAxisSubAxis.begin();
 		for (; iterAxes != pfileinfo->m_mapAxisSubAxis.end(); iterAxes++) {
-			nlohmann::json jaxis;
-			jaxis.push_back(iterAxes->first.c_str());
-			jaxis.push_back(iterAxes->second.c_str());
-			jfia.push_back(jaxis);
+			MappedIndexFileAxis fileaxis;
+			fileaxis.uAxis = writer.String(iterAxes->first);
+			fileaxis.uSubAxis = writer.String(iterAxes->second);
+			writer.m_vecFileAxes.push_back(fileaxis);
 		}
+		file.uAxesCount =
+			static_cast<uint32_t>(writer.m_vecFileAxes.size()) - file.uAxesBegin;
+
+		file.llSize = pfileinfo->m_stamp.m_llSize;
+		file.llModTime = pfileinfo->m_stamp.m_llModTime;
+		file.ullInode = pfileinfo->m_stamp.m_ullInode;
 
+		writer.m_vecFiles.push_back(file);
 	}
 
 	// AxisInfo
-	nlohmann::json & ja = j["axes"];
 	LookupVectorHeap<std::string, AxisInfo>::const_iterator iteraxis = m_vecAxisInfo.begin();
 	for (; iteraxis != m_vecAxisInfo.end(); iteraxis++) {
 		const AxisInfo * paxisinfo = *iteraxis;
 
-		nlohmann::json & jaa = ja[paxisinfo->m_strName.c_str()];
-		jaa["units"] = paxisinfo->m_strUnits.c_str();
-		jaa["datatype"] =  NcTypeToString(paxisinfo->m_nctype).c_str();
-
-		AttributeMap::const_iterator iterAttKey =
-			paxisinfo->m_mapKeyAttributes.begin();
-		for (; iterAttKey != paxisinfo->m_mapKeyAttributes.end(); iterAttKey++) {
-			jaa[iterAttKey->first.c_str()] = iterAttKey->second.c_str();
-		}
-
-		AttributeMap::const_iterator iterAttOther =
-			paxisinfo->m_mapOtherAttributes.begin();
-		for (; iterAttOther != paxisinfo->m_mapOtherAttributes.end(); iterAttOther++) {
-			jaa[iterAttOther->first.c_str()] = iterAttOther->second.c_str();
-		}
+		MappedIndexAxis axis;
+		memset(&axis, 0, sizeof(MappedIndexAxis));
+		axis.uName = writer.String(iteraxis.key());
+		axis.uUnits = writer.String(paxisinfo->m_strUnits);
+		axis.iType = static_cast<int32_t>(paxisinfo->m_nctype);
+		DataObjectAttributesToMappedIndex(writer, *paxisinfo,
+			axis.uAttrBegin, axis.uAttrCount);
 
-		// Add all subaxes
+		axis.uSubAxisBegin = static_cast<uint32_t>(writer.m_vecSubAxes.size());
 		AxisInfo::SubAxisVector::const_iterator itersubaxis = paxisinfo->m_vecSubAxis.begin();
 		for (; itersubaxis != paxisinfo->m_vecSubAxis.end(); itersubaxis++) {
 			const SubAxis * psubaxisinfo = *itersubaxis;
 
-			nlohmann::json * jaas = NULL;
-			if (paxisinfo->m_vecSubAxis.size() == 1) {
-				jaas = &jaa;
-			} else {
-				jaas = &(jaa["subaxes"][itersubaxis.key().c_str()]);
+			MappedIndexSubAxis subaxis;
+			memset(&subaxis, 0, sizeof(MappedIndexSubAxis));
+			subaxis.uId = writer.String(itersubaxis.key());
+			subaxis.iType = static_cast<int32_t>(psubaxisinfo->m_nctype);
+			subaxis.lSize = psubaxisinfo->m_lSize;
+
+			if (IsNumericNcType(psubaxisinfo->m_nctype)) {
+				subaxis.uValuesCount = psubaxisinfo->m_values.size();
+				subaxis.uValuesOffset = writer.AddValues(
+					psubaxisinfo->m_values.RawData(),
+					psubaxisinfo->m_values.GetBytes());
 			}
-			psubaxisinfo->ToJSON(*jaas);
+
+			writer.m_vecSubAxes.push_back(subaxis);
 		}
+		axis.uSubAxisCount =
+			static_cast<uint32_t>(writer.m_vecSubAxes.size()) - axis.uSubAxisBegin;
+
+		writer.m_vecAxes.push_back(axis);
 	}
 
 	// Variables
-	nlohmann::json & jv = j["variables"];
-	for (int v = 0; v < m_vecVariableInfo.size(); v++) {
-		const VariableInfo * pvarinfo = m_vecVariableInfo[v];
+	LookupVectorHeap<std::string, VariableInfo>::const_iterator itervar = m_vecVariableInfo.begin();
+	for (; itervar != m_vecVariableInfo.end(); itervar++) {
+		const VariableInfo * pvarinfo = *itervar;
+
+		MappedIndexVariable var;
+		memset(&var, 0, sizeof(MappedIndexVariable));
+		var.uName = writer.String(itervar.key());
+		var.uUnits = writer.String(pvarinfo->m_strUnits);
+		var.iType = static_cast<int32_t>(pvarinfo->m_nctype);
+		DataObjectAttributesToMappedIndex(writer, *pvarinfo,
+			var.uAttrBegin, var.uAttrCount);
+
+		var.uGroupBegin = static_cast<uint32_t>(writer.m_vecAxisGroups.size());
+		AxisNamesToSubAxisToFileIdMapMap::const_iterator iterAxisGroup =
+			pvarinfo->m_mapSubAxisToFileIdMaps.begin();
+		for (; iterAxisGroup != pvarinfo->m_mapSubAxisToFileIdMaps.end(); iterAxisGroup++) {
+			const AxisNameVector & vecAxisNames = iterAxisGroup->first;
+			const SubAxisToFileIdMap & mapSubAxisToFileId = iterAxisGroup->second;
+
+			MappedIndexAxisGroup group;
+			memset(&group, 0, sizeof(MappedIndexAxisGroup));
+			group.uAxisIdBegin = static_cast<uint32_t>(writer.m_vecAxisGroupIds.size());
+			group.uAxisIdCount = static_cast<uint32_t>(vecAxisNames.size());
+			for (size_t d = 0; d < vecAxisNames.size(); d++) {
+				writer.m_vecAxisGroupIds.push_back(writer.String(vecAxisNames[d]));
+			}
+
+			group.uEntryBegin = writer.m_vecSubAxisMap.size();
+			group.uEntryCount = mapSubAxisToFileId.size();
+			if ((mapSubAxisToFileId.size() != 0) &&
+			    (mapSubAxisToFileId.width() != vecAxisNames.size())
+			) {
+				_EXCEPTION1("Variable \"%s\" has a subaxis map entry of the wrong length",
+					pvarinfo->m_strName.c_str());
+			}
 
-		nlohmann::json & jvv = jv[pvarinfo->m_strName.c_str()];
-		jvv["units"] = pvarinfo->m_strUnits.c_str();
-		jvv["datatype"] = NcTypeToString(pvarinfo->m_nctype).c_str();
+			// MappedIndex::FindFileId searches entries in the order of the
+			// string form of their ids
+			std::vector<size_t> vecEntryOrder(mapSubAxisToFileId.size());
+			for (size_t i = 0; i < vecEntryOrder.size(); i++) {
+				vecEntryOrder[i] = i;
+			}
+			std::sort(vecEntryOrder.begin(), vecEntryOrder.end(),
+				[&](size_t a, size_t b) {
+					const IndexId * pA = mapSubAxisToFileId.subaxisids(a);
+					const IndexId * pB = mapSubAxisToFileId.subaxisids(b);
+					for (size_t d = 0; d < vecAxisNames.size(); d++) {
+						if (pA[d] != pB[d]) {
+							return (IndexIdToString(pA[d]) < IndexIdToString(pB[d]));
+						}
+					}
+					return false;
+				});
+
+			for (size_t i = 0; i < vecEntryOrder.size(); i++) {
+				const IndexId * pSubAxisIds =
+					mapSubAxisToFileId.subaxisids(vecEntryOrder[i]);
+				for (size_t d = 0; d < vecAxisNames.size(); d++) {
+					writer.m_vecSubAxisMap.push_back(
+						writer.String(IndexIdToString(pSubAxisIds[d])));
+				}
+				writer.m_vecSubAxisMap.push_back(
+					writer.String(IndexIdToString(
+						mapSubAxisToFileId.fileid(vecEntryOrder[i]))));
+			}
 
-		AttributeMap::const_iterator iterAttKey =
-			pvarinfo->m_mapKeyAttributes.begin();
-		for (; iterAttKey != pvarinfo->m_mapKeyAttributes.end(); iterAttKey++) {
-			jvv[iterAttKey->first.c_str()] = iterAttKey->second.c_str();
+			writer.m_vecAxisGroups.push_back(group);
 		}
+		var.uGroupCount =
+			static_cast<uint32_t>(writer.m_vecAxisGroups.size()) - var.uGroupBegin;
+
+		writer.m_vecVariables.push_back(var);
+	}
+
+	writer.Write(strOutputFilename);
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string IndexedDataset::OutputChunkReferences(
+	const std::string & strOutputFilename,
+	size_t & sFailedFiles
+) const {
+	sFailedFiles = 0;
+
+#if defined(HYPERION_MPIOMP)
+	// Only output on root thread
+	int nRank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	if (nRank != 0) {
+		return std::string("");
+	}
+#endif
 
-		AttributeMap::const_iterator iterAttOther =
-			pvarinfo->m_mapOtherAttributes.begin();
-		for (; iterAttOther != pvarinfo->m_mapOtherAttributes.end(); iterAttOther++) {
-			jvv[iterAttOther->first.c_str()] = iterAttOther->second.c_str();
+	if (m_pspill != NULL) {
+		return std::string("Chunk references cannot be output from a spilled index");
+	}
+
+	// Local paths are made absolute so that the references can be read
+	// from any directory
+	std::string strWorkingDir;
+	{
+		char szCwd[PATH_MAX];
+		if (getcwd(szCwd, sizeof(szCwd)) != NULL) {
+			strWorkingDir = std::string(szCwd) + std::string("/");
 		}
+	}
 
-		// Output subaxis lookup table
-		if (pvarinfo->m_mapSubAxisToFileIdMaps.size() != 0) {
+	std::vector< std::pair<const std::string *, const FileInfo *> > vecFiles;
+	vecFiles.reserve(m_vecFileInfo.size());
+	LookupVectorHeap<std::string, FileInfo>::const_iterator iterfile = m_vecFileInfo.begin();
+	for (; iterfile != m_vecFileInfo.end(); iterfile++) {
+		vecFiles.push_back(
+			std::pair<const std::string *, const FileInfo *>(
+				&(iterfile.key()), *iterfile));
+	}
 
-			int ixAxisGroup = 0;
-			AxisNamesToSubAxisToFileIdMapMap::const_iterator iterAxisGroup =
-				pvarinfo->m_mapSubAxisToFileIdMaps.begin();
-			for (; iterAxisGroup != pvarinfo->m_mapSubAxisToFileIdMaps.end(); iterAxisGroup++) {
+	// Files named .gz or .zst are compressed as they are written
+	CompressedOutputStream ofRefs(strOutputFilename);
+	if (!ofRefs.is_open()) {
+		return std::string("Unable to open output file \"")
+			+ strOutputFilename + std::string("\"");
+	}
 
-				nlohmann::json * jvvg = NULL;
-				if (pvarinfo->m_mapSubAxisToFileIdMaps.size() > 1) {
-					std::string strKey = std::to_string((long long)ixAxisGroup);
-					jvvg = &(jvv["axisgroups"][strKey]);
-				} else {
-					jvvg = &jvv;
+	ofRefs << "{\"version\":1,\"files\":{";
+
+	// Files are read and formatted in batches, and written in key order
+	const size_t sBatchSize = std::max<size_t>(256, 64 * m_sThreads);
+	std::vector<std::string> vecText;
+	std::vector<size_t> vecChunks;
+	std::vector<char> vecFailed;
+	size_t sChunks = 0;
+	for (size_t sBegin = 0; sBegin < vecFiles.size(); sBegin += sBatchSize) {
+		const size_t sEnd = std::min(vecFiles.size(), sBegin + sBatchSize);
+		vecText.assign(sEnd - sBegin, std::string());
+		vecChunks.assign(sEnd - sBegin, 0);
+		vecFailed.assign(sEnd - sBegin, 0);
+
+		RunTasks(sEnd - sBegin, [&](size_t i) {
+			const FileInfo & fileinfo = *(vecFiles[sBegin + i].second);
+
+			std::string strFilename = fileinfo.m_strFilename;
+			if (!IsRemoteURL(strFilename) &&
+			    (strFilename.length() != 0) && (strFilename[0] != '/')
+			) {
+				strFilename = strWorkingDir + strFilename;
+			}
+
+			nlohmann::json jfi;
+			FileInfoToJSON(fileinfo, jfi);
+
+			FileChunkReferences refs;
+			std::string strError;
+			try {
+				strError = refs.FromFile(strFilename);
+			} catch(Exception & e) {
+				strError = e.ToString();
+			}
+
+			if (strError != "") {
+				jfi["error"] = strError;
+				vecFailed[i] = 1;
+			} else {
+				refs.ToJSON(jfi["refs"]);
+				for (size_t s = 0; s < refs.m_vecSkipped.size(); s++) {
+					jfi["skipped"][refs.m_vecSkipped[s].first] =
+						refs.m_vecSkipped[s].second;
 				}
+				vecChunks[i] = refs.GetChunkCount();
+			}
 
-				iterAxisGroup->first.ToJSON((*jvvg)["axisids"]);
+			vecText[i] = nlohmann::json(*(vecFiles[sBegin + i].first)).dump()
+				+ std::string(":") + jfi.dump();
+		});
 
-				iterAxisGroup->second.ToJSON((*jvvg)["subaxismap"]);
+		for (size_t i = 0; i < vecText.size(); i++) {
+			if (sBegin + i != 0) {
+				ofRefs << ",";
 			}
+			ofRefs << vecText[i];
+			sChunks += vecChunks[i];
+			sFailedFiles += vecFailed[i];
 		}
 	}
 
-	// Output to the file stream
-	if (fPrettyPrint) {
-		ofJSON << std::setw(4) << j;
-	} else {
-		ofJSON << j;
+	ofRefs << "}}\n";
+
+	ofRefs.close();
+	if (!ofRefs) {
+		return std::string("Error writing output file \"")
+			+ strOutputFilename + std::string("\"");
 	}
 
+	Announce("%lu chunks located in %lu files (%lu failed)",
+		sChunks, vecFiles.size() - sFailedFiles, sFailedFiles);
+
 	return std::string("");
 }
 
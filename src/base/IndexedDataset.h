@@ -11,21 +11,51 @@
 #include "Announce.h"
 #include "TimeObj.h"
 #include "DataArray1D.h"
+#include "DataArray2D.h"
+#include "DataArray3D.h"
 #include "LookupVectorHeap.h"
+#include "ObjectPool.h"
+#include "InternedString.h"
+#include "CFTimeUnits.h"
+#include "BinaryIndexCodec.h"
+#include "ClassicNcFile.h"
+#include "FileNameFilter.h"
 #include "MathHelper.h"
+#include "TypedValueArray.h"
+#include "NcWriteBatch.h"
+#include "VariableStatistics.h"
+#include "ExtractionScheduler.h"
 #include "netcdfcpp.h"
 
 #include "../contrib/nlohmann/json_fwd.hpp"
 
 #include <set>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <ostream>
 #include <vector>
 #include <string>
+#include <thread>
 
 ///////////////////////////////////////////////////////////////////////////////
 
 class Variable;
 
+class VariableHeader;
+
+class IndexedDatasetJSONReader;
+
+class GridRegistry;
+
+class FileInfoSpill;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 ///	<summary>
@@ -38,10 +68,15 @@ typedef std::pair<size_t, int> LocalFileTimePair;
 ///	</summary>
 typedef std::map<size_t, LocalFileTimePair> VariableTimeFileMap;
 
+///	<summary>
+///		A range of indices along one axis, as a start and a count.
+///	</summary>
+typedef std::pair<long, long> AxisIndexRange;
+
 ///	<summary>
 ///		A map from attribute names to values.
 ///	</summary>
-typedef std::map<std::string, std::string> AttributeMap;
+typedef std::map<InternedString, InternedString> AttributeMap;
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -77,13 +112,31 @@ public:
 	);
 
 	///	<summary>
-	///		Populate from a NcVar.
+	///		Insert a global attribute of a file, as the key or other
+	///		attribute FromNcFile would make it.
+	///	</summary>
+	void InsertFileAttribute(
+		const std::string & strAttName,
+		const std::string & strValue
+	);
+
+	///	<summary>
+	///		Populate from a NcVar in the given NcFile.
 	///	</summary>
 	std::string FromNcVar(
+		NcFile * ncfile,
 		NcVar * var,
 		bool fCheckConsistency
 	);
 
+	///	<summary>
+	///		Populate from a VariableHeader.
+	///	</summary>
+	std::string FromVariableHeader(
+		const VariableHeader & varheader,
+		bool fCheckConsistency
+	);
+
 	///	<summary>
 	///		Insert attribute.
 	///	</summary>
@@ -154,19 +207,137 @@ public:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+///	<summary>
+///		A summary of the coordinate values of a SubAxis, stored instead
+///		of the values for large axes.  The hash covers the bit pattern of
+///		every value, so two summaries are equal only if their values are
+///		identical.
+///	</summary>
+class SubAxisSummary {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	SubAxisSummary() :
+		m_sCount(0),
+		m_dMin(0.0),
+		m_dMax(0.0),
+		m_dFirst(0.0),
+		m_dLast(0.0),
+		m_ullHash(0)
+	{ }
+
+	///	<summary>
+	///		Add the next value, given with its bit pattern.
+	///	</summary>
+	void Add(
+		double dValue,
+		unsigned long long ullBits
+	);
+
+	///	<summary>
+	///		Add the next values of any numeric NetCDF type.
+	///	</summary>
+	template <typename T>
+	void Add(
+		const T * pValues,
+		size_t sCount
+	) {
+		for (size_t i = 0; i < sCount; i++) {
+			Add(static_cast<double>(pValues[i]), NcValueBits(pValues[i]));
+		}
+	}
+
+	///	<summary>
+	///		Equality operator.
+	///	</summary>
+	bool operator==(const SubAxisSummary & summary) const;
+
+	///	<summary>
+	///		Convert to a JSON object.
+	///	</summary>
+	void ToJSON(
+		nlohmann::json & j
+	) const;
+
+public:
+	///	<summary>
+	///		Number of values.
+	///	</summary>
+	size_t m_sCount;
+
+	///	<summary>
+	///		Smallest and largest value, ignoring NaNs.
+	///	</summary>
+	double m_dMin;
+	double m_dMax;
+
+	///	<summary>
+	///		First and last value.
+	///	</summary>
+	double m_dFirst;
+	double m_dLast;
+
+	///	<summary>
+	///		Hash of the values.
+	///	</summary>
+	unsigned long long m_ullHash;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 ///	<summary>
 ///		A class that stores a range of the given dimension.
 ///	</summary>
 class SubAxis : public DataObjectInfo {
 
 public:
+	///	<summary>
+	///		Allocate from the pool shared by all SubAxis objects.
+	///	</summary>
+	OBJECTPOOL_ALLOCATED(SubAxis)
+
 	///	<summary>
 	///		Constructor.
 	///	</summary>
 	SubAxis() :
-		m_nctype(ncNoType)
+		m_nctype(ncNoType),
+		m_fSummarized(false),
+		m_fLinear(false),
+		m_dLinearStart(0.0),
+		m_dLinearStep(0.0)
 	{ }
 
+	///	<summary>
+	///		Replace the values by their summary.
+	///	</summary>
+	void Summarize();
+
+	///	<summary>
+	///		Check if the values are an arithmetic progression that
+	///		ExpandLinear reproduces exactly, and if so record its start
+	///		and step.
+	///	</summary>
+	void DetectLinear();
+
+	///	<summary>
+	///		Set the values to the first m_lSize terms of the arithmetic
+	///		progression with the given start and step.
+	///	</summary>
+	void ExpandLinear(
+		double dStart,
+		double dStep
+	);
+
+	///	<summary>
+	///		Load the values of a summarized SubAxis from the dimension
+	///		variable strVariableName of m_strSourceFile.
+	///	</summary>
+	std::string LoadValues(
+		const std::string & strVariableName
+	);
+
 	///	<summary>
 	///		Verify that this range is monotonic.
 	///	</summary>
@@ -179,16 +350,45 @@ public:
 	///	</summary>
 	bool operator==(const SubAxis & dimrange) const;
 
+	///	<summary>
+	///		Get the fingerprints under which a SubAxis equal to this one
+	///		may be indexed.  The first entry is the fingerprint of this
+	///		SubAxis; further entries account for floating point values
+	///		that lie close to a quantization boundary.
+	///	</summary>
+	void GetFingerprints(
+		std::vector<size_t> & vecFingerprints
+	) const;
+
+	///	<summary>
+	///		Get a fingerprint of the exact content of this SubAxis: its
+	///		type, size and the bit pattern of every value.  Unlike
+	///		GetFingerprints it does not tolerate rounding differences, and
+	///		it is the same whether or not the values are summarized.
+	///	</summary>
+	unsigned long long GetContentFingerprint() const;
+
+	///	<summary>
+	///		Write the values as a Python list.
+	///	</summary>
+	void ValuesToStream(
+		std::ostream & os
+	) const;
+
 	///	<summary>
 	///		Convert to a Python list.
 	///	</summary>
 	std::string ValuesToString() const;
 
 	///	<summary>
-	///		Convert to a JSON object.
+	///		Convert to a JSON object.  If fIncludeValues is false the
+	///		"values" member is left out.  Values found in pgridregistry
+	///		are written as a "grid" reference to their fingerprint.
 	///	</summary>
 	void ToJSON(
-		nlohmann::json & j
+		nlohmann::json & j,
+		bool fIncludeValues = true,
+		const GridRegistry * pgridregistry = NULL
 	) const;
 
 	///	<summary>
@@ -211,19 +411,193 @@ public:
 	long m_lSize;
 
 	///	<summary>
-	///		Dimension values as int.
+	///		Dimension values, of type m_nctype.
+	///	</summary>
+	TypedValueArray m_values;
+
+	///	<summary>
+	///		Flag indicating only m_summary is stored, not the values.
+	///	</summary>
+	bool m_fSummarized;
+
+	///	<summary>
+	///		Summary of the values, if m_fSummarized is set.
+	///	</summary>
+	SubAxisSummary m_summary;
+
+	///	<summary>
+	///		File from which the values of a summarized SubAxis can be
+	///		loaded.
+	///	</summary>
+	std::string m_strSourceFile;
+
+	///	<summary>
+	///		Flag indicating the values are the arithmetic progression
+	///		given by m_dLinearStart and m_dLinearStep, which is written
+	///		in place of the values.
+	///	</summary>
+	bool m_fLinear;
+
+	///	<summary>
+	///		First value of the arithmetic progression.
+	///	</summary>
+	double m_dLinearStart;
+
+	///	<summary>
+	///		Step of the arithmetic progression.
+	///	</summary>
+	double m_dLinearStep;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A file or subaxis id.  Ids are written to the index as the decimal
+///		string of the integer.
+///	</summary>
+typedef uint32_t IndexId;
+
+///	<summary>
+///		Convert an id to its string form.
+///	</summary>
+inline std::string IndexIdToString(
+	IndexId id
+) {
+	return std::to_string(static_cast<unsigned long long>(id));
+}
+
+///	<summary>
+///		Parse the string form of an id.  Returns false if the string is
+///		not a non-negative decimal integer that fits in an IndexId.
+///	</summary>
+bool IndexIdFromString(
+	const std::string & str,
+	IndexId & id
+);
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A table of the range of values of each SubAxis of an axis, sorted
+///		on the smallest value, used to find the subaxes overlapping a
+///		range of coordinates.  The values of time axes whose units parse
+///		as CF time units are stored as TimeKeys, so that subaxes with
+///		different reference times are ordered chronologically.
+///	</summary>
+class SubAxisIntervalIndex {
+
+public:
+	///	<summary>
+	///		The range of values of one SubAxis.
+	///	</summary>
+	struct Interval {
+		///	<summary>
+		///		Smallest value.
+		///	</summary>
+		double m_dMin;
+
+		///	<summary>
+		///		Largest value.
+		///	</summary>
+		double m_dMax;
+
+		///	<summary>
+		///		Id of the SubAxis.
+		///	</summary>
+		IndexId m_idSubAxis;
+
+		///	<summary>
+		///		The SubAxis.
+		///	</summary>
+		const SubAxis * m_psubaxis;
+
+		///	<summary>
+		///		Index in m_vecTimeUnits of the units of a time SubAxis.
+		///	</summary>
+		size_t m_sTimeUnitsIx;
+
+		///	<summary>
+		///		Order intervals by their smallest value.
+		///	</summary>
+		static bool MinLess(
+			const Interval & a,
+			const Interval & b
+		) {
+			return (a.m_dMin < b.m_dMin);
+		}
+	};
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	SubAxisIntervalIndex() :
+		m_fTime(false),
+		m_eCalendarType(Time::CalendarUnknown)
+	{ }
+
+	///	<summary>
+	///		Remove all intervals.
+	///	</summary>
+	void Clear() {
+		m_fTime = false;
+		m_eCalendarType = Time::CalendarUnknown;
+		m_vecTimeUnits.clear();
+		m_vecIntervals.clear();
+		m_vecPrefixMax.clear();
+	}
+
+	///	<summary>
+	///		Bytes of memory used by the index.
+	///	</summary>
+	size_t GetMemoryBytes() const {
+		return m_vecTimeUnits.capacity() * sizeof(CFTimeUnits)
+			+ m_vecIntervals.capacity() * sizeof(Interval)
+			+ m_vecPrefixMax.capacity() * sizeof(double);
+	}
+
+	///	<summary>
+	///		Sort the intervals and build the prefix maxima; called once
+	///		m_vecIntervals has been filled.
+	///	</summary>
+	void Sort();
+
+	///	<summary>
+	///		Get the positions in m_vecIntervals of the intervals that
+	///		overlap [dLow, dHigh].
+	///	</summary>
+	void FindOverlapping(
+		double dLow,
+		double dHigh,
+		std::vector<size_t> & vecIntervalIxs
+	) const;
+
+public:
+	///	<summary>
+	///		Flag indicating values are TimeKeys.
+	///	</summary>
+	bool m_fTime;
+
+	///	<summary>
+	///		Calendar of a time axis.
+	///	</summary>
+	Time::CalendarType m_eCalendarType;
+
+	///	<summary>
+	///		Distinct units of the subaxes of a time axis.
 	///	</summary>
-	std::vector<int> m_dValuesInt;
+	std::vector<CFTimeUnits> m_vecTimeUnits;
 
 	///	<summary>
-	///		Dimension values as floats.
+	///		Intervals sorted by their smallest value.
 	///	</summary>
-	std::vector<float> m_dValuesFloat;
+	std::vector<Interval> m_vecIntervals;
 
 	///	<summary>
-	///		Dimension values as doubles.
+	///		Largest value of the intervals up to and including each
+	///		position of m_vecIntervals.
 	///	</summary>
-	std::vector<double> m_dValuesDouble;
+	std::vector<double> m_vecPrefixMax;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -251,13 +625,24 @@ public:
 	///	</summary>
 	typedef LookupVectorHeap<std::string, SubAxis> SubAxisVector;
 
+	///	<summary>
+	///		Map from SubAxis fingerprint to subaxis id.
+	///	</summary>
+	typedef std::unordered_multimap<size_t, std::string> SubAxisFingerprintIndex;
+
 public:
+	///	<summary>
+	///		Allocate from the pool shared by all AxisInfo objects.
+	///	</summary>
+	OBJECTPOOL_ALLOCATED(AxisInfo)
+
 	///	<summary>
 	///		Constructor.
 	///	</summary>
 	AxisInfo() :
 		DataObjectInfo(""),
-		m_eType(Type_Unknown)
+		m_eType(Type_Unknown),
+		m_vecSubAxis(true)
 	{ }
 
 	///	<summary>
@@ -267,9 +652,34 @@ public:
 		const std::string & strName
 	) :
 		DataObjectInfo(strName),
-		m_eType(Type_Unknown)
+		m_eType(Type_Unknown),
+		m_vecSubAxis(true)
 	{ }
 
+public:
+	///	<summary>
+	///		Find the id of the SubAxis equal to the given SubAxis, or an
+	///		empty string if there is none.  If several are equal the
+	///		first in id order is returned.
+	///	</summary>
+	std::string FindSubAxis(
+		const SubAxis & subaxis
+	) const;
+
+	///	<summary>
+	///		Insert a SubAxis into m_vecSubAxis and the fingerprint index.
+	///	</summary>
+	void InsertSubAxis(
+		const std::string & strSubAxisId,
+		SubAxis * psubaxis
+	);
+
+	///	<summary>
+	///		Rebuild the fingerprint index after m_vecSubAxis has been
+	///		modified directly.
+	///	</summary>
+	void RebuildSubAxisIndex();
+
 public:
 	///	<summary>
 	///		Dimension type.
@@ -280,6 +690,17 @@ public:
 	///		A map from subaxis id to SubAxis.
 	///	</summary>
 	SubAxisVector m_vecSubAxis;
+
+	///	<summary>
+	///		Fingerprint index of m_vecSubAxis.
+	///	</summary>
+	SubAxisFingerprintIndex m_mapSubAxisFingerprints;
+
+	///	<summary>
+	///		Ranges of the values of m_vecSubAxis, filled by
+	///		IndexedDataset::BuildQueryIndex.
+	///	</summary>
+	SubAxisIntervalIndex m_intervals;
 };
 
 ///	<summary>
@@ -319,109 +740,1424 @@ public:
 };
 
 ///	<summary>
-///		A list of subaxis names.
+///		A list of subaxis ids.
 ///	</summary>
-typedef std::vector<std::string> SubAxisIdVector;
+typedef std::vector<IndexId> SubAxisIdVector;
 
 ///	<summary>
-///		A map from subaxis ids to file ids.
+///		A map from subaxis ids to file ids, stored as a flat array of
+///		fixed-width tuples sorted on the subaxis ids.  Each tuple holds
+///		one subaxis id for each axis of the axis group, followed by the
+///		file id.  Entries are accessed by position, in ascending order of
+///		their subaxis ids.
+///
+///		BuildDenseLookup adds a dense table over the ranges of subaxis ids
+///		when the entries vary along at most two axes and fill most of it,
+///		as for a variable split into time chunks and ensemble members;
+///		find then resolves a tuple in constant time.  Any change to the
+///		entries drops the table.
 ///	</summary>
-class SubAxisToFileIdMap : public std::map< SubAxisIdVector, std::string> {
+class SubAxisToFileIdMap {
+
 public:
 	///	<summary>
-	///		Convert to a string.
+	///		Largest number of axes along which the entries of a dense
+	///		lookup may vary.
 	///	</summary>
-	std::string ToString() const;
+	static const size_t DenseLookupMaxVaryingAxes;
 
 	///	<summary>
-	///		Convert to JSON.
+	///		Largest ratio of the size of a dense lookup to the number of
+	///		entries.
 	///	</summary>
-	void ToJSON(nlohmann::json & j) const;
-};
-
-///	<summary>
-///		A map from a vector of axis names to a SubAxisToFileIdMap.
-///	</summary>
-typedef std::map<AxisNameVector, SubAxisToFileIdMap> AxisNamesToSubAxisToFileIdMapMap;
-
-///////////////////////////////////////////////////////////////////////////////
+	static const size_t DenseLookupMaxFillRatio;
 
-///	<summary>
-///		A class that describes primitive variable information from a IndexedDataset.
-///	</summary>
-class VariableInfo : public DataObjectInfo {
+	///	<summary>
+	///		A dense lookup cell with no entry.
+	///	</summary>
+	static const IndexId InvalidDenseEntry;
 
 public:
 	///	<summary>
-	///		Constructor.
+	///		Constructor.  The width is set by the first insertion.
 	///	</summary>
-	VariableInfo(
-		const std::string & strName
-	) :
-		DataObjectInfo(strName)
-	{ } 
+	SubAxisToFileIdMap() :
+		m_sWidth(0)
+	{ }
 
 	///	<summary>
-	///		Insert a new SubAxisToFileIdMap from a JSON object.
+	///		Number of entries.
 	///	</summary>
-	void SubAxisToFileIdMapFromJSON(
-		const std::string & strKey,
-		nlohmann::json & j
-	);
+	size_t size() const {
+		return m_vecEntries.size() / (m_sWidth + 1);
+	}
 
-public:
 	///	<summary>
-	///		Map from Times to filename index and time index.
+	///		Check if there are no entries.
 	///	</summary>
-	VariableTimeFileMap m_mapTimeFile;
+	bool empty() const {
+		return (m_vecEntries.size() == 0);
+	}
 
 	///	<summary>
-	///		Map from subaxis coordinate to file id.
+	///		Number of subaxis ids in each entry.
 	///	</summary>
-	AxisNamesToSubAxisToFileIdMapMap m_mapSubAxisToFileIdMaps;
-};
-
-///////////////////////////////////////////////////////////////////////////////
+	size_t width() const {
+		return m_sWidth;
+	}
 
-///	<summary>
-///		A class that describes dimension information from a IndexedDataset.
-///	</summary>
-class FileInfo : public DataObjectInfo {
+	///	<summary>
+	///		Subaxis ids of the given entry.
+	///	</summary>
+	const IndexId * subaxisids(
+		size_t i
+	) const {
+		return &(m_vecEntries[i * (m_sWidth + 1)]);
+	}
 
-public:
 	///	<summary>
-	///		Constructor.
+	///		File id of the given entry.
 	///	</summary>
-	FileInfo(
-		const std::string & strFilename
-	) :
-		m_strFilename(strFilename)
-	{ }
+	IndexId fileid(
+		size_t i
+	) const {
+		return m_vecEntries[i * (m_sWidth + 1) + m_sWidth];
+	}
 
-public:
 	///	<summary>
-	///		File name of this File.
+	///		Find the entry with the given subaxis ids.  Returns size() if
+	///		there is no such entry.
 	///	</summary>
-	std::string m_strFilename;
+	size_t find(
+		const SubAxisIdVector & vecSubAxisIds
+	) const;
 
 	///	<summary>
-	///		A set of AxisSubAxisPairs stored in this file.
+	///		Find the file id of the entry with the given subaxis ids.
+	///		Returns false if there is no such entry.
 	///	</summary>
-	AxisSubAxisMap m_mapAxisSubAxis;
+	bool FindFileId(
+		const SubAxisIdVector & vecSubAxisIds,
+		IndexId & idFile
+	) const {
+		size_t i = find(vecSubAxisIds);
+		if (i == size()) {
+			return false;
+		}
+		idFile = fileid(i);
+		return true;
+	}
 
 	///	<summary>
-	///		A set of variables stored in this file?
+	///		Build the dense lookup if the entries are suited to one.
+	///		Returns true if a dense lookup was built.
+	///	</summary>
+	bool BuildDenseLookup();
+
+	///	<summary>
+	///		Check if find uses a dense lookup.
+	///	</summary>
+	bool HasDenseLookup() const {
+		return (m_vecDenseEntries.size() != 0);
+	}
+
+	///	<summary>
+	///		Insert an entry.  Returns false, leaving the map unchanged, if
+	///		an entry with the same subaxis ids already exists.
+	///	</summary>
+	bool insert(
+		const SubAxisIdVector & vecSubAxisIds,
+		IndexId idFile
+	);
+
+	///	<summary>
+	///		Insert entries given as a flat array of tuples of sWidth
+	///		subaxis ids followed by a file id, in any order.  Entries whose
+	///		subaxis ids are already in the map, or appear earlier in the
+	///		array, are skipped.  Returns the number of entries inserted.
+	///	</summary>
+	size_t insert(
+		size_t sWidth,
+		const std::vector<IndexId> & vecEntries
+	);
+
+	///	<summary>
+	///		Remove all entries for which fn(subaxisids, fileid) is true,
+	///		preserving the order of the rest.
+	///	</summary>
+	template <typename Predicate>
+	void erase_if(
+		Predicate fn
+	) {
+		const size_t sStride = m_sWidth + 1;
+		size_t sOut = 0;
+		for (size_t sIn = 0; sIn < m_vecEntries.size(); sIn += sStride) {
+			if (fn(&(m_vecEntries[sIn]), m_vecEntries[sIn + m_sWidth])) {
+				continue;
+			}
+			if (sOut != sIn) {
+				std::copy(
+					m_vecEntries.begin() + sIn,
+					m_vecEntries.begin() + sIn + sStride,
+					m_vecEntries.begin() + sOut);
+			}
+			sOut += sStride;
+		}
+		if (sOut != m_vecEntries.size()) {
+			m_vecEntries.resize(sOut);
+			ClearDenseLookup();
+		}
+	}
+
+	///	<summary>
+	///		Remove all entries.
+	///	</summary>
+	void clear() {
+		m_vecEntries.clear();
+		m_sWidth = 0;
+		ClearDenseLookup();
+	}
+
+	///	<summary>
+	///		Swap with another map.
+	///	</summary>
+	void swap(
+		SubAxisToFileIdMap & map
+	) {
+		m_vecEntries.swap(map.m_vecEntries);
+		std::swap(m_sWidth, map.m_sWidth);
+		m_vecDenseBase.swap(map.m_vecDenseBase);
+		m_vecDenseExtent.swap(map.m_vecDenseExtent);
+		m_vecDenseEntries.swap(map.m_vecDenseEntries);
+	}
+
+	///	<summary>
+	///		Release unused capacity.
+	///	</summary>
+	void shrink_to_fit() {
+		m_vecEntries.shrink_to_fit();
+	}
+
+	///	<summary>
+	///		Bytes of memory used by the entries.
+	///	</summary>
+	size_t GetMemoryBytes() const {
+		return (m_vecEntries.capacity()
+				+ m_vecDenseBase.capacity()
+				+ m_vecDenseEntries.capacity()) * sizeof(IndexId)
+			+ m_vecDenseExtent.capacity() * sizeof(size_t);
+	}
+
+	///	<summary>
+	///		Write as a string.
+	///	</summary>
+	void ToStream(std::ostream & os) const;
+
+	///	<summary>
+	///		Convert to a string.
+	///	</summary>
+	std::string ToString() const;
+
+	///	<summary>
+	///		Convert to JSON.
+	///	</summary>
+	void ToJSON(nlohmann::json & j) const;
+
+protected:
+	///	<summary>
+	///		Get the position in m_vecEntries of the first entry whose
+	///		subaxis ids are not less than the given ids.
+	///	</summary>
+	size_t LowerBound(
+		const SubAxisIdVector & vecSubAxisIds
+	) const;
+
+	///	<summary>
+	///		Drop the dense lookup.
+	///	</summary>
+	void ClearDenseLookup() {
+		m_vecDenseBase.clear();
+		m_vecDenseExtent.clear();
+		m_vecDenseEntries.clear();
+	}
+
+protected:
+	///	<summary>
+	///		Number of subaxis ids in each entry.
+	///	</summary>
+	size_t m_sWidth;
+
+	///	<summary>
+	///		Entries of m_sWidth subaxis ids followed by a file id.
+	///	</summary>
+	std::vector<IndexId> m_vecEntries;
+
+	///	<summary>
+	///		Smallest subaxis id along each axis of the dense lookup.
+	///	</summary>
+	std::vector<IndexId> m_vecDenseBase;
+
+	///	<summary>
+	///		Range of subaxis ids along each axis of the dense lookup.
+	///	</summary>
+	std::vector<size_t> m_vecDenseExtent;
+
+	///	<summary>
+	///		Row-major dense lookup from the offsets of subaxis ids from
+	///		m_vecDenseBase to the entry index, or InvalidDenseEntry.
+	///	</summary>
+	std::vector<IndexId> m_vecDenseEntries;
+};
+
+///	<summary>
+///		A map from a vector of axis names to a SubAxisToFileIdMap.
+///	</summary>
+typedef std::map<AxisNameVector, SubAxisToFileIdMap> AxisNamesToSubAxisToFileIdMapMap;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		The storage layout of a variable in a file: its chunking, the
+///		filters applied to each chunk and its byte order.  Readers use it
+///		to plan reads aligned to chunks without opening the file.
+///	</summary>
+class VariableStorage {
+
+public:
+	///	<summary>
+	///		Storage layouts.
+	///	</summary>
+	enum Layout {
+		Layout_Unknown = (-1),
+		Layout_Contiguous = 0,
+		Layout_Chunked = 1,
+		Layout_Compact = 2
+	};
+
+	///	<summary>
+	///		Byte orders.
+	///	</summary>
+	enum Endian {
+		Endian_Native = 0,
+		Endian_Little = 1,
+		Endian_Big = 2
+	};
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	VariableStorage() :
+		m_eLayout(Layout_Unknown),
+		m_iDeflateLevel(0),
+		m_fShuffle(false),
+		m_fFletcher32(false),
+		m_eEndian(Endian_Native),
+		m_uFilterId(0)
+	{ }
+
+	///	<summary>
+	///		Populate from the given variable of an open NetCDF file.
+	///	</summary>
+	void FromNcVar(
+		int ncid,
+		int varid,
+		int nDims
+	);
+
+	///	<summary>
+	///		Populate as a variable of a classic format file, which is
+	///		always contiguous, unfiltered and big-endian.
+	///	</summary>
+	void SetClassic();
+
+	///	<summary>
+	///		Check if the layout is known.
+	///	</summary>
+	bool IsKnown() const {
+		return (m_eLayout != Layout_Unknown);
+	}
+
+	///	<summary>
+	///		Convert to a JSON object, leaving out members with their
+	///		default values.
+	///	</summary>
+	void ToJSON(
+		nlohmann::json & j
+	) const;
+
+	///	<summary>
+	///		Get the chunk sizes as a comma-separated list.
+	///	</summary>
+	std::string ChunkSizesToString() const;
+
+	///	<summary>
+	///		Get the name of a layout.
+	///	</summary>
+	static const char * LayoutToString(
+		Layout eLayout
+	);
+
+	///	<summary>
+	///		Get the layout with the given name.  Returns false if the name
+	///		is not a layout.
+	///	</summary>
+	static bool LayoutFromString(
+		const std::string & strLayout,
+		Layout & eLayout
+	);
+
+	///	<summary>
+	///		Get the name of a byte order.
+	///	</summary>
+	static const char * EndianToString(
+		Endian eEndian
+	);
+
+	///	<summary>
+	///		Get the byte order with the given name.  Returns false if the
+	///		name is not a byte order.
+	///	</summary>
+	static bool EndianFromString(
+		const std::string & strEndian,
+		Endian & eEndian
+	);
+
+	///	<summary>
+	///		Equality operator.
+	///	</summary>
+	bool operator==(const VariableStorage & storage) const {
+		return (
+			(m_eLayout == storage.m_eLayout) &&
+			(m_vecChunkSizes == storage.m_vecChunkSizes) &&
+			(m_iDeflateLevel == storage.m_iDeflateLevel) &&
+			(m_fShuffle == storage.m_fShuffle) &&
+			(m_fFletcher32 == storage.m_fFletcher32) &&
+			(m_eEndian == storage.m_eEndian) &&
+			(m_uFilterId == storage.m_uFilterId));
+	}
+
+	///	<summary>
+	///		Inequality operator.
+	///	</summary>
+	bool operator!=(const VariableStorage & storage) const {
+		return !((*this) == storage);
+	}
+
+public:
+	///	<summary>
+	///		Storage layout.
+	///	</summary>
+	Layout m_eLayout;
+
+	///	<summary>
+	///		Size of a chunk along each dimension, if chunked.
+	///	</summary>
+	std::vector<size_t> m_vecChunkSizes;
+
+	///	<summary>
+	///		Deflate level, or zero if not deflated.
+	///	</summary>
+	int m_iDeflateLevel;
+
+	///	<summary>
+	///		Flag indicating the shuffle filter is applied.
+	///	</summary>
+	bool m_fShuffle;
+
+	///	<summary>
+	///		Flag indicating the fletcher32 checksum is applied.
+	///	</summary>
+	bool m_fFletcher32;
+
+	///	<summary>
+	///		Byte order.
+	///	</summary>
+	Endian m_eEndian;
+
+	///	<summary>
+	///		HDF5 id of the first filter other than deflate, shuffle and
+	///		fletcher32, such as 32015 for Zstandard, or zero if none.
+	///	</summary>
+	unsigned int m_uFilterId;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A class that describes primitive variable information from a IndexedDataset.
+///	</summary>
+class VariableInfo : public DataObjectInfo {
+
+public:
+	///	<summary>
+	///		Allocate from the pool shared by all VariableInfo objects.
+	///	</summary>
+	OBJECTPOOL_ALLOCATED(VariableInfo)
+
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	VariableInfo(
+		const std::string & strName
+	) :
+		DataObjectInfo(strName),
+		m_fStorageVaries(false)
+	{ }
+
+	///	<summary>
+	///		Insert a new SubAxisToFileIdMap from a JSON object.
+	///	</summary>
+	void SubAxisToFileIdMapFromJSON(
+		const std::string & strKey,
+		nlohmann::json & j
+	);
+
+	///	<summary>
+	///		Build the dense lookup of each SubAxisToFileIdMap suited to one.
+	///		Returns the number of dense lookups.
+	///	</summary>
+	size_t BuildFileIdLookups();
+
+	///	<summary>
+	///		Add the storage layout of the variable in another file,
+	///		marking the layout as varying if it differs.  Returns true
+	///		the first time the layout is found to vary.
+	///	</summary>
+	bool MergeStorage(
+		const VariableStorage & storage
+	);
+
+public:
+	///	<summary>
+	///		Storage layout of the variable in the first file indexed.
+	///	</summary>
+	VariableStorage m_storage;
+
+	///	<summary>
+	///		Flag indicating the storage layout differs across files, so
+	///		that m_storage describes only some of them.
+	///	</summary>
+	bool m_fStorageVaries;
+
+	///	<summary>
+	///		Statistics of the values of the variable combined over all
+	///		files for which they were computed.
+	///	</summary>
+	VariableStatistics m_statistics;
+
+	///	<summary>
+	///		Map from indices of IndexedDataset::m_vecTimes to file index
+	///		and time index, filled by IndexedDataset::BuildTimeIndex.
+	///	</summary>
+	VariableTimeFileMap m_mapTimeFile;
+
+	///	<summary>
+	///		Map from subaxis coordinate to file id.
+	///	</summary>
+	AxisNamesToSubAxisToFileIdMapMap m_mapSubAxisToFileIdMaps;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A hyperslab of a variable in one file, and the position of its
+///		first element in the row-major array being loaded.
+///	</summary>
+class FileHyperslab {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	FileHyperslab() :
+		m_sFileIx(0),
+		m_sOffset(0)
+	{ }
+
+public:
+	///	<summary>
+	///		Index of the file in the IndexedDataset.
+	///	</summary>
+	size_t m_sFileIx;
+
+	///	<summary>
+	///		Start of the hyperslab along each dimension of the variable.
+	///	</summary>
+	std::vector<long> m_vecStart;
+
+	///	<summary>
+	///		Size of the hyperslab along each dimension of the variable.
+	///	</summary>
+	std::vector<long> m_vecCount;
+
+	///	<summary>
+	///		Offset of the hyperslab in the array being loaded.
+	///	</summary>
+	size_t m_sOffset;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A closed range of coordinates along one axis of a query.  Bounds
+///		on a time axis may be given as formatted times, such as
+///		"1950-01-01 00:00:00", in the calendar of the axis; numeric bounds
+///		are in the units of the axis.
+///	</summary>
+class QueryAxisRange {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	QueryAxisRange() :
+		m_dLow(0.0),
+		m_dHigh(0.0),
+		m_fFormattedTime(false)
+	{ }
+
+	///	<summary>
+	///		Parse a range of the form "<axis>=<low>,<high>".  Bounds that
+	///		are not numbers are taken as formatted times.  Returns an
+	///		error message if the range is malformed.
+	///	</summary>
+	std::string FromString(
+		const std::string & strRange
+	);
+
+	///	<summary>
+	///		Parse a list of ranges separated by semicolons.  Returns an
+	///		error message if any range is malformed.
+	///	</summary>
+	static std::string ListFromString(
+		const std::string & strRanges,
+		std::vector<QueryAxisRange> & vecRanges
+	);
+
+public:
+	///	<summary>
+	///		Name of the axis.
+	///	</summary>
+	std::string m_strAxisName;
+
+	///	<summary>
+	///		Lower bound in the units of the axis.
+	///	</summary>
+	double m_dLow;
+
+	///	<summary>
+	///		Upper bound in the units of the axis.
+	///	</summary>
+	double m_dHigh;
+
+	///	<summary>
+	///		Flag indicating the bounds are m_strTimeLow and m_strTimeHigh.
+	///	</summary>
+	bool m_fFormattedTime;
+
+	///	<summary>
+	///		Lower bound as a formatted time.
+	///	</summary>
+	std::string m_strTimeLow;
+
+	///	<summary>
+	///		Upper bound as a formatted time.
+	///	</summary>
+	std::string m_strTimeHigh;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A file holding part of a variable that matches a query, with the
+///		range of indices of the file that lie within the query.
+///	</summary>
+class QueryFileRange {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	QueryFileRange() :
+		m_sFileIx(0)
+	{ }
+
+	///	<summary>
+	///		Convert to JSON.
+	///	</summary>
+	void ToJSON(nlohmann::json & j) const;
+
+public:
+	///	<summary>
+	///		Index of the file in the IndexedDataset.
+	///	</summary>
+	size_t m_sFileIx;
+
+	///	<summary>
+	///		Full path to the file.
+	///	</summary>
+	std::string m_strFilename;
+
+	///	<summary>
+	///		Names of the dimensions of the variable in the file.
+	///	</summary>
+	AxisNameVector m_vecAxisNames;
+
+	///	<summary>
+	///		Start of the range along each dimension.
+	///	</summary>
+	std::vector<long> m_vecStart;
+
+	///	<summary>
+	///		Size of the range along each dimension.
+	///	</summary>
+	std::vector<long> m_vecCount;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Size, modification time and inode of a file, used to detect
+///		files that have changed since they were indexed.
+///	</summary>
+class FileStamp {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	FileStamp() :
+		m_llSize(0),
+		m_llModTime(0),
+		m_ullInode(0)
+	{ }
+
+	///	<summary>
+	///		Populate from the given file.  Returns false if the file
+	///		could not be stat'ed.  Remote files have no inode, and their
+	///		modification time has a resolution of one second.
+	///	</summary>
+	bool FromFile(
+		const std::string & strFilename
+	);
+
+	///	<summary>
+	///		Check whether this stamp has been populated.
+	///	</summary>
+	bool IsValid() const {
+		return (m_ullInode != 0);
+	}
+
+	///	<summary>
+	///		Equality operator.
+	///	</summary>
+	bool operator==(const FileStamp & stamp) const {
+		return (
+			(m_llSize == stamp.m_llSize) &&
+			(m_llModTime == stamp.m_llModTime) &&
+			(m_ullInode == stamp.m_ullInode));
+	}
+
+public:
+	///	<summary>
+	///		File size in bytes.
+	///	</summary>
+	long long m_llSize;
+
+	///	<summary>
+	///		Modification time in nanoseconds since the epoch.
+	///	</summary>
+	long long m_llModTime;
+
+	///	<summary>
+	///		Inode number.
+	///	</summary>
+	unsigned long long m_ullInode;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		An immutable set of key and other attributes shared by the
+///		FileInfo of files whose global attributes are mostly identical.
+///	</summary>
+class FileAttributeBlock {
+
+public:
+	///	<summary>
+	///		Key attributes of the files.
+	///	</summary>
+	AttributeMap m_mapKeyAttributes;
+
+	///	<summary>
+	///		Other attributes of the files.
+	///	</summary>
+	AttributeMap m_mapOtherAttributes;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A class that describes dimension information from a IndexedDataset.
+///	</summary>
+class FileInfo : public DataObjectInfo {
+
+public:
+	///	<summary>
+	///		Allocate from the pool shared by all FileInfo objects.
+	///	</summary>
+	OBJECTPOOL_ALLOCATED(FileInfo)
+
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	FileInfo(
+		const std::string & strFilename
+	) :
+		m_strFilename(strFilename)
+	{ }
+
+public:
+	///	<summary>
+	///		Get all key and other attributes of the file, those of the
+	///		shared block overridden by those of the file.
+	///	</summary>
+	void GetAttributes(
+		AttributeMap & mapKeyAttributes,
+		AttributeMap & mapOtherAttributes
+	) const;
+
+	///	<summary>
+	///		Replace the shared block by a copy of its attributes.
+	///	</summary>
+	void UnshareAttributes();
+
+public:
+	///	<summary>
+	///		File name of this File.
+	///	</summary>
+	std::string m_strFilename;
+
+	///	<summary>
+	///		Stamp of the file when it was indexed.
+	///	</summary>
+	FileStamp m_stamp;
+
+	///	<summary>
+	///		A set of AxisSubAxisPairs stored in this file.
+	///	</summary>
+	AxisSubAxisMap m_mapAxisSubAxis;
+
+	///	<summary>
+	///		Statistics of the values of each variable in this file, if
+	///		they were computed when it was indexed.
+	///	</summary>
+	std::map<std::string, VariableStatistics> m_mapVariableStatistics;
+
+	///	<summary>
+	///		Attributes shared with other files, or NULL.  The key and other
+	///		attributes of a FileInfo with a shared block only hold those
+	///		whose values differ from the block.
+	///	</summary>
+	std::shared_ptr<const FileAttributeBlock> m_pattrblock;
+
+	///	<summary>
+	///		A set of variables stored in this file?
 	///	</summary>
 	//std::vector<LocalVariableInfo> m_vecLocalVariableInfo;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
+///	<summary>
+///		A table of the FileAttributeBlock shared by the files of an
+///		IndexedDataset.  The global attributes of most files of a dataset
+///		differ only in a few values, such as a tracking_id or creation
+///		date, so each FileInfo is given a block with the same attribute
+///		names and keeps only the values that differ from it.  Blocks are
+///		found by the hash of their attribute names, and a file whose
+///		values mostly differ from every candidate starts a new block.
+///	</summary>
+class FileAttributeBlockTable {
+
+public:
+	///	<summary>
+	///		Number of most recent blocks with the same attribute names
+	///		that are compared against a file.
+	///	</summary>
+	static const size_t MaxCandidates = 8;
+
+public:
+	///	<summary>
+	///		Move the attributes of a FileInfo into a shared block, leaving
+	///		those whose values differ from the block in the FileInfo.
+	///	</summary>
+	void Share(
+		FileInfo & fileinfo
+	);
+
+protected:
+	///	<summary>
+	///		Candidate blocks by the hash of their attribute names, most
+	///		recently created last.
+	///	</summary>
+	std::unordered_map<size_t,
+		std::vector< std::shared_ptr<const FileAttributeBlock> > > m_mapBlocks;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		An ordered list of attribute names and values.
+///	</summary>
+typedef std::vector< std::pair<InternedString, InternedString> > AttributeVector;
+
+///	<summary>
+///		A snapshot of the header of a single NcVar.
+///	</summary>
+class VariableHeader {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	VariableHeader() :
+		m_nctype(ncNoType)
+	{ }
+
+	///	<summary>
+	///		Populate from a NcVar in the given NcFile.
+	///	</summary>
+	void FromNcVar(
+		NcFile * ncfile,
+		NcVar * var
+	);
+
+	///	<summary>
+	///		Populate from a variable of a ClassicNcFile, in the same form
+	///		as FromNcVar.
+	///	</summary>
+	void FromClassicNcVar(
+		const ClassicNcFile & ncclassic,
+		const ClassicNcVariable & var
+	);
+
+public:
+	///	<summary>
+	///		Variable name.
+	///	</summary>
+	std::string m_strName;
+
+	///	<summary>
+	///		NcType for the Variable.
+	///	</summary>
+	NcType m_nctype;
+
+	///	<summary>
+	///		Units for the Variable.
+	///	</summary>
+	std::string m_strUnits;
+
+	///	<summary>
+	///		Attributes other than units, in the order they appear in the file.
+	///	</summary>
+	AttributeVector m_vecAttributes;
+
+	///	<summary>
+	///		Names of the dimensions of this Variable.
+	///	</summary>
+	std::vector<std::string> m_vecDimNames;
+
+	///	<summary>
+	///		Storage layout of this Variable.
+	///	</summary>
+	VariableStorage m_storage;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A snapshot of a single dimension and its dimension variable.
+///	</summary>
+class DimensionHeader {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	DimensionHeader() :
+		m_lSize(0),
+		m_fHasVariable(false),
+		m_fSummarized(false)
+	{ }
+
+public:
+	///	<summary>
+	///		Dimension name.
+	///	</summary>
+	std::string m_strName;
+
+	///	<summary>
+	///		Dimension size.
+	///	</summary>
+	long m_lSize;
+
+	///	<summary>
+	///		Flag indicating a dimension variable is present.
+	///	</summary>
+	bool m_fHasVariable;
+
+	///	<summary>
+	///		Header of the dimension variable.
+	///	</summary>
+	VariableHeader m_varheader;
+
+	///	<summary>
+	///		Dimension values, of the type of the dimension variable.
+	///	</summary>
+	TypedValueArray m_values;
+
+	///	<summary>
+	///		Flag indicating the values were summarized while they were
+	///		read, and only m_summary is stored.
+	///	</summary>
+	bool m_fSummarized;
+
+	///	<summary>
+	///		Summary of the values, if m_fSummarized is set.
+	///	</summary>
+	SubAxisSummary m_summary;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A snapshot of everything IndexedDataset needs from a single file,
+///		in a form that can be extracted independently of the index and
+///		merged into it later.
+///	</summary>
+class FileHeader {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	FileHeader() :
+		m_dOpenTime(0.0),
+		m_dHeaderTime(0.0)
+	{ }
+
+	///	<summary>
+	///		Extract the header from the given NetCDF file.  Errors are
+	///		recorded in m_strError and m_exception rather than returned,
+	///		so that they are reported when the header is merged.  The
+	///		values of dimension variables longer than sSummarizeSize are
+	///		summarized as they are read, unless sSummarizeSize is zero.
+	///		If fNativeClassic is set, classic format files are decoded by
+	///		ClassicNcFile and only other files use the NetCDF library.
+	///		Remote files are always decoded by ClassicNcFile if they are
+	///		classic format files, and are otherwise opened by the NetCDF
+	///		library with byte-range access.  If fStatistics is set, the
+	///		values of every variable are also read to compute their
+	///		statistics.
+	///	</summary>
+	void Extract(
+		const std::string & strFilename,
+		size_t sSummarizeSize = 0,
+		bool fNativeClassic = false,
+		bool fStatistics = false
+	);
+
+	///	<summary>
+	///		Extract the header from the given file with ClassicNcFile.
+	///		Returns false, leaving the header empty, if the file is not a
+	///		classic format file or could not be decoded.
+	///	</summary>
+	bool ExtractClassic(
+		const std::string & strFilename,
+		size_t sSummarizeSize,
+		bool fStatistics = false
+	);
+
+	///	<summary>
+	///		Check if this header holds the dimension values required for
+	///		the given summary size.
+	///	</summary>
+	bool HasValuesFor(
+		size_t sSummarizeSize
+	) const;
+
+	///	<summary>
+	///		Check if an error was encountered during extraction.
+	///	</summary>
+	bool HasError() const {
+		return ((m_strError != "") || (m_exception));
+	}
+
+	///	<summary>
+	///		Get the error encountered during extraction, with exceptions
+	///		converted to error strings.
+	///	</summary>
+	std::string GetError() const;
+
+	///	<summary>
+	///		Append a binary representation of this FileHeader to a buffer.
+	///		Exceptions are converted to error strings.
+	///	</summary>
+	void ToBuffer(
+		std::vector<char> & vecBuffer
+	) const;
+
+	///	<summary>
+	///		Read a FileHeader written by ToBuffer starting at position sPos
+	///		in the buffer, and advance sPos past it.
+	///	</summary>
+	void FromBuffer(
+		const std::vector<char> & vecBuffer,
+		size_t & sPos
+	);
+
+	///	<summary>
+	///		Get a hash of the structure of the file: the names of its
+	///		dimensions and variables, their types and dimensions, and the
+	///		names of their attributes.  Sizes and values are not included.
+	///	</summary>
+	unsigned long long GetStructureHash() const;
+
+	///	<summary>
+	///		Get a hash of everything compared across files when the header
+	///		is merged: the structure, and the units, attribute values and
+	///		storage layout of every variable.
+	///	</summary>
+	unsigned long long GetHeaderHash() const;
+
+public:
+	///	<summary>
+	///		Full path to the file.
+	///	</summary>
+	std::string m_strFilename;
+
+	///	<summary>
+	///		Stamp of the file when it was extracted.
+	///	</summary>
+	FileStamp m_stamp;
+
+	///	<summary>
+	///		Error encountered during extraction.
+	///	</summary>
+	std::string m_strError;
+
+	///	<summary>
+	///		Exception thrown during extraction.
+	///	</summary>
+	std::exception_ptr m_exception;
+
+	///	<summary>
+	///		Global attributes of the file.
+	///	</summary>
+	DataObjectInfo m_datainfo;
+
+	///	<summary>
+	///		Dimensions in the file.
+	///	</summary>
+	std::vector<DimensionHeader> m_vecDimensions;
+
+	///	<summary>
+	///		Variables in the file.
+	///	</summary>
+	std::vector<VariableHeader> m_vecVariables;
+
+	///	<summary>
+	///		Statistics of the values of each variable in m_vecVariables,
+	///		or empty if they were not computed.
+	///	</summary>
+	std::vector<VariableStatistics> m_vecStatistics;
+
+	///	<summary>
+	///		Seconds spent opening the file during extraction, or zero if
+	///		the header was not extracted by this process.
+	///	</summary>
+	double m_dOpenTime;
+
+	///	<summary>
+	///		Seconds spent reading the header during extraction, or zero if
+	///		the header was not extracted by this process.
+	///	</summary>
+	double m_dHeaderTime;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		How thoroughly the headers of files are checked for consistency
+///		with the files already indexed.
+///	</summary>
+enum ValidationLevel {
+
+	///	<summary>
+	///		Every file is checked.
+	///	</summary>
+	ValidationLevel_Full,
+
+	///	<summary>
+	///		The first file of each structure and a fixed sample of the
+	///		remaining files, chosen by a hash of their name, are checked.
+	///	</summary>
+	ValidationLevel_Sample,
+
+	///	<summary>
+	///		Files whose headers hash identically to a file already checked
+	///		are trusted, so only the first file of each header is checked.
+	///	</summary>
+	ValidationLevel_None
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A directory of extracted FileHeaders shared across runs.  Entries
+///		are keyed by the device, inode, size and modification time of the
+///		file, so they remain valid when the same file is reached through a
+///		different path and are never reused once the file changes.
+///	</summary>
+class FileHeaderCache {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	FileHeaderCache(
+		const std::string & strCacheDir
+	) :
+		m_strCacheDir(strCacheDir),
+		m_sHits(0),
+		m_sMisses(0)
+	{ }
+
+	///	<summary>
+	///		Create the cache directory if it does not exist.
+	///	</summary>
+	std::string Initialize();
+
+	///	<summary>
+	///		Get the cache key of the given file, or an empty string if the
+	///		file could not be stat'ed.
+	///	</summary>
+	std::string GetKey(
+		const std::string & strFilename
+	) const;
+
+	///	<summary>
+	///		Load the FileHeader with the given key.  Returns false and
+	///		counts a miss if there is no usable entry, including one whose
+	///		values are summarized below sSummarizeSize or one without the
+	///		variable statistics required by fStatistics.
+	///	</summary>
+	bool Load(
+		const std::string & strKey,
+		const std::string & strFilename,
+		size_t sSummarizeSize,
+		bool fStatistics,
+		FileHeader & header
+	);
+
+	///	<summary>
+	///		Check if there is an entry with the given key, without
+	///		reading it.
+	///	</summary>
+	bool Contains(
+		const std::string & strKey
+	) const;
+
+	///	<summary>
+	///		Store a successfully extracted FileHeader under the given key.
+	///	</summary>
+	void Store(
+		const std::string & strKey,
+		const FileHeader & header
+	) const;
+
+	///	<summary>
+	///		Number of headers loaded from the cache.
+	///	</summary>
+	size_t GetHits() const {
+		return m_sHits;
+	}
+
+	///	<summary>
+	///		Number of headers not found in the cache.
+	///	</summary>
+	size_t GetMisses() const {
+		return m_sMisses;
+	}
+
+protected:
+	///	<summary>
+	///		Get the path of the entry with the given key.
+	///	</summary>
+	std::string GetEntryPath(
+		const std::string & strKey
+	) const;
+
+protected:
+	///	<summary>
+	///		Cache directory.
+	///	</summary>
+	std::string m_strCacheDir;
+
+	///	<summary>
+	///		Number of headers loaded from the cache.
+	///	</summary>
+	std::atomic<size_t> m_sHits;
+
+	///	<summary>
+	///		Number of headers not found in the cache.
+	///	</summary>
+	std::atomic<size_t> m_sMisses;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		The structures used to deduplicate files merged into an index,
+///		saved beside the index so that loading the index to extend it
+///		does not rebuild them.  The state is tied to the stamp of the
+///		index file and is ignored once the index changes.
+///	</summary>
+class IndexDedupState {
+
+public:
+	///	<summary>
+	///		Map from axis name to the fingerprint index of its subaxes.
+	///	</summary>
+	typedef std::map<std::string, AxisInfo::SubAxisFingerprintIndex>
+		AxisFingerprintIndexMap;
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	IndexDedupState() :
+		m_sInternedStrings(0),
+		m_eValidationLevel(ValidationLevel_Full)
+	{ }
+
+	///	<summary>
+	///		Get the path of the state saved beside the given index file.
+	///	</summary>
+	static std::string GetPath(
+		const std::string & strIndexFilename
+	);
+
+	///	<summary>
+	///		Write the state to the given file.
+	///	</summary>
+	std::string ToFile(
+		const std::string & strFilename
+	) const;
+
+	///	<summary>
+	///		Read the state from the given file.  Returns false if there is
+	///		no usable state, including one saved for a different version
+	///		of the index file.
+	///	</summary>
+	bool FromFile(
+		const std::string & strFilename,
+		const std::string & strIndexFilename
+	);
+
+	///	<summary>
+	///		Install the fingerprint index of the given axis, and remove it
+	///		from this state.  Returns false, leaving the axis unchanged,
+	///		if the saved index does not cover exactly the subaxes of the
+	///		axis.
+	///	</summary>
+	bool InstallSubAxisIndex(
+		AxisInfo & axisinfo
+	);
+
+public:
+	///	<summary>
+	///		Stamp of the index file the state belongs to.
+	///	</summary>
+	FileStamp m_stampIndex;
+
+	///	<summary>
+	///		Number of strings in the InternedString pool when the state
+	///		was saved.
+	///	</summary>
+	size_t m_sInternedStrings;
+
+	///	<summary>
+	///		Validation level under which m_vecValidatedHashes were found.
+	///	</summary>
+	ValidationLevel m_eValidationLevel;
+
+	///	<summary>
+	///		Structure or header hashes of the files already checked.
+	///	</summary>
+	std::vector<unsigned long long> m_vecValidatedHashes;
+
+	///	<summary>
+	///		Fingerprint index of the subaxes of each axis.
+	///	</summary>
+	AxisFingerprintIndexMap m_mapSubAxisFingerprints;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class FileHeaderExtraction;
+
+class IndexLoadFilter;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A file that could not be indexed and was skipped.
+///	</summary>
+class FailedFile {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	FailedFile(
+		const std::string & strFilename,
+		const std::string & strError,
+		size_t sAttempts
+	) :
+		m_strFilename(strFilename),
+		m_strError(strError),
+		m_sAttempts(sAttempts)
+	{ }
+
+public:
+	///	<summary>
+	///		Full path to the file.
+	///	</summary>
+	std::string m_strFilename;
+
+	///	<summary>
+	///		Error of the last attempt to extract its header.
+	///	</summary>
+	std::string m_strError;
+
+	///	<summary>
+	///		Number of attempts made to extract its header.
+	///	</summary>
+	size_t m_sAttempts;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 ///	<summary>
 ///		A data structure describing a list of files.
 ///	</summary>
 class IndexedDataset {
 
+	friend class IndexedDatasetJSONReader;
+
 public:
 	///	<summary>
 	///		Invalid File index.
@@ -434,49 +2170,484 @@ public:
 	static const size_t InvalidTimeIx;
 
 	///	<summary>
-	///		A value to denote that a dimension has inconsistent sizes
-	///		across files.
+	///		A value to denote that a dimension has inconsistent sizes
+	///		across files.
+	///	</summary>
+	static const long InconsistentDimensionSizes;
+
+public:
+	///	<summary>
+	///		A variable name with the axis names and subaxis ids of one
+	///		entry in its SubAxisToFileIdMap.
+	///	</summary>
+	typedef std::pair<std::string, std::pair<AxisNameVector, SubAxisIdVector> >
+		VariableSubAxisKey;
+
+public:
+	///	<summary>
+	///		With ValidationLevel_Sample, one in this many files of a known
+	///		structure is checked.
+	///	</summary>
+	static const size_t ValidationSampleInterval = 16;
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	IndexedDataset(
+		const std::string & strName
+	) :
+		m_vecFileInfo(true),
+		m_vecVariableInfo(true),
+		m_vecAxisInfo(true),
+		m_fHasQueryIndex(false),
+		m_sThreads(1),
+		m_sPrefetchDepth(0),
+		m_eExtractionSchedule(ExtractionSchedule_Count),
+		m_sSummarizeSize(0),
+		m_fNativeClassic(false),
+		m_fComputeStatistics(false),
+		m_dFileDeadline(0.0),
+		m_sFileRetries(0),
+		m_dRetryBackoff(1.0),
+		m_fSkipFailedFiles(false),
+		m_fWriteSharedFileAttributes(false),
+		m_pgridregistry(NULL),
+		m_eValidationLevel(ValidationLevel_Full),
+		m_sValidatedFiles(0),
+		m_sTrustedFiles(0),
+		m_pcache(NULL),
+		m_fOwnsCache(false),
+		m_fReportProgress(true),
+		m_pspill(NULL),
+		m_fIncremental(false)
+	{ }
+
+	///	<summary>
+	///		Destructor.
+	///	</summary>
+	~IndexedDataset();
+
+private:
+	///	<summary>
+	///		Not copyable, since the index owns its header cache and spill
+	///		file.
+	///	</summary>
+	IndexedDataset(const IndexedDataset &);
+	IndexedDataset & operator=(const IndexedDataset &);
+
+public:
+	///	<summary>
+	///		Set the number of threads used to extract file headers.
+	///	</summary>
+	void SetThreadCount(
+		size_t sThreads
+	) {
+		m_sThreads = (sThreads == 0)?(1):(sThreads);
+	}
+
+	///	<summary>
+	///		Set the number of files whose headers may be extracted ahead of
+	///		the file being merged.  With a single thread a nonzero depth
+	///		extracts headers on a second thread, so that opening the next
+	///		files overlaps the merge.  A depth of zero uses four files per
+	///		thread with more than one thread and no prefetch otherwise.
+	///	</summary>
+	void SetPrefetchDepth(
+		size_t sPrefetchDepth
+	) {
+		m_sPrefetchDepth = sPrefetchDepth;
+	}
+
+	///	<summary>
+	///		Set how the extraction of file headers is distributed over
+	///		threads and ranks.
+	///	</summary>
+	void SetExtractionSchedule(
+		ExtractionSchedule eExtractionSchedule
+	) {
+		m_eExtractionSchedule = eExtractionSchedule;
+	}
+
+	///	<summary>
+	///		Store only a summary of the values of SubAxis longer than
+	///		sSummarizeSize, or of none if it is zero.  Summarized SubAxis
+	///		are equal if their values are identical.
+	///	</summary>
+	void SetSummarizeSize(
+		size_t sSummarizeSize
+	) {
+		m_sSummarizeSize = sSummarizeSize;
+	}
+
+	///	<summary>
+	///		Decode the headers of classic format files without the NetCDF
+	///		library.
+	///	</summary>
+	void SetNativeClassicHeaders(
+		bool fNativeClassic
+	) {
+		m_fNativeClassic = fNativeClassic;
+	}
+
+	///	<summary>
+	///		Read the values of every variable as its file is indexed, and
+	///		record their statistics for each file and variable.
+	///	</summary>
+	void SetComputeStatistics(
+		bool fComputeStatistics
+	) {
+		m_fComputeStatistics = fComputeStatistics;
+	}
+
+	///	<summary>
+	///		Set the number of seconds the header of one file may take to
+	///		be extracted, or zero for no limit.  A file that exceeds the
+	///		deadline is set aside to be retried after the other files,
+	///		and its worker thread is replaced so that the rest of the
+	///		files are not held up.  A thread blocked in the filesystem
+	///		cannot be interrupted, so it is abandoned rather than
+	///		stopped, and the dataset must outlive it.
+	///	</summary>
+	void SetFileDeadline(
+		double dFileDeadline
+	) {
+		m_dFileDeadline = (dFileDeadline > 0.0)?(dFileDeadline):(0.0);
+	}
+
+	///	<summary>
+	///		Set the number of times a file that could not be extracted,
+	///		or exceeded the deadline, is retried.  Retries take place in
+	///		rounds after the other files are merged, waiting dBackoff
+	///		seconds before the first round and twice as long before each
+	///		following round.
+	///	</summary>
+	void SetFileRetries(
+		size_t sFileRetries,
+		double dBackoff
+	) {
+		m_sFileRetries = sFileRetries;
+		m_dRetryBackoff = (dBackoff > 0.0)?(dBackoff):(0.0);
+	}
+
+	///	<summary>
+	///		Skip files that still cannot be extracted after all retries,
+	///		recording them in the list of failed files, rather than
+	///		stopping with an error.
+	///	</summary>
+	void SetSkipFailedFiles(
+		bool fSkipFailedFiles
+	) {
+		m_fSkipFailedFiles = fSkipFailedFiles;
+	}
+
+	///	<summary>
+	///		Get the files skipped since the index was created or the last
+	///		incremental update began.
+	///	</summary>
+	const std::vector<FailedFile> & GetFailedFiles() const {
+		return m_vecFailedFiles;
+	}
+
+	///	<summary>
+	///		Set how thoroughly the headers of files are checked against
+	///		the files already indexed.  Files that are not checked do not
+	///		update the units or attributes of existing axes and variables.
+	///	</summary>
+	void SetValidationLevel(
+		ValidationLevel eValidationLevel
+	) {
+		m_eValidationLevel = eValidationLevel;
+	}
+
+	///	<summary>
+	///		Get the number of files whose headers were checked and trusted
+	///		since the index was created.
+	///	</summary>
+	void GetValidationCounts(
+		size_t & sValidatedFiles,
+		size_t & sTrustedFiles
+	) const {
+		sValidatedFiles = m_sValidatedFiles;
+		sTrustedFiles = m_sTrustedFiles;
+	}
+
+	///	<summary>
+	///		Write the attributes shared by several files once, in a
+	///		"file_attributes" section of JSON and binary indexes that each
+	///		file references by block id.  Other formats write the
+	///		attributes of every file in full.
+	///	</summary>
+	void SetWriteSharedFileAttributes(
+		bool fWriteSharedFileAttributes
+	) {
+		m_fWriteSharedFileAttributes = fWriteSharedFileAttributes;
+	}
+
+	///	<summary>
+	///		Set the registry of shared grids.  Indexes are written with
+	///		references to the grids in the registry in place of their
+	///		values, and references in indexes that are read are resolved
+	///		through it.  The registry must outlive its use.
+	///	</summary>
+	void SetGridRegistry(
+		const GridRegistry * pgridregistry
+	) {
+		m_pgridregistry = pgridregistry;
+	}
+
+	///	<summary>
+	///		Add to the registry the values of every axis made of a single
+	///		SubAxis, which is then shared by all files of the dataset.
+	///		Returns the number of grids added.
+	///	</summary>
+	size_t AddGridsToRegistry(
+		GridRegistry & gridregistry
+	) const;
+
+	///	<summary>
+	///		Record in the Profiler the bytes and number of objects held by
+	///		each structure of the index.  Objects allocated from an
+	///		ObjectPool are counted over all indexes of the process.
+	///	</summary>
+	void RecordMemoryFootprint() const;
+
+	///	<summary>
+	///		Load the values of all summarized SubAxis from their source
+	///		files, so that they are included in the output.
+	///	</summary>
+	std::string LoadSummarizedValues();
+
+	///	<summary>
+	///		Use the given directory as a persistent cache of file headers.
+	///	</summary>
+	std::string SetHeaderCacheDir(
+		const std::string & strCacheDir
+	);
+
+	///	<summary>
+	///		Use the given cache of file headers, which may be shared by
+	///		indexes built concurrently.  The cache must outlive its use.
+	///	</summary>
+	void SetHeaderCache(
+		FileHeaderCache * pcache
+	);
+
+	///	<summary>
+	///		Get the cache of file headers, or NULL if none is in use.
+	///	</summary>
+	FileHeaderCache * GetHeaderCache() const {
+		return m_pcache;
+	}
+
+	///	<summary>
+	///		Set whether progress through the files being indexed is
+	///		reported.  Progress is reported for one set of files at a
+	///		time, so it is turned off for indexes built concurrently.
+	///	</summary>
+	void SetReportProgress(
+		bool fReportProgress
+	) {
+		m_fReportProgress = fReportProgress;
+	}
+
+	///	<summary>
+	///		Write the FileInfo of each indexed file to the given spill file
+	///		rather than keeping it in memory, holding at most sBufferBytes
+	///		of records before they are written.  The "file" section of the
+	///		JSON and binary outputs is streamed back from the spill file.
+	///		Indexes that spill cannot be queried, merged, updated
+	///		incrementally, or written as CSV, XML or mapped indexes.
+	///	</summary>
+	std::string SetFileSpill(
+		const std::string & strSpillFile,
+		size_t sBufferBytes
+	);
+
+	///	<summary>
+	///		Get the number of header cache hits and misses, summed over
+	///		all ranks.  Returns false if no cache is in use.
+	///	</summary>
+	bool GetHeaderCacheCounts(
+		size_t & sHits,
+		size_t & sMisses
+	) const;
+
+	///	<summary>
+	///		Get the number of files in the index.
+	///	</summary>
+	size_t GetFileCount() const;
+
+	///	<summary>
+	///		Get the names of all variables in the index.
+	///	</summary>
+	void GetVariableNames(
+		std::vector<std::string> & vecVariableNames
+	) const {
+		vecVariableNames.clear();
+		LookupVectorHeap<std::string, VariableInfo>::const_iterator itervar =
+			m_vecVariableInfo.begin();
+		for (; itervar != m_vecVariableInfo.end(); itervar++) {
+			vecVariableNames.push_back(itervar.key());
+		}
+	}
+
+	///	<summary>
+	///		Get the VariableInfo associated with a given variable name.
+	///	</summary>
+	const VariableInfo * GetVariableInfo(
+		const std::string & strVariableName
+	) const {
+		LookupVectorHeap<std::string, VariableInfo>::const_iterator itervar =
+			m_vecVariableInfo.find(strVariableName);
+		if (itervar == m_vecVariableInfo.end()) {
+			return NULL;
+		}
+		return (*itervar);
+	}
+
+	///	<summary>
+	///		Get the names of all axes in the index.
+	///	</summary>
+	void GetAxisNames(
+		std::vector<std::string> & vecAxisNames
+	) const {
+		vecAxisNames.clear();
+		LookupVectorHeap<std::string, AxisInfo>::const_iterator iteraxis =
+			m_vecAxisInfo.begin();
+		for (; iteraxis != m_vecAxisInfo.end(); iteraxis++) {
+			vecAxisNames.push_back(iteraxis.key());
+		}
+	}
+
+	///	<summary>
+	///		Get the AxisInfo associated with a given axis name.
+	///	</summary>
+	const AxisInfo * GetAxisInfo(
+		const std::string & strAxisName
+	) const {
+		LookupVectorHeap<std::string, AxisInfo>::const_iterator iteraxis =
+			m_vecAxisInfo.find(strAxisName);
+		if (iteraxis == m_vecAxisInfo.end()) {
+			return NULL;
+		}
+		return (*iteraxis);
+	}
+
+	///	<summary>
+	///		Get the FileInfo with the given index, or NULL if the index is
+	///		out of range or the files have been spilled to disk.
+	///	</summary>
+	const FileInfo * GetFileInfo(
+		size_t sFileIx
+	) const {
+		if ((m_pspill != NULL) || (sFileIx >= m_vecFileInfo.size())) {
+			return NULL;
+		}
+		return m_vecFileInfo[sFileIx];
+	}
+
+	///	<summary>
+	///		Populate from the objects under a remote prefix, as
+	///		PopulateFromFilePath.
+	///	</summary>
+	std::string PopulateFromRemotePath(
+		const std::string & strFilePath,
+		const FileNameFilter & filter,
+		bool fRecurse
+	);
+
+	///	<summary>
+	///		Populate from a search string.
+	///	</summary>
+	std::string PopulateFromSearchString(
+		const std::string & strSearchString
+	);
+
+	///	<summary>
+	///		Populate from the files in a path, and in its subdirectories if
+	///		fRecurse is set, that match one of the comma-separated patterns
+	///		in strFileName and none of those in strExclude.  Directories
+	///		matching strExclude are not walked.  Directories are listed
+	///		concurrently on m_sThreads threads.  An "s3://bucket/prefix/"
+	///		path is listed through the RemoteFileClient.  With several MPI
+	///		ranks the path is listed on rank 0 and all files are indexed in
+	///		one call to IndexVariableData.
+	///	</summary>
+	std::string PopulateFromFilePath(
+		const std::string & strFilePath,
+		const std::string & strFileName,
+		bool fRecurse,
+		const std::string & strExclude = ""
+	);
+
+	///	<summary>
+	///		Populate from a list of files, one path per line, read from
+	///		strFileList or from standard input if it is "-".  A path may be
+	///		followed by its size in bytes and its modification time in
+	///		seconds since the epoch, separated by tabs, which are then
+	///		compared with the index during an incremental update instead
+	///		of stat'ing the file.  Empty lines and lines starting with '#'
+	///		are ignored.  The list is indexed in batches as it is read, or
+	///		in one call with several MPI ranks.
+	///	</summary>
+	std::string PopulateFromFileList(
+		const std::string & strFileList
+	);
+
+	///	<summary>
+	///		Populate from the given list of file paths.
+	///	</summary>
+	std::string PopulateFromFiles(
+		const std::vector<std::string> & vecFilenames
+	);
+
+	///	<summary>
+	///		Begin an incremental update of an index loaded with
+	///		FromJSONFile.  Until EndIncrementalIndex is called, files whose
+	///		stamp is unchanged are skipped and modified files replace their
+	///		previous entry.
 	///	</summary>
-	static const long InconsistentDimensionSizes;
+	void BeginIncrementalIndex();
 
-public:
 	///	<summary>
-	///		Constructor.
+	///		End an incremental update, removing files from the index that
+	///		were not visited since BeginIncrementalIndex.
 	///	</summary>
-	IndexedDataset(
-		const std::string & strName
-	)
-	{ }
+	std::string EndIncrementalIndex();
 
-public:
 	///	<summary>
-	///		Get the VariableInfo associated with a given variable name.
+	///		Set the full paths of files still being written.  During an
+	///		incremental update these keep their previous entry, if any,
+	///		and are otherwise skipped.
 	///	</summary>
-	const VariableInfo * GetVariableInfo(
-		const std::string & strVariableName
-	) const {
-		for (size_t i = 0; i < m_vecVariableInfo.size(); i++) {
-			if (m_vecVariableInfo[i]->m_strName == strVariableName) {
-				return (m_vecVariableInfo[i]);
-			}
-		}
-		return NULL;
+	void SetDeferredFiles(
+		const std::set<std::string> & setFilenames
+	) {
+		m_setDeferredFilenames = setFilenames;
 	}
 
 	///	<summary>
-	///		Populate from a search string.
+	///		Merge another index into this one, as if its files had been
+	///		indexed after those already here.  Its file and subaxis ids are
+	///		renumbered, its subaxes are shared with equal subaxes found
+	///		through the fingerprint index, and the subaxis maps of its
+	///		variables are added to those here, keeping existing entries.
+	///		A file already in this index under the same name is not added
+	///		again.
 	///	</summary>
-	std::string PopulateFromSearchString(
-		const std::string & strSearchString
+	std::string Merge(
+		const IndexedDataset & dataset
 	);
 
 	///	<summary>
-	///		Populate from a path.
+	///		Populate by merging the given index files in order, loading
+	///		them and merging pairs of them as a reduction tree on
+	///		m_sThreads threads.  Files ending in ".cbor" or ".msgpack" are
+	///		read as CBOR or MessagePack, and others as JSON.
 	///	</summary>
-	std::string PopulateFromFilePath(
-		const std::string & strFilePath,
-		const std::string & strFileName,
-		bool fRecurse
+	std::string MergeFromFiles(
+		const std::vector<std::string> & vecFilenames
 	);
 
 public:
@@ -496,68 +2667,436 @@ public:
 	}
 */
 	///	<summary>
-	///		Load the data from a particular variable into the given array.
+	///		Resolve a range of indices along each dimension of a variable
+	///		to hyperslabs of the files that hold it.  Indices along the
+	///		axis of the time index are indices of m_vecTimes, which
+	///		requires that axis to be the first dimension; indices along
+	///		other axes are indices of the subaxes shared by those files.
+	///		Variables without the time axis must be held by one file.
+	///		Consecutive times in the same file share a hyperslab.
+	///	</summary>
+	std::string FindHyperslabs(
+		const std::string & strVariableName,
+		const std::vector<AxisIndexRange> & vecRanges,
+		std::vector<FileHyperslab> & vecHyperslabs
+	) const;
+
+	///	<summary>
+	///		Build the interval index of each axis and the map from file
+	///		ids to file indices used by Query.  Call once the index is
+	///		complete.
+	///	</summary>
+	std::string BuildQueryIndex();
+
+	///	<summary>
+	///		Find the files holding the given variable within the given
+	///		ranges of coordinates, and the range of indices of each file
+	///		that lies within them.  Axes without a range are not
+	///		restricted.  Values of a subaxis are assumed monotonic, so
+	///		that the indices within a range are contiguous.
+	///	</summary>
+	std::string Query(
+		const std::string & strVariableName,
+		const std::vector<QueryAxisRange> & vecRanges,
+		std::vector<QueryFileRange> & vecResults
+	) const;
+
+	///	<summary>
+	///		Load a range of indices along each dimension of a variable
+	///		into a row-major array, with one read per hyperslab.  The data
+	///		is allocated with the DataArrayPolicy of the array, and an array
+	///		already holding data of the same shape is reused.
 	///	</summary>
 	std::string LoadData_float(
 		const std::string & strVariableName,
-		const std::vector<long> & vecAuxIndices,
+		const std::vector<AxisIndexRange> & vecRanges,
 		DataArray1D<float> & data
 	);
 
 	///	<summary>
-	///		Write the data from the given array to disk.
+	///		Load a range of indices along each dimension of a variable
+	///		with two dimensions.
+	///	</summary>
+	std::string LoadData_float(
+		const std::string & strVariableName,
+		const std::vector<AxisIndexRange> & vecRanges,
+		DataArray2D<float> & data
+	);
+
+	///	<summary>
+	///		Load a range of indices along each dimension of a variable
+	///		with three dimensions.
+	///	</summary>
+	std::string LoadData_float(
+		const std::string & strVariableName,
+		const std::vector<AxisIndexRange> & vecRanges,
+		DataArray3D<float> & data
+	);
+
+	///	<summary>
+	///		Add a range of indices along each dimension of a variable, in
+	///		row-major order as loaded by LoadData_float, to a batch of
+	///		writes into the files holding them.  Nothing is written until
+	///		the batch is flushed, so that writes of many slices are grouped
+	///		by file and chunk.
+	///	</summary>
+	std::string WriteData_float(
+		const std::string & strVariableName,
+		const std::vector<AxisIndexRange> & vecRanges,
+		const DataArray1D<float> & data,
+		NcWriteBatch & batch
+	) const;
+
+	///	<summary>
+	///		Write a range of indices along each dimension of a variable,
+	///		in row-major order as loaded by LoadData_float, into the files
+	///		holding them.
 	///	</summary>
 	std::string WriteData_float(
 		const std::string & strVariableName,
-		const std::vector<long> & vecAuxIndices,
+		const std::vector<AxisIndexRange> & vecRanges,
 		const DataArray1D<float> & data
-	);
+	) const;
 
 protected:
 	///	<summary>
-	///		Sort the array of Times to keep m_vecTimes in
-	///		chronological order.
+	///		Call fnTask(i) for each i in [0, sTasks) on up to m_sThreads
+	///		threads.
+	///	</summary>
+	void RunTasks(
+		size_t sTasks,
+		const std::function<void(size_t)> & fnTask
+	) const;
+
+	///	<summary>
+	///		Load the variables of the shard files of a sharded JSON
+	///		manifest in parallel.  Each shard is listed with the names of
+	///		the variables it holds.  If pfilter is not NULL only the shards
+	///		holding variables it selects are read, and only those
+	///		variables are loaded from them.
+	///	</summary>
+	std::string LoadJSONShards(
+		const std::string & strJSONManifestFilename,
+		const std::vector< std::pair<std::string, std::vector<std::string> > > & vecShards,
+		const IndexLoadFilter * pfilter = NULL
+	);
+
+	///	<summary>
+	///		Read hyperslabs of a variable into a row-major array.
 	///	</summary>
-	void SortTimeArray();
+	std::string ReadHyperslabs_float(
+		const std::string & strVariableName,
+		const std::vector<FileHyperslab> & vecHyperslabs,
+		float * pData
+	) const;
 
 	///	<summary>
-	///		Index variable data.
+	///		Index variable data.  During an incremental update, files with
+	///		a stamp in pvecListedStamps whose m_llSize is not negative are
+	///		compared by size and modification time without being stat'ed.
 	///	</summary>
 	std::string IndexVariableData(
 		const std::string & strBaseDir,
-		const std::vector<std::string> & strFilenames
+		const std::vector<std::string> & strFilenames,
+		const std::vector<FileStamp> * pvecListedStamps = NULL
+	);
+
+	///	<summary>
+	///		Get the size in bytes of files [sBegin, sEnd) of vecFilenames
+	///		into vecFileBytes[0, sEnd - sBegin), negative if unknown, from
+	///		pvecStamps if given and otherwise from stat'ing them on
+	///		m_sThreads threads, and whether their headers are cached into
+	///		vecCached.  These are the inputs of
+	///		ExtractionScheduler::EstimateCosts.
+	///	</summary>
+	void StatExtractionFiles(
+		const std::string & strBaseDir,
+		const std::vector<std::string> & vecFilenames,
+		const std::vector<FileStamp> * pvecStamps,
+		size_t sBegin,
+		size_t sEnd,
+		std::vector<long long> & vecFileBytes,
+		std::vector<char> & vecCached
+	);
+
+	///	<summary>
+	///		Obtain the header of the given file, from the header cache if
+	///		possible.
+	///	</summary>
+	void LoadFileHeader(
+		const std::string & strFilename,
+		bool fPrefetch,
+		FileHeader & header
+	);
+
+	///	<summary>
+	///		Extract the given headers and pass them in order to fnConsume,
+	///		then retry those that failed or exceeded the deadline in rounds
+	///		with a doubling backoff.  Extractions that still fail after all
+	///		retries are returned in vecFailed.
+	///	</summary>
+	std::string ExtractFileHeadersWithRetries(
+		std::vector< std::shared_ptr<FileHeaderExtraction> > & vecExtractions,
+		const std::function<std::string(FileHeaderExtraction &)> & fnConsume,
+		std::vector< std::shared_ptr<FileHeaderExtraction> > & vecFailed
+	);
+
+	///	<summary>
+	///		Extract the given headers, on a pool of worker threads if more
+	///		than one thread, prefetching or a file deadline is requested,
+	///		and pass them in order to fnConsume.  If a deadline, retries or
+	///		skipping is requested, extractions that fail or exceed the
+	///		deadline are appended to vecFailed instead.
+	///	</summary>
+	std::string ExtractAndConsumeFileHeaders(
+		const std::vector< std::shared_ptr<FileHeaderExtraction> > & vecExtractions,
+		const std::function<std::string(FileHeaderExtraction &)> & fnConsume,
+		std::vector< std::shared_ptr<FileHeaderExtraction> > & vecFailed
+	);
+
+	///	<summary>
+	///		Join abandoned workers whose extraction has completed, or all
+	///		abandoned workers if fWait is set.
+	///	</summary>
+	void JoinAbandonedWorkers(
+		bool fWait
+	);
+
+	///	<summary>
+	///		Record extractions that failed after all retries as failed
+	///		files, or return the error of the first if they are not to be
+	///		skipped.
+	///	</summary>
+	std::string SkipFailedFiles(
+		const std::vector< std::shared_ptr<FileHeaderExtraction> > & vecFailed
+	);
+
+#if defined(HYPERION_MPIOMP)
+	///	<summary>
+	///		Index variable data with the file list split across all MPI
+	///		ranks.  Headers are streamed to rank 0 in chunks of records in
+	///		filename order and merged there as they arrive.  Each
+	///		rank applies the file deadline and retries to its own files,
+	///		and files that still fail are skipped or reported on rank 0.
+	///	</summary>
+	std::string IndexVariableDataDistributed(
+		const std::string & strBaseDir,
+		const std::vector<std::string> & strFilenames,
+		const std::vector<FileStamp> * pvecStamps
+	);
+#endif
+
+	///	<summary>
+	///		Merge an extracted FileHeader into the index.
+	///	</summary>
+	std::string MergeFileHeader(
+		FileHeader & header
+	);
+
+	///	<summary>
+	///		Check if the given header is to be checked for consistency with
+	///		the files already indexed under the validation level.
+	///	</summary>
+	bool SelectForValidation(
+		const FileHeader & header
+	);
+
+	///	<summary>
+	///		Remove all references to the given file ids from variables.
+	///		During an incremental update the removed entries are recorded
+	///		in m_setOrphanedKeys, and the statistics of the files are
+	///		dropped from those of the variables.
+	///	</summary>
+	void RemoveFileReferences(
+		const std::set<std::string> & setFileIds
+	);
+
+	///	<summary>
+	///		Recompute the statistics of every variable from the statistics
+	///		recorded for each file.
+	///	</summary>
+	void RebuildVariableStatistics();
+
+	///	<summary>
+	///		Read the deduplication state saved beside the given index file
+	///		into state, and restore the parts of it used before the index
+	///		is read.  Returns false if there is no usable state.
+	///	</summary>
+	bool LoadDedupState(
+		const std::string & strIndexFilename,
+		IndexDedupState & state
+	);
+
+	///	<summary>
+	///		Find files not yet in setTriedFilenames that may have been
+	///		shadowed by entries in m_setOrphanedKeys, since only the first
+	///		file with a given set of subaxes is referenced by a variable.
+	///	</summary>
+	void FindShadowedFiles(
+		std::set<std::string> & setTriedFilenames,
+		std::vector<std::string> & vecFilenames
+	);
+
+	///	<summary>
+	///		Remove the given files from the index, along with any subaxes,
+	///		axes and variables that are no longer referenced, and
+	///		renumber the remaining file and subaxis ids.
+	///	</summary>
+	void CompactIndex(
+		const std::set<std::string> & setRemovedFileIds
 	);
 
 public:
 	///	<summary>
-	///		Output the time-variable index as a CSV.
+	///		Build the chronologically sorted array of Times on the given
+	///		axis across all files, and the map from each Time to the file
+	///		and time index of every variable on that axis.  The units and
+	///		calendar of each subaxis are parsed once and its values are
+	///		converted to integer keys, which are sorted and merged.
+	///	</summary>
+	std::string BuildTimeIndex(
+		const std::string & strTimeAxisName
+	);
+
+	///	<summary>
+	///		Build the dense lookups from subaxis ids to file ids of every
+	///		variable suited to one; see SubAxisToFileIdMap.  Call once the
+	///		index is complete, since merging more files drops them.
+	///		Returns the number of dense lookups.
+	///	</summary>
+	size_t BuildFileIdLookups();
+
+	///	<summary>
+	///		Get the array of Times built by BuildTimeIndex.
+	///	</summary>
+	const std::vector<Time> & GetTimes() const {
+		return m_vecTimes;
+	}
+
+	///	<summary>
+	///		Output the time-variable index built by BuildTimeIndex as a
+	///		CSV, streamed one row at a time.  By default this is a matrix
+	///		with a row per time and a column per variable; if fRunLength
+	///		is set, each row instead holds a contiguous range of times
+	///		available for a variable, so gaps appear between rows.
 	///	</summary>
 	std::string OutputTimeVariableIndexCSV(
-		const std::string & strCSVOutput
+		const std::string & strCSVOutput,
+		bool fRunLength = false
 	);
 
 	///	<summary>
-	///		Output the indexed dataset as a XML file.
+	///		Output the indexed dataset as a XML file, compressed if the
+	///		file name ends in ".gz" or ".zst".
 	///	</summary>
 	std::string ToXMLFile(
 		const std::string & strXMLOutputFilename
 	) const;
 
 	///	<summary>
-	///		Read the indexed dataset from a JSON file.
+	///		Load only the given variables, and the files, axes and subaxes
+	///		they reference, from indexes read by FromJSONFile,
+	///		FromBinaryFile and MergeFromFiles.  The index is then read in
+	///		two passes, and it is an error if a variable is not in it.
+	///		Files keep only their axes that are loaded.  No variables
+	///		loads all of them.
+	///	</summary>
+	void SetLoadedVariables(
+		const std::set<std::string> & setVariables
+	) {
+		m_setLoadedVariables = setVariables;
+	}
+
+	///	<summary>
+	///		Read the indexed dataset from a JSON file, which may be gzip or
+	///		Zstandard compressed.
 	///	</summary>
 	std::string FromJSONFile(
 		const std::string & strJSONInputFilename
 	);
 
 	///	<summary>
-	///		Output the indexed dataset as a JSON file.
+	///		Output the indexed dataset as a JSON file, compressed if the
+	///		file name ends in ".gz" or ".zst".
 	///	</summary>
 	std::string ToJSONFile(
 		const std::string & strJSONOutputFilename,
 		bool fPrettyPrint = true
 	) const;
 
+	///	<summary>
+	///		Output the indexed dataset as a JSON manifest holding the
+	///		"axes", "dataset" and "file" sections, and a set of shard files
+	///		each holding the "variables" section for sVariablesPerShard
+	///		variables.  The shards are written in parallel on m_sThreads
+	///		threads and are listed in the "shards" section of the manifest
+	///		by file name, relative to the directory of the manifest.  Shard
+	///		file names are strShardBasename, or strJSONOutputFilename
+	///		without its ".json" extension if empty, followed by
+	///		".shardNNNN.json".  Shards are compressed like the manifest
+	///		and carry its ".gz" or ".zst" extension.  FromJSONFile reads
+	///		the manifest and its shards.
+	///	</summary>
+	std::string ToShardedJSONFile(
+		const std::string & strJSONOutputFilename,
+		size_t sVariablesPerShard,
+		bool fPrettyPrint = true,
+		const std::string & strShardBasename = ""
+	) const;
+
+	///	<summary>
+	///		Read the indexed dataset from a CBOR or MessagePack file with
+	///		the same schema as a JSON file.
+	///	</summary>
+	std::string FromBinaryFile(
+		const std::string & strInputFilename,
+		BinaryIndexFormat eFormat
+	);
+
+	///	<summary>
+	///		Output the indexed dataset as a CBOR or MessagePack file with
+	///		the same schema as a JSON file.  Coordinate values are written
+	///		as typed arrays.
+	///	</summary>
+	std::string ToBinaryFile(
+		const std::string & strOutputFilename,
+		BinaryIndexFormat eFormat
+	) const;
+
+	///	<summary>
+	///		Save the state used to deduplicate files merged into the index
+	///		(see IndexDedupState) beside an index file already written by
+	///		ToJSONFile, ToShardedJSONFile or ToBinaryFile.  FromJSONFile
+	///		and FromBinaryFile restore it in place of rebuilding it while
+	///		the index file is unchanged.
+	///	</summary>
+	std::string ToDedupStateFile(
+		const std::string & strIndexFilename
+	) const;
+
+	///	<summary>
+	///		Output the indexed dataset as a memory-mappable index file,
+	///		which can be queried in place with MappedIndex.
+	///	</summary>
+	std::string ToMappedIndexFile(
+		const std::string & strOutputFilename
+	) const;
+
+	///	<summary>
+	///		Output the location of every chunk of every variable of the
+	///		indexed files (see FileChunkReferences).  Each entry of the
+	///		"file" section of the index is repeated under the same file id
+	///		with a Kerchunk reference set of the file in "refs", so that
+	///		the subaxis maps of a variable lead directly to byte ranges of
+	///		its data.  Files are read on m_sThreads threads; files that
+	///		cannot be read are recorded with an "error" and counted in
+	///		sFailedFiles.
+	///	</summary>
+	std::string OutputChunkReferences(
+		const std::string & strOutputFilename,
+		size_t & sFailedFiles
+	) const;
+
 protected:
 	///	<summary>
 	///		The DataObjectInfo describing this global dataset.
@@ -583,6 +3122,177 @@ protected:
 	///		Information on axes that appear in the IndexedDataset.
 	///	</summary>
 	LookupVectorHeap<std::string, AxisInfo> m_vecAxisInfo;
+
+	///	<summary>
+	///		Name of the axis used by the time index.
+	///	</summary>
+	std::string m_strTimeAxisName;
+
+	///	<summary>
+	///		Chronologically sorted Times on the time axis.
+	///	</summary>
+	std::vector<Time> m_vecTimes;
+
+	///	<summary>
+	///		Flag indicating BuildQueryIndex has been called.
+	///	</summary>
+	bool m_fHasQueryIndex;
+
+	///	<summary>
+	///		Map from file id to index in m_vecFileInfo, filled by
+	///		BuildQueryIndex.
+	///	</summary>
+	std::unordered_map<IndexId, size_t> m_mapQueryFileIx;
+
+	///	<summary>
+	///		Number of threads used to extract file headers.
+	///	</summary>
+	size_t m_sThreads;
+
+	///	<summary>
+	///		Number of file headers extracted ahead of the merge, or zero
+	///		for the default.
+	///	</summary>
+	size_t m_sPrefetchDepth;
+
+	///	<summary>
+	///		How the extraction of file headers is distributed.
+	///	</summary>
+	ExtractionSchedule m_eExtractionSchedule;
+
+	///	<summary>
+	///		Size above which SubAxis values are summarized, or zero.
+	///	</summary>
+	size_t m_sSummarizeSize;
+
+	///	<summary>
+	///		Flag indicating classic format headers are decoded without the
+	///		NetCDF library.
+	///	</summary>
+	bool m_fNativeClassic;
+
+	///	<summary>
+	///		Flag indicating the statistics of variables are computed as
+	///		files are indexed.
+	///	</summary>
+	bool m_fComputeStatistics;
+
+	///	<summary>
+	///		Seconds the header of one file may take to be extracted, or
+	///		zero for no limit.
+	///	</summary>
+	double m_dFileDeadline;
+
+	///	<summary>
+	///		Number of times a failed file is retried, and seconds waited
+	///		before the first retry.
+	///	</summary>
+	size_t m_sFileRetries;
+	double m_dRetryBackoff;
+
+	///	<summary>
+	///		Flag indicating files that cannot be extracted are skipped.
+	///	</summary>
+	bool m_fSkipFailedFiles;
+
+	///	<summary>
+	///		Files that were skipped.
+	///	</summary>
+	std::vector<FailedFile> m_vecFailedFiles;
+
+	///	<summary>
+	///		Workers abandoned on a file past its deadline, with the
+	///		extraction they are working on.  They use this dataset, so
+	///		they are joined once done and before it is destroyed.
+	///	</summary>
+	std::vector< std::pair< std::thread, std::shared_ptr<FileHeaderExtraction> > >
+		m_vecAbandonedWorkers;
+
+	///	<summary>
+	///		Variables loaded from indexes, or empty to load all.
+	///	</summary>
+	std::set<std::string> m_setLoadedVariables;
+
+	///	<summary>
+	///		Blocks of attributes shared by the files of the dataset.
+	///	</summary>
+	FileAttributeBlockTable m_fileattrblocks;
+
+	///	<summary>
+	///		Flag indicating shared file attributes are written once.
+	///	</summary>
+	bool m_fWriteSharedFileAttributes;
+
+	///	<summary>
+	///		Registry of shared grids, or NULL.
+	///	</summary>
+	const GridRegistry * m_pgridregistry;
+
+	///	<summary>
+	///		How thoroughly file headers are checked.
+	///	</summary>
+	ValidationLevel m_eValidationLevel;
+
+	///	<summary>
+	///		Structure hashes, or header hashes, of files already checked.
+	///	</summary>
+	std::unordered_set<unsigned long long> m_setValidatedHashes;
+
+	///	<summary>
+	///		Number of files whose headers were checked and trusted.
+	///	</summary>
+	size_t m_sValidatedFiles;
+	size_t m_sTrustedFiles;
+
+	///	<summary>
+	///		Persistent cache of file headers, or NULL if not in use.
+	///	</summary>
+	FileHeaderCache * m_pcache;
+
+	///	<summary>
+	///		Flag indicating m_pcache is deleted with the index.
+	///	</summary>
+	bool m_fOwnsCache;
+
+	///	<summary>
+	///		Flag indicating progress through the files being indexed is
+	///		reported.
+	///	</summary>
+	bool m_fReportProgress;
+
+	///	<summary>
+	///		Spill file of the FileInfo of each file, or NULL if they are
+	///		kept in m_vecFileInfo.
+	///	</summary>
+	FileInfoSpill * m_pspill;
+
+	///	<summary>
+	///		Flag indicating an incremental update is in progress.
+	///	</summary>
+	bool m_fIncremental;
+
+	///	<summary>
+	///		Map from full filename to file id for files indexed before
+	///		the incremental update that have not yet been visited.
+	///	</summary>
+	std::map<std::string, std::string> m_mapIncrementalFileIds;
+
+	///	<summary>
+	///		File ids indexed before the incremental update that have not
+	///		been found unchanged.
+	///	</summary>
+	std::set<std::string> m_setStaleFileIds;
+
+	///	<summary>
+	///		Variable entries removed during the incremental update.
+	///	</summary>
+	std::set<VariableSubAxisKey> m_setOrphanedKeys;
+
+	///	<summary>
+	///		Files skipped by incremental updates since they are still
+	///		being written.
+	///	</summary>
+	std::set<std::string> m_setDeferredFilenames;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    InternedString.cpp
+///	\version October 14, 2026
+///
+
+#include "InternedString.h"
+
+#include <unordered_map>
+#include <mutex>
+#include <tuple>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		The global string pool.  Handles point at nodes of the map, which
+///		are stable under rehashing.  Interning may happen on the header
+///		extraction threads, so the map is guarded by a mutex; counts of
+///		handles are atomic so that copies need not take it.  The pool is
+///		never destroyed, so that static handles may outlive it.
+///	</summary>
+class InternedStringPool {
+
+public:
+	///	<summary>
+	///		Get the pool.
+	///	</summary>
+	static InternedStringPool & Get() {
+		static InternedStringPool * s_ppool = new InternedStringPool;
+		return (*s_ppool);
+	}
+
+public:
+	///	<summary>
+	///		Mutex guarding the pool.
+	///	</summary>
+	std::mutex m_mutex;
+
+	///	<summary>
+	///		Pooled strings and the number of handles to each.
+	///	</summary>
+	std::unordered_map<std::string, std::atomic<size_t> > m_mapStrings;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+InternedString::Entry * InternedString::Intern(
+	const std::string & str
+) {
+	if (str.length() == 0) {
+		return NULL;
+	}
+	InternedStringPool & pool = InternedStringPool::Get();
+	std::lock_guard<std::mutex> lock(pool.m_mutex);
+	Entry & entry =
+		*(pool.m_mapStrings.emplace(
+			std::piecewise_construct,
+			std::forward_as_tuple(str),
+			std::forward_as_tuple(0)).first);
+	entry.second.fetch_add(1, std::memory_order_relaxed);
+	return &entry;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InternedString::Release(
+	Entry * pentry
+) {
+	// Other handles remain, so the string stays pooled
+	size_t sCount = pentry->second.load(std::memory_order_relaxed);
+	while (sCount > 1) {
+		if (pentry->second.compare_exchange_weak(
+			sCount, sCount - 1, std::memory_order_acq_rel)
+		) {
+			return;
+		}
+	}
+
+	// Possibly the last handle; only Intern can add a handle now, and it
+	// holds the mutex
+	InternedStringPool & pool = InternedStringPool::Get();
+	std::lock_guard<std::mutex> lock(pool.m_mutex);
+	if (pentry->second.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		pool.m_mapStrings.erase(pentry->first);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const std::string & InternedString::EmptyString() {
+	static const std::string s_strEmpty;
+	return s_strEmpty;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t InternedString::PoolSize() {
+	InternedStringPool & pool = InternedStringPool::Get();
+	std::lock_guard<std::mutex> lock(pool.m_mutex);
+	return pool.m_mapStrings.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InternedString::ReservePool(
+	size_t sStrings
+) {
+	InternedStringPool & pool = InternedStringPool::Get();
+	std::lock_guard<std::mutex> lock(pool.m_mutex);
+	pool.m_mapStrings.reserve(sStrings);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t InternedString::PoolBytes() {
+	InternedStringPool & pool = InternedStringPool::Get();
+	std::lock_guard<std::mutex> lock(pool.m_mutex);
+
+	// Each node holds the string, the count, a next pointer and the
+	// cached hash; strings of up to 15 characters are stored inline
+	size_t sBytes = pool.m_mapStrings.bucket_count() * sizeof(void *);
+	for (auto iter = pool.m_mapStrings.begin(); iter != pool.m_mapStrings.end(); iter++) {
+		sBytes += sizeof(Entry) + 2 * sizeof(void *);
+		if (iter->first.capacity() > 15) {
+			sBytes += iter->first.capacity() + 1;
+		}
+	}
+	return sBytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,279 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    InternedString.h
+///	\version October 14, 2026
+///
+
+#ifndef _INTERNEDSTRING_H_
+#define _INTERNEDSTRING_H_
+
+#include <string>
+#include <functional>
+#include <atomic>
+#include <utility>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A handle to a string stored once in a global pool.  Equal strings
+///		share the same handle, so equality is a pointer comparison, and
+///		copies cost a pointer and an atomic increment.  Ordering is
+///		lexicographic, as for std::string.  Pooled strings are counted
+///		and freed when their last handle is destroyed; the empty string
+///		is not pooled.
+///	</summary>
+class InternedString {
+
+public:
+	///	<summary>
+	///		A pooled string and the number of handles to it.
+	///	</summary>
+	typedef std::pair<const std::string, std::atomic<size_t> > Entry;
+
+public:
+	///	<summary>
+	///		Constructor for the empty string.
+	///	</summary>
+	InternedString() :
+		m_pentry(NULL)
+	{ }
+
+	///	<summary>
+	///		Constructor from a std::string.
+	///	</summary>
+	InternedString(
+		const std::string & str
+	) :
+		m_pentry(Intern(str))
+	{ }
+
+	///	<summary>
+	///		Constructor from a null-terminated string.
+	///	</summary>
+	InternedString(
+		const char * sz
+	) :
+		m_pentry(Intern(std::string(sz)))
+	{ }
+
+	///	<summary>
+	///		Copy constructor.
+	///	</summary>
+	InternedString(
+		const InternedString & str
+	) :
+		m_pentry(str.m_pentry)
+	{
+		if (m_pentry != NULL) {
+			m_pentry->second.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	///	<summary>
+	///		Move constructor.
+	///	</summary>
+	InternedString(
+		InternedString && str
+	) :
+		m_pentry(str.m_pentry)
+	{
+		str.m_pentry = NULL;
+	}
+
+	///	<summary>
+	///		Destructor.
+	///	</summary>
+	~InternedString() {
+		if (m_pentry != NULL) {
+			Release(m_pentry);
+		}
+	}
+
+	///	<summary>
+	///		Assignment operator.
+	///	</summary>
+	InternedString & operator=(
+		const InternedString & str
+	) {
+		InternedString strCopy(str);
+		std::swap(m_pentry, strCopy.m_pentry);
+		return (*this);
+	}
+
+	///	<summary>
+	///		Move assignment operator.
+	///	</summary>
+	InternedString & operator=(
+		InternedString && str
+	) {
+		std::swap(m_pentry, str.m_pentry);
+		return (*this);
+	}
+
+public:
+	///	<summary>
+	///		Get the pooled string.
+	///	</summary>
+	const std::string & str() const {
+		return (m_pentry != NULL)?(m_pentry->first):(EmptyString());
+	}
+
+	///	<summary>
+	///		Conversion to the pooled string.
+	///	</summary>
+	operator const std::string & () const {
+		return str();
+	}
+
+	///	<summary>
+	///		Get a null-terminated version of the string.
+	///	</summary>
+	const char * c_str() const {
+		return str().c_str();
+	}
+
+	///	<summary>
+	///		Length of the string.
+	///	</summary>
+	size_t length() const {
+		return (m_pentry != NULL)?(m_pentry->first.length()):(0);
+	}
+
+public:
+	///	<summary>
+	///		Equality operator.
+	///	</summary>
+	bool operator==(const InternedString & str) const {
+		return (m_pentry == str.m_pentry);
+	}
+
+	///	<summary>
+	///		Inequality operator.
+	///	</summary>
+	bool operator!=(const InternedString & str) const {
+		return (m_pentry != str.m_pentry);
+	}
+
+	///	<summary>
+	///		Equality operator with a string that need not be pooled.
+	///	</summary>
+	bool operator==(const std::string & str) const {
+		return (this->str() == str);
+	}
+
+	///	<summary>
+	///		Inequality operator with a string that need not be pooled.
+	///	</summary>
+	bool operator!=(const std::string & str) const {
+		return (this->str() != str);
+	}
+
+	///	<summary>
+	///		Equality operator with a null-terminated string.
+	///	</summary>
+	bool operator==(const char * sz) const {
+		return (str() == sz);
+	}
+
+	///	<summary>
+	///		Inequality operator with a null-terminated string.
+	///	</summary>
+	bool operator!=(const char * sz) const {
+		return (str() != sz);
+	}
+
+	///	<summary>
+	///		Less-than operator.
+	///	</summary>
+	bool operator<(const InternedString & str) const {
+		return ((m_pentry != str.m_pentry) && (this->str() < str.str()));
+	}
+
+	///	<summary>
+	///		Get a hash of this handle.
+	///	</summary>
+	size_t hash() const {
+		return std::hash<const Entry *>()(m_pentry);
+	}
+
+public:
+	///	<summary>
+	///		Get the number of distinct strings in the pool.
+	///	</summary>
+	static size_t PoolSize();
+
+	///	<summary>
+	///		Estimate the bytes of memory used by the pool.
+	///	</summary>
+	static size_t PoolBytes();
+
+	///	<summary>
+	///		Reserve room in the pool for the given number of strings, so
+	///		that interning them does not rehash the pool.
+	///	</summary>
+	static void ReservePool(
+		size_t sStrings
+	);
+
+protected:
+	///	<summary>
+	///		Get the empty string.
+	///	</summary>
+	static const std::string & EmptyString();
+
+	///	<summary>
+	///		Find or insert a string in the pool and count a handle to it,
+	///		or return NULL for the empty string.
+	///	</summary>
+	static Entry * Intern(
+		const std::string & str
+	);
+
+	///	<summary>
+	///		Release a handle to a pooled string, removing it from the pool
+	///		if it was the last.
+	///	</summary>
+	static void Release(
+		Entry * pentry
+	);
+
+protected:
+	///	<summary>
+	///		Pointer to the pooled string, or NULL for the empty string.
+	///	</summary>
+	Entry * m_pentry;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline bool operator==(const std::string & str1, const InternedString & str2) {
+	return (str2 == str1);
+}
+
+inline bool operator!=(const std::string & str1, const InternedString & str2) {
+	return (str2 != str1);
+}
+
+inline std::string operator+(const std::string & str1, const InternedString & str2) {
+	return (str1 + str2.str());
+}
+
+inline std::string operator+(const InternedString & str1, const std::string & str2) {
+	return (str1.str() + str2);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace std {
+	template <>
+	struct hash<InternedString> {
+		size_t operator()(const InternedString & str) const {
+			return str.hash();
+		}
+	};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
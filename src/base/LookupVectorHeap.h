@@ -10,6 +10,111 @@
 
 #include <vector>
 #include <map>
+#include <string>
+#include <cstring>
+#include <functional>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A non-owning reference to a character string, used to look up
+///		std::string keys without constructing a std::string.
+///	</summary>
+class LookupStringRef {
+
+public:
+	///	<summary>
+	///		Constructor from a null-terminated string.
+	///	</summary>
+	explicit LookupStringRef(
+		const char * sz
+	) :
+		m_sz(sz),
+		m_sLength(strlen(sz))
+	{ }
+
+	///	<summary>
+	///		Constructor from a character array and length.
+	///	</summary>
+	LookupStringRef(
+		const char * sz,
+		size_t sLength
+	) :
+		m_sz(sz),
+		m_sLength(sLength)
+	{ }
+
+	///	<summary>
+	///		Constructor from a std::string.
+	///	</summary>
+	explicit LookupStringRef(
+		const std::string & str
+	) :
+		m_sz(str.data()),
+		m_sLength(str.length())
+	{ }
+
+public:
+	///	<summary>
+	///		Pointer to the first character.
+	///	</summary>
+	const char * m_sz;
+
+	///	<summary>
+	///		Number of characters.
+	///	</summary>
+	size_t m_sLength;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Hash and equality used by the hash index of LookupVectorHeap.
+///	</summary>
+template <typename LookupObject>
+struct LookupTraits {
+	static size_t Hash(const LookupObject & key) {
+		return std::hash<LookupObject>()(key);
+	}
+
+	static bool Equal(const LookupObject & key1, const LookupObject & key2) {
+		return (key1 == key2);
+	}
+};
+
+///	<summary>
+///		Hash and equality for std::string keys, which may also be looked
+///		up by LookupStringRef.
+///	</summary>
+template <>
+struct LookupTraits<std::string> {
+	static size_t Hash(const char * sz, size_t sLength) {
+		unsigned long long ullHash = 14695981039346656037ULL;
+		for (size_t i = 0; i < sLength; i++) {
+			ullHash ^= static_cast<unsigned char>(sz[i]);
+			ullHash *= 1099511628211ULL;
+		}
+		return static_cast<size_t>(ullHash ^ (ullHash >> 32));
+	}
+
+	static size_t Hash(const std::string & key) {
+		return Hash(key.data(), key.length());
+	}
+
+	static size_t Hash(const LookupStringRef & key) {
+		return Hash(key.m_sz, key.m_sLength);
+	}
+
+	static bool Equal(const std::string & key1, const std::string & key2) {
+		return (key1 == key2);
+	}
+
+	static bool Equal(const std::string & key1, const LookupStringRef & key2) {
+		return (
+			(key1.length() == key2.m_sLength) &&
+			(memcmp(key1.data(), key2.m_sz, key2.m_sLength) == 0));
+	}
+};
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -71,6 +176,10 @@ public:
 				return m_iter->first;
 			}
 
+			size_t index() {
+				return m_iter->second;
+			}
+
 			StoredObjectPtr operator*() {
 				return (*m_pheap)[m_iter->second];
 			}
@@ -121,6 +230,10 @@ public:
 				return m_iter->first;
 			}
 
+			size_t index() {
+				return m_iter->second;
+			}
+
 			ConstStoredObjectPtr operator*() {
 				return (*m_pheap)[m_iter->second];
 			}
@@ -141,6 +254,18 @@ public:
 	};
 
 public:
+	///	<summary>
+	///		Constructor.  If fHashIndex is true an open-addressing hash
+	///		index is maintained alongside the ordered lookup table, so that
+	///		find() takes constant time.
+	///	</summary>
+	LookupVectorHeap(
+		bool fHashIndex = false
+	) :
+		m_fHashIndex(fHashIndex),
+		m_sHashCount(0)
+	{ }
+
 	///	<summary>
 	///		Destructor.
 	///	</summary>
@@ -157,6 +282,20 @@ public:
 		return m_vecStoredObjects.size();
 	}
 
+	///	<summary>
+	///		Estimate the bytes of memory used by the lookup structures,
+	///		excluding the stored objects and memory owned by the keys.
+	///	</summary>
+	size_t GetContainerBytes() const {
+		// A std::map node holds three pointers and a color beside its value
+		static const size_t MapNodeOverhead = 32;
+		return m_mapLookupTable.size()
+				* (MapNodeOverhead + sizeof(typename LookupTable::value_type))
+			+ m_vecStoredObjects.capacity() * sizeof(StoredObject *)
+			+ m_vecLookupIters.capacity() * sizeof(typename LookupTable::iterator)
+			+ m_vecHashSlots.capacity() * sizeof(size_t);
+	}
+
 	///	<summary>
 	///		Insert an object into this LookupVector.
 	///	</summary>
@@ -165,9 +304,41 @@ public:
 		StoredObject * value
 	) {
 		size_t sIndex = size();
-		m_mapLookupTable.insert(
-			std::pair<LookupObject, size_t>(key, sIndex));
+		std::pair<typename LookupTable::iterator, bool> pr =
+			m_mapLookupTable.insert(
+				std::pair<LookupObject, size_t>(key, sIndex));
 		m_vecStoredObjects.push_back(value);
+		m_vecLookupIters.push_back(pr.first);
+
+		if (m_fHashIndex && pr.second) {
+			HashInsert(sIndex);
+		}
+	}
+
+	///	<summary>
+	///		Swap the contents of this LookupVectorHeap with another.
+	///		Each heap keeps its own hash index setting.
+	///	</summary>
+	void swap(
+		LookupVectorHeap & heap
+	) {
+		m_mapLookupTable.swap(heap.m_mapLookupTable);
+		m_vecStoredObjects.swap(heap.m_vecStoredObjects);
+		m_vecLookupIters.swap(heap.m_vecLookupIters);
+		HashRebuild();
+		heap.HashRebuild();
+	}
+
+	///	<summary>
+	///		Remove all objects from this LookupVector without
+	///		deleting them.  The caller takes ownership of the objects.
+	///	</summary>
+	void release() {
+		m_mapLookupTable.clear();
+		m_vecStoredObjects.clear();
+		m_vecLookupIters.clear();
+		m_vecHashSlots.clear();
+		m_sHashCount = 0;
 	}
 
 	///	<summary>
@@ -184,10 +355,24 @@ public:
 		return m_vecStoredObjects[ix];
 	}
 
+	///	<summary>
+	///		Get the key of the object with the given index.
+	///	</summary>
+	const LookupObject & key(size_t ix) const {
+		return m_vecLookupIters[ix]->first;
+	}
+
 	///	<summary>
 	///		Perform a lookup by LookupObject.
 	///	</summary>
 	iterator find(const LookupObject & key) {
+		if (m_fHashIndex) {
+			size_t sIndex = HashFind(key);
+			if (sIndex == InvalidIndex) {
+				return end();
+			}
+			return iterator(m_vecLookupIters[sIndex], this);
+		}
 		typename LookupTable::iterator iter = m_mapLookupTable.find(key);
 		if (iter == m_mapLookupTable.end()) {
 			return end();
@@ -200,12 +385,47 @@ public:
 	///		Perform a lookup by LookupObject.
 	///	</summary>
 	const_iterator find(const LookupObject & key) const {
-		typename LookupTable::iterator iter = m_mapLookupTable.find(key);
+		if (m_fHashIndex) {
+			size_t sIndex = HashFind(key);
+			if (sIndex == InvalidIndex) {
+				return end();
+			}
+			return const_iterator(m_vecLookupIters[sIndex], this);
+		}
+		typename LookupTable::const_iterator iter = m_mapLookupTable.find(key);
 		if (iter == m_mapLookupTable.end()) {
 			return end();
 		} else {
-			return iterator(iter, this);
+			return const_iterator(iter, this);
+		}
+	}
+
+	///	<summary>
+	///		Perform a lookup of a std::string key by LookupStringRef.
+	///	</summary>
+	iterator find(const LookupStringRef & key) {
+		if (m_fHashIndex) {
+			size_t sIndex = HashFind(key);
+			if (sIndex == InvalidIndex) {
+				return end();
+			}
+			return iterator(m_vecLookupIters[sIndex], this);
+		}
+		return find(LookupObject(key.m_sz, key.m_sLength));
+	}
+
+	///	<summary>
+	///		Perform a lookup of a std::string key by LookupStringRef.
+	///	</summary>
+	const_iterator find(const LookupStringRef & key) const {
+		if (m_fHashIndex) {
+			size_t sIndex = HashFind(key);
+			if (sIndex == InvalidIndex) {
+				return end();
+			}
+			return const_iterator(m_vecLookupIters[sIndex], this);
 		}
+		return find(LookupObject(key.m_sz, key.m_sLength));
 	}
 
 	///	<summary>
@@ -236,6 +456,91 @@ public:
 		return const_iterator(m_mapLookupTable.end(), this);
 	}
 
+protected:
+	///	<summary>
+	///		Index denoting an empty hash slot or a failed lookup.
+	///	</summary>
+	static const size_t InvalidIndex = static_cast<size_t>(-1);
+
+	///	<summary>
+	///		Find the index of the object with the given key in the hash
+	///		index, or InvalidIndex if not present.
+	///	</summary>
+	template <typename KeyType>
+	size_t HashFind(const KeyType & key) const {
+		if (m_sHashCount == 0) {
+			return InvalidIndex;
+		}
+		const size_t sMask = m_vecHashSlots.size() - 1;
+		size_t sSlot = LookupTraits<LookupObject>::Hash(key) & sMask;
+		for (;;) {
+			const size_t sIndex = m_vecHashSlots[sSlot];
+			if (sIndex == InvalidIndex) {
+				return InvalidIndex;
+			}
+			if (LookupTraits<LookupObject>::Equal(
+					m_vecLookupIters[sIndex]->first, key)
+			) {
+				return sIndex;
+			}
+			sSlot = (sSlot + 1) & sMask;
+		}
+	}
+
+	///	<summary>
+	///		Insert the object with the given index into the hash index,
+	///		growing the table to keep the load factor at most one half.
+	///	</summary>
+	void HashInsert(size_t sIndex) {
+		if (2 * (m_sHashCount + 1) > m_vecHashSlots.size()) {
+			size_t sSlots = (m_vecHashSlots.size() == 0)?(16):(2 * m_vecHashSlots.size());
+			m_vecHashSlots.assign(sSlots, InvalidIndex);
+			m_sHashCount = 0;
+			typename LookupTable::const_iterator iter = m_mapLookupTable.begin();
+			for (; iter != m_mapLookupTable.end(); iter++) {
+				if (iter->second != sIndex) {
+					HashPlace(iter->second);
+				}
+			}
+		}
+		HashPlace(sIndex);
+	}
+
+	///	<summary>
+	///		Place the object with the given index in the first free slot
+	///		of its probe sequence.
+	///	</summary>
+	void HashPlace(size_t sIndex) {
+		const size_t sMask = m_vecHashSlots.size() - 1;
+		size_t sSlot =
+			LookupTraits<LookupObject>::Hash(m_vecLookupIters[sIndex]->first) & sMask;
+		while (m_vecHashSlots[sSlot] != InvalidIndex) {
+			sSlot = (sSlot + 1) & sMask;
+		}
+		m_vecHashSlots[sSlot] = sIndex;
+		m_sHashCount++;
+	}
+
+	///	<summary>
+	///		Rebuild the hash index from the lookup table.
+	///	</summary>
+	void HashRebuild() {
+		m_vecHashSlots.clear();
+		m_sHashCount = 0;
+		if (!m_fHashIndex) {
+			return;
+		}
+		size_t sSlots = 16;
+		while (sSlots < 2 * m_mapLookupTable.size()) {
+			sSlots *= 2;
+		}
+		m_vecHashSlots.assign(sSlots, InvalidIndex);
+		typename LookupTable::const_iterator iter = m_mapLookupTable.begin();
+		for (; iter != m_mapLookupTable.end(); iter++) {
+			HashPlace(iter->second);
+		}
+	}
+
 protected:
 	///	<summary>
 	///		Map from LookupObject to vector index.
@@ -246,9 +551,37 @@ protected:
 	///		Vector of pointers to StoredObjects.
 	///	</summary>
 	StoredObjectVector m_vecStoredObjects;
+
+	///	<summary>
+	///		Lookup table entry of each StoredObject.
+	///	</summary>
+	std::vector<typename LookupTable::iterator> m_vecLookupIters;
+
+	///	<summary>
+	///		Flag indicating the hash index is maintained.
+	///	</summary>
+	bool m_fHashIndex;
+
+	///	<summary>
+	///		Open-addressing hash table of vector indices.
+	///	</summary>
+	std::vector<size_t> m_vecHashSlots;
+
+	///	<summary>
+	///		Number of occupied slots in m_vecHashSlots.
+	///	</summary>
+	size_t m_sHashCount;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
+template <
+	typename LookupObject,
+	typename StoredObject
+>
+const size_t LookupVectorHeap<LookupObject, StoredObject>::InvalidIndex;
+
+///////////////////////////////////////////////////////////////////////////////
+
 #endif // _LOOKUPVECTORHEAP_H_
 
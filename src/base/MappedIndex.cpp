@@ -0,0 +1,596 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    MappedIndex.cpp
+///	\version October 14, 2026
+///
+
+#include "MappedIndex.h"
+#include "Exception.h"
+#include "TypedValueArray.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Magic number at the start of a mapped index file.
+///	</summary>
+static const char MappedIndexMagic[8] = { 'A', 'C', 'M', 'I', 'D', 'X', '0', '1' };
+
+///	<summary>
+///		Value of uByteOrder written by the host that created the file.
+///	</summary>
+static const uint32_t MappedIndexByteOrder = 0x01020304;
+
+///	<summary>
+///		Current version of the layout.
+///	</summary>
+static const uint32_t MappedIndexVersion = 1;
+
+///////////////////////////////////////////////////////////////////////////////
+// MappedIndexWriter
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t MappedIndexWriter::String(
+	const std::string & str
+) {
+	std::unordered_map<std::string, uint32_t>::iterator iter =
+		m_mapStrings.find(str);
+	if (iter != m_mapStrings.end()) {
+		return iter->second;
+	}
+
+	uint32_t uRef = static_cast<uint32_t>(m_vecStrings.size());
+	iter = m_mapStrings.insert(
+		std::pair<std::string, uint32_t>(str, uRef)).first;
+	m_vecStrings.push_back(&(iter->first));
+	return uRef;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MappedIndexWriter::AddAttribute(
+	const std::string & strName,
+	const std::string & strValue,
+	bool fKey
+) {
+	MappedIndexAttribute attr;
+	attr.uName = String(strName);
+	attr.uValue = String(strValue);
+	attr.uFlags = (fKey)?(MappedIndexAttributeKey):(0);
+	m_vecAttributes.push_back(attr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint64_t MappedIndexWriter::AddValues(
+	const void * pData,
+	size_t sBytes
+) {
+	m_vecValues.resize((m_vecValues.size() + 7) & ~static_cast<size_t>(7), 0);
+	uint64_t uOffset = m_vecValues.size();
+	m_vecValues.resize(m_vecValues.size() + sBytes);
+	if (sBytes != 0) {
+		memcpy(&(m_vecValues[uOffset]), pData, sBytes);
+	}
+	return uOffset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Append a section to a mapped index file being written.
+///	</summary>
+static void MappedIndexWriteSection(
+	std::ofstream & ofIndex,
+	uint64_t & uOffset,
+	MappedIndexSection & sec,
+	const void * pData,
+	size_t sCount,
+	size_t sRecordSize
+) {
+	static const char szPadding[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+	uint64_t uAligned = (uOffset + 7) & ~static_cast<uint64_t>(7);
+	ofIndex.write(szPadding, uAligned - uOffset);
+
+	sec.uOffset = uAligned;
+	sec.uCount = sCount;
+
+	ofIndex.write(reinterpret_cast<const char *>(pData), sCount * sRecordSize);
+	uOffset = uAligned + sCount * sRecordSize;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MappedIndexWriter::Write(
+	const std::string & strFilename
+) {
+	std::ofstream ofIndex(strFilename.c_str(), std::ios::binary);
+	if (!ofIndex.is_open()) {
+		_EXCEPTION1("Error opening file \"%s\" for writing",
+			strFilename.c_str());
+	}
+
+	// String table
+	std::vector<uint64_t> vecStringOffsets;
+	vecStringOffsets.reserve(m_vecStrings.size() + 1);
+
+	std::vector<char> vecStringData;
+	for (size_t s = 0; s < m_vecStrings.size(); s++) {
+		vecStringOffsets.push_back(vecStringData.size());
+		vecStringData.insert(vecStringData.end(),
+			m_vecStrings[s]->begin(), m_vecStrings[s]->end());
+		vecStringData.push_back('\0');
+	}
+	vecStringOffsets.push_back(vecStringData.size());
+
+	// Header, rewritten once all section offsets are known
+	MappedIndexHeader header;
+	memset(&header, 0, sizeof(MappedIndexHeader));
+	memcpy(header.szMagic, MappedIndexMagic, sizeof(header.szMagic));
+	header.uByteOrder = MappedIndexByteOrder;
+	header.uVersion = MappedIndexVersion;
+	header.uDatasetAttrBegin = m_uDatasetAttrBegin;
+	header.uDatasetAttrCount = m_uDatasetAttrCount;
+
+	ofIndex.write(reinterpret_cast<const char *>(&header), sizeof(MappedIndexHeader));
+	uint64_t uOffset = sizeof(MappedIndexHeader);
+
+	MappedIndexWriteSection(ofIndex, uOffset, header.secStringOffsets,
+		vecStringOffsets.data(), vecStringOffsets.size(), sizeof(uint64_t));
+	MappedIndexWriteSection(ofIndex, uOffset, header.secStringData,
+		vecStringData.data(), vecStringData.size(), sizeof(char));
+	MappedIndexWriteSection(ofIndex, uOffset, header.secAttributes,
+		m_vecAttributes.data(), m_vecAttributes.size(), sizeof(MappedIndexAttribute));
+	MappedIndexWriteSection(ofIndex, uOffset, header.secFiles,
+		m_vecFiles.data(), m_vecFiles.size(), sizeof(MappedIndexFile));
+	MappedIndexWriteSection(ofIndex, uOffset, header.secFileAxes,
+		m_vecFileAxes.data(), m_vecFileAxes.size(), sizeof(MappedIndexFileAxis));
+	MappedIndexWriteSection(ofIndex, uOffset, header.secAxes,
+		m_vecAxes.data(), m_vecAxes.size(), sizeof(MappedIndexAxis));
+	MappedIndexWriteSection(ofIndex, uOffset, header.secSubAxes,
+		m_vecSubAxes.data(), m_vecSubAxes.size(), sizeof(MappedIndexSubAxis));
+	MappedIndexWriteSection(ofIndex, uOffset, header.secVariables,
+		m_vecVariables.data(), m_vecVariables.size(), sizeof(MappedIndexVariable));
+	MappedIndexWriteSection(ofIndex, uOffset, header.secAxisGroups,
+		m_vecAxisGroups.data(), m_vecAxisGroups.size(), sizeof(MappedIndexAxisGroup));
+	MappedIndexWriteSection(ofIndex, uOffset, header.secAxisGroupIds,
+		m_vecAxisGroupIds.data(), m_vecAxisGroupIds.size(), sizeof(uint32_t));
+	MappedIndexWriteSection(ofIndex, uOffset, header.secSubAxisMap,
+		m_vecSubAxisMap.data(), m_vecSubAxisMap.size(), sizeof(uint32_t));
+	MappedIndexWriteSection(ofIndex, uOffset, header.secValues,
+		m_vecValues.data(), m_vecValues.size(), sizeof(unsigned char));
+
+	header.uFileSize = uOffset;
+	ofIndex.seekp(0);
+	ofIndex.write(reinterpret_cast<const char *>(&header), sizeof(MappedIndexHeader));
+
+	ofIndex.close();
+	if (!ofIndex) {
+		_EXCEPTION1("Error writing to file \"%s\"",
+			strFilename.c_str());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MappedIndex
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check that a section of a mapped file is aligned and in bounds.
+///	</summary>
+static bool MappedIndexSectionValid(
+	const MappedIndexSection & sec,
+	size_t sRecordSize,
+	size_t sFileSize
+) {
+	if ((sec.uOffset % 8) != 0) {
+		return false;
+	}
+	if (sec.uOffset > sFileSize) {
+		return false;
+	}
+	return (sec.uCount <= (sFileSize - sec.uOffset) / sRecordSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string MappedIndex::Open(
+	const std::string & strFilename
+) {
+	Close();
+
+	int fd = open(strFilename.c_str(), O_RDONLY);
+	if (fd == -1) {
+		return std::string("Unable to open mapped index \"")
+			+ strFilename + "\": " + strerror(errno);
+	}
+
+	struct stat statbuf;
+	if (fstat(fd, &statbuf) != 0) {
+		close(fd);
+		return std::string("Unable to stat mapped index \"")
+			+ strFilename + "\"";
+	}
+
+	size_t sSize = static_cast<size_t>(statbuf.st_size);
+	if (sSize < sizeof(MappedIndexHeader)) {
+		close(fd);
+		return std::string("File \"") + strFilename
+			+ "\" is not a mapped index";
+	}
+
+	void * pMap = mmap(NULL, sSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (pMap == MAP_FAILED) {
+		return std::string("Unable to map \"")
+			+ strFilename + "\": " + strerror(errno);
+	}
+
+	m_pData = static_cast<const char *>(pMap);
+	m_sSize = sSize;
+
+	const MappedIndexHeader * pheader =
+		reinterpret_cast<const MappedIndexHeader *>(m_pData);
+
+	std::string strError;
+	if (memcmp(pheader->szMagic, MappedIndexMagic, sizeof(MappedIndexMagic)) != 0) {
+		strError = "is not a mapped index";
+	} else if (pheader->uByteOrder != MappedIndexByteOrder) {
+		strError = "was written on a host with different byte order";
+	} else if (pheader->uVersion != MappedIndexVersion) {
+		strError = "has an unsupported version";
+	} else if (pheader->uFileSize != sSize) {
+		strError = "is truncated";
+	} else if (
+		!MappedIndexSectionValid(pheader->secStringOffsets, sizeof(uint64_t), sSize) ||
+		!MappedIndexSectionValid(pheader->secStringData, sizeof(char), sSize) ||
+		!MappedIndexSectionValid(pheader->secAttributes, sizeof(MappedIndexAttribute), sSize) ||
+		!MappedIndexSectionValid(pheader->secFiles, sizeof(MappedIndexFile), sSize) ||
+		!MappedIndexSectionValid(pheader->secFileAxes, sizeof(MappedIndexFileAxis), sSize) ||
+		!MappedIndexSectionValid(pheader->secAxes, sizeof(MappedIndexAxis), sSize) ||
+		!MappedIndexSectionValid(pheader->secSubAxes, sizeof(MappedIndexSubAxis), sSize) ||
+		!MappedIndexSectionValid(pheader->secVariables, sizeof(MappedIndexVariable), sSize) ||
+		!MappedIndexSectionValid(pheader->secAxisGroups, sizeof(MappedIndexAxisGroup), sSize) ||
+		!MappedIndexSectionValid(pheader->secAxisGroupIds, sizeof(uint32_t), sSize) ||
+		!MappedIndexSectionValid(pheader->secSubAxisMap, sizeof(uint32_t), sSize) ||
+		!MappedIndexSectionValid(pheader->secValues, sizeof(char), sSize) ||
+		(pheader->secStringOffsets.uCount == 0)
+	) {
+		strError = "has an invalid section table";
+	} else if (
+		static_cast<uint64_t>(pheader->uDatasetAttrBegin) + pheader->uDatasetAttrCount
+			> pheader->secAttributes.uCount
+	) {
+		strError = "has invalid dataset attributes";
+	}
+
+	if (strError != "") {
+		Close();
+		return std::string("File \"") + strFilename + "\" " + strError;
+	}
+
+	m_pheader = pheader;
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MappedIndex::Close() {
+	if (m_pData != NULL) {
+		munmap(const_cast<char *>(m_pData), m_sSize);
+	}
+	m_pData = NULL;
+	m_sSize = 0;
+	m_pheader = NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MappedIndex::CheckRange(
+	const MappedIndexSection & sec,
+	uint64_t uBegin,
+	uint64_t uCount,
+	const char * szSection
+) const {
+	if ((uBegin > sec.uCount) || (uCount > sec.uCount - uBegin)) {
+		_EXCEPTION1("Mapped index reference out of range in %s", szSection);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * MappedIndex::GetString(
+	uint32_t uRef
+) const {
+	const MappedIndexSection & sec = m_pheader->secStringOffsets;
+	if (static_cast<uint64_t>(uRef) + 1 >= sec.uCount) {
+		_EXCEPTION1("Mapped index string %u out of range", uRef);
+	}
+
+	const uint64_t * pOffsets = Section<uint64_t>(sec);
+	uint64_t uBegin = pOffsets[uRef];
+	uint64_t uEnd = pOffsets[uRef+1];
+
+	const char * pStrings = Section<char>(m_pheader->secStringData);
+	if ((uBegin >= uEnd) ||
+	    (uEnd > m_pheader->secStringData.uCount) ||
+	    (pStrings[uEnd-1] != '\0')
+	) {
+		_EXCEPTION1("Mapped index string %u is invalid", uRef);
+	}
+
+	return (pStrings + uBegin);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const MappedIndexAttribute * MappedIndex::GetAttributes(
+	uint32_t uBegin,
+	uint32_t uCount
+) const {
+	CheckRange(m_pheader->secAttributes, uBegin, uCount, "attributes");
+	return Section<MappedIndexAttribute>(m_pheader->secAttributes) + uBegin;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const MappedIndexFile & MappedIndex::GetFile(
+	size_t ix
+) const {
+	CheckRange(m_pheader->secFiles, ix, 1, "files");
+	return Section<MappedIndexFile>(m_pheader->secFiles)[ix];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const MappedIndexAxis & MappedIndex::GetAxis(
+	size_t ix
+) const {
+	CheckRange(m_pheader->secAxes, ix, 1, "axes");
+	return Section<MappedIndexAxis>(m_pheader->secAxes)[ix];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const MappedIndexVariable & MappedIndex::GetVariable(
+	size_t ix
+) const {
+	CheckRange(m_pheader->secVariables, ix, 1, "variables");
+	return Section<MappedIndexVariable>(m_pheader->secVariables)[ix];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const MappedIndexFileAxis * MappedIndex::GetFileAxes(
+	const MappedIndexFile & file
+) const {
+	CheckRange(m_pheader->secFileAxes, file.uAxesBegin, file.uAxesCount, "file axes");
+	return Section<MappedIndexFileAxis>(m_pheader->secFileAxes) + file.uAxesBegin;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const MappedIndexSubAxis & MappedIndex::GetSubAxis(
+	const MappedIndexAxis & axis,
+	size_t ix
+) const {
+	if (ix >= axis.uSubAxisCount) {
+		_EXCEPTIONT("Mapped index subaxis out of range");
+	}
+	CheckRange(m_pheader->secSubAxes,
+		static_cast<uint64_t>(axis.uSubAxisBegin) + ix, 1, "subaxes");
+	return Section<MappedIndexSubAxis>(m_pheader->secSubAxes)[axis.uSubAxisBegin + ix];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const void * MappedIndex::GetSubAxisValues(
+	const MappedIndexSubAxis & subaxis
+) const {
+	if (subaxis.uValuesCount == 0) {
+		return NULL;
+	}
+
+	const size_t sElementSize =
+		NcTypeValueSize(static_cast<NcType>(subaxis.iType));
+	if (sElementSize == 0) {
+		_EXCEPTIONT("Mapped index subaxis has values of invalid type");
+	}
+
+	const MappedIndexSection & sec = m_pheader->secValues;
+	if ((subaxis.uValuesOffset % sElementSize != 0) ||
+	    (subaxis.uValuesCount > sec.uCount / sElementSize)
+	) {
+		_EXCEPTIONT("Mapped index subaxis values out of range");
+	}
+	CheckRange(sec,
+		subaxis.uValuesOffset, subaxis.uValuesCount * sElementSize,
+		"values");
+
+	return (Section<char>(sec) + subaxis.uValuesOffset);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const MappedIndexAxisGroup & MappedIndex::GetAxisGroup(
+	const MappedIndexVariable & var,
+	size_t ix
+) const {
+	if (ix >= var.uGroupCount) {
+		_EXCEPTIONT("Mapped index axis group out of range");
+	}
+	CheckRange(m_pheader->secAxisGroups,
+		static_cast<uint64_t>(var.uGroupBegin) + ix, 1, "axis groups");
+	return Section<MappedIndexAxisGroup>(m_pheader->secAxisGroups)[var.uGroupBegin + ix];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const uint32_t * MappedIndex::GetAxisGroupIds(
+	const MappedIndexAxisGroup & group
+) const {
+	CheckRange(m_pheader->secAxisGroupIds,
+		group.uAxisIdBegin, group.uAxisIdCount, "axis ids");
+	return Section<uint32_t>(m_pheader->secAxisGroupIds) + group.uAxisIdBegin;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const uint32_t * MappedIndex::GetSubAxisMapEntry(
+	const MappedIndexAxisGroup & group,
+	size_t ix
+) const {
+	if (ix >= group.uEntryCount) {
+		_EXCEPTIONT("Mapped index subaxis map entry out of range");
+	}
+	uint64_t uStride = static_cast<uint64_t>(group.uAxisIdCount) + 1;
+	uint64_t uBegin = group.uEntryBegin + ix * uStride;
+	CheckRange(m_pheader->secSubAxisMap, uBegin, uStride, "subaxis map");
+	return Section<uint32_t>(m_pheader->secSubAxisMap) + uBegin;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T, typename KeyFn>
+size_t MappedIndex::Search(
+	const T * pRecords,
+	size_t sCount,
+	const std::string & strKey,
+	KeyFn fnKey
+) const {
+	size_t sLow = 0;
+	size_t sHigh = sCount;
+	while (sLow < sHigh) {
+		size_t sMid = sLow + (sHigh - sLow) / 2;
+		int iCompare = strcmp(GetString(fnKey(pRecords[sMid])), strKey.c_str());
+		if (iCompare == 0) {
+			return sMid;
+		} else if (iCompare < 0) {
+			sLow = sMid + 1;
+		} else {
+			sHigh = sMid;
+		}
+	}
+	return InvalidIndex;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t MappedIndex::FindFile(
+	const std::string & strId
+) const {
+	return Search(
+		Section<MappedIndexFile>(m_pheader->secFiles),
+		GetFileCount(),
+		strId,
+		[](const MappedIndexFile & file) { return file.uId; });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t MappedIndex::FindAxis(
+	const std::string & strName
+) const {
+	return Search(
+		Section<MappedIndexAxis>(m_pheader->secAxes),
+		GetAxisCount(),
+		strName,
+		[](const MappedIndexAxis & axis) { return axis.uName; });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t MappedIndex::FindSubAxis(
+	const MappedIndexAxis & axis,
+	const std::string & strId
+) const {
+	CheckRange(m_pheader->secSubAxes,
+		axis.uSubAxisBegin, axis.uSubAxisCount, "subaxes");
+	return Search(
+		Section<MappedIndexSubAxis>(m_pheader->secSubAxes) + axis.uSubAxisBegin,
+		axis.uSubAxisCount,
+		strId,
+		[](const MappedIndexSubAxis & subaxis) { return subaxis.uId; });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t MappedIndex::FindVariable(
+	const std::string & strName
+) const {
+	return Search(
+		Section<MappedIndexVariable>(m_pheader->secVariables),
+		GetVariableCount(),
+		strName,
+		[](const MappedIndexVariable & var) { return var.uName; });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t MappedIndex::FindAxisGroup(
+	const MappedIndexVariable & var,
+	const std::vector<std::string> & vecAxisIds
+) const {
+	for (size_t g = 0; g < var.uGroupCount; g++) {
+		const MappedIndexAxisGroup & group = GetAxisGroup(var, g);
+		if (group.uAxisIdCount != vecAxisIds.size()) {
+			continue;
+		}
+
+		const uint32_t * pAxisIds = GetAxisGroupIds(group);
+		size_t d = 0;
+		for (; d < vecAxisIds.size(); d++) {
+			if (vecAxisIds[d] != GetString(pAxisIds[d])) {
+				break;
+			}
+		}
+		if (d == vecAxisIds.size()) {
+			return g;
+		}
+	}
+	return InvalidIndex;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char * MappedIndex::FindFileId(
+	const MappedIndexAxisGroup & group,
+	const std::vector<std::string> & vecSubAxisIds
+) const {
+	if (vecSubAxisIds.size() != group.uAxisIdCount) {
+		return NULL;
+	}
+
+	// Entries are sorted lexicographically by their subaxis ids
+	size_t sLow = 0;
+	size_t sHigh = static_cast<size_t>(group.uEntryCount);
+	while (sLow < sHigh) {
+		size_t sMid = sLow + (sHigh - sLow) / 2;
+		const uint32_t * pEntry = GetSubAxisMapEntry(group, sMid);
+
+		int iCompare = 0;
+		for (size_t d = 0; (d < vecSubAxisIds.size()) && (iCompare == 0); d++) {
+			iCompare = strcmp(GetString(pEntry[d]), vecSubAxisIds[d].c_str());
+		}
+		if (iCompare == 0) {
+			return GetString(pEntry[vecSubAxisIds.size()]);
+		} else if (iCompare < 0) {
+			sLow = sMid + 1;
+		} else {
+			sHigh = sMid;
+		}
+	}
+	return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
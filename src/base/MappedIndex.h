@@ -0,0 +1,457 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    MappedIndex.h
+///	\version October 14, 2026
+///
+
+#ifndef _MAPPEDINDEX_H_
+#define _MAPPEDINDEX_H_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A section of a mapped index file: the byte offset of its first
+///		record and the number of records.
+///	</summary>
+struct MappedIndexSection {
+	uint64_t uOffset;
+	uint64_t uCount;
+};
+
+///	<summary>
+///		Header at the start of a mapped index file.  All integers are
+///		stored in host byte order, and every section starts on an 8 byte
+///		boundary.  Strings are referenced by their index in the string
+///		table; every string is followed by a NUL so that it can be used
+///		in place as a C string.
+///	</summary>
+struct MappedIndexHeader {
+	char szMagic[8];
+	uint32_t uByteOrder;
+	uint32_t uVersion;
+	uint64_t uFileSize;
+
+	MappedIndexSection secStringOffsets;
+	MappedIndexSection secStringData;
+	MappedIndexSection secAttributes;
+	MappedIndexSection secFiles;
+	MappedIndexSection secFileAxes;
+	MappedIndexSection secAxes;
+	MappedIndexSection secSubAxes;
+	MappedIndexSection secVariables;
+	MappedIndexSection secAxisGroups;
+	MappedIndexSection secAxisGroupIds;
+	MappedIndexSection secSubAxisMap;
+	MappedIndexSection secValues;
+
+	uint32_t uDatasetAttrBegin;
+	uint32_t uDatasetAttrCount;
+};
+
+///	<summary>
+///		An attribute of the dataset, a file, an axis or a variable.
+///		uFlags is MappedIndexAttributeKey for key attributes.
+///	</summary>
+struct MappedIndexAttribute {
+	uint32_t uName;
+	uint32_t uValue;
+	uint32_t uFlags;
+};
+
+///	<summary>
+///		Flag for key attributes.
+///	</summary>
+static const uint32_t MappedIndexAttributeKey = 1;
+
+///	<summary>
+///		A file, in order of file id.
+///	</summary>
+struct MappedIndexFile {
+	uint32_t uId;
+	uint32_t uName;
+	uint32_t uAttrBegin;
+	uint32_t uAttrCount;
+	uint32_t uAxesBegin;
+	uint32_t uAxesCount;
+	int64_t llSize;
+	int64_t llModTime;
+	uint64_t ullInode;
+};
+
+///	<summary>
+///		The subaxis of one axis that appears in a file.
+///	</summary>
+struct MappedIndexFileAxis {
+	uint32_t uAxis;
+	uint32_t uSubAxis;
+};
+
+///	<summary>
+///		An axis, in order of name.  Its subaxes are contiguous and in
+///		order of id.  iType is the NcType.
+///	</summary>
+struct MappedIndexAxis {
+	uint32_t uName;
+	uint32_t uUnits;
+	int32_t iType;
+	uint32_t uAttrBegin;
+	uint32_t uAttrCount;
+	uint32_t uSubAxisBegin;
+	uint32_t uSubAxisCount;
+	uint32_t uReserved;
+};
+
+///	<summary>
+///		A subaxis.  Its values are uValuesCount elements of iType
+///		starting at byte uValuesOffset of the values section.
+///	</summary>
+struct MappedIndexSubAxis {
+	uint32_t uId;
+	int32_t iType;
+	int64_t lSize;
+	uint64_t uValuesOffset;
+	uint64_t uValuesCount;
+};
+
+///	<summary>
+///		A variable, in order of name.  Its axis groups are contiguous and
+///		in order of axis ids.
+///	</summary>
+struct MappedIndexVariable {
+	uint32_t uName;
+	uint32_t uUnits;
+	int32_t iType;
+	uint32_t uAttrBegin;
+	uint32_t uAttrCount;
+	uint32_t uGroupBegin;
+	uint32_t uGroupCount;
+	uint32_t uReserved;
+};
+
+///	<summary>
+///		An axis group of a variable.  The axis ids are uAxisIdCount
+///		strings starting at uAxisIdBegin of the axis group id section.
+///		The subaxis map is uEntryCount entries starting at string
+///		uEntryBegin of the subaxis map section, each made of
+///		uAxisIdCount subaxis ids followed by a file id.  Entries are
+///		sorted by subaxis ids.
+///	</summary>
+struct MappedIndexAxisGroup {
+	uint32_t uAxisIdBegin;
+	uint32_t uAxisIdCount;
+	uint64_t uEntryBegin;
+	uint64_t uEntryCount;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Builds a mapped index file in memory and writes it out.  Records
+///		must be added in the order described in MappedIndexHeader.
+///	</summary>
+class MappedIndexWriter {
+
+public:
+	///	<summary>
+	///		Get the reference to a string, adding it to the table if needed.
+	///	</summary>
+	uint32_t String(const std::string & str);
+
+	///	<summary>
+	///		Add an attribute.
+	///	</summary>
+	void AddAttribute(
+		const std::string & strName,
+		const std::string & strValue,
+		bool fKey
+	);
+
+	///	<summary>
+	///		Append coordinate values to the values section, aligned to
+	///		8 bytes, and return their byte offset.
+	///	</summary>
+	uint64_t AddValues(const void * pData, size_t sBytes);
+
+	///	<summary>
+	///		Write the mapped index to a file.
+	///	</summary>
+	void Write(const std::string & strFilename);
+
+public:
+	///	<summary>
+	///		Dataset attributes.
+	///	</summary>
+	uint32_t m_uDatasetAttrBegin;
+	uint32_t m_uDatasetAttrCount;
+
+	///	<summary>
+	///		Records of each section.
+	///	</summary>
+	std::vector<MappedIndexAttribute> m_vecAttributes;
+	std::vector<MappedIndexFile> m_vecFiles;
+	std::vector<MappedIndexFileAxis> m_vecFileAxes;
+	std::vector<MappedIndexAxis> m_vecAxes;
+	std::vector<MappedIndexSubAxis> m_vecSubAxes;
+	std::vector<MappedIndexVariable> m_vecVariables;
+	std::vector<MappedIndexAxisGroup> m_vecAxisGroups;
+	std::vector<uint32_t> m_vecAxisGroupIds;
+	std::vector<uint32_t> m_vecSubAxisMap;
+
+protected:
+	///	<summary>
+	///		String table.
+	///	</summary>
+	std::unordered_map<std::string, uint32_t> m_mapStrings;
+	std::vector<const std::string *> m_vecStrings;
+
+	///	<summary>
+	///		Values section.
+	///	</summary>
+	std::vector<unsigned char> m_vecValues;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A read-only view of a mapped index file.  The file is mapped into
+///		memory and queried in place: opening it only validates the header,
+///		and all records, strings and coordinate values are returned as
+///		pointers into the mapping, which is shared by every process that
+///		opens the same file.
+///	</summary>
+class MappedIndex {
+
+public:
+	///	<summary>
+	///		Index returned when a lookup fails.
+	///	</summary>
+	static const size_t InvalidIndex = static_cast<size_t>(-1);
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	MappedIndex() :
+		m_pData(NULL),
+		m_sSize(0),
+		m_pheader(NULL)
+	{ }
+
+	///	<summary>
+	///		Destructor.
+	///	</summary>
+	~MappedIndex() {
+		Close();
+	}
+
+private:
+	///	<summary>
+	///		Not copyable.
+	///	</summary>
+	MappedIndex(const MappedIndex &);
+	MappedIndex & operator=(const MappedIndex &);
+
+public:
+	///	<summary>
+	///		Map a file and validate its header.
+	///	</summary>
+	std::string Open(const std::string & strFilename);
+
+	///	<summary>
+	///		Unmap the file.
+	///	</summary>
+	void Close();
+
+	///	<summary>
+	///		Check if a file is mapped.
+	///	</summary>
+	bool IsOpen() const {
+		return (m_pheader != NULL);
+	}
+
+	///	<summary>
+	///		Get the header.
+	///	</summary>
+	const MappedIndexHeader & GetHeader() const {
+		return (*m_pheader);
+	}
+
+public:
+	///	<summary>
+	///		Get a string by reference.
+	///	</summary>
+	const char * GetString(uint32_t uRef) const;
+
+	///	<summary>
+	///		Get a range of attributes.
+	///	</summary>
+	const MappedIndexAttribute * GetAttributes(
+		uint32_t uBegin,
+		uint32_t uCount
+	) const;
+
+	///	<summary>
+	///		Number of files, axes and variables.
+	///	</summary>
+	size_t GetFileCount() const {
+		return static_cast<size_t>(m_pheader->secFiles.uCount);
+	}
+	size_t GetAxisCount() const {
+		return static_cast<size_t>(m_pheader->secAxes.uCount);
+	}
+	size_t GetVariableCount() const {
+		return static_cast<size_t>(m_pheader->secVariables.uCount);
+	}
+
+	///	<summary>
+	///		Get a record by index.
+	///	</summary>
+	const MappedIndexFile & GetFile(size_t ix) const;
+	const MappedIndexAxis & GetAxis(size_t ix) const;
+	const MappedIndexVariable & GetVariable(size_t ix) const;
+
+	///	<summary>
+	///		Get the axis and subaxis pairs of a file.
+	///	</summary>
+	const MappedIndexFileAxis * GetFileAxes(
+		const MappedIndexFile & file
+	) const;
+
+	///	<summary>
+	///		Get a subaxis of an axis.
+	///	</summary>
+	const MappedIndexSubAxis & GetSubAxis(
+		const MappedIndexAxis & axis,
+		size_t ix
+	) const;
+
+	///	<summary>
+	///		Get the coordinate values of a subaxis, or NULL if it has none.
+	///		The element type is given by the iType of the subaxis.
+	///	</summary>
+	const void * GetSubAxisValues(
+		const MappedIndexSubAxis & subaxis
+	) const;
+
+	///	<summary>
+	///		Get an axis group of a variable.
+	///	</summary>
+	const MappedIndexAxisGroup & GetAxisGroup(
+		const MappedIndexVariable & var,
+		size_t ix
+	) const;
+
+	///	<summary>
+	///		Get the axis ids of an axis group.
+	///	</summary>
+	const uint32_t * GetAxisGroupIds(
+		const MappedIndexAxisGroup & group
+	) const;
+
+	///	<summary>
+	///		Get an entry of the subaxis map of an axis group: the subaxis
+	///		ids followed by the file id.
+	///	</summary>
+	const uint32_t * GetSubAxisMapEntry(
+		const MappedIndexAxisGroup & group,
+		size_t ix
+	) const;
+
+public:
+	///	<summary>
+	///		Find a file by id.
+	///	</summary>
+	size_t FindFile(const std::string & strId) const;
+
+	///	<summary>
+	///		Find an axis by name.
+	///	</summary>
+	size_t FindAxis(const std::string & strName) const;
+
+	///	<summary>
+	///		Find a subaxis of an axis by id.
+	///	</summary>
+	size_t FindSubAxis(
+		const MappedIndexAxis & axis,
+		const std::string & strId
+	) const;
+
+	///	<summary>
+	///		Find a variable by name.
+	///	</summary>
+	size_t FindVariable(const std::string & strName) const;
+
+	///	<summary>
+	///		Find the axis group of a variable with the given axis ids.
+	///	</summary>
+	size_t FindAxisGroup(
+		const MappedIndexVariable & var,
+		const std::vector<std::string> & vecAxisIds
+	) const;
+
+	///	<summary>
+	///		Find the id of the file holding the given subaxes of an axis
+	///		group, or NULL if there is none.
+	///	</summary>
+	const char * FindFileId(
+		const MappedIndexAxisGroup & group,
+		const std::vector<std::string> & vecSubAxisIds
+	) const;
+
+protected:
+	///	<summary>
+	///		Get a pointer to the first record of a section.
+	///	</summary>
+	template <typename T>
+	const T * Section(const MappedIndexSection & sec) const {
+		return reinterpret_cast<const T *>(m_pData + sec.uOffset);
+	}
+
+	///	<summary>
+	///		Check that a range of records lies within a section.
+	///	</summary>
+	void CheckRange(
+		const MappedIndexSection & sec,
+		uint64_t uBegin,
+		uint64_t uCount,
+		const char * szSection
+	) const;
+
+	///	<summary>
+	///		Binary search a range of records sorted by a string.
+	///	</summary>
+	template <typename T, typename KeyFn>
+	size_t Search(
+		const T * pRecords,
+		size_t sCount,
+		const std::string & strKey,
+		KeyFn fnKey
+	) const;
+
+protected:
+	///	<summary>
+	///		Start of the mapping.
+	///	</summary>
+	const char * m_pData;
+
+	///	<summary>
+	///		Size of the mapping.
+	///	</summary>
+	size_t m_sSize;
+
+	///	<summary>
+	///		Header of the mapped file.
+	///	</summary>
+	const MappedIndexHeader * m_pheader;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
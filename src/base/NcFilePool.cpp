@@ -0,0 +1,169 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    NcFilePool.cpp
+///	\version October 14, 2026
+///
+
+#include "NcFilePool.h"
+#include "Exception.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// NcFilePool::Handle
+///////////////////////////////////////////////////////////////////////////////
+
+void NcFilePool::Handle::Release() {
+	if (m_pPool != NULL) {
+		m_pPool->Release(m_iterEntry);
+		m_pPool = NULL;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// NcFilePool
+///////////////////////////////////////////////////////////////////////////////
+
+NcFilePool & NcFilePool::Shared() {
+	static NcFilePool s_pool;
+	return s_pool;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::mutex & NcFilePool::LibraryMutex() {
+	static std::mutex s_mutexNetCDF;
+	return s_mutexNetCDF;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void NcFilePool::SetMaxOpenFiles(
+	size_t sMaxOpenFiles
+) {
+	m_sMaxOpenFiles = sMaxOpenFiles;
+	Trim();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string NcFilePool::Open(
+	const std::string & strFilename,
+	Handle & handle
+) {
+	handle.Release();
+
+	std::unordered_map<std::string, EntryList::iterator>::iterator iterMap =
+		m_mapEntries.find(strFilename);
+
+	// Already open
+	if (iterMap != m_mapEntries.end()) {
+		EntryList::iterator iterEntry = iterMap->second;
+		m_listEntries.splice(m_listEntries.begin(), m_listEntries, iterEntry);
+		iterEntry->m_sRefCount++;
+		handle.m_pPool = this;
+		handle.m_iterEntry = iterEntry;
+		return std::string("");
+	}
+
+	// Close unused files before opening another
+	if (m_sMaxOpenFiles != 0) {
+		m_sMaxOpenFiles--;
+		Trim();
+		m_sMaxOpenFiles++;
+	}
+
+	std::unique_ptr<NcFile> pncfile(
+		new NcFile(strFilename.c_str(), NcFile::ReadOnly));
+	if (!pncfile->is_valid()) {
+		return std::string("Unable to open data file \"")
+			+ strFilename + std::string("\" for reading");
+	}
+
+	m_listEntries.push_front(Entry(strFilename));
+	EntryList::iterator iterEntry = m_listEntries.begin();
+	iterEntry->m_pncfile = std::move(pncfile);
+	iterEntry->m_sRefCount = 1;
+	m_mapEntries.insert(
+		std::pair<std::string, EntryList::iterator>(strFilename, iterEntry));
+
+	handle.m_pPool = this;
+	handle.m_iterEntry = iterEntry;
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void NcFilePool::Evict(
+	const std::string & strFilename
+) {
+	std::unordered_map<std::string, EntryList::iterator>::iterator iterMap =
+		m_mapEntries.find(strFilename);
+	if (iterMap == m_mapEntries.end()) {
+		return;
+	}
+
+	EntryList::iterator iterEntry = iterMap->second;
+	m_mapEntries.erase(iterMap);
+
+	if (iterEntry->m_sRefCount == 0) {
+		m_listEntries.erase(iterEntry);
+	} else {
+		iterEntry->m_fEvicted = true;
+		m_listEvicted.splice(m_listEvicted.begin(), m_listEntries, iterEntry);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void NcFilePool::Clear() {
+	EntryList::iterator iterEntry = m_listEntries.begin();
+	while (iterEntry != m_listEntries.end()) {
+		if (iterEntry->m_sRefCount == 0) {
+			m_mapEntries.erase(iterEntry->m_strFilename);
+			iterEntry = m_listEntries.erase(iterEntry);
+		} else {
+			iterEntry++;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void NcFilePool::Release(
+	EntryList::iterator iterEntry
+) {
+	if (iterEntry->m_sRefCount == 0) {
+		_EXCEPTIONT("Logic error");
+	}
+	iterEntry->m_sRefCount--;
+	if (iterEntry->m_sRefCount != 0) {
+		return;
+	}
+
+	if (iterEntry->m_fEvicted) {
+		m_listEvicted.erase(iterEntry);
+	} else {
+		Trim();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void NcFilePool::Trim() {
+	if (m_listEntries.size() <= m_sMaxOpenFiles) {
+		return;
+	}
+
+	EntryList::iterator iterEntry = m_listEntries.end();
+	while ((m_listEntries.size() > m_sMaxOpenFiles) &&
+	       (iterEntry != m_listEntries.begin())
+	) {
+		iterEntry--;
+		if (iterEntry->m_sRefCount == 0) {
+			m_mapEntries.erase(iterEntry->m_strFilename);
+			iterEntry = m_listEntries.erase(iterEntry);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
@@ -0,0 +1,273 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    NcFilePool.h
+///	\version October 14, 2026
+///
+
+#ifndef _NCFILEPOOL_H_
+#define _NCFILEPOOL_H_
+
+#include "netcdfcpp.h"
+
+#include <string>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A bounded pool of NetCDF files open for reading.  Files are kept
+///		open after use and closed in least recently used order once more
+///		than the maximum number are open.  Files in use by a Handle are
+///		never closed, so the maximum may be exceeded while more handles
+///		than that are held.
+///
+///		The NetCDF library is not thread-safe, so the pool is not either:
+///		handles must be acquired, used and released while holding the
+///		mutex returned by LibraryMutex.
+///	</summary>
+class NcFilePool {
+
+protected:
+	///	<summary>
+	///		An open file.
+	///	</summary>
+	struct Entry {
+		///	<summary>
+		///		Constructor.
+		///	</summary>
+		Entry(const std::string & strFilename) :
+			m_strFilename(strFilename),
+			m_sRefCount(0),
+			m_fEvicted(false)
+		{ }
+
+		///	<summary>
+		///		Filename.
+		///	</summary>
+		std::string m_strFilename;
+
+		///	<summary>
+		///		Open file.
+		///	</summary>
+		std::unique_ptr<NcFile> m_pncfile;
+
+		///	<summary>
+		///		Number of handles to the file.
+		///	</summary>
+		size_t m_sRefCount;
+
+		///	<summary>
+		///		Flag indicating the file is to be closed once released.
+		///	</summary>
+		bool m_fEvicted;
+	};
+
+	///	<summary>
+	///		Entries in order of use, most recently used first.
+	///	</summary>
+	typedef std::list<Entry> EntryList;
+
+public:
+	///	<summary>
+	///		A reference to an open file in the pool.
+	///	</summary>
+	class Handle {
+		friend class NcFilePool;
+
+	public:
+		///	<summary>
+		///		Constructor for an empty handle.
+		///	</summary>
+		Handle() :
+			m_pPool(NULL)
+		{ }
+
+		///	<summary>
+		///		Move constructor.
+		///	</summary>
+		Handle(Handle && handle) :
+			m_pPool(handle.m_pPool),
+			m_iterEntry(handle.m_iterEntry)
+		{
+			handle.m_pPool = NULL;
+		}
+
+		///	<summary>
+		///		Move assignment.
+		///	</summary>
+		Handle & operator=(Handle && handle) {
+			if (this != &handle) {
+				Release();
+				m_pPool = handle.m_pPool;
+				m_iterEntry = handle.m_iterEntry;
+				handle.m_pPool = NULL;
+			}
+			return (*this);
+		}
+
+		///	<summary>
+		///		Destructor.
+		///	</summary>
+		~Handle() {
+			Release();
+		}
+
+		///	<summary>
+		///		Release the file back to the pool.
+		///	</summary>
+		void Release();
+
+		///	<summary>
+		///		Check if the handle refers to a file.
+		///	</summary>
+		bool is_valid() const {
+			return (m_pPool != NULL);
+		}
+
+		///	<summary>
+		///		Get the open file.
+		///	</summary>
+		NcFile * operator->() const {
+			return m_iterEntry->m_pncfile.get();
+		}
+
+		///	<summary>
+		///		Get the open file.
+		///	</summary>
+		NcFile & operator*() const {
+			return *(m_iterEntry->m_pncfile);
+		}
+
+	private:
+		Handle(const Handle &);
+		Handle & operator=(const Handle &);
+
+	protected:
+		///	<summary>
+		///		Pool holding the file, or NULL for an empty handle.
+		///	</summary>
+		NcFilePool * m_pPool;
+
+		///	<summary>
+		///		Entry of the file in the pool.
+		///	</summary>
+		EntryList::iterator m_iterEntry;
+	};
+
+public:
+	///	<summary>
+	///		Default maximum number of open files.
+	///	</summary>
+	static const size_t DefaultMaxOpenFiles = 64;
+
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	NcFilePool(
+		size_t sMaxOpenFiles = DefaultMaxOpenFiles
+	) :
+		m_sMaxOpenFiles(sMaxOpenFiles)
+	{ }
+
+	///	<summary>
+	///		Get the pool shared by the indexer and the data loaders.
+	///	</summary>
+	static NcFilePool & Shared();
+
+	///	<summary>
+	///		Get the mutex serializing all calls into the NetCDF library.
+	///	</summary>
+	static std::mutex & LibraryMutex();
+
+public:
+	///	<summary>
+	///		Set the maximum number of files kept open, closing unused files
+	///		beyond it.  A maximum of zero closes files as soon as they are
+	///		released.
+	///	</summary>
+	void SetMaxOpenFiles(
+		size_t sMaxOpenFiles
+	);
+
+	///	<summary>
+	///		Get the maximum number of files kept open.
+	///	</summary>
+	size_t GetMaxOpenFiles() const {
+		return m_sMaxOpenFiles;
+	}
+
+	///	<summary>
+	///		Get the number of open files.
+	///	</summary>
+	size_t GetOpenFileCount() const {
+		return m_listEntries.size();
+	}
+
+	///	<summary>
+	///		Get a handle to the file opened for reading, opening it if it
+	///		is not already open.  Returns an error message if the file
+	///		cannot be opened.
+	///	</summary>
+	std::string Open(
+		const std::string & strFilename,
+		Handle & handle
+	);
+
+	///	<summary>
+	///		Close the file once it is no longer in use, so that the next
+	///		Open reads it from disk again.  Called when a file may have
+	///		changed since it was opened.
+	///	</summary>
+	void Evict(
+		const std::string & strFilename
+	);
+
+	///	<summary>
+	///		Close all files not in use.
+	///	</summary>
+	void Clear();
+
+protected:
+	///	<summary>
+	///		Release a handle to an entry.
+	///	</summary>
+	void Release(
+		EntryList::iterator iterEntry
+	);
+
+	///	<summary>
+	///		Close least recently used files not in use until at most the
+	///		maximum number are open.
+	///	</summary>
+	void Trim();
+
+protected:
+	///	<summary>
+	///		Maximum number of files kept open.
+	///	</summary>
+	size_t m_sMaxOpenFiles;
+
+	///	<summary>
+	///		Open files, most recently used first.
+	///	</summary>
+	EntryList m_listEntries;
+
+	///	<summary>
+	///		Open files by filename.
+	///	</summary>
+	std::unordered_map<std::string, EntryList::iterator> m_mapEntries;
+
+	///	<summary>
+	///		Entries evicted while in use, closed when their last handle is
+	///		released.
+	///	</summary>
+	EntryList m_listEvicted;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
@@ -0,0 +1,326 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    NcWriteBatch.cpp
+///	\version October 15, 2026
+///
+
+#include "NcWriteBatch.h"
+#include "NcFilePool.h"
+#include "RemoteFile.h"
+#include "TypedValueArray.h"
+#include "Exception.h"
+
+#include "netcdf.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the smallest prime not less than n, as the NetCDF library
+///		recommends for the number of slots of a chunk cache.
+///	</summary>
+static size_t NextPrime(
+	size_t n
+) {
+	if (n <= 2) {
+		return 2;
+	}
+	for (n |= 1; ; n += 2) {
+		bool fPrime = true;
+		for (size_t d = 3; d * d <= n; d += 2) {
+			if (n % d == 0) {
+				fPrime = false;
+				break;
+			}
+		}
+		if (fPrime) {
+			return n;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string NcWriteBatch::Add(
+	const std::string & strFilename,
+	const std::string & strVariableName,
+	const std::vector<long> & vecStart,
+	const std::vector<long> & vecCount,
+	const float * pData
+) {
+	if (vecStart.size() != vecCount.size()) {
+		_EXCEPTIONT("Hyperslab start and count differ in rank");
+	}
+
+	PendingSlab slab;
+	slab.m_sOffset = m_vecData.size();
+	slab.m_sSize = 1;
+	for (size_t d = 0; d < vecStart.size(); d++) {
+		if ((vecStart[d] < 0) || (vecCount[d] < 0)) {
+			return std::string("Negative hyperslab bounds for variable \"")
+				+ strVariableName + std::string("\"");
+		}
+		slab.m_vecStart.push_back(static_cast<size_t>(vecStart[d]));
+		slab.m_vecCount.push_back(static_cast<size_t>(vecCount[d]));
+		slab.m_sSize *= static_cast<size_t>(vecCount[d]);
+	}
+	if (slab.m_sSize == 0) {
+		return std::string("");
+	}
+
+	m_vecData.insert(m_vecData.end(), pData, pData + slab.m_sSize);
+	m_mapFiles[strFilename][strVariableName].push_back(slab);
+
+	if (GetPendingBytes() >= m_sMaxPendingBytes) {
+		return Flush();
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string NcWriteBatch::Flush() {
+
+	std::string strFirstError;
+
+	std::lock_guard<std::mutex> lockNetCDF(NcFilePool::LibraryMutex());
+
+	std::map<std::string, VariableSlabMap>::iterator iterFile =
+		m_mapFiles.begin();
+	for (; iterFile != m_mapFiles.end(); iterFile++) {
+		const std::string & strFilename = iterFile->first;
+
+		std::string strError;
+		if (IsRemoteURL(strFilename)) {
+			strError = std::string("Unable to write to remote file \"")
+				+ strFilename + std::string("\"");
+
+		} else {
+			// Files open for reading may not be opened again for writing
+			NcFilePool::Shared().Evict(strFilename);
+
+			int ncid;
+			int iStatus = nc_open(strFilename.c_str(), NC_WRITE, &ncid);
+			if (iStatus != NC_NOERR) {
+				strError = std::string("Unable to open data file \"")
+					+ strFilename + std::string("\" for writing: ")
+					+ std::string(nc_strerror(iStatus));
+
+			} else {
+				VariableSlabMap::iterator iterVar = iterFile->second.begin();
+				for (; iterVar != iterFile->second.end(); iterVar++) {
+					strError = FlushVariable(
+						ncid, strFilename, iterVar->first, iterVar->second);
+					if (strError != "") {
+						break;
+					}
+				}
+
+				iStatus = nc_close(ncid);
+				if ((iStatus != NC_NOERR) && (strError == "")) {
+					strError = std::string("Unable to close data file \"")
+						+ strFilename + std::string("\": ")
+						+ std::string(nc_strerror(iStatus));
+				}
+			}
+		}
+
+		if ((strError != "") && (strFirstError == "")) {
+			strFirstError = strError;
+		}
+	}
+
+	Clear();
+
+	return strFirstError;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string NcWriteBatch::FlushVariable(
+	int ncid,
+	const std::string & strFilename,
+	const std::string & strVariableName,
+	std::vector<PendingSlab> & vecSlabs
+) {
+	int varid;
+	int nDims;
+	nc_type nctype;
+	if ((nc_inq_varid(ncid, strVariableName.c_str(), &varid) != NC_NOERR) ||
+	    (nc_inq_varndims(ncid, varid, &nDims) != NC_NOERR) ||
+	    (nc_inq_vartype(ncid, varid, &nctype) != NC_NOERR)
+	) {
+		return std::string("Variable \"") + strVariableName
+			+ std::string("\" not found in \"") + strFilename
+			+ std::string("\"");
+	}
+	const size_t sValueSize = NcTypeValueSize(static_cast<NcType>(nctype));
+	if (sValueSize == 0) {
+		return std::string("Variable \"") + strVariableName
+			+ std::string("\" is not of a numeric type");
+	}
+	for (size_t s = 0; s < vecSlabs.size(); s++) {
+		if (vecSlabs[s].m_vecStart.size() != static_cast<size_t>(nDims)) {
+			return std::string("Variable \"") + strVariableName
+				+ std::string("\" in \"") + strFilename
+				+ std::string("\" does not match the rank of the data");
+		}
+	}
+	if (nDims == 0) {
+		const size_t sIndex = 0;
+		int iStatus = nc_put_var1_float(ncid, varid, &sIndex,
+			&(m_vecData[vecSlabs.back().m_sOffset]));
+		m_sPutCount++;
+		if (iStatus != NC_NOERR) {
+			return std::string("Unable to write variable \"") + strVariableName
+				+ std::string("\" to \"") + strFilename + std::string("\": ")
+				+ std::string(nc_strerror(iStatus));
+		}
+		return std::string("");
+	}
+
+	// Files other than netCDF-4 are contiguous
+	int iStorage = NC_CONTIGUOUS;
+	std::vector<size_t> vecChunk(nDims, 0);
+	if (nc_inq_var_chunking(ncid, varid, &iStorage, &(vecChunk[0])) != NC_NOERR) {
+		iStorage = NC_CONTIGUOUS;
+	}
+	const bool fChunked = (iStorage == NC_CHUNKED)
+		&& (std::find(vecChunk.begin(), vecChunk.end(), 0) == vecChunk.end());
+
+	// Visit hyperslabs in order of position, so that rows of chunks
+	// are written one after another
+	std::stable_sort(vecSlabs.begin(), vecSlabs.end(),
+		[](const PendingSlab & a, const PendingSlab & b) {
+			return (a.m_vecStart < b.m_vecStart);
+		});
+
+	// Merge hyperslabs into runs along the first dimension
+	std::vector<std::pair<size_t, size_t> > vecRuns;
+	for (size_t s = 0; s < vecSlabs.size(); s++) {
+		if (vecRuns.size() != 0) {
+			const PendingSlab & slabFirst = vecSlabs[vecRuns.back().first];
+			const PendingSlab & slabLast = vecSlabs[s-1];
+			const PendingSlab & slab = vecSlabs[s];
+
+			bool fMerge =
+				(slab.m_vecStart[0] == slabLast.m_vecStart[0] + slabLast.m_vecCount[0])
+				&& std::equal(
+					slab.m_vecStart.begin() + 1, slab.m_vecStart.end(),
+					slabFirst.m_vecStart.begin() + 1)
+				&& std::equal(
+					slab.m_vecCount.begin() + 1, slab.m_vecCount.end(),
+					slabFirst.m_vecCount.begin() + 1);
+			if (fMerge && fChunked) {
+				fMerge = (slab.m_vecStart[0] / vecChunk[0]
+					== slabFirst.m_vecStart[0] / vecChunk[0]);
+			}
+			if (fMerge) {
+				vecRuns.back().second++;
+				continue;
+			}
+		}
+		vecRuns.push_back(std::pair<size_t, size_t>(s, 1));
+	}
+
+	// Size the chunk cache to hold every chunk touched by the largest run
+	if (fChunked) {
+		size_t sChunkBytes = sValueSize;
+		for (int d = 0; d < nDims; d++) {
+			sChunkBytes *= vecChunk[d];
+		}
+
+		size_t sMaxChunks = 1;
+		for (size_t r = 0; r < vecRuns.size(); r++) {
+			const PendingSlab & slabFirst = vecSlabs[vecRuns[r].first];
+			const PendingSlab & slabLast =
+				vecSlabs[vecRuns[r].first + vecRuns[r].second - 1];
+
+			size_t sChunks =
+				(slabLast.m_vecStart[0] + slabLast.m_vecCount[0] - 1) / vecChunk[0]
+				- slabFirst.m_vecStart[0] / vecChunk[0] + 1;
+			for (int d = 1; d < nDims; d++) {
+				sChunks *=
+					(slabFirst.m_vecStart[d] + slabFirst.m_vecCount[d] - 1) / vecChunk[d]
+					- slabFirst.m_vecStart[d] / vecChunk[d] + 1;
+			}
+			sMaxChunks = std::max(sMaxChunks, sChunks);
+		}
+
+		const size_t sCacheBytes =
+			std::min(sMaxChunks * sChunkBytes, MaxChunkCacheBytes);
+		const size_t sCacheChunks =
+			std::max<size_t>(sCacheBytes / std::max<size_t>(sChunkBytes, 1), 1);
+
+		// Chunks are written in full, so they may always be preempted
+		nc_set_var_chunk_cache(
+			ncid, varid, sCacheBytes, NextPrime(10 * sCacheChunks), 1.0f);
+	}
+
+	// Write each run with one call
+	for (size_t r = 0; r < vecRuns.size(); r++) {
+		const PendingSlab & slabFirst = vecSlabs[vecRuns[r].first];
+
+		std::vector<size_t> vecCount = slabFirst.m_vecCount;
+		const float * pData = &(m_vecData[slabFirst.m_sOffset]);
+		if (vecRuns[r].second != 1) {
+			size_t sSize = 0;
+			for (size_t s = 0; s < vecRuns[r].second; s++) {
+				sSize += vecSlabs[vecRuns[r].first + s].m_sSize;
+			}
+			m_vecGather.resize(sSize);
+
+			size_t sOffset = 0;
+			for (size_t s = 1; s < vecRuns[r].second; s++) {
+				vecCount[0] += vecSlabs[vecRuns[r].first + s].m_vecCount[0];
+			}
+			for (size_t s = 0; s < vecRuns[r].second; s++) {
+				const PendingSlab & slab = vecSlabs[vecRuns[r].first + s];
+				memcpy(&(m_vecGather[sOffset]), &(m_vecData[slab.m_sOffset]),
+					slab.m_sSize * sizeof(float));
+				sOffset += slab.m_sSize;
+			}
+			pData = &(m_vecGather[0]);
+		}
+
+		int iStatus = nc_put_vara_float(ncid, varid,
+			&(slabFirst.m_vecStart[0]), &(vecCount[0]), pData);
+		m_sPutCount++;
+		if (iStatus != NC_NOERR) {
+			return std::string("Unable to write variable \"") + strVariableName
+				+ std::string("\" to \"") + strFilename + std::string("\": ")
+				+ std::string(nc_strerror(iStatus));
+		}
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void NcWriteBatch::Clear() {
+	m_mapFiles.clear();
+	std::vector<float>().swap(m_vecData);
+	std::vector<float>().swap(m_vecGather);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t NcWriteBatch::size() const {
+	size_t sSlabs = 0;
+	std::map<std::string, VariableSlabMap>::const_iterator iterFile =
+		m_mapFiles.begin();
+	for (; iterFile != m_mapFiles.end(); iterFile++) {
+		VariableSlabMap::const_iterator iterVar = iterFile->second.begin();
+		for (; iterVar != iterFile->second.end(); iterVar++) {
+			sSlabs += iterVar->second.size();
+		}
+	}
+	return sSlabs;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
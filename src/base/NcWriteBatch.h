@@ -0,0 +1,175 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    NcWriteBatch.h
+///	\version October 15, 2026
+///
+
+#ifndef _NCWRITEBATCH_H_
+#define _NCWRITEBATCH_H_
+
+#include <string>
+#include <vector>
+#include <map>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A batch of hyperslabs of float data written to NetCDF files.
+///		Hyperslabs are held in memory until Flush(), which opens each file
+///		once and writes the hyperslabs of each variable in order of their
+///		position.  Hyperslabs adjacent along the first (record) dimension
+///		and equal along the others are merged, up to the end of a chunk
+///		along the first dimension, so that each row of chunks is written
+///		with one call.  The chunk cache of each chunked variable is sized
+///		to hold a full row of the chunks being written, so that no chunk
+///		is evicted and read back before it is complete.
+///
+///		Hyperslabs of a batch should not overlap; where they do, the order
+///		in which they are written is unspecified.
+///	</summary>
+class NcWriteBatch {
+
+public:
+	///	<summary>
+	///		Default number of bytes held before the batch is flushed.
+	///	</summary>
+	static const size_t DefaultMaxPendingBytes = 256 * 1024 * 1024;
+
+	///	<summary>
+	///		Largest chunk cache set for a variable, in bytes.
+	///	</summary>
+	static const size_t MaxChunkCacheBytes = 1024 * 1024 * 1024;
+
+public:
+	///	<summary>
+	///		Constructor.  The batch is flushed by Add once sMaxPendingBytes
+	///		of data are held.
+	///	</summary>
+	NcWriteBatch(
+		size_t sMaxPendingBytes = DefaultMaxPendingBytes
+	) :
+		m_sMaxPendingBytes(sMaxPendingBytes),
+		m_sPutCount(0)
+	{ }
+
+public:
+	///	<summary>
+	///		Add a hyperslab of a variable, with the given start and count
+	///		along each dimension, whose data in row-major order is copied
+	///		from pData.  Returns an error message if the batch is flushed
+	///		and the flush fails.
+	///	</summary>
+	std::string Add(
+		const std::string & strFilename,
+		const std::string & strVariableName,
+		const std::vector<long> & vecStart,
+		const std::vector<long> & vecCount,
+		const float * pData
+	);
+
+	///	<summary>
+	///		Write all hyperslabs held and remove them from the batch, even
+	///		if some could not be written.  Returns an error message on
+	///		failure.
+	///	</summary>
+	std::string Flush();
+
+	///	<summary>
+	///		Remove all hyperslabs held without writing them.
+	///	</summary>
+	void Clear();
+
+	///	<summary>
+	///		Get the number of hyperslabs held.
+	///	</summary>
+	size_t size() const;
+
+	///	<summary>
+	///		Get the number of bytes of data held.
+	///	</summary>
+	size_t GetPendingBytes() const {
+		return m_vecData.size() * sizeof(float);
+	}
+
+	///	<summary>
+	///		Get the number of writes into the NetCDF library made by all
+	///		flushes so far.
+	///	</summary>
+	size_t GetPutCount() const {
+		return m_sPutCount;
+	}
+
+protected:
+	///	<summary>
+	///		A hyperslab held by the batch.
+	///	</summary>
+	class PendingSlab {
+
+	public:
+		///	<summary>
+		///		Start of the hyperslab along each dimension.
+		///	</summary>
+		std::vector<size_t> m_vecStart;
+
+		///	<summary>
+		///		Size of the hyperslab along each dimension.
+		///	</summary>
+		std::vector<size_t> m_vecCount;
+
+		///	<summary>
+		///		Offset of the data of the hyperslab in m_vecData.
+		///	</summary>
+		size_t m_sOffset;
+
+		///	<summary>
+		///		Number of values of the hyperslab.
+		///	</summary>
+		size_t m_sSize;
+	};
+
+	///	<summary>
+	///		Hyperslabs held for each variable of a file.
+	///	</summary>
+	typedef std::map<std::string, std::vector<PendingSlab> > VariableSlabMap;
+
+	///	<summary>
+	///		Write the hyperslabs of one variable of an open file.
+	///	</summary>
+	std::string FlushVariable(
+		int ncid,
+		const std::string & strFilename,
+		const std::string & strVariableName,
+		std::vector<PendingSlab> & vecSlabs
+	);
+
+protected:
+	///	<summary>
+	///		Number of bytes held before the batch is flushed.
+	///	</summary>
+	size_t m_sMaxPendingBytes;
+
+	///	<summary>
+	///		Hyperslabs held for each file.
+	///	</summary>
+	std::map<std::string, VariableSlabMap> m_mapFiles;
+
+	///	<summary>
+	///		Data of all hyperslabs held.
+	///	</summary>
+	std::vector<float> m_vecData;
+
+	///	<summary>
+	///		Buffer into which merged hyperslabs are gathered.
+	///	</summary>
+	std::vector<float> m_vecGather;
+
+	///	<summary>
+	///		Number of writes into the NetCDF library.
+	///	</summary>
+	size_t m_sPutCount;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
@@ -18,9 +18,13 @@
 #include "STLStringHelper.h"
 #include "Exception.h"
 #include "DataArray1D.h"
+#include "NcFilePool.h"
 #include "netcdfcpp.h"
 
 #include <vector>
+#include <mutex>
+#include <cstdio>
+#include <cstring>
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -164,6 +168,132 @@ NcType StringToNcType(
 
 ////////////////////////////////////////////////////////////////////////////////
 
+bool GetNcAttName(
+	int ncid,
+	int varid,
+	int iAtt,
+	char * szAttName
+) {
+	return (nc_inq_attname(ncid, varid, iAtt, szAttName) == NC_NOERR);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check that an attribute exists and is numeric, and get its length.
+///	</summary>
+static bool InqNcNumericAtt(
+	int ncid,
+	int varid,
+	const char * szAttName,
+	size_t & sLength
+) {
+	nc_type nctype;
+	if (nc_inq_att(ncid, varid, szAttName, &nctype, &sLength) != NC_NOERR) {
+		return false;
+	}
+	return (nctype != NC_CHAR) && (nctype != NC_STRING);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool GetNcAttAsDoubles(
+	int ncid,
+	int varid,
+	const char * szAttName,
+	std::vector<double> & vecValues
+) {
+	size_t sLength;
+	if (!InqNcNumericAtt(ncid, varid, szAttName, sLength)) {
+		return false;
+	}
+	vecValues.resize(sLength);
+	if (sLength == 0) {
+		return true;
+	}
+	return (nc_get_att_double(ncid, varid, szAttName, &(vecValues[0])) == NC_NOERR);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool GetNcAttAsInt64s(
+	int ncid,
+	int varid,
+	const char * szAttName,
+	std::vector<long long> & vecValues
+) {
+	size_t sLength;
+	if (!InqNcNumericAtt(ncid, varid, szAttName, sLength)) {
+		return false;
+	}
+	vecValues.resize(sLength);
+	if (sLength == 0) {
+		return true;
+	}
+	return (nc_get_att_longlong(ncid, varid, szAttName, &(vecValues[0])) == NC_NOERR);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool GetNcAttAsString(
+	int ncid,
+	int varid,
+	const char * szAttName,
+	std::string & strValue
+) {
+	static thread_local std::vector<char> s_vecText;
+	static thread_local std::vector<long long> s_vecInteger;
+	static thread_local std::vector<double> s_vecReal;
+
+	nc_type nctype;
+	size_t sLength;
+	if (nc_inq_att(ncid, varid, szAttName, &nctype, &sLength) != NC_NOERR) {
+		return false;
+	}
+
+	// Text, including bytes, is read up to the first null character
+	if ((nctype == NC_CHAR) || (nctype == NC_BYTE)) {
+		s_vecText.resize(sLength + 1);
+		int status =
+			(nctype == NC_CHAR)
+			?(nc_get_att_text(ncid, varid, szAttName, &(s_vecText[0])))
+			:(nc_get_att_schar(ncid, varid, szAttName,
+				reinterpret_cast<signed char *>(&(s_vecText[0]))));
+		if (status != NC_NOERR) {
+			return false;
+		}
+		s_vecText[sLength] = '\0';
+		strValue.assign(&(s_vecText[0]), strlen(&(s_vecText[0])));
+		return true;
+	}
+
+	if (sLength == 0) {
+		strValue.clear();
+		return true;
+	}
+
+	// Numeric values are formatted as std::ostream formats them
+	char szBuffer[64];
+	if ((nctype == NC_FLOAT) || (nctype == NC_DOUBLE)) {
+		s_vecReal.resize(sLength);
+		if (nc_get_att_double(ncid, varid, szAttName, &(s_vecReal[0])) != NC_NOERR) {
+			return false;
+		}
+		snprintf(szBuffer, sizeof(szBuffer), "%g", s_vecReal[0]);
+
+	} else {
+		s_vecInteger.resize(sLength);
+		if (nc_get_att_longlong(ncid, varid, szAttName, &(s_vecInteger[0])) != NC_NOERR) {
+			return false;
+		}
+		snprintf(szBuffer, sizeof(szBuffer), "%lld", s_vecInteger[0]);
+	}
+	strValue.assign(szBuffer);
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void CopyNcFileAttributes(
 	NcFile * fileIn,
 	NcFile * fileOut
@@ -418,3 +548,23 @@ void CopyNcVar(
 ////////////////////////////////////////////////////////////////////////////////
 
 
+
+void CopyNcVar(
+	const std::string & strInputFile,
+	NcFile & ncOut,
+	const std::string & strVarName,
+	bool fCopyAttributes
+) {
+	std::lock_guard<std::mutex> lockNetCDF(NcFilePool::LibraryMutex());
+
+	NcFilePool::Handle handle;
+	std::string strError = NcFilePool::Shared().Open(strInputFile, handle);
+	if (strError != "") {
+		_EXCEPTIONT(strError.c_str());
+	}
+
+	CopyNcVar(*handle, ncOut, strVarName, fCopyAttributes);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
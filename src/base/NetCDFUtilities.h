@@ -18,6 +18,7 @@
 #define _NETCDFUTILITIES_H_
 
 #include <string>
+#include <vector>
 #include "netcdfcpp.h"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -49,6 +50,69 @@ NcType StringToNcType(
 
 ////////////////////////////////////////////////////////////////////////////////
 
+///	<summary>
+///		Get the name of attribute iAtt of variable varid in file ncid, or
+///		of a global attribute if varid is NC_GLOBAL, without allocating an
+///		NcAtt.  szAttName must hold NC_MAX_NAME+1 characters.  Returns
+///		false if the attribute does not exist.
+///	</summary>
+bool GetNcAttName(
+	int ncid,
+	int varid,
+	int iAtt,
+	char * szAttName
+);
+
+////////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the value of an attribute as a string, as NcAtt::as_string(0)
+///		gives it: text attributes are read whole, and numeric attributes
+///		are read with the typed NetCDF calls and represented by their
+///		first value.  Values are read into a buffer reused by each
+///		thread, so no allocation is made beyond the string itself.
+///		Returns false if the attribute cannot be read.
+///	</summary>
+bool GetNcAttAsString(
+	int ncid,
+	int varid,
+	const char * szAttName,
+	std::string & strValue
+);
+
+////////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the values of a numeric attribute as doubles, converted by
+///		the NetCDF library.  vecValues is resized to the length of the
+///		attribute.  Returns false if the attribute does not exist, is
+///		text or cannot be read.
+///	</summary>
+bool GetNcAttAsDoubles(
+	int ncid,
+	int varid,
+	const char * szAttName,
+	std::vector<double> & vecValues
+);
+
+////////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the values of a numeric attribute as 64-bit integers,
+///		converted by the NetCDF library.  vecValues is resized to the
+///		length of the attribute.  Returns false if the attribute does not
+///		exist, is text, cannot be read or does not fit in a 64-bit
+///		integer.
+///	</summary>
+bool GetNcAttAsInt64s(
+	int ncid,
+	int varid,
+	const char * szAttName,
+	std::vector<long long> & vecValues
+);
+
+////////////////////////////////////////////////////////////////////////////////
+
 void CopyNcFileAttributes(
 	NcFile * fileIn,
 	NcFile * fileOut
@@ -72,5 +136,18 @@ void CopyNcVar(
 
 ////////////////////////////////////////////////////////////////////////////////
 
+///	<summary>
+///		Copy a variable from a file opened for reading through the shared
+///		NcFilePool.
+///	</summary>
+void CopyNcVar(
+	const std::string & strInputFile,
+	NcFile & ncOut,
+	const std::string & strVarName,
+	bool fCopyAttributes = true
+);
+
+////////////////////////////////////////////////////////////////////////////////
+
 #endif
 
@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    NumberFormat.cpp
+///	\version October 14, 2026
+///
+
+#include "NumberFormat.h"
+
+#include "../contrib/json.hpp"
+
+#include <cmath>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write a non-finite value as the standard streams do.
+///	</summary>
+template <typename T>
+static char * FormatNonFinite(
+	char * szBuffer,
+	T value
+) {
+	const char * szText;
+	if (std::isnan(value)) {
+		szText = "nan";
+	} else if (value > 0) {
+		szText = "inf";
+	} else {
+		szText = "-inf";
+	}
+	size_t sLength = strlen(szText);
+	memcpy(szBuffer, szText, sLength);
+	return szBuffer + sLength;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+char * FormatNumber(
+	char * szBuffer,
+	double d
+) {
+	if (!std::isfinite(d)) {
+		return FormatNonFinite(szBuffer, d);
+	}
+	return nlohmann::detail::to_chars(
+		szBuffer, szBuffer + NumberFormatMaxChars, d);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+char * FormatNumber(
+	char * szBuffer,
+	float fl
+) {
+	if (!std::isfinite(fl)) {
+		return FormatNonFinite(szBuffer, fl);
+	}
+	return nlohmann::detail::to_chars(
+		szBuffer, szBuffer + NumberFormatMaxChars, fl);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+char * FormatNumber(
+	char * szBuffer,
+	int i
+) {
+	// Work with the magnitude as unsigned so INT_MIN is representable
+	unsigned int u = static_cast<unsigned int>(i);
+	if (i < 0) {
+		*(szBuffer++) = '-';
+		u = 0u - u;
+	}
+
+	char szDigits[16];
+	int nDigits = 0;
+	do {
+		szDigits[nDigits++] = static_cast<char>('0' + (u % 10));
+		u /= 10;
+	} while (u != 0);
+
+	while (nDigits > 0) {
+		*(szBuffer++) = szDigits[--nDigits];
+	}
+	return szBuffer;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+char * FormatNumber(
+	char * szBuffer,
+	unsigned long long ull
+) {
+	char szDigits[24];
+	int nDigits = 0;
+	do {
+		szDigits[nDigits++] = static_cast<char>('0' + (ull % 10));
+		ull /= 10;
+	} while (ull != 0);
+
+	while (nDigits > 0) {
+		*(szBuffer++) = szDigits[--nDigits];
+	}
+	return szBuffer;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+char * FormatNumber(
+	char * szBuffer,
+	long long ll
+) {
+	// Work with the magnitude as unsigned so LLONG_MIN is representable
+	unsigned long long ull = static_cast<unsigned long long>(ll);
+	if (ll < 0) {
+		*(szBuffer++) = '-';
+		ull = 0ull - ull;
+	}
+	return FormatNumber(szBuffer, ull);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    NumberFormat.h
+///	\version October 14, 2026
+///
+
+#ifndef _NUMBERFORMAT_H_
+#define _NUMBERFORMAT_H_
+
+#include <cstddef>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Maximum number of characters written by FormatNumber.
+///	</summary>
+static const size_t NumberFormatMaxChars = 32;
+
+///	<summary>
+///		Write the shortest decimal representation that reads back as
+///		the given double, in the format used for JSON output, and return
+///		a pointer past the last character written.  The buffer must hold
+///		NumberFormatMaxChars characters and is not null-terminated.
+///		Non-finite values are written as nan, inf and -inf.
+///	</summary>
+char * FormatNumber(
+	char * szBuffer,
+	double d
+);
+
+///	<summary>
+///		Write the shortest decimal representation that reads back as
+///		the given float.
+///	</summary>
+char * FormatNumber(
+	char * szBuffer,
+	float fl
+);
+
+///	<summary>
+///		Write an int in decimal.
+///	</summary>
+char * FormatNumber(
+	char * szBuffer,
+	int i
+);
+
+///	<summary>
+///		Write a long long in decimal.
+///	</summary>
+char * FormatNumber(
+	char * szBuffer,
+	long long ll
+);
+
+///	<summary>
+///		Write an unsigned long long in decimal.
+///	</summary>
+char * FormatNumber(
+	char * szBuffer,
+	unsigned long long ull
+);
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    ObjectPool.h
+///	\version October 14, 2026
+///
+
+#ifndef _OBJECTPOOL_H_
+#define _OBJECTPOOL_H_
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <mutex>
+#include <type_traits>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A pool of storage for objects of type T, allocated in blocks of
+///		BlockObjects objects and recycled through a free list.  Classes
+///		route their operator new and operator delete through Shared() so
+///		that the many small objects of an index come from a few large
+///		allocations.  Requests for any other size, as made by derived
+///		classes, go to the global allocator.  The blocks are released
+///		once every object in the pool has been deleted.
+///	</summary>
+template <typename T, size_t BlockObjects = 256>
+class ObjectPool {
+
+protected:
+	///	<summary>
+	///		Storage for one object, linked into the free list when unused.
+	///	</summary>
+	union Slot {
+		Slot * m_pnext;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type m_storage;
+	};
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	ObjectPool() :
+		m_pfree(NULL),
+		m_sLive(0)
+	{ }
+
+	///	<summary>
+	///		Destructor.
+	///	</summary>
+	~ObjectPool() {
+		ReleaseBlocks();
+	}
+
+	///	<summary>
+	///		Get the pool shared by all objects of type T.  The pool is
+	///		never destroyed, so objects may be deleted during static
+	///		destruction.
+	///	</summary>
+	static ObjectPool & Shared() {
+		static ObjectPool * s_ppool = new ObjectPool;
+		return *s_ppool;
+	}
+
+public:
+	///	<summary>
+	///		Allocate storage for an object of the given size.
+	///	</summary>
+	void * Allocate(
+		size_t sSize
+	) {
+		if (sSize != sizeof(T)) {
+			return ::operator new(sSize);
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_pfree == NULL) {
+			Slot * pblock = static_cast<Slot *>(
+				::operator new(BlockObjects * sizeof(Slot)));
+			m_vecBlocks.push_back(pblock);
+			for (size_t i = BlockObjects; i > 0; i--) {
+				pblock[i-1].m_pnext = m_pfree;
+				m_pfree = &(pblock[i-1]);
+			}
+		}
+
+		Slot * pslot = m_pfree;
+		m_pfree = pslot->m_pnext;
+		m_sLive++;
+		return static_cast<void *>(pslot);
+	}
+
+	///	<summary>
+	///		Return storage obtained from Allocate with the same size.
+	///	</summary>
+	void Deallocate(
+		void * p,
+		size_t sSize
+	) {
+		if (p == NULL) {
+			return;
+		}
+		if (sSize != sizeof(T)) {
+			::operator delete(p);
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Slot * pslot = static_cast<Slot *>(p);
+		pslot->m_pnext = m_pfree;
+		m_pfree = pslot;
+		m_sLive--;
+		if (m_sLive == 0) {
+			ReleaseBlocks();
+		}
+	}
+
+	///	<summary>
+	///		Get the number of objects allocated from the pool.
+	///	</summary>
+	size_t GetLiveCount() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_sLive;
+	}
+
+	///	<summary>
+	///		Get the number of bytes held by the pool.
+	///	</summary>
+	size_t GetReservedBytes() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_vecBlocks.size() * BlockObjects * sizeof(Slot);
+	}
+
+protected:
+	///	<summary>
+	///		Free all blocks; no object may be live.
+	///	</summary>
+	void ReleaseBlocks() {
+		for (size_t b = 0; b < m_vecBlocks.size(); b++) {
+			::operator delete(static_cast<void *>(m_vecBlocks[b]));
+		}
+		m_vecBlocks.clear();
+		m_pfree = NULL;
+	}
+
+protected:
+	///	<summary>
+	///		Mutex guarding the pool.
+	///	</summary>
+	std::mutex m_mutex;
+
+	///	<summary>
+	///		Blocks of slots.
+	///	</summary>
+	std::vector<Slot *> m_vecBlocks;
+
+	///	<summary>
+	///		First unused slot.
+	///	</summary>
+	Slot * m_pfree;
+
+	///	<summary>
+	///		Number of slots in use.
+	///	</summary>
+	size_t m_sLive;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Declare operator new and operator delete of class CLASS in terms
+///		of ObjectPool<CLASS>::Shared().
+///	</summary>
+#define OBJECTPOOL_ALLOCATED(CLASS) \
+	static void * operator new(size_t sSize) { \
+		return ObjectPool<CLASS>::Shared().Allocate(sSize); \
+	} \
+	static void operator delete(void * p, size_t sSize) { \
+		ObjectPool<CLASS>::Shared().Deallocate(p, sSize); \
+	}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
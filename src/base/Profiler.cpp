@@ -0,0 +1,721 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    Profiler.cpp
+///	\version October 14, 2026
+///
+
+#include "Profiler.h"
+#include "../contrib/json.hpp"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#if defined(HYPERION_MPIOMP)
+#include <mpi.h>
+#endif
+
+#include <ctime>
+#include <cctype>
+#include <cstdio>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+///////////////////////////////////////////////////////////////////////////////
+// Profiler::Histogram
+///////////////////////////////////////////////////////////////////////////////
+
+void Profiler::Histogram::Add(
+	double dSeconds
+) {
+	m_sCount++;
+	m_dTotal += dSeconds;
+	if (dSeconds > m_dMax) {
+		m_dMax = dSeconds;
+	}
+
+	size_t b = 0;
+	double dMicroseconds = dSeconds * 1.0e6;
+	while ((b < HistogramBuckets - 1) &&
+	       (dMicroseconds >= static_cast<double>(1ull << b))
+	) {
+		b++;
+	}
+	m_vecBuckets[b]++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Profiler
+///////////////////////////////////////////////////////////////////////////////
+
+Profiler & Profiler::Shared() {
+	static Profiler s_profiler;
+	return s_profiler;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+Profiler::~Profiler() {
+	StopRSSSampling();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+double Profiler::ProcessCPUTime() {
+	struct timespec ts;
+	if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) {
+		return 0.0;
+	}
+	return static_cast<double>(ts.tv_sec)
+		+ 1.0e-9 * static_cast<double>(ts.tv_nsec);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t Profiler::ResidentSetBytes() {
+	FILE * fp = fopen("/proc/self/statm", "r");
+	if (fp == NULL) {
+		return 0;
+	}
+	unsigned long ulSize = 0;
+	unsigned long ulResident = 0;
+	int nRead = fscanf(fp, "%lu %lu", &ulSize, &ulResident);
+	fclose(fp);
+	if (nRead != 2) {
+		return 0;
+	}
+	return static_cast<size_t>(ulResident)
+		* static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t Profiler::PeakResidentSetBytes() {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+#if defined(__APPLE__)
+	return static_cast<size_t>(usage.ru_maxrss);
+#else
+	return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Profiler::Enable() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (IsEnabled()) {
+		return;
+	}
+	m_tEnabled = Clock::now();
+	m_dCPUEnabled = ProcessCPUTime();
+	m_fEnabled.store(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Profiler::BeginPhase(
+	const char * szName
+) {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	// Block text often ends in a newline
+	std::string strName((szName != NULL)?(szName):(""));
+	while ((strName.length() != 0) && isspace(strName[strName.length()-1])) {
+		strName.resize(strName.length()-1);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Phase phase;
+	phase.m_strName = strName;
+	phase.m_sDepth = m_vecOpenPhases.size();
+	phase.m_tBegin = Clock::now();
+	phase.m_dCPUBegin = ProcessCPUTime();
+	phase.m_dWallTime = 0.0;
+	phase.m_dCPUTime = 0.0;
+	phase.m_fEnded = false;
+
+	m_vecOpenPhases.push_back(m_vecPhases.size());
+	m_vecPhases.push_back(phase);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Profiler::EndPhase() {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_vecOpenPhases.size() == 0) {
+		return;
+	}
+	Phase & phase = m_vecPhases[m_vecOpenPhases.back()];
+	m_vecOpenPhases.pop_back();
+
+	phase.m_dWallTime = SecondsSince(phase.m_tBegin);
+	phase.m_dCPUTime = ProcessCPUTime() - phase.m_dCPUBegin;
+	phase.m_fEnded = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Profiler::AddFileStage(
+	ProfilerFileStage stage,
+	double dSeconds
+) {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_histStage[stage].Add(dSeconds);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Profiler::AddFile(
+	const std::string & strFilename,
+	double dOpenTime,
+	double dHeaderTime,
+	double dMergeTime
+) {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	const double dTotal = dOpenTime + dHeaderTime + dMergeTime;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if ((m_vecSlowestFiles.size() == SlowestFileCount) &&
+	    (dTotal <= m_vecSlowestFiles.front().m_dTotal)
+	) {
+		return;
+	}
+
+	FileTiming timing;
+	timing.m_strFilename = strFilename;
+	timing.m_dStage[ProfilerFileStage_Open] = dOpenTime;
+	timing.m_dStage[ProfilerFileStage_Header] = dHeaderTime;
+	timing.m_dStage[ProfilerFileStage_Merge] = dMergeTime;
+	timing.m_dTotal = dTotal;
+
+	if (m_vecSlowestFiles.size() == SlowestFileCount) {
+		std::pop_heap(
+			m_vecSlowestFiles.begin(),
+			m_vecSlowestFiles.end(),
+			FileTiming::TotalGreater);
+		m_vecSlowestFiles.back() = timing;
+	} else {
+		m_vecSlowestFiles.push_back(timing);
+	}
+	std::push_heap(
+		m_vecSlowestFiles.begin(),
+		m_vecSlowestFiles.end(),
+		FileTiming::TotalGreater);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Profiler::RecordMemory(
+	const std::string & strStructure,
+	size_t sBytes,
+	size_t sObjects
+) {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	MemoryUsage & usage = m_mapMemory[strStructure];
+	usage.m_sBytes = sBytes;
+	usage.m_sObjects = sObjects;
+	if (sBytes > usage.m_sPeakBytes) {
+		usage.m_sPeakBytes = sBytes;
+	}
+	if (sObjects > usage.m_sPeakObjects) {
+		usage.m_sPeakObjects = sObjects;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Profiler::StartRSSSampling(
+	double dIntervalSeconds
+) {
+	if (!IsEnabled() || (dIntervalSeconds <= 0.0)) {
+		return;
+	}
+
+	StopRSSSampling();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_dRSSInterval = dIntervalSeconds;
+	m_fStopRSSSampling = false;
+	m_threadRSSSampling = std::thread([this]() {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		for (;;) {
+			m_condStopRSSSampling.wait_for(
+				lock,
+				std::chrono::duration<double>(m_dRSSInterval),
+				[this]() { return m_fStopRSSSampling; });
+			if (m_fStopRSSSampling) {
+				break;
+			}
+
+			RSSSample sample;
+			sample.m_dTime = SecondsSince(m_tEnabled);
+			sample.m_sBytes = ResidentSetBytes();
+
+			// Keep long runs to a bounded number of evenly spaced samples
+			if (m_vecRSSSamples.size() == MaxRSSSamples) {
+				for (size_t i = 0; i < MaxRSSSamples / 2; i++) {
+					m_vecRSSSamples[i] = m_vecRSSSamples[2*i+1];
+				}
+				m_vecRSSSamples.resize(MaxRSSSamples / 2);
+				m_dRSSInterval *= 2.0;
+			}
+			m_vecRSSSamples.push_back(sample);
+		}
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Profiler::StopRSSSampling() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_fStopRSSSampling = true;
+	}
+	m_condStopRSSSampling.notify_all();
+	if (m_threadRSSSampling.joinable()) {
+		m_threadRSSSampling.join();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Profiler::AddRankWork(
+	size_t sFiles,
+	unsigned long long ullFileBytes,
+	double dBusyTime,
+	double dIdleTime
+) {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_sRankFiles += sFiles;
+	m_ullRankFileBytes += ullFileBytes;
+	m_dRankBusyTime += dBusyTime;
+	m_dRankIdleTime += dIdleTime;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(HYPERION_MPIOMP)
+
+///	<summary>
+///		Gather a JSON object from every rank on rank 0, in rank order.
+///		vecAll is left empty on the other ranks.
+///	</summary>
+static void MPIGatherJSON(
+	const nlohmann::json & jLocal,
+	std::vector<nlohmann::json> & vecAll
+) {
+	int nRank;
+	int nCommSize;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nCommSize);
+
+	std::string strLocal = jLocal.dump();
+	int nLength = static_cast<int>(strLocal.length());
+
+	std::vector<int> vecLengths(nCommSize, 0);
+	MPI_Gather(&nLength, 1, MPI_INT, &(vecLengths[0]), 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+	std::vector<int> vecOffsets(nCommSize, 0);
+	int nTotal = 0;
+	for (int r = 0; r < nCommSize; r++) {
+		vecOffsets[r] = nTotal;
+		nTotal += vecLengths[r];
+	}
+
+	std::vector<char> vecBuffer(std::max(nTotal, 1));
+	MPI_Gatherv(
+		const_cast<char *>(strLocal.data()), nLength, MPI_CHAR,
+		&(vecBuffer[0]), &(vecLengths[0]), &(vecOffsets[0]), MPI_CHAR,
+		0, MPI_COMM_WORLD);
+
+	vecAll.clear();
+	if (nRank != 0) {
+		return;
+	}
+	for (int r = 0; r < nCommSize; r++) {
+		vecAll.push_back(
+			nlohmann::json::parse(
+				std::string(&(vecBuffer[0]) + vecOffsets[r], vecLengths[r])));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Reduce a value of several ranks to its minimum, mean and maximum,
+///		the rank holding the maximum, and the ratio of the maximum to the
+///		mean.
+///	</summary>
+static void ReduceRankValues(
+	const std::vector<double> & vecValues,
+	const std::vector<int> & vecRanks,
+	nlohmann::json & j
+) {
+	if (vecValues.size() == 0) {
+		return;
+	}
+
+	size_t sMin = 0;
+	size_t sMax = 0;
+	double dSum = 0.0;
+	for (size_t i = 0; i < vecValues.size(); i++) {
+		if (vecValues[i] < vecValues[sMin]) {
+			sMin = i;
+		}
+		if (vecValues[i] > vecValues[sMax]) {
+			sMax = i;
+		}
+		dSum += vecValues[i];
+	}
+	const double dMean = dSum / static_cast<double>(vecValues.size());
+
+	j["min"] = vecValues[sMin];
+	j["mean"] = dMean;
+	j["max"] = vecValues[sMax];
+	j["max_rank"] = vecRanks[sMax];
+	j["max_over_mean"] = (dMean > 0.0)?(vecValues[sMax] / dMean):(1.0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Reduce the summaries of all ranks.  Phases of different ranks are
+///		matched by name, depth and the number of earlier phases with the
+///		same name and depth.
+///	</summary>
+static void ReduceRankSummaries(
+	const std::vector<nlohmann::json> & vecSummaries,
+	nlohmann::json & jRanks
+) {
+	static const char * const s_szWorkNames[] = {
+		"files",
+		"file_bytes",
+		"busy_s",
+		"idle_s",
+		"coordinate_bytes_read",
+		"wall_time_s",
+		"cpu_time_s",
+		"peak_rss_bytes"
+	};
+	static const size_t s_sWorkNameCount =
+		sizeof(s_szWorkNames) / sizeof(s_szWorkNames[0]);
+
+	jRanks["count"] = vecSummaries.size();
+
+	// Work of each rank, and its reduction
+	std::vector<int> vecAllRanks;
+	nlohmann::json & jPerRank = jRanks["per_rank"];
+	jPerRank = nlohmann::json::array();
+	for (size_t r = 0; r < vecSummaries.size(); r++) {
+		vecAllRanks.push_back(vecSummaries[r]["rank"].get<int>());
+		nlohmann::json jRank;
+		jRank["rank"] = vecSummaries[r]["rank"];
+		for (size_t w = 0; w < s_sWorkNameCount; w++) {
+			jRank[s_szWorkNames[w]] = vecSummaries[r][s_szWorkNames[w]];
+		}
+		jPerRank.push_back(jRank);
+	}
+
+	nlohmann::json & jWork = jRanks["work"];
+	for (size_t w = 0; w < s_sWorkNameCount; w++) {
+		std::vector<double> vecValues;
+		for (size_t r = 0; r < vecSummaries.size(); r++) {
+			vecValues.push_back(vecSummaries[r][s_szWorkNames[w]].get<double>());
+		}
+		ReduceRankValues(vecValues, vecAllRanks, jWork[s_szWorkNames[w]]);
+	}
+
+	// Phases, in the order they first appear
+	std::vector<nlohmann::json> vecPhases;
+	std::vector< std::vector<double> > vecWallTimes;
+	std::vector< std::vector<double> > vecCPUTimes;
+	std::vector< std::vector<int> > vecPhaseRanks;
+	std::map<std::string, size_t> mapPhaseIx;
+
+	for (size_t r = 0; r < vecSummaries.size(); r++) {
+		const nlohmann::json & jRankPhases = vecSummaries[r]["phases"];
+		std::map<std::string, size_t> mapOccurrences;
+		for (size_t p = 0; p < jRankPhases.size(); p++) {
+			const nlohmann::json & jPhase = jRankPhases[p];
+			std::string strName = jPhase["name"].get<std::string>();
+			size_t sDepth = jPhase["depth"].get<size_t>();
+
+			std::string strKey =
+				strName + std::string("\n") + std::to_string(sDepth);
+			strKey += std::string("\n")
+				+ std::to_string(mapOccurrences[strKey]++);
+
+			std::map<std::string, size_t>::const_iterator iter =
+				mapPhaseIx.find(strKey);
+			size_t sPhaseIx;
+			if (iter == mapPhaseIx.end()) {
+				sPhaseIx = vecPhases.size();
+				mapPhaseIx[strKey] = sPhaseIx;
+
+				nlohmann::json jReduced;
+				jReduced["name"] = strName;
+				jReduced["depth"] = sDepth;
+				vecPhases.push_back(jReduced);
+				vecWallTimes.push_back(std::vector<double>());
+				vecCPUTimes.push_back(std::vector<double>());
+				vecPhaseRanks.push_back(std::vector<int>());
+			} else {
+				sPhaseIx = iter->second;
+			}
+			vecWallTimes[sPhaseIx].push_back(jPhase["wall_time_s"].get<double>());
+			vecCPUTimes[sPhaseIx].push_back(jPhase["cpu_time_s"].get<double>());
+			vecPhaseRanks[sPhaseIx].push_back(vecAllRanks[r]);
+		}
+	}
+
+	nlohmann::json & jPhases = jRanks["phases"];
+	jPhases = nlohmann::json::array();
+	for (size_t p = 0; p < vecPhases.size(); p++) {
+		nlohmann::json & jPhase = vecPhases[p];
+		jPhase["ranks"] = vecPhaseRanks[p].size();
+		ReduceRankValues(vecWallTimes[p], vecPhaseRanks[p], jPhase["wall_time_s"]);
+		ReduceRankValues(vecCPUTimes[p], vecPhaseRanks[p], jPhase["cpu_time_s"]);
+		jPhases.push_back(jPhase);
+	}
+}
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string Profiler::WriteReport(
+	const std::string & strFilename
+) {
+	static const char * const s_szStageNames[ProfilerFileStageCount] =
+		{ "open", "header", "merge" };
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	nlohmann::json j;
+	j["wall_time_s"] = (IsEnabled())?(SecondsSince(m_tEnabled)):(0.0);
+	j["cpu_time_s"] =
+		(IsEnabled())?(ProcessCPUTime() - m_dCPUEnabled):(0.0);
+
+	// Phases, including any still open when the report is written
+	nlohmann::json & jPhases = j["phases"];
+	jPhases = nlohmann::json::array();
+	for (size_t p = 0; p < m_vecPhases.size(); p++) {
+		const Phase & phase = m_vecPhases[p];
+		nlohmann::json jPhase;
+		jPhase["name"] = phase.m_strName;
+		jPhase["depth"] = phase.m_sDepth;
+		if (phase.m_fEnded) {
+			jPhase["wall_time_s"] = phase.m_dWallTime;
+			jPhase["cpu_time_s"] = phase.m_dCPUTime;
+		} else {
+			jPhase["wall_time_s"] = SecondsSince(phase.m_tBegin);
+			jPhase["cpu_time_s"] = ProcessCPUTime() - phase.m_dCPUBegin;
+			jPhase["incomplete"] = true;
+		}
+		jPhases.push_back(jPhase);
+	}
+
+	// Latency histograms
+	Histogram histStage[ProfilerFileStageCount];
+	for (size_t s = 0; s < ProfilerFileStageCount; s++) {
+		histStage[s] = m_histStage[s];
+	}
+
+#if defined(HYPERION_MPIOMP)
+	// Sum the histograms of every rank on rank 0
+	for (size_t s = 0; s < ProfilerFileStageCount; s++) {
+		Histogram & hist = histStage[s];
+
+		std::vector<unsigned long long> vecCounts(HistogramBuckets + 1);
+		vecCounts[0] = hist.m_sCount;
+		for (size_t b = 0; b < HistogramBuckets; b++) {
+			vecCounts[b+1] = hist.m_vecBuckets[b];
+		}
+		std::vector<unsigned long long> vecSums(vecCounts.size(), 0);
+		MPI_Reduce(
+			&(vecCounts[0]), &(vecSums[0]), static_cast<int>(vecCounts.size()),
+			MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+		double dTotal = 0.0;
+		double dMax = 0.0;
+		MPI_Reduce(&(hist.m_dTotal), &dTotal, 1,
+			MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+		MPI_Reduce(&(hist.m_dMax), &dMax, 1,
+			MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+		hist.m_sCount = static_cast<size_t>(vecSums[0]);
+		for (size_t b = 0; b < HistogramBuckets; b++) {
+			hist.m_vecBuckets[b] = static_cast<size_t>(vecSums[b+1]);
+		}
+		hist.m_dTotal = dTotal;
+		hist.m_dMax = dMax;
+	}
+#endif
+
+	// Dropping empty buckets above the largest
+	nlohmann::json & jFiles = j["files"];
+	for (size_t s = 0; s < ProfilerFileStageCount; s++) {
+		const Histogram & hist = histStage[s];
+		nlohmann::json & jStage = jFiles[s_szStageNames[s]];
+		jStage["count"] = hist.m_sCount;
+		jStage["total_s"] = hist.m_dTotal;
+		jStage["mean_s"] =
+			(hist.m_sCount != 0)
+			?(hist.m_dTotal / static_cast<double>(hist.m_sCount))
+			:(0.0);
+		jStage["max_s"] = hist.m_dMax;
+
+		size_t sLastBucket = 0;
+		for (size_t b = 0; b < HistogramBuckets; b++) {
+			if (hist.m_vecBuckets[b] != 0) {
+				sLastBucket = b+1;
+			}
+		}
+		nlohmann::json & jHistogram = jStage["histogram"];
+		jHistogram = nlohmann::json::array();
+		for (size_t b = 0; b < sLastBucket; b++) {
+			nlohmann::json jBucket;
+			jBucket["lt_us"] = (1ull << b);
+			jBucket["count"] = hist.m_vecBuckets[b];
+			jHistogram.push_back(jBucket);
+		}
+	}
+
+	// Slowest files, slowest first
+	std::vector<FileTiming> vecSlowestFiles(m_vecSlowestFiles);
+	std::sort_heap(
+		vecSlowestFiles.begin(),
+		vecSlowestFiles.end(),
+		FileTiming::TotalGreater);
+
+	nlohmann::json & jSlowest = j["slowest_files"];
+	jSlowest = nlohmann::json::array();
+	for (size_t f = 0; f < vecSlowestFiles.size(); f++) {
+		const FileTiming & timing = vecSlowestFiles[f];
+		nlohmann::json jFile;
+		jFile["file"] = timing.m_strFilename;
+		jFile["total_s"] = timing.m_dTotal;
+		for (size_t s = 0; s < ProfilerFileStageCount; s++) {
+			jFile[std::string(s_szStageNames[s]) + std::string("_s")] =
+				timing.m_dStage[s];
+		}
+		jSlowest.push_back(jFile);
+	}
+
+	// Counters
+	nlohmann::json & jCounters = j["counters"];
+	jCounters["coordinate_bytes_read"] = m_sCoordinateBytes.load();
+	jCounters["subaxis_dedup_hits"] = m_sSubAxisDedupHits.load();
+	jCounters["subaxis_dedup_misses"] = m_sSubAxisDedupMisses.load();
+
+	// Memory of each structure of the index and of the process
+	nlohmann::json & jMemory = j["memory"];
+	nlohmann::json & jStructures = jMemory["structures"];
+	jStructures = nlohmann::json::object();
+	for (auto iter = m_mapMemory.begin(); iter != m_mapMemory.end(); iter++) {
+		nlohmann::json & jStructure = jStructures[iter->first];
+		jStructure["bytes"] = iter->second.m_sBytes;
+		jStructure["objects"] = iter->second.m_sObjects;
+		jStructure["peak_bytes"] = iter->second.m_sPeakBytes;
+		jStructure["peak_objects"] = iter->second.m_sPeakObjects;
+	}
+	jMemory["rss_bytes"] = ResidentSetBytes();
+	jMemory["peak_rss_bytes"] = PeakResidentSetBytes();
+	if (m_vecRSSSamples.size() != 0) {
+		jMemory["rss_interval_s"] = m_dRSSInterval;
+		nlohmann::json & jSamples = jMemory["rss_samples"];
+		jSamples = nlohmann::json::array();
+		for (size_t i = 0; i < m_vecRSSSamples.size(); i++) {
+			nlohmann::json jSample;
+			jSample["t_s"] = m_vecRSSSamples[i].m_dTime;
+			jSample["bytes"] = m_vecRSSSamples[i].m_sBytes;
+			jSamples.push_back(jSample);
+		}
+	}
+
+#if defined(HYPERION_MPIOMP)
+	// Gather the phases and work of every rank, reduced on rank 0
+	int nRank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &nRank);
+
+	nlohmann::json jSummary;
+	jSummary["rank"] = nRank;
+	jSummary["files"] = m_sRankFiles;
+	jSummary["file_bytes"] = m_ullRankFileBytes;
+	jSummary["busy_s"] = m_dRankBusyTime;
+	jSummary["idle_s"] = m_dRankIdleTime;
+	jSummary["coordinate_bytes_read"] = jCounters["coordinate_bytes_read"];
+	jSummary["wall_time_s"] = j["wall_time_s"];
+	jSummary["cpu_time_s"] = j["cpu_time_s"];
+	jSummary["peak_rss_bytes"] = jMemory["peak_rss_bytes"];
+	jSummary["phases"] = jPhases;
+	jSummary["slowest_files"] = jSlowest;
+
+	std::vector<nlohmann::json> vecSummaries;
+	MPIGatherJSON(jSummary, vecSummaries);
+	if (nRank != 0) {
+		return std::string("");
+	}
+	ReduceRankSummaries(vecSummaries, j["ranks"]);
+
+	// Slowest files of all ranks, slowest first
+	std::vector<nlohmann::json> vecAllSlowest;
+	for (size_t r = 0; r < vecSummaries.size(); r++) {
+		const nlohmann::json & jRankSlowest = vecSummaries[r]["slowest_files"];
+		for (size_t f = 0; f < jRankSlowest.size(); f++) {
+			vecAllSlowest.push_back(jRankSlowest[f]);
+		}
+	}
+	std::stable_sort(vecAllSlowest.begin(), vecAllSlowest.end(),
+		[](const nlohmann::json & jA, const nlohmann::json & jB) {
+			return (jA["total_s"].get<double>() > jB["total_s"].get<double>());
+		});
+	if (vecAllSlowest.size() > SlowestFileCount) {
+		vecAllSlowest.resize(SlowestFileCount);
+	}
+	jSlowest = nlohmann::json::array();
+	for (size_t f = 0; f < vecAllSlowest.size(); f++) {
+		jSlowest.push_back(vecAllSlowest[f]);
+	}
+#endif
+
+	std::ofstream ofs(strFilename.c_str());
+	if (!ofs.is_open()) {
+		return std::string("Unable to open profile file \"")
+			+ strFilename + std::string("\" for writing");
+	}
+	ofs << std::setw(4) << j << std::endl;
+	if (!ofs) {
+		return std::string("Unable to write profile file \"")
+			+ strFilename + std::string("\"");
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
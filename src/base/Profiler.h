@@ -0,0 +1,514 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    Profiler.h
+///	\version October 14, 2026
+///
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <condition_variable>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Stages of indexing a single file.
+///	</summary>
+enum ProfilerFileStage {
+	ProfilerFileStage_Open = 0,
+	ProfilerFileStage_Header = 1,
+	ProfilerFileStage_Merge = 2,
+	ProfilerFileStageCount = 3
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Collects the timings written by autocurator --profile: the wall
+///		and CPU time of each Announce block, latency histograms of the
+///		stages of indexing each file, the slowest files, counters for
+///		the coordinate reads and subaxis deduplication, and the memory
+///		held by each structure of the index along with the resident set
+///		size of the process.  In the MPI build the work of each rank is
+///		also recorded, and WriteReport reduces the phases, work, latency
+///		histograms and slowest files of all ranks into the report written
+///		by rank 0.
+///
+///		Nothing is recorded until Enable is called.  All methods may be
+///		called from any thread.
+///	</summary>
+class Profiler {
+
+public:
+	///	<summary>
+	///		Number of log2 buckets of the latency histograms; bucket b
+	///		counts latencies below 2^b microseconds.
+	///	</summary>
+	static const size_t HistogramBuckets = 32;
+
+	///	<summary>
+	///		Number of slowest files kept.
+	///	</summary>
+	static const size_t SlowestFileCount = 20;
+
+	///	<summary>
+	///		A monotonic clock.
+	///	</summary>
+	typedef std::chrono::steady_clock Clock;
+
+	///	<summary>
+	///		Largest number of resident set size samples kept; when it is
+	///		reached every other sample is dropped and the interval doubled.
+	///	</summary>
+	static const size_t MaxRSSSamples = 4096;
+
+protected:
+	///	<summary>
+	///		Timings of one Announce block.
+	///	</summary>
+	struct Phase {
+		///	<summary>
+		///		Name of the block.
+		///	</summary>
+		std::string m_strName;
+
+		///	<summary>
+		///		Nesting depth of the block.
+		///	</summary>
+		size_t m_sDepth;
+
+		///	<summary>
+		///		Wall clock time at the start of the block.
+		///	</summary>
+		Clock::time_point m_tBegin;
+
+		///	<summary>
+		///		Process CPU time at the start of the block, in seconds.
+		///	</summary>
+		double m_dCPUBegin;
+
+		///	<summary>
+		///		Wall clock time of the block, in seconds.
+		///	</summary>
+		double m_dWallTime;
+
+		///	<summary>
+		///		CPU time of the block summed over threads, in seconds.
+		///	</summary>
+		double m_dCPUTime;
+
+		///	<summary>
+		///		Flag indicating the block has ended.
+		///	</summary>
+		bool m_fEnded;
+	};
+
+	///	<summary>
+	///		A histogram of latencies.
+	///	</summary>
+	struct Histogram {
+		///	<summary>
+		///		Constructor.
+		///	</summary>
+		Histogram() :
+			m_sCount(0),
+			m_dTotal(0.0),
+			m_dMax(0.0),
+			m_vecBuckets(HistogramBuckets, 0)
+		{ }
+
+		///	<summary>
+		///		Add a latency in seconds.
+		///	</summary>
+		void Add(double dSeconds);
+
+		///	<summary>
+		///		Number of latencies.
+		///	</summary>
+		size_t m_sCount;
+
+		///	<summary>
+		///		Sum of latencies in seconds.
+		///	</summary>
+		double m_dTotal;
+
+		///	<summary>
+		///		Largest latency in seconds.
+		///	</summary>
+		double m_dMax;
+
+		///	<summary>
+		///		Counts in each bucket.
+		///	</summary>
+		std::vector<size_t> m_vecBuckets;
+	};
+
+	///	<summary>
+	///		Latencies of one file.
+	///	</summary>
+	struct FileTiming {
+		///	<summary>
+		///		Full path to the file.
+		///	</summary>
+		std::string m_strFilename;
+
+		///	<summary>
+		///		Latency of each stage, in seconds.
+		///	</summary>
+		double m_dStage[ProfilerFileStageCount];
+
+		///	<summary>
+		///		Total latency, in seconds.
+		///	</summary>
+		double m_dTotal;
+
+		///	<summary>
+		///		Order files as a min-heap on the total latency.
+		///	</summary>
+		static bool TotalGreater(
+			const FileTiming & a,
+			const FileTiming & b
+		) {
+			return (a.m_dTotal > b.m_dTotal);
+		}
+	};
+
+	///	<summary>
+	///		Memory held by one structure of the index.
+	///	</summary>
+	struct MemoryUsage {
+		///	<summary>
+		///		Constructor.
+		///	</summary>
+		MemoryUsage() :
+			m_sBytes(0),
+			m_sObjects(0),
+			m_sPeakBytes(0),
+			m_sPeakObjects(0)
+		{ }
+
+		///	<summary>
+		///		Bytes at the last record.
+		///	</summary>
+		size_t m_sBytes;
+
+		///	<summary>
+		///		Number of objects at the last record.
+		///	</summary>
+		size_t m_sObjects;
+
+		///	<summary>
+		///		Largest number of bytes recorded.
+		///	</summary>
+		size_t m_sPeakBytes;
+
+		///	<summary>
+		///		Largest number of objects recorded.
+		///	</summary>
+		size_t m_sPeakObjects;
+	};
+
+	///	<summary>
+	///		A sample of the resident set size.
+	///	</summary>
+	struct RSSSample {
+		///	<summary>
+		///		Seconds since recording started.
+		///	</summary>
+		double m_dTime;
+
+		///	<summary>
+		///		Resident set size in bytes.
+		///	</summary>
+		size_t m_sBytes;
+	};
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	Profiler() :
+		m_fEnabled(false),
+		m_sCoordinateBytes(0),
+		m_sSubAxisDedupHits(0),
+		m_sSubAxisDedupMisses(0),
+		m_sRankFiles(0),
+		m_ullRankFileBytes(0),
+		m_dRankBusyTime(0.0),
+		m_dRankIdleTime(0.0),
+		m_dRSSInterval(0.0),
+		m_fStopRSSSampling(false)
+	{ }
+
+	///	<summary>
+	///		Destructor.
+	///	</summary>
+	~Profiler();
+
+	///	<summary>
+	///		Get the profiler shared by autocurator and the IndexedDataset.
+	///	</summary>
+	static Profiler & Shared();
+
+	///	<summary>
+	///		Get the CPU time used by the process so far, in seconds.
+	///	</summary>
+	static double ProcessCPUTime();
+
+	///	<summary>
+	///		Get the resident set size of the process in bytes, or zero if
+	///		it is not available.
+	///	</summary>
+	static size_t ResidentSetBytes();
+
+	///	<summary>
+	///		Get the largest resident set size of the process so far in
+	///		bytes.
+	///	</summary>
+	static size_t PeakResidentSetBytes();
+
+	///	<summary>
+	///		Get the seconds elapsed since the given time.
+	///	</summary>
+	static double SecondsSince(
+		const Clock::time_point & tBegin
+	) {
+		return std::chrono::duration<double>(Clock::now() - tBegin).count();
+	}
+
+public:
+	///	<summary>
+	///		Start recording.
+	///	</summary>
+	void Enable();
+
+	///	<summary>
+	///		Check if the profiler is recording.
+	///	</summary>
+	bool IsEnabled() const {
+		return m_fEnabled.load(std::memory_order_relaxed);
+	}
+
+	///	<summary>
+	///		Mark the start of an Announce block.
+	///	</summary>
+	void BeginPhase(
+		const char * szName
+	);
+
+	///	<summary>
+	///		Mark the end of the innermost open Announce block.
+	///	</summary>
+	void EndPhase();
+
+	///	<summary>
+	///		Record the latency of a stage of indexing a file.
+	///	</summary>
+	void AddFileStage(
+		ProfilerFileStage stage,
+		double dSeconds
+	);
+
+	///	<summary>
+	///		Record the latencies of all stages of a file once it has been
+	///		merged, keeping it if it is among the slowest.
+	///	</summary>
+	void AddFile(
+		const std::string & strFilename,
+		double dOpenTime,
+		double dHeaderTime,
+		double dMergeTime
+	);
+
+	///	<summary>
+	///		Count bytes read from coordinate variables.
+	///	</summary>
+	void AddCoordinateBytes(
+		size_t sBytes
+	) {
+		if (IsEnabled()) {
+			m_sCoordinateBytes.fetch_add(sBytes, std::memory_order_relaxed);
+		}
+	}
+
+	///	<summary>
+	///		Count a subaxis that was or was not already in the index.
+	///	</summary>
+	void AddSubAxisDedup(
+		bool fHit
+	) {
+		if (IsEnabled()) {
+			if (fHit) {
+				m_sSubAxisDedupHits.fetch_add(1, std::memory_order_relaxed);
+			} else {
+				m_sSubAxisDedupMisses.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	///	<summary>
+	///		Record the work of this rank in a distributed extraction: the
+	///		number and total size of the files whose headers it extracted,
+	///		the seconds it spent extracting and merging them, and the
+	///		seconds it spent waiting on other ranks.
+	///	</summary>
+	void AddRankWork(
+		size_t sFiles,
+		unsigned long long ullFileBytes,
+		double dBusyTime,
+		double dIdleTime
+	);
+
+	///	<summary>
+	///		Record the bytes and number of objects currently held by a
+	///		structure of the index, keeping the largest values recorded.
+	///	</summary>
+	void RecordMemory(
+		const std::string & strStructure,
+		size_t sBytes,
+		size_t sObjects
+	);
+
+	///	<summary>
+	///		Sample the resident set size every dIntervalSeconds on a
+	///		background thread until StopRSSSampling is called.
+	///	</summary>
+	void StartRSSSampling(
+		double dIntervalSeconds
+	);
+
+	///	<summary>
+	///		Stop sampling the resident set size.
+	///	</summary>
+	void StopRSSSampling();
+
+	///	<summary>
+	///		Write the report as JSON.  In the MPI build this must be called
+	///		on every rank; the phases, work, latency histograms and slowest
+	///		files of all ranks are gathered and reduced, and only rank 0
+	///		writes the report.  Returns an error
+	///		message if the file cannot be written.
+	///	</summary>
+	std::string WriteReport(
+		const std::string & strFilename
+	);
+
+protected:
+	///	<summary>
+	///		Flag indicating the profiler is recording.
+	///	</summary>
+	std::atomic<bool> m_fEnabled;
+
+	///	<summary>
+	///		Mutex guarding the phases, histograms and slowest files.
+	///	</summary>
+	std::mutex m_mutex;
+
+	///	<summary>
+	///		Wall clock time when recording started.
+	///	</summary>
+	Clock::time_point m_tEnabled;
+
+	///	<summary>
+	///		Process CPU time when recording started, in seconds.
+	///	</summary>
+	double m_dCPUEnabled;
+
+	///	<summary>
+	///		Phases in the order they started.
+	///	</summary>
+	std::vector<Phase> m_vecPhases;
+
+	///	<summary>
+	///		Indices of the phases that have not yet ended.
+	///	</summary>
+	std::vector<size_t> m_vecOpenPhases;
+
+	///	<summary>
+	///		Latency histogram of each stage.
+	///	</summary>
+	Histogram m_histStage[ProfilerFileStageCount];
+
+	///	<summary>
+	///		Slowest files, as a min-heap on the total latency.
+	///	</summary>
+	std::vector<FileTiming> m_vecSlowestFiles;
+
+	///	<summary>
+	///		Bytes read from coordinate variables.
+	///	</summary>
+	std::atomic<size_t> m_sCoordinateBytes;
+
+	///	<summary>
+	///		Number of subaxes found already in the index.
+	///	</summary>
+	std::atomic<size_t> m_sSubAxisDedupHits;
+
+	///	<summary>
+	///		Number of subaxes added to the index.
+	///	</summary>
+	std::atomic<size_t> m_sSubAxisDedupMisses;
+
+	///	<summary>
+	///		Number of files whose headers were extracted by this rank.
+	///	</summary>
+	size_t m_sRankFiles;
+
+	///	<summary>
+	///		Total size of the files whose headers were extracted by this
+	///		rank.
+	///	</summary>
+	unsigned long long m_ullRankFileBytes;
+
+	///	<summary>
+	///		Seconds this rank spent extracting and merging headers.
+	///	</summary>
+	double m_dRankBusyTime;
+
+	///	<summary>
+	///		Seconds this rank spent waiting on other ranks.
+	///	</summary>
+	double m_dRankIdleTime;
+
+	///	<summary>
+	///		Memory held by each structure of the index.
+	///	</summary>
+	std::map<std::string, MemoryUsage> m_mapMemory;
+
+	///	<summary>
+	///		Samples of the resident set size.
+	///	</summary>
+	std::vector<RSSSample> m_vecRSSSamples;
+
+	///	<summary>
+	///		Interval between samples of the resident set size, in seconds.
+	///	</summary>
+	double m_dRSSInterval;
+
+	///	<summary>
+	///		Flag telling the sampling thread to stop.
+	///	</summary>
+	bool m_fStopRSSSampling;
+
+	///	<summary>
+	///		Signalled to stop the sampling thread.
+	///	</summary>
+	std::condition_variable m_condStopRSSSampling;
+
+	///	<summary>
+	///		Thread sampling the resident set size.
+	///	</summary>
+	std::thread m_threadRSSSampling;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
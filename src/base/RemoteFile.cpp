@@ -0,0 +1,927 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    RemoteFile.cpp
+///	\version October 15, 2026
+///
+
+#include "RemoteFile.h"
+#include "../contrib/tinyxml2.h"
+
+#include <strings.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#if defined(HYPERION_CURL)
+#include <curl/curl.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool IsRemoteURL(
+	const std::string & strPath
+) {
+	return (strPath.compare(0, 5, "s3://") == 0)
+		|| (strPath.compare(0, 7, "http://") == 0)
+		|| (strPath.compare(0, 8, "https://") == 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Percent-encode a string for a URL, leaving unreserved characters
+///		and, if fKeepSlash is set, '/' unchanged.
+///	</summary>
+static std::string RemoteURLEncode(
+	const std::string & str,
+	bool fKeepSlash
+) {
+	static const char * szHex = "0123456789ABCDEF";
+	std::string strEncoded;
+	for (size_t i = 0; i < str.length(); i++) {
+		unsigned char c = static_cast<unsigned char>(str[i]);
+		if (((c >= 'A') && (c <= 'Z')) ||
+		    ((c >= 'a') && (c <= 'z')) ||
+		    ((c >= '0') && (c <= '9')) ||
+		    (c == '-') || (c == '_') || (c == '.') || (c == '~') ||
+		    (fKeepSlash && (c == '/'))
+		) {
+			strEncoded += static_cast<char>(c);
+		} else {
+			strEncoded += '%';
+			strEncoded += szHex[c >> 4];
+			strEncoded += szHex[c & 0xf];
+		}
+	}
+	return strEncoded;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Split an "s3://bucket/key" URL into its bucket and key.
+///	</summary>
+static void RemoteSplitS3URL(
+	const std::string & strURL,
+	std::string & strBucket,
+	std::string & strKey
+) {
+	size_t sSlash = strURL.find('/', 5);
+	if (sSlash == std::string::npos) {
+		strBucket = strURL.substr(5);
+		strKey = "";
+	} else {
+		strBucket = strURL.substr(5, sSlash - 5);
+		strKey = strURL.substr(sSlash + 1);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get an environment variable, or strDefault if it is unset.
+///	</summary>
+static std::string RemoteGetEnv(
+	const char * szName,
+	const std::string & strDefault = std::string("")
+) {
+	const char * szValue = getenv(szName);
+	if ((szValue == NULL) || (szValue[0] == '\0')) {
+		return strDefault;
+	}
+	return std::string(szValue);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the region of S3 requests.
+///	</summary>
+static std::string RemoteS3Region() {
+	return RemoteGetEnv("AWS_REGION",
+		RemoteGetEnv("AWS_DEFAULT_REGION", "us-east-1"));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the URL of an S3 bucket, with a trailing slash.
+///	</summary>
+static std::string RemoteS3BucketURL(
+	const std::string & strBucket
+) {
+	std::string strEndpoint = RemoteGetEnv("AWS_ENDPOINT_URL");
+	if (strEndpoint != "") {
+		if (strEndpoint[strEndpoint.length()-1] != '/') {
+			strEndpoint += '/';
+		}
+		return strEndpoint + RemoteURLEncode(strBucket, false) + "/";
+	}
+	return std::string("https://") + strBucket
+		+ ".s3." + RemoteS3Region() + ".amazonaws.com/";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// RemoteFileClient
+///////////////////////////////////////////////////////////////////////////////
+
+RemoteFileClient & RemoteFileClient::Shared() {
+	static RemoteFileClient s_client;
+	return s_client;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RemoteFileClient::SetMaxConnections(
+	size_t sMaxConnections
+) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_sMaxConnections = (sMaxConnections == 0)?(1):(sMaxConnections);
+	m_condRelease.notify_all();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string RemoteFileClient::GetHTTPURL(
+	const std::string & strURL
+) const {
+	if (strURL.compare(0, 5, "s3://") != 0) {
+		return strURL;
+	}
+	std::string strBucket;
+	std::string strKey;
+	RemoteSplitS3URL(strURL, strBucket, strKey);
+	return RemoteS3BucketURL(strBucket) + RemoteURLEncode(strKey, true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(HYPERION_CURL)
+
+///	<summary>
+///		Parse an ISO 8601 UTC time, such as "2024-01-02T03:04:05.000Z",
+///		into nanoseconds since the epoch.
+///	</summary>
+static bool RemoteParseISOTime(
+	const char * szTime,
+	long long & llTime
+) {
+	struct tm tmTime;
+	memset(&tmTime, 0, sizeof(tmTime));
+	int nFraction = 0;
+	int nRead = sscanf(szTime, "%d-%d-%dT%d:%d:%d.%d",
+		&tmTime.tm_year, &tmTime.tm_mon, &tmTime.tm_mday,
+		&tmTime.tm_hour, &tmTime.tm_min, &tmTime.tm_sec, &nFraction);
+	if (nRead < 6) {
+		return false;
+	}
+	tmTime.tm_year -= 1900;
+	tmTime.tm_mon -= 1;
+	llTime = static_cast<long long>(timegm(&tmTime)) * 1000000000LL;
+	return true;
+}
+
+///	<summary>
+///		Mutexes guarding the data shared between connections.
+///	</summary>
+static std::mutex s_mutexCurlShare[CURL_LOCK_DATA_LAST];
+
+static void RemoteShareLock(
+	CURL * curl,
+	curl_lock_data data,
+	curl_lock_access access,
+	void * pUser
+) {
+	s_mutexCurlShare[data].lock();
+}
+
+static void RemoteShareUnlock(
+	CURL * curl,
+	curl_lock_data data,
+	void * pUser
+) {
+	s_mutexCurlShare[data].unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A connection of the pool.
+///	</summary>
+struct RemoteConnection {
+
+	///	<summary>
+	///		Handle of the connection.
+	///	</summary>
+	CURL * m_curl;
+
+	///	<summary>
+	///		Extra request headers, which must outlive the request.
+	///	</summary>
+	struct curl_slist * m_pHeaders;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Destination of the body of a response.
+///	</summary>
+struct RemoteResponse {
+
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	RemoteResponse(
+		std::vector<char> & vecData
+	) :
+		m_pvecData(&vecData)
+	{ }
+
+	///	<summary>
+	///		Body of the response.
+	///	</summary>
+	std::vector<char> * m_pvecData;
+
+	///	<summary>
+	///		Value of the Content-Range header.
+	///	</summary>
+	std::string m_strContentRange;
+};
+
+static size_t RemoteWriteCallback(
+	char * pData,
+	size_t sSize,
+	size_t sCount,
+	void * pUser
+) {
+	RemoteResponse * presponse = static_cast<RemoteResponse *>(pUser);
+	presponse->m_pvecData->insert(
+		presponse->m_pvecData->end(), pData, pData + sSize * sCount);
+	return sSize * sCount;
+}
+
+static size_t RemoteHeaderCallback(
+	char * pData,
+	size_t sSize,
+	size_t sCount,
+	void * pUser
+) {
+	RemoteResponse * presponse = static_cast<RemoteResponse *>(pUser);
+	const size_t sLength = sSize * sCount;
+	static const char szContentRange[] = "content-range:";
+	const size_t sPrefix = sizeof(szContentRange) - 1;
+	if ((sLength > sPrefix) && (strncasecmp(pData, szContentRange, sPrefix) == 0)) {
+		std::string strValue(pData + sPrefix, sLength - sPrefix);
+		size_t sBegin = strValue.find_first_not_of(" \t");
+		size_t sEnd = strValue.find_last_not_of(" \t\r\n");
+		if ((sBegin != std::string::npos) && (sEnd != std::string::npos)) {
+			presponse->m_strContentRange = strValue.substr(sBegin, sEnd - sBegin + 1);
+		}
+	}
+	return sLength;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the HTTP status of a completed request as an error message,
+///		which is empty for a success status.
+///	</summary>
+static std::string RemoteCheckStatus(
+	CURL * curl,
+	CURLcode code,
+	const std::string & strURL,
+	bool fRange
+) {
+	if (code != CURLE_OK) {
+		return std::string("Unable to read \"") + strURL + std::string("\": ")
+			+ std::string(curl_easy_strerror(code));
+	}
+	long lStatus = 0;
+	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &lStatus);
+	if (fRange && (lStatus == 200)) {
+		return std::string("Server does not support byte-range requests for \"")
+			+ strURL + std::string("\"");
+	}
+	if ((lStatus != 200) && (lStatus != 206)) {
+		return std::string("Unable to read \"") + strURL
+			+ std::string("\": HTTP status ") + std::to_string(lStatus);
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+RemoteFileClient::RemoteFileClient(
+	size_t sMaxConnections
+) :
+	m_sMaxConnections((sMaxConnections == 0)?(1):(sMaxConnections)),
+	m_sConnections(0),
+	m_pShare(NULL)
+{
+	static std::once_flag s_flagInit;
+	std::call_once(s_flagInit, []() {
+		curl_global_init(CURL_GLOBAL_DEFAULT);
+	});
+
+	// Share sockets, DNS lookups and TLS sessions between connections,
+	// so that a connection to a host is kept alive for later requests
+	CURLSH * share = curl_share_init();
+	curl_share_setopt(share, CURLSHOPT_LOCKFUNC, RemoteShareLock);
+	curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, RemoteShareUnlock);
+	curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+	curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+	m_pShare = share;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Close a connection.
+///	</summary>
+static void RemoteCloseConnection(
+	RemoteConnection * pconn
+) {
+	curl_easy_cleanup(pconn->m_curl);
+	curl_slist_free_all(pconn->m_pHeaders);
+	delete pconn;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+RemoteFileClient::~RemoteFileClient() {
+	for (size_t i = 0; i < m_vecIdle.size(); i++) {
+		RemoteCloseConnection(static_cast<RemoteConnection *>(m_vecIdle[i]));
+	}
+	curl_share_cleanup(static_cast<CURLSH *>(m_pShare));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void * RemoteFileClient::AcquireConnection(
+	bool fWait
+) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;) {
+		if (m_vecIdle.size() != 0) {
+			void * pConnection = m_vecIdle.back();
+			m_vecIdle.pop_back();
+			return pConnection;
+		}
+		if (m_sConnections < m_sMaxConnections) {
+			CURL * curl = curl_easy_init();
+			if (curl == NULL) {
+				return NULL;
+			}
+			RemoteConnection * pconn = new RemoteConnection;
+			pconn->m_curl = curl;
+			pconn->m_pHeaders = NULL;
+			m_sConnections++;
+			return pconn;
+		}
+		if (!fWait) {
+			return NULL;
+		}
+		m_condRelease.wait(lock);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RemoteFileClient::ReleaseConnection(
+	void * pConnection
+) {
+	if (pConnection == NULL) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_sConnections > m_sMaxConnections) {
+		RemoteCloseConnection(static_cast<RemoteConnection *>(pConnection));
+		m_sConnections--;
+	} else {
+		m_vecIdle.push_back(pConnection);
+	}
+	m_condRelease.notify_one();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RemoteFileClient::PrepareRequest(
+	void * pConnection,
+	const std::string & strURL
+) {
+	RemoteConnection * pconn = static_cast<RemoteConnection *>(pConnection);
+	CURL * curl = pconn->m_curl;
+
+	// Reset options from the last request, keeping the connection
+	curl_easy_reset(curl);
+	curl_slist_free_all(pconn->m_pHeaders);
+	pconn->m_pHeaders = NULL;
+
+	curl_easy_setopt(curl, CURLOPT_URL, GetHTTPURL(strURL).c_str());
+	curl_easy_setopt(curl, CURLOPT_SHARE, static_cast<CURLSH *>(m_pShare));
+	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+	curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+	curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
+	curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+	curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 60L);
+	curl_easy_setopt(curl, CURLOPT_USERAGENT, "autocurator");
+
+#if LIBCURL_VERSION_NUM >= 0x074b00
+	// Sign requests to S3 if credentials are available
+	if (strURL.compare(0, 5, "s3://") == 0) {
+		std::string strKeyId = RemoteGetEnv("AWS_ACCESS_KEY_ID");
+		std::string strSecret = RemoteGetEnv("AWS_SECRET_ACCESS_KEY");
+		if ((strKeyId != "") && (strSecret != "")) {
+			std::string strSigV4 =
+				std::string("aws:amz:") + RemoteS3Region() + std::string(":s3");
+			curl_easy_setopt(curl, CURLOPT_AWS_SIGV4, strSigV4.c_str());
+			curl_easy_setopt(curl, CURLOPT_USERNAME, strKeyId.c_str());
+			curl_easy_setopt(curl, CURLOPT_PASSWORD, strSecret.c_str());
+
+			std::string strToken = RemoteGetEnv("AWS_SESSION_TOKEN");
+			if (strToken != "") {
+				std::string strHeader =
+					std::string("x-amz-security-token: ") + strToken;
+				pconn->m_pHeaders =
+					curl_slist_append(NULL, strHeader.c_str());
+				curl_easy_setopt(curl, CURLOPT_HTTPHEADER, pconn->m_pHeaders);
+			}
+		}
+	}
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string RemoteFileClient::Get(
+	const std::string & strURL,
+	unsigned long long ullOffset,
+	size_t sSize,
+	std::vector<char> & vecData,
+	std::string * pstrContentRange
+) {
+	void * pConnection = AcquireConnection(true);
+	if (pConnection == NULL) {
+		return std::string("Unable to create connection");
+	}
+	CURL * curl = static_cast<RemoteConnection *>(pConnection)->m_curl;
+
+	vecData.clear();
+	RemoteResponse response(vecData);
+
+	PrepareRequest(pConnection, strURL);
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, RemoteWriteCallback);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+	curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, RemoteHeaderCallback);
+	curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response);
+
+	std::string strRange;
+	if (sSize != 0) {
+		strRange = std::to_string(ullOffset) + std::string("-")
+			+ std::to_string(ullOffset + sSize - 1);
+		curl_easy_setopt(curl, CURLOPT_RANGE, strRange.c_str());
+	}
+
+	CURLcode code = curl_easy_perform(curl);
+	std::string strError = RemoteCheckStatus(curl, code, strURL, (sSize != 0));
+	ReleaseConnection(pConnection);
+
+	if (pstrContentRange != NULL) {
+		*pstrContentRange = response.m_strContentRange;
+	}
+	return strError;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string RemoteFileClient::Stat(
+	const std::string & strURL,
+	long long & llSize,
+	long long & llModTime
+) {
+	void * pConnection = AcquireConnection(true);
+	if (pConnection == NULL) {
+		return std::string("Unable to create connection");
+	}
+	CURL * curl = static_cast<RemoteConnection *>(pConnection)->m_curl;
+
+	PrepareRequest(pConnection, strURL);
+	curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+	curl_easy_setopt(curl, CURLOPT_FILETIME, 1L);
+
+	CURLcode code = curl_easy_perform(curl);
+	std::string strError = RemoteCheckStatus(curl, code, strURL, false);
+	if (strError == "") {
+		curl_off_t offSize = -1;
+		long lFileTime = -1;
+		curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &offSize);
+		curl_easy_getinfo(curl, CURLINFO_FILETIME, &lFileTime);
+		if (offSize < 0) {
+			strError = std::string("Size of \"") + strURL
+				+ std::string("\" not reported");
+		}
+		llSize = static_cast<long long>(offSize);
+		llModTime =
+			(lFileTime < 0)?(0):(static_cast<long long>(lFileTime) * 1000000000LL);
+	}
+	ReleaseConnection(pConnection);
+	return strError;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string RemoteFileClient::ReadHead(
+	const std::string & strURL,
+	size_t sMaxBytes,
+	std::vector<char> & vecData,
+	unsigned long long & ullFileSize
+) {
+	std::string strContentRange;
+	std::string strError =
+		Get(strURL, 0, sMaxBytes, vecData, &strContentRange);
+	if (strError != "") {
+		return strError;
+	}
+
+	// The size of the file follows the range, as in "bytes 0-1023/4096"
+	size_t sSlash = strContentRange.rfind('/');
+	if ((sSlash == std::string::npos) ||
+	    (strContentRange.compare(sSlash + 1, std::string::npos, "*") == 0)
+	) {
+		return std::string("Size of \"") + strURL
+			+ std::string("\" not reported");
+	}
+	ullFileSize = strtoull(strContentRange.c_str() + sSlash + 1, NULL, 10);
+	if (vecData.size() > sMaxBytes) {
+		vecData.resize(sMaxBytes);
+	}
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string RemoteFileClient::ReadRanges(
+	const std::string & strURL,
+	const std::vector<RemoteByteRange> & vecRanges
+) {
+	if (vecRanges.size() == 0) {
+		return std::string("");
+	}
+
+	// Coalesce ranges that are close together into requests
+	struct Request {
+		unsigned long long m_ullBegin;
+		unsigned long long m_ullEnd;
+		std::vector<size_t> m_vecRanges;
+		std::vector<char> m_vecData;
+		std::string m_strRange;
+	};
+
+	std::vector<size_t> vecOrder(vecRanges.size());
+	for (size_t i = 0; i < vecOrder.size(); i++) {
+		vecOrder[i] = i;
+	}
+	std::sort(vecOrder.begin(), vecOrder.end(),
+		[&](size_t i, size_t j) {
+			return vecRanges[i].m_ullOffset < vecRanges[j].m_ullOffset;
+		});
+
+	std::vector<Request> vecRequests;
+	for (size_t i = 0; i < vecOrder.size(); i++) {
+		const RemoteByteRange & range = vecRanges[vecOrder[i]];
+		if (range.m_sSize == 0) {
+			continue;
+		}
+		const unsigned long long ullEnd = range.m_ullOffset + range.m_sSize;
+		if ((vecRequests.size() == 0) ||
+		    (range.m_ullOffset > vecRequests.back().m_ullEnd + CoalesceGapBytes)
+		) {
+			vecRequests.push_back(Request());
+			vecRequests.back().m_ullBegin = range.m_ullOffset;
+			vecRequests.back().m_ullEnd = ullEnd;
+		} else if (ullEnd > vecRequests.back().m_ullEnd) {
+			vecRequests.back().m_ullEnd = ullEnd;
+		}
+		vecRequests.back().m_vecRanges.push_back(vecOrder[i]);
+	}
+
+	// Issue the requests in parallel on as many connections as are free,
+	// waiting only for the first so that threads cannot deadlock
+	std::vector<void *> vecConnections;
+	vecConnections.push_back(AcquireConnection(true));
+	if (vecConnections[0] == NULL) {
+		return std::string("Unable to create connection");
+	}
+	while (vecConnections.size() < vecRequests.size()) {
+		void * pConnection = AcquireConnection(false);
+		if (pConnection == NULL) {
+			break;
+		}
+		vecConnections.push_back(pConnection);
+	}
+
+	CURLM * multi = curl_multi_init();
+	std::vector<RemoteResponse> vecResponses;
+	for (size_t r = 0; r < vecRequests.size(); r++) {
+		vecResponses.push_back(RemoteResponse(vecRequests[r].m_vecData));
+	}
+
+	// Request being read on each connection
+	std::vector<size_t> vecActive(vecConnections.size());
+	size_t sNextRequest = 0;
+
+	auto fnStart = [&](size_t c) {
+		size_t r = sNextRequest++;
+		Request & request = vecRequests[r];
+		CURL * curl = static_cast<RemoteConnection *>(vecConnections[c])->m_curl;
+
+		request.m_vecData.reserve(
+			static_cast<size_t>(request.m_ullEnd - request.m_ullBegin));
+		request.m_strRange = std::to_string(request.m_ullBegin) + std::string("-")
+			+ std::to_string(request.m_ullEnd - 1);
+
+		PrepareRequest(vecConnections[c], strURL);
+		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, RemoteWriteCallback);
+		curl_easy_setopt(curl, CURLOPT_WRITEDATA, &(vecResponses[r]));
+		curl_easy_setopt(curl, CURLOPT_RANGE, request.m_strRange.c_str());
+		curl_easy_setopt(curl, CURLOPT_PRIVATE, reinterpret_cast<char *>(c));
+		curl_multi_add_handle(multi, curl);
+		vecActive[c] = r;
+	};
+
+	size_t sRunning = 0;
+	for (size_t c = 0; (c < vecConnections.size()) && (sNextRequest < vecRequests.size()); c++) {
+		fnStart(c);
+		sRunning++;
+	}
+
+	std::string strError;
+	while ((sRunning != 0) && (strError == "")) {
+		int nStillRunning = 0;
+		CURLMcode mcode = curl_multi_perform(multi, &nStillRunning);
+		if (mcode != CURLM_OK) {
+			strError = std::string("Unable to read \"") + strURL
+				+ std::string("\": ") + std::string(curl_multi_strerror(mcode));
+			break;
+		}
+
+		CURLMsg * pmsg;
+		int nQueued;
+		while ((pmsg = curl_multi_info_read(multi, &nQueued)) != NULL) {
+			if (pmsg->msg != CURLMSG_DONE) {
+				continue;
+			}
+			CURL * curl = pmsg->easy_handle;
+			char * pPrivate = NULL;
+			curl_easy_getinfo(curl, CURLINFO_PRIVATE, &pPrivate);
+			size_t c = reinterpret_cast<size_t>(pPrivate);
+			const Request & request = vecRequests[vecActive[c]];
+
+			if (strError == "") {
+				strError = RemoteCheckStatus(curl, pmsg->data.result, strURL, true);
+			}
+			if ((strError == "") &&
+			    (request.m_vecData.size() != request.m_ullEnd - request.m_ullBegin)
+			) {
+				strError = std::string("Short read of \"") + strURL
+					+ std::string("\"");
+			}
+
+			curl_multi_remove_handle(multi, curl);
+			sRunning--;
+			if ((strError == "") && (sNextRequest < vecRequests.size())) {
+				fnStart(c);
+				sRunning++;
+			}
+		}
+
+		if ((sRunning != 0) && (strError == "")) {
+			curl_multi_wait(multi, NULL, 0, 1000, NULL);
+		}
+	}
+
+	// Detach any requests abandoned after an error
+	for (size_t c = 0; c < vecConnections.size(); c++) {
+		curl_multi_remove_handle(multi,
+			static_cast<RemoteConnection *>(vecConnections[c])->m_curl);
+		ReleaseConnection(vecConnections[c]);
+	}
+	curl_multi_cleanup(multi);
+
+	if (strError != "") {
+		return strError;
+	}
+
+	// Scatter the data to the ranges
+	for (size_t r = 0; r < vecRequests.size(); r++) {
+		const Request & request = vecRequests[r];
+		for (size_t i = 0; i < request.m_vecRanges.size(); i++) {
+			const RemoteByteRange & range = vecRanges[request.m_vecRanges[i]];
+			memcpy(range.m_pData,
+				&(request.m_vecData[range.m_ullOffset - request.m_ullBegin]),
+				range.m_sSize);
+		}
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string RemoteFileClient::List(
+	const std::string & strURL,
+	bool fRecurse,
+	std::vector<RemoteObject> & vecObjects
+) {
+	if (strURL.compare(0, 5, "s3://") != 0) {
+		return std::string("Unable to list \"") + strURL
+			+ std::string("\": only s3:// URLs can be listed");
+	}
+
+	std::string strBucket;
+	std::string strPrefix;
+	RemoteSplitS3URL(strURL, strBucket, strPrefix);
+	if ((strPrefix != "") && (strPrefix[strPrefix.length()-1] != '/')) {
+		strPrefix += '/';
+	}
+
+	// Page through ListObjectsV2 results
+	std::string strToken;
+	for (;;) {
+		std::string strHTTPURL = RemoteS3BucketURL(strBucket)
+			+ std::string("?list-type=2&prefix=")
+			+ RemoteURLEncode(strPrefix, false);
+		if (!fRecurse) {
+			strHTTPURL += "&delimiter=%2F";
+		}
+		if (strToken != "") {
+			strHTTPURL += std::string("&continuation-token=")
+				+ RemoteURLEncode(strToken, false);
+		}
+
+		std::vector<char> vecData;
+		std::string strError;
+		{
+			void * pConnection = AcquireConnection(true);
+			if (pConnection == NULL) {
+				return std::string("Unable to create connection");
+			}
+			CURL * curl = static_cast<RemoteConnection *>(pConnection)->m_curl;
+			RemoteResponse response(vecData);
+
+			// Signed as a request to the bucket, with the query in the URL
+			PrepareRequest(pConnection, strURL);
+			curl_easy_setopt(curl, CURLOPT_URL, strHTTPURL.c_str());
+			curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, RemoteWriteCallback);
+			curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+			CURLcode code = curl_easy_perform(curl);
+			strError = RemoteCheckStatus(curl, code, strURL, false);
+			ReleaseConnection(pConnection);
+		}
+		if (strError != "") {
+			return strError;
+		}
+
+		tinyxml2::XMLDocument doc;
+		if (doc.Parse(vecData.data(), vecData.size()) != tinyxml2::XML_SUCCESS) {
+			return std::string("Malformed listing of \"") + strURL
+				+ std::string("\"");
+		}
+		tinyxml2::XMLElement * pResult = doc.FirstChildElement("ListBucketResult");
+		if (pResult == NULL) {
+			return std::string("Malformed listing of \"") + strURL
+				+ std::string("\"");
+		}
+
+		for (tinyxml2::XMLElement * pContents = pResult->FirstChildElement("Contents");
+		     pContents != NULL;
+		     pContents = pContents->NextSiblingElement("Contents")
+		) {
+			tinyxml2::XMLElement * pKey = pContents->FirstChildElement("Key");
+			tinyxml2::XMLElement * pSize = pContents->FirstChildElement("Size");
+			tinyxml2::XMLElement * pModified =
+				pContents->FirstChildElement("LastModified");
+			if ((pKey == NULL) || (pKey->GetText() == NULL)) {
+				continue;
+			}
+			std::string strKey = pKey->GetText();
+			if ((strKey.length() <= strPrefix.length()) ||
+			    (strKey[strKey.length()-1] == '/')
+			) {
+				continue;
+			}
+
+			RemoteObject object;
+			object.m_strKey = strKey.substr(strPrefix.length());
+			object.m_llSize = -1;
+			object.m_llModTime = 0;
+			if ((pSize != NULL) && (pSize->GetText() != NULL)) {
+				object.m_llSize = strtoll(pSize->GetText(), NULL, 10);
+			}
+			if ((pModified != NULL) && (pModified->GetText() != NULL)) {
+				RemoteParseISOTime(pModified->GetText(), object.m_llModTime);
+			}
+			vecObjects.push_back(object);
+		}
+
+		tinyxml2::XMLElement * pTruncated = pResult->FirstChildElement("IsTruncated");
+		tinyxml2::XMLElement * pNextToken =
+			pResult->FirstChildElement("NextContinuationToken");
+		if ((pTruncated == NULL) || (pTruncated->GetText() == NULL) ||
+		    (strcmp(pTruncated->GetText(), "true") != 0) ||
+		    (pNextToken == NULL) || (pNextToken->GetText() == NULL)
+		) {
+			break;
+		}
+		strToken = pNextToken->GetText();
+	}
+
+	return std::string("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#else
+
+///	<summary>
+///		Error returned by every request without CURL support.
+///	</summary>
+static std::string RemoteUnsupported(
+	const std::string & strURL
+) {
+	return std::string("Unable to read \"") + strURL
+		+ std::string("\": remote files require a build with CURL=TRUE");
+}
+
+RemoteFileClient::RemoteFileClient(
+	size_t sMaxConnections
+) :
+	m_sMaxConnections((sMaxConnections == 0)?(1):(sMaxConnections)),
+	m_sConnections(0),
+	m_pShare(NULL)
+{ }
+
+RemoteFileClient::~RemoteFileClient()
+{ }
+
+void * RemoteFileClient::AcquireConnection(bool fWait) {
+	return NULL;
+}
+
+void RemoteFileClient::ReleaseConnection(void * pConnection)
+{ }
+
+void RemoteFileClient::PrepareRequest(void * pConnection, const std::string & strURL)
+{ }
+
+std::string RemoteFileClient::Get(
+	const std::string & strURL,
+	unsigned long long ullOffset,
+	size_t sSize,
+	std::vector<char> & vecData,
+	std::string * pstrContentRange
+) {
+	return RemoteUnsupported(strURL);
+}
+
+std::string RemoteFileClient::Stat(
+	const std::string & strURL,
+	long long & llSize,
+	long long & llModTime
+) {
+	return RemoteUnsupported(strURL);
+}
+
+std::string RemoteFileClient::ReadHead(
+	const std::string & strURL,
+	size_t sMaxBytes,
+	std::vector<char> & vecData,
+	unsigned long long & ullFileSize
+) {
+	return RemoteUnsupported(strURL);
+}
+
+std::string RemoteFileClient::ReadRanges(
+	const std::string & strURL,
+	const std::vector<RemoteByteRange> & vecRanges
+) {
+	return RemoteUnsupported(strURL);
+}
+
+std::string RemoteFileClient::List(
+	const std::string & strURL,
+	bool fRecurse,
+	std::vector<RemoteObject> & vecObjects
+) {
+	return RemoteUnsupported(strURL);
+}
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
@@ -0,0 +1,258 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    RemoteFile.h
+///	\version October 15, 2026
+///
+
+#ifndef _REMOTEFILE_H_
+#define _REMOTEFILE_H_
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check if a path is the URL of a remote file: "s3://", "http://"
+///		or "https://".
+///	</summary>
+bool IsRemoteURL(
+	const std::string & strPath
+);
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A range of bytes of a remote file and the buffer receiving it.
+///	</summary>
+struct RemoteByteRange {
+
+	///	<summary>
+	///		Offset of the first byte.
+	///	</summary>
+	unsigned long long m_ullOffset;
+
+	///	<summary>
+	///		Number of bytes.
+	///	</summary>
+	size_t m_sSize;
+
+	///	<summary>
+	///		Buffer of m_sSize bytes.
+	///	</summary>
+	char * m_pData;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		An object in a listing of a remote prefix.
+///	</summary>
+struct RemoteObject {
+
+	///	<summary>
+	///		Key relative to the listed prefix.
+	///	</summary>
+	std::string m_strKey;
+
+	///	<summary>
+	///		Size in bytes.
+	///	</summary>
+	long long m_llSize;
+
+	///	<summary>
+	///		Modification time in nanoseconds since the epoch.
+	///	</summary>
+	long long m_llModTime;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A client reading byte ranges of remote files over HTTP(S) and from
+///		S3-compatible object stores.  Requests run on a bounded pool of
+///		connections that are kept alive between requests and shared by
+///		all threads.  Ranges of one read that are close together are
+///		coalesced into a single request, and the requests of one read are
+///		issued in parallel.
+///
+///		"s3://bucket/key" is read from the endpoint in AWS_ENDPOINT_URL
+///		(path style) if set, and otherwise from the virtual-hosted AWS
+///		endpoint of AWS_REGION.  Requests are signed with AWS_ACCESS_KEY_ID
+///		and AWS_SECRET_ACCESS_KEY if set, and are anonymous otherwise.
+///
+///		Requires a build with CURL=TRUE; otherwise every request fails.
+///	</summary>
+class RemoteFileClient {
+
+public:
+	///	<summary>
+	///		Default maximum number of connections.
+	///	</summary>
+	static const size_t DefaultMaxConnections = 16;
+
+	///	<summary>
+	///		Ranges separated by at most this many bytes are read with a
+	///		single request.
+	///	</summary>
+	static const size_t CoalesceGapBytes = 65536;
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	RemoteFileClient(
+		size_t sMaxConnections = DefaultMaxConnections
+	);
+
+	///	<summary>
+	///		Destructor.
+	///	</summary>
+	~RemoteFileClient();
+
+	///	<summary>
+	///		Get the client shared by the indexer.
+	///	</summary>
+	static RemoteFileClient & Shared();
+
+private:
+	///	<summary>
+	///		Not copyable.
+	///	</summary>
+	RemoteFileClient(const RemoteFileClient &);
+	RemoteFileClient & operator=(const RemoteFileClient &);
+
+public:
+	///	<summary>
+	///		Set the maximum number of connections.  Connections in use are
+	///		not closed.
+	///	</summary>
+	void SetMaxConnections(
+		size_t sMaxConnections
+	);
+
+	///	<summary>
+	///		Get the HTTP(S) URL a remote file is read from.
+	///	</summary>
+	std::string GetHTTPURL(
+		const std::string & strURL
+	) const;
+
+	///	<summary>
+	///		Get the size and modification time, in nanoseconds since the
+	///		epoch, of a remote file.  Returns an error message on failure.
+	///	</summary>
+	std::string Stat(
+		const std::string & strURL,
+		long long & llSize,
+		long long & llModTime
+	);
+
+	///	<summary>
+	///		Read up to sMaxBytes from the start of a remote file, and get
+	///		the size of the file, with a single request.  Returns an error
+	///		message on failure.
+	///	</summary>
+	std::string ReadHead(
+		const std::string & strURL,
+		size_t sMaxBytes,
+		std::vector<char> & vecData,
+		unsigned long long & ullFileSize
+	);
+
+	///	<summary>
+	///		Read the given ranges of a remote file.  Returns an error
+	///		message on failure.
+	///	</summary>
+	std::string ReadRanges(
+		const std::string & strURL,
+		const std::vector<RemoteByteRange> & vecRanges
+	);
+
+	///	<summary>
+	///		List the objects under an "s3://bucket/prefix/" URL, with keys
+	///		relative to the prefix.  If fRecurse is not set only objects
+	///		directly under the prefix are listed.  Returns an error message
+	///		on failure.
+	///	</summary>
+	std::string List(
+		const std::string & strURL,
+		bool fRecurse,
+		std::vector<RemoteObject> & vecObjects
+	);
+
+protected:
+	///	<summary>
+	///		Take an idle connection, creating one if fewer than the maximum
+	///		exist.  If fWait is not set NULL is returned rather than
+	///		waiting for a connection to be released.
+	///	</summary>
+	void * AcquireConnection(
+		bool fWait
+	);
+
+	///	<summary>
+	///		Return a connection to the pool.
+	///	</summary>
+	void ReleaseConnection(
+		void * pConnection
+	);
+
+	///	<summary>
+	///		Set up a connection for a GET of strURL.
+	///	</summary>
+	void PrepareRequest(
+		void * pConnection,
+		const std::string & strURL
+	);
+
+	///	<summary>
+	///		GET a URL, or the given range of it if sSize is not zero, into
+	///		vecData.  Returns an error message on failure.
+	///	</summary>
+	std::string Get(
+		const std::string & strURL,
+		unsigned long long ullOffset,
+		size_t sSize,
+		std::vector<char> & vecData,
+		std::string * pstrContentRange = NULL
+	);
+
+protected:
+	///	<summary>
+	///		Maximum number of connections.
+	///	</summary>
+	size_t m_sMaxConnections;
+
+	///	<summary>
+	///		Number of connections, idle or in use.
+	///	</summary>
+	size_t m_sConnections;
+
+	///	<summary>
+	///		Idle connections.
+	///	</summary>
+	std::vector<void *> m_vecIdle;
+
+	///	<summary>
+	///		State shared by all connections, such as open sockets.
+	///	</summary>
+	void * m_pShare;
+
+	///	<summary>
+	///		Mutex guarding the pool.
+	///	</summary>
+	std::mutex m_mutex;
+
+	///	<summary>
+	///		Signalled when a connection is released.
+	///	</summary>
+	std::condition_variable m_condRelease;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
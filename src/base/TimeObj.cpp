@@ -126,6 +126,124 @@ bool Time::operator>(const Time & time) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+///	<summary>
+///		Divide llValue by llDivisor, returning the quotient rounded
+///		towards negative infinity and leaving the nonnegative remainder
+///		in llValue.
+///	</summary>
+static inline long long FloorDivide(
+	long long & llValue,
+	long long llDivisor
+) {
+	long long llQuotient = llValue / llDivisor;
+	llValue -= llQuotient * llDivisor;
+	if (llValue < 0) {
+		llValue += llDivisor;
+		llQuotient--;
+	}
+	return llQuotient;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Number of days before each month in a year with no leap day.
+///	</summary>
+static const int NoLeapDaysBeforeMonth[13] =
+	{0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the number of days from 1970-01-01 to the given date, with
+///		zero-indexed month and day, in closed form.
+///	</summary>
+static long long DaysFromDate(
+	Time::CalendarType eCalendarType,
+	long long llYear,
+	int iMonth,
+	int iDay
+) {
+	if (eCalendarType == Time::CalendarNoLeap) {
+		return 365 * (llYear - 1970) + NoLeapDaysBeforeMonth[iMonth] + iDay;
+
+	} else if (eCalendarType == Time::Calendar360Day) {
+		return 360 * (llYear - 1970) + 30 * iMonth + iDay;
+
+	// Based on http://howardhinnant.github.io/date_algorithms.html, with
+	// years starting on March 1 so that the leap day is the last day
+	} else if (
+		(eCalendarType == Time::CalendarStandard) ||
+		(eCalendarType == Time::CalendarGregorian)
+	) {
+		long long llY = llYear - ((iMonth < 2)?(1):(0));
+		long long llEra = ((llY >= 0)?(llY):(llY - 399)) / 400;
+		long long llYearOfEra = llY - llEra * 400;
+		long long llDayOfYear =
+			(153 * ((iMonth > 1)?(iMonth - 2):(iMonth + 10)) + 2) / 5 + iDay;
+		long long llDayOfEra =
+			llYearOfEra * 365 + llYearOfEra / 4 - llYearOfEra / 100
+			+ llDayOfYear;
+
+		return llEra * 146097 + llDayOfEra - 719468;
+
+	} else {
+		_EXCEPTIONT("Not implemented");
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the date, with zero-indexed month and day, that is the given
+///		number of days from 1970-01-01, in closed form.
+///	</summary>
+static void DateFromDays(
+	Time::CalendarType eCalendarType,
+	long long llDays,
+	long long & llYear,
+	int & iMonth,
+	int & iDay
+) {
+	if (eCalendarType == Time::CalendarNoLeap) {
+		llYear = 1970 + FloorDivide(llDays, 365);
+		iMonth = static_cast<int>(llDays / 31);
+		if (NoLeapDaysBeforeMonth[iMonth + 1] <= llDays) {
+			iMonth++;
+		}
+		iDay = static_cast<int>(llDays) - NoLeapDaysBeforeMonth[iMonth];
+
+	} else if (eCalendarType == Time::Calendar360Day) {
+		llYear = 1970 + FloorDivide(llDays, 360);
+		iMonth = static_cast<int>(llDays / 30);
+		iDay = static_cast<int>(llDays % 30);
+
+	} else if (
+		(eCalendarType == Time::CalendarStandard) ||
+		(eCalendarType == Time::CalendarGregorian)
+	) {
+		long long llZ = llDays + 719468;
+		long long llEra = ((llZ >= 0)?(llZ):(llZ - 146096)) / 146097;
+		long long llDayOfEra = llZ - llEra * 146097;
+		long long llYearOfEra =
+			(llDayOfEra - llDayOfEra / 1460 + llDayOfEra / 36524
+				- llDayOfEra / 146096) / 365;
+		long long llDayOfYear =
+			llDayOfEra - (365 * llYearOfEra + llYearOfEra / 4 - llYearOfEra / 100);
+		long long llMonthFromMarch = (5 * llDayOfYear + 2) / 153;
+
+		iDay = static_cast<int>(llDayOfYear - (153 * llMonthFromMarch + 2) / 5);
+		iMonth = static_cast<int>(
+			(llMonthFromMarch < 10)?(llMonthFromMarch + 2):(llMonthFromMarch - 10));
+		llYear = llYearOfEra + llEra * 400 + ((iMonth < 2)?(1):(0));
+
+	} else {
+		_EXCEPTIONT("Not implemented");
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 void Time::VerifyTime() {
 
 	// Verification only for known CalendarTypes
@@ -181,117 +299,24 @@ void Time::NormalizeTime() {
 		(m_eCalendarType == CalendarGregorian) ||
 		(m_eCalendarType == Calendar360Day)
 	) {
-		int nDaysPerMonth[]
-			= {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-
-		if ((m_eCalendarType == CalendarStandard) ||
-			(m_eCalendarType == CalendarGregorian)
-		) {
-			if ((m_iYear % 4) == 0) {
-				nDaysPerMonth[1] = 29;
-				if (((m_iYear % 100) == 0) && ((m_iYear % 400) != 0)) {
-					nDaysPerMonth[1] = 28;
-				}
-			}
-		}
-		if (m_eCalendarType == Calendar360Day) {
-			for (int i = 0; i < 12; i++) {
-				nDaysPerMonth[i] = 30;
-			}
-		}
-
-		// Add seconds
-		int nAddedSeconds = 0;
-		if (m_iMicroSecond >= 1000000) {
-			nAddedSeconds = m_iMicroSecond / 1000000;
-
-		} else if (m_iMicroSecond < 0) {
-			nAddedSeconds = - (1000000 - m_iSecond) / 1000000;
-		}
-		m_iMicroSecond -= nAddedSeconds * 1000000;
-		m_iSecond += nAddedSeconds;
-
-		// Add days
-		int nAddedDays = 0;
-		if (m_iSecond >= 86400) {
-			nAddedDays = m_iSecond / 86400;
-
-		} else if (m_iSecond < 0) {
-			nAddedDays = - (86400 - m_iSecond) / 86400;
-		}
-
-		m_iSecond -= nAddedDays * 86400;
-		m_iDay += nAddedDays;
-
-		// Add years
-		int nAddedYears = 0;
-		if (m_iMonth >= 12) {
-			nAddedYears = m_iMonth / 12;
-		} else if (m_iMonth < 0) {
-			nAddedYears = - (12 - m_iMonth) / 12;
-		}
-		m_iMonth -= nAddedYears * 12;
-		m_iYear += nAddedYears;
-
-		if ((m_iMonth < 0) || (m_iMonth >= 12)) {
-			_EXCEPTIONT("Logic error");
-		}
-
-		// Subtract months
-		while (m_iDay < 0) {
-			m_iMonth--;
-			if (m_iMonth < 0) {
-				m_iMonth = 11;
-				m_iYear--;
-
-				// Adjust number of days per month
-				if ((m_eCalendarType == CalendarStandard) ||
-					(m_eCalendarType == CalendarGregorian)
-				) {
-					nDaysPerMonth[1] = 28;
-					if ((m_iYear % 4) == 0) {
-						nDaysPerMonth[1] = 29;
-						if (((m_iYear % 100) == 0) && ((m_iYear % 400) != 0)) {
-							nDaysPerMonth[1] = 28;
-						}
-					}
-				}
-			}
-			m_iDay += nDaysPerMonth[m_iMonth];
-		}
-
-		// Add months
-		while (m_iDay >= nDaysPerMonth[m_iMonth]) {
-			m_iDay -= nDaysPerMonth[m_iMonth];
-			m_iMonth++;
-			if (m_iMonth > 11) {
-				m_iMonth = 0;
-				m_iYear++;
-
-				// Adjust number of days per month
-				if ((m_eCalendarType == CalendarStandard) ||
-					(m_eCalendarType == CalendarGregorian)
-				) {
-					nDaysPerMonth[1] = 28;
-					if ((m_iYear % 4) == 0) {
-						nDaysPerMonth[1] = 29;
-						if (((m_iYear % 100) == 0) && ((m_iYear % 400) != 0)) {
-							nDaysPerMonth[1] = 28;
-						}
-					}
-				}
-			}
-		}
-
-		// Check that the result is ok
-		if ((m_iMonth < 0) || (m_iMonth >= 12) ||
-		    (m_iDay < 0) || (m_iDay >= nDaysPerMonth[m_iMonth]) ||
-		    (m_iSecond < 0) || (m_iSecond >= 86400) ||
-			(m_iMicroSecond < 0) || (m_iMicroSecond >= 1e6)
-		) {
-			_EXCEPTION5("Logic error: %i %i %i %i %i",
-				m_iYear, m_iMonth, m_iDay, m_iSecond, m_iMicroSecond);
-		}
+		// Carry microseconds into seconds, seconds into days and
+		// months into years
+		long long llMicroSecond = m_iMicroSecond;
+		long long llSecond = m_iSecond + FloorDivide(llMicroSecond, 1000000);
+		long long llDay = m_iDay + FloorDivide(llSecond, 86400);
+		long long llMonth = m_iMonth;
+		long long llYear = m_iYear + FloorDivide(llMonth, 12);
+
+		// Carry days into months and years in closed form
+		long long llDays =
+			DaysFromDate(m_eCalendarType, llYear, static_cast<int>(llMonth), 0)
+			+ llDay;
+
+		DateFromDays(m_eCalendarType, llDays, llYear, m_iMonth, m_iDay);
+
+		m_iYear = static_cast<int>(llYear);
+		m_iSecond = static_cast<int>(llSecond);
+		m_iMicroSecond = static_cast<int>(llMicroSecond);
 	}
 }
 
@@ -346,6 +371,31 @@ int Time::DayNumber() const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+long long Time::GetEpochMicroSeconds() const {
+	long long llDays =
+		DaysFromDate(m_eCalendarType, m_iYear, m_iMonth, m_iDay);
+
+	return (llDays * 86400 + m_iSecond) * 1000000 + m_iMicroSecond;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Time::FromEpochMicroSeconds(
+	long long llMicroSeconds
+) {
+	long long llSeconds = FloorDivide(llMicroSeconds, 1000000);
+	long long llDays = FloorDivide(llSeconds, 86400);
+	long long llYear;
+
+	DateFromDays(m_eCalendarType, llDays, llYear, m_iMonth, m_iDay);
+
+	m_iYear = static_cast<int>(llYear);
+	m_iSecond = static_cast<int>(llSeconds);
+	m_iMicroSecond = static_cast<int>(llMicroSeconds);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 double Time::operator-(const Time & time) const {
 	return -DeltaSeconds(time);
 }
@@ -302,6 +302,20 @@ public:
 	///	</summary>
 	int DayNumber() const;
 
+	///	<summary>
+	///		Get the number of microseconds since 1970-01-01 00:00:00 in
+	///		the calendar of this Time, computed in closed form.
+	///	</summary>
+	long long GetEpochMicroSeconds() const;
+
+	///	<summary>
+	///		Set this Time from a number of microseconds since
+	///		1970-01-01 00:00:00 in its calendar, computed in closed form.
+	///	</summary>
+	void FromEpochMicroSeconds(
+		long long llMicroSeconds
+	);
+
 	///	<summary>
 	///		Determine the number of seconds between two Times.
 	///	</summary>
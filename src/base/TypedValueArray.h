@@ -0,0 +1,358 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    TypedValueArray.h
+///	\version October 15, 2026
+///
+
+#ifndef _TYPEDVALUEARRAY_H_
+#define _TYPEDVALUEARRAY_H_
+
+#include "Exception.h"
+#include "netcdfcpp.h"
+
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		The NcType of each C++ type holding the values of a numeric
+///		NetCDF type, and the type to which a value is promoted when it
+///		is formatted.
+///	</summary>
+template <typename T>
+struct NcValueTraits;
+
+template <>
+struct NcValueTraits<signed char> {
+	static const NcType Type = ncByte;
+	typedef int Promoted;
+};
+
+template <>
+struct NcValueTraits<short> {
+	static const NcType Type = ncShort;
+	typedef int Promoted;
+};
+
+template <>
+struct NcValueTraits<int> {
+	static const NcType Type = ncInt;
+	typedef int Promoted;
+};
+
+template <>
+struct NcValueTraits<float> {
+	static const NcType Type = ncFloat;
+	typedef float Promoted;
+};
+
+template <>
+struct NcValueTraits<double> {
+	static const NcType Type = ncDouble;
+	typedef double Promoted;
+};
+
+template <>
+struct NcValueTraits<unsigned char> {
+	static const NcType Type = ncUByte;
+	typedef int Promoted;
+};
+
+template <>
+struct NcValueTraits<unsigned short> {
+	static const NcType Type = ncUShort;
+	typedef int Promoted;
+};
+
+template <>
+struct NcValueTraits<unsigned int> {
+	static const NcType Type = ncUInt;
+	typedef long long Promoted;
+};
+
+template <>
+struct NcValueTraits<long long> {
+	static const NcType Type = ncInt64;
+	typedef long long Promoted;
+};
+
+template <>
+struct NcValueTraits<unsigned long long> {
+	static const NcType Type = ncUInt64;
+	typedef unsigned long long Promoted;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Call fn.template Apply<T>() with the C++ type T holding values of
+///		the given NcType.  Returns false without calling fn if the type
+///		is not numeric.
+///	</summary>
+template <typename Fn>
+inline bool DispatchNumericNcType(
+	NcType nctype,
+	Fn & fn
+) {
+	switch(nctype) {
+		case ncByte:
+			fn.template Apply<signed char>();
+			return true;
+		case ncShort:
+			fn.template Apply<short>();
+			return true;
+		case ncInt:
+			fn.template Apply<int>();
+			return true;
+		case ncFloat:
+			fn.template Apply<float>();
+			return true;
+		case ncDouble:
+			fn.template Apply<double>();
+			return true;
+		case ncUByte:
+			fn.template Apply<unsigned char>();
+			return true;
+		case ncUShort:
+			fn.template Apply<unsigned short>();
+			return true;
+		case ncUInt:
+			fn.template Apply<unsigned int>();
+			return true;
+		case ncInt64:
+			fn.template Apply<long long>();
+			return true;
+		case ncUInt64:
+			fn.template Apply<unsigned long long>();
+			return true;
+		default:
+			return false;
+	}
+}
+
+///	<summary>
+///		Get the size in bytes of a value of the given NcType, or zero if
+///		the type is not numeric.
+///	</summary>
+inline size_t NcTypeValueSize(
+	NcType nctype
+) {
+	switch(nctype) {
+		case ncByte:
+		case ncUByte:
+			return 1;
+		case ncShort:
+		case ncUShort:
+			return 2;
+		case ncInt:
+		case ncFloat:
+		case ncUInt:
+			return 4;
+		case ncDouble:
+		case ncInt64:
+		case ncUInt64:
+			return 8;
+		default:
+			return 0;
+	}
+}
+
+///	<summary>
+///		Check if the given NcType is numeric; ncChar holds text.
+///	</summary>
+inline bool IsNumericNcType(
+	NcType nctype
+) {
+	return (NcTypeValueSize(nctype) != 0);
+}
+
+///	<summary>
+///		Check if the given NcType is a numeric type compared exactly.
+///	</summary>
+inline bool IsIntegerNcType(
+	NcType nctype
+) {
+	return IsNumericNcType(nctype)
+		&& (nctype != ncFloat)
+		&& (nctype != ncDouble);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the bit pattern of a value, zero-extended to 64 bits.
+///	</summary>
+template <typename T>
+inline unsigned long long NcValueBits(
+	T value
+) {
+	return static_cast<unsigned long long>(
+		static_cast<typename std::make_unsigned<T>::type>(value));
+}
+
+inline unsigned long long NcValueBits(
+	float fl
+) {
+	unsigned int uiBits;
+	memcpy(&uiBits, &fl, sizeof(float));
+	return uiBits;
+}
+
+inline unsigned long long NcValueBits(
+	double d
+) {
+	unsigned long long ullBits;
+	memcpy(&ullBits, &d, sizeof(double));
+	return ullBits;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		An array of values of a single numeric NcType, stored in their
+///		native type.  Operations on the values are written once as a
+///		template over the value type and dispatched on the NcType with
+///		DispatchNumericNcType, so that no per-value branch is needed.
+///	</summary>
+class TypedValueArray {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	TypedValueArray() :
+		m_nctype(ncNoType),
+		m_sSize(0)
+	{ }
+
+public:
+	///	<summary>
+	///		Set the type and number of values.  Values kept from before
+	///		are only meaningful if the type is unchanged.
+	///	</summary>
+	void Resize(
+		NcType nctype,
+		size_t sSize
+	) {
+		const size_t sValueSize = NcTypeValueSize(nctype);
+		if (sValueSize == 0) {
+			_EXCEPTION1("Invalid value type %i", static_cast<int>(nctype));
+		}
+		m_nctype = nctype;
+		m_sSize = sSize;
+		m_vecStorage.resize(
+			(sSize * sValueSize + sizeof(unsigned long long) - 1)
+			/ sizeof(unsigned long long));
+	}
+
+	///	<summary>
+	///		Remove all values and release their memory.
+	///	</summary>
+	void Clear() {
+		m_nctype = ncNoType;
+		m_sSize = 0;
+		std::vector<unsigned long long>().swap(m_vecStorage);
+	}
+
+	///	<summary>
+	///		Exchange the values with another array.
+	///	</summary>
+	void swap(
+		TypedValueArray & values
+	) {
+		std::swap(m_nctype, values.m_nctype);
+		std::swap(m_sSize, values.m_sSize);
+		m_vecStorage.swap(values.m_vecStorage);
+	}
+
+	///	<summary>
+	///		Get the type of the values, or ncNoType if there are none.
+	///	</summary>
+	NcType GetType() const {
+		return m_nctype;
+	}
+
+	///	<summary>
+	///		Get the number of values.
+	///	</summary>
+	size_t size() const {
+		return m_sSize;
+	}
+
+	///	<summary>
+	///		Get the size of the values in bytes.
+	///	</summary>
+	size_t GetBytes() const {
+		return m_sSize * NcTypeValueSize(m_nctype);
+	}
+
+	///	<summary>
+	///		Get the bytes of memory allocated for the values.
+	///	</summary>
+	size_t GetCapacityBytes() const {
+		return m_vecStorage.capacity() * sizeof(unsigned long long);
+	}
+
+	///	<summary>
+	///		Get the values, which must be of type T unless there are none.
+	///	</summary>
+	template <typename T>
+	T * Data() {
+		CheckType(NcValueTraits<T>::Type);
+		return reinterpret_cast<T *>(m_vecStorage.data());
+	}
+
+	template <typename T>
+	const T * Data() const {
+		CheckType(NcValueTraits<T>::Type);
+		return reinterpret_cast<const T *>(m_vecStorage.data());
+	}
+
+	///	<summary>
+	///		Get the values as bytes.
+	///	</summary>
+	void * RawData() {
+		return m_vecStorage.data();
+	}
+
+	const void * RawData() const {
+		return m_vecStorage.data();
+	}
+
+protected:
+	///	<summary>
+	///		Verify values are accessed as the type they are stored as.
+	///	</summary>
+	void CheckType(
+		NcType nctype
+	) const {
+		if ((m_sSize != 0) && (nctype != m_nctype)) {
+			_EXCEPTION2("Values of type %i accessed as type %i",
+				static_cast<int>(m_nctype), static_cast<int>(nctype));
+		}
+	}
+
+protected:
+	///	<summary>
+	///		Type of the values.
+	///	</summary>
+	NcType m_nctype;
+
+	///	<summary>
+	///		Number of values.
+	///	</summary>
+	size_t m_sSize;
+
+	///	<summary>
+	///		Storage for the values, aligned for the widest type.
+	///	</summary>
+	std::vector<unsigned long long> m_vecStorage;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
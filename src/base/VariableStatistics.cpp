@@ -0,0 +1,486 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    VariableStatistics.cpp
+///	\version October 15, 2026
+///
+
+#include "VariableStatistics.h"
+#include "ClassicNcFile.h"
+#include "TypedValueArray.h"
+#include "NetCDFUtilities.h"
+#include "../contrib/json.hpp"
+
+#include "netcdf.h"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Number of bytes of values read and reduced at a time.
+///	</summary>
+static const size_t StatisticsBlockBytes = 16 * 1024 * 1024;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check if a value is finite.  Integer values always are; written
+///		without a library call so that the reduction loop is branch-free.
+///	</summary>
+template <typename T>
+static inline bool IsFiniteValue(T) {
+	return true;
+}
+
+static inline bool IsFiniteValue(float x) {
+	return ((x - x) == 0.0f);
+}
+
+static inline bool IsFiniteValue(double x) {
+	return ((x - x) == 0.0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		The _FillValue and missing_value of a variable, if present and
+///		representable in its type.
+///	</summary>
+template <typename T>
+struct ExcludedValues {
+	ExcludedValues() :
+		fHasFillValue(false),
+		tFillValue(0),
+		fHasMissingValue(false),
+		tMissingValue(0)
+	{ }
+
+	bool fHasFillValue;
+	T tFillValue;
+	bool fHasMissingValue;
+	T tMissingValue;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Convert an attribute value to the type of the variable, returning
+///		false if it lies outside the range of the type.
+///	</summary>
+template <typename T>
+static bool ExcludedValueFromDouble(
+	double dValue,
+	T & tValue
+) {
+	const long double ldValue = static_cast<long double>(dValue);
+	if (!(ldValue >= static_cast<long double>(std::numeric_limits<T>::lowest())) ||
+	    !(ldValue <= static_cast<long double>(std::numeric_limits<T>::max()))
+	) {
+		return false;
+	}
+	tValue = static_cast<T>(dValue);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Convert an integer attribute value to the integer type of the
+///		variable, returning false if it lies outside the range of the type.
+///	</summary>
+template <typename T>
+static bool ExcludedValueFromInt64(
+	long long llValue,
+	T & tValue
+) {
+	if (llValue < 0) {
+		if (!std::numeric_limits<T>::is_signed ||
+		    (llValue < static_cast<long long>(std::numeric_limits<T>::lowest()))
+		) {
+			return false;
+		}
+	} else if (static_cast<unsigned long long>(llValue) >
+	           static_cast<unsigned long long>(std::numeric_limits<T>::max())
+	) {
+		return false;
+	}
+	tValue = static_cast<T>(llValue);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Reduce a block of values into the statistics.  The loop body is
+///		branch-free, so that the missing values scattered through a
+///		block cost no mispredicted branches, and the compiler may
+///		vectorize it where the target allows.
+///	</summary>
+template <typename T>
+static void AddStatisticsBlock(
+	VariableStatistics & stats,
+	const T * pValues,
+	size_t sCount,
+	const ExcludedValues<T> & excluded
+) {
+	const bool fNoFillValue = !excluded.fHasFillValue;
+	const bool fNoMissingValue = !excluded.fHasMissingValue;
+	const T tFillValue = excluded.tFillValue;
+	const T tMissingValue = excluded.tMissingValue;
+
+	T tMin = std::numeric_limits<T>::max();
+	T tMax = std::numeric_limits<T>::lowest();
+	double dSum = 0.0;
+	size_t sValid = 0;
+
+	for (size_t i = 0; i < sCount; i++) {
+		const T t = pValues[i];
+		const bool fValid =
+			IsFiniteValue(t)
+			& (fNoFillValue | (t != tFillValue))
+			& (fNoMissingValue | (t != tMissingValue));
+
+		tMin = (fValid & (t < tMin))?(t):(tMin);
+		tMax = (fValid & (t > tMax))?(t):(tMax);
+		dSum += (fValid)?(static_cast<double>(t)):(0.0);
+		sValid += (fValid)?(1):(0);
+	}
+
+	if (sValid != 0) {
+		if (stats.m_ullCount == 0) {
+			stats.m_dMin = static_cast<double>(tMin);
+			stats.m_dMax = static_cast<double>(tMax);
+		} else {
+			stats.m_dMin = std::min(stats.m_dMin, static_cast<double>(tMin));
+			stats.m_dMax = std::max(stats.m_dMax, static_cast<double>(tMax));
+		}
+	}
+	stats.m_ullCount += sValid;
+	stats.m_ullMissing += sCount - sValid;
+	stats.m_dSum += dSum;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Read the first value of a numeric attribute of a variable of an
+///		open NetCDF file, returning false if it is absent or unusable.
+///		Attributes of the type of the variable are read exactly, so that
+///		64-bit integer values are not rounded.
+///	</summary>
+template <typename T>
+static bool ReadNcExcludedValue(
+	int ncid,
+	int varid,
+	const char * szName,
+	T & tValue
+) {
+	nc_type nctypeAtt;
+	size_t sLength;
+	if ((nc_inq_atttype(ncid, varid, szName, &nctypeAtt) != NC_NOERR) ||
+	    (nc_inq_attlen(ncid, varid, szName, &sLength) != NC_NOERR)
+	) {
+		return false;
+	}
+	if (sLength == 0) {
+		return false;
+	}
+	if (static_cast<int>(nctypeAtt) == static_cast<int>(NcValueTraits<T>::Type)) {
+		std::vector<T> vecValues(sLength);
+		if (nc_get_att(ncid, varid, szName, &(vecValues[0])) != NC_NOERR) {
+			return false;
+		}
+		tValue = vecValues[0];
+		return true;
+	}
+
+	// Integer attributes of integer variables are converted exactly
+	if (std::numeric_limits<T>::is_integer &&
+	    (nctypeAtt != NC_FLOAT) &&
+	    (nctypeAtt != NC_DOUBLE)
+	) {
+		std::vector<long long> vecIntegers;
+		if (!GetNcAttAsInt64s(ncid, varid, szName, vecIntegers)) {
+			return false;
+		}
+		return ExcludedValueFromInt64<T>(vecIntegers[0], tValue);
+	}
+
+	std::vector<double> vecReals;
+	if (!GetNcAttAsDoubles(ncid, varid, szName, vecReals)) {
+		return false;
+	}
+	return ExcludedValueFromDouble<T>(vecReals[0], tValue);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Compute the statistics of a variable of an open NetCDF file once
+///		its type is known.  The trailing dimensions that fit in a block
+///		are read whole, the next dimension a slab of them at a time, and
+///		the leading dimensions one index at a time.
+///	</summary>
+struct NcStatisticsKernel {
+	VariableStatistics & stats;
+	int ncid;
+	int varid;
+	const std::vector<size_t> & vecShape;
+	std::string strError;
+
+	template <typename T>
+	void Apply() {
+		ExcludedValues<T> excluded;
+		excluded.fHasFillValue =
+			ReadNcExcludedValue<T>(ncid, varid, "_FillValue", excluded.tFillValue);
+		excluded.fHasMissingValue =
+			ReadNcExcludedValue<T>(ncid, varid, "missing_value", excluded.tMissingValue);
+
+		const int nDims = static_cast<int>(vecShape.size());
+		const size_t sBlockValues =
+			std::max<size_t>(1, StatisticsBlockBytes / sizeof(T));
+
+		// Scalar variables
+		if (nDims == 0) {
+			size_t sStart = 0;
+			size_t sCount = 1;
+			T tValue;
+			if (nc_get_vara(ncid, varid, &sStart, &sCount, &tValue) != NC_NOERR) {
+				strError = "Unable to read variable values";
+				return;
+			}
+			AddStatisticsBlock<T>(stats, &tValue, 1, excluded);
+			return;
+		}
+
+		for (int d = 0; d < nDims; d++) {
+			if (vecShape[d] == 0) {
+				return;
+			}
+		}
+
+		// Find the trailing dimensions that are read whole
+		int k = nDims - 1;
+		size_t sInner = 1;
+		while ((k >= 0) && (sInner * vecShape[k] <= sBlockValues)) {
+			sInner *= vecShape[k];
+			k--;
+		}
+
+		std::vector<size_t> vecStart(nDims, 0);
+		std::vector<size_t> vecCount(vecShape);
+
+		// The whole variable fits in one block
+		if (k < 0) {
+			std::vector<T> vecValues(sInner);
+			if (nc_get_vara(ncid, varid, &(vecStart[0]), &(vecCount[0]), &(vecValues[0])) != NC_NOERR) {
+				strError = "Unable to read variable values";
+				return;
+			}
+			AddStatisticsBlock<T>(stats, &(vecValues[0]), sInner, excluded);
+			return;
+		}
+
+		for (int d = 0; d < k; d++) {
+			vecCount[d] = 1;
+		}
+		const size_t sSlab = std::max<size_t>(1, sBlockValues / sInner);
+		std::vector<T> vecValues(std::min(sSlab, vecShape[k]) * sInner);
+
+		for (;;) {
+			for (size_t s = 0; s < vecShape[k]; s += sSlab) {
+				vecStart[k] = s;
+				vecCount[k] = std::min(sSlab, vecShape[k] - s);
+				if (nc_get_vara(ncid, varid, &(vecStart[0]), &(vecCount[0]), &(vecValues[0])) != NC_NOERR) {
+					strError = "Unable to read variable values";
+					return;
+				}
+				AddStatisticsBlock<T>(stats, &(vecValues[0]), vecCount[k] * sInner, excluded);
+			}
+
+			int d = k - 1;
+			for (; d >= 0; d--) {
+				vecStart[d]++;
+				if (vecStart[d] < vecShape[d]) {
+					break;
+				}
+				vecStart[d] = 0;
+			}
+			if (d < 0) {
+				break;
+			}
+		}
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the first value of a numeric attribute of a variable of a
+///		ClassicNcFile, returning false if it is unusable.  Integer
+///		attributes of the type of the variable are decoded exactly, so
+///		that 64-bit values are not rounded.
+///	</summary>
+template <typename T>
+static bool ClassicExcludedValue(
+	const ClassicNcAttribute & att,
+	int nVarType,
+	T & tValue
+) {
+	if (std::numeric_limits<T>::is_integer &&
+	    (att.m_nType == nVarType) &&
+	    (att.m_sCount != 0) &&
+	    (att.m_vecData.size() >= sizeof(T))
+	) {
+		unsigned long long ullValue = 0;
+		for (size_t i = 0; i < sizeof(T); i++) {
+			ullValue = (ullValue << 8)
+				| static_cast<unsigned char>(att.m_vecData[i]);
+		}
+		tValue = static_cast<T>(ullValue);
+		return true;
+	}
+
+	double dValue;
+	if (!att.GetValue(0, dValue)) {
+		return false;
+	}
+	return ExcludedValueFromDouble<T>(dValue, tValue);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Compute the statistics of a variable of a ClassicNcFile once its
+///		type is known, reading the values a block at a time in the order
+///		they are stored.
+///	</summary>
+struct ClassicStatisticsKernel {
+	VariableStatistics & stats;
+	const ClassicNcFile & ncclassic;
+	const ClassicNcVariable & var;
+	bool fSuccess;
+
+	template <typename T>
+	void Apply() {
+		ExcludedValues<T> excluded;
+		for (size_t a = 0; a < var.m_vecAttributes.size(); a++) {
+			const ClassicNcAttribute & att = var.m_vecAttributes[a];
+			if (att.m_strName == "_FillValue") {
+				excluded.fHasFillValue =
+					ClassicExcludedValue<T>(att, var.m_nType, excluded.tFillValue);
+			} else if (att.m_strName == "missing_value") {
+				excluded.fHasMissingValue =
+					ClassicExcludedValue<T>(att, var.m_nType, excluded.tMissingValue);
+			}
+		}
+
+		const unsigned long long ullElements = ncclassic.GetElementCount(var);
+		const size_t sBlockValues =
+			std::max<size_t>(1, StatisticsBlockBytes / sizeof(T));
+
+		std::vector<T> vecValues(
+			static_cast<size_t>(std::min<unsigned long long>(ullElements, sBlockValues)));
+
+		for (unsigned long long ull = 0; ull < ullElements; ull += sBlockValues) {
+			const size_t sCount = static_cast<size_t>(
+				std::min<unsigned long long>(sBlockValues, ullElements - ull));
+			if (!ncclassic.ReadElements(var, ull, sCount, &(vecValues[0]))) {
+				fSuccess = false;
+				return;
+			}
+			AddStatisticsBlock<T>(stats, &(vecValues[0]), sCount, excluded);
+		}
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VariableStatistics
+///////////////////////////////////////////////////////////////////////////////
+
+std::string VariableStatistics::FromNcVar(
+	int ncid,
+	int varid
+) {
+	(*this) = VariableStatistics();
+
+	nc_type nctype;
+	int nDims;
+	if ((nc_inq_vartype(ncid, varid, &nctype) != NC_NOERR) ||
+	    (nc_inq_varndims(ncid, varid, &nDims) != NC_NOERR)
+	) {
+		return std::string("Unable to query variable");
+	}
+
+	std::vector<int> vecDimIds(std::max(nDims, 1));
+	if (nc_inq_vardimid(ncid, varid, &(vecDimIds[0])) != NC_NOERR) {
+		return std::string("Unable to query variable dimensions");
+	}
+
+	std::vector<size_t> vecShape(nDims);
+	for (int d = 0; d < nDims; d++) {
+		if (nc_inq_dimlen(ncid, vecDimIds[d], &(vecShape[d])) != NC_NOERR) {
+			return std::string("Unable to query variable dimensions");
+		}
+	}
+
+	// Variables that are not numeric have no statistics
+	NcStatisticsKernel kernel = { *this, ncid, varid, vecShape, std::string() };
+	DispatchNumericNcType(static_cast<NcType>(nctype), kernel);
+
+	return kernel.strError;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool VariableStatistics::FromClassicNcVar(
+	const ClassicNcFile & ncclassic,
+	const ClassicNcVariable & var
+) {
+	(*this) = VariableStatistics();
+
+	// Variables that are not numeric have no statistics
+	ClassicStatisticsKernel kernel = { *this, ncclassic, var, true };
+	DispatchNumericNcType(static_cast<NcType>(var.m_nType), kernel);
+
+	return kernel.fSuccess;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableStatistics::Add(
+	const VariableStatistics & stats
+) {
+	if (stats.m_ullCount != 0) {
+		if (m_ullCount == 0) {
+			m_dMin = stats.m_dMin;
+			m_dMax = stats.m_dMax;
+		} else {
+			m_dMin = std::min(m_dMin, stats.m_dMin);
+			m_dMax = std::max(m_dMax, stats.m_dMax);
+		}
+	}
+	m_ullCount += stats.m_ullCount;
+	m_ullMissing += stats.m_ullMissing;
+	m_dSum += stats.m_dSum;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void VariableStatistics::ToJSON(
+	nlohmann::json & j
+) const {
+	j = nlohmann::json::object();
+	j["count"] = m_ullCount;
+	j["missing"] = m_ullMissing;
+	if (m_ullCount != 0) {
+		j["min"] = m_dMin;
+		j["max"] = m_dMax;
+		j["mean"] = GetMean();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
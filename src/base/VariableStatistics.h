@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    VariableStatistics.h
+///	\version October 15, 2026
+///
+
+#ifndef _VARIABLESTATISTICS_H_
+#define _VARIABLESTATISTICS_H_
+
+#include "../contrib/nlohmann/json_fwd.hpp"
+
+#include <string>
+
+class ClassicNcFile;
+struct ClassicNcVariable;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Quick-look statistics of the values of a variable: the number of
+///		valid and missing values, and the minimum, maximum and mean of the
+///		valid values.  Values equal to _FillValue or missing_value, and
+///		NaN and infinite values, are counted as missing.  Statistics of
+///		several files are combined with Add.
+///	</summary>
+class VariableStatistics {
+
+public:
+	///	<summary>
+	///		Constructor.
+	///	</summary>
+	VariableStatistics() :
+		m_ullCount(0),
+		m_ullMissing(0),
+		m_dMin(0.0),
+		m_dMax(0.0),
+		m_dSum(0.0)
+	{ }
+
+public:
+	///	<summary>
+	///		Read all values of the given variable of an open NetCDF file
+	///		a block at a time and compute their statistics.  The caller
+	///		must hold the NetCDF library mutex.  Returns an error message
+	///		if the values cannot be read.
+	///	</summary>
+	std::string FromNcVar(
+		int ncid,
+		int varid
+	);
+
+	///	<summary>
+	///		Read all values of the given variable of a ClassicNcFile a
+	///		block at a time and compute their statistics.  Returns false
+	///		if the values cannot be read.
+	///	</summary>
+	bool FromClassicNcVar(
+		const ClassicNcFile & ncclassic,
+		const ClassicNcVariable & var
+	);
+
+	///	<summary>
+	///		Add the statistics of other values.
+	///	</summary>
+	void Add(
+		const VariableStatistics & stats
+	);
+
+	///	<summary>
+	///		Check if no values have been added.
+	///	</summary>
+	bool IsEmpty() const {
+		return ((m_ullCount == 0) && (m_ullMissing == 0));
+	}
+
+	///	<summary>
+	///		Get the mean of the valid values.
+	///	</summary>
+	double GetMean() const {
+		return (m_ullCount == 0)?(0.0):(m_dSum / static_cast<double>(m_ullCount));
+	}
+
+	///	<summary>
+	///		Convert to a JSON object with members "count", "missing" and,
+	///		if there are valid values, "min", "max" and "mean".
+	///	</summary>
+	void ToJSON(
+		nlohmann::json & j
+	) const;
+
+	///	<summary>
+	///		Set the mean of the valid values, given after the count.
+	///	</summary>
+	void SetMean(
+		double dMean
+	) {
+		m_dSum = dMean * static_cast<double>(m_ullCount);
+	}
+
+public:
+	///	<summary>
+	///		Number of valid values.
+	///	</summary>
+	unsigned long long m_ullCount;
+
+	///	<summary>
+	///		Number of missing values.
+	///	</summary>
+	unsigned long long m_ullMissing;
+
+	///	<summary>
+	///		Smallest and largest valid value.
+	///	</summary>
+	double m_dMin;
+	double m_dMax;
+
+	///	<summary>
+	///		Sum of the valid values.
+	///	</summary>
+	double m_dSum;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
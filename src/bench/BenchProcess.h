@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    BenchProcess.h
+///	\version October 15, 2026
+///
+
+#ifndef _BENCHPROCESS_H_
+#define _BENCHPROCESS_H_
+
+#include "Exception.h"
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <sstream>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Split a string on the given delimiter, dropping empty tokens.
+///	</summary>
+inline void SplitString(
+	const std::string & str,
+	char cDelimiter,
+	std::vector<std::string> & vecTokens
+) {
+	vecTokens.clear();
+	std::istringstream iss(str);
+	std::string strToken;
+	while (std::getline(iss, strToken, cDelimiter)) {
+		if (strToken != "") {
+			vecTokens.push_back(strToken);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Measurements of one run of a command.
+///	</summary>
+struct RunResult {
+
+	///	<summary>
+	///		Exit status of the run.
+	///	</summary>
+	int iStatus;
+
+	///	<summary>
+	///		Wall clock time in seconds.
+	///	</summary>
+	double dWallTime;
+
+	///	<summary>
+	///		Peak resident set size of the largest process in kilobytes.
+	///	</summary>
+	long lMaxRSSKB;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Run a command and wait for it, measuring its wall time and the
+///		peak RSS of it and its descendants.  Output of the command is
+///		written to strLogFile.
+///	</summary>
+inline RunResult RunCommand(
+	const std::vector<std::string> & vecArgs,
+	const std::string & strLogFile
+) {
+	std::vector<char *> vecArgv;
+	for (size_t i = 0; i < vecArgs.size(); i++) {
+		vecArgv.push_back(const_cast<char *>(vecArgs[i].c_str()));
+	}
+	vecArgv.push_back(NULL);
+
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point tBegin = Clock::now();
+
+	pid_t pid = fork();
+	if (pid < 0) {
+		_EXCEPTIONT("Unable to fork");
+	}
+	if (pid == 0) {
+		FILE * fpLog = freopen(strLogFile.c_str(), "w", stdout);
+		if (fpLog != NULL) {
+			dup2(fileno(stdout), fileno(stderr));
+		}
+		execvp(vecArgv[0], &(vecArgv[0]));
+		_exit(127);
+	}
+
+	int iStatus = 0;
+	struct rusage usage;
+	if (wait4(pid, &iStatus, 0, &usage) != pid) {
+		_EXCEPTIONT("Unable to wait for child process");
+	}
+
+	RunResult result;
+	result.dWallTime =
+		std::chrono::duration<double>(Clock::now() - tBegin).count();
+	result.lMaxRSSKB = usage.ru_maxrss;
+	result.iStatus = WIFEXITED(iStatus)?(WEXITSTATUS(iStatus)):(-1);
+	return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the path of an executable in the directory of this executable.
+///	</summary>
+inline std::string SiblingExecutable(
+	const char * szSelf,
+	const char * szName
+) {
+	std::string strSelf(szSelf);
+	size_t sSlash = strSelf.rfind('/');
+	if (sSlash == std::string::npos) {
+		return std::string(szName);
+	}
+	return strSelf.substr(0, sSlash+1) + std::string(szName);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif
+
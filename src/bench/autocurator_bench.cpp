@@ -0,0 +1,561 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    autocurator_bench.cpp
+///	\version October 14, 2026
+///
+
+#include "CommandLine.h"
+#include "Announce.h"
+#include "Exception.h"
+#include "IndexedDataset.h"
+#include "LookupVectorHeap.h"
+#include "STLStringHelper.h"
+#include "TimeObj.h"
+#include "CFTimeUnits.h"
+#include "DataArray3D.h"
+#include "../contrib/json.hpp"
+
+#include "netcdfcpp.h"
+
+#include <unistd.h>
+#include <cstdio>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Sink for benchmark results, so that the work is not optimized
+///		away.
+///	</summary>
+static volatile size_t s_sSink = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Results of all benchmarks run.
+///	</summary>
+static nlohmann::json s_jResults = nlohmann::json::array();
+
+///	<summary>
+///		Substring of the names of the benchmarks to run.
+///	</summary>
+static std::string s_strFilter;
+
+///	<summary>
+///		Minimum duration of one sample in seconds.
+///	</summary>
+static double s_dMinSampleTime = 0.05;
+
+///	<summary>
+///		Number of samples of each benchmark.
+///	</summary>
+static int s_nSamples = 7;
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Time fnBody, which performs sOpsPerCall operations per call.
+///		The number of calls per sample is doubled until a sample takes at
+///		least s_dMinSampleTime, and the median and minimum time per
+///		operation over s_nSamples samples are recorded under strName.
+///	</summary>
+template <typename BodyType>
+static void RunBenchmark(
+	const std::string & strName,
+	const nlohmann::json & jParams,
+	size_t sOpsPerCall,
+	BodyType fnBody
+) {
+	if ((s_strFilter != "") && (strName.find(s_strFilter) == std::string::npos)) {
+		return;
+	}
+
+	typedef std::chrono::steady_clock Clock;
+
+	// Calibrate, which also warms up caches
+	size_t sCalls = 1;
+	for (;;) {
+		Clock::time_point tBegin = Clock::now();
+		for (size_t c = 0; c < sCalls; c++) {
+			fnBody();
+		}
+		double dElapsed =
+			std::chrono::duration<double>(Clock::now() - tBegin).count();
+		if ((dElapsed >= s_dMinSampleTime) || (sCalls >= (1ull << 40))) {
+			break;
+		}
+		sCalls *= 2;
+	}
+
+	std::vector<double> vecNsPerOp;
+	for (int s = 0; s < s_nSamples; s++) {
+		Clock::time_point tBegin = Clock::now();
+		for (size_t c = 0; c < sCalls; c++) {
+			fnBody();
+		}
+		double dElapsed =
+			std::chrono::duration<double>(Clock::now() - tBegin).count();
+		vecNsPerOp.push_back(
+			dElapsed * 1.0e9 / static_cast<double>(sCalls * sOpsPerCall));
+	}
+	std::sort(vecNsPerOp.begin(), vecNsPerOp.end());
+
+	nlohmann::json jResult;
+	jResult["name"] = strName;
+	jResult["params"] = jParams;
+	jResult["ops_per_sample"] = sCalls * sOpsPerCall;
+	jResult["samples"] = s_nSamples;
+	jResult["ns_per_op"] = vecNsPerOp[vecNsPerOp.size() / 2];
+	jResult["ns_per_op_min"] = vecNsPerOp[0];
+	s_jResults.push_back(jResult);
+
+	Announce("%-28s %-36s %12.2f ns/op",
+		strName.c_str(), jParams.dump().c_str(),
+		vecNsPerOp[vecNsPerOp.size() / 2]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Generate sCount distinct keys shaped like file ids.
+///	</summary>
+static void GenerateKeys(
+	size_t sCount,
+	std::vector<std::string> & vecKeys
+) {
+	vecKeys.resize(sCount);
+	for (size_t i = 0; i < sCount; i++) {
+		// Visit ids out of order so insertion is not sorted
+		size_t sId = (i * 2654435761ull) % sCount;
+		vecKeys[i] = std::to_string(sId);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void BenchLookupVectorHeap() {
+	const size_t sSizes[] = {1000, 100000};
+
+	for (size_t n = 0; n < 2; n++) {
+	for (int iHash = 0; iHash < 2; iHash++) {
+		const size_t sCount = sSizes[n];
+		const bool fHashIndex = (iHash != 0);
+
+		std::vector<std::string> vecKeys;
+		GenerateKeys(sCount, vecKeys);
+
+		nlohmann::json jParams;
+		jParams["size"] = sCount;
+		jParams["hash_index"] = fHashIndex;
+
+		RunBenchmark("lookup_vector_heap_insert", jParams, sCount, [&]() {
+			LookupVectorHeap<std::string, size_t> heap(fHashIndex);
+			for (size_t i = 0; i < sCount; i++) {
+				heap.insert(vecKeys[i], new size_t(i));
+			}
+			s_sSink += heap.size();
+		});
+
+		LookupVectorHeap<std::string, size_t> heap(fHashIndex);
+		for (size_t i = 0; i < sCount; i++) {
+			heap.insert(vecKeys[i], new size_t(i));
+		}
+		std::vector<std::string> vecQueries(vecKeys);
+		std::reverse(vecQueries.begin(), vecQueries.end());
+
+		RunBenchmark("lookup_vector_heap_find", jParams, sCount, [&]() {
+			size_t sFound = 0;
+			for (size_t i = 0; i < sCount; i++) {
+				sFound += (heap.find(vecQueries[i]) != heap.end())?(1):(0);
+			}
+			s_sSink += sFound;
+		});
+	}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Fill a SubAxis with sCount values of the given type that are not
+///		an arithmetic progression.
+///	</summary>
+static void GenerateSubAxis(
+	NcType nctype,
+	size_t sCount,
+	SubAxis & subaxis
+) {
+	subaxis.m_nctype = nctype;
+	subaxis.m_lSize = static_cast<long>(sCount);
+	subaxis.m_values.Resize(nctype, sCount);
+	for (size_t i = 0; i < sCount; i++) {
+		double dValue = static_cast<double>(i) + 0.25 * std::sin(static_cast<double>(i));
+		if (nctype == ncInt) {
+			subaxis.m_values.Data<int>()[i] = static_cast<int>(i * i);
+		} else if (nctype == ncFloat) {
+			subaxis.m_values.Data<float>()[i] = static_cast<float>(dValue);
+		} else {
+			subaxis.m_values.Data<double>()[i] = dValue;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static const char * NcTypeName(
+	NcType nctype
+) {
+	if (nctype == ncInt) {
+		return "int";
+	} else if (nctype == ncFloat) {
+		return "float";
+	}
+	return "double";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void BenchSubAxis() {
+	const NcType nctypes[] = {ncInt, ncFloat, ncDouble};
+	const size_t sSizes[] = {16, 1024, 65536};
+
+	for (int t = 0; t < 3; t++) {
+	for (int n = 0; n < 3; n++) {
+		SubAxis subaxisA;
+		SubAxis subaxisB;
+		GenerateSubAxis(nctypes[t], sSizes[n], subaxisA);
+		GenerateSubAxis(nctypes[t], sSizes[n], subaxisB);
+
+		nlohmann::json jParams;
+		jParams["type"] = NcTypeName(nctypes[t]);
+		jParams["size"] = sSizes[n];
+
+		RunBenchmark("subaxis_equal", jParams, 1, [&]() {
+			s_sSink += (subaxisA == subaxisB)?(1):(0);
+		});
+	}
+	}
+
+	for (int t = 0; t < 3; t++) {
+		SubAxis subaxis;
+		GenerateSubAxis(nctypes[t], 1024, subaxis);
+
+		nlohmann::json jParams;
+		jParams["type"] = NcTypeName(nctypes[t]);
+		jParams["size"] = 1024;
+
+		RunBenchmark("subaxis_values_to_string", jParams, 1024, [&]() {
+			s_sSink += subaxis.ValuesToString().length();
+		});
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write a synthetic catalog of sFiles files, each holding a block
+///		of twelve times and sVariables variables on a shared lat/lon
+///		grid.
+///	</summary>
+static void GenerateCatalog(
+	const std::string & strFilename,
+	size_t sFiles,
+	size_t sVariables
+) {
+	nlohmann::json j;
+
+	j["dataset"]["Conventions"] = "CF-1.6";
+	j["dataset"]["title"] = "synthetic catalog";
+
+	nlohmann::json & jLat = j["axes"]["lat"];
+	jLat["datatype"] = "Double";
+	jLat["units"] = "degrees_north";
+	jLat["subaxes"]["0"]["datatype"] = "Double";
+	jLat["subaxes"]["0"]["size"] = 96;
+	for (int i = 0; i < 96; i++) {
+		jLat["subaxes"]["0"]["values"].push_back(
+			-90.0 + 180.0 * std::sin(0.5 * M_PI * (i + 0.5) / 96.0));
+	}
+
+	nlohmann::json & jLon = j["axes"]["lon"];
+	jLon["datatype"] = "Double";
+	jLon["units"] = "degrees_east";
+	jLon["subaxes"]["0"]["datatype"] = "Double";
+	jLon["subaxes"]["0"]["size"] = 192;
+	jLon["subaxes"]["0"]["range"]["start"] = 0.0;
+	jLon["subaxes"]["0"]["range"]["step"] = 1.875;
+
+	nlohmann::json & jTime = j["axes"]["time"];
+	jTime["datatype"] = "Double";
+	jTime["units"] = "days since 1850-01-01";
+	jTime["calendar"] = "noleap";
+	for (size_t f = 0; f < sFiles; f++) {
+		nlohmann::json & jSubAxis = jTime["subaxes"][std::to_string(f)];
+		jSubAxis["datatype"] = "Double";
+		jSubAxis["size"] = 12;
+		for (int m = 0; m < 12; m++) {
+			jSubAxis["values"].push_back(365.0 * f + 30.4 * m + 15.5);
+		}
+	}
+
+	for (size_t v = 0; v < sVariables; v++) {
+		nlohmann::json & jVar = j["variables"][std::string("var") + std::to_string(v)];
+		jVar["datatype"] = "Float";
+		jVar["units"] = "K";
+		jVar["long_name"] = std::string("Synthetic variable ") + std::to_string(v);
+		jVar["axisids"] = {"time", "lat", "lon"};
+		for (size_t f = 0; f < sFiles; f++) {
+			jVar["subaxismap"].push_back(
+				{std::to_string(f), "0", "0", std::to_string(f)});
+		}
+	}
+
+	for (size_t f = 0; f < sFiles; f++) {
+		nlohmann::json & jFile = j["file"][std::to_string(f)];
+		jFile["name"] = std::string("/data/synthetic/run_")
+			+ std::to_string(1850 + f) + std::string(".nc");
+		jFile["axes"] = nlohmann::json::array();
+		jFile["axes"].push_back(nlohmann::json::array({"lat", "0"}));
+		jFile["axes"].push_back(nlohmann::json::array({"lon", "0"}));
+		jFile["axes"].push_back(nlohmann::json::array({"time", std::to_string(f)}));
+		jFile["tracking_id"] = std::string("id-") + std::to_string(f);
+	}
+
+	std::ofstream ofs(strFilename.c_str());
+	if (!ofs.is_open()) {
+		_EXCEPTION1("Unable to open \"%s\"", strFilename.c_str());
+	}
+	ofs << j;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void BenchJSON(
+	const std::string & strTempDir
+) {
+	const size_t sFiles[] = {100, 1000};
+
+	for (int n = 0; n < 2; n++) {
+		const std::string strCatalog =
+			strTempDir + std::string("/bench_catalog_")
+			+ std::to_string(sFiles[n]) + std::string(".json");
+		const std::string strOutput =
+			strTempDir + std::string("/bench_output_")
+			+ std::to_string(sFiles[n]) + std::string(".json");
+
+		GenerateCatalog(strCatalog, sFiles[n], 20);
+
+		nlohmann::json jParams;
+		jParams["files"] = sFiles[n];
+		jParams["variables"] = 20;
+
+		RunBenchmark("from_json_file", jParams, 1, [&]() {
+			IndexedDataset dataset("bench");
+			std::string strError = dataset.FromJSONFile(strCatalog);
+			if (strError != "") {
+				_EXCEPTIONT(strError.c_str());
+			}
+			s_sSink += (dataset.GetVariableInfo("var0") != NULL)?(1):(0);
+		});
+
+		IndexedDataset dataset("bench");
+		std::string strError = dataset.FromJSONFile(strCatalog);
+		if (strError != "") {
+			_EXCEPTIONT(strError.c_str());
+		}
+
+		RunBenchmark("to_json_file", jParams, 1, [&]() {
+			std::string strError = dataset.ToJSONFile(strOutput, false);
+			if (strError != "") {
+				_EXCEPTIONT(strError.c_str());
+			}
+		});
+
+		unlink(strCatalog.c_str());
+		unlink(strOutput.c_str());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void BenchWildcardMatch() {
+	std::vector<std::string> vecFilenames;
+	for (int i = 0; i < 1000; i++) {
+		char szFilename[128];
+		snprintf(szFilename, sizeof(szFilename),
+			"tas_Amon_Model-%d_historical_r%di1p1f1_gn_%04d01-%04d12.nc",
+			i % 7, i % 10, 1850 + i, 1850 + i);
+		vecFilenames.push_back(szFilename);
+	}
+
+	const char * szPatterns[] = {"*.nc", "tas_*_r1i1p1f1_*.nc", "*_18??01-*"};
+
+	for (int p = 0; p < 3; p++) {
+		nlohmann::json jParams;
+		jParams["pattern"] = szPatterns[p];
+
+		RunBenchmark("wildcard_match", jParams, vecFilenames.size(), [&]() {
+			size_t sMatches = 0;
+			for (size_t f = 0; f < vecFilenames.size(); f++) {
+				if (STLStringHelper::WildcardMatch(
+						szPatterns[p], vecFilenames[f].c_str())
+				) {
+					sMatches++;
+				}
+			}
+			s_sSink += sMatches;
+		});
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void BenchTime() {
+	const Time::CalendarType eCalendars[] =
+		{Time::CalendarNoLeap, Time::CalendarStandard};
+	const char * szCalendars[] = {"noleap", "standard"};
+
+	std::vector<double> vecOffsets;
+	for (int i = 0; i < 4096; i++) {
+		vecOffsets.push_back(0.5 + 10.25 * i);
+	}
+
+	for (int c = 0; c < 2; c++) {
+		nlohmann::json jParams;
+		jParams["calendar"] = szCalendars[c];
+		jParams["units"] = "days since 1850-01-01";
+
+		RunBenchmark("time_from_cf_offset", jParams, vecOffsets.size(), [&]() {
+			size_t sDays = 0;
+			for (size_t i = 0; i < vecOffsets.size(); i++) {
+				Time time(eCalendars[c]);
+				time.FromCFCompliantUnitsOffsetDouble(
+					"days since 1850-01-01", vecOffsets[i]);
+				sDays += time.GetDay();
+			}
+			s_sSink += sDays;
+		});
+
+		CFTimeUnits cftime;
+		std::string strError = cftime.Parse("days since 1850-01-01", szCalendars[c]);
+		if (strError != "") {
+			_EXCEPTIONT(strError.c_str());
+		}
+		std::vector<long long> vecKeys;
+
+		RunBenchmark("cf_time_units_to_time_keys", jParams, vecOffsets.size(), [&]() {
+			cftime.ToTimeKeys(vecOffsets, vecKeys);
+			s_sSink += static_cast<size_t>(vecKeys.back());
+		});
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void BenchDataArray() {
+	const DataArrayPolicy policies[] = {
+		DataArrayPolicy(DataArrayHugePages_None, false),
+		DataArrayPolicy(DataArrayHugePages_None, true),
+		DataArrayPolicy(DataArrayHugePages_Transparent, true)
+	};
+	const char * szHugePages[] = {"none", "transparent", "explicit"};
+
+	// One 4 MiB and one 64 MiB float array, as loaded by LoadData_float
+	const size_t sShapes[][3] = {{16, 256, 256}, {64, 512, 512}};
+
+	for (size_t s = 0; s < 2; s++) {
+		for (size_t p = 0; p < 3; p++) {
+			nlohmann::json jParams;
+			jParams["shape"] = {sShapes[s][0], sShapes[s][1], sShapes[s][2]};
+			jParams["huge_pages"] = szHugePages[policies[p].m_eHugePages];
+			jParams["pooled"] = policies[p].m_fPooled;
+
+			RunBenchmark("data_array_allocate", jParams, 1, [&]() {
+				DataArray3D<float> data(
+					sShapes[s][0], sShapes[s][1], sShapes[s][2], true, policies[p]);
+				data(sShapes[s][0]-1, sShapes[s][1]-1, sShapes[s][2]-1) = 1.0f;
+				s_sSink += static_cast<size_t>(data(0,0,0));
+			});
+		}
+	}
+
+	DataArrayAllocator::Shared().ReleasePool();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+
+	NcError error(NcError::silent_nonfatal);
+
+try {
+
+	// Output JSON file
+	std::string strOutputFile;
+
+	// Directory for temporary files
+	std::string strTempDir;
+
+	// Minimum duration of a sample in seconds
+	double dMinSampleTime;
+
+	// Number of samples
+	int nSamples;
+
+	// Parse the command line
+	BeginCommandLine()
+		CommandLineString(strOutputFile, "out", "bench_results.json");
+		CommandLineString(strTempDir, "tmpdir", "/tmp");
+		CommandLineString(s_strFilter, "filter", "");
+		CommandLineDouble(dMinSampleTime, "min_time", 0.05);
+		CommandLineInt(nSamples, "samples", 7);
+
+		ParseCommandLine(argc, argv);
+	EndCommandLine(argv)
+
+	if (nSamples < 1) {
+		_EXCEPTIONT("--samples must be at least 1");
+	}
+	s_dMinSampleTime = dMinSampleTime;
+	s_nSamples = nSamples;
+
+	AnnounceBanner();
+
+	BenchLookupVectorHeap();
+	BenchSubAxis();
+	BenchJSON(strTempDir);
+	BenchWildcardMatch();
+	BenchTime();
+	BenchDataArray();
+
+	nlohmann::json j;
+	j["benchmarks"] = s_jResults;
+#if defined(__VERSION__)
+	j["context"]["compiler"] = __VERSION__;
+#endif
+	j["context"]["min_sample_time"] = s_dMinSampleTime;
+
+	std::ofstream ofs(strOutputFile.c_str());
+	if (!ofs.is_open()) {
+		_EXCEPTION1("Unable to open output file \"%s\"", strOutputFile.c_str());
+	}
+	ofs << std::setw(4) << j << std::endl;
+
+	AnnounceBanner();
+
+} catch(Exception & e) {
+	Announce(e.ToString().c_str());
+	return (-1);
+}
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
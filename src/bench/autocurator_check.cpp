@@ -0,0 +1,1416 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    autocurator_check.cpp
+///	\version October 15, 2026
+///
+
+#include "CommandLine.h"
+#include "Announce.h"
+#include "Exception.h"
+#include "BenchProcess.h"
+#include "ExtractionScheduler.h"
+#include "../contrib/json.hpp"
+#include "../contrib/tinyxml2.h"
+
+#include <sys/stat.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		A synthetic tree indexed by the check, with the arguments passed
+///		to autocurator_gendata to generate it.
+///	</summary>
+struct CheckTree {
+	const char * szName;
+	std::vector<std::string> vecGenArgs;
+};
+
+///	<summary>
+///		The fixed trees indexed by the check.  Goldens and budgets are
+///		recorded for these exact arguments and must be updated whenever
+///		they change.
+///	</summary>
+static const std::vector<CheckTree> & CheckTrees() {
+	static const std::vector<CheckTree> s_vecTrees = {
+		{"regular", {
+			"--files", "64", "--members", "2", "--vars", "4",
+			"--atts", "3", "--times", "12", "--lat", "16", "--lon", "32",
+			"--grids", "1"}},
+		{"irregular", {
+			"--files", "48", "--vars", "2", "--atts", "1",
+			"--times", "6", "--lat", "8", "--lon", "16", "--lev", "4",
+			"--grids", "2", "--irregular_times", "--calendar", "360_day",
+			"--time_units", "hours since 1979-01-01 00:00:00"}}
+	};
+	return s_vecTrees;
+}
+
+///	<summary>
+///		Modes in which each tree is indexed.
+///	</summary>
+static const char * const CheckModes[] = {
+	"serial", "threaded", "mpi", "incremental"
+};
+
+///	<summary>
+///		Mode in which each tree is indexed with many workers and a short
+///		file deadline.  It has no budget, as it checks only that no file
+///		is timed out.
+///	</summary>
+static const char * const DeadlineMode = "deadline";
+
+///	<summary>
+///		File deadline of the deadline mode, in seconds, which is shorter
+///		than the time a file may wait for the NetCDF library behind the
+///		other workers.
+///	</summary>
+static const char * const DeadlineSeconds = "0.1";
+
+///	<summary>
+///		Name under which the legacy index is selected with --trees and
+///		its goldens are recorded.
+///	</summary>
+static const char * const LegacyTree = "legacy";
+
+///	<summary>
+///		Name under which the check of the extraction schedule is selected
+///		with --trees.
+///	</summary>
+static const char * const ScheduleTree = "schedule";
+
+///	<summary>
+///		Placeholder for the tree directory in canonical outputs.
+///	</summary>
+static const char * const TreePlaceholder = "${TREE}";
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check if a file exists.
+///	</summary>
+static bool FileExists(
+	const std::string & strFile
+) {
+	struct stat statFile;
+	return (stat(strFile.c_str(), &statFile) == 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Read a file into a string; returns false if it cannot be opened.
+///	</summary>
+static bool ReadFile(
+	const std::string & strFile,
+	std::string & strContents
+) {
+	std::ifstream ifs(strFile.c_str(), std::ios::binary);
+	if (!ifs.is_open()) {
+		return false;
+	}
+	std::ostringstream oss;
+	oss << ifs.rdbuf();
+	strContents = oss.str();
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write a string to a file.
+///	</summary>
+static void WriteFile(
+	const std::string & strFile,
+	const std::string & strContents
+) {
+	std::ofstream ofs(strFile.c_str(), std::ios::binary);
+	if (!ofs.is_open()) {
+		_EXCEPTION1("Unable to open \"%s\" for writing", strFile.c_str());
+	}
+	ofs << strContents;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Replace the tree directory at the start of a path with
+///		TreePlaceholder.
+///	</summary>
+static std::string CanonicalPath(
+	const std::string & strPath,
+	const std::string & strTree
+) {
+	if (strPath.compare(0, strTree.length(), strTree) == 0) {
+		return std::string(TreePlaceholder) + strPath.substr(strTree.length());
+	}
+	return strPath;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Assign new ids 0, 1, 2, ... to the given ids in order of their
+///		sort keys, falling back to the order of the old ids.
+///	</summary>
+static void RenumberIds(
+	const std::map<std::string, std::string> & mapSortKeys,
+	std::map<std::string, std::string> & mapNewIds
+) {
+	std::vector< std::pair<std::string, std::string> > vecOrder;
+	std::map<std::string, std::string>::const_iterator iter =
+		mapSortKeys.begin();
+	for (; iter != mapSortKeys.end(); iter++) {
+		vecOrder.push_back(
+			std::pair<std::string, std::string>(iter->second, iter->first));
+	}
+	std::sort(vecOrder.begin(), vecOrder.end());
+
+	mapNewIds.clear();
+	for (size_t i = 0; i < vecOrder.size(); i++) {
+		mapNewIds[vecOrder[i].second] = std::to_string(i);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Look up the new id of an old id, which is unchanged if unknown.
+///	</summary>
+static std::string RemapId(
+	const std::map<std::string, std::string> & mapNewIds,
+	const std::string & strId
+) {
+	std::map<std::string, std::string>::const_iterator iter =
+		mapNewIds.find(strId);
+	if (iter == mapNewIds.end()) {
+		return strId;
+	}
+	return iter->second;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		New ids of the files and of the subaxes of each axis of an index.
+///	</summary>
+struct IdRemap {
+
+	///	<summary>
+	///		New id of each file.
+	///	</summary>
+	std::map<std::string, std::string> mapFileIds;
+
+	///	<summary>
+	///		New id of each subaxis of each axis.
+	///	</summary>
+	std::map<std::string, std::map<std::string, std::string> > mapSubAxisIds;
+
+	///	<summary>
+	///		Look up the new id of a subaxis.
+	///	</summary>
+	std::string SubAxis(
+		const std::string & strAxis,
+		const std::string & strSubAxis
+	) const {
+		std::map<std::string, std::map<std::string, std::string> >::const_iterator
+			iter = mapSubAxisIds.find(strAxis);
+		if (iter == mapSubAxisIds.end()) {
+			return strSubAxis;
+		}
+		return RemapId(iter->second, strSubAxis);
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Remap the rows of a subaxis map, each holding a subaxis of each
+///		axis followed by a file, and sort them.
+///	</summary>
+static nlohmann::json CanonicalSubAxisMap(
+	const nlohmann::json & jSubAxisMap,
+	const nlohmann::json & jAxisIds,
+	const IdRemap & remap
+) {
+	std::vector<nlohmann::json> vecRows;
+	for (size_t r = 0; r < jSubAxisMap.size(); r++) {
+		nlohmann::json jRow = jSubAxisMap[r];
+		if (!jRow.is_array() || (jRow.size() != jAxisIds.size() + 1)) {
+			vecRows.push_back(jRow);
+			continue;
+		}
+		for (size_t a = 0; a < jAxisIds.size(); a++) {
+			jRow[a] = remap.SubAxis(
+				jAxisIds[a].get<std::string>(), jRow[a].get<std::string>());
+		}
+		jRow[jAxisIds.size()] =
+			RemapId(remap.mapFileIds, jRow[jAxisIds.size()].get<std::string>());
+		vecRows.push_back(jRow);
+	}
+	std::sort(vecRows.begin(), vecRows.end());
+
+	nlohmann::json jOut = nlohmann::json::array();
+	for (size_t r = 0; r < vecRows.size(); r++) {
+		jOut.push_back(vecRows[r]);
+	}
+	return jOut;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the canonical form of a JSON index.  File ids are assigned in
+///		order of file name and subaxis ids in order of content, since both
+///		otherwise follow the order in which the filesystem lists the tree;
+///		the tree directory is replaced by TreePlaceholder and file stamps,
+///		which hold inodes and times, are removed.
+///	</summary>
+static std::string CanonicalJSON(
+	const std::string & strContents,
+	const std::string & strTree
+) {
+	nlohmann::json j = nlohmann::json::parse(strContents);
+
+	IdRemap remap;
+
+	nlohmann::json::iterator iterFiles = j.find("file");
+	if ((iterFiles != j.end()) && iterFiles->is_object()) {
+		std::map<std::string, std::string> mapSortKeys;
+		for (auto iter = iterFiles->begin(); iter != iterFiles->end(); iter++) {
+			nlohmann::json::iterator iterName = iter.value().find("name");
+			if (iterName != iter.value().end()) {
+				mapSortKeys[iter.key()] =
+					CanonicalPath(iterName->get<std::string>(), strTree);
+			}
+		}
+		RenumberIds(mapSortKeys, remap.mapFileIds);
+	}
+
+	nlohmann::json::iterator iterAxes = j.find("axes");
+	if ((iterAxes != j.end()) && iterAxes->is_object()) {
+		for (auto iter = iterAxes->begin(); iter != iterAxes->end(); iter++) {
+			nlohmann::json::iterator iterSubAxes = iter.value().find("subaxes");
+			if (iterSubAxes == iter.value().end()) {
+				continue;
+			}
+			std::map<std::string, std::string> mapSortKeys;
+			for (auto iterSub = iterSubAxes->begin(); iterSub != iterSubAxes->end(); iterSub++) {
+				mapSortKeys[iterSub.key()] = iterSub.value().dump();
+			}
+			RenumberIds(mapSortKeys, remap.mapSubAxisIds[iter.key()]);
+
+			nlohmann::json jSubAxes = nlohmann::json::object();
+			for (auto iterSub = iterSubAxes->begin(); iterSub != iterSubAxes->end(); iterSub++) {
+				jSubAxes[remap.SubAxis(iter.key(), iterSub.key())] = iterSub.value();
+			}
+			*iterSubAxes = jSubAxes;
+		}
+	}
+
+	if ((iterFiles != j.end()) && iterFiles->is_object()) {
+		nlohmann::json jFiles = nlohmann::json::object();
+		for (auto iter = iterFiles->begin(); iter != iterFiles->end(); iter++) {
+			nlohmann::json jFile = iter.value();
+			jFile.erase("stamp");
+			nlohmann::json::iterator iterName = jFile.find("name");
+			if (iterName != jFile.end()) {
+				*iterName = CanonicalPath(iterName->get<std::string>(), strTree);
+			}
+			nlohmann::json::iterator iterFileAxes = jFile.find("axes");
+			if (iterFileAxes != jFile.end()) {
+				for (size_t a = 0; a < iterFileAxes->size(); a++) {
+					nlohmann::json & jAxis = (*iterFileAxes)[a];
+					if (jAxis.is_array() && (jAxis.size() == 2)) {
+						jAxis[1] = remap.SubAxis(
+							jAxis[0].get<std::string>(), jAxis[1].get<std::string>());
+					}
+				}
+			}
+			jFiles[RemapId(remap.mapFileIds, iter.key())] = jFile;
+		}
+		*iterFiles = jFiles;
+	}
+
+	nlohmann::json::iterator iterVariables = j.find("variables");
+	if ((iterVariables != j.end()) && iterVariables->is_object()) {
+		for (auto iter = iterVariables->begin(); iter != iterVariables->end(); iter++) {
+			nlohmann::json::iterator iterAxisIds = iter.value().find("axisids");
+			nlohmann::json::iterator iterMap = iter.value().find("subaxismap");
+			if ((iterAxisIds != iter.value().end()) && (iterMap != iter.value().end())) {
+				*iterMap = CanonicalSubAxisMap(*iterMap, *iterAxisIds, remap);
+			}
+		}
+	}
+
+	std::ostringstream oss;
+	oss << std::setw(4) << j << std::endl;
+	return oss.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Write the canonical form of an XML element and its children.
+///		strAxis is the id of the enclosing axis element, if any.
+///	</summary>
+static std::string CanonicalXMLElement(
+	const tinyxml2::XMLElement * pElement,
+	const IdRemap & remap,
+	const std::string & strTree,
+	const std::string & strAxis,
+	const std::string & strIndent,
+	bool fSkipId
+) {
+	const std::string strName(pElement->Name());
+
+	std::string strOut = strIndent + std::string("<") + strName;
+	const tinyxml2::XMLAttribute * pAttr = pElement->FirstAttribute();
+	for (; pAttr != NULL; pAttr = pAttr->Next()) {
+		const std::string strAttr(pAttr->Name());
+		std::string strValue(pAttr->Value());
+		if (fSkipId && (strAttr == "id")) {
+			continue;
+		}
+		if (strName == "file") {
+			if (strAttr == "id") {
+				strValue = RemapId(remap.mapFileIds, strValue);
+			} else if (strAttr == "name") {
+				strValue = CanonicalPath(strValue, strTree);
+			}
+		} else if (strName == "subaxis") {
+			if ((strAttr == "id") && (strAxis != "")) {
+				strValue = remap.SubAxis(strAxis, strValue);
+			} else if (strAttr == "subaxis") {
+				const char * szAxis = pElement->Attribute("axis");
+				if (szAxis != NULL) {
+					strValue = remap.SubAxis(szAxis, strValue);
+				}
+			}
+		}
+		strOut += std::string(" ") + strAttr
+			+ std::string("=\"") + strValue + std::string("\"");
+	}
+	strOut += std::string(">");
+
+	const char * szText = pElement->GetText();
+	if (szText != NULL) {
+		std::string strText(szText);
+		if (strName == "subaxismap") {
+			const tinyxml2::XMLElement * pAxisIds =
+				pElement->Parent()->FirstChildElement("axisids");
+			if ((pAxisIds != NULL) && (pAxisIds->GetText() != NULL)) {
+				strText = CanonicalSubAxisMap(
+					nlohmann::json::parse(strText),
+					nlohmann::json::parse(pAxisIds->GetText()),
+					remap).dump();
+			}
+		}
+		strOut += strText;
+	}
+
+	// Children, where runs of files and of subaxes are sorted by new id
+	std::vector< std::pair<long, std::string> > vecChildren;
+	std::vector<std::string> vecChildNames;
+	std::string strChildAxis = strAxis;
+	if ((strName == "axis") && (pElement->Attribute("id") != NULL)) {
+		strChildAxis = pElement->Attribute("id");
+	}
+	const tinyxml2::XMLElement * pChild = pElement->FirstChildElement();
+	for (; pChild != NULL; pChild = pChild->NextSiblingElement()) {
+		std::string strChild =
+			CanonicalXMLElement(
+				pChild, remap, strTree, strChildAxis,
+				strIndent + std::string("    "), false);
+
+		long lSortId = -1;
+		const char * szId = pChild->Attribute("id");
+		if (szId != NULL) {
+			if (std::string(pChild->Name()) == "file") {
+				lSortId = atol(RemapId(remap.mapFileIds, szId).c_str());
+			} else if ((std::string(pChild->Name()) == "subaxis") && (strChildAxis != "")) {
+				lSortId = atol(remap.SubAxis(strChildAxis, szId).c_str());
+			}
+		}
+		vecChildren.push_back(std::pair<long, std::string>(lSortId, strChild));
+		vecChildNames.push_back(pChild->Name());
+	}
+	for (size_t c = 0; c < vecChildren.size(); ) {
+		size_t cEnd = c + 1;
+		if (vecChildren[c].first >= 0) {
+			while ((cEnd < vecChildren.size()) &&
+			       (vecChildren[cEnd].first >= 0) &&
+			       (vecChildNames[cEnd] == vecChildNames[c])
+			) {
+				cEnd++;
+			}
+			std::sort(vecChildren.begin() + c, vecChildren.begin() + cEnd);
+		}
+		c = cEnd;
+	}
+
+	if (vecChildren.size() != 0) {
+		strOut += std::string("\n");
+		for (size_t c = 0; c < vecChildren.size(); c++) {
+			strOut += vecChildren[c].second;
+		}
+		strOut += strIndent;
+	}
+	strOut += std::string("</") + strName + std::string(">\n");
+	return strOut;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Get the canonical form of an XML index, renumbered as in
+///		CanonicalJSON.  Subaxes are ordered by their canonical XML.
+///	</summary>
+static std::string CanonicalXML(
+	const std::string & strContents,
+	const std::string & strTree
+) {
+	tinyxml2::XMLDocument doc;
+	if (doc.Parse(strContents.c_str(), strContents.length()) != tinyxml2::XML_SUCCESS) {
+		_EXCEPTION1("Malformed XML: %s", doc.ErrorStr());
+	}
+	const tinyxml2::XMLElement * pRoot = doc.RootElement();
+	if (pRoot == NULL) {
+		_EXCEPTIONT("XML has no root element");
+	}
+
+	IdRemap remap;
+	std::map<std::string, std::string> mapFileKeys;
+	const tinyxml2::XMLElement * pChild = pRoot->FirstChildElement();
+	for (; pChild != NULL; pChild = pChild->NextSiblingElement()) {
+		const std::string strName(pChild->Name());
+		if ((strName == "file") &&
+		    (pChild->Attribute("id") != NULL) &&
+		    (pChild->Attribute("name") != NULL)
+		) {
+			mapFileKeys[pChild->Attribute("id")] =
+				CanonicalPath(pChild->Attribute("name"), strTree);
+
+		} else if ((strName == "axis") && (pChild->Attribute("id") != NULL)) {
+			std::map<std::string, std::string> mapSubAxisKeys;
+			const tinyxml2::XMLElement * pSubAxis =
+				pChild->FirstChildElement("subaxis");
+			for (; pSubAxis != NULL; pSubAxis = pSubAxis->NextSiblingElement("subaxis")) {
+				if (pSubAxis->Attribute("id") != NULL) {
+					mapSubAxisKeys[pSubAxis->Attribute("id")] =
+						CanonicalXMLElement(
+							pSubAxis, IdRemap(), strTree, "", "", true);
+				}
+			}
+			RenumberIds(mapSubAxisKeys, remap.mapSubAxisIds[pChild->Attribute("id")]);
+		}
+	}
+	RenumberIds(mapFileKeys, remap.mapFileIds);
+
+	return CanonicalXMLElement(pRoot, remap, strTree, "", "", false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Compare a canonical output with its reference, returning an empty
+///		string if equal and otherwise a description of the first
+///		difference.
+///	</summary>
+static std::string CompareCanonical(
+	const std::string & strActual,
+	const std::string & strExpected
+) {
+	if (strActual == strExpected) {
+		return std::string("");
+	}
+	std::istringstream issActual(strActual);
+	std::istringstream issExpected(strExpected);
+	std::string strLineActual;
+	std::string strLineExpected;
+	for (size_t sLine = 1; ; sLine++) {
+		bool fActual = static_cast<bool>(std::getline(issActual, strLineActual));
+		bool fExpected = static_cast<bool>(std::getline(issExpected, strLineExpected));
+		if (!fActual && !fExpected) {
+			break;
+		}
+		if ((fActual != fExpected) || (strLineActual != strLineExpected)) {
+			return std::string("differs at line ") + std::to_string(sLine);
+		}
+	}
+	return std::string("differs in line endings");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Load the legacy index and write it in each format, then reload
+///		each output, which must give the same index.  The index written
+///		is compared with its goldens, or recorded as the goldens if
+///		fUpdate is set.  Returns the failures; result is the first run.
+///	</summary>
+static std::vector<std::string> CheckLegacyIndex(
+	const std::string & strAutocurator,
+	const std::string & strLegacyIndex,
+	const std::string & strGoldenDir,
+	const std::string & strWorkDir,
+	bool fUpdate,
+	RunResult & result
+) {
+	std::vector<std::string> vecFailures;
+
+	const std::string strRun =
+		strWorkDir + std::string("/") + std::string(LegacyTree);
+	const std::string strGoldenJSON =
+		strGoldenDir + std::string("/") + LegacyTree + std::string(".json");
+	const std::string strGoldenXML =
+		strGoldenDir + std::string("/") + LegacyTree + std::string(".xml");
+
+	result = RunResult();
+	if (!FileExists(strLegacyIndex)) {
+		vecFailures.push_back(
+			std::string("legacy index \"") + strLegacyIndex
+			+ std::string("\" not found"));
+		return vecFailures;
+	}
+
+	// Write the index in each format
+	std::vector<std::string> vecCommand;
+	vecCommand.push_back(strAutocurator);
+	vecCommand.push_back("--in_json");
+	vecCommand.push_back(strLegacyIndex);
+	vecCommand.push_back("--out_json");
+	vecCommand.push_back(strRun + std::string(".json"));
+	vecCommand.push_back("--out_xml");
+	vecCommand.push_back(strRun + std::string(".xml"));
+	vecCommand.push_back("--out_cbor");
+	vecCommand.push_back(strRun + std::string(".cbor"));
+	vecCommand.push_back("--out_msgpack");
+	vecCommand.push_back(strRun + std::string(".msgpack"));
+
+	result = RunCommand(vecCommand, strRun + std::string(".log"));
+	if (result.iStatus != 0) {
+		vecFailures.push_back(
+			std::string("exited with status ")
+			+ std::to_string(result.iStatus) + std::string("; see ")
+			+ strRun + std::string(".log"));
+		return vecFailures;
+	}
+
+	std::string strActualJSON;
+	std::string strActualXML;
+	if (!ReadFile(strRun + std::string(".json"), strActualJSON) ||
+	    !ReadFile(strRun + std::string(".xml"), strActualXML)
+	) {
+		vecFailures.push_back("output not written");
+		return vecFailures;
+	}
+	strActualJSON = CanonicalJSON(strActualJSON, "");
+	strActualXML = CanonicalXML(strActualXML, "");
+	WriteFile(strRun + std::string(".canonical.json"), strActualJSON);
+	WriteFile(strRun + std::string(".canonical.xml"), strActualXML);
+
+	// Reload each output and write it as JSON again
+	const char * const szFormats[] = {"json", "cbor", "msgpack"};
+	for (size_t f = 0; f < 3; f++) {
+		const std::string strReload =
+			strRun + std::string(".") + szFormats[f] + std::string(".reload");
+
+		vecCommand.clear();
+		vecCommand.push_back(strAutocurator);
+		vecCommand.push_back(std::string("--in_") + szFormats[f]);
+		vecCommand.push_back(strRun + std::string(".") + szFormats[f]);
+		vecCommand.push_back("--out_json");
+		vecCommand.push_back(strReload + std::string(".json"));
+
+		RunResult resultReload =
+			RunCommand(vecCommand, strReload + std::string(".log"));
+		std::string strReloadJSON;
+		if (resultReload.iStatus != 0) {
+			vecFailures.push_back(
+				std::string("reloading ") + szFormats[f]
+				+ std::string(" exited with status ")
+				+ std::to_string(resultReload.iStatus) + std::string("; see ")
+				+ strReload + std::string(".log"));
+			continue;
+		}
+		if (!ReadFile(strReload + std::string(".json"), strReloadJSON)) {
+			vecFailures.push_back(
+				std::string("reloading ") + szFormats[f]
+				+ std::string(" wrote no output"));
+			continue;
+		}
+		strReloadJSON = CanonicalJSON(strReloadJSON, "");
+		std::string strDiff = CompareCanonical(strReloadJSON, strActualJSON);
+		if (strDiff != "") {
+			WriteFile(strReload + std::string(".canonical.json"), strReloadJSON);
+			vecFailures.push_back(std::string("reloaded ") + szFormats[f]
+				+ std::string(" ") + strDiff + std::string(" of ")
+				+ strReload + std::string(".canonical.json"));
+		}
+	}
+
+	// Compare with the goldens
+	if (fUpdate) {
+		WriteFile(strGoldenJSON, strActualJSON);
+		WriteFile(strGoldenXML, strActualXML);
+		return vecFailures;
+	}
+
+	std::string strExpectedJSON;
+	std::string strExpectedXML;
+	if (!ReadFile(strGoldenJSON, strExpectedJSON) ||
+	    !ReadFile(strGoldenXML, strExpectedXML)
+	) {
+		vecFailures.push_back("no golden output; record it with --update");
+		return vecFailures;
+	}
+	std::string strDiff = CompareCanonical(strActualJSON, strExpectedJSON);
+	if (strDiff != "") {
+		vecFailures.push_back(std::string("JSON ") + strDiff
+			+ std::string(" of ") + strRun + std::string(".canonical.json"));
+	}
+	strDiff = CompareCanonical(strActualXML, strExpectedXML);
+	if (strDiff != "") {
+		vecFailures.push_back(std::string("XML ") + strDiff
+			+ std::string(" of ") + strRun + std::string(".canonical.xml"));
+	}
+	return vecFailures;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Check the cost schedule on a tree of two directories, one holding
+///		a file forty times larger than each of the ten files of the
+///		other.  Blocks of equal numbers of files give the large file and
+///		four small files to the first of two ranks.  The cost schedule
+///		must leave the large file alone on its rank and balance the ranks
+///		better.  Returns the failures.
+///	</summary>
+static std::vector<std::string> CheckSchedule() {
+	std::vector<std::string> vecFailures;
+
+	const size_t sRanks = 2;
+	const long long llMB = 1024 * 1024;
+
+	std::vector<std::string> vecFilenames;
+	std::vector<long long> vecFileBytes;
+	vecFilenames.push_back("a/0.nc");
+	vecFileBytes.push_back(400 * llMB);
+	for (int f = 0; f < 10; f++) {
+		vecFilenames.push_back(std::string("b/") + std::to_string(f) + ".nc");
+		vecFileBytes.push_back(10 * llMB);
+	}
+	const size_t sFiles = vecFilenames.size();
+	std::vector<char> vecCached(sFiles, 0);
+
+	std::vector<double> vecCosts;
+	ExtractionScheduler::EstimateCosts(vecFileBytes, vecCached, vecCosts);
+	if (!(vecCosts[0] > 10.0 * vecCosts[sFiles-1])) {
+		vecFailures.push_back(
+			std::string("a file 40 times the median size costs ")
+			+ std::to_string(vecCosts[0]) + std::string(", against ")
+			+ std::to_string(vecCosts[sFiles-1]) + std::string(" for the median"));
+	}
+
+	// Cost of each rank under each schedule
+	std::vector<double> vecCountRankCosts(sRanks, 0.0);
+	for (size_t r = 0; r < sRanks; r++) {
+		for (size_t f = (sFiles * r) / sRanks; f < (sFiles * (r+1)) / sRanks; f++) {
+			vecCountRankCosts[r] += vecCosts[f];
+		}
+	}
+
+	std::vector< std::vector<size_t> > vecRankIndices;
+	ExtractionScheduler::Partition(
+		vecFilenames, vecCosts, sRanks, vecRankIndices);
+
+	std::vector<double> vecCostRankCosts(sRanks, 0.0);
+	size_t sAssigned = 0;
+	for (size_t r = 0; r < sRanks; r++) {
+		bool fLarge = false;
+		for (size_t i = 0; i < vecRankIndices[r].size(); i++) {
+			vecCostRankCosts[r] += vecCosts[vecRankIndices[r][i]];
+			fLarge = fLarge || (vecRankIndices[r][i] == 0);
+		}
+		sAssigned += vecRankIndices[r].size();
+		if (fLarge && (vecRankIndices[r].size() != 1)) {
+			vecFailures.push_back(
+				std::string("the rank of the large file also extracts ")
+				+ std::to_string(vecRankIndices[r].size() - 1)
+				+ std::string(" small files"));
+		}
+	}
+	if (sAssigned != sFiles) {
+		vecFailures.push_back(
+			std::to_string(sAssigned) + std::string(" of ")
+			+ std::to_string(sFiles) + std::string(" files assigned"));
+	}
+
+	const double dCountMax =
+		*std::max_element(vecCountRankCosts.begin(), vecCountRankCosts.end());
+	const double dCostMax =
+		*std::max_element(vecCostRankCosts.begin(), vecCostRankCosts.end());
+	if (!(dCostMax < dCountMax)) {
+		vecFailures.push_back(
+			std::string("largest rank cost ") + std::to_string(dCostMax)
+			+ std::string(" is no lower than ") + std::to_string(dCountMax)
+			+ std::string(" with blocks of equal numbers of files"));
+	}
+
+	// Cached headers are cheap, and files of unknown size cost as much as
+	// one of the median size
+	vecFileBytes[sFiles-1] = -1;
+	vecCached[0] = 1;
+	ExtractionScheduler::EstimateCosts(vecFileBytes, vecCached, vecCosts);
+	if (vecCosts[0] != ExtractionScheduler::CachedCost) {
+		vecFailures.push_back("a cached file does not have the cached cost");
+	}
+	if (vecCosts[sFiles-1] != vecCosts[sFiles-2]) {
+		vecFailures.push_back(
+			"a file of unknown size does not cost as much as the median");
+	}
+
+	return vecFailures;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Index a tree with four times the workers of the threaded mode and
+///		the deadline of DeadlineSeconds, without retries, so that a
+///		healthy file timed out while waiting for the other workers fails
+///		the run.  The outputs are compared with their references.
+///		Returns the failures.
+///	</summary>
+static std::vector<std::string> CheckDeadline(
+	const std::string & strAutocurator,
+	const std::string & strTreeDir,
+	const std::string & strRun,
+	int nThreads,
+	const std::vector<std::string> & vecArgs,
+	const std::string & strExpectedJSON,
+	const std::string & strExpectedXML,
+	RunResult & result
+) {
+	std::vector<std::string> vecFailures;
+
+	std::vector<std::string> vecCommand;
+	vecCommand.push_back(strAutocurator);
+	vecCommand.push_back("--path");
+	vecCommand.push_back(strTreeDir);
+	vecCommand.push_back("--recurse");
+	vecCommand.push_back("--threads");
+	vecCommand.push_back(std::to_string(4 * nThreads));
+	vecCommand.push_back("--file_deadline");
+	vecCommand.push_back(DeadlineSeconds);
+	vecCommand.push_back("--out_json");
+	vecCommand.push_back(strRun + std::string(".json"));
+	vecCommand.push_back("--out_xml");
+	vecCommand.push_back(strRun + std::string(".xml"));
+	vecCommand.insert(vecCommand.end(), vecArgs.begin(), vecArgs.end());
+
+	result = RunCommand(vecCommand, strRun + std::string(".log"));
+	if (result.iStatus != 0) {
+		vecFailures.push_back(
+			std::string("exited with status ")
+			+ std::to_string(result.iStatus) + std::string("; see ")
+			+ strRun + std::string(".log"));
+		return vecFailures;
+	}
+
+	std::string strActualJSON;
+	std::string strActualXML;
+	if (!ReadFile(strRun + std::string(".json"), strActualJSON) ||
+	    !ReadFile(strRun + std::string(".xml"), strActualXML)
+	) {
+		vecFailures.push_back("output not written");
+		return vecFailures;
+	}
+	strActualJSON = CanonicalJSON(strActualJSON, strTreeDir);
+	strActualXML = CanonicalXML(strActualXML, strTreeDir);
+	WriteFile(strRun + std::string(".canonical.json"), strActualJSON);
+	WriteFile(strRun + std::string(".canonical.xml"), strActualXML);
+
+	std::string strDiff = CompareCanonical(strActualJSON, strExpectedJSON);
+	if (strDiff != "") {
+		vecFailures.push_back(std::string("JSON ") + strDiff
+			+ std::string(" of ") + strRun + std::string(".canonical.json"));
+	}
+	strDiff = CompareCanonical(strActualXML, strExpectedXML);
+	if (strDiff != "") {
+		vecFailures.push_back(std::string("XML ") + strDiff
+			+ std::string(" of ") + strRun + std::string(".canonical.xml"));
+	}
+
+	return vecFailures;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Announce the result of a check that has no budget and add it to
+///		jResults, counting it in sFailures if it failed.
+///	</summary>
+static void ReportCheck(
+	const char * szTree,
+	const char * szMode,
+	const RunResult & result,
+	const std::vector<std::string> & vecFailures,
+	bool fUpdate,
+	nlohmann::json & jResults,
+	size_t & sFailures
+) {
+	nlohmann::json jRun;
+	jRun["tree"] = szTree;
+	jRun["mode"] = szMode;
+	jRun["wall_time_s"] = result.dWallTime;
+	jRun["peak_rss_kb"] = result.lMaxRSSKB;
+
+	std::string strResult;
+	if (vecFailures.size() != 0) {
+		strResult = "FAILED";
+		sFailures++;
+		jRun["result"] = "failed";
+		jRun["failures"] = vecFailures;
+	} else if (fUpdate) {
+		strResult = "RECORDED";
+		jRun["result"] = "recorded";
+	} else {
+		strResult = "PASSED";
+		jRun["result"] = "passed";
+	}
+
+	Announce("%-10s %-12s %10.3f %14.1f  %s",
+		szTree, szMode, result.dWallTime,
+		static_cast<double>(result.lMaxRSSKB) / 1024.0,
+		strResult.c_str());
+	for (size_t f = 0; f < vecFailures.size(); f++) {
+		Announce("    %s", vecFailures[f].c_str());
+	}
+
+	jResults.push_back(jRun);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+
+try {
+
+	// autocurator executable
+	std::string strAutocurator;
+
+	// autocurator_gendata executable
+	std::string strGenData;
+
+	// Comma-separated trees to check
+	std::string strTrees;
+
+	// Comma-separated modes to check
+	std::string strModes;
+
+	// Directory holding the golden outputs and budgets
+	std::string strGoldenDir;
+
+	// Index in the legacy format that is loaded and written again
+	std::string strLegacyIndex;
+
+	// Directory for the trees and the outputs of each run
+	std::string strWorkDir;
+
+	// Number of threads of the threaded mode
+	int nThreads;
+
+	// Number of ranks of the MPI mode; zero skips the mode
+	int nMPIRanks;
+
+	// Command used to launch MPI runs, followed by the rank count
+	std::string strMPIRun;
+
+	// Further arguments passed to autocurator, which must begin with a
+	// space so that they are not taken as options of this executable
+	std::string strArgs;
+
+	// Fraction by which a run may exceed its budget
+	double dMargin;
+
+	// Wall time in seconds by which a run may exceed its budget, on top of
+	// the margin, as small trees are indexed in a fraction of a second
+	double dTimeSlack;
+
+	// Number of runs of each mode, of which the fastest is kept
+	int nRepeat;
+
+	// Use the trees already in the work directory
+	bool fReuseTrees;
+
+	// Record the goldens and budgets instead of checking them
+	bool fUpdate;
+
+	// Output JSON file
+	std::string strOutputFile;
+
+	// Parse the command line
+	BeginCommandLine()
+		CommandLineString(strAutocurator, "autocurator", "");
+		CommandLineString(strGenData, "gendata", "");
+		CommandLineString(strTrees, "trees", "");
+		CommandLineString(strModes, "modes", "serial,threaded,mpi,incremental,deadline");
+		CommandLineString(strGoldenDir, "golden_dir", "");
+		CommandLineString(strLegacyIndex, "legacy_index", "");
+		CommandLineString(strWorkDir, "work_dir", "/tmp/autocurator_check");
+		CommandLineInt(nThreads, "threads", 4);
+		CommandLineInt(nMPIRanks, "mpi_ranks", 0);
+		CommandLineString(strMPIRun, "mpirun", "mpirun -np");
+		CommandLineString(strArgs, "args", "");
+		CommandLineDouble(dMargin, "margin", 0.25);
+		CommandLineDouble(dTimeSlack, "time_slack", 0.1);
+		CommandLineInt(nRepeat, "repeat", 3);
+		CommandLineBool(fReuseTrees, "reuse_trees");
+		CommandLineBool(fUpdate, "update");
+		CommandLineString(strOutputFile, "out", "");
+
+		ParseCommandLine(argc, argv);
+	EndCommandLine(argv)
+
+	// Default to executables and goldens relative to this executable
+	if (strAutocurator == "") {
+		strAutocurator = SiblingExecutable(argv[0], "autocurator");
+	}
+	if (strGenData == "") {
+		strGenData = SiblingExecutable(argv[0], "autocurator_gendata");
+	}
+	if (strGoldenDir == "") {
+		strGoldenDir = SiblingExecutable(argv[0], "../test/check");
+	}
+	if (strLegacyIndex == "") {
+		strLegacyIndex = SiblingExecutable(argv[0], "../test/test_a_v2.json");
+	}
+	if (nRepeat < 1) {
+		_EXCEPTIONT("--repeat must be at least 1");
+	}
+	if (dMargin < 0.0) {
+		_EXCEPTIONT("--margin must be nonnegative");
+	}
+
+	// Trees and modes to check
+	std::vector<const CheckTree *> vecTrees;
+	bool fLegacy;
+	bool fSchedule;
+	{
+		std::vector<std::string> vecNames;
+		SplitString(strTrees, ',', vecNames);
+		const std::vector<CheckTree> & vecAll = CheckTrees();
+		for (size_t t = 0; t < vecAll.size(); t++) {
+			if ((vecNames.size() == 0) ||
+			    (std::find(vecNames.begin(), vecNames.end(), vecAll[t].szName) != vecNames.end())
+			) {
+				vecTrees.push_back(&(vecAll[t]));
+			}
+		}
+		fLegacy =
+			(vecNames.size() == 0) ||
+			(std::find(vecNames.begin(), vecNames.end(), LegacyTree) != vecNames.end());
+		fSchedule =
+			(vecNames.size() == 0) ||
+			(std::find(vecNames.begin(), vecNames.end(), ScheduleTree) != vecNames.end());
+		for (size_t n = 0; n < vecNames.size(); n++) {
+			bool fFound =
+				(vecNames[n] == LegacyTree) || (vecNames[n] == ScheduleTree);
+			for (size_t t = 0; t < vecAll.size(); t++) {
+				fFound = fFound || (vecNames[n] == vecAll[t].szName);
+			}
+			if (!fFound) {
+				_EXCEPTION1("Unknown tree \"%s\" in --trees", vecNames[n].c_str());
+			}
+		}
+	}
+
+	std::vector<std::string> vecModes;
+	SplitString(strModes, ',', vecModes);
+	const bool fDeadline =
+		(std::find(vecModes.begin(), vecModes.end(), DeadlineMode) != vecModes.end());
+	for (size_t m = 0; m < vecModes.size(); m++) {
+		if ((vecModes[m] != DeadlineMode) &&
+		    (std::find(CheckModes, CheckModes + 4, vecModes[m]) == CheckModes + 4)
+		) {
+			_EXCEPTION1("Unknown mode \"%s\" in --modes", vecModes[m].c_str());
+		}
+	}
+
+	std::vector<std::string> vecMPIRun;
+	std::vector<std::string> vecArgs;
+	SplitString(strMPIRun, ' ', vecMPIRun);
+	SplitString(strArgs, ' ', vecArgs);
+
+	// Trees are generated and indexed in the work directory
+	if ((mkdir(strWorkDir.c_str(), 0777) != 0) && !FileExists(strWorkDir)) {
+		_EXCEPTION1("Unable to create work directory \"%s\"", strWorkDir.c_str());
+	}
+	if (strWorkDir[0] != '/') {
+		char szCwd[4096];
+		if (getcwd(szCwd, sizeof(szCwd)) == NULL) {
+			_EXCEPTIONT("Unable to get the working directory");
+		}
+		strWorkDir = std::string(szCwd) + std::string("/") + strWorkDir;
+	}
+
+	if (fUpdate &&
+	    (mkdir(strGoldenDir.c_str(), 0777) != 0) && !FileExists(strGoldenDir)
+	) {
+		_EXCEPTION1("Unable to create golden directory \"%s\"", strGoldenDir.c_str());
+	}
+
+	// Budgets of each mode of each tree
+	const std::string strBudgetFile =
+		strGoldenDir + std::string("/budgets.json");
+	nlohmann::json jBudgets = nlohmann::json::object();
+	{
+		std::string strContents;
+		if (ReadFile(strBudgetFile, strContents)) {
+			jBudgets = nlohmann::json::parse(strContents);
+		}
+	}
+
+	AnnounceBanner();
+
+	nlohmann::json jResults = nlohmann::json::array();
+	size_t sFailures = 0;
+	size_t sSkipped = 0;
+
+	Announce("%-10s %-12s %10s %14s  %s",
+		"tree", "mode", "time (s)", "peak RSS (MB)", "result");
+
+	for (size_t t = 0; t < vecTrees.size(); t++) {
+		const CheckTree & tree = *(vecTrees[t]);
+		const std::string strTreeDir =
+			strWorkDir + std::string("/") + std::string(tree.szName);
+		const std::string strPrefix =
+			strWorkDir + std::string("/") + std::string(tree.szName);
+
+		// Generate the tree
+		if (!fReuseTrees) {
+			std::vector<std::string> vecCommand;
+			vecCommand.push_back("rm");
+			vecCommand.push_back("-rf");
+			vecCommand.push_back(strTreeDir);
+			RunCommand(vecCommand, strPrefix + std::string(".gendata.log"));
+
+			vecCommand.clear();
+			vecCommand.push_back(strGenData);
+			vecCommand.push_back("--out_dir");
+			vecCommand.push_back(strTreeDir);
+			vecCommand.insert(vecCommand.end(),
+				tree.vecGenArgs.begin(), tree.vecGenArgs.end());
+			RunResult result =
+				RunCommand(vecCommand, strPrefix + std::string(".gendata.log"));
+			if (result.iStatus != 0) {
+				_EXCEPTION2("autocurator_gendata exited with status %i; see \"%s\"",
+					result.iStatus, (strPrefix + std::string(".gendata.log")).c_str());
+			}
+		} else if (!FileExists(strTreeDir)) {
+			_EXCEPTION1("Tree \"%s\" does not exist", strTreeDir.c_str());
+		}
+
+		// Goldens of the tree
+		const std::string strGoldenJSON =
+			strGoldenDir + std::string("/") + tree.szName + std::string(".json");
+		const std::string strGoldenXML =
+			strGoldenDir + std::string("/") + tree.szName + std::string(".xml");
+
+		std::string strExpectedJSON;
+		std::string strExpectedXML;
+		bool fGolden =
+			!fUpdate
+			&& ReadFile(strGoldenJSON, strExpectedJSON)
+			&& ReadFile(strGoldenXML, strExpectedXML);
+
+		// The serial index is the input of the incremental mode and, when
+		// recording, the reference of the other modes
+		std::vector<std::string> vecTreeModes;
+		for (size_t m = 0; m < 4; m++) {
+			bool fRequested =
+				(std::find(vecModes.begin(), vecModes.end(), CheckModes[m]) != vecModes.end());
+			if (fRequested || ((m == 0) && (vecModes.size() != 0))) {
+				vecTreeModes.push_back(CheckModes[m]);
+			}
+		}
+
+		for (size_t m = 0; m < vecTreeModes.size(); m++) {
+			const std::string & strMode = vecTreeModes[m];
+			const std::string strRun = strPrefix + std::string(".") + strMode;
+
+			nlohmann::json jRun;
+			jRun["tree"] = tree.szName;
+			jRun["mode"] = strMode;
+
+			if ((strMode == "mpi") && (nMPIRanks < 1)) {
+				Announce("%-10s %-12s %10s %14s  %s",
+					tree.szName, strMode.c_str(), "-", "-", "SKIPPED (no --mpi_ranks)");
+				jRun["result"] = "skipped";
+				jResults.push_back(jRun);
+				sSkipped++;
+				continue;
+			}
+
+			std::vector<std::string> vecCommand;
+			if (strMode == "mpi") {
+				vecCommand = vecMPIRun;
+				vecCommand.push_back(std::to_string(nMPIRanks));
+			}
+			vecCommand.push_back(strAutocurator);
+			vecCommand.push_back("--path");
+			vecCommand.push_back(strTreeDir);
+			vecCommand.push_back("--recurse");
+			vecCommand.push_back("--threads");
+			vecCommand.push_back((strMode == "threaded")?(std::to_string(nThreads)):("1"));
+			if (strMode == "incremental") {
+				vecCommand.push_back("--in_json");
+				vecCommand.push_back(strPrefix + std::string(".serial.json"));
+				vecCommand.push_back("--incremental");
+			}
+			vecCommand.push_back("--out_json");
+			vecCommand.push_back(strRun + std::string(".json"));
+			vecCommand.push_back("--out_xml");
+			vecCommand.push_back(strRun + std::string(".xml"));
+			vecCommand.insert(vecCommand.end(), vecArgs.begin(), vecArgs.end());
+
+			// Keep the fastest run
+			RunResult result;
+			for (int n = 0; n < nRepeat; n++) {
+				RunResult resultRun =
+					RunCommand(vecCommand, strRun + std::string(".log"));
+				if ((n == 0) || (resultRun.iStatus != 0) ||
+				    (resultRun.dWallTime < result.dWallTime)
+				) {
+					result = resultRun;
+				}
+				if (resultRun.iStatus != 0) {
+					break;
+				}
+			}
+
+			jRun["wall_time_s"] = result.dWallTime;
+			jRun["peak_rss_kb"] = result.lMaxRSSKB;
+
+			std::vector<std::string> vecFailures;
+			std::vector<std::string> vecWarnings;
+
+			// Compare the outputs with their references
+			std::string strActualJSON;
+			std::string strActualXML;
+			if (result.iStatus != 0) {
+				vecFailures.push_back(
+					std::string("exited with status ")
+					+ std::to_string(result.iStatus) + std::string("; see ")
+					+ strRun + std::string(".log"));
+
+			} else if (
+			    !ReadFile(strRun + std::string(".json"), strActualJSON) ||
+			    !ReadFile(strRun + std::string(".xml"), strActualXML)
+			) {
+				vecFailures.push_back("output not written");
+
+			} else {
+				try {
+					strActualJSON = CanonicalJSON(strActualJSON, strTreeDir);
+					strActualXML = CanonicalXML(strActualXML, strTreeDir);
+				} catch(Exception & e) {
+					vecFailures.push_back(e.ToString());
+				} catch(std::exception & e) {
+					vecFailures.push_back(std::string("malformed output: ") + e.what());
+				}
+			}
+
+			if (vecFailures.size() == 0) {
+				WriteFile(strRun + std::string(".canonical.json"), strActualJSON);
+				WriteFile(strRun + std::string(".canonical.xml"), strActualXML);
+
+				if ((strMode == "serial") && fUpdate) {
+					WriteFile(strGoldenJSON, strActualJSON);
+					WriteFile(strGoldenXML, strActualXML);
+				}
+				if ((strMode == "serial") && !fGolden) {
+					strExpectedJSON = strActualJSON;
+					strExpectedXML = strActualXML;
+					if (!fUpdate) {
+						vecFailures.push_back("no golden output; record it with --update");
+					}
+				}
+
+				std::string strDiff = CompareCanonical(strActualJSON, strExpectedJSON);
+				if (strDiff != "") {
+					vecFailures.push_back(std::string("JSON ") + strDiff
+						+ std::string(" of ") + strRun + std::string(".canonical.json"));
+				}
+				strDiff = CompareCanonical(strActualXML, strExpectedXML);
+				if (strDiff != "") {
+					vecFailures.push_back(std::string("XML ") + strDiff
+						+ std::string(" of ") + strRun + std::string(".canonical.xml"));
+				}
+			}
+
+			// Compare the measurements with their budgets
+			if (vecFailures.size() == 0) {
+				if (fUpdate) {
+					nlohmann::json & jBudget = jBudgets[tree.szName][strMode];
+					jBudget["wall_time_s"] = result.dWallTime;
+					jBudget["peak_rss_kb"] = result.lMaxRSSKB;
+
+				} else if (
+				    jBudgets.contains(tree.szName) &&
+				    jBudgets[tree.szName].contains(strMode)
+				) {
+					const nlohmann::json & jBudget = jBudgets[tree.szName][strMode];
+					const double dMaxTime =
+						jBudget["wall_time_s"].get<double>() * (1.0 + dMargin)
+						+ dTimeSlack;
+					const double dMaxRSSKB =
+						jBudget["peak_rss_kb"].get<double>() * (1.0 + dMargin);
+
+					if (result.dWallTime > dMaxTime) {
+						std::ostringstream oss;
+						oss << "wall time " << result.dWallTime
+							<< " s over budget of " << dMaxTime << " s";
+						vecFailures.push_back(oss.str());
+					}
+					if (static_cast<double>(result.lMaxRSSKB) > dMaxRSSKB) {
+						std::ostringstream oss;
+						oss << "peak RSS " << result.lMaxRSSKB
+							<< " kB over budget of " << static_cast<long>(dMaxRSSKB) << " kB";
+						vecFailures.push_back(oss.str());
+					}
+
+				} else {
+					vecFailures.push_back("no budget; record it with --update");
+				}
+			}
+
+			std::string strResult;
+			if (vecFailures.size() != 0) {
+				strResult = "FAILED";
+				sFailures++;
+				jRun["result"] = "failed";
+				jRun["failures"] = vecFailures;
+			} else if (fUpdate) {
+				strResult = "RECORDED";
+				jRun["result"] = "recorded";
+			} else {
+				strResult = "PASSED";
+				jRun["result"] = "passed";
+			}
+			if (vecWarnings.size() != 0) {
+				jRun["warnings"] = vecWarnings;
+				for (size_t w = 0; w < vecWarnings.size(); w++) {
+					strResult += ((w == 0)?(" ("):(", ")) + vecWarnings[w];
+				}
+				strResult += ")";
+			}
+
+			Announce("%-10s %-12s %10.3f %14.1f  %s",
+				tree.szName, strMode.c_str(), result.dWallTime,
+				static_cast<double>(result.lMaxRSSKB) / 1024.0,
+				strResult.c_str());
+			for (size_t f = 0; f < vecFailures.size(); f++) {
+				Announce("    %s", vecFailures[f].c_str());
+			}
+
+			jResults.push_back(jRun);
+		}
+
+		// The deadline mode is compared with the serial outputs
+		if (fDeadline) {
+			RunResult result = RunResult();
+			std::vector<std::string> vecFailures;
+			try {
+				vecFailures =
+					CheckDeadline(
+						strAutocurator, strTreeDir,
+						strPrefix + std::string(".") + DeadlineMode,
+						nThreads, vecArgs, strExpectedJSON, strExpectedXML,
+						result);
+			} catch(Exception & e) {
+				vecFailures.push_back(e.ToString());
+			} catch(std::exception & e) {
+				vecFailures.push_back(std::string("malformed output: ") + e.what());
+			}
+
+			ReportCheck(tree.szName, DeadlineMode, result, vecFailures,
+				fUpdate, jResults, sFailures);
+		}
+	}
+
+	// The legacy index has no budget, since it is loaded rather than
+	// indexed
+	if (fLegacy) {
+		RunResult result = RunResult();
+		std::vector<std::string> vecFailures;
+		try {
+			vecFailures =
+				CheckLegacyIndex(
+					strAutocurator, strLegacyIndex,
+					strGoldenDir, strWorkDir, fUpdate, result);
+		} catch(Exception & e) {
+			vecFailures.push_back(e.ToString());
+		} catch(std::exception & e) {
+			vecFailures.push_back(std::string("malformed output: ") + e.what());
+		}
+
+		ReportCheck(LegacyTree, "reload", result, vecFailures,
+			fUpdate, jResults, sFailures);
+	}
+
+	// The schedule is checked in process and has nothing to record
+	if (fSchedule) {
+		ReportCheck(ScheduleTree, "unit", RunResult(), CheckSchedule(),
+			false, jResults, sFailures);
+	}
+
+	if (fUpdate) {
+		std::ofstream ofs(strBudgetFile.c_str());
+		if (!ofs.is_open()) {
+			_EXCEPTION1("Unable to open budget file \"%s\"", strBudgetFile.c_str());
+		}
+		ofs << std::setw(4) << jBudgets << std::endl;
+	}
+
+	if (strOutputFile != "") {
+		nlohmann::json j;
+		j["margin"] = dMargin;
+		j["time_slack_s"] = dTimeSlack;
+		j["runs"] = jResults;
+
+		std::ofstream ofs(strOutputFile.c_str());
+		if (!ofs.is_open()) {
+			_EXCEPTION1("Unable to open output file \"%s\"", strOutputFile.c_str());
+		}
+		ofs << std::setw(4) << j << std::endl;
+	}
+
+	Announce("%lu failed, %lu skipped", sFailures, sSkipped);
+
+	AnnounceBanner();
+
+	if (sFailures != 0) {
+		return 1;
+	}
+
+} catch(Exception & e) {
+	Announce(e.ToString().c_str());
+	return (-1);
+}
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
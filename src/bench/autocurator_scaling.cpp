@@ -0,0 +1,237 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+///	\file    autocurator_scaling.cpp
+///	\version October 14, 2026
+///
+
+#include "CommandLine.h"
+#include "Announce.h"
+#include "Exception.h"
+#include "BenchProcess.h"
+#include "../contrib/json.hpp"
+
+#include <sys/stat.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+
+///////////////////////////////////////////////////////////////////////////////
+
+///	<summary>
+///		Parse a comma-separated list of positive counts.
+///	</summary>
+static void ParseCounts(
+	const std::string & strList,
+	const char * szOption,
+	std::vector<int> & vecCounts
+) {
+	std::vector<std::string> vecTokens;
+	SplitString(strList, ',', vecTokens);
+	vecCounts.clear();
+	for (size_t i = 0; i < vecTokens.size(); i++) {
+		char * szEnd = NULL;
+		long lCount = strtol(vecTokens[i].c_str(), &szEnd, 10);
+		if ((*szEnd != '\0') || (lCount < 1)) {
+			_EXCEPTION2("Invalid count \"%s\" in --%s",
+				vecTokens[i].c_str(), szOption);
+		}
+		vecCounts.push_back(static_cast<int>(lCount));
+	}
+	if (vecCounts.size() == 0) {
+		_EXCEPTION1("--%s must list at least one count", szOption);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+
+try {
+
+	// autocurator executable
+	std::string strAutocurator;
+
+	// Comma-separated trees to index; one per configuration for weak scaling
+	std::string strPaths;
+
+	// Comma-separated thread counts
+	std::string strThreads;
+
+	// Comma-separated MPI rank counts
+	std::string strRanks;
+
+	// Command used to launch MPI runs, followed by the rank count
+	std::string strMPIRun;
+
+	// Further arguments passed to autocurator
+	std::string strArgs;
+
+	// Directory for the index and log of each run
+	std::string strWorkDir;
+
+	// Output JSON file
+	std::string strOutputFile;
+
+	// Number of runs of each configuration
+	int nRepeat;
+
+	// Parse the command line
+	BeginCommandLine()
+		CommandLineString(strAutocurator, "autocurator", "");
+		CommandLineString(strPaths, "path", "");
+		CommandLineString(strThreads, "threads", "1,2,4,8");
+		CommandLineString(strRanks, "ranks", "1");
+		CommandLineString(strMPIRun, "mpirun", "mpirun -np");
+		CommandLineString(strArgs, "args", "--recurse");
+		CommandLineString(strWorkDir, "work_dir", "/tmp");
+		CommandLineString(strOutputFile, "out", "scaling_results.json");
+		CommandLineInt(nRepeat, "repeat", 1);
+
+		ParseCommandLine(argc, argv);
+	EndCommandLine(argv)
+
+	// Default to the autocurator next to this executable
+	if (strAutocurator == "") {
+		strAutocurator = SiblingExecutable(argv[0], "autocurator");
+	}
+
+	std::vector<std::string> vecPaths;
+	SplitString(strPaths, ',', vecPaths);
+	if (vecPaths.size() == 0) {
+		_EXCEPTIONT("No --path specified");
+	}
+	if (nRepeat < 1) {
+		_EXCEPTIONT("--repeat must be at least 1");
+	}
+
+	std::vector<int> vecThreads;
+	std::vector<int> vecRanks;
+	ParseCounts(strThreads, "threads", vecThreads);
+	ParseCounts(strRanks, "ranks", vecRanks);
+
+	std::vector<std::string> vecMPIRun;
+	std::vector<std::string> vecArgs;
+	SplitString(strMPIRun, ' ', vecMPIRun);
+	SplitString(strArgs, ' ', vecArgs);
+
+	// A single path is indexed by every configuration (strong scaling);
+	// otherwise configuration i indexes path i (weak scaling)
+	const size_t sConfigs = vecThreads.size() * vecRanks.size();
+	if ((vecPaths.size() != 1) && (vecPaths.size() != sConfigs)) {
+		_EXCEPTION2("--path lists %lu trees for %lu configurations",
+			vecPaths.size(), sConfigs);
+	}
+
+	AnnounceBanner();
+
+	nlohmann::json jRuns = nlohmann::json::array();
+
+	Announce("%6s %8s %10s %10s %12s %12s %s",
+		"ranks", "threads", "files", "time (s)", "files/s", "peak RSS (MB)", "output (B)");
+
+	size_t sConfig = 0;
+	for (size_t r = 0; r < vecRanks.size(); r++) {
+	for (size_t t = 0; t < vecThreads.size(); t++, sConfig++) {
+		const std::string & strPath =
+			vecPaths[(vecPaths.size() == 1)?(0):(sConfig)];
+
+		const std::string strTag =
+			std::string("scaling_r") + std::to_string(vecRanks[r])
+			+ std::string("_t") + std::to_string(vecThreads[t]);
+		const std::string strIndexFile =
+			strWorkDir + std::string("/") + strTag + std::string(".json");
+		const std::string strLogFile =
+			strWorkDir + std::string("/") + strTag + std::string(".log");
+
+		std::vector<std::string> vecCommand;
+		if (vecRanks[r] > 1) {
+			vecCommand = vecMPIRun;
+			vecCommand.push_back(std::to_string(vecRanks[r]));
+		}
+		vecCommand.push_back(strAutocurator);
+		vecCommand.push_back("--path");
+		vecCommand.push_back(strPath);
+		vecCommand.push_back("--threads");
+		vecCommand.push_back(std::to_string(vecThreads[t]));
+		vecCommand.push_back("--out_json");
+		vecCommand.push_back(strIndexFile);
+		vecCommand.insert(vecCommand.end(), vecArgs.begin(), vecArgs.end());
+
+		// Keep the fastest run
+		RunResult result;
+		for (int n = 0; n < nRepeat; n++) {
+			RunResult resultRun = RunCommand(vecCommand, strLogFile);
+			if (resultRun.iStatus != 0) {
+				_EXCEPTION2("autocurator exited with status %i; see \"%s\"",
+					resultRun.iStatus, strLogFile.c_str());
+			}
+			if ((n == 0) || (resultRun.dWallTime < result.dWallTime)) {
+				result = resultRun;
+			}
+		}
+
+		// Count the indexed files
+		size_t sFiles = 0;
+		{
+			std::ifstream ifs(strIndexFile.c_str());
+			if (!ifs.is_open()) {
+				_EXCEPTION1("autocurator did not write \"%s\"", strIndexFile.c_str());
+			}
+			nlohmann::json jIndex = nlohmann::json::parse(ifs);
+			nlohmann::json::iterator iterFile = jIndex.find("file");
+			if (iterFile != jIndex.end()) {
+				sFiles = iterFile->size();
+			}
+		}
+
+		struct stat statIndex;
+		long long llOutputBytes = 0;
+		if (stat(strIndexFile.c_str(), &statIndex) == 0) {
+			llOutputBytes = static_cast<long long>(statIndex.st_size);
+		}
+
+		const double dFilesPerSecond =
+			static_cast<double>(sFiles) / result.dWallTime;
+
+		Announce("%6i %8i %10lu %10.3f %12.1f %12.1f %lld",
+			vecRanks[r], vecThreads[t], sFiles, result.dWallTime,
+			dFilesPerSecond, static_cast<double>(result.lMaxRSSKB) / 1024.0,
+			llOutputBytes);
+
+		nlohmann::json jRun;
+		jRun["path"] = strPath;
+		jRun["ranks"] = vecRanks[r];
+		jRun["threads"] = vecThreads[t];
+		jRun["files"] = sFiles;
+		jRun["wall_time_s"] = result.dWallTime;
+		jRun["files_per_s"] = dFilesPerSecond;
+		jRun["peak_rss_kb"] = result.lMaxRSSKB;
+		jRun["output_bytes"] = llOutputBytes;
+		jRuns.push_back(jRun);
+	}
+	}
+
+	nlohmann::json j;
+	j["scaling"] = (vecPaths.size() == 1)?("strong"):("weak");
+	j["runs"] = jRuns;
+
+	std::ofstream ofs(strOutputFile.c_str());
+	if (!ofs.is_open()) {
+		_EXCEPTION1("Unable to open output file \"%s\"", strOutputFile.c_str());
+	}
+	ofs << std::setw(4) << j << std::endl;
+
+	AnnounceBanner();
+
+} catch(Exception & e) {
+	Announce(e.ToString().c_str());
+	return (-1);
+}
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+